@@ -33,6 +33,7 @@
 #include "system/cpus.h"
 #include "system/accel-blocker.h"
 #include "qemu/bswap.h"
+#include "qemu/host-utils.h"
 #include "exec/memory.h"
 #include "exec/ram_addr.h"
 #include "qemu/event_notifier.h"
@@ -132,6 +133,40 @@ static QemuMutex kml_slots_lock;
 #define kvm_slots_lock()    qemu_mutex_lock(&kml_slots_lock)
 #define kvm_slots_unlock()  qemu_mutex_unlock(&kml_slots_lock)
 
+/*
+ * Per-vCPU cache of the last few MMIO exit translations, so that a guest
+ * polling a device register does not pay for a full flatview lookup on
+ * every exit.  Entries are validated against kvm_mmio_cache_gen, which is
+ * bumped from the memory listener both when a memory transaction begins
+ * and when it commits:
+ *
+ *  - the bump at begin happens before the old flatview (and thus any
+ *    MemoryRegion a cached entry points to) can be handed to RCU for
+ *    reclamation.  A vCPU thread inside an RCU read section that still
+ *    observes the pre-begin generation therefore also blocks reclamation
+ *    of the regions it may dispatch to, exactly like a reader that looked
+ *    the region up in the flatview.
+ *
+ *  - the bump at commit kills entries cached while the transaction was
+ *    in flight, whose translation may predate the flatview switch.
+ */
+#define KVM_MMIO_CACHE_SIZE 4
+
+typedef struct KVMMmioCacheEntry {
+    unsigned gen;           /* kvm_mmio_cache_gen value when cached */
+    hwaddr addr;            /* guest-physical start of the cached window */
+    hwaddr len;
+    hwaddr mr_addr;         /* offset of @addr within @mr */
+    MemoryRegion *mr;
+} KVMMmioCacheEntry;
+
+struct KVMMmioCache {
+    KVMMmioCacheEntry entry[KVM_MMIO_CACHE_SIZE];
+    unsigned next;          /* round-robin replacement cursor */
+};
+
+static unsigned kvm_mmio_cache_gen = 1;
+
 static void kvm_slot_init_dirty_bitmap(KVMSlot *mem);
 
 static inline void kvm_resample_fd_remove(int gsi)
@@ -519,6 +554,9 @@ static int do_kvm_destroy_vcpu(CPUState *cpu)
         }
     }
 
+    g_free(cpu->kvm_mmio_cache);
+    cpu->kvm_mmio_cache = NULL;
+
     kvm_park_vcpu(cpu);
 err:
     return ret;
@@ -583,6 +621,8 @@ int kvm_init_vcpu(CPUState *cpu, Error **errp)
         }
     }
 
+    cpu->kvm_mmio_cache = g_new0(struct KVMMmioCache, 1);
+
     ret = kvm_arch_init_vcpu(cpu);
     if (ret < 0) {
         error_setg_errno(errp, -ret,
@@ -872,9 +912,14 @@ static uint64_t kvm_dirty_ring_reap_locked(KVMState *s, CPUState* cpu)
     if (cpu) {
         total = kvm_dirty_ring_reap_one(s, cpu);
     } else {
+        uint32_t count, max_fill = 0;
+
         CPU_FOREACH(cpu) {
-            total += kvm_dirty_ring_reap_one(s, cpu);
+            count = kvm_dirty_ring_reap_one(s, cpu);
+            max_fill = MAX(max_fill, count);
+            total += count;
         }
+        s->reaper.reaper_max_fill = max_fill;
     }
 
     if (total) {
@@ -1569,10 +1614,15 @@ static void kvm_set_phys_mem(KVMMemoryListener *kml,
     } while (size);
 }
 
+/* Bounds for the adaptive reap interval */
+#define KVM_DIRTY_RING_REAP_INTERVAL_MIN_US (50 * 1000)
+#define KVM_DIRTY_RING_REAP_INTERVAL_MAX_US (1000 * 1000)
+
 static void *kvm_dirty_ring_reaper_thread(void *data)
 {
     KVMState *s = data;
     struct KVMDirtyRingReaper *r = &s->reaper;
+    uint64_t interval_us = KVM_DIRTY_RING_REAP_INTERVAL_MAX_US;
 
     rcu_register_thread();
 
@@ -1581,10 +1631,7 @@ static void *kvm_dirty_ring_reaper_thread(void *data)
     while (true) {
         r->reaper_state = KVM_DIRTY_RING_REAPER_WAIT;
         trace_kvm_dirty_ring_reaper("wait");
-        /*
-         * TODO: provide a smarter timeout rather than a constant?
-         */
-        sleep(1);
+        g_usleep(interval_us);
 
         /* keep sleeping so that dirtylimit not be interfered by reaper */
         if (dirtylimit_in_service()) {
@@ -1598,6 +1645,20 @@ static void *kvm_dirty_ring_reaper_thread(void *data)
         kvm_dirty_ring_reap(s, NULL);
         bql_unlock();
 
+        /*
+         * Adapt the interval to the fill level of the busiest ring: back
+         * off while the guest is quiet, and poll more often when a ring
+         * could fill up within the next interval, since a full ring makes
+         * its vCPU exit and block until the next reset.
+         */
+        if (r->reaper_max_fill > s->kvm_dirty_ring_size / 4) {
+            interval_us = MAX(interval_us / 2,
+                              KVM_DIRTY_RING_REAP_INTERVAL_MIN_US);
+        } else if (r->reaper_max_fill < s->kvm_dirty_ring_size / 16) {
+            interval_us = MIN(interval_us * 2,
+                              KVM_DIRTY_RING_REAP_INTERVAL_MAX_US);
+        }
+
         r->reaper_iteration++;
     }
 
@@ -1700,6 +1761,16 @@ static void kvm_region_del(MemoryListener *listener,
     QSIMPLEQ_INSERT_TAIL(&kml->transaction_del, update, next);
 }
 
+static void kvm_region_begin(MemoryListener *listener)
+{
+    /*
+     * Invalidate the per-vCPU MMIO dispatch caches before any of this
+     * transaction's changes take effect; see the comment above
+     * KVM_MMIO_CACHE_SIZE for why this must precede the flatview switch.
+     */
+    qatomic_set(&kvm_mmio_cache_gen, kvm_mmio_cache_gen + 1);
+}
+
 static void kvm_region_commit(MemoryListener *listener)
 {
     KVMMemoryListener *kml = container_of(listener, KVMMemoryListener,
@@ -1707,6 +1778,9 @@ static void kvm_region_commit(MemoryListener *listener)
     KVMMemoryUpdate *u1, *u2;
     bool need_inhibit = false;
 
+    /* Invalidate MMIO dispatch cache entries filled mid-transaction */
+    qatomic_set(&kvm_mmio_cache_gen, kvm_mmio_cache_gen + 1);
+
     if (QSIMPLEQ_EMPTY(&kml->transaction_add) &&
         QSIMPLEQ_EMPTY(&kml->transaction_del)) {
         return;
@@ -1914,6 +1988,7 @@ void kvm_memory_listener_register(KVMState *s, KVMMemoryListener *kml,
     QSIMPLEQ_INIT(&kml->transaction_add);
     QSIMPLEQ_INIT(&kml->transaction_del);
 
+    kml->listener.begin = kvm_region_begin;
     kml->listener.region_add = kvm_region_add;
     kml->listener.region_del = kvm_region_del;
     kml->listener.commit = kvm_region_commit;
@@ -2804,6 +2879,81 @@ static void kvm_handle_io(uint16_t port, MemTxAttrs attrs, void *data, int direc
     }
 }
 
+static void kvm_handle_mmio(CPUState *cpu, struct kvm_run *run,
+                            MemTxAttrs attrs)
+{
+    struct KVMMmioCache *cache = cpu->kvm_mmio_cache;
+    hwaddr addr = run->mmio.phys_addr;
+    unsigned len = run->mmio.len;
+    void *data = run->mmio.data;
+    bool is_write = run->mmio.is_write;
+    KVMMmioCacheEntry *e;
+    MemoryRegion *mr;
+    hwaddr mr_addr, l;
+    unsigned gen;
+    uint64_t val;
+    int i;
+
+    if (len == 0 || len > 8 || !is_power_of_2(len) || (addr & (len - 1)) ||
+        attrs.memory) {
+        /* Odd-sized or split accesses take the generic path */
+        address_space_rw(&address_space_memory, addr, attrs, data, len,
+                         is_write);
+        return;
+    }
+
+    RCU_READ_LOCK_GUARD();
+
+    gen = qatomic_read(&kvm_mmio_cache_gen);
+    for (i = 0; i < KVM_MMIO_CACHE_SIZE; i++) {
+        e = &cache->entry[i];
+        if (e->gen != gen || e->addr != addr || e->len != len) {
+            continue;
+        }
+        mr = e->mr;
+        mr_addr = e->mr_addr;
+        if (memory_access_size(mr, len, mr_addr) == len) {
+            bool release_lock = prepare_mmio_access(mr);
+
+            if (is_write) {
+                val = ldn_he_p(data, len);
+                memory_region_dispatch_write(mr, mr_addr, val,
+                                             size_memop(len), attrs);
+            } else {
+                memory_region_dispatch_read(mr, mr_addr, &val,
+                                            size_memop(len), attrs);
+                stn_he_p(data, len, val);
+            }
+            if (release_lock) {
+                bql_unlock();
+            }
+            return;
+        }
+        break;
+    }
+
+    address_space_rw(&address_space_memory, addr, attrs, data, len, is_write);
+
+    /*
+     * Remember this translation for the next exit to the same register.
+     * Only pure MMIO regions are cached; a hit requires the exact same
+     * (addr, len), so the fast path dispatch below is the same single
+     * memory_region_dispatch_*() call address_space_rw() would make.
+     */
+    l = len;
+    mr = address_space_translate(&address_space_memory, addr, &mr_addr, &l,
+                                 is_write, attrs);
+    if (l >= len && mr->ops &&
+        !memory_region_is_ram(mr) && !memory_region_is_romd(mr)) {
+        e = &cache->entry[cache->next++ % KVM_MMIO_CACHE_SIZE];
+        e->gen = gen;
+        e->addr = addr;
+        e->len = len;
+        e->mr_addr = mr_addr;
+        e->mr = mr;
+    }
+}
+
 static int kvm_handle_internal_error(CPUState *cpu, struct kvm_run *run)
 {
     int i;
@@ -3192,11 +3342,7 @@ int kvm_cpu_exec(CPUState *cpu)
             break;
         case KVM_EXIT_MMIO:
             /* Called outside BQL */
-            address_space_rw(&address_space_memory,
-                             run->mmio.phys_addr, attrs,
-                             run->mmio.data,
-                             run->mmio.len,
-                             run->mmio.is_write);
+            kvm_handle_mmio(cpu, run, attrs);
             ret = 0;
             break;
         case KVM_EXIT_IRQ_WINDOW_OPEN:
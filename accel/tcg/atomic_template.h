@@ -77,6 +77,12 @@
 # define END  _le
 #endif
 
+/* Operations for the misaligned RMW loops.  */
+#define ADD(X, Y)   (X + Y)
+#define AND(X, Y)   (X & Y)
+#define OR(X, Y)    (X | Y)
+#define XOR(X, Y)   (X ^ Y)
+
 ABI_TYPE ATOMIC_NAME(cmpxchg)(CPUArchState *env, abi_ptr addr,
                               ABI_TYPE cmpv, ABI_TYPE newv,
                               MemOpIdx oi, uintptr_t retaddr)
@@ -88,7 +94,11 @@ ABI_TYPE ATOMIC_NAME(cmpxchg)(CPUArchState *env, abi_ptr addr,
 #if DATA_SIZE == 16
     ret = atomic16_cmpxchg(haddr, cmpv, newv);
 #else
-    ret = qatomic_cmpxchg__nocheck(haddr, cmpv, newv);
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {
+        ret = atomic_misal_cmpxchg(haddr, DATA_SIZE, cmpv, newv);
+    } else {
+        ret = qatomic_cmpxchg__nocheck(haddr, cmpv, newv);
+    }
 #endif
     ATOMIC_MMU_CLEANUP;
     atomic_trace_rmw_post(env, addr,
@@ -108,7 +118,19 @@ ABI_TYPE ATOMIC_NAME(xchg)(CPUArchState *env, abi_ptr addr, ABI_TYPE val,
                                          DATA_SIZE, retaddr);
     DATA_TYPE ret;
 
-    ret = qatomic_xchg__nocheck(haddr, val);
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {
+        DATA_TYPE cmp = ldn_he_p(haddr, DATA_SIZE);
+
+        for (;;) {
+            ret = atomic_misal_cmpxchg(haddr, DATA_SIZE, cmp, val);
+            if (ret == cmp) {
+                break;
+            }
+            cmp = ret;
+        }
+    } else {
+        ret = qatomic_xchg__nocheck(haddr, val);
+    }
     ATOMIC_MMU_CLEANUP;
     atomic_trace_rmw_post(env, addr,
                           VALUE_LOW(ret),
@@ -119,13 +141,32 @@ ABI_TYPE ATOMIC_NAME(xchg)(CPUArchState *env, abi_ptr addr, ABI_TYPE val,
     return ret;
 }
 
-#define GEN_ATOMIC_HELPER(X)                                        \
+/*
+ * The misaligned paths below emulate the operation with a loop around
+ * atomic_misal_cmpxchg, so they need the operation as an expression
+ * (OP) and the returned value (RET, old or new) alongside the host
+ * atomic (X) that the aligned path uses directly.
+ */
+#define GEN_ATOMIC_HELPER(X, OP, RET)                               \
 ABI_TYPE ATOMIC_NAME(X)(CPUArchState *env, abi_ptr addr,            \
                         ABI_TYPE val, MemOpIdx oi, uintptr_t retaddr) \
 {                                                                   \
-    DATA_TYPE *haddr, ret;                                          \
+    DATA_TYPE *haddr, old, new, got, ret;                           \
     haddr = atomic_mmu_lookup(env_cpu(env), addr, oi, DATA_SIZE, retaddr);   \
-    ret = qatomic_##X(haddr, val);                                  \
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {             \
+        old = ldn_he_p(haddr, DATA_SIZE);                           \
+        for (;;) {                                                  \
+            new = OP(old, val);                                     \
+            got = atomic_misal_cmpxchg(haddr, DATA_SIZE, old, new); \
+            if (got == old) {                                       \
+                break;                                              \
+            }                                                       \
+            old = got;                                              \
+        }                                                           \
+        ret = RET;                                                  \
+    } else {                                                        \
+        ret = qatomic_##X(haddr, val);                              \
+    }                                                               \
     ATOMIC_MMU_CLEANUP;                                             \
     atomic_trace_rmw_post(env, addr,                                \
                           VALUE_LOW(ret),                           \
@@ -136,14 +177,14 @@ ABI_TYPE ATOMIC_NAME(X)(CPUArchState *env, abi_ptr addr,            \
     return ret;                                                     \
 }
 
-GEN_ATOMIC_HELPER(fetch_add)
-GEN_ATOMIC_HELPER(fetch_and)
-GEN_ATOMIC_HELPER(fetch_or)
-GEN_ATOMIC_HELPER(fetch_xor)
-GEN_ATOMIC_HELPER(add_fetch)
-GEN_ATOMIC_HELPER(and_fetch)
-GEN_ATOMIC_HELPER(or_fetch)
-GEN_ATOMIC_HELPER(xor_fetch)
+GEN_ATOMIC_HELPER(fetch_add, ADD, old)
+GEN_ATOMIC_HELPER(fetch_and, AND, old)
+GEN_ATOMIC_HELPER(fetch_or, OR, old)
+GEN_ATOMIC_HELPER(fetch_xor, XOR, old)
+GEN_ATOMIC_HELPER(add_fetch, ADD, new)
+GEN_ATOMIC_HELPER(and_fetch, AND, new)
+GEN_ATOMIC_HELPER(or_fetch, OR, new)
+GEN_ATOMIC_HELPER(xor_fetch, XOR, new)
 
 #undef GEN_ATOMIC_HELPER
 
@@ -162,11 +203,19 @@ ABI_TYPE ATOMIC_NAME(X)(CPUArchState *env, abi_ptr addr,            \
     XDATA_TYPE *haddr, cmp, old, new, val = xval;                   \
     haddr = atomic_mmu_lookup(env_cpu(env), addr, oi, DATA_SIZE, retaddr);   \
     smp_mb();                                                       \
-    cmp = qatomic_read__nocheck(haddr);                             \
-    do {                                                            \
-        old = cmp; new = FN(old, val);                              \
-        cmp = qatomic_cmpxchg__nocheck(haddr, old, new);            \
-    } while (cmp != old);                                           \
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {             \
+        cmp = ldn_he_p(haddr, DATA_SIZE);                           \
+        do {                                                        \
+            old = cmp; new = FN(old, val);                          \
+            cmp = atomic_misal_cmpxchg(haddr, DATA_SIZE, old, new); \
+        } while (cmp != old);                                       \
+    } else {                                                        \
+        cmp = qatomic_read__nocheck(haddr);                         \
+        do {                                                        \
+            old = cmp; new = FN(old, val);                          \
+            cmp = qatomic_cmpxchg__nocheck(haddr, old, new);        \
+        } while (cmp != old);                                       \
+    }                                                               \
     ATOMIC_MMU_CLEANUP;                                             \
     atomic_trace_rmw_post(env, addr,                                \
                           VALUE_LOW(old),                           \
@@ -213,7 +262,12 @@ ABI_TYPE ATOMIC_NAME(cmpxchg)(CPUArchState *env, abi_ptr addr,
 #if DATA_SIZE == 16
     ret = atomic16_cmpxchg(haddr, BSWAP(cmpv), BSWAP(newv));
 #else
-    ret = qatomic_cmpxchg__nocheck(haddr, BSWAP(cmpv), BSWAP(newv));
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {
+        ret = atomic_misal_cmpxchg(haddr, DATA_SIZE,
+                                   BSWAP(cmpv), BSWAP(newv));
+    } else {
+        ret = qatomic_cmpxchg__nocheck(haddr, BSWAP(cmpv), BSWAP(newv));
+    }
 #endif
     ATOMIC_MMU_CLEANUP;
     atomic_trace_rmw_post(env, addr,
@@ -233,7 +287,19 @@ ABI_TYPE ATOMIC_NAME(xchg)(CPUArchState *env, abi_ptr addr, ABI_TYPE val,
                                          DATA_SIZE, retaddr);
     ABI_TYPE ret;
 
-    ret = qatomic_xchg__nocheck(haddr, BSWAP(val));
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {
+        DATA_TYPE cmp = ldn_he_p(haddr, DATA_SIZE);
+
+        for (;;) {
+            ret = atomic_misal_cmpxchg(haddr, DATA_SIZE, cmp, BSWAP(val));
+            if (ret == cmp) {
+                break;
+            }
+            cmp = ret;
+        }
+    } else {
+        ret = qatomic_xchg__nocheck(haddr, BSWAP(val));
+    }
     ATOMIC_MMU_CLEANUP;
     atomic_trace_rmw_post(env, addr,
                           VALUE_LOW(ret),
@@ -244,13 +310,32 @@ ABI_TYPE ATOMIC_NAME(xchg)(CPUArchState *env, abi_ptr addr, ABI_TYPE val,
     return BSWAP(ret);
 }
 
-#define GEN_ATOMIC_HELPER(X)                                        \
+/*
+ * As above, the misaligned paths loop around atomic_misal_cmpxchg and
+ * need the operation as an expression and the value to return.  Only
+ * bitwise operations commute with the byte swap; addition goes through
+ * the cmpxchg loop helpers below.
+ */
+#define GEN_ATOMIC_HELPER(X, OP, RET)                               \
 ABI_TYPE ATOMIC_NAME(X)(CPUArchState *env, abi_ptr addr,            \
                         ABI_TYPE val, MemOpIdx oi, uintptr_t retaddr) \
 {                                                                   \
-    DATA_TYPE *haddr, ret;                                          \
+    DATA_TYPE *haddr, old, new, got, ret;                           \
     haddr = atomic_mmu_lookup(env_cpu(env), addr, oi, DATA_SIZE, retaddr);   \
-    ret = qatomic_##X(haddr, BSWAP(val));                           \
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {             \
+        old = ldn_he_p(haddr, DATA_SIZE);                           \
+        for (;;) {                                                  \
+            new = OP(old, BSWAP(val));                              \
+            got = atomic_misal_cmpxchg(haddr, DATA_SIZE, old, new); \
+            if (got == old) {                                       \
+                break;                                              \
+            }                                                       \
+            old = got;                                              \
+        }                                                           \
+        ret = RET;                                                  \
+    } else {                                                        \
+        ret = qatomic_##X(haddr, BSWAP(val));                       \
+    }                                                               \
     ATOMIC_MMU_CLEANUP;                                             \
     atomic_trace_rmw_post(env, addr,                                \
                           VALUE_LOW(ret),                           \
@@ -261,12 +346,12 @@ ABI_TYPE ATOMIC_NAME(X)(CPUArchState *env, abi_ptr addr,            \
     return BSWAP(ret);                                              \
 }
 
-GEN_ATOMIC_HELPER(fetch_and)
-GEN_ATOMIC_HELPER(fetch_or)
-GEN_ATOMIC_HELPER(fetch_xor)
-GEN_ATOMIC_HELPER(and_fetch)
-GEN_ATOMIC_HELPER(or_fetch)
-GEN_ATOMIC_HELPER(xor_fetch)
+GEN_ATOMIC_HELPER(fetch_and, AND, old)
+GEN_ATOMIC_HELPER(fetch_or, OR, old)
+GEN_ATOMIC_HELPER(fetch_xor, XOR, old)
+GEN_ATOMIC_HELPER(and_fetch, AND, new)
+GEN_ATOMIC_HELPER(or_fetch, OR, new)
+GEN_ATOMIC_HELPER(xor_fetch, XOR, new)
 
 #undef GEN_ATOMIC_HELPER
 
@@ -284,11 +369,20 @@ ABI_TYPE ATOMIC_NAME(X)(CPUArchState *env, abi_ptr addr,            \
     XDATA_TYPE *haddr, ldo, ldn, old, new, val = xval;              \
     haddr = atomic_mmu_lookup(env_cpu(env), addr, oi, DATA_SIZE, retaddr);   \
     smp_mb();                                                       \
-    ldn = qatomic_read__nocheck(haddr);                             \
-    do {                                                            \
-        ldo = ldn; old = BSWAP(ldo); new = FN(old, val);            \
-        ldn = qatomic_cmpxchg__nocheck(haddr, ldo, BSWAP(new));     \
-    } while (ldo != ldn);                                           \
+    if (unlikely((uintptr_t)haddr & (DATA_SIZE - 1))) {             \
+        ldn = ldn_he_p(haddr, DATA_SIZE);                           \
+        do {                                                        \
+            ldo = ldn; old = BSWAP(ldo); new = FN(old, val);        \
+            ldn = atomic_misal_cmpxchg(haddr, DATA_SIZE,            \
+                                       ldo, BSWAP(new));            \
+        } while (ldo != ldn);                                       \
+    } else {                                                        \
+        ldn = qatomic_read__nocheck(haddr);                         \
+        do {                                                        \
+            ldo = ldn; old = BSWAP(ldo); new = FN(old, val);        \
+            ldn = qatomic_cmpxchg__nocheck(haddr, ldo, BSWAP(new)); \
+        } while (ldo != ldn);                                       \
+    }                                                               \
     ATOMIC_MMU_CLEANUP;                                             \
     atomic_trace_rmw_post(env, addr,                                \
                           VALUE_LOW(old),                           \
@@ -311,10 +405,8 @@ GEN_ATOMIC_HELPER_FN(umax_fetch, MAX,  DATA_TYPE, new)
 
 /* Note that for addition, we need to use a separate cmpxchg loop instead
    of bswaps for the reverse-host-endian helpers.  */
-#define ADD(X, Y)   (X + Y)
 GEN_ATOMIC_HELPER_FN(fetch_add, ADD, DATA_TYPE, old)
 GEN_ATOMIC_HELPER_FN(add_fetch, ADD, DATA_TYPE, new)
-#undef ADD
 
 #undef GEN_ATOMIC_HELPER_FN
 #endif /* DATA_SIZE < 16 */
@@ -322,6 +414,10 @@ GEN_ATOMIC_HELPER_FN(add_fetch, ADD, DATA_TYPE, new)
 #undef END
 #endif /* DATA_SIZE > 1 */
 
+#undef ADD
+#undef AND
+#undef OR
+#undef XOR
 #undef BSWAP
 #undef ABI_TYPE
 #undef DATA_TYPE
@@ -244,13 +244,25 @@ static inline TranslationBlock *tb_lookup(CPUState *cpu, vaddr pc,
     hash = tb_jmp_cache_hash_func(pc);
     jc = cpu->tb_jmp_cache;
 
-    tb = qatomic_read(&jc->array[hash].tb);
-    if (likely(tb &&
-               jc->array[hash].pc == pc &&
-               tb->cs_base == cs_base &&
-               tb->flags == flags &&
-               tb_cflags(tb) == cflags)) {
-        goto hit;
+    for (int way = 0; way < TB_JMP_CACHE_WAYS; way++) {
+        tb = qatomic_read(&jc->array[hash][way].tb);
+        if (likely(tb &&
+                   jc->array[hash][way].pc == pc &&
+                   tb->cs_base == cs_base &&
+                   tb->flags == flags &&
+                   tb_cflags(tb) == cflags)) {
+            if (way != 0) {
+                /* Keep the set in LRU order: move the hit to way 0. */
+                TranslationBlock *tb0 = qatomic_read(&jc->array[hash][0].tb);
+                vaddr pc0 = jc->array[hash][0].pc;
+
+                jc->array[hash][way].pc = pc0;
+                qatomic_set(&jc->array[hash][way].tb, tb0);
+                jc->array[hash][0].pc = pc;
+                qatomic_set(&jc->array[hash][0].tb, tb);
+            }
+            goto hit;
+        }
     }
 
     tb = tb_htable_lookup(cpu, pc, cs_base, flags, cflags);
@@ -258,8 +270,7 @@ static inline TranslationBlock *tb_lookup(CPUState *cpu, vaddr pc,
         return NULL;
     }
 
-    jc->array[hash].pc = pc;
-    qatomic_set(&jc->array[hash].tb, tb);
+    tb_jmp_cache_set(jc, hash, tb, pc);
 
 hit:
     /*
@@ -400,6 +411,9 @@ const void *HELPER(lookup_tb_ptr)(CPUArchState *env)
     cpu->neg.can_do_io = true;
     cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
 
+    /* Overlap the jump cache set load with the breakpoint check below. */
+    __builtin_prefetch(&cpu->tb_jmp_cache->array[tb_jmp_cache_hash_func(pc)]);
+
     cflags = curr_cflags(cpu);
     if (check_for_breakpoints(cpu, pc, &cflags)) {
         cpu_loop_exit(cpu);
@@ -960,6 +974,9 @@ cpu_exec_loop(CPUState *cpu, SyncClocks *sc)
 
             cpu_get_tb_cpu_state(cpu_env(cpu), &pc, &cs_base, &flags);
 
+            /* Overlap the jump cache set load with the cflags handling. */
+            __builtin_prefetch(&cpu->tb_jmp_cache->array[tb_jmp_cache_hash_func(pc)]);
+
             /*
              * When requested, use an exact setting for cflags for the next
              * execution.  This is used for icount, precise smc, and stop-
@@ -993,8 +1010,7 @@ cpu_exec_loop(CPUState *cpu, SyncClocks *sc)
                  */
                 h = tb_jmp_cache_hash_func(pc);
                 jc = cpu->tb_jmp_cache;
-                jc->array[h].pc = pc;
-                qatomic_set(&jc->array[h].tb, tb);
+                tb_jmp_cache_set(jc, h, tb, pc);
             }
 
 #ifndef CONFIG_USER_ONLY
@@ -37,6 +37,7 @@
 #include "exec/helper-proto-common.h"
 #include "qemu/atomic.h"
 #include "qemu/atomic128.h"
+#include "qemu/counter.h"
 #include "tb-internal.h"
 #include "trace.h"
 #include "tb-hash.h"
@@ -154,7 +155,9 @@ static void tb_jmp_cache_clear_page(CPUState *cpu, vaddr page_addr)
 
     i0 = tb_jmp_cache_hash_page(page_addr);
     for (i = 0; i < TB_JMP_PAGE_SIZE; i++) {
-        qatomic_set(&jc->array[i0 + i].tb, NULL);
+        for (int way = 0; way < TB_JMP_CACHE_WAYS; way++) {
+            qatomic_set(&jc->array[i0 + i][way].tb, NULL);
+        }
     }
 }
 
@@ -279,6 +282,7 @@ static void tlb_mmu_flush_locked(CPUTLBDesc *desc, CPUTLBDescFast *fast)
     desc->large_page_addr = -1;
     desc->large_page_mask = -1;
     desc->vindex = 0;
+    desc->vactive = false;
     memset(fast->table, -1, sizeof_tlb(fast));
     memset(desc->vtable, -1, sizeof(desc->vtable));
 }
@@ -1008,6 +1012,8 @@ static inline void tlb_set_compare(CPUTLBEntryFull *full, CPUTLBEntry *ent,
     full->slow_flags[access_type] = flags;
 }
 
+QEMU_COUNTER_DEFINE(tlb_fill_counter, "tlb-fill")
+
 /*
  * Add a new TLB entry. At most one entry for a given virtual address
  * is permitted. Only a single TARGET_PAGE_SIZE region is mapped, the
@@ -1031,6 +1037,7 @@ void tlb_set_page_full(CPUState *cpu, int mmu_idx,
     bool is_ram, is_romd;
 
     assert_cpu_is_self(cpu);
+    qemu_counter_inc(&tlb_fill_counter);
 
     if (full->lg_page_size <= TARGET_PAGE_BITS) {
         sz = TARGET_PAGE_SIZE;
@@ -1129,6 +1136,7 @@ void tlb_set_page_full(CPUState *cpu, int mmu_idx,
         /* Evict the old entry into the victim tlb.  */
         copy_tlb_helper_locked(tv, te);
         desc->vfulltlb[vidx] = desc->fulltlb[index];
+        desc->vactive = true;
         tlb_n_used_entries_dec(cpu, mmu_idx);
     }
 
@@ -1175,6 +1183,7 @@ void tlb_set_page_full(CPUState *cpu, int mmu_idx,
 
     copy_tlb_helper_locked(te, &tn);
     tlb_n_used_entries_inc(cpu, mmu_idx);
+    qatomic_set(&desc->n_fills, desc->n_fills + 1);
     qemu_spin_unlock(&tlb->c.lock);
 }
 
@@ -1304,6 +1313,9 @@ static bool victim_tlb_hit(CPUState *cpu, size_t mmu_idx, size_t index,
     size_t vidx;
 
     assert_cpu_is_self(cpu);
+    if (!cpu->neg.tlb.d[mmu_idx].vactive) {
+        return false;
+    }
     for (vidx = 0; vidx < CPU_VTLB_SIZE; ++vidx) {
         CPUTLBEntry *vtlb = &cpu->neg.tlb.d[mmu_idx].vtable[vidx];
         uint64_t cmp = tlb_read_idx(vtlb, access_type);
@@ -1859,10 +1871,16 @@ static void *atomic_mmu_lookup(CPUState *cpu, vaddr addr, MemOpIdx oi,
         /*
          * We get here if guest alignment was not requested, or was not
          * enforced by cpu_unaligned_access or tlb_fill_align above.
-         * We might widen the access and emulate, but for now
-         * mark an exception and exit the cpu loop.
+         * If the access is contained within a single atomic granule,
+         * the helpers widen it to a compare-and-swap of the granule;
+         * an access that crosses a granule has no host primitive and
+         * must still be restarted in exclusive mode.
          */
-        goto stop_the_world;
+        int gran = HAVE_CMPXCHG128 ? 16 : HAVE_al8 ? 8 : 1;
+
+        if ((addr & (gran - 1)) + size > gran) {
+            goto stop_the_world;
+        }
     }
 
     /* Collect tlb flags for read. */
@@ -1929,7 +1947,7 @@ static void *atomic_mmu_lookup(CPUState *cpu, vaddr addr, MemOpIdx oi,
  * @size: number of bytes
  * @mmu_idx: virtual address context
  * @ra: return address into tcg generated code, or 0
- * Context: BQL held
+ * Context: BQL held, unless the region allows lockless access
  *
  * Load @size bytes from @addr, which is memory-mapped i/o.
  * The bytes are concatenated in big-endian order with @ret_be.
@@ -1976,6 +1994,8 @@ static uint64_t do_ld_mmio_beN(CPUState *cpu, CPUTLBEntryFull *full,
     MemoryRegion *mr;
     hwaddr mr_offset;
     MemTxAttrs attrs;
+    bool release_lock;
+    uint64_t ret;
 
     tcg_debug_assert(size > 0 && size <= 8);
 
@@ -1983,9 +2003,13 @@ static uint64_t do_ld_mmio_beN(CPUState *cpu, CPUTLBEntryFull *full,
     section = io_prepare(&mr_offset, cpu, full->xlat_section, attrs, addr, ra);
     mr = section->mr;
 
-    BQL_LOCK_GUARD();
-    return int_ld_mmio_beN(cpu, full, ret_be, addr, size, mmu_idx,
-                           type, ra, mr, mr_offset);
+    release_lock = prepare_mmio_access(mr);
+    ret = int_ld_mmio_beN(cpu, full, ret_be, addr, size, mmu_idx,
+                          type, ra, mr, mr_offset);
+    if (release_lock) {
+        bql_unlock();
+    }
+    return ret;
 }
 
 static Int128 do_ld16_mmio_beN(CPUState *cpu, CPUTLBEntryFull *full,
@@ -1996,6 +2020,7 @@ static Int128 do_ld16_mmio_beN(CPUState *cpu, CPUTLBEntryFull *full,
     MemoryRegion *mr;
     hwaddr mr_offset;
     MemTxAttrs attrs;
+    bool release_lock;
     uint64_t a, b;
 
     tcg_debug_assert(size > 8 && size <= 16);
@@ -2004,11 +2029,14 @@ static Int128 do_ld16_mmio_beN(CPUState *cpu, CPUTLBEntryFull *full,
     section = io_prepare(&mr_offset, cpu, full->xlat_section, attrs, addr, ra);
     mr = section->mr;
 
-    BQL_LOCK_GUARD();
+    release_lock = prepare_mmio_access(mr);
     a = int_ld_mmio_beN(cpu, full, ret_be, addr, size - 8, mmu_idx,
                         MMU_DATA_LOAD, ra, mr, mr_offset);
     b = int_ld_mmio_beN(cpu, full, ret_be, addr + size - 8, 8, mmu_idx,
                         MMU_DATA_LOAD, ra, mr, mr_offset + size - 8);
+    if (release_lock) {
+        bql_unlock();
+    }
     return int128_make128(b, a);
 }
 
@@ -2469,7 +2497,7 @@ static Int128 do_ld16_mmu(CPUState *cpu, vaddr addr,
  * @size: number of bytes
  * @mmu_idx: virtual address context
  * @ra: return address into tcg generated code, or 0
- * Context: BQL held
+ * Context: BQL held, unless the region allows lockless access
  *
  * Store @size bytes at @addr, which is memory-mapped i/o.
  * The bytes to store are extracted in little-endian order from @val_le;
@@ -2517,6 +2545,8 @@ static uint64_t do_st_mmio_leN(CPUState *cpu, CPUTLBEntryFull *full,
     hwaddr mr_offset;
     MemoryRegion *mr;
     MemTxAttrs attrs;
+    bool release_lock;
+    uint64_t ret;
 
     tcg_debug_assert(size > 0 && size <= 8);
 
@@ -2524,9 +2554,13 @@ static uint64_t do_st_mmio_leN(CPUState *cpu, CPUTLBEntryFull *full,
     section = io_prepare(&mr_offset, cpu, full->xlat_section, attrs, addr, ra);
     mr = section->mr;
 
-    BQL_LOCK_GUARD();
-    return int_st_mmio_leN(cpu, full, val_le, addr, size, mmu_idx,
-                           ra, mr, mr_offset);
+    release_lock = prepare_mmio_access(mr);
+    ret = int_st_mmio_leN(cpu, full, val_le, addr, size, mmu_idx,
+                          ra, mr, mr_offset);
+    if (release_lock) {
+        bql_unlock();
+    }
+    return ret;
 }
 
 static uint64_t do_st16_mmio_leN(CPUState *cpu, CPUTLBEntryFull *full,
@@ -2537,6 +2571,8 @@ static uint64_t do_st16_mmio_leN(CPUState *cpu, CPUTLBEntryFull *full,
     MemoryRegion *mr;
     hwaddr mr_offset;
     MemTxAttrs attrs;
+    bool release_lock;
+    uint64_t ret;
 
     tcg_debug_assert(size > 8 && size <= 16);
 
@@ -2544,11 +2580,15 @@ static uint64_t do_st16_mmio_leN(CPUState *cpu, CPUTLBEntryFull *full,
     section = io_prepare(&mr_offset, cpu, full->xlat_section, attrs, addr, ra);
     mr = section->mr;
 
-    BQL_LOCK_GUARD();
+    release_lock = prepare_mmio_access(mr);
     int_st_mmio_leN(cpu, full, int128_getlo(val_le), addr, 8,
                     mmu_idx, ra, mr, mr_offset);
-    return int_st_mmio_leN(cpu, full, int128_gethi(val_le), addr + 8,
-                           size - 8, mmu_idx, ra, mr, mr_offset + 8);
+    ret = int_st_mmio_leN(cpu, full, int128_gethi(val_le), addr + 8,
+                          size - 8, mmu_idx, ra, mr, mr_offset + 8);
+    if (release_lock) {
+        bql_unlock();
+    }
+    return ret;
 }
 
 /*
@@ -17,6 +17,8 @@ extern int64_t max_advance;
 
 extern bool one_insn_per_tb;
 
+extern bool tb_exec_stats;
+
 extern bool icount_align_option;
 
 /*
@@ -28,6 +30,17 @@ static inline bool cpu_in_serial_context(CPUState *cs)
     return !tcg_cflags_has(cs, CF_PARALLEL) || cpu_in_exclusive_context(cs);
 }
 
+/**
+ * tb_flush_region() - recycle one code-gen region
+ * @cs: CPUState of the vCPU that failed to allocate a TB
+ *
+ * Like tb_flush(), but only invalidates the TBs of a single code-gen
+ * region when one can be recycled, so that code-cache pressure from one
+ * vCPU does not discard every other vCPU's translations.  Falls back to
+ * a full flush when the buffer is undivided or all regions are in use.
+ */
+void tb_flush_region(CPUState *cs);
+
 /**
  * cpu_plugin_mem_cbs_enabled() - are plugin memory callbacks enabled?
  * @cs: CPUState pointer
@@ -49,7 +62,7 @@ TranslationBlock *tb_gen_code(CPUState *cpu, vaddr pc,
                               uint64_t cs_base, uint32_t flags,
                               int cflags);
 void page_init(void);
-void tb_htable_init(void);
+void tb_htable_init(unsigned size);
 void tb_reset_jump(TranslationBlock *tb, int n);
 TranslationBlock *tb_link_page(TranslationBlock *tb);
 void cpu_restore_state_from_tb(CPUState *cpu, TranslationBlock *tb,
@@ -13,6 +13,7 @@
 #include "qapi/type-helpers.h"
 #include "qapi/qapi-commands-machine.h"
 #include "monitor/monitor.h"
+#include "hw/core/cpu.h"
 #include "system/cpu-timers.h"
 #include "system/tcg.h"
 #include "tcg/tcg.h"
@@ -140,6 +141,18 @@ static void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide)
     *pelide = elide;
 }
 
+static void tlb_fill_counts(size_t fills[NB_MMU_MODES])
+{
+    CPUState *cpu;
+    int i;
+
+    CPU_FOREACH(cpu) {
+        for (i = 0; i < NB_MMU_MODES; i++) {
+            fills[i] += qatomic_read(&cpu->neg.tlb.d[i].n_fills);
+        }
+    }
+}
+
 static void tcg_dump_info(GString *buf)
 {
     g_string_append_printf(buf, "[TCG profiler not compiled]\n");
@@ -150,6 +163,8 @@ static void dump_exec_info(GString *buf)
     struct tb_tree_stats tst = {};
     struct qht_stats hst;
     size_t nb_tbs, flush_full, flush_part, flush_elide;
+    size_t tlb_fills[NB_MMU_MODES] = {};
+    int i;
 
     tcg_tb_foreach(tb_tree_stats_iter, &tst);
     nb_tbs = tst.nb_tbs;
@@ -195,6 +210,14 @@ static void dump_exec_info(GString *buf)
     g_string_append_printf(buf, "TLB full flushes    %zu\n", flush_full);
     g_string_append_printf(buf, "TLB partial flushes %zu\n", flush_part);
     g_string_append_printf(buf, "TLB elided flushes  %zu\n", flush_elide);
+
+    tlb_fill_counts(tlb_fills);
+    for (i = 0; i < NB_MMU_MODES; i++) {
+        if (tlb_fills[i]) {
+            g_string_append_printf(buf, "TLB fills (idx %2d)  %zu\n",
+                                   i, tlb_fills[i]);
+        }
+    }
     tcg_dump_info(buf);
 }
 
@@ -214,6 +237,189 @@ HumanReadableText *qmp_x_query_jit(Error **errp)
     return human_readable_text_from_str(buf);
 }
 
+/* Number of entries reported by x-query-hottb */
+#define HOT_TB_MAX      32
+
+struct hot_tb_entry {
+    vaddr pc;
+    uint16_t size;
+    uint64_t exec_count;
+};
+
+static gboolean hot_tb_iter(gpointer key, gpointer value, gpointer data)
+{
+    const TranslationBlock *tb = value;
+    GArray *array = data;
+    struct hot_tb_entry ent = {
+        /* With CF_PCREL tb->pc is not valid; report the physical page */
+        .pc = (tb->cflags & CF_PCREL) ? tb->page_addr[0] : tb->pc,
+        .size = tb->size,
+        .exec_count = tb->exec_count,
+    };
+
+    if (ent.exec_count) {
+        g_array_append_val(array, ent);
+    }
+    return false;
+}
+
+static gint hot_tb_cmp(gconstpointer a, gconstpointer b)
+{
+    const struct hot_tb_entry *ea = a;
+    const struct hot_tb_entry *eb = b;
+
+    if (ea->exec_count != eb->exec_count) {
+        return ea->exec_count < eb->exec_count ? 1 : -1;
+    }
+    return 0;
+}
+
+HumanReadableText *qmp_x_query_hottb(Error **errp)
+{
+    g_autoptr(GString) buf = g_string_new("");
+    g_autoptr(GArray) array = NULL;
+    int i, n;
+
+    if (!tcg_enabled()) {
+        error_setg(errp, "Hot TB information is only available with accel=tcg");
+        return NULL;
+    }
+    if (!qatomic_read(&tb_exec_stats)) {
+        error_setg(errp, "TB execution counters are disabled; "
+                   "enable with -accel tcg,tb-exec-stats=on");
+        return NULL;
+    }
+
+    array = g_array_new(false, false, sizeof(struct hot_tb_entry));
+    tcg_tb_foreach(hot_tb_iter, array);
+    g_array_sort(array, hot_tb_cmp);
+
+    n = MIN(array->len, HOT_TB_MAX);
+    g_string_append_printf(buf, "Hottest TBs (%d of %u, counts since last"
+                           " code cache flush):\n", n, array->len);
+    for (i = 0; i < n; i++) {
+        struct hot_tb_entry *ent = &g_array_index(array, struct hot_tb_entry, i);
+
+        g_string_append_printf(buf,
+                               "%2d: pc=0x%016" PRIx64 " size=%-5u"
+                               " count=%" PRIu64 "\n",
+                               i + 1, (uint64_t)ent->pc, ent->size,
+                               ent->exec_count);
+    }
+
+    return human_readable_text_from_str(buf);
+}
+
+/*
+ * cpu->watchpoints is walked by the owning vCPU during execution
+ * without taking the BQL, so the monitor must not mutate the list
+ * behind its back.  Run insertions and removals on the target vCPU's
+ * own thread instead: queued work only executes between translation
+ * blocks, when the vCPU cannot be in the middle of a list walk.
+ */
+typedef struct WatchvarArgs {
+    uint64_t addr;
+    uint64_t len;
+    int flags;
+    bool found;
+} WatchvarArgs;
+
+static void watchvar_insert_on_cpu(CPUState *cpu, run_on_cpu_data data)
+{
+    WatchvarArgs *args = data.host_ptr;
+
+    cpu_watchpoint_insert(cpu, args->addr, args->len, args->flags, NULL);
+}
+
+void qmp_x_watchvar_set(uint64_t addr, uint64_t len,
+                        bool has_cpu_index, int64_t cpu_index,
+                        bool has_on_read, bool on_read,
+                        bool has_on_write, bool on_write,
+                        Error **errp)
+{
+    WatchvarArgs args = { .addr = addr, .len = len };
+    CPUState *cpu;
+
+    if (!tcg_enabled()) {
+        error_setg(errp, "Light watches are only available with accel=tcg");
+        return;
+    }
+    args.flags = BP_WATCHPOINT_LOG;
+    if (has_on_read && on_read) {
+        args.flags |= BP_MEM_READ;
+    }
+    if (!has_on_write || on_write) {
+        args.flags |= BP_MEM_WRITE;
+    }
+    if (!(args.flags & BP_MEM_ACCESS)) {
+        error_setg(errp, "at least one of on-read and on-write must be true");
+        return;
+    }
+    /* Same check as cpu_watchpoint_insert(), so that it cannot fail */
+    if (len == 0 || addr + len - 1 < addr) {
+        error_setg(errp, "invalid watch range");
+        return;
+    }
+
+    if (has_cpu_index) {
+        cpu = qemu_get_cpu(cpu_index);
+        if (!cpu) {
+            error_setg(errp, "no CPU with index %" PRId64, cpu_index);
+            return;
+        }
+        run_on_cpu(cpu, watchvar_insert_on_cpu, RUN_ON_CPU_HOST_PTR(&args));
+        return;
+    }
+
+    CPU_FOREACH(cpu) {
+        run_on_cpu(cpu, watchvar_insert_on_cpu, RUN_ON_CPU_HOST_PTR(&args));
+    }
+}
+
+static void watchvar_remove_on_cpu(CPUState *cpu, run_on_cpu_data data)
+{
+    WatchvarArgs *args = data.host_ptr;
+    CPUWatchpoint *wp, *next;
+
+    QTAILQ_FOREACH_SAFE(wp, &cpu->watchpoints, entry, next) {
+        if ((wp->flags & BP_WATCHPOINT_LOG) &&
+            wp->vaddr == args->addr && wp->len == args->len) {
+            cpu_watchpoint_remove_by_ref(cpu, wp);
+            args->found = true;
+        }
+    }
+}
+
+void qmp_x_watchvar_remove(uint64_t addr, uint64_t len,
+                           bool has_cpu_index, int64_t cpu_index,
+                           Error **errp)
+{
+    WatchvarArgs args = { .addr = addr, .len = len };
+    CPUState *cpu;
+
+    if (!tcg_enabled()) {
+        error_setg(errp, "Light watches are only available with accel=tcg");
+        return;
+    }
+
+    if (has_cpu_index) {
+        cpu = qemu_get_cpu(cpu_index);
+        if (!cpu) {
+            error_setg(errp, "no CPU with index %" PRId64, cpu_index);
+            return;
+        }
+        run_on_cpu(cpu, watchvar_remove_on_cpu, RUN_ON_CPU_HOST_PTR(&args));
+    } else {
+        CPU_FOREACH(cpu) {
+            run_on_cpu(cpu, watchvar_remove_on_cpu, RUN_ON_CPU_HOST_PTR(&args));
+        }
+    }
+    if (!args.found) {
+        error_setg(errp, "no light watch at 0x%" PRIx64 "/%" PRIu64,
+                   addr, len);
+    }
+}
+
 static void tcg_dump_op_count(GString *buf)
 {
     g_string_append_printf(buf, "[TCG profiler not compiled]\n");
@@ -238,6 +444,7 @@ static void hmp_tcg_register(void)
 {
     monitor_register_hmp_info_hrt("jit", qmp_x_query_jit);
     monitor_register_hmp_info_hrt("opcount", qmp_x_query_opcount);
+    monitor_register_hmp_info_hrt("hottb", qmp_x_query_hottb);
 }
 
 type_init(hmp_tcg_register);
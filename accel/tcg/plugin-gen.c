@@ -221,6 +221,27 @@ static void gen_mem_cb(struct qemu_plugin_regular_cb *cb,
     tcg_temp_free_i32(cpu_index);
 }
 
+static void gen_mem_filter_cb(struct qemu_plugin_mem_filter_cb *cb,
+                              qemu_plugin_meminfo_t meminfo, TCGv_i64 addr)
+{
+    TCGLabel *after_cb = gen_new_label();
+    TCGv_i64 off = tcg_temp_ebb_new_i64();
+
+    /* A single unsigned compare tests lo <= addr < hi. */
+    tcg_gen_subi_i64(off, addr, cb->lo);
+    tcg_gen_brcondi_i64(TCG_COND_GEU, off, cb->hi - cb->lo, after_cb);
+    TCGv_i32 cpu_index = gen_cpu_index();
+    tcg_gen_call4(cb->f.vcpu_mem, cb->info, NULL,
+                  tcgv_i32_temp(cpu_index),
+                  tcgv_i32_temp(tcg_constant_i32(meminfo)),
+                  tcgv_i64_temp(addr),
+                  tcgv_ptr_temp(tcg_constant_ptr(cb->userp)));
+    tcg_temp_free_i32(cpu_index);
+    gen_set_label(after_cb);
+
+    tcg_temp_free_i64(off);
+}
+
 static void inject_cb(struct qemu_plugin_dyn_cb *cb)
 
 {
@@ -252,6 +273,11 @@ static void inject_mem_cb(struct qemu_plugin_dyn_cb *cb,
             gen_mem_cb(&cb->regular, meminfo, addr);
         }
         break;
+    case PLUGIN_CB_MEM_FILTER:
+        if (rw & cb->mem_filter.rw) {
+            gen_mem_filter_cb(&cb->mem_filter, meminfo, addr);
+        }
+        break;
     case PLUGIN_CB_INLINE_ADD_U64:
     case PLUGIN_CB_INLINE_STORE_U64:
         if (rw & cb->inline_insn.rw) {
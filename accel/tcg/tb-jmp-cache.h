@@ -9,11 +9,13 @@
 #ifndef ACCEL_TCG_TB_JMP_CACHE_H
 #define ACCEL_TCG_TB_JMP_CACHE_H
 
+#include "qemu/atomic.h"
 #include "qemu/rcu.h"
 #include "exec/cpu-common.h"
 
 #define TB_JMP_CACHE_BITS 12
 #define TB_JMP_CACHE_SIZE (1 << TB_JMP_CACHE_BITS)
+#define TB_JMP_CACHE_WAYS 2
 
 /*
  * Invalidated in parallel; all accesses to 'tb' must be atomic.
@@ -21,13 +23,42 @@
  * no need for qatomic_rcu_read() and pc is always consistent with a
  * non-NULL value of 'tb'.  Strictly speaking pc is only needed for
  * CF_PCREL, but it's used always for simplicity.
+ *
+ * Each set holds TB_JMP_CACHE_WAYS entries in LRU order: way 0 is the
+ * most recently used.  Two ways are enough to stop the ping-pong
+ * eviction seen with guests whose working set of translation blocks
+ * does not fit a direct-mapped table.
  */
 typedef struct CPUJumpCache {
     struct rcu_head rcu;
     struct {
         TranslationBlock *tb;
         vaddr pc;
-    } array[TB_JMP_CACHE_SIZE];
+    } array[TB_JMP_CACHE_SIZE][TB_JMP_CACHE_WAYS];
 } CPUJumpCache;
 
+/**
+ * tb_jmp_cache_set:
+ * @jc: jump cache of the CPU performing the lookup
+ * @hash: set index for @pc
+ * @tb: translation block to record
+ * @pc: guest PC of @tb
+ *
+ * Record @tb as the most recently used entry of its set, evicting
+ * the LRU way.  Only the owning CPU may call this; concurrent
+ * invalidation of a demoted entry may be lost, which is benign
+ * because the entry fails the cflags check on its next lookup.
+ */
+static inline void tb_jmp_cache_set(CPUJumpCache *jc, uint32_t hash,
+                                    TranslationBlock *tb, vaddr pc)
+{
+    for (int way = TB_JMP_CACHE_WAYS - 1; way > 0; way--) {
+        jc->array[hash][way].pc = jc->array[hash][way - 1].pc;
+        qatomic_set(&jc->array[hash][way].tb,
+                    qatomic_read(&jc->array[hash][way - 1].tb));
+    }
+    jc->array[hash][0].pc = pc;
+    qatomic_set(&jc->array[hash][0].tb, tb);
+}
+
 #endif /* ACCEL_TCG_TB_JMP_CACHE_H */
@@ -18,6 +18,8 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/bitops.h"
+#include "qemu/counter.h"
 #include "qemu/interval-tree.h"
 #include "qemu/qtree.h"
 #include "exec/cputlb.h"
@@ -60,11 +62,22 @@ static bool tb_cmp(const void *ap, const void *bp)
             tb_page_addr1(a) == tb_page_addr1(b));
 }
 
-void tb_htable_init(void)
+/*
+ * Initial (and post-flush) size of the TB hash table.  Overridable via
+ * the "tb-htable-size" accelerator property, so that short-lived guests
+ * with a known translation footprint do not pay for the incremental
+ * resizes that QHT_MODE_AUTO_RESIZE would otherwise perform during boot.
+ */
+static unsigned tb_htable_size = CODE_GEN_HTABLE_SIZE;
+
+void tb_htable_init(unsigned size)
 {
     unsigned int mode = QHT_MODE_AUTO_RESIZE;
 
-    qht_init(&tb_ctx.htable, tb_cmp, CODE_GEN_HTABLE_SIZE, mode);
+    if (size) {
+        tb_htable_size = pow2ceil(size);
+    }
+    qht_init(&tb_ctx.htable, tb_cmp, tb_htable_size, mode);
 }
 
 typedef struct PageDesc PageDesc;
@@ -187,8 +200,27 @@ struct PageDesc {
     QemuSpin lock;
     /* list of TBs intersecting this ram page */
     uintptr_t first_tb;
+    /*
+     * Bitmap of the page in 64 granules: a bit is set if any TB covers
+     * part of the granule.  Bits are set when a TB is added and only
+     * cleared when the last TB on the page is removed, so the bitmap is
+     * a superset of the code actually present.  This lets a write to a
+     * still-protected page skip the walk of first_tb when it cannot
+     * possibly overlap translated code.
+     */
+    uint64_t code_granules;
 };
 
+/* Bitmap of granules covered by the sub-page range [@start, @last]. */
+static uint64_t page_code_granules(tb_page_addr_t start, tb_page_addr_t last)
+{
+    int shift = TARGET_PAGE_BITS - 6;
+    unsigned first = (start & ~TARGET_PAGE_MASK) >> shift;
+    unsigned count = ((last & ~TARGET_PAGE_MASK) >> shift) - first + 1;
+
+    return MAKE_64BIT_MASK(first, count);
+}
+
 void page_table_config_init(void)
 {
     uint32_t v_l1_bits;
@@ -668,6 +700,7 @@ static void tb_remove_all_1(int level, void **lp)
         for (i = 0; i < V_L2_SIZE; ++i) {
             page_lock(&pd[i]);
             pd[i].first_tb = (uintptr_t)NULL;
+            pd[i].code_granules = 0;
             page_unlock(&pd[i]);
         }
     } else {
@@ -694,6 +727,8 @@ static void tb_remove_all(void)
  */
 static void tb_page_add(PageDesc *p, TranslationBlock *tb, unsigned int n)
 {
+    tb_page_addr_t tb_start = tb_page_addr0(tb);
+    tb_page_addr_t tb_last = tb_start + tb->size - 1;
     bool page_already_protected;
 
     assert_page_locked(p);
@@ -702,6 +737,15 @@ static void tb_page_add(PageDesc *p, TranslationBlock *tb, unsigned int n)
     page_already_protected = p->first_tb != 0;
     p->first_tb = (uintptr_t)tb | n;
 
+    /* Record the granules covered by the portion of the TB on this page. */
+    if (n == 0) {
+        tb_last = MIN(tb_last, tb_start | ~TARGET_PAGE_MASK);
+    } else {
+        tb_start = tb_page_addr1(tb);
+        tb_last = tb_start + (tb_last & ~TARGET_PAGE_MASK);
+    }
+    p->code_granules |= page_code_granules(tb_start, tb_last);
+
     /*
      * If some code is already present, then the pages are already
      * protected. So we handle the case where only the first TB is
@@ -737,6 +781,9 @@ static void tb_page_remove(PageDesc *pd, TranslationBlock *tb)
     PAGE_FOR_EACH_TB(unused, unused, pd, tb1, n1) {
         if (tb1 == tb) {
             *pprev = tb1->page_next[n1];
+            if (!pd->first_tb) {
+                pd->code_granules = 0;
+            }
             return;
         }
         pprev = &tb1->page_next[n1];
@@ -775,7 +822,7 @@ static void do_tb_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
         tcg_flush_jmp_cache(cpu);
     }
 
-    qht_reset_size(&tb_ctx.htable, CODE_GEN_HTABLE_SIZE);
+    qht_reset_size(&tb_ctx.htable, tb_htable_size);
     tb_remove_all();
 
     tcg_region_reset_all();
@@ -803,6 +850,62 @@ void tb_flush(CPUState *cpu)
     }
 }
 
+/*
+ * Flush only the TBs of one recycled code-gen region.  Runs in the
+ * requesting vCPU's thread, so tcg_ctx is the context that ran out of
+ * space and inherits the region.  All vCPUs are out of generated code
+ * here, which makes it safe to reuse the region's memory once its TBs
+ * are unlinked.
+ */
+static void do_tb_region_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
+{
+    GPtrArray *tbs = NULL;
+    unsigned i;
+
+    mmap_lock();
+    /* A full flush may have emptied the pool already; then just retry. */
+    if (tb_ctx.tb_flush_count == tb_flush_count.host_int) {
+        tbs = tcg_region_reclaim(tcg_ctx);
+    }
+    if (tbs) {
+        qemu_thread_jit_write();
+        for (i = 0; i < tbs->len; i++) {
+            TranslationBlock *tb = g_ptr_array_index(tbs, i);
+
+            tb_phys_invalidate(tb, -1);
+            tcg_tb_remove(tb);
+        }
+        qemu_thread_jit_execute();
+        g_ptr_array_free(tbs, true);
+        mmap_unlock();
+        return;
+    }
+    mmap_unlock();
+
+    /* Every region is being translated into: only a full flush helps. */
+    do_tb_flush(cpu, tb_flush_count);
+}
+
+/*
+ * Make room in the code cache when TB allocation fails.  Prefer
+ * recycling a single region, so that one context filling its region
+ * does not throw away every other vCPU's translations; fall back to
+ * tb_flush() semantics when the buffer is undivided or fully occupied.
+ */
+void tb_flush_region(CPUState *cpu)
+{
+    if (tcg_enabled()) {
+        unsigned tb_flush_count = qatomic_read(&tb_ctx.tb_flush_count);
+
+        if (cpu_in_serial_context(cpu)) {
+            do_tb_region_flush(cpu, RUN_ON_CPU_HOST_INT(tb_flush_count));
+        } else {
+            async_safe_run_on_cpu(cpu, do_tb_region_flush,
+                                  RUN_ON_CPU_HOST_INT(tb_flush_count));
+        }
+    }
+}
+
 /* remove @orig from its @n_orig-th jump list */
 static inline void tb_remove_from_jmp_list(TranslationBlock *orig, int n_orig)
 {
@@ -894,13 +997,17 @@ static void tb_jmp_cache_inval_tb(TranslationBlock *tb)
         CPU_FOREACH(cpu) {
             CPUJumpCache *jc = cpu->tb_jmp_cache;
 
-            if (qatomic_read(&jc->array[h].tb) == tb) {
-                qatomic_set(&jc->array[h].tb, NULL);
+            for (int way = 0; way < TB_JMP_CACHE_WAYS; way++) {
+                if (qatomic_read(&jc->array[h][way].tb) == tb) {
+                    qatomic_set(&jc->array[h][way].tb, NULL);
+                }
             }
         }
     }
 }
 
+QEMU_COUNTER_DEFINE(tb_invalidate_counter, "tb-invalidate")
+
 /*
  * In user-mode, call with mmap_lock held.
  * In !user-mode, if @rm_from_page_list is set, call with the TB's pages'
@@ -913,6 +1020,7 @@ static void do_tb_phys_invalidate(TranslationBlock *tb, bool rm_from_page_list)
     uint32_t orig_cflags = tb_cflags(tb);
 
     assert_memory_lock();
+    qemu_counter_inc(&tb_invalidate_counter);
 
     /* make sure no further incoming jumps will be chained to this TB */
     qemu_spin_lock(&tb->jmp_lock);
@@ -1114,6 +1222,16 @@ tb_invalidate_phys_page_range__locked(struct page_collection *pages,
     /* Range may not cross a page. */
     tcg_debug_assert(((start ^ last) & TARGET_PAGE_MASK) == 0);
 
+    /*
+     * If no granule that ever held translated code overlaps the written
+     * range, there is nothing to invalidate and no need to walk the TB
+     * list.  Do not take this exit when the page is empty, so that the
+     * !first_tb path below can unprotect the page.
+     */
+    if (p->first_tb && !(p->code_granules & page_code_granules(start, last))) {
+        return;
+    }
+
     /*
      * We remove all the TBs in the range [start, last].
      * XXX: see if in some cases it could be faster to invalidate all the code
@@ -48,8 +48,10 @@ struct TCGState {
 
     bool mttcg_enabled;
     bool one_insn_per_tb;
+    bool tb_exec_stats;
     int splitwx_enabled;
     unsigned long tb_size;
+    unsigned tb_htable_size;
 };
 typedef struct TCGState TCGState;
 
@@ -102,6 +104,7 @@ static void tcg_accel_instance_init(Object *obj)
 
 bool mttcg_enabled;
 bool one_insn_per_tb;
+bool tb_exec_stats;
 
 static int tcg_init_machine(MachineState *ms)
 {
@@ -116,7 +119,7 @@ static int tcg_init_machine(MachineState *ms)
     mttcg_enabled = s->mttcg_enabled;
 
     page_init();
-    tb_htable_init();
+    tb_htable_init(s->tb_htable_size);
     tcg_init(s->tb_size * MiB, s->splitwx_enabled, max_cpus);
 
 #if defined(CONFIG_SOFTMMU)
@@ -186,6 +189,30 @@ static void tcg_set_tb_size(Object *obj, Visitor *v,
     s->tb_size = value;
 }
 
+static void tcg_get_tb_htable_size(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value = s->tb_htable_size;
+
+    visit_type_uint32(v, name, &value, errp);
+}
+
+static void tcg_set_tb_htable_size(Object *obj, Visitor *v,
+                                   const char *name, void *opaque,
+                                   Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    uint32_t value;
+
+    if (!visit_type_uint32(v, name, &value, errp)) {
+        return;
+    }
+
+    s->tb_htable_size = value;
+}
+
 static bool tcg_get_splitwx(Object *obj, Error **errp)
 {
     TCGState *s = TCG_STATE(obj);
@@ -212,6 +239,20 @@ static void tcg_set_one_insn_per_tb(Object *obj, bool value, Error **errp)
     qatomic_set(&one_insn_per_tb, value);
 }
 
+static bool tcg_get_tb_exec_stats(Object *obj, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    return s->tb_exec_stats;
+}
+
+static void tcg_set_tb_exec_stats(Object *obj, bool value, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    s->tb_exec_stats = value;
+    /* Set the global also: this changes the behaviour */
+    qatomic_set(&tb_exec_stats, value);
+}
+
 static int tcg_gdbstub_supported_sstep_flags(void)
 {
     /*
@@ -247,6 +288,12 @@ static void tcg_accel_class_init(ObjectClass *oc, void *data)
     object_class_property_set_description(oc, "tb-size",
         "TCG translation block cache size");
 
+    object_class_property_add(oc, "tb-htable-size", "int",
+        tcg_get_tb_htable_size, tcg_set_tb_htable_size,
+        NULL, NULL);
+    object_class_property_set_description(oc, "tb-htable-size",
+        "Initial size of the translation block hash table");
+
     object_class_property_add_bool(oc, "split-wx",
         tcg_get_splitwx, tcg_set_splitwx);
     object_class_property_set_description(oc, "split-wx",
@@ -257,6 +304,12 @@ static void tcg_accel_class_init(ObjectClass *oc, void *data)
                                    tcg_set_one_insn_per_tb);
     object_class_property_set_description(oc, "one-insn-per-tb",
         "Only put one guest insn in each translation block");
+
+    object_class_property_add_bool(oc, "tb-exec-stats",
+                                   tcg_get_tb_exec_stats,
+                                   tcg_set_tb_exec_stats);
+    object_class_property_set_description(oc, "tb-exec-stats",
+        "Count executions of each translation block (see x-query-hottb)");
 }
 
 static const TypeInfo tcg_accel_type = {
@@ -17,6 +17,7 @@
 #include "exec/cpu_ldst.h"
 #include "exec/tswap.h"
 #include "tcg/tcg-op-common.h"
+#include "internal-common.h"
 #include "internal-target.h"
 #include "disas/disas.h"
 #include "tb-internal.h"
@@ -46,6 +47,23 @@ static TCGOp *gen_tb_start(DisasContextBase *db, uint32_t cflags)
     TCGv_i32 count = NULL;
     TCGOp *icount_start_insn = NULL;
 
+    if (qatomic_read(&tb_exec_stats)) {
+        /*
+         * Bump the block's execution counter.  The TB struct outlives
+         * its generated code, so embedding its address is safe; plain
+         * (non-atomic) load/add/store keeps the overhead down at the
+         * cost of approximate counts under MTTCG.
+         */
+        TCGv_ptr tb_ptr = tcg_constant_ptr(db->tb);
+        TCGv_i64 exec_count = tcg_temp_new_i64();
+
+        tcg_gen_ld_i64(exec_count, tb_ptr,
+                       offsetof(TranslationBlock, exec_count));
+        tcg_gen_addi_i64(exec_count, exec_count, 1);
+        tcg_gen_st_i64(exec_count, tb_ptr,
+                       offsetof(TranslationBlock, exec_count));
+    }
+
     if ((cflags & CF_USE_ICOUNT) || !(cflags & CF_NOIRQ)) {
         count = tcg_temp_new_i32();
         tcg_gen_ld_i32(count, tcg_env,
@@ -116,8 +134,24 @@ bool translator_use_goto_tb(DisasContextBase *db, vaddr dest)
         return false;
     }
 
-    /* Check for the dest on the same page as the start of the TB.  */
+#ifdef CONFIG_USER_ONLY
+    /*
+     * Without MMU indirection a direct link can never go stale through a
+     * remap: mmap/mprotect on an executable page invalidates its TBs
+     * (see page_set_flags), which unlinks any incoming direct jumps.
+     * So the destination page does not restrict linking here.
+     */
+    return true;
+#else
+    /*
+     * A direct link embeds a host address that is only valid for the
+     * virtual-to-physical mapping in effect when the link is made.  A
+     * jump to another page must be re-validated against the current
+     * mapping, which is what tcg_gen_lookup_and_goto_ptr() does, so
+     * only in-page destinations may use goto_tb.
+     */
     return translator_is_same_page(db, dest);
+#endif
 }
 
 void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
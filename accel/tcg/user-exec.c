@@ -1330,7 +1330,18 @@ static void *atomic_mmu_lookup(CPUState *cpu, vaddr addr, MemOpIdx oi,
 
     /* Enforce qemu required alignment.  */
     if (unlikely(addr & (size - 1))) {
-        cpu_loop_exit_atomic(cpu, retaddr);
+        /*
+         * If the access is contained within a single atomic granule,
+         * the helpers widen it to a compare-and-swap of the granule;
+         * an access that crosses a granule has no host primitive and
+         * must still be restarted in exclusive mode.  guest_base is
+         * page aligned, so host and guest granule offsets agree.
+         */
+        int gran = HAVE_CMPXCHG128 ? 16 : HAVE_al8 ? 8 : 1;
+
+        if ((addr & (gran - 1)) + size > gran) {
+            cpu_loop_exit_atomic(cpu, retaddr);
+        }
     }
 
     ret = g2h(cpu, addr);
@@ -28,6 +28,7 @@
 #include "accel/tcg/cpu-ops.h"
 #include "hw/core/cpu.h"
 #include "internal-common.h"
+#include "trace.h"
 
 /*
  * Return true if this watchpoint address matches the specified
@@ -56,6 +57,11 @@ int cpu_watchpoint_address_matches(CPUState *cpu, vaddr addr, vaddr len)
     CPUWatchpoint *wp;
     int ret = 0;
 
+    /* Compare against the union of all ranges before walking the list. */
+    if (addr > cpu->watchpoints_hi || addr + len - 1 < cpu->watchpoints_lo) {
+        return 0;
+    }
+
     QTAILQ_FOREACH(wp, &cpu->watchpoints, entry) {
         if (watchpoint_address_matches(wp, addr, len)) {
             ret |= wp->flags;
@@ -89,10 +95,32 @@ void cpu_check_watchpoint(CPUState *cpu, vaddr addr, vaddr len,
     }
 
     assert((flags & ~BP_MEM_ACCESS) == 0);
+
+    /*
+     * TLB_WATCHPOINT is set with page granularity, so most accesses on
+     * a watched page cannot hit.  Skip the walk (and the hit-flag
+     * bookkeeping, which only matters after a real hit) when the access
+     * cannot overlap any watchpoint.
+     */
+    if (addr > cpu->watchpoints_hi || addr + len - 1 < cpu->watchpoints_lo) {
+        return;
+    }
+
     QTAILQ_FOREACH(wp, &cpu->watchpoints, entry) {
         int hit_flags = wp->flags & flags;
 
         if (hit_flags && watchpoint_address_matches(wp, addr, len)) {
+            if (wp->flags & BP_WATCHPOINT_LOG) {
+                /*
+                 * Light watch: record the access in the trace stream
+                 * and continue.  No debug exception is raised and no
+                 * re-translation for exact CPU state is needed, so
+                 * the hit stays cheap.
+                 */
+                trace_watchpoint_log_hit(cpu->cpu_index, wp->vaddr, addr, len,
+                                         hit_flags);
+                continue;
+            }
             if (replay_running_debug()) {
                 /*
                  * replay_breakpoint reads icount.
@@ -97,53 +97,61 @@ static inline IN_T glue (clip_, ET) (int64_t v)
 }
 #endif
 
+/*
+ * The loops below are written as countable loops over restrict-qualified
+ * pointers so that the compiler can auto-vectorize them; the conversion
+ * is pure arithmetic per sample and the clip branches are if-convertible
+ * to min/max.  Keep them free of loop-carried state.
+ */
+
 static void glue (glue (conv_, ET), _to_stereo)
     (struct st_sample *dst, const void *src, int samples)
 {
-    struct st_sample *out = dst;
-    IN_T *in = (IN_T *) src;
+    struct st_sample *restrict out = dst;
+    const IN_T *restrict in = (const IN_T *) src;
+    int i;
 
-    while (samples--) {
-        out->l = glue (conv_, ET) (*in++);
-        out->r = glue (conv_, ET) (*in++);
-        out += 1;
+    for (i = 0; i < samples; i++) {
+        out[i].l = glue (conv_, ET) (in[2 * i + 0]);
+        out[i].r = glue (conv_, ET) (in[2 * i + 1]);
     }
 }
 
 static void glue (glue (conv_, ET), _to_mono)
     (struct st_sample *dst, const void *src, int samples)
 {
-    struct st_sample *out = dst;
-    IN_T *in = (IN_T *) src;
-
-    while (samples--) {
-        out->l = glue (conv_, ET) (in[0]);
-        out->r = out->l;
-        out += 1;
-        in += 1;
+    struct st_sample *restrict out = dst;
+    const IN_T *restrict in = (const IN_T *) src;
+    int i;
+
+    for (i = 0; i < samples; i++) {
+        out[i].l = glue (conv_, ET) (in[i]);
+        out[i].r = out[i].l;
     }
 }
 
 static void glue (glue (clip_, ET), _from_stereo)
     (void *dst, const struct st_sample *src, int samples)
 {
-    const struct st_sample *in = src;
-    IN_T *out = (IN_T *) dst;
-    while (samples--) {
-        *out++ = glue (clip_, ET) (in->l);
-        *out++ = glue (clip_, ET) (in->r);
-        in += 1;
+    const struct st_sample *restrict in = src;
+    IN_T *restrict out = (IN_T *) dst;
+    int i;
+
+    for (i = 0; i < samples; i++) {
+        out[2 * i + 0] = glue (clip_, ET) (in[i].l);
+        out[2 * i + 1] = glue (clip_, ET) (in[i].r);
     }
 }
 
 static void glue (glue (clip_, ET), _from_mono)
     (void *dst, const struct st_sample *src, int samples)
 {
-    const struct st_sample *in = src;
-    IN_T *out = (IN_T *) dst;
-    while (samples--) {
-        *out++ = glue (clip_, ET) (in->l + in->r);
-        in += 1;
+    const struct st_sample *restrict in = src;
+    IN_T *restrict out = (IN_T *) dst;
+    int i;
+
+    for (i = 0; i < samples; i++) {
+        out[i] = glue (clip_, ET) (in[i].l + in[i].r);
     }
 }
 
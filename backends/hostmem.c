@@ -34,6 +34,11 @@ QEMU_BUILD_BUG_ON(HOST_MEM_POLICY_DEFAULT != MPOL_DEFAULT);
 QEMU_BUILD_BUG_ON(HOST_MEM_POLICY_PREFERRED != MPOL_PREFERRED);
 QEMU_BUILD_BUG_ON(HOST_MEM_POLICY_BIND != MPOL_BIND);
 QEMU_BUILD_BUG_ON(HOST_MEM_POLICY_INTERLEAVE != MPOL_INTERLEAVE);
+/*
+ * HOST_MEM_POLICY_PREFERRED_MANY does not match MPOL_PREFERRED_MANY
+ * numerically (the kernel put MPOL_LOCAL in between) and is translated
+ * explicitly before the mbind() call.
+ */
 #endif
 
 char *
@@ -159,6 +164,31 @@ host_memory_backend_set_policy(Object *obj, int policy, Error **errp)
 #endif
 }
 
+static bool host_memory_backend_get_numa_stripe(Object *obj, Error **errp)
+{
+    HostMemoryBackend *backend = MEMORY_BACKEND(obj);
+
+    return backend->numa_stripe;
+}
+
+static void host_memory_backend_set_numa_stripe(Object *obj, bool value,
+                                                Error **errp)
+{
+#ifdef CONFIG_NUMA
+    HostMemoryBackend *backend = MEMORY_BACKEND(obj);
+
+    if (host_memory_backend_mr_inited(backend)) {
+        error_setg(errp, "cannot change property value");
+        return;
+    }
+    backend->numa_stripe = value;
+#else
+    if (value) {
+        error_setg(errp, "NUMA node binding are not supported by this QEMU");
+    }
+#endif
+}
+
 static bool host_memory_backend_get_merge(Object *obj, Error **errp)
 {
     HostMemoryBackend *backend = MEMORY_BACKEND(obj);
@@ -388,6 +418,11 @@ host_memory_backend_memory_complete(UserCreatable *uc, Error **errp)
         return;
     }
 
+    if (backend->numa_stripe && backend->policy != MPOL_BIND) {
+        error_setg(errp, "numa-stripe requires policy 'bind'");
+        return;
+    }
+
     /*
      * We can have up to MAX_NODES nodes, but we need to pass maxnode+1
      * as argument to mbind() due to an old Linux bug (feature?) which
@@ -408,6 +443,62 @@ host_memory_backend_memory_complete(UserCreatable *uc, Error **errp)
     }
 #endif
 
+    if (backend->policy == HOST_MEM_POLICY_PREFERRED_MANY) {
+#ifdef HAVE_NUMA_HAS_PREFERRED_MANY
+        if (numa_has_preferred_many() > 0) {
+            mode = MPOL_PREFERRED_MANY;
+        } else
+#endif
+        {
+            error_setg(errp, "policy 'preferred-many' is not supported by"
+                       " this host kernel");
+            return;
+        }
+    }
+
+    if (maxnode && backend->numa_stripe) {
+        /*
+         * Stripe the region across the host nodes in equal contiguous
+         * chunks, one node per chunk, so that a single backend mapped as
+         * guest RAM lines up with the guest's own node boundaries.  Chunk
+         * boundaries stay THP-aligned so transparent huge pages can still
+         * back each chunk, and each chunk is preallocated right after its
+         * binding so the touching threads fault pages on the right node.
+         */
+        unsigned long nnodes = bitmap_count_one(backend->host_nodes, MAX_NODES);
+        unsigned long node = find_first_bit(backend->host_nodes, MAX_NODES);
+        uint64_t align = MAX(pagesize, QEMU_VMALLOC_ALIGN);
+        uint64_t chunk = QEMU_ALIGN_UP(DIV_ROUND_UP(sz, nnodes), align);
+        unsigned threads = MAX(backend->prealloc_threads / nnodes, 1);
+        uint64_t offset;
+
+        for (offset = 0; offset < sz; offset += chunk) {
+            DECLARE_BITMAP(nodemask, MAX_NODES + 1) = { 0 };
+            uint64_t len = MIN(chunk, sz - offset);
+
+            bitmap_set(nodemask, node, 1);
+            if (mbind(ptr + offset, len, mode, nodemask, node + 2, flags)) {
+                error_setg_errno(errp, errno,
+                                 "cannot bind memory to host NUMA node %lu",
+                                 node);
+                return;
+            }
+
+            if (backend->prealloc &&
+                !qemu_prealloc_mem(memory_region_get_fd(&backend->mr),
+                                   ptr + offset, len, threads,
+                                   backend->prealloc_context, async, errp)) {
+                return;
+            }
+
+            node = find_next_bit(backend->host_nodes, MAX_NODES, node + 1);
+            if (node == MAX_NODES) {
+                node = find_first_bit(backend->host_nodes, MAX_NODES);
+            }
+        }
+        return;
+    }
+
     if (maxnode &&
         mbind(ptr, sz, mode, backend->host_nodes, maxnode + 1, flags)) {
         if (backend->policy != MPOL_DEFAULT || errno != ENOSYS) {
@@ -552,6 +643,12 @@ host_memory_backend_class_init(ObjectClass *oc, void *data)
         host_memory_backend_set_policy);
     object_class_property_set_description(oc, "policy",
         "Set the NUMA policy");
+    object_class_property_add_bool(oc, "numa-stripe",
+        host_memory_backend_get_numa_stripe,
+        host_memory_backend_set_numa_stripe);
+    object_class_property_set_description(oc, "numa-stripe",
+        "Stripe the memory across the host-nodes list in equal chunks, "
+        "binding and preallocating each chunk on its own node");
     object_class_property_add_bool(oc, "share",
         host_memory_backend_get_share, host_memory_backend_set_share);
     object_class_property_set_description(oc, "share",
@@ -176,6 +176,8 @@ static int tpm_emulator_unix_tx_bufs(TPMEmulator *tpm_emu,
                                      bool *selftest_done,
                                      Error **errp)
 {
+    uint32_t resp_len = sizeof(struct tpm_resp_hdr);
+    uint32_t got = 0;
     ssize_t ret;
     bool is_selftest = false;
 
@@ -189,17 +191,35 @@ static int tpm_emulator_unix_tx_bufs(TPMEmulator *tpm_emu,
         return -1;
     }
 
-    ret = qio_channel_read_all(tpm_emu->data_ioc, (char *)out,
-              sizeof(struct tpm_resp_hdr), errp);
-    if (ret != 0) {
-        return -1;
-    }
-
-    ret = qio_channel_read_all(tpm_emu->data_ioc,
-              (char *)out + sizeof(struct tpm_resp_hdr),
-              tpm_cmd_get_size(out) - sizeof(struct tpm_resp_hdr), errp);
-    if (ret != 0) {
-        return -1;
+    /*
+     * The emulator sends the complete response in one go, so read
+     * whatever has arrived rather than issuing one syscall for the
+     * header and a second one for the body.  The response length is
+     * only known once the header is in.
+     */
+    while (got < resp_len) {
+        ret = qio_channel_read(tpm_emu->data_ioc, (char *)out + got,
+                               out_len - got, errp);
+        if (ret == QIO_CHANNEL_ERR_BLOCK) {
+            qio_channel_wait(tpm_emu->data_ioc, G_IO_IN);
+            continue;
+        }
+        if (ret == 0) {
+            error_setg(errp, "tpm-emulator: EOF on data channel");
+            return -1;
+        }
+        if (ret < 0) {
+            return -1;
+        }
+        got += ret;
+        if (got >= sizeof(struct tpm_resp_hdr)) {
+            resp_len = tpm_cmd_get_size(out);
+            if (resp_len < sizeof(struct tpm_resp_hdr) || resp_len > out_len) {
+                error_setg(errp, "tpm-emulator: bogus response size %" PRIu32,
+                           resp_len);
+                return -1;
+            }
+        }
     }
 
     if (is_selftest) {
@@ -429,6 +429,7 @@ BlockDriverState *bdrv_new(void)
 
     qemu_co_mutex_init(&bs->bsc_modify_lock);
     bs->block_status_cache = g_new0(BdrvBlockStatusCache, 1);
+    bs->pad_cache_offset = -1;
 
     for (i = 0; i < bdrv_drain_all_count; i++) {
         bdrv_drained_begin(bs);
@@ -1203,18 +1204,38 @@ static char *bdrv_child_get_parent_desc(BdrvChild *c)
 static void GRAPH_RDLOCK bdrv_child_cb_drained_begin(BdrvChild *child)
 {
     BlockDriverState *bs = child->opaque;
+
+    if (bs->drv && bs->drv->bdrv_drain_child_begin &&
+        bs->drv->bdrv_drain_child_begin(bs, child)) {
+        /* The driver quiesces its own requests to @child */
+        child->drained_independent = true;
+        return;
+    }
     bdrv_do_drained_begin_quiesce(bs, NULL);
 }
 
 static bool GRAPH_RDLOCK bdrv_child_cb_drained_poll(BdrvChild *child)
 {
     BlockDriverState *bs = child->opaque;
+
+    if (child->drained_independent) {
+        return bs->drv && bs->drv->bdrv_drain_child_poll &&
+               bs->drv->bdrv_drain_child_poll(bs, child);
+    }
     return bdrv_drain_poll(bs, NULL, false);
 }
 
 static void GRAPH_RDLOCK bdrv_child_cb_drained_end(BdrvChild *child)
 {
     BlockDriverState *bs = child->opaque;
+
+    if (child->drained_independent) {
+        child->drained_independent = false;
+        if (bs->drv) {
+            bs->drv->bdrv_drain_child_end(bs, child);
+        }
+        return;
+    }
     bdrv_drained_end(bs);
 }
 
@@ -5181,6 +5202,10 @@ static void bdrv_close(BlockDriverState *bs)
     bs->full_open_options = NULL;
     g_free(bs->block_status_cache);
     bs->block_status_cache = NULL;
+    qemu_vfree(bs->pad_cache_buf);
+    bs->pad_cache_buf = NULL;
+    bs->pad_cache_size = 0;
+    bs->pad_cache_offset = -1;
 
     bdrv_release_named_dirty_bitmaps(bs);
     assert(QLIST_EMPTY(&bs->dirty_bitmaps));
@@ -6932,6 +6957,11 @@ int coroutine_fn bdrv_co_invalidate_cache(BlockDriverState *bs, Error **errp)
     assert(!(bs->open_flags & BDRV_O_INACTIVE));
     assert_bdrv_graph_readable();
 
+    /* The image may have been written while the node was inactive */
+    qemu_mutex_lock(&bs->reqs_lock);
+    bs->pad_cache_offset = -1;
+    qemu_mutex_unlock(&bs->reqs_lock);
+
     if (bs->drv->bdrv_co_invalidate_cache) {
         bs->drv->bdrv_co_invalidate_cache(bs, &local_err);
         if (local_err) {
@@ -26,6 +26,7 @@
 #include "qemu/osdep.h"
 #include "block/accounting.h"
 #include "block/block_int.h"
+#include "qemu/host-utils.h"
 #include "qemu/timer.h"
 #include "system/qtest.h"
 
@@ -229,6 +230,13 @@ static void block_account_one_io(BlockAcctStats *stats, BlockAcctCookie *cookie,
                                         latency_ns);
 
         if (!failed || stats->account_failed) {
+            int bin = latency_ns > 0 ? 64 - clz64(latency_ns) : 0;
+
+            if (bin >= BLOCK_LATENCY_LOG2_NBINS) {
+                bin = BLOCK_LATENCY_LOG2_NBINS - 1;
+            }
+            stats->latency_log2_bins[cookie->type][bin]++;
+
             stats->total_time_ns[cookie->type] += latency_ns;
             stats->last_access_time_ns = time_ns;
 
@@ -155,6 +155,15 @@ typedef struct BlockCopyState {
      * block_copy_reset_unallocated() every time it does.
      */
     bool skip_unallocated; /* atomic */
+    /*
+     * skip_identical:
+     *
+     * Read the target before writing and skip the write if the content is
+     * already identical.  Useful when the target starts out as a copy of an
+     * earlier state of the source.  Set before copying starts and never
+     * changed afterwards.
+     */
+    bool skip_identical;
     /* State fields that use a thread-safe API */
     BdrvDirtyBitmap *copy_bitmap;
     ProgressMeter *progress;
@@ -559,6 +568,20 @@ block_copy_do_copy(BlockCopyState *s, int64_t offset, int64_t bytes,
             goto out;
         }
 
+        if (s->skip_identical) {
+            void *target_buffer = qemu_blockalign(s->target->bs, nbytes);
+
+            /* If the target read fails just fall back to writing */
+            ret = bdrv_co_pread(s->target, offset, nbytes, target_buffer, 0);
+            if (ret == 0 &&
+                memcmp(bounce_buffer, target_buffer, nbytes) == 0) {
+                trace_block_copy_skip_identical(s, offset);
+                qemu_vfree(target_buffer);
+                goto out;
+            }
+            qemu_vfree(target_buffer);
+        }
+
         ret = bdrv_co_pwrite(s->target, offset, nbytes, bounce_buffer,
                              s->write_flags);
         if (ret < 0) {
@@ -1062,6 +1085,15 @@ void block_copy_set_skip_unallocated(BlockCopyState *s, bool skip)
     qatomic_set(&s->skip_unallocated, skip);
 }
 
+void block_copy_set_skip_identical(BlockCopyState *s, bool skip)
+{
+    s->skip_identical = skip;
+    if (skip) {
+        /* Only the read+write method can compare against the target */
+        s->method = COPY_READ_WRITE;
+    }
+}
+
 void block_copy_set_speed(BlockCopyState *s, uint64_t speed)
 {
     ratelimit_set_speed(&s->rate_limit, speed, BLOCK_COPY_SLICE_TIME);
@@ -34,11 +34,14 @@
 #include "block/block-copy.h"
 #include "block/dirty-bitmap.h"
 
+#include "block/aio_task.h"
 #include "block/copy-before-write.h"
 #include "block/reqlist.h"
 
 #include "qapi/qapi-visit-block-core.h"
 
+#define CBW_MAX_WORKERS 8
+
 typedef struct BDRVCopyBeforeWriteState {
     BlockCopyState *bcs;
     BdrvChild *target;
@@ -71,6 +74,25 @@ typedef struct BDRVCopyBeforeWriteState {
      */
     BlockReqList frozen_read_reqs;
 
+    /*
+     * The target child may be drained without quiescing the whole filter:
+     * guest reads never touch the target, so only operations that issue
+     * requests to it coordinate with the drained section through this gate.
+     * @target_drain is the number of active drained sections of the target
+     * child and @target_in_flight counts operations that may still issue a
+     * request to the target; both are read with atomics and written under
+     * @target_gate_lock. Requests arriving while @target_drain is nonzero
+     * wait in @target_drain_queue. @target_drain_bypass releases them when
+     * the filter node itself is quiesced, so that an enclosing drain
+     * flushes the parked requests instead of deadlocking against the
+     * target's drained section.
+     */
+    unsigned int target_drain;
+    unsigned int target_drain_bypass;
+    unsigned int target_in_flight;
+    CoQueue target_drain_queue;
+    QemuMutex target_gate_lock;
+
     /*
      * @snapshot_error is normally zero. But on first copy-before-write failure
      * when @on_cbw_error == ON_CBW_ERROR_BREAK_SNAPSHOT, @snapshot_error takes
@@ -87,10 +109,45 @@ cbw_co_preadv(BlockDriverState *bs, int64_t offset, int64_t bytes,
     return bdrv_co_preadv(bs->file, offset, bytes, qiov, flags);
 }
 
+/*
+ * Mark the beginning of an operation that may issue requests to s->target,
+ * waiting first for a drained section of the target child to end.  Must be
+ * paired with cbw_target_gate_leave() once no more requests follow.
+ */
+static void coroutine_fn cbw_target_gate_enter(BDRVCopyBeforeWriteState *s)
+{
+    qatomic_inc(&s->target_in_flight);
+    /* Pairs with the barrier in cbw_drain_child_begin() */
+    smp_mb();
+    if (likely(!qatomic_read(&s->target_drain))) {
+        return;
+    }
+
+    qemu_mutex_lock(&s->target_gate_lock);
+    while (qatomic_read(&s->target_drain) && !s->target_drain_bypass) {
+        if (qatomic_fetch_dec(&s->target_in_flight) == 1) {
+            aio_wait_kick();
+        }
+        qemu_co_queue_wait(&s->target_drain_queue, &s->target_gate_lock);
+        qatomic_inc(&s->target_in_flight);
+        smp_mb();
+    }
+    qemu_mutex_unlock(&s->target_gate_lock);
+}
+
+static void cbw_target_gate_leave(BDRVCopyBeforeWriteState *s)
+{
+    if (qatomic_fetch_dec(&s->target_in_flight) == 1) {
+        aio_wait_kick();
+    }
+}
+
 static void block_copy_cb(void *opaque)
 {
     BlockDriverState *bs = opaque;
+    BDRVCopyBeforeWriteState *s = bs->opaque;
 
+    cbw_target_gate_leave(s);
     bdrv_dec_in_flight(bs);
 }
 
@@ -129,6 +186,7 @@ static coroutine_fn int cbw_do_copy_before_write(BlockDriverState *bs,
      * sure that on bs close() we'll previously wait for all timed-out but yet
      * running block_copy calls.
      */
+    cbw_target_gate_enter(s);
     bdrv_inc_in_flight(bs);
     ret = block_copy(s->bcs, off, end - off, true, s->cbw_timeout_ns,
                      block_copy_cb, bs);
@@ -258,28 +316,99 @@ cbw_snapshot_read_unlock(BlockDriverState *bs, BlockReq *req)
     g_free(req);
 }
 
+typedef struct CbwSnapshotReadTask {
+    AioTask task;
+
+    BlockDriverState *bs;
+    BlockReq *req;
+    BdrvChild *file;
+    int64_t offset;
+    int64_t bytes;
+    QEMUIOVector *qiov;
+    size_t qiov_offset;
+} CbwSnapshotReadTask;
+
+static int coroutine_fn GRAPH_RDLOCK
+cbw_co_preadv_snapshot_do(BlockDriverState *bs, BlockReq *req, BdrvChild *file,
+                          int64_t offset, int64_t bytes,
+                          QEMUIOVector *qiov, size_t qiov_offset)
+{
+    BDRVCopyBeforeWriteState *s = bs->opaque;
+    int ret;
+
+    if (file == s->target) {
+        cbw_target_gate_enter(s);
+    }
+    ret = bdrv_co_preadv_part(file, offset, bytes, qiov, qiov_offset, 0);
+    if (file == s->target) {
+        cbw_target_gate_leave(s);
+    }
+    cbw_snapshot_read_unlock(bs, req);
+
+    return ret;
+}
+
+/*
+ * This function can count as GRAPH_RDLOCK because cbw_co_preadv_snapshot()
+ * holds the graph lock and keeps it until this coroutine has terminated.
+ */
+static int coroutine_fn GRAPH_RDLOCK
+cbw_co_preadv_snapshot_task_entry(AioTask *task)
+{
+    CbwSnapshotReadTask *t = container_of(task, CbwSnapshotReadTask, task);
+
+    return cbw_co_preadv_snapshot_do(t->bs, t->req, t->file, t->offset,
+                                     t->bytes, t->qiov, t->qiov_offset);
+}
+
 static int coroutine_fn GRAPH_RDLOCK
 cbw_co_preadv_snapshot(BlockDriverState *bs, int64_t offset, int64_t bytes,
                        QEMUIOVector *qiov, size_t qiov_offset)
 {
     BlockReq *req;
     BdrvChild *file;
-    int ret;
+    AioTaskPool *aio = NULL;
+    int ret = 0;
 
-    /* TODO: upgrade to async loop using AioTask */
-    while (bytes) {
+    /*
+     * A request is fragmented at the boundaries between copied and not yet
+     * copied areas. Take the snapshot lock of the next fragment while reads
+     * of the previous ones are still in flight, so that a backup stream is
+     * not limited to one lock round trip and one read per iteration.
+     */
+    while (bytes && aio_task_pool_status(aio) == 0) {
         int64_t cur_bytes;
 
         req = cbw_snapshot_read_lock(bs, offset, bytes, &cur_bytes, &file);
         if (!req) {
-            return -EACCES;
+            ret = -EACCES;
+            break;
         }
 
-        ret = bdrv_co_preadv_part(file, offset, cur_bytes,
-                                  qiov, qiov_offset, 0);
-        cbw_snapshot_read_unlock(bs, req);
-        if (ret < 0) {
-            return ret;
+        if (!aio && cur_bytes != bytes) {
+            aio = aio_task_pool_new(CBW_MAX_WORKERS);
+        }
+
+        if (aio) {
+            CbwSnapshotReadTask *task = g_new(CbwSnapshotReadTask, 1);
+
+            *task = (CbwSnapshotReadTask) {
+                .task.func = cbw_co_preadv_snapshot_task_entry,
+                .bs = bs,
+                .req = req,
+                .file = file,
+                .offset = offset,
+                .bytes = cur_bytes,
+                .qiov = qiov,
+                .qiov_offset = qiov_offset,
+            };
+            aio_task_pool_start_task(aio, &task->task);
+        } else {
+            ret = cbw_co_preadv_snapshot_do(bs, req, file, offset, cur_bytes,
+                                            qiov, qiov_offset);
+            if (ret < 0) {
+                break;
+            }
         }
 
         bytes -= cur_bytes;
@@ -287,7 +416,15 @@ cbw_co_preadv_snapshot(BlockDriverState *bs, int64_t offset, int64_t bytes,
         qiov_offset += cur_bytes;
     }
 
-    return 0;
+    if (aio) {
+        aio_task_pool_wait_all(aio);
+        if (ret == 0) {
+            ret = aio_task_pool_status(aio);
+        }
+        g_free(aio);
+    }
+
+    return ret;
 }
 
 static int coroutine_fn GRAPH_RDLOCK
@@ -307,7 +444,13 @@ cbw_co_snapshot_block_status(BlockDriverState *bs,
         return -EACCES;
     }
 
+    if (child == s->target) {
+        cbw_target_gate_enter(s);
+    }
     ret = bdrv_co_block_status(child->bs, offset, cur_bytes, pnum, map, file);
+    if (child == s->target) {
+        cbw_target_gate_leave(s);
+    }
     if (child == s->target) {
         /*
          * We refer to s->target only for areas that we've written to it.
@@ -331,6 +474,7 @@ cbw_co_pdiscard_snapshot(BlockDriverState *bs, int64_t offset, int64_t bytes)
     int64_t aligned_offset = QEMU_ALIGN_UP(offset, cluster_size);
     int64_t aligned_end = QEMU_ALIGN_DOWN(offset + bytes, cluster_size);
     int64_t aligned_bytes;
+    int ret;
 
     if (aligned_end <= aligned_offset) {
         return 0;
@@ -344,7 +488,76 @@ cbw_co_pdiscard_snapshot(BlockDriverState *bs, int64_t offset, int64_t bytes)
 
     block_copy_reset(s->bcs, aligned_offset, aligned_bytes);
 
-    return bdrv_co_pdiscard(s->target, aligned_offset, aligned_bytes);
+    cbw_target_gate_enter(s);
+    ret = bdrv_co_pdiscard(s->target, aligned_offset, aligned_bytes);
+    cbw_target_gate_leave(s);
+
+    return ret;
+}
+
+static bool cbw_drain_child_begin(BlockDriverState *bs, BdrvChild *child)
+{
+    BDRVCopyBeforeWriteState *s = bs->opaque;
+
+    if (child != s->target) {
+        return false;
+    }
+
+    qemu_mutex_lock(&s->target_gate_lock);
+    qatomic_set(&s->target_drain, s->target_drain + 1);
+    qemu_mutex_unlock(&s->target_gate_lock);
+    /* Pairs with the barrier in cbw_target_gate_enter() */
+    smp_mb();
+    return true;
+}
+
+static bool cbw_drain_child_poll(BlockDriverState *bs, BdrvChild *child)
+{
+    BDRVCopyBeforeWriteState *s = bs->opaque;
+
+    assert(child == s->target);
+    return qatomic_read(&s->target_in_flight) > 0;
+}
+
+static void cbw_drain_child_end(BlockDriverState *bs, BdrvChild *child)
+{
+    BDRVCopyBeforeWriteState *s = bs->opaque;
+
+    assert(child == s->target);
+    qemu_mutex_lock(&s->target_gate_lock);
+    assert(s->target_drain > 0);
+    qatomic_set(&s->target_drain, s->target_drain - 1);
+    if (s->target_drain == 0) {
+        qemu_co_enter_all(&s->target_drain_queue, &s->target_gate_lock);
+    }
+    qemu_mutex_unlock(&s->target_gate_lock);
+}
+
+static void cbw_drain_begin(BlockDriverState *bs)
+{
+    BDRVCopyBeforeWriteState *s = bs->opaque;
+
+    /*
+     * Once this node is quiesced, no new guest requests arrive.  Release
+     * requests parked on a drained target so that an enclosing drain
+     * completes them instead of deadlocking against the target's drained
+     * section; the encloser then waits for them, so the target is quiet
+     * again before the enclosing drained section begins.
+     */
+    qemu_mutex_lock(&s->target_gate_lock);
+    s->target_drain_bypass++;
+    qemu_co_enter_all(&s->target_drain_queue, &s->target_gate_lock);
+    qemu_mutex_unlock(&s->target_gate_lock);
+}
+
+static void cbw_drain_end(BlockDriverState *bs)
+{
+    BDRVCopyBeforeWriteState *s = bs->opaque;
+
+    qemu_mutex_lock(&s->target_gate_lock);
+    assert(s->target_drain_bypass > 0);
+    s->target_drain_bypass--;
+    qemu_mutex_unlock(&s->target_gate_lock);
 }
 
 static void GRAPH_RDLOCK cbw_refresh_filename(BlockDriverState *bs)
@@ -419,6 +632,7 @@ static BlockdevOptions *cbw_parse_options(QDict *options, Error **errp)
     qdict_del(options, "on-cbw-error");
     qdict_del(options, "cbw-timeout");
     qdict_del(options, "min-cluster-size");
+    qdict_del(options, "skip-identical");
 
 out:
     visit_free(v);
@@ -438,6 +652,9 @@ static int cbw_open(BlockDriverState *bs, QDict *options, int flags,
     BlockdevOptionsCbw *opts;
     int ret;
 
+    qemu_mutex_init(&s->target_gate_lock);
+    qemu_co_queue_init(&s->target_drain_queue);
+
     full_opts = cbw_parse_options(options, errp);
     if (!full_opts) {
         return -EINVAL;
@@ -487,6 +704,10 @@ static int cbw_open(BlockDriverState *bs, QDict *options, int flags,
         return -EINVAL;
     }
 
+    if (opts->has_skip_identical && opts->skip_identical) {
+        block_copy_set_skip_identical(s->bcs, true);
+    }
+
     cluster_size = block_copy_cluster_size(s->bcs);
 
     s->done_bitmap = bdrv_create_dirty_bitmap(bs, cluster_size, NULL, errp);
@@ -517,6 +738,9 @@ static void cbw_close(BlockDriverState *bs)
     bdrv_release_dirty_bitmap(s->access_bitmap);
     bdrv_release_dirty_bitmap(s->done_bitmap);
 
+    assert(qemu_co_queue_empty(&s->target_drain_queue));
+    qemu_mutex_destroy(&s->target_gate_lock);
+
     block_copy_state_free(s->bcs);
     s->bcs = NULL;
 }
@@ -538,6 +762,12 @@ static BlockDriver bdrv_cbw_filter = {
     .bdrv_co_pdiscard_snapshot     = cbw_co_pdiscard_snapshot,
     .bdrv_co_snapshot_block_status = cbw_co_snapshot_block_status,
 
+    .bdrv_drain_begin           = cbw_drain_begin,
+    .bdrv_drain_end             = cbw_drain_end,
+    .bdrv_drain_child_begin     = cbw_drain_child_begin,
+    .bdrv_drain_child_poll      = cbw_drain_child_poll,
+    .bdrv_drain_child_end       = cbw_drain_child_end,
+
     .bdrv_refresh_filename      = cbw_refresh_filename,
 
     .bdrv_child_perm            = cbw_child_perm,
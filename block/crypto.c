@@ -19,9 +19,11 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/coroutine.h"
 
 #include "block/block_int.h"
 #include "block/qdict.h"
+#include "block/thread-pool.h"
 #include "system/block-backend.h"
 #include "crypto/block.h"
 #include "qapi/opts-visitor.h"
@@ -36,10 +38,17 @@
 
 typedef struct BlockCrypto BlockCrypto;
 
+#define BLOCK_CRYPTO_MAX_THREADS 4
+
 struct BlockCrypto {
     QCryptoBlock *block;
     bool updating_keys;
     BdrvChild *header;  /* Reference to the detached LUKS header */
+
+    /* Throttles cipher work offloaded to the thread pool */
+    CoMutex pool_lock;
+    CoQueue pool_task_queue;
+    int nb_pool_threads;
 };
 
 
@@ -372,6 +381,9 @@ static int block_crypto_open_generic(QCryptoBlockFormat format,
 
     bs->encrypted = true;
 
+    qemu_co_mutex_init(&crypto->pool_lock);
+    qemu_co_queue_init(&crypto->pool_task_queue);
+
     ret = 0;
  cleanup:
     qobject_unref(cryptoopts);
@@ -466,6 +478,65 @@ static int block_crypto_reopen_prepare(BDRVReopenState *state,
  */
 #define BLOCK_CRYPTO_MAX_IO_SIZE (1024 * 1024)
 
+/*
+ * BlockCryptoEncDecFunc: common prototype of qcrypto_block_encrypt()
+ * and qcrypto_block_decrypt() functions.
+ */
+typedef int (*BlockCryptoEncDecFunc)(QCryptoBlock *block, uint64_t offset,
+                                     uint8_t *buf, size_t len, Error **errp);
+
+typedef struct BlockCryptoEncDecData {
+    QCryptoBlock *block;
+    uint64_t offset;
+    uint8_t *buf;
+    size_t len;
+
+    BlockCryptoEncDecFunc func;
+} BlockCryptoEncDecData;
+
+static int block_crypto_encdec_pool_func(void *opaque)
+{
+    BlockCryptoEncDecData *data = opaque;
+
+    return data->func(data->block, data->offset, data->buf, data->len, NULL);
+}
+
+/*
+ * Run encryption or decryption in the thread pool, so that requests
+ * from different coroutines use the idle cores instead of serializing
+ * the cipher work on the iothread.  qcrypto_block_*crypt() maintain a
+ * pool of cipher contexts, so concurrent calls are safe.
+ */
+static int coroutine_fn
+block_crypto_co_encdec(BlockCrypto *crypto, uint64_t offset,
+                       uint8_t *buf, size_t len, BlockCryptoEncDecFunc func)
+{
+    int ret;
+    BlockCryptoEncDecData arg = {
+        .block = crypto->block,
+        .offset = offset,
+        .buf = buf,
+        .len = len,
+        .func = func,
+    };
+
+    qemu_co_mutex_lock(&crypto->pool_lock);
+    while (crypto->nb_pool_threads >= BLOCK_CRYPTO_MAX_THREADS) {
+        qemu_co_queue_wait(&crypto->pool_task_queue, &crypto->pool_lock);
+    }
+    crypto->nb_pool_threads++;
+    qemu_co_mutex_unlock(&crypto->pool_lock);
+
+    ret = thread_pool_submit_co(block_crypto_encdec_pool_func, &arg);
+
+    qemu_co_mutex_lock(&crypto->pool_lock);
+    crypto->nb_pool_threads--;
+    qemu_co_queue_next(&crypto->pool_task_queue);
+    qemu_co_mutex_unlock(&crypto->pool_lock);
+
+    return ret;
+}
+
 static int coroutine_fn GRAPH_RDLOCK
 block_crypto_co_preadv(BlockDriverState *bs, int64_t offset, int64_t bytes,
                        QEMUIOVector *qiov, BdrvRequestFlags flags)
@@ -508,8 +579,9 @@ block_crypto_co_preadv(BlockDriverState *bs, int64_t offset, int64_t bytes,
             goto cleanup;
         }
 
-        if (qcrypto_block_decrypt(crypto->block, offset + bytes_done,
-                                  cipher_data, cur_bytes, NULL) < 0) {
+        if (block_crypto_co_encdec(crypto, offset + bytes_done,
+                                   cipher_data, cur_bytes,
+                                   qcrypto_block_decrypt) < 0) {
             ret = -EIO;
             goto cleanup;
         }
@@ -565,8 +637,9 @@ block_crypto_co_pwritev(BlockDriverState *bs, int64_t offset, int64_t bytes,
 
         qemu_iovec_to_buf(qiov, bytes_done, cipher_data, cur_bytes);
 
-        if (qcrypto_block_encrypt(crypto->block, offset + bytes_done,
-                                  cipher_data, cur_bytes, NULL) < 0) {
+        if (block_crypto_co_encdec(crypto, offset + bytes_done,
+                                   cipher_data, cur_bytes,
+                                   qcrypto_block_encrypt) < 0) {
             ret = -EIO;
             goto cleanup;
         }
@@ -505,6 +505,21 @@ static int curl_init_state(BDRVCURLState *s, CURLState *state)
             }
         }
 
+        /*
+         * Prefer HTTP/2 where the server offers it over TLS, and wait for
+         * an existing connection that supports multiplexing instead of
+         * opening a new one, so that the parallel transfers of this pool
+         * can share connections instead of each paying for its own TCP
+         * and TLS handshake.  Available from 7.47.0 upwards.
+         */
+#if LIBCURL_VERSION_NUM >= 0x072f00
+        if (curl_easy_setopt(state->curl, CURLOPT_HTTP_VERSION,
+                             CURL_HTTP_VERSION_2TLS) ||
+            curl_easy_setopt(state->curl, CURLOPT_PIPEWAIT, 1L)) {
+            goto err;
+        }
+#endif
+
         /* Restrict supported protocols to avoid security issues in the more
          * obscure protocols.  For example, do not allow POP3/SMTP/IMAP see
          * CVE-2013-0249.
@@ -608,6 +623,10 @@ static void curl_attach_aio_context(BlockDriverState *bs,
     curl_multi_setopt(s->multi, CURLMOPT_SOCKETFUNCTION, curl_sock_cb);
     curl_multi_setopt(s->multi, CURLMOPT_TIMERDATA, s);
     curl_multi_setopt(s->multi, CURLMOPT_TIMERFUNCTION, curl_timer_cb);
+#if LIBCURL_VERSION_NUM >= 0x072b00
+    /* Multiplex parallel transfers over one connection where possible */
+    curl_multi_setopt(s->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
 }
 
 static QemuOptsList runtime_opts = {
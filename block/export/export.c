@@ -72,9 +72,57 @@ static const BlockExportDriver *blk_exp_find_driver(BlockExportType type)
     return NULL;
 }
 
+typedef struct BlkExpIOThreadSelection {
+    IOThread *best;
+    unsigned int best_load;
+} BlkExpIOThreadSelection;
+
+static int blk_exp_check_one_iothread(Object *object, void *opaque)
+{
+    BlkExpIOThreadSelection *sel = opaque;
+    IOThread *iothread;
+    AioContext *ctx;
+    BlockExport *exp;
+    unsigned int load = 0;
+
+    iothread = (IOThread *)object_dynamic_cast(object, TYPE_IOTHREAD);
+    if (!iothread) {
+        return 0;
+    }
+
+    ctx = iothread_get_aio_context(iothread);
+    QLIST_FOREACH(exp, &block_exports, next) {
+        if (exp->ctx == ctx) {
+            load++;
+        }
+    }
+
+    if (!sel->best || load < sel->best_load) {
+        sel->best = iothread;
+        sel->best_load = load;
+    }
+    return 0;
+}
+
+/*
+ * Returns the user-created iothread that currently serves the fewest
+ * exports, or NULL if no iothread object exists.  Only counts exports,
+ * not other users of the thread, which is good enough to spread a large
+ * number of similar exports without configuring placement by hand.
+ */
+static IOThread *blk_exp_find_least_loaded_iothread(void)
+{
+    BlkExpIOThreadSelection sel = { .best = NULL };
+
+    object_child_foreach(object_get_objects_root(),
+                         blk_exp_check_one_iothread, &sel);
+    return sel.best;
+}
+
 BlockExport *blk_exp_add(BlockExportOptions *export, Error **errp)
 {
     bool fixed_iothread = export->has_fixed_iothread && export->fixed_iothread;
+    bool auto_iothread = export->has_auto_iothread && export->auto_iothread;
     bool allow_inactive = export->has_allow_inactive && export->allow_inactive;
     const BlockExportDriver *drv;
     BlockExport *exp = NULL;
@@ -94,6 +142,10 @@ BlockExport *blk_exp_add(BlockExportOptions *export, Error **errp)
         error_setg(errp, "Block export id '%s' is already in use", export->id);
         return NULL;
     }
+    if (auto_iothread && export->iothread) {
+        error_setg(errp, "auto-iothread cannot be combined with iothread");
+        return NULL;
+    }
 
     drv = blk_exp_find_driver(export->type);
     if (!drv) {
@@ -116,15 +168,25 @@ BlockExport *blk_exp_add(BlockExportOptions *export, Error **errp)
 
     ctx = bdrv_get_aio_context(bs);
 
-    if (export->iothread) {
+    if (export->iothread || auto_iothread) {
         IOThread *iothread;
         AioContext *new_ctx;
         Error **set_context_errp;
 
-        iothread = iothread_by_id(export->iothread);
-        if (!iothread) {
-            error_setg(errp, "iothread \"%s\" not found", export->iothread);
-            goto fail;
+        if (export->iothread) {
+            iothread = iothread_by_id(export->iothread);
+            if (!iothread) {
+                error_setg(errp, "iothread \"%s\" not found", export->iothread);
+                goto fail;
+            }
+        } else {
+            iothread = blk_exp_find_least_loaded_iothread();
+            if (!iothread) {
+                error_setg(errp,
+                           "auto-iothread requires an iothread object to be "
+                           "defined");
+                goto fail;
+            }
         }
 
         new_ctx = iothread_get_aio_context(iothread);
@@ -365,6 +427,10 @@ BlockExportInfoList *qmp_query_block_exports(Error **errp)
             .shutting_down  = !exp->user_owned,
         };
 
+        if (exp->drv->fill_info) {
+            exp->drv->fill_info(exp, info);
+        }
+
         QAPI_LIST_APPEND(tail, info);
     }
 
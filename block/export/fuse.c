@@ -269,6 +269,16 @@ static int setup_fuse_export(FuseExport *exp, const char *mountpoint,
 
     g_hash_table_insert(exports, g_strdup(mountpoint), NULL);
 
+    /*
+     * Make the session FD non-blocking so that read_from_fuse_export()
+     * can drain all queued requests after one readiness notification
+     * and stop on EAGAIN.
+     */
+    ret = fcntl(fuse_session_fd(exp->fuse_session), F_GETFL);
+    if (ret >= 0) {
+        fcntl(fuse_session_fd(exp->fuse_session), F_SETFL, ret | O_NONBLOCK);
+    }
+
     aio_set_fd_handler(exp->common.ctx,
                        fuse_session_fd(exp->fuse_session),
                        read_from_fuse_export, NULL, NULL, NULL, exp);
@@ -294,16 +304,24 @@ static void read_from_fuse_export(void *opaque)
 
     qatomic_inc(&exp->in_flight);
 
-    do {
-        ret = fuse_session_receive_buf(exp->fuse_session, &exp->fuse_buf);
-    } while (ret == -EINTR);
-    if (ret < 0) {
-        goto out;
+    /*
+     * The kernel can queue many requests behind a single readiness
+     * notification, so keep receiving until the queue is empty (the
+     * session FD is non-blocking, so an empty queue shows up as
+     * -EAGAIN) instead of taking one event loop iteration per request.
+     */
+    while (!fuse_session_exited(exp->fuse_session)) {
+        do {
+            ret = fuse_session_receive_buf(exp->fuse_session, &exp->fuse_buf);
+        } while (ret == -EINTR);
+        if (ret <= 0) {
+            break;
+        }
+
+        fuse_session_process_buf(exp->fuse_session, &exp->fuse_buf);
     }
 
-    fuse_session_process_buf(exp->fuse_session, &exp->fuse_buf);
 
-out:
     if (qatomic_fetch_dec(&exp->in_flight) == 1) {
         aio_wait_kick(); /* wake AIO_WAIT_WHILE() */
     }
@@ -410,10 +410,21 @@ static void vduse_blk_exp_request_shutdown(BlockExport *exp)
     vduse_blk_stop_virtqueues(vblk_exp);
 }
 
+static void vduse_blk_exp_fill_info(BlockExport *exp, BlockExportInfo *info)
+{
+    VduseBlkExport *vblk_exp = container_of(exp, VduseBlkExport, export);
+
+    info->has_requests = true;
+    info->requests = stat64_get(&vblk_exp->handler.req_count);
+    info->has_request_total_ns = true;
+    info->request_total_ns = stat64_get(&vblk_exp->handler.req_total_ns);
+}
+
 const BlockExportDriver blk_exp_vduse_blk = {
     .type               = BLOCK_EXPORT_TYPE_VDUSE_BLK,
     .instance_size      = sizeof(VduseBlkExport),
     .create             = vduse_blk_exp_create,
     .delete             = vduse_blk_exp_delete,
     .request_shutdown   = vduse_blk_exp_request_shutdown,
+    .fill_info          = vduse_blk_exp_fill_info,
 };
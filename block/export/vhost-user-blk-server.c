@@ -364,6 +364,16 @@ static int vu_blk_exp_create(BlockExport *exp, BlockExportOptions *opts,
     return 0;
 }
 
+static void vu_blk_exp_fill_info(BlockExport *exp, BlockExportInfo *info)
+{
+    VuBlkExport *vexp = container_of(exp, VuBlkExport, export);
+
+    info->has_requests = true;
+    info->requests = stat64_get(&vexp->handler.req_count);
+    info->has_request_total_ns = true;
+    info->request_total_ns = stat64_get(&vexp->handler.req_total_ns);
+}
+
 static void vu_blk_exp_delete(BlockExport *exp)
 {
     VuBlkExport *vexp = container_of(exp, VuBlkExport, export);
@@ -379,4 +389,5 @@ const BlockExportDriver blk_exp_vhost_user_blk = {
     .create             = vu_blk_exp_create,
     .delete             = vu_blk_exp_delete,
     .request_shutdown   = vu_blk_exp_request_shutdown,
+    .fill_info          = vu_blk_exp_fill_info,
 };
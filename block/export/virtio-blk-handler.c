@@ -14,6 +14,7 @@
 
 #include "qemu/osdep.h"
 #include "qemu/error-report.h"
+#include "qemu/timer.h"
 #include "virtio-blk-handler.h"
 
 #include "standard-headers/linux/virtio_blk.h"
@@ -138,6 +139,7 @@ int coroutine_fn virtio_blk_process_req(VirtioBlkHandler *handler,
     BlockBackend *blk = handler->blk;
     struct virtio_blk_inhdr *in;
     struct virtio_blk_outhdr out;
+    int64_t start_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
     uint32_t type;
     int in_len;
 
@@ -237,5 +239,9 @@ int coroutine_fn virtio_blk_process_req(VirtioBlkHandler *handler,
         break;
     }
 
+    stat64_add(&handler->req_count, 1);
+    stat64_add(&handler->req_total_ns,
+               qemu_clock_get_ns(QEMU_CLOCK_REALTIME) - start_ns);
+
     return in_len;
 }
@@ -13,6 +13,7 @@
 #ifndef VIRTIO_BLK_HANDLER_H
 #define VIRTIO_BLK_HANDLER_H
 
+#include "qemu/stats64.h"
 #include "system/block-backend.h"
 
 #define VIRTIO_BLK_SECTOR_BITS 9
@@ -26,6 +27,13 @@ typedef struct {
     char *serial;
     uint32_t logical_block_size;
     bool writable;
+
+    /*
+     * Completed request statistics. Stat64 so that query-block-exports
+     * can read them from the main thread, also on 32-bit hosts.
+     */
+    Stat64 req_count;
+    Stat64 req_total_ns;
 } VirtioBlkHandler;
 
 int coroutine_fn virtio_blk_process_req(VirtioBlkHandler *handler,
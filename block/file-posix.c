@@ -173,9 +173,37 @@ typedef struct BDRVRawState {
         uint64_t discard_bytes_ok;
     } stats;
 
+    /*
+     * Guest fstrim can produce thousands of discards at once, and
+     * FALLOC_FL_PUNCH_HOLE largely serializes within the filesystem, so
+     * fanning them out over the whole thread pool only ties up threads
+     * that data I/O could use.  Discards therefore go through their own
+     * bounded queue; requests that line up with a queued discard are
+     * merged into it while it waits for a slot.
+     */
+    CoMutex discard_lock;
+    CoQueue discard_slot_wait;
+    QTAILQ_HEAD(, RawDiscardReq) discard_queue;
+    unsigned discard_inflight;
+
     PRManager *pr_mgr;
 } BDRVRawState;
 
+/* A queued or running discard operation; covers one or more requests */
+typedef struct RawDiscardReq {
+    int64_t offset;
+    int64_t bytes;
+    int ret;
+    bool running;
+    bool done;
+    unsigned refcnt;
+    CoQueue wait;
+    QTAILQ_ENTRY(RawDiscardReq) next;
+} RawDiscardReq;
+
+/* Max discard operations on the thread pool per image */
+#define MAX_DISCARD_INFLIGHT 4
+
 typedef struct BDRVRawReopenState {
     int open_flags;
     bool drop_cache;
@@ -744,6 +772,10 @@ static int raw_open_common(BlockDriverState *bs, QDict *options,
     s->has_discard = true;
     s->has_write_zeroes = true;
 
+    qemu_co_mutex_init(&s->discard_lock);
+    qemu_co_queue_init(&s->discard_slot_wait);
+    QTAILQ_INIT(&s->discard_queue);
+
     if (fstat(s->fd, &st) < 0) {
         ret = -errno;
         error_setg_errno(errp, errno, "Could not stat file");
@@ -1470,6 +1502,9 @@ static void raw_refresh_zoned_limits(BlockDriverState *bs, struct stat *st,
         goto no_zoned;
     }
     qemu_co_mutex_init(&bs->wps->colock);
+    for (unsigned int i = 0; i < BLK_ZONE_LOCK_STRIPES; i++) {
+        qemu_co_mutex_init(&bs->wps->zone_locks[i]);
+    }
     return;
 
 no_zoned:
@@ -2496,13 +2531,27 @@ static int coroutine_fn raw_co_prw(BlockDriverState *bs, int64_t *offset_ptr,
     if (fd_open(bs) < 0)
         return -EIO;
 #if defined(CONFIG_BLKZONED)
-    if ((type & (QEMU_AIO_WRITE | QEMU_AIO_ZONE_APPEND)) &&
-        bs->bl.zoned != BLK_Z_NONE) {
+    bool zoned_write = (type & (QEMU_AIO_WRITE | QEMU_AIO_ZONE_APPEND)) &&
+                       bs->bl.zoned != BLK_Z_NONE;
+    CoMutex *zone_lock = NULL;
+
+    if (zoned_write) {
+        int index = offset / bs->bl.zone_size;
+
+        /*
+         * Hold the zone's stripe lock across the I/O: writes and
+         * appends within one zone stay strictly ordered, while
+         * requests to (most) other zones proceed in parallel.  The
+         * wp array itself is only touched under colock, which is
+         * never held across I/O.
+         */
+        zone_lock = &bs->wps->zone_locks[index % BLK_ZONE_LOCK_STRIPES];
+        qemu_co_mutex_lock(zone_lock);
         qemu_co_mutex_lock(&bs->wps->colock);
         if (type & QEMU_AIO_ZONE_APPEND) {
-            int index = offset / bs->bl.zone_size;
             offset = bs->wps->wp[index];
         }
+        qemu_co_mutex_unlock(&bs->wps->colock);
     }
 #endif
 
@@ -2551,9 +2600,9 @@ static int coroutine_fn raw_co_prw(BlockDriverState *bs, int64_t *offset_ptr,
 
 out:
 #if defined(CONFIG_BLKZONED)
-    if ((type & (QEMU_AIO_WRITE | QEMU_AIO_ZONE_APPEND)) &&
-        bs->bl.zoned != BLK_Z_NONE) {
+    if (zoned_write) {
         BlockZoneWps *wps = bs->wps;
+        qemu_co_mutex_lock(&wps->colock);
         if (ret == 0) {
             uint64_t *wp = &wps->wp[offset / bs->bl.zone_size];
             if (!BDRV_ZT_IS_CONV(*wp)) {
@@ -2575,6 +2624,7 @@ out:
         }
 
         qemu_co_mutex_unlock(&wps->colock);
+        qemu_co_mutex_unlock(zone_lock);
     }
 #endif
     return ret;
@@ -3563,14 +3613,58 @@ raw_do_pdiscard(BlockDriverState *bs, int64_t offset, int64_t bytes,
 {
     BDRVRawState *s = bs->opaque;
     RawPosixAIOData acb;
+    RawDiscardReq *req;
     int ret;
 
+    qemu_co_mutex_lock(&s->discard_lock);
+
+    /*
+     * If this request lines up with a discard that is still waiting for
+     * a slot, extend that one and share its result instead of submitting
+     * another operation.
+     */
+    QTAILQ_FOREACH(req, &s->discard_queue, next) {
+        if (!req->running &&
+            offset <= req->offset + req->bytes &&
+            req->offset <= offset + bytes) {
+            int64_t end = MAX(req->offset + req->bytes, offset + bytes);
+
+            req->offset = MIN(req->offset, offset);
+            req->bytes = end - req->offset;
+            req->refcnt++;
+            while (!req->done) {
+                qemu_co_queue_wait(&req->wait, &s->discard_lock);
+            }
+            ret = req->ret;
+            if (--req->refcnt == 0) {
+                g_free(req);
+            }
+            qemu_co_mutex_unlock(&s->discard_lock);
+            raw_account_discard(s, bytes, ret);
+            return ret;
+        }
+    }
+
+    req = g_new0(RawDiscardReq, 1);
+    req->offset = offset;
+    req->bytes = bytes;
+    req->refcnt = 1;
+    qemu_co_queue_init(&req->wait);
+    QTAILQ_INSERT_TAIL(&s->discard_queue, req, next);
+
+    while (s->discard_inflight >= MAX_DISCARD_INFLIGHT) {
+        qemu_co_queue_wait(&s->discard_slot_wait, &s->discard_lock);
+    }
+    s->discard_inflight++;
+    req->running = true;
+    qemu_co_mutex_unlock(&s->discard_lock);
+
     acb = (RawPosixAIOData) {
         .bs             = bs,
         .aio_fildes     = s->fd,
         .aio_type       = QEMU_AIO_DISCARD,
-        .aio_offset     = offset,
-        .aio_nbytes     = bytes,
+        .aio_offset     = req->offset,
+        .aio_nbytes     = req->bytes,
     };
 
     if (blkdev) {
@@ -3578,6 +3672,19 @@ raw_do_pdiscard(BlockDriverState *bs, int64_t offset, int64_t bytes,
     }
 
     ret = raw_thread_pool_submit(handle_aiocb_discard, &acb);
+
+    qemu_co_mutex_lock(&s->discard_lock);
+    s->discard_inflight--;
+    req->ret = ret;
+    req->done = true;
+    QTAILQ_REMOVE(&s->discard_queue, req, next);
+    qemu_co_queue_restart_all(&req->wait);
+    qemu_co_queue_next(&s->discard_slot_wait);
+    if (--req->refcnt == 0) {
+        g_free(req);
+    }
+    qemu_co_mutex_unlock(&s->discard_lock);
+
     raw_account_discard(s, bytes, ret);
     return ret;
 }
@@ -3892,6 +3999,29 @@ raw_co_copy_range_to(BlockDriverState *bs,
     return raw_thread_pool_submit(handle_aiocb_copy_range, &acb);
 }
 
+#if defined(CONFIG_LINUX_IO_URING)
+static bool raw_register_buf(BlockDriverState *bs, void *host, size_t size,
+                             Error **errp)
+{
+    BDRVRawState *s = bs->opaque;
+
+    if (!s->use_linux_io_uring) {
+        /* Nothing to register, but the hint is not an error */
+        return true;
+    }
+    return luring_register_buf(host, size, errp);
+}
+
+static void raw_unregister_buf(BlockDriverState *bs, void *host, size_t size)
+{
+    BDRVRawState *s = bs->opaque;
+
+    if (s->use_linux_io_uring) {
+        luring_unregister_buf(host, size);
+    }
+}
+#endif
+
 BlockDriver bdrv_file = {
     .format_name = "file",
     .protocol_name = "file",
@@ -3929,6 +4059,10 @@ BlockDriver bdrv_file = {
     .bdrv_check_perm = raw_check_perm,
     .bdrv_set_perm   = raw_set_perm,
     .bdrv_abort_perm_update = raw_abort_perm_update,
+#if defined(CONFIG_LINUX_IO_URING)
+    .bdrv_register_buf = raw_register_buf,
+    .bdrv_unregister_buf = raw_unregister_buf,
+#endif
     .create_opts = &raw_create_opts,
     .mutable_opts = mutable_opts,
 };
@@ -4293,6 +4427,10 @@ static BlockDriver bdrv_host_device = {
     .bdrv_check_perm = raw_check_perm,
     .bdrv_set_perm   = raw_set_perm,
     .bdrv_abort_perm_update = raw_abort_perm_update,
+#if defined(CONFIG_LINUX_IO_URING)
+    .bdrv_register_buf = raw_register_buf,
+    .bdrv_unregister_buf = raw_unregister_buf,
+#endif
     .bdrv_probe_blocksizes = hdev_probe_blocksizes,
     .bdrv_probe_geometry = hdev_probe_geometry,
 
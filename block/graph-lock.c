@@ -19,7 +19,9 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/host-utils.h"
 #include "qemu/main-loop.h"
+#include "qemu/timer.h"
 #include "block/graph-lock.h"
 #include "block/block.h"
 #include "block/block_int.h"
@@ -47,6 +49,30 @@ static uint32_t orphaned_reader_count;
 /* Queue of readers waiting for the writer to finish */
 static CoQueue reader_queue;
 
+/*
+ * Log2 histograms of the time spent waiting to take the lock, in
+ * nanoseconds, reported by query-stats under the "block" provider.
+ * Readers only wait while a writer is mid-flight, so the reader
+ * histogram directly shows the I/O latency injected by graph changes.
+ * Protected by aio_context_list_lock.
+ */
+static uint64_t rdlock_wait_bins[GRAPH_LOCK_WAIT_LOG2_NBINS];
+static uint64_t wrlock_wait_bins[GRAPH_LOCK_WAIT_LOG2_NBINS];
+
+/* Called with aio_context_list_lock held; 0 means "did not wait". */
+static void graph_lock_account_wait_locked(uint64_t *bins, int64_t start_ns)
+{
+    int64_t wait_ns;
+    int bin;
+
+    if (!start_ns) {
+        return;
+    }
+    wait_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME) - start_ns;
+    bin = wait_ns > 0 ? 64 - clz64(wait_ns) : 0;
+    bins[MIN(bin, GRAPH_LOCK_WAIT_LOG2_NBINS - 1)]++;
+}
+
 struct BdrvGraphRWlock {
     /* How many readers are currently reading the graph. */
     uint32_t reader_count;
@@ -108,6 +134,8 @@ static uint32_t reader_count(void)
 
 void no_coroutine_fn bdrv_graph_wrlock(void)
 {
+    int64_t start_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+
     GLOBAL_STATE_CODE();
     assert(!qatomic_read(&has_writer));
     assert(!qemu_in_coroutine());
@@ -139,6 +167,10 @@ void no_coroutine_fn bdrv_graph_wrlock(void)
         smp_mb();
     } while (reader_count() >= 1);
 
+    WITH_QEMU_LOCK_GUARD(&aio_context_list_lock) {
+        graph_lock_account_wait_locked(wrlock_wait_bins, start_ns);
+    }
+
     bdrv_drain_all_end();
 }
 
@@ -173,6 +205,7 @@ void no_coroutine_fn bdrv_graph_wrunlock(void)
 void coroutine_fn bdrv_graph_co_rdlock(void)
 {
     BdrvGraphRWlock *bdrv_graph;
+    int64_t start_ns = 0;
     bdrv_graph = qemu_get_current_aio_context()->bdrv_graph;
 
     for (;;) {
@@ -222,15 +255,26 @@ void coroutine_fn bdrv_graph_co_rdlock(void)
              * actually running.
              */
             if (!qatomic_read(&has_writer)) {
+                graph_lock_account_wait_locked(rdlock_wait_bins, start_ns);
                 return;
             }
 
             /* slow path where reader sleeps */
+            if (!start_ns) {
+                start_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+            }
             bdrv_graph->reader_count--;
             aio_wait_kick();
             qemu_co_queue_wait(&reader_queue, &aio_context_list_lock);
         }
     }
+
+    /* The fast path never waits; only account after a sleep. */
+    if (unlikely(start_ns)) {
+        WITH_QEMU_LOCK_GUARD(&aio_context_list_lock) {
+            graph_lock_account_wait_locked(rdlock_wait_bins, start_ns);
+        }
+    }
 }
 
 void coroutine_fn bdrv_graph_co_rdunlock(void)
@@ -279,3 +323,11 @@ void assert_bdrv_graph_writable(void)
     assert(qemu_in_main_thread());
     assert(qatomic_read(&has_writer));
 }
+
+void bdrv_graph_lock_wait_histograms(uint64_t *rd_bins, uint64_t *wr_bins)
+{
+    QEMU_LOCK_GUARD(&aio_context_list_lock);
+
+    memcpy(rd_bins, rdlock_wait_bins, sizeof(rdlock_wait_bins));
+    memcpy(wr_bins, wrlock_wait_bins, sizeof(wrlock_wait_bins));
+}
@@ -1511,6 +1511,58 @@ static bool bdrv_init_padding(BlockDriverState *bs,
     return true;
 }
 
+/*
+ * Try to fill an aligned block of a padding read-modify-write cycle from
+ * bs->pad_cache_buf instead of reading it from disk.  The caller's
+ * request must already be serialising so that the cached block cannot be
+ * invalidated by a concurrent overlapping request.
+ */
+static bool bdrv_pad_cache_fetch(BlockDriverState *bs, int64_t offset,
+                                 int64_t bytes, uint8_t *buf)
+{
+    QEMU_LOCK_GUARD(&bs->reqs_lock);
+
+    if (bs->pad_cache_offset != offset || bs->pad_cache_size != bytes) {
+        return false;
+    }
+
+    memcpy(buf, bs->pad_cache_buf, bytes);
+    return true;
+}
+
+/*
+ * Remember the content of the request_alignment-sized block at @offset,
+ * taken from @qiov starting at @qiov_offset.
+ */
+static void bdrv_pad_cache_store(BlockDriverState *bs, int64_t offset,
+                                 QEMUIOVector *qiov, size_t qiov_offset)
+{
+    int64_t align = bs->bl.request_alignment;
+
+    QEMU_LOCK_GUARD(&bs->reqs_lock);
+
+    if (bs->pad_cache_size != align) {
+        qemu_vfree(bs->pad_cache_buf);
+        bs->pad_cache_buf = qemu_blockalign(bs, align);
+        bs->pad_cache_size = align;
+    }
+
+    qemu_iovec_to_buf(qiov, qiov_offset, bs->pad_cache_buf, align);
+    bs->pad_cache_offset = offset;
+}
+
+static void bdrv_pad_cache_invalidate(BlockDriverState *bs, int64_t offset,
+                                      int64_t bytes)
+{
+    QEMU_LOCK_GUARD(&bs->reqs_lock);
+
+    if (bs->pad_cache_offset >= 0 &&
+        offset < bs->pad_cache_offset + bs->pad_cache_size &&
+        bs->pad_cache_offset < offset + bytes) {
+        bs->pad_cache_offset = -1;
+    }
+}
+
 static int coroutine_fn GRAPH_RDLOCK
 bdrv_padding_rmw_read(BdrvChild *child, BdrvTrackedRequest *req,
                       BdrvRequestPadding *pad, bool zero_middle)
@@ -1525,18 +1577,19 @@ bdrv_padding_rmw_read(BdrvChild *child, BdrvTrackedRequest *req,
     if (pad->head || pad->merge_reads) {
         int64_t bytes = pad->merge_reads ? pad->buf_len : align;
 
-        qemu_iovec_init_buf(&local_qiov, pad->buf, bytes);
-
         if (pad->head) {
             bdrv_co_debug_event(bs, BLKDBG_PWRITEV_RMW_HEAD);
         }
         if (pad->merge_reads && pad->tail) {
             bdrv_co_debug_event(bs, BLKDBG_PWRITEV_RMW_TAIL);
         }
-        ret = bdrv_aligned_preadv(child, req, req->overlap_offset, bytes,
-                                  align, &local_qiov, 0, 0);
-        if (ret < 0) {
-            return ret;
+        if (!bdrv_pad_cache_fetch(bs, req->overlap_offset, bytes, pad->buf)) {
+            qemu_iovec_init_buf(&local_qiov, pad->buf, bytes);
+            ret = bdrv_aligned_preadv(child, req, req->overlap_offset, bytes,
+                                      align, &local_qiov, 0, 0);
+            if (ret < 0) {
+                return ret;
+            }
         }
         if (pad->head) {
             bdrv_co_debug_event(bs, BLKDBG_PWRITEV_RMW_AFTER_HEAD);
@@ -1551,15 +1604,19 @@ bdrv_padding_rmw_read(BdrvChild *child, BdrvTrackedRequest *req,
     }
 
     if (pad->tail) {
-        qemu_iovec_init_buf(&local_qiov, pad->tail_buf, align);
-
         bdrv_co_debug_event(bs, BLKDBG_PWRITEV_RMW_TAIL);
-        ret = bdrv_aligned_preadv(
-                child, req,
-                req->overlap_offset + req->overlap_bytes - align,
-                align, align, &local_qiov, 0, 0);
-        if (ret < 0) {
-            return ret;
+        if (!bdrv_pad_cache_fetch(bs,
+                                  req->overlap_offset + req->overlap_bytes
+                                  - align,
+                                  align, pad->tail_buf)) {
+            qemu_iovec_init_buf(&local_qiov, pad->tail_buf, align);
+            ret = bdrv_aligned_preadv(
+                    child, req,
+                    req->overlap_offset + req->overlap_bytes - align,
+                    align, align, &local_qiov, 0, 0);
+            if (ret < 0) {
+                return ret;
+            }
         }
         bdrv_co_debug_event(bs, BLKDBG_PWRITEV_RMW_AFTER_TAIL);
     }
@@ -1992,6 +2049,13 @@ bdrv_co_write_req_prepare(BdrvChild *child, int64_t offset, int64_t bytes,
         bdrv_wait_serialising_requests(req);
     }
 
+    /*
+     * Conflicting requests were waited for above, so the padded write
+     * that populated the RMW padding cache has completed and cannot
+     * repopulate it after this invalidation.
+     */
+    bdrv_pad_cache_invalidate(bs, offset, bytes);
+
     assert(req->overlap_offset <= offset);
     assert(offset + bytes <= req->overlap_offset + req->overlap_bytes);
     assert(offset + bytes <= bs->total_sectors * BDRV_SECTOR_SIZE ||
@@ -2308,6 +2372,19 @@ int coroutine_fn bdrv_co_pwritev_part(BdrvChild *child,
     ret = bdrv_aligned_pwritev(child, &req, offset, bytes, align,
                                qiov, qiov_offset, flags);
 
+    if (padded && ret == 0) {
+        /*
+         * Remember the block that the next write of a sequential
+         * sub-alignment stream is most likely to pad with, saving its
+         * RMW read.  The request is still serialising, so no concurrent
+         * request can invalidate the entry before we store it.
+         */
+        int64_t cache_offset = pad.tail ? offset + bytes - align : offset;
+
+        bdrv_pad_cache_store(bs, cache_offset, qiov,
+                             qiov_offset + (cache_offset - offset));
+    }
+
     bdrv_padding_finalize(&pad);
 
 out:
@@ -26,6 +26,78 @@
 /* io_uring ring size */
 #define MAX_ENTRIES 128
 
+/*
+ * Registry of candidate fixed buffers, typically guest RAM blocks
+ * registered by the raw driver through luring_register_buf().  Rings
+ * pick up table changes lazily from their home thread at submission
+ * time, so no cross-thread io_uring_register() calls are needed.
+ */
+typedef struct LuringFixedBuf {
+    void *host;     /* NULL for free table slots */
+    size_t len;
+    int refcount;
+} LuringFixedBuf;
+
+static QemuMutex luring_fixed_buf_lock;
+static GArray *luring_fixed_bufs;
+static unsigned luring_fixed_buf_gen;
+
+static void __attribute__((constructor)) luring_fixed_buf_lock_init(void)
+{
+    qemu_mutex_init(&luring_fixed_buf_lock);
+}
+
+bool luring_register_buf(void *host, size_t size, Error **errp)
+{
+    LuringFixedBuf *buf;
+    LuringFixedBuf new_buf = { .host = host, .len = size, .refcount = 1 };
+    size_t i;
+
+    qemu_mutex_lock(&luring_fixed_buf_lock);
+    if (!luring_fixed_bufs) {
+        luring_fixed_bufs = g_array_new(FALSE, TRUE, sizeof(LuringFixedBuf));
+    }
+    for (i = 0; i < luring_fixed_bufs->len; i++) {
+        buf = &g_array_index(luring_fixed_bufs, LuringFixedBuf, i);
+        if (buf->host == host && buf->len == size) {
+            buf->refcount++;
+            qemu_mutex_unlock(&luring_fixed_buf_lock);
+            return true;
+        }
+    }
+    for (i = 0; i < luring_fixed_bufs->len; i++) {
+        buf = &g_array_index(luring_fixed_bufs, LuringFixedBuf, i);
+        if (!buf->host) {
+            *buf = new_buf;
+            break;
+        }
+    }
+    if (i == luring_fixed_bufs->len) {
+        g_array_append_val(luring_fixed_bufs, new_buf);
+    }
+    qatomic_set(&luring_fixed_buf_gen, luring_fixed_buf_gen + 1);
+    qemu_mutex_unlock(&luring_fixed_buf_lock);
+    return true;
+}
+
+void luring_unregister_buf(void *host, size_t size)
+{
+    LuringFixedBuf *buf;
+    size_t i;
+
+    qemu_mutex_lock(&luring_fixed_buf_lock);
+    for (i = 0; luring_fixed_bufs && i < luring_fixed_bufs->len; i++) {
+        buf = &g_array_index(luring_fixed_bufs, LuringFixedBuf, i);
+        if (buf->host == host && buf->len == size && --buf->refcount == 0) {
+            buf->host = NULL;
+            buf->len = 0;
+            qatomic_set(&luring_fixed_buf_gen, luring_fixed_buf_gen + 1);
+            break;
+        }
+    }
+    qemu_mutex_unlock(&luring_fixed_buf_lock);
+}
+
 typedef struct LuringAIOCB {
     Coroutine *co;
     struct io_uring_sqe sqeq;
@@ -58,8 +130,93 @@ struct LuringState {
     LuringQueue io_q;
 
     QEMUBH *completion_bh;
+
+    /* Fixed buffers registered with this ring; home thread only */
+    struct iovec *fixed_bufs;
+    unsigned nr_fixed_bufs;
+    unsigned fixed_buf_gen;     /* luring_fixed_buf_gen these match */
+    bool fixed_bufs_registered;
 };
 
+/*
+ * Catch up with changes to the fixed buffer table.  Replacing an
+ * existing registration requires an idle ring, so that no request can
+ * be issued against a buffer index that meanwhile changed meaning;
+ * the initial registration has no such constraint.
+ */
+static void luring_refresh_fixed_bufs(LuringState *s)
+{
+    g_autofree struct iovec *iovs = NULL;
+    unsigned gen, n = 0;
+    size_t i;
+
+    if (qatomic_read(&luring_fixed_buf_gen) == s->fixed_buf_gen) {
+        return;
+    }
+
+    if (s->fixed_bufs_registered) {
+        if (s->io_q.in_flight || s->io_q.in_queue) {
+            return; /* retry when the ring is idle */
+        }
+        if (io_uring_unregister_buffers(&s->ring) < 0) {
+            return;
+        }
+        s->fixed_bufs_registered = false;
+    }
+
+    qemu_mutex_lock(&luring_fixed_buf_lock);
+    gen = luring_fixed_buf_gen;
+    if (luring_fixed_bufs && luring_fixed_bufs->len) {
+        iovs = g_new0(struct iovec, luring_fixed_bufs->len);
+        for (i = 0; i < luring_fixed_bufs->len; i++) {
+            LuringFixedBuf *buf = &g_array_index(luring_fixed_bufs,
+                                                 LuringFixedBuf, i);
+            if (buf->host) {
+                iovs[n].iov_base = buf->host;
+                iovs[n].iov_len = buf->len;
+                n++;
+            }
+        }
+    }
+    qemu_mutex_unlock(&luring_fixed_buf_lock);
+
+    g_free(s->fixed_bufs);
+    s->fixed_bufs = g_steal_pointer(&iovs);
+    s->nr_fixed_bufs = n;
+    s->fixed_buf_gen = gen;
+
+    if (n && io_uring_register_buffers(&s->ring, s->fixed_bufs, n) == 0) {
+        s->fixed_bufs_registered = true;
+    }
+    trace_luring_register_buffers(s, n, s->fixed_bufs_registered);
+}
+
+/*
+ * Return the registered buffer index covering the request, or -1 if
+ * IORING_OP_READ_FIXED/WRITE_FIXED cannot be used for it.
+ */
+static int luring_fixed_buf_index(LuringState *s, QEMUIOVector *qiov)
+{
+    uintptr_t base;
+    unsigned i;
+
+    luring_refresh_fixed_bufs(s);
+
+    if (!s->fixed_bufs_registered || qiov->niov != 1) {
+        return -1;
+    }
+    base = (uintptr_t)qiov->iov[0].iov_base;
+    for (i = 0; i < s->nr_fixed_bufs; i++) {
+        uintptr_t buf_base = (uintptr_t)s->fixed_bufs[i].iov_base;
+
+        if (base >= buf_base &&
+            base + qiov->iov[0].iov_len <= buf_base + s->fixed_bufs[i].iov_len) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 /**
  * luring_resubmit:
  *
@@ -105,6 +262,14 @@ static void luring_resubmit_short_read(LuringState *s, LuringAIOCB *luringcb,
     luringcb->sqeq.addr = (uintptr_t)luringcb->resubmit_qiov.iov;
     luringcb->sqeq.len = luringcb->resubmit_qiov.niov;
 
+    /*
+     * The registered buffer table may change before the resubmission
+     * runs; finish the request with a plain readv instead.
+     */
+    if (luringcb->sqeq.opcode == IORING_OP_READ_FIXED) {
+        luringcb->sqeq.opcode = IORING_OP_READV;
+    }
+
     luring_resubmit(s, luringcb);
 }
 
@@ -338,10 +503,21 @@ static int luring_do_submit(int fd, LuringAIOCB *luringcb, LuringState *s,
                             uint64_t offset, int type, BdrvRequestFlags flags)
 {
     int ret;
+    int buf_index;
     struct io_uring_sqe *sqes = &luringcb->sqeq;
 
     switch (type) {
     case QEMU_AIO_WRITE:
+        /* RWF_DSYNC cannot be expressed with a fixed-buffer write */
+        buf_index = (flags & BDRV_REQ_FUA) ? -1
+                    : luring_fixed_buf_index(s, luringcb->qiov);
+        if (buf_index >= 0) {
+            io_uring_prep_write_fixed(sqes, fd,
+                                      luringcb->qiov->iov[0].iov_base,
+                                      luringcb->qiov->iov[0].iov_len,
+                                      offset, buf_index);
+            break;
+        }
 #ifdef HAVE_IO_URING_PREP_WRITEV2
     {
         int luring_flags = (flags & BDRV_REQ_FUA) ? RWF_DSYNC : 0;
@@ -359,6 +535,14 @@ static int luring_do_submit(int fd, LuringAIOCB *luringcb, LuringState *s,
                              luringcb->qiov->niov, offset);
         break;
     case QEMU_AIO_READ:
+        buf_index = luring_fixed_buf_index(s, luringcb->qiov);
+        if (buf_index >= 0) {
+            io_uring_prep_read_fixed(sqes, fd,
+                                     luringcb->qiov->iov[0].iov_base,
+                                     luringcb->qiov->iov[0].iov_len,
+                                     offset, buf_index);
+            break;
+        }
         io_uring_prep_readv(sqes, fd, luringcb->qiov->iov,
                             luringcb->qiov->niov, offset);
         break;
@@ -456,6 +640,7 @@ void luring_cleanup(LuringState *s)
 {
     io_uring_queue_exit(&s->ring);
     trace_luring_cleanup_state(s);
+    g_free(s->fixed_bufs);
     g_free(s);
 }
 
@@ -485,6 +485,7 @@ static void coroutine_fn GRAPH_UNLOCKED mirror_iteration(MirrorBlockJob *s)
     BlockDriverState *source;
     MirrorOp *pseudo_op;
     int64_t offset;
+    int64_t max_bytes, dirty_end, first_chunk;
     /* At least the first dirty chunk is mirrored in one iteration. */
     int nb_chunks = 1;
     bool write_zeroes_ok = bdrv_can_write_zeroes_with_unmap(blk_bs(s->target));
@@ -516,30 +517,31 @@ static void coroutine_fn GRAPH_UNLOCKED mirror_iteration(MirrorBlockJob *s)
     job_pause_point(&s->common.job);
 
     /* Find the number of consecutive dirty chunks following the first dirty
-     * one, and wait for in flight requests in them. */
+     * one, and wait for in flight requests in them.  Query the bitmap for
+     * the whole run at once instead of probing it chunk by chunk, which
+     * walks the bitmap levels once per chunk on sequential-dirty bitmaps. */
     bdrv_dirty_bitmap_lock(s->dirty_bitmap);
-    while (nb_chunks * s->granularity < s->buf_size) {
-        int64_t next_dirty;
-        int64_t next_offset = offset + nb_chunks * s->granularity;
-        int64_t next_chunk = next_offset / s->granularity;
-        if (next_offset >= s->bdev_length ||
-            !bdrv_dirty_bitmap_get_locked(s->dirty_bitmap, next_offset)) {
-            break;
-        }
-        if (test_bit(next_chunk, s->in_flight_bitmap)) {
-            break;
-        }
-
-        next_dirty = bdrv_dirty_iter_next(s->dbi);
-        if (next_dirty > next_offset || next_dirty < 0) {
-            /* The bitmap iterator's cache is stale, refresh it */
-            bdrv_set_dirty_iter(s->dbi, next_offset);
-            next_dirty = bdrv_dirty_iter_next(s->dbi);
-        }
-        assert(next_dirty == next_offset);
-        nb_chunks++;
+    max_bytes = MIN(s->buf_size, s->bdev_length - offset);
+    dirty_end = bdrv_dirty_bitmap_next_zero(s->dirty_bitmap, offset, max_bytes);
+    if (dirty_end < 0) {
+        dirty_end = offset + max_bytes;
     }
 
+    /* Stop at the first chunk that already has a request in flight */
+    first_chunk = offset / s->granularity;
+    nb_chunks = DIV_ROUND_UP(dirty_end - offset, s->granularity);
+    nb_chunks = find_next_bit(s->in_flight_bitmap, first_chunk + nb_chunks,
+                              first_chunk + 1) - first_chunk;
+
+    /*
+     * Even if an active write raced with us and cleaned the first chunk
+     * again, copy it; that is what the chunk-by-chunk loop used to do.
+     */
+    nb_chunks = MAX(nb_chunks, 1);
+
+    /* Advance the iterator past the chunks consumed by this iteration */
+    bdrv_set_dirty_iter(s->dbi, offset + nb_chunks * s->granularity);
+
     /* Clear dirty bits before querying the block status, because
      * calling bdrv_block_status_above could yield - if some blocks are
      * marked dirty in this window, we need to know.
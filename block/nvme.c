@@ -16,6 +16,7 @@
 #include "qapi/error.h"
 #include "qobject/qdict.h"
 #include "qobject/qstring.h"
+#include "qemu/atomic.h"
 #include "qemu/defer-call.h"
 #include "qemu/error-report.h"
 #include "qemu/main-loop.h"
@@ -49,6 +50,9 @@ typedef struct BDRVNVMeState BDRVNVMeState;
 #define INDEX_ADMIN     0
 #define INDEX_IO(n)     (1 + n)
 
+#define NVME_DEFAULT_IO_QUEUES 4
+#define NVME_MAX_IO_QUEUES 16
+
 /* This driver shares a single MSIX IRQ for the admin and I/O queues */
 enum {
     MSIX_SHARED_IRQ_IDX = 0,
@@ -93,6 +97,20 @@ typedef struct {
 
     /* Thread-safe, no lock necessary */
     QEMUBH      *completion_bh;
+
+    /*
+     * AioContext that owns this queue pair, claimed with cmpxchg by the
+     * first context that submits to it.  NULL while unclaimed.
+     */
+    AioContext  *ctx;
+
+    /*
+     * Dummy notifier carrying the CQ poll handler in @ctx for I/O queues.
+     * The eventfd itself never fires; completions missed by polling are
+     * picked up by the shared MSIX interrupt in the main context.
+     */
+    EventNotifier poll_notifier;
+    bool        poll_notifier_inited;
 } NVMeQueuePair;
 
 struct BDRVNVMeState {
@@ -143,6 +161,7 @@ struct BDRVNVMeState {
 
 #define NVME_BLOCK_OPT_DEVICE "device"
 #define NVME_BLOCK_OPT_NAMESPACE "namespace"
+#define NVME_BLOCK_OPT_QUEUES "num-queues"
 
 static void nvme_process_completion_bh(void *opaque);
 
@@ -160,6 +179,11 @@ static QemuOptsList runtime_opts = {
             .type = QEMU_OPT_NUMBER,
             .help = "NVMe namespace",
         },
+        {
+            .name = NVME_BLOCK_OPT_QUEUES,
+            .type = QEMU_OPT_NUMBER,
+            .help = "Number of hardware I/O queue pairs",
+        },
         { /* end of list */ }
     },
 };
@@ -198,6 +222,9 @@ static void nvme_free_queue_pair(NVMeQueuePair *q)
     if (q->completion_bh) {
         qemu_bh_delete(q->completion_bh);
     }
+    if (q->poll_notifier_inited) {
+        event_notifier_cleanup(&q->poll_notifier);
+    }
     nvme_free_queue(&q->sq);
     nvme_free_queue(&q->cq);
     qemu_vfree(q->prp_list_pages);
@@ -344,8 +371,10 @@ static void nvme_put_free_req_locked(NVMeQueuePair *q, NVMeRequest *req)
 static void nvme_wake_free_req_locked(NVMeQueuePair *q)
 {
     if (!qemu_co_queue_empty(&q->free_req_queue)) {
-        replay_bh_schedule_oneshot_event(q->s->aio_context,
-                nvme_free_req_queue_cb, q);
+        /* Waiters submitted from the context that owns the queue */
+        AioContext *ctx = qatomic_read(&q->ctx) ?: q->s->aio_context;
+
+        replay_bh_schedule_oneshot_event(ctx, nvme_free_req_queue_cb, q);
     }
 }
 
@@ -632,9 +661,10 @@ static void nvme_poll_queue(NVMeQueuePair *q)
 
     trace_nvme_poll_queue(q->s, q->index);
     /*
-     * Do an early check for completions. q->lock isn't needed because
-     * nvme_process_completion() only runs in the event loop thread and
-     * cannot race with itself.
+     * Do an early check for completions.  The owning context and the main
+     * context (via the shared MSIX interrupt) can both process this queue,
+     * so the unlocked read may be stale; that only costs a spurious lock
+     * acquisition or a missed poll round, never a lost completion.
      */
     if ((le16_to_cpu(cqe->status) & 0x1) == q->cq_phase) {
         return;
@@ -700,6 +730,8 @@ static bool nvme_add_io_queue(BlockDriverState *bs, Error **errp)
         error_setg(errp, "Failed to create SQ io queue [%u]", n);
         goto out_error;
     }
+    /* Without the notifier the queue still works off the shared interrupt */
+    q->poll_notifier_inited = !event_notifier_init(&q->poll_notifier, 0);
     s->queues = g_renew(NVMeQueuePair *, s->queues, n + 1);
     s->queues[n] = q;
     s->queue_count++;
@@ -714,22 +746,15 @@ static bool nvme_poll_cb(void *opaque)
     EventNotifier *e = opaque;
     BDRVNVMeState *s = container_of(e, BDRVNVMeState,
                                     irq_notifier[MSIX_SHARED_IRQ_IDX]);
-    int i;
-
-    for (i = 0; i < s->queue_count; i++) {
-        NVMeQueuePair *q = s->queues[i];
-        const size_t cqe_offset = q->cq.head * NVME_CQ_ENTRY_BYTES;
-        NvmeCqe *cqe = (NvmeCqe *)&q->cq.queue[cqe_offset];
+    NVMeQueuePair *q = s->queues[INDEX_ADMIN];
+    const size_t cqe_offset = q->cq.head * NVME_CQ_ENTRY_BYTES;
+    NvmeCqe *cqe = (NvmeCqe *)&q->cq.queue[cqe_offset];
 
-        /*
-         * q->lock isn't needed because nvme_process_completion() only runs in
-         * the event loop thread and cannot race with itself.
-         */
-        if ((le16_to_cpu(cqe->status) & 0x1) != q->cq_phase) {
-            return true;
-        }
-    }
-    return false;
+    /*
+     * Only the admin queue is polled here; I/O queues are polled by the
+     * context that owns them, see nvme_get_ioq().
+     */
+    return (le16_to_cpu(cqe->status) & 0x1) != q->cq_phase;
 }
 
 static void nvme_poll_ready(EventNotifier *e)
@@ -737,11 +762,72 @@ static void nvme_poll_ready(EventNotifier *e)
     BDRVNVMeState *s = container_of(e, BDRVNVMeState,
                                     irq_notifier[MSIX_SHARED_IRQ_IDX]);
 
-    nvme_poll_queues(s);
+    nvme_poll_queue(s->queues[INDEX_ADMIN]);
+}
+
+static void nvme_queue_notifier_read(EventNotifier *n)
+{
+    NVMeQueuePair *q = container_of(n, NVMeQueuePair, poll_notifier);
+
+    /* The dummy eventfd never fires, but handle it for completeness */
+    event_notifier_test_and_clear(n);
+    nvme_poll_queue(q);
+}
+
+static bool nvme_queue_poll_cb(void *opaque)
+{
+    EventNotifier *n = opaque;
+    NVMeQueuePair *q = container_of(n, NVMeQueuePair, poll_notifier);
+    const size_t cqe_offset = q->cq.head * NVME_CQ_ENTRY_BYTES;
+    NvmeCqe *cqe = (NvmeCqe *)&q->cq.queue[cqe_offset];
+
+    return (le16_to_cpu(cqe->status) & 0x1) != q->cq_phase;
+}
+
+static void nvme_queue_poll_ready(EventNotifier *n)
+{
+    NVMeQueuePair *q = container_of(n, NVMeQueuePair, poll_notifier);
+
+    nvme_poll_queue(q);
+}
+
+/*
+ * Return the I/O queue pair owned by the current AioContext, claiming an
+ * unused one on first submission.  Each iothread thus submits to its own
+ * hardware queue instead of contending on a shared queue lock, and polls
+ * its own completion queue from its event loop.  When there are more
+ * submitting contexts than hardware queues, the excess contexts share the
+ * first I/O queue; the shared MSIX interrupt in the main context reaps
+ * completions that no one polls.
+ */
+static NVMeQueuePair *nvme_get_ioq(BDRVNVMeState *s)
+{
+    AioContext *ctx = qemu_get_current_aio_context();
+    unsigned i;
+
+    for (i = INDEX_IO(0); i < s->queue_count; i++) {
+        NVMeQueuePair *q = s->queues[i];
+        AioContext *owner = qatomic_read(&q->ctx);
+
+        if (owner == ctx) {
+            return q;
+        }
+        if (!owner && qatomic_cmpxchg(&q->ctx, NULL, ctx) == NULL) {
+            trace_nvme_claim_queue(s, q->index, ctx);
+            if (q->poll_notifier_inited) {
+                aio_set_event_notifier(ctx, &q->poll_notifier,
+                                       nvme_queue_notifier_read,
+                                       nvme_queue_poll_cb,
+                                       nvme_queue_poll_ready);
+            }
+            return q;
+        }
+    }
+    return s->queues[INDEX_IO(0)];
 }
 
 static int nvme_init(BlockDriverState *bs, const char *device, int namespace,
-                     Error **errp)
+                     unsigned num_queues, Error **errp)
 {
     BDRVNVMeState *s = bs->opaque;
     NVMeQueuePair *q;
@@ -842,6 +928,7 @@ static int nvme_init(BlockDriverState *bs, const char *device, int namespace,
     }
     s->queues[INDEX_ADMIN] = q;
     s->queue_count = 1;
+    q->ctx = aio_context;
     QEMU_BUILD_BUG_ON((NVME_QUEUE_SIZE - 1) & 0xF000);
     regs->aqa = cpu_to_le32(((NVME_QUEUE_SIZE - 1) << AQA_ACQS_SHIFT) |
                             ((NVME_QUEUE_SIZE - 1) << AQA_ASQS_SHIFT));
@@ -883,6 +970,22 @@ static int nvme_init(BlockDriverState *bs, const char *device, int namespace,
     /* Set up command queues. */
     if (!nvme_add_io_queue(bs, errp)) {
         ret = -EIO;
+        goto out;
+    }
+
+    /*
+     * Additional hardware queues are claimed by the iothreads that submit
+     * I/O, see nvme_get_ioq().  Running with fewer than requested is fine:
+     * the controller may support less than we ask for.
+     */
+    while (s->queue_count < 1 + num_queues) {
+        Error *local_err = NULL;
+
+        if (!nvme_add_io_queue(bs, &local_err)) {
+            warn_reportf_err(local_err, "Only %u of %u I/O queues available: ",
+                             s->queue_count - 1, num_queues);
+            break;
+        }
     }
 out:
     if (regs) {
@@ -953,7 +1056,14 @@ static void nvme_close(BlockDriverState *bs)
     BDRVNVMeState *s = bs->opaque;
 
     for (unsigned i = 0; i < s->queue_count; ++i) {
-        nvme_free_queue_pair(s->queues[i]);
+        NVMeQueuePair *q = s->queues[i];
+        AioContext *owner = qatomic_read(&q->ctx);
+
+        if (i != INDEX_ADMIN && q->poll_notifier_inited && owner) {
+            aio_set_event_notifier(owner, &q->poll_notifier,
+                                   NULL, NULL, NULL);
+        }
+        nvme_free_queue_pair(q);
     }
     g_free(s->queues);
     aio_set_event_notifier(bdrv_get_aio_context(bs),
@@ -973,6 +1083,7 @@ static int nvme_open(BlockDriverState *bs, QDict *options, int flags,
     const char *device;
     QemuOpts *opts;
     int namespace;
+    uint64_t num_queues;
     int ret;
     BDRVNVMeState *s = bs->opaque;
 
@@ -988,7 +1099,15 @@ static int nvme_open(BlockDriverState *bs, QDict *options, int flags,
     }
 
     namespace = qemu_opt_get_number(opts, NVME_BLOCK_OPT_NAMESPACE, 1);
-    ret = nvme_init(bs, device, namespace, errp);
+    num_queues = qemu_opt_get_number(opts, NVME_BLOCK_OPT_QUEUES,
+                                     NVME_DEFAULT_IO_QUEUES);
+    if (num_queues < 1 || num_queues > NVME_MAX_IO_QUEUES) {
+        error_setg(errp, "'" NVME_BLOCK_OPT_QUEUES "' must be between 1 "
+                   "and %u", NVME_MAX_IO_QUEUES);
+        qemu_opts_del(opts);
+        return -EINVAL;
+    }
+    ret = nvme_init(bs, device, namespace, num_queues, errp);
     qemu_opts_del(opts);
     if (ret) {
         goto fail;
@@ -1188,7 +1307,7 @@ static coroutine_fn int nvme_co_prw_aligned(BlockDriverState *bs,
 {
     int r;
     BDRVNVMeState *s = bs->opaque;
-    NVMeQueuePair *ioq = s->queues[INDEX_IO(0)];
+    NVMeQueuePair *ioq = nvme_get_ioq(s);
     NVMeRequest *req;
 
     uint32_t cdw12 = (((bytes >> s->blkshift) - 1) & 0xFFFF) |
@@ -1201,7 +1320,7 @@ static coroutine_fn int nvme_co_prw_aligned(BlockDriverState *bs,
         .cdw12 = cpu_to_le32(cdw12),
     };
     NVMeCoData data = {
-        .ctx = bdrv_get_aio_context(bs),
+        .ctx = qemu_get_current_aio_context(),
         .ret = -EINPROGRESS,
     };
 
@@ -1309,14 +1428,14 @@ static coroutine_fn int nvme_co_pwritev(BlockDriverState *bs,
 static coroutine_fn int nvme_co_flush(BlockDriverState *bs)
 {
     BDRVNVMeState *s = bs->opaque;
-    NVMeQueuePair *ioq = s->queues[INDEX_IO(0)];
+    NVMeQueuePair *ioq = nvme_get_ioq(s);
     NVMeRequest *req;
     NvmeCmd cmd = {
         .opcode = NVME_CMD_FLUSH,
         .nsid = cpu_to_le32(s->nsid),
     };
     NVMeCoData data = {
-        .ctx = bdrv_get_aio_context(bs),
+        .ctx = qemu_get_current_aio_context(),
         .ret = -EINPROGRESS,
     };
 
@@ -1340,7 +1459,7 @@ static coroutine_fn int nvme_co_pwrite_zeroes(BlockDriverState *bs,
                                               BdrvRequestFlags flags)
 {
     BDRVNVMeState *s = bs->opaque;
-    NVMeQueuePair *ioq = s->queues[INDEX_IO(0)];
+    NVMeQueuePair *ioq = nvme_get_ioq(s);
     NVMeRequest *req;
     uint32_t cdw12;
 
@@ -1367,7 +1486,7 @@ static coroutine_fn int nvme_co_pwrite_zeroes(BlockDriverState *bs,
     };
 
     NVMeCoData data = {
-        .ctx = bdrv_get_aio_context(bs),
+        .ctx = qemu_get_current_aio_context(),
         .ret = -EINPROGRESS,
     };
 
@@ -1403,7 +1522,7 @@ static int coroutine_fn nvme_co_pdiscard(BlockDriverState *bs,
                                          int64_t bytes)
 {
     BDRVNVMeState *s = bs->opaque;
-    NVMeQueuePair *ioq = s->queues[INDEX_IO(0)];
+    NVMeQueuePair *ioq = nvme_get_ioq(s);
     NVMeRequest *req;
     QEMU_AUTO_VFREE NvmeDsmRange *buf = NULL;
     QEMUIOVector local_qiov;
@@ -1417,7 +1536,7 @@ static int coroutine_fn nvme_co_pdiscard(BlockDriverState *bs,
     };
 
     NVMeCoData data = {
-        .ctx = bdrv_get_aio_context(bs),
+        .ctx = qemu_get_current_aio_context(),
         .ret = -EINPROGRESS,
     };
 
@@ -1550,6 +1669,20 @@ static void nvme_detach_aio_context(BlockDriverState *bs)
     for (unsigned i = 0; i < s->queue_count; i++) {
         NVMeQueuePair *q = s->queues[i];
 
+        /*
+         * Release I/O queues owned by the outgoing context; they are
+         * re-claimed by whichever contexts submit I/O afterwards.  Queues
+         * owned by other iothreads are not affected by the move.
+         */
+        if (i != INDEX_ADMIN &&
+            qatomic_read(&q->ctx) == bdrv_get_aio_context(bs)) {
+            if (q->poll_notifier_inited) {
+                aio_set_event_notifier(bdrv_get_aio_context(bs),
+                                       &q->poll_notifier, NULL, NULL, NULL);
+            }
+            qatomic_set(&q->ctx, NULL);
+        }
+
         qemu_bh_delete(q->completion_bh);
         q->completion_bh = NULL;
     }
@@ -1565,6 +1698,7 @@ static void nvme_attach_aio_context(BlockDriverState *bs,
     BDRVNVMeState *s = bs->opaque;
 
     s->aio_context = new_context;
+    qatomic_set(&s->queues[INDEX_ADMIN]->ctx, new_context);
     aio_set_event_notifier(new_context, &s->irq_notifier[MSIX_SHARED_IRQ_IDX],
                            nvme_handle_event, nvme_poll_cb,
                            nvme_poll_ready);
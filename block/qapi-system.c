@@ -38,6 +38,7 @@
 #include "qobject/qdict.h"
 #include "system/block-backend.h"
 #include "system/blockdev.h"
+#include "system/stats.h"
 
 static BlockBackend *qmp_get_blk(const char *blk_name, const char *qdev_id,
                                  Error **errp)
@@ -572,3 +573,258 @@ void qmp_block_latency_histogram_set(
         }
     }
 }
+
+/*
+ * "block" provider for the query-stats command: exposes the always-on
+ * log2 latency histograms kept in BlockAcctStats, plus percentiles
+ * derived from them at query time.  Results are keyed by the block
+ * backend name.
+ */
+
+static const char *const block_acct_stat_prefix[BLOCK_MAX_IOTYPE] = {
+    [BLOCK_ACCT_READ] = "rd",
+    [BLOCK_ACCT_WRITE] = "wr",
+    [BLOCK_ACCT_FLUSH] = "flush",
+    [BLOCK_ACCT_ZONE_APPEND] = "zone-append",
+    [BLOCK_ACCT_UNMAP] = "unmap",
+};
+
+static const char *const block_latency_percentile_suffix[] = {
+    "p50", "p99", "p999",
+};
+
+static const unsigned block_latency_percentile_permille[] = {
+    500, 990, 999,
+};
+
+static uint64_t block_latency_log2_percentile(const uint64_t *bins,
+                                              uint64_t count,
+                                              unsigned permille)
+{
+    uint64_t rank = MAX((count * permille + 999) / 1000, 1);
+    uint64_t cum = 0;
+    int i;
+
+    for (i = 0; i < BLOCK_LATENCY_LOG2_NBINS; i++) {
+        if (cum + bins[i] >= rank) {
+            uint64_t lower = i ? UINT64_C(1) << (i - 1) : 0;
+            uint64_t width = (UINT64_C(1) << i) - lower;
+
+            /* Assume a uniform distribution within the bucket */
+            return lower + width * (rank - cum) / bins[i];
+        }
+        cum += bins[i];
+    }
+    return 0;
+}
+
+static void block_latency_stats_add(StatsList **stats_list, strList *names,
+                                    const char *prefix, const char *suffix,
+                                    StatsValue *value)
+{
+    g_autofree char *name = g_strdup_printf("%s-latency-%s", prefix, suffix);
+    Stats *stats;
+
+    if (!apply_str_list_filter(name, names)) {
+        qapi_free_StatsValue(value);
+        return;
+    }
+
+    stats = g_new0(Stats, 1);
+    stats->name = g_steal_pointer(&name);
+    stats->value = value;
+    QAPI_LIST_PREPEND(*stats_list, stats);
+}
+
+static void block_latency_stats_cb(StatsResultList **result, StatsTarget target,
+                                   strList *names, strList *targets,
+                                   Error **errp)
+{
+    BlockBackend *blk = NULL;
+
+    if (target != STATS_TARGET_BLOCK) {
+        return;
+    }
+
+    while ((blk = blk_next(blk)) != NULL) {
+        BlockAcctStats *acct = blk_get_stats(blk);
+        uint64_t bins[BLOCK_MAX_IOTYPE][BLOCK_LATENCY_LOG2_NBINS];
+        StatsList *stats_list = NULL;
+        int op, i;
+
+        qemu_mutex_lock(&acct->lock);
+        memcpy(bins, acct->latency_log2_bins, sizeof(bins));
+        qemu_mutex_unlock(&acct->lock);
+
+        for (op = BLOCK_ACCT_READ; op < BLOCK_MAX_IOTYPE; op++) {
+            const char *prefix = block_acct_stat_prefix[op];
+            uint64_t count = 0;
+            StatsValue *value;
+            int nbins = 0;
+
+            for (i = 0; i < BLOCK_LATENCY_LOG2_NBINS; i++) {
+                count += bins[op][i];
+                if (bins[op][i]) {
+                    nbins = i + 1;
+                }
+            }
+            if (!count) {
+                continue;
+            }
+
+            for (i = 0; i < ARRAY_SIZE(block_latency_percentile_suffix); i++) {
+                value = g_new0(StatsValue, 1);
+                value->type = QTYPE_QNUM;
+                value->u.scalar = block_latency_log2_percentile(
+                    bins[op], count, block_latency_percentile_permille[i]);
+                block_latency_stats_add(&stats_list, names, prefix,
+                                        block_latency_percentile_suffix[i],
+                                        value);
+            }
+
+            value = g_new0(StatsValue, 1);
+            value->type = QTYPE_QLIST;
+            for (i = nbins - 1; i >= 0; i--) {
+                QAPI_LIST_PREPEND(value->u.list, bins[op][i]);
+            }
+            block_latency_stats_add(&stats_list, names, prefix, "histogram",
+                                    value);
+        }
+
+        if (stats_list) {
+            add_stats_entry(result, STATS_PROVIDER_BLOCK, blk_name(blk),
+                            stats_list);
+        }
+    }
+}
+
+static StatsSchemaValueList *
+block_latency_schema_add(StatsSchemaValueList *list, const char *prefix,
+                         const char *suffix, StatsType type)
+{
+    StatsSchemaValueList *entry = g_new0(StatsSchemaValueList, 1);
+
+    entry->value = g_new0(StatsSchemaValue, 1);
+    entry->value->name = g_strdup_printf("%s-latency-%s", prefix, suffix);
+    entry->value->type = type;
+    entry->value->has_unit = true;
+    entry->value->unit = STATS_UNIT_SECONDS;
+    entry->value->has_base = true;
+    entry->value->base = 10;
+    entry->value->exponent = -9;
+    entry->next = list;
+
+    return entry;
+}
+
+static void block_latency_schemas_cb(StatsSchemaList **result, Error **errp)
+{
+    StatsSchemaValueList *stats_list = NULL;
+    int op, i;
+
+    for (op = BLOCK_ACCT_READ; op < BLOCK_MAX_IOTYPE; op++) {
+        const char *prefix = block_acct_stat_prefix[op];
+
+        for (i = 0; i < ARRAY_SIZE(block_latency_percentile_suffix); i++) {
+            stats_list = block_latency_schema_add(
+                stats_list, prefix, block_latency_percentile_suffix[i],
+                STATS_TYPE_INSTANT);
+        }
+        stats_list = block_latency_schema_add(stats_list, prefix, "histogram",
+                                              STATS_TYPE_LOG2_HISTOGRAM);
+    }
+
+    add_stats_schema(result, STATS_PROVIDER_BLOCK, STATS_TARGET_BLOCK,
+                     stats_list);
+}
+
+static void __attribute__((constructor)) block_latency_stats_register(void)
+{
+    add_stats_callbacks(STATS_PROVIDER_BLOCK, block_latency_stats_cb,
+                        block_latency_schemas_cb);
+}
+
+static void graph_lock_stats_add(StatsList **stats_list, strList *names,
+                                 const char *name, const uint64_t *bins)
+{
+    StatsValue *value;
+    Stats *stats;
+    int i, nbins = 0;
+
+    for (i = 0; i < GRAPH_LOCK_WAIT_LOG2_NBINS; i++) {
+        if (bins[i]) {
+            nbins = i + 1;
+        }
+    }
+    if (!nbins || !apply_str_list_filter(name, names)) {
+        return;
+    }
+
+    value = g_new0(StatsValue, 1);
+    value->type = QTYPE_QLIST;
+    for (i = nbins - 1; i >= 0; i--) {
+        QAPI_LIST_PREPEND(value->u.list, bins[i]);
+    }
+
+    stats = g_new0(Stats, 1);
+    stats->name = g_strdup(name);
+    stats->value = value;
+    QAPI_LIST_PREPEND(*stats_list, stats);
+}
+
+static void graph_lock_stats_cb(StatsResultList **result, StatsTarget target,
+                                strList *names, strList *targets, Error **errp)
+{
+    uint64_t rd_bins[GRAPH_LOCK_WAIT_LOG2_NBINS];
+    uint64_t wr_bins[GRAPH_LOCK_WAIT_LOG2_NBINS];
+    StatsList *stats_list = NULL;
+
+    if (target != STATS_TARGET_VM) {
+        return;
+    }
+
+    bdrv_graph_lock_wait_histograms(rd_bins, wr_bins);
+
+    graph_lock_stats_add(&stats_list, names,
+                         "graph-rdlock-wait-histogram", rd_bins);
+    graph_lock_stats_add(&stats_list, names,
+                         "graph-wrlock-wait-histogram", wr_bins);
+
+    if (stats_list) {
+        add_stats_entry(result, STATS_PROVIDER_BLOCK, NULL, stats_list);
+    }
+}
+
+static void graph_lock_schemas_cb(StatsSchemaList **result, Error **errp)
+{
+    static const char * const names[] = {
+        "graph-rdlock-wait-histogram",
+        "graph-wrlock-wait-histogram",
+    };
+    StatsSchemaValueList *stats_list = NULL;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(names); i++) {
+        StatsSchemaValueList *entry = g_new0(StatsSchemaValueList, 1);
+
+        entry->value = g_new0(StatsSchemaValue, 1);
+        entry->value->name = g_strdup(names[i]);
+        entry->value->type = STATS_TYPE_LOG2_HISTOGRAM;
+        entry->value->has_unit = true;
+        entry->value->unit = STATS_UNIT_SECONDS;
+        entry->value->has_base = true;
+        entry->value->base = 10;
+        entry->value->exponent = -9;
+        entry->next = stats_list;
+        stats_list = entry;
+    }
+
+    add_stats_schema(result, STATS_PROVIDER_BLOCK, STATS_TARGET_VM,
+                     stats_list);
+}
+
+static void __attribute__((constructor)) graph_lock_stats_register(void)
+{
+    add_stats_callbacks(STATS_PROVIDER_BLOCK, graph_lock_stats_cb,
+                        graph_lock_schemas_cb);
+}
@@ -44,8 +44,28 @@ struct Qcow2Cache {
     void                   *table_array;
     uint64_t                lru_counter;
     uint64_t                cache_clean_lru_counter;
+    /* Maps host offset to index + 1 of the caching entry */
+    GHashTable             *table_map;
 };
 
+/*
+ * The hash table keys point at the offset field of the entries, so a
+ * mapping must be removed while the slot still holds the old offset and
+ * inserted only once the slot holds the new one.
+ */
+static void qcow2_cache_map_insert(Qcow2Cache *c, int i)
+{
+    g_hash_table_insert(c->table_map, &c->entries[i].offset,
+                        GINT_TO_POINTER(i + 1));
+}
+
+static void qcow2_cache_map_remove(Qcow2Cache *c, int i)
+{
+    if (c->entries[i].offset) {
+        g_hash_table_remove(c->table_map, &c->entries[i].offset);
+    }
+}
+
 static inline void *qcow2_cache_get_table_addr(Qcow2Cache *c, int table)
 {
     return (uint8_t *) c->table_array + (size_t) table * c->table_size;
@@ -106,6 +126,7 @@ void qcow2_cache_clean_unused(Qcow2Cache *c)
 
         /* And count how many we can clean in a row */
         while (i < c->size && can_clean_entry(c, i)) {
+            qcow2_cache_map_remove(c, i);
             c->entries[i].offset = 0;
             c->entries[i].lru_counter = 0;
             i++;
@@ -142,9 +163,11 @@ Qcow2Cache *qcow2_cache_create(BlockDriverState *bs, int num_tables,
         qemu_vfree(c->table_array);
         g_free(c->entries);
         g_free(c);
-        c = NULL;
+        return NULL;
     }
 
+    c->table_map = g_hash_table_new(g_int64_hash, g_int64_equal);
+
     return c;
 }
 
@@ -156,6 +179,7 @@ int qcow2_cache_destroy(Qcow2Cache *c)
         assert(c->entries[i].ref == 0);
     }
 
+    g_hash_table_destroy(c->table_map);
     qemu_vfree(c->table_array);
     g_free(c->entries);
     g_free(c);
@@ -312,6 +336,7 @@ int qcow2_cache_empty(BlockDriverState *bs, Qcow2Cache *c)
         c->entries[i].offset = 0;
         c->entries[i].lru_counter = 0;
     }
+    g_hash_table_remove_all(c->table_map);
 
     qcow2_cache_table_release(c, 0, c->size);
 
@@ -325,9 +350,9 @@ qcow2_cache_do_get(BlockDriverState *bs, Qcow2Cache *c, uint64_t offset,
                    void **table, bool read_from_disk)
 {
     BDRVQcow2State *s = bs->opaque;
+    gpointer value;
     int i;
     int ret;
-    int lookup_index;
     uint64_t min_lru_counter = UINT64_MAX;
     int min_lru_index = -1;
 
@@ -344,20 +369,20 @@ qcow2_cache_do_get(BlockDriverState *bs, Qcow2Cache *c, uint64_t offset,
     }
 
     /* Check if the table is already cached */
-    i = lookup_index = (offset / c->table_size * 4) % c->size;
-    do {
+    value = g_hash_table_lookup(c->table_map, &offset);
+    if (value) {
+        i = GPOINTER_TO_INT(value) - 1;
+        goto found;
+    }
+
+    /* Find the least recently used unreferenced entry to replace */
+    for (i = 0; i < c->size; i++) {
         const Qcow2CachedTable *t = &c->entries[i];
-        if (t->offset == offset) {
-            goto found;
-        }
         if (t->ref == 0 && t->lru_counter < min_lru_counter) {
             min_lru_counter = t->lru_counter;
             min_lru_index = i;
         }
-        if (++i == c->size) {
-            i = 0;
-        }
-    } while (i != lookup_index);
+    }
 
     if (min_lru_index == -1) {
         /* This can't happen in current synchronous code, but leave the check
@@ -377,6 +402,7 @@ qcow2_cache_do_get(BlockDriverState *bs, Qcow2Cache *c, uint64_t offset,
 
     trace_qcow2_cache_get_read(qemu_coroutine_self(),
                                c == s->l2_table_cache, i);
+    qcow2_cache_map_remove(c, i);
     c->entries[i].offset = 0;
     if (read_from_disk) {
         if (c == s->l2_table_cache) {
@@ -391,6 +417,7 @@ qcow2_cache_do_get(BlockDriverState *bs, Qcow2Cache *c, uint64_t offset,
     }
 
     c->entries[i].offset = offset;
+    qcow2_cache_map_insert(c, i);
 
     /* And return the right table */
 found:
@@ -438,12 +465,10 @@ void qcow2_cache_entry_mark_dirty(Qcow2Cache *c, void *table)
 
 void *qcow2_cache_is_table_offset(Qcow2Cache *c, uint64_t offset)
 {
-    int i;
+    gpointer value = g_hash_table_lookup(c->table_map, &offset);
 
-    for (i = 0; i < c->size; i++) {
-        if (c->entries[i].offset == offset) {
-            return qcow2_cache_get_table_addr(c, i);
-        }
+    if (value) {
+        return qcow2_cache_get_table_addr(c, GPOINTER_TO_INT(value) - 1);
     }
     return NULL;
 }
@@ -454,6 +479,7 @@ void qcow2_cache_discard(Qcow2Cache *c, void *table)
 
     assert(c->entries[i].ref == 0);
 
+    qcow2_cache_map_remove(c, i);
     c->entries[i].offset = 0;
     c->entries[i].lru_counter = 0;
     c->entries[i].dirty = false;
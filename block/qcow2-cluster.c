@@ -1172,6 +1172,13 @@ calculate_l2_meta(BlockDriverState *bs, uint64_t host_cluster_offset,
     QCow2SubclusterType type;
     int i;
     bool skip_cow = keep_old;
+    /*
+     * Whether all COW source regions are known to read as zeroes.  Only
+     * tracked for in-place writes into already allocated clusters, which
+     * is where preallocated images spend their time; everything else
+     * stays conservative and lets handle_alloc_space() probe.
+     */
+    bool cow_is_zero = keep_old;
 
     assert(nb_clusters <= s->l2_slice_size - l2_index);
 
@@ -1243,10 +1250,14 @@ calculate_l2_meta(BlockDriverState *bs, uint64_t host_cluster_offset,
         switch (type) {
         case QCOW2_SUBCLUSTER_NORMAL:
             cow_start_from = cow_start_to;
+            cow_is_zero = false;
             break;
         case QCOW2_SUBCLUSTER_ZERO_ALLOC:
         case QCOW2_SUBCLUSTER_UNALLOCATED_ALLOC:
             cow_start_from = sc_index << s->subcluster_bits;
+            if (type != QCOW2_SUBCLUSTER_ZERO_ALLOC && bs->backing) {
+                cow_is_zero = false;
+            }
             break;
         default:
             g_assert_not_reached();
@@ -1288,10 +1299,14 @@ calculate_l2_meta(BlockDriverState *bs, uint64_t host_cluster_offset,
         switch (type) {
         case QCOW2_SUBCLUSTER_NORMAL:
             cow_end_to = cow_end_from;
+            cow_is_zero = false;
             break;
         case QCOW2_SUBCLUSTER_ZERO_ALLOC:
         case QCOW2_SUBCLUSTER_UNALLOCATED_ALLOC:
             cow_end_to = ROUND_UP(cow_end_from, s->subcluster_size);
+            if (type != QCOW2_SUBCLUSTER_ZERO_ALLOC && bs->backing) {
+                cow_is_zero = false;
+            }
             break;
         default:
             g_assert_not_reached();
@@ -1307,6 +1322,7 @@ calculate_l2_meta(BlockDriverState *bs, uint64_t host_cluster_offset,
         .nb_clusters    = nb_clusters,
 
         .keep_old_clusters = keep_old,
+        .cow_is_zero    = cow_is_zero,
 
         .cow_start = {
             .offset     = cow_start_from,
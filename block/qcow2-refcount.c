@@ -1590,6 +1590,9 @@ enum {
     CHECK_FRAG_INFO = 0x2,      /* update BlockFragInfo counters */
 };
 
+/* Number of physically contiguous L2 tables to read in one request */
+#define CHECK_L2_BATCH_SIZE 16
+
 /*
  * Fix L2 entry by making it QCOW2_CLUSTER_ZERO_PLAIN (or making all its present
  * subclusters QCOW2_SUBCLUSTER_ZERO_PLAIN).
@@ -1656,31 +1659,26 @@ fail:
  * referenced in the L2 table. While doing so, performs some checks on L2
  * entries.
  *
+ * @l2_table contains the L2 table as read from @l2_offset; the caller is
+ * responsible for reading it (possibly as part of a larger request covering
+ * several physically contiguous L2 tables).
+ *
  * Returns the number of errors found by the checks or -errno if an internal
  * error occurred.
  */
 static int coroutine_fn GRAPH_RDLOCK
 check_refcounts_l2(BlockDriverState *bs, BdrvCheckResult *res,
                    void **refcount_table,
-                   int64_t *refcount_table_size, int64_t l2_offset,
+                   int64_t *refcount_table_size,
+                   uint64_t *l2_table, int64_t l2_offset,
                    int flags, BdrvCheckMode fix, bool active)
 {
     BDRVQcow2State *s = bs->opaque;
     uint64_t l2_entry, l2_bitmap;
     uint64_t next_contiguous_offset = 0;
     int i, ret;
-    size_t l2_size_bytes = s->l2_size * l2_entry_size(s);
-    g_autofree uint64_t *l2_table = g_malloc(l2_size_bytes);
     bool metadata_overlap;
 
-    /* Read L2 table from disk */
-    ret = bdrv_co_pread(bs->file, l2_offset, l2_size_bytes, l2_table, 0);
-    if (ret < 0) {
-        fprintf(stderr, "ERROR: I/O error in check_refcounts_l2\n");
-        res->check_errors++;
-        return ret;
-    }
-
     /* Do the actual checks */
     for (i = 0; i < s->l2_size; i++) {
         uint64_t coffset;
@@ -1867,9 +1865,11 @@ check_refcounts_l1(BlockDriverState *bs, BdrvCheckResult *res,
 {
     BDRVQcow2State *s = bs->opaque;
     size_t l1_size_bytes = l1_size * L1E_SIZE;
+    size_t l2_size_bytes = s->l2_size * l2_entry_size(s);
     g_autofree uint64_t *l1_table = NULL;
+    g_autofree uint64_t *l2_tables = NULL;
     uint64_t l2_offset;
-    int i, ret;
+    int i, j, batch, ret;
 
     if (!l1_size) {
         return 0;
@@ -1883,7 +1883,8 @@ check_refcounts_l1(BlockDriverState *bs, BdrvCheckResult *res,
     }
 
     l1_table = g_try_malloc(l1_size_bytes);
-    if (l1_table == NULL) {
+    l2_tables = g_try_malloc(l2_size_bytes * CHECK_L2_BATCH_SIZE);
+    if (l1_table == NULL || l2_tables == NULL) {
         res->check_errors++;
         return -ENOMEM;
     }
@@ -1901,40 +1902,70 @@ check_refcounts_l1(BlockDriverState *bs, BdrvCheckResult *res,
     }
 
     /* Do the actual checks */
-    for (i = 0; i < l1_size; i++) {
+    for (i = 0; i < l1_size; i += batch) {
         if (!l1_table[i]) {
+            batch = 1;
             continue;
         }
 
-        if (l1_table[i] & L1E_RESERVED_MASK) {
-            fprintf(stderr, "ERROR found L1 entry with reserved bits set: "
-                    "%" PRIx64 "\n", l1_table[i]);
-            res->corruptions++;
-        }
-
+        /*
+         * L2 tables of sequentially written images are typically allocated
+         * one after the other, so read runs of physically contiguous tables
+         * in a single request instead of one request per table.
+         */
         l2_offset = l1_table[i] & L1E_OFFSET_MASK;
+        batch = 1;
+        if (!offset_into_cluster(s, l2_offset)) {
+            while (batch < CHECK_L2_BATCH_SIZE && i + batch < l1_size &&
+                   l1_table[i + batch] &&
+                   (l1_table[i + batch] & L1E_OFFSET_MASK) ==
+                       l2_offset + (uint64_t)batch * s->cluster_size)
+            {
+                batch++;
+            }
+        }
 
-        /* Mark L2 table as used */
-        ret = qcow2_inc_refcounts_imrt(bs, res,
-                                       refcount_table, refcount_table_size,
-                                       l2_offset, s->cluster_size);
+        ret = bdrv_co_pread(bs->file, l2_offset, batch * l2_size_bytes,
+                            l2_tables, 0);
         if (ret < 0) {
+            fprintf(stderr, "ERROR: I/O error in check_refcounts_l1\n");
+            res->check_errors++;
             return ret;
         }
 
-        /* L2 tables are cluster aligned */
-        if (offset_into_cluster(s, l2_offset)) {
-            fprintf(stderr, "ERROR l2_offset=%" PRIx64 ": Table is not "
-                "cluster aligned; L1 entry corrupted\n", l2_offset);
-            res->corruptions++;
-        }
+        for (j = 0; j < batch; j++) {
+            if (l1_table[i + j] & L1E_RESERVED_MASK) {
+                fprintf(stderr, "ERROR found L1 entry with reserved bits set: "
+                        "%" PRIx64 "\n", l1_table[i + j]);
+                res->corruptions++;
+            }
 
-        /* Process and check L2 entries */
-        ret = check_refcounts_l2(bs, res, refcount_table,
-                                 refcount_table_size, l2_offset, flags,
-                                 fix, active);
-        if (ret < 0) {
-            return ret;
+            l2_offset = l1_table[i + j] & L1E_OFFSET_MASK;
+
+            /* Mark L2 table as used */
+            ret = qcow2_inc_refcounts_imrt(bs, res,
+                                           refcount_table, refcount_table_size,
+                                           l2_offset, s->cluster_size);
+            if (ret < 0) {
+                return ret;
+            }
+
+            /* L2 tables are cluster aligned */
+            if (offset_into_cluster(s, l2_offset)) {
+                fprintf(stderr, "ERROR l2_offset=%" PRIx64 ": Table is not "
+                    "cluster aligned; L1 entry corrupted\n", l2_offset);
+                res->corruptions++;
+            }
+
+            /* Process and check L2 entries */
+            ret = check_refcounts_l2(bs, res, refcount_table,
+                                     refcount_table_size,
+                                     l2_tables + j * (l2_size_bytes /
+                                                      sizeof(uint64_t)),
+                                     l2_offset, flags, fix, active);
+            if (ret < 0) {
+                return ret;
+            }
         }
     }
 
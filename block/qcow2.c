@@ -2549,7 +2549,12 @@ handle_alloc_space(BlockDriverState *bs, QCowL2Meta *l2meta)
             continue;
         }
 
-        ret = is_zero_cow(bs, m);
+        /*
+         * Writes into preallocated zero clusters have their COW regions
+         * flagged as zero when the L2 metadata is inspected; only probe
+         * the block status when that shortcut does not apply.
+         */
+        ret = m->cow_is_zero ? 1 : is_zero_cow(bs, m);
         if (ret < 0) {
             return ret;
         } else if (ret == 0) {
@@ -480,6 +480,13 @@ typedef struct QCowL2Meta
      */
     bool skip_cow;
 
+    /*
+     * Indicates that the COW regions are known to read as zeroes, e.g.
+     * because the write hits preallocated zero clusters.  Allows
+     * handle_alloc_space() to skip its block-status queries.
+     */
+    bool cow_is_zero;
+
     /**
      * Indicates that this is not a normal write request but a preallocation.
      * If the image has extended L2 entries this means that no new individual
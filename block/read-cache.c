@@ -0,0 +1,495 @@
+/*
+ * Read cache filter block driver
+ *
+ * Keeps a host-RAM cache of cluster-sized blocks of guest data so that
+ * repeated reads of the same clusters are served locally instead of being
+ * re-fetched from a (potentially remote) backend such as nbd or curl.
+ *
+ * The cache uses the 2Q replacement policy: clusters seen for the first
+ * time go through a small FIFO (A1in) and are only promoted to the main
+ * LRU list (Am) when they are accessed again after leaving the FIFO, which
+ * keeps one-time sequential scans from flushing the frequently used
+ * working set.  Clusters evicted from the FIFO leave a data-less ghost
+ * entry (A1out) behind that is used to detect such re-accesses.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 or
+ * (at your option) any later version of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qemu/osdep.h"
+#include "block/block-io.h"
+#include "block/block_int.h"
+#include "qemu/host-utils.h"
+#include "qemu/lockable.h"
+#include "qemu/module.h"
+#include "qemu/option.h"
+#include "qemu/units.h"
+#include "qapi/error.h"
+
+#define READ_CACHE_OPT_CACHE_SIZE "cache-size"
+#define READ_CACHE_OPT_CLUSTER_SIZE "cluster-size"
+
+#define READ_CACHE_DEFAULT_CACHE_SIZE (32 * MiB)
+#define READ_CACHE_DEFAULT_CLUSTER_SIZE (64 * KiB)
+
+/* Which list a cache entry is currently on */
+enum ReadCacheQueue {
+    READ_CACHE_Q_AM,        /* main LRU list, frequently used clusters */
+    READ_CACHE_Q_A1IN,      /* FIFO of clusters seen once, still resident */
+    READ_CACHE_Q_A1OUT,     /* FIFO of ghost entries without data */
+};
+
+typedef struct ReadCacheEntry {
+    int64_t offset;         /* cluster-aligned guest offset */
+    uint8_t *data;          /* cluster contents, NULL for ghost entries */
+    enum ReadCacheQueue queue;
+    QTAILQ_ENTRY(ReadCacheEntry) next;
+} ReadCacheEntry;
+
+typedef struct BDRVReadCacheState {
+    uint64_t cluster_size;
+    uint64_t max_clusters;  /* resident capacity (Am + A1in) */
+    uint64_t kin;           /* capacity of A1in */
+    uint64_t kout;          /* capacity of A1out */
+
+    /* Protects everything below; never held across I/O */
+    QemuMutex lock;
+
+    GHashTable *table;      /* offset -> ReadCacheEntry, including ghosts */
+    QTAILQ_HEAD(, ReadCacheEntry) am;
+    QTAILQ_HEAD(, ReadCacheEntry) a1in;
+    QTAILQ_HEAD(, ReadCacheEntry) a1out;
+    uint64_t n_am;
+    uint64_t n_a1in;
+    uint64_t n_a1out;
+
+    /*
+     * Bumped whenever cached data is invalidated; a miss that was reading
+     * from the backend while this changed must not insert its result.
+     */
+    uint64_t inval_gen;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t hit_bytes;
+} BDRVReadCacheState;
+
+static QemuOptsList read_cache_opts = {
+    .name = "read-cache",
+    .head = QTAILQ_HEAD_INITIALIZER(read_cache_opts.head),
+    .desc = {
+        {
+            .name = READ_CACHE_OPT_CACHE_SIZE,
+            .type = QEMU_OPT_SIZE,
+            .help = "Total size of the cache in bytes",
+        },
+        {
+            .name = READ_CACHE_OPT_CLUSTER_SIZE,
+            .type = QEMU_OPT_SIZE,
+            .help = "Size of a cache cluster in bytes",
+        },
+        { /* end of list */ }
+    },
+};
+
+static void read_cache_entry_free(ReadCacheEntry *entry)
+{
+    qemu_vfree(entry->data);
+    g_free(entry);
+}
+
+/* Called with s->lock held */
+static void read_cache_remove(BDRVReadCacheState *s, ReadCacheEntry *entry)
+{
+    switch (entry->queue) {
+    case READ_CACHE_Q_AM:
+        QTAILQ_REMOVE(&s->am, entry, next);
+        s->n_am--;
+        break;
+    case READ_CACHE_Q_A1IN:
+        QTAILQ_REMOVE(&s->a1in, entry, next);
+        s->n_a1in--;
+        break;
+    case READ_CACHE_Q_A1OUT:
+        QTAILQ_REMOVE(&s->a1out, entry, next);
+        s->n_a1out--;
+        break;
+    default:
+        abort();
+    }
+    g_hash_table_remove(s->table, &entry->offset);
+    read_cache_entry_free(entry);
+}
+
+/*
+ * Make room for one resident cluster.  Called with s->lock held.
+ */
+static void read_cache_reclaim(BDRVReadCacheState *s)
+{
+    ReadCacheEntry *old;
+
+    if (s->n_am + s->n_a1in < s->max_clusters) {
+        return;
+    }
+
+    if (s->n_a1in > s->kin || !s->n_am) {
+        /* Demote the oldest once-seen cluster to a ghost entry */
+        old = QTAILQ_FIRST(&s->a1in);
+        QTAILQ_REMOVE(&s->a1in, old, next);
+        s->n_a1in--;
+        qemu_vfree(old->data);
+        old->data = NULL;
+        old->queue = READ_CACHE_Q_A1OUT;
+        QTAILQ_INSERT_TAIL(&s->a1out, old, next);
+        if (++s->n_a1out > s->kout) {
+            read_cache_remove(s, QTAILQ_FIRST(&s->a1out));
+        }
+    } else {
+        /* Evict the least recently used cluster without leaving a ghost */
+        read_cache_remove(s, QTAILQ_FIRST(&s->am));
+    }
+}
+
+/*
+ * Insert a cluster read from the backend.  Takes ownership of @data
+ * (or frees it if the cluster does not get inserted after all).
+ * Called with s->lock held.
+ */
+static void read_cache_insert(BDRVReadCacheState *s, int64_t offset,
+                              uint8_t *data)
+{
+    ReadCacheEntry *entry = g_hash_table_lookup(s->table, &offset);
+
+    if (entry && entry->data) {
+        /* A concurrent miss on the same cluster beat us to it */
+        qemu_vfree(data);
+        return;
+    }
+
+    if (entry) {
+        /*
+         * A ghost entry means the cluster was recently evicted from the
+         * FIFO and is being used again: promote it to the main LRU list.
+         * Take it off A1out before reclaiming so that trimming A1out
+         * cannot free it.
+         */
+        QTAILQ_REMOVE(&s->a1out, entry, next);
+        s->n_a1out--;
+        read_cache_reclaim(s);
+        entry->data = data;
+        entry->queue = READ_CACHE_Q_AM;
+        QTAILQ_INSERT_TAIL(&s->am, entry, next);
+        s->n_am++;
+    } else {
+        read_cache_reclaim(s);
+        entry = g_new0(ReadCacheEntry, 1);
+        entry->offset = offset;
+        entry->data = data;
+        entry->queue = READ_CACHE_Q_A1IN;
+        QTAILQ_INSERT_TAIL(&s->a1in, entry, next);
+        s->n_a1in++;
+        g_hash_table_insert(s->table, &entry->offset, entry);
+    }
+}
+
+/*
+ * Drop all cached clusters overlapping [offset, offset + bytes).
+ * Ghost entries carry no data and may stay.
+ *
+ * Must be called after the write reached the backend, not before: a
+ * concurrent miss that sampled inval_gen after an early bump could
+ * read pre-write data from the backend and insert it with a matching
+ * generation.  When called afterwards, such an insertion either
+ * happens first and is removed here, or fails the generation check.
+ */
+static void read_cache_invalidate(BDRVReadCacheState *s, int64_t offset,
+                                  int64_t bytes)
+{
+    int64_t start = QEMU_ALIGN_DOWN(offset, s->cluster_size);
+    int64_t end = offset + bytes;
+    int64_t cluster;
+
+    QEMU_LOCK_GUARD(&s->lock);
+
+    s->inval_gen++;
+
+    if ((uint64_t)(end - start) / s->cluster_size >
+        g_hash_table_size(s->table)) {
+        /* Walking the range would take longer than walking the cache */
+        ReadCacheEntry *entry, *tmp;
+
+        QTAILQ_FOREACH_SAFE(entry, &s->am, next, tmp) {
+            if (entry->offset >= start && entry->offset < end) {
+                read_cache_remove(s, entry);
+            }
+        }
+        QTAILQ_FOREACH_SAFE(entry, &s->a1in, next, tmp) {
+            if (entry->offset >= start && entry->offset < end) {
+                read_cache_remove(s, entry);
+            }
+        }
+        return;
+    }
+
+    for (cluster = start; cluster < end; cluster += s->cluster_size) {
+        ReadCacheEntry *entry = g_hash_table_lookup(s->table, &cluster);
+
+        if (entry && entry->data) {
+            read_cache_remove(s, entry);
+        }
+    }
+}
+
+static int read_cache_open(BlockDriverState *bs, QDict *options, int flags,
+                           Error **errp)
+{
+    BDRVReadCacheState *s = bs->opaque;
+    QemuOpts *opts;
+    uint64_t cache_size, cluster_size;
+    int ret;
+
+    ret = bdrv_open_file_child(NULL, options, "file", bs, errp);
+    if (ret < 0) {
+        return ret;
+    }
+
+    GRAPH_RDLOCK_GUARD_MAINLOOP();
+
+    opts = qemu_opts_create(&read_cache_opts, NULL, 0, &error_abort);
+    if (!qemu_opts_absorb_qdict(opts, options, errp)) {
+        qemu_opts_del(opts);
+        return -EINVAL;
+    }
+    cache_size = qemu_opt_get_size(opts, READ_CACHE_OPT_CACHE_SIZE,
+                                   READ_CACHE_DEFAULT_CACHE_SIZE);
+    cluster_size = qemu_opt_get_size(opts, READ_CACHE_OPT_CLUSTER_SIZE,
+                                     READ_CACHE_DEFAULT_CLUSTER_SIZE);
+    qemu_opts_del(opts);
+
+    if (!is_power_of_2(cluster_size) || cluster_size < BDRV_SECTOR_SIZE) {
+        error_setg(errp, "Cluster size must be a power of two not smaller "
+                   "than %u", BDRV_SECTOR_SIZE);
+        return -EINVAL;
+    }
+    if (cache_size < cluster_size) {
+        error_setg(errp, "Cache size must be at least one cluster");
+        return -EINVAL;
+    }
+
+    s->cluster_size = cluster_size;
+    s->max_clusters = cache_size / cluster_size;
+    s->kin = MAX(s->max_clusters / 4, 1);
+    s->kout = MAX(s->max_clusters / 2, 1);
+
+    qemu_mutex_init(&s->lock);
+    s->table = g_hash_table_new(g_int64_hash, g_int64_equal);
+    QTAILQ_INIT(&s->am);
+    QTAILQ_INIT(&s->a1in);
+    QTAILQ_INIT(&s->a1out);
+
+    bs->supported_write_flags = BDRV_REQ_WRITE_UNCHANGED |
+        (BDRV_REQ_FUA & bs->file->bs->supported_write_flags);
+
+    bs->supported_zero_flags = BDRV_REQ_WRITE_UNCHANGED |
+        ((BDRV_REQ_FUA | BDRV_REQ_MAY_UNMAP | BDRV_REQ_NO_FALLBACK) &
+            bs->file->bs->supported_zero_flags);
+
+    return 0;
+}
+
+static void read_cache_close(BlockDriverState *bs)
+{
+    BDRVReadCacheState *s = bs->opaque;
+    ReadCacheEntry *entry, *tmp;
+
+    QTAILQ_FOREACH_SAFE(entry, &s->am, next, tmp) {
+        read_cache_entry_free(entry);
+    }
+    QTAILQ_FOREACH_SAFE(entry, &s->a1in, next, tmp) {
+        read_cache_entry_free(entry);
+    }
+    QTAILQ_FOREACH_SAFE(entry, &s->a1out, next, tmp) {
+        read_cache_entry_free(entry);
+    }
+    g_hash_table_destroy(s->table);
+    qemu_mutex_destroy(&s->lock);
+}
+
+static int64_t coroutine_fn GRAPH_RDLOCK
+read_cache_co_getlength(BlockDriverState *bs)
+{
+    return bdrv_co_getlength(bs->file->bs);
+}
+
+static int coroutine_fn GRAPH_RDLOCK
+read_cache_co_preadv_part(BlockDriverState *bs, int64_t offset, int64_t bytes,
+                          QEMUIOVector *qiov, size_t qiov_offset,
+                          BdrvRequestFlags flags)
+{
+    BDRVReadCacheState *s = bs->opaque;
+    int64_t len, cur;
+    int ret;
+
+    len = bdrv_co_getlength(bs->file->bs);
+    if (len < 0) {
+        return len;
+    }
+
+    for (cur = offset; cur < offset + bytes; ) {
+        int64_t cluster = QEMU_ALIGN_DOWN(cur, s->cluster_size);
+        int64_t chunk = MIN(cluster + s->cluster_size, offset + bytes) - cur;
+        ReadCacheEntry *entry;
+        uint64_t gen;
+        uint8_t *data;
+
+        if (cluster + s->cluster_size > len) {
+            /* Partial cluster at the end of the image, don't cache it */
+            return bdrv_co_preadv_part(bs->file, cur, offset + bytes - cur,
+                                       qiov, qiov_offset + (cur - offset),
+                                       flags);
+        }
+
+        WITH_QEMU_LOCK_GUARD(&s->lock) {
+            entry = g_hash_table_lookup(s->table, &cluster);
+            if (entry && entry->data) {
+                if (entry->queue == READ_CACHE_Q_AM) {
+                    QTAILQ_REMOVE(&s->am, entry, next);
+                    QTAILQ_INSERT_TAIL(&s->am, entry, next);
+                }
+                qemu_iovec_from_buf(qiov, qiov_offset + (cur - offset),
+                                    entry->data + (cur - cluster), chunk);
+                s->hits++;
+                s->hit_bytes += chunk;
+            } else {
+                entry = NULL;
+                s->misses++;
+            }
+            gen = s->inval_gen;
+        }
+
+        if (!entry) {
+            data = qemu_blockalign(bs, s->cluster_size);
+            ret = bdrv_co_pread(bs->file, cluster, s->cluster_size, data, 0);
+            if (ret < 0) {
+                qemu_vfree(data);
+                return ret;
+            }
+            qemu_iovec_from_buf(qiov, qiov_offset + (cur - offset),
+                                data + (cur - cluster), chunk);
+
+            WITH_QEMU_LOCK_GUARD(&s->lock) {
+                if (gen == s->inval_gen) {
+                    read_cache_insert(s, cluster, data);
+                } else {
+                    /* The cluster may have been written meanwhile */
+                    qemu_vfree(data);
+                }
+            }
+        }
+
+        cur += chunk;
+    }
+
+    return 0;
+}
+
+static int coroutine_fn GRAPH_RDLOCK
+read_cache_co_pwritev_part(BlockDriverState *bs, int64_t offset, int64_t bytes,
+                           QEMUIOVector *qiov, size_t qiov_offset,
+                           BdrvRequestFlags flags)
+{
+    int ret = bdrv_co_pwritev_part(bs->file, offset, bytes, qiov, qiov_offset,
+                                   flags);
+
+    /* Invalidate even on failure, the write may have partially hit disk */
+    read_cache_invalidate(bs->opaque, offset, bytes);
+    return ret;
+}
+
+static int coroutine_fn GRAPH_RDLOCK
+read_cache_co_pwrite_zeroes(BlockDriverState *bs, int64_t offset,
+                            int64_t bytes, BdrvRequestFlags flags)
+{
+    int ret = bdrv_co_pwrite_zeroes(bs->file, offset, bytes, flags);
+
+    read_cache_invalidate(bs->opaque, offset, bytes);
+    return ret;
+}
+
+static int coroutine_fn GRAPH_RDLOCK
+read_cache_co_pdiscard(BlockDriverState *bs, int64_t offset, int64_t bytes)
+{
+    int ret = bdrv_co_pdiscard(bs->file, offset, bytes);
+
+    read_cache_invalidate(bs->opaque, offset, bytes);
+    return ret;
+}
+
+static int coroutine_fn GRAPH_RDLOCK
+read_cache_co_flush(BlockDriverState *bs)
+{
+    return bdrv_co_flush(bs->file->bs);
+}
+
+static BlockStatsSpecific *read_cache_get_specific_stats(BlockDriverState *bs)
+{
+    BDRVReadCacheState *s = bs->opaque;
+    BlockStatsSpecific *stats = g_new(BlockStatsSpecific, 1);
+
+    stats->driver = BLOCKDEV_DRIVER_READ_CACHE;
+    qemu_mutex_lock(&s->lock);
+    stats->u.read_cache = (BlockStatsSpecificReadCache) {
+        .hits = s->hits,
+        .misses = s->misses,
+        .hit_bytes = s->hit_bytes,
+    };
+    qemu_mutex_unlock(&s->lock);
+
+    return stats;
+}
+
+static const char *const read_cache_strong_runtime_opts[] = {
+    READ_CACHE_OPT_CACHE_SIZE,
+    READ_CACHE_OPT_CLUSTER_SIZE,
+
+    NULL
+};
+
+static BlockDriver bdrv_read_cache = {
+    .format_name                        = "read-cache",
+    .instance_size                      = sizeof(BDRVReadCacheState),
+
+    .bdrv_open                          = read_cache_open,
+    .bdrv_close                         = read_cache_close,
+    .bdrv_child_perm                    = bdrv_default_perms,
+
+    .bdrv_co_getlength                  = read_cache_co_getlength,
+
+    .bdrv_co_preadv_part                = read_cache_co_preadv_part,
+    .bdrv_co_pwritev_part               = read_cache_co_pwritev_part,
+    .bdrv_co_pwrite_zeroes              = read_cache_co_pwrite_zeroes,
+    .bdrv_co_pdiscard                   = read_cache_co_pdiscard,
+    .bdrv_co_flush                      = read_cache_co_flush,
+
+    .bdrv_get_specific_stats            = read_cache_get_specific_stats,
+
+    .strong_runtime_opts                = read_cache_strong_runtime_opts,
+    .is_filter                          = true,
+};
+
+static void bdrv_read_cache_init(void)
+{
+    bdrv_register(&bdrv_read_cache);
+}
+
+block_init(bdrv_read_cache_init);
@@ -70,6 +70,19 @@ struct ThrottleGroup {
     bool is_initialized;
     char *name; /* This is constant during the lifetime of the group */
 
+    /*
+     * Optional aggregate pool this group draws from; constant after
+     * initialization.  A request must have budget at every level of the
+     * hierarchy before it can run, so a group may allow bursts up to its
+     * own limits without ever exceeding the parent's cap.  The parent
+     * chain is acyclic by construction since parents can only be set to
+     * already initialized groups.  These fields are protected by the
+     * global QEMU mutex.
+     */
+    ThrottleGroup *parent;
+    char *parent_name;
+    unsigned nr_children;
+
     QemuMutex lock; /* This lock protects the following four fields */
     ThrottleState ts;
     QLIST_HEAD(, ThrottleGroupMember) head;
@@ -283,6 +296,20 @@ static bool throttle_group_schedule_timer(ThrottleGroupMember *tgm,
 
     must_wait = throttle_schedule_timer(ts, tt, direction);
 
+    /* Every pool up the hierarchy must also have budget for this request */
+    if (!must_wait) {
+        ThrottleGroup *parent;
+
+        for (parent = tg->parent; parent; parent = parent->parent) {
+            qemu_mutex_lock(&parent->lock);
+            must_wait = throttle_schedule_timer(&parent->ts, tt, direction);
+            qemu_mutex_unlock(&parent->lock);
+            if (must_wait) {
+                break;
+            }
+        }
+    }
+
     /* If a timer just got armed, set tgm as the current token */
     if (must_wait) {
         tg->tokens[direction] = tgm;
@@ -387,8 +414,13 @@ void coroutine_fn throttle_group_co_io_limits_intercept(ThrottleGroupMember *tgm
         tgm->pending_reqs[direction]--;
     }
 
-    /* The I/O will be executed, so do the accounting */
+    /* The I/O will be executed, so do the accounting at every level */
     throttle_account(tgm->throttle_state, direction, bytes);
+    for (ThrottleGroup *parent = tg->parent; parent; parent = parent->parent) {
+        qemu_mutex_lock(&parent->lock);
+        throttle_account(&parent->ts, direction, bytes);
+        qemu_mutex_unlock(&parent->lock);
+    }
 
     /* Schedule the next request */
     schedule_next_request(tgm, direction);
@@ -792,6 +824,18 @@ static void throttle_group_obj_complete(UserCreatable *obj, Error **errp)
         return;
     }
     throttle_config(&tg->ts, tg->clock_type, &cfg);
+
+    /* resolve the parent pool, which must be initialized already */
+    if (tg->parent_name) {
+        tg->parent = throttle_group_by_name(tg->parent_name);
+        if (!tg->parent) {
+            error_setg(errp, "Parent throttle group '%s' does not exist",
+                       tg->parent_name);
+            return;
+        }
+        tg->parent->nr_children++;
+    }
+
     QTAILQ_INSERT_TAIL(&throttle_groups, tg, list);
     tg->is_initialized = true;
 }
@@ -804,7 +848,11 @@ static void throttle_group_obj_finalize(Object *obj)
     if (tg->is_initialized) {
         QTAILQ_REMOVE(&throttle_groups, tg, list);
     }
+    if (tg->parent) {
+        tg->parent->nr_children--;
+    }
     qemu_mutex_destroy(&tg->lock);
+    g_free(tg->parent_name);
     g_free(tg->name);
 }
 
@@ -929,9 +977,31 @@ static void throttle_group_get_limits(Object *obj, Visitor *v,
     visit_type_ThrottleLimits(v, name, &argp, errp);
 }
 
+static void throttle_group_set_parent(Object *obj, const char *value,
+                                      Error **errp)
+{
+    ThrottleGroup *tg = THROTTLE_GROUP(obj);
+
+    if (tg->is_initialized) {
+        error_setg(errp, "Property cannot be set after initialization");
+        return;
+    }
+
+    g_free(tg->parent_name);
+    tg->parent_name = g_strdup(value);
+}
+
+static char *throttle_group_get_parent(Object *obj, Error **errp)
+{
+    ThrottleGroup *tg = THROTTLE_GROUP(obj);
+
+    return g_strdup(tg->parent_name);
+}
+
 static bool throttle_group_can_be_deleted(UserCreatable *uc)
 {
-    return OBJECT(uc)->ref == 1;
+    /* a group that still acts as a parent pool must stay around */
+    return OBJECT(uc)->ref == 1 && THROTTLE_GROUP(uc)->nr_children == 0;
 }
 
 static void throttle_group_obj_class_init(ObjectClass *klass, void *class_data)
@@ -958,6 +1028,11 @@ static void throttle_group_obj_class_init(ObjectClass *klass, void *class_data)
                               throttle_group_get_limits,
                               throttle_group_set_limits,
                               NULL, NULL);
+
+    /* parent pool */
+    object_class_property_add_str(klass, "parent",
+                                  throttle_group_get_parent,
+                                  throttle_group_set_parent);
 }
 
 static const TypeInfo throttle_group_info = {
@@ -275,20 +275,79 @@ static void vdi_header_print(VdiHeader *header)
     logout("uuid parent %s\n", uuidstr);
 }
 
-static int coroutine_fn vdi_co_check(BlockDriverState *bs, BdrvCheckResult *res,
-                                     BdrvCheckMode fix)
+/*
+ * Load the block map on first use.  Opening the image only reads the
+ * header, so mere inspection (e.g. qemu-img info) does not pay for
+ * reading a map of up to several megabytes.
+ *
+ * Called with s->bmap_lock held for reading; temporarily upgrades to the
+ * write lock for the actual load.
+ */
+static int coroutine_fn GRAPH_RDLOCK
+vdi_co_bmap_load(BlockDriverState *bs)
+{
+    BDRVVdiState *s = bs->opaque;
+    uint32_t *bmap;
+    size_t bmap_size;
+    int ret;
+
+    if (likely(s->bmap)) {
+        return 0;
+    }
+
+    qemu_co_rwlock_upgrade(&s->bmap_lock);
+    if (s->bmap) {
+        /* A concurrent request loaded the block map for us. */
+        qemu_co_rwlock_downgrade(&s->bmap_lock);
+        return 0;
+    }
+
+    bmap_size = s->header.blocks_in_image * sizeof(uint32_t);
+    bmap_size = DIV_ROUND_UP(bmap_size, SECTOR_SIZE);
+    bmap = qemu_try_blockalign(bs->file->bs, bmap_size * SECTOR_SIZE);
+    if (bmap == NULL) {
+        ret = -ENOMEM;
+        goto fail;
+    }
+
+    ret = bdrv_co_pread(bs->file, s->header.offset_bmap,
+                        bmap_size * SECTOR_SIZE, bmap, 0);
+    if (ret < 0) {
+        qemu_vfree(bmap);
+        goto fail;
+    }
+
+    s->bmap = bmap;
+    ret = 0;
+
+ fail:
+    qemu_co_rwlock_downgrade(&s->bmap_lock);
+    return ret;
+}
+
+static int coroutine_fn GRAPH_RDLOCK
+vdi_co_check(BlockDriverState *bs, BdrvCheckResult *res, BdrvCheckMode fix)
 {
     /* TODO: additional checks possible. */
     BDRVVdiState *s = (BDRVVdiState *)bs->opaque;
     uint32_t blocks_allocated = 0;
     uint32_t block;
     uint32_t *bmap;
+    int ret;
     logout("\n");
 
     if (fix) {
         return -ENOTSUP;
     }
 
+    qemu_co_rwlock_rdlock(&s->bmap_lock);
+    ret = vdi_co_bmap_load(bs);
+    qemu_co_rwlock_unlock(&s->bmap_lock);
+    if (ret < 0) {
+        res->check_errors++;
+        return ret;
+    }
+
     bmap = g_try_new(uint32_t, s->header.blocks_in_image);
     if (s->header.blocks_in_image && bmap == NULL) {
         res->check_errors++;
@@ -481,19 +540,12 @@ static int vdi_open(BlockDriverState *bs, QDict *options, int flags,
     s->bmap_sector = header.offset_bmap / SECTOR_SIZE;
     s->header = header;
 
-    bmap_size = header.blocks_in_image * sizeof(uint32_t);
-    bmap_size = DIV_ROUND_UP(bmap_size, SECTOR_SIZE);
-    s->bmap = qemu_try_blockalign(bs->file->bs, bmap_size * SECTOR_SIZE);
-    if (s->bmap == NULL) {
-        ret = -ENOMEM;
-        goto fail;
-    }
-
-    ret = bdrv_pread(bs->file, header.offset_bmap, bmap_size * SECTOR_SIZE,
-                     s->bmap, 0);
-    if (ret < 0) {
-        goto fail_free_bmap;
-    }
+    /*
+     * The block map is loaded lazily by vdi_co_bmap_load(): merely opening
+     * the image for inspection (e.g. qemu-img info) does not pay for
+     * reading a map of up to several megabytes.
+     */
+    s->bmap = NULL;
 
     /* Disable migration when vdi images are used */
     error_setg(&s->migration_blocker, "The vdi format used by node '%s' "
@@ -502,16 +554,13 @@ static int vdi_open(BlockDriverState *bs, QDict *options, int flags,
 
     ret = migrate_add_blocker_normal(&s->migration_blocker, errp);
     if (ret < 0) {
-        goto fail_free_bmap;
+        goto fail;
     }
 
     qemu_co_rwlock_init(&s->bmap_lock);
 
     return 0;
 
- fail_free_bmap:
-    qemu_vfree(s->bmap);
-
  fail:
     return ret;
 }
@@ -530,9 +579,19 @@ vdi_co_block_status(BlockDriverState *bs, bool want_zero, int64_t offset,
     BDRVVdiState *s = (BDRVVdiState *)bs->opaque;
     size_t bmap_index = offset / s->block_size;
     size_t index_in_block = offset % s->block_size;
-    uint32_t bmap_entry = le32_to_cpu(s->bmap[bmap_index]);
+    uint32_t bmap_entry;
     int result;
 
+    qemu_co_rwlock_rdlock(&s->bmap_lock);
+    result = vdi_co_bmap_load(bs);
+    if (result == 0) {
+        bmap_entry = le32_to_cpu(s->bmap[bmap_index]);
+    }
+    qemu_co_rwlock_unlock(&s->bmap_lock);
+    if (result < 0) {
+        return result;
+    }
+
     logout("%p, %" PRId64 ", %" PRId64 ", %p\n", bs, offset, bytes, pnum);
     *pnum = MIN(s->block_size - index_in_block, bytes);
     result = VDI_IS_ALLOCATED(bmap_entry);
@@ -574,6 +633,11 @@ vdi_co_preadv(BlockDriverState *bs, int64_t offset, int64_t bytes,
 
         /* prepare next AIO request */
         qemu_co_rwlock_rdlock(&s->bmap_lock);
+        ret = vdi_co_bmap_load(bs);
+        if (ret < 0) {
+            qemu_co_rwlock_unlock(&s->bmap_lock);
+            break;
+        }
         bmap_entry = le32_to_cpu(s->bmap[block_index]);
         qemu_co_rwlock_unlock(&s->bmap_lock);
         if (!VDI_IS_ALLOCATED(bmap_entry)) {
@@ -634,6 +698,11 @@ vdi_co_pwritev(BlockDriverState *bs, int64_t offset, int64_t bytes,
 
         /* prepare next AIO request */
         qemu_co_rwlock_rdlock(&s->bmap_lock);
+        ret = vdi_co_bmap_load(bs);
+        if (ret < 0) {
+            qemu_co_rwlock_unlock(&s->bmap_lock);
+            break;
+        }
         bmap_entry = le32_to_cpu(s->bmap[block_index]);
         if (!VDI_IS_ALLOCATED(bmap_entry)) {
             /* Allocate new block and write to it. */
@@ -112,6 +112,7 @@ static void GRAPH_RDLOCK vhdx_log_reset(BlockDriverState *bs, BDRVVHDXState *s)
 {
     MSGUID guid = { 0 };
     s->log.read = s->log.write = 0;
+    s->log.tail = 0;
     /* a log guid of 0 indicates an empty log to any parser of v0
      * VHDX logs */
     vhdx_update_headers(bs, s, false, &guid);
@@ -573,7 +574,11 @@ vhdx_log_flush(BlockDriverState *bs, BDRVVHDXState *s, VHDXLogSequence *logs)
         desc_entries = NULL;
     }
 
-    ret = bdrv_flush(bs);
+    /*
+     * Flush the file child directly: going through the vhdx node here
+     * would recurse into vhdx_co_flush_to_os() while committing the log.
+     */
+    ret = bdrv_flush(bs->file->bs);
     if (ret < 0) {
         goto exit;
     }
@@ -895,12 +900,8 @@ vhdx_log_write(BlockDriverState *bs, BDRVVHDXState *s,
     if (guid_eq(header->log_guid, zero_guid)) {
         vhdx_guid_generate(&new_guid);
         vhdx_update_headers(bs, s, false, &new_guid);
-    } else {
-        /* currently, we require that the log be flushed after
-         * every write. */
-        ret = -ENOTSUP;
-        goto exit;
     }
+    /* else the log is already active; append to the current sequence */
 
     /* 0 is an invalid sequence number, but may also represent the first
      * log write (or a wrapped seq) */
@@ -1031,8 +1032,10 @@ vhdx_log_write(BlockDriverState *bs, BDRVVHDXState *s,
     }
 
     s->log.sequence++;
-    /* write new tail */
-    s->log.tail = s->log.write;
+    /*
+     * The tail stays at the start of the active sequence; it only advances
+     * once the accumulated entries have been replayed by vhdx_log_commit().
+     */
 
 exit:
     qemu_vfree(buffer);
@@ -1040,32 +1043,70 @@ exit:
     return ret;
 }
 
-/* Perform a log write, and then immediately flush the entire log */
+/*
+ * Queue the BAT update of an allocating write for the next log commit.
+ *
+ * The in-memory BAT was already updated by the caller, so subsequent
+ * requests see the new mapping; the on-disk BAT is only touched by
+ * vhdx_log_commit().  A crash before the commit loses the allocation
+ * together with the data writes into it, none of which were flushed yet,
+ * which leaves the image in its prior consistent state.
+ */
 int coroutine_fn
-vhdx_log_write_and_flush(BlockDriverState *bs, BDRVVHDXState *s,
-                         void *data, uint32_t length, uint64_t offset)
+vhdx_log_queue_bat_update(BlockDriverState *bs, BDRVVHDXState *s,
+                          uint64_t bat_entry_le, uint64_t bat_offset)
+{
+    assert(s->bat_batch_len < VHDX_BAT_BATCH_MAX);
+
+    s->bat_batch[s->bat_batch_len++] = (VHDXBatUpdate) {
+        .entry_le = bat_entry_le,
+        .offset = bat_offset,
+    };
+
+    if (s->bat_batch_len == VHDX_BAT_BATCH_MAX) {
+        return vhdx_log_commit(bs, s);
+    }
+
+    return 0;
+}
+
+/*
+ * Write one log entry per queued BAT update, then flush the entire log and
+ * replay it into the BAT.  Called with s->lock held.
+ */
+int coroutine_fn
+vhdx_log_commit(BlockDriverState *bs, BDRVVHDXState *s)
 {
     int ret = 0;
-    VHDXLogSequence logs = { .valid = true,
-                             .count = 1,
-                             .hdr = { 0 } };
+    unsigned int i;
+    VHDXLogSequence logs;
+
+    if (s->bat_batch_len == 0) {
+        return 0;
+    }
 
+    logs = (VHDXLogSequence) { .valid = true,
+                               .count = s->bat_batch_len,
+                               .hdr = { 0 } };
 
     /* Make sure data written (new and/or changed blocks) is stable
-     * on disk, before creating log entry */
-    ret = bdrv_co_flush(bs);
+     * on disk, before creating log entries */
+    ret = bdrv_co_flush(bs->file->bs);
     if (ret < 0) {
         goto exit;
     }
 
-    ret = vhdx_log_write(bs, s, data, length, offset);
-    if (ret < 0) {
-        goto exit;
+    for (i = 0; i < s->bat_batch_len; i++) {
+        ret = vhdx_log_write(bs, s, &s->bat_batch[i].entry_le,
+                             sizeof(VHDXBatEntry), s->bat_batch[i].offset);
+        if (ret < 0) {
+            goto exit;
+        }
     }
     logs.log = s->log;
 
     /* Make sure log is stable on disk */
-    ret = bdrv_co_flush(bs);
+    ret = bdrv_co_flush(bs->file->bs);
     if (ret < 0) {
         goto exit;
     }
@@ -1076,6 +1117,8 @@ vhdx_log_write_and_flush(BlockDriverState *bs, BDRVVHDXState *s,
     }
 
     s->log = logs.log;
+    s->log.tail = s->log.write;
+    s->bat_batch_len = 0;
 
 exit:
     return ret;
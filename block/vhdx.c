@@ -1470,10 +1470,12 @@ vhdx_co_writev(BlockDriverState *bs, int64_t sector_num, int nb_sectors,
             }
 
             if (bat_update) {
-                /* this will update the BAT entry into the log journal, and
-                 * then flush the log journal out to disk */
-                ret =  vhdx_log_write_and_flush(bs, s, &bat_entry,
-                                                sizeof(VHDXBatEntry),
+                /*
+                 * Queue the BAT entry for the log journal; the journal is
+                 * committed in batches, so sequential allocating writes
+                 * amortize the metadata flushes across many blocks.
+                 */
+                ret = vhdx_log_queue_bat_update(bs, s, bat_entry,
                                                 bat_entry_offset);
                 if (ret < 0) {
                     goto exit;
@@ -1490,6 +1492,11 @@ vhdx_co_writev(BlockDriverState *bs, int64_t sector_num, int nb_sectors,
     goto exit;
 
 error_bat_restore:
+    /*
+     * Note that only the BAT update of the failed iteration is restored;
+     * updates of previous iterations are already queued for the next log
+     * commit and remain valid.
+     */
     if (bat_update) {
         /* keep metadata in sync, and restore the bat entry state
          * if error. */
@@ -1505,6 +1512,18 @@ exit:
     return ret;
 }
 
+static int coroutine_fn GRAPH_RDLOCK vhdx_co_flush_to_os(BlockDriverState *bs)
+{
+    BDRVVHDXState *s = bs->opaque;
+    int ret;
+
+    qemu_co_mutex_lock(&s->lock);
+    ret = vhdx_log_commit(bs, s);
+    qemu_co_mutex_unlock(&s->lock);
+
+    return ret;
+}
+
 
 
 /*
@@ -2255,6 +2274,7 @@ static BlockDriver bdrv_vhdx = {
     .bdrv_child_perm        = bdrv_default_perms,
     .bdrv_co_readv          = vhdx_co_readv,
     .bdrv_co_writev         = vhdx_co_writev,
+    .bdrv_co_flush_to_os    = vhdx_co_flush_to_os,
     .bdrv_co_create         = vhdx_co_create,
     .bdrv_co_create_opts    = vhdx_co_create_opts,
     .bdrv_co_get_info       = vhdx_co_get_info,
@@ -353,6 +353,18 @@ typedef struct VHDXRegionEntry {
     QLIST_ENTRY(VHDXRegionEntry) entries;
 } VHDXRegionEntry;
 
+/*
+ * Allocating writes queue their BAT update and commit the log in batches.
+ * Each entry takes one descriptor sector and one data sector in the log,
+ * so 64 queued entries stay well below the minimum 1 MB log size.
+ */
+#define VHDX_BAT_BATCH_MAX 64
+
+typedef struct VHDXBatUpdate {
+    uint64_t entry_le;
+    uint64_t offset;
+} VHDXBatUpdate;
+
 typedef struct BDRVVHDXState {
     CoMutex lock;
 
@@ -389,6 +401,10 @@ typedef struct BDRVVHDXState {
 
     VHDXLogEntries log;
 
+    /* BAT updates queued for the next log commit */
+    VHDXBatUpdate bat_batch[VHDX_BAT_BATCH_MAX];
+    unsigned int bat_batch_len;
+
     VHDXParentLocatorHeader parent_header;
     VHDXParentLocatorEntry *parent_entries;
 
@@ -416,8 +432,11 @@ vhdx_parse_log(BlockDriverState *bs, BDRVVHDXState *s, bool *flushed,
                Error **errp);
 
 int coroutine_fn GRAPH_RDLOCK
-vhdx_log_write_and_flush(BlockDriverState *bs, BDRVVHDXState *s,
-                         void *data, uint32_t length, uint64_t offset);
+vhdx_log_queue_bat_update(BlockDriverState *bs, BDRVVHDXState *s,
+                          uint64_t bat_entry_le, uint64_t bat_offset);
+
+int coroutine_fn GRAPH_RDLOCK
+vhdx_log_commit(BlockDriverState *bs, BDRVVHDXState *s);
 
 static inline void leguid_to_cpus(MSGUID *guid)
 {
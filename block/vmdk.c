@@ -420,12 +420,57 @@ static int coroutine_fn GRAPH_RDLOCK vmdk_is_cid_valid(BlockDriverState *bs)
     return 1;
 }
 
+/*
+ * Read the backup grain directory of an extent. It is only consulted when
+ * grain tables are updated, so read-only opens skip it to save time and
+ * memory and load it on demand when the image is reopened read-write.
+ */
+static int GRAPH_RDLOCK
+vmdk_read_l1_backup_table(VmdkExtent *extent, Error **errp)
+{
+    size_t l1_size = extent->l1_size * extent->entry_size;
+    int i, ret;
+
+    assert(extent->l1_backup_table_offset && !extent->l1_backup_table);
+    assert(!extent->sesparse);
+
+    extent->l1_backup_table = g_try_malloc(l1_size);
+    if (l1_size && extent->l1_backup_table == NULL) {
+        error_setg(errp, "Could not allocate l1 backup table");
+        return -ENOMEM;
+    }
+    ret = bdrv_pread(extent->file, extent->l1_backup_table_offset,
+                     l1_size, extent->l1_backup_table, 0);
+    if (ret < 0) {
+        bdrv_refresh_filename(extent->file->bs);
+        error_setg_errno(errp, -ret,
+                         "Could not read l1 backup table from extent '%s'",
+                         extent->file->bs->filename);
+        g_free(extent->l1_backup_table);
+        extent->l1_backup_table = NULL;
+        return ret;
+    }
+    for (i = 0; i < extent->l1_size; i++) {
+        le32_to_cpus(&extent->l1_backup_table[i]);
+    }
+    return 0;
+}
+
+static void vmdk_reopen_clean(BDRVReopenState *state)
+{
+    BDRVVmdkReopenState *rs = state->opaque;
+
+    g_free(rs->extents_using_bs_file);
+    g_free(rs);
+    state->opaque = NULL;
+}
+
 static int vmdk_reopen_prepare(BDRVReopenState *state,
                                BlockReopenQueue *queue, Error **errp)
 {
     BDRVVmdkState *s;
     BDRVVmdkReopenState *rs;
-    int i;
+    int ret, i;
 
     GLOBAL_STATE_CODE();
     GRAPH_RDLOCK_GUARD_MAINLOOP();
@@ -448,16 +493,26 @@ static int vmdk_reopen_prepare(BDRVReopenState *state,
         rs->extents_using_bs_file[i] = s->extents[i].file == state->bs->file;
     }
 
-    return 0;
-}
+    /*
+     * Backup grain directories are not loaded for read-only images; load
+     * them now if the image becomes writable so that grain table updates
+     * can keep them in sync.
+     */
+    if (state->flags & BDRV_O_RDWR) {
+        for (i = 0; i < s->num_extents; i++) {
+            VmdkExtent *extent = &s->extents[i];
 
-static void vmdk_reopen_clean(BDRVReopenState *state)
-{
-    BDRVVmdkReopenState *rs = state->opaque;
+            if (extent->l1_backup_table_offset && !extent->l1_backup_table) {
+                ret = vmdk_read_l1_backup_table(extent, errp);
+                if (ret < 0) {
+                    vmdk_reopen_clean(state);
+                    return ret;
+                }
+            }
+        }
+    }
 
-    g_free(rs->extents_using_bs_file);
-    g_free(rs);
-    state->opaque = NULL;
+    return 0;
 }
 
 static void vmdk_reopen_commit(BDRVReopenState *state)
@@ -628,32 +683,16 @@ vmdk_init_tables(BlockDriverState *bs, VmdkExtent *extent, Error **errp)
         }
     }
 
-    if (extent->l1_backup_table_offset) {
-        assert(!extent->sesparse);
-        extent->l1_backup_table = g_try_malloc(l1_size);
-        if (l1_size && extent->l1_backup_table == NULL) {
-            ret = -ENOMEM;
-            goto fail_l1;
-        }
-        ret = bdrv_pread(extent->file, extent->l1_backup_table_offset,
-                         l1_size, extent->l1_backup_table, 0);
+    if (extent->l1_backup_table_offset && !bdrv_is_read_only(bs)) {
+        ret = vmdk_read_l1_backup_table(extent, errp);
         if (ret < 0) {
-            bdrv_refresh_filename(extent->file->bs);
-            error_setg_errno(errp, -ret,
-                             "Could not read l1 backup table from extent '%s'",
-                             extent->file->bs->filename);
-            goto fail_l1b;
-        }
-        for (i = 0; i < extent->l1_size; i++) {
-            le32_to_cpus(&extent->l1_backup_table[i]);
+            goto fail_l1;
         }
     }
 
     extent->l2_cache =
         g_malloc(extent->entry_size * extent->l2_size * L2_CACHE_SIZE);
     return 0;
- fail_l1b:
-    g_free(extent->l1_backup_table);
  fail_l1:
     g_free(extent->l1_table);
     return ret;
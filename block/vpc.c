@@ -253,7 +253,6 @@ static int vpc_open(BlockDriverState *bs, QDict *options, int flags,
                     Error **errp)
 {
     BDRVVPCState *s = bs->opaque;
-    int i;
     VHDFooter *footer;
     QemuOpts *opts = NULL;
     Error *local_err = NULL;
@@ -398,50 +397,27 @@ static int vpc_open(BlockDriverState *bs, QDict *options, int flags,
 
         pagetable_size = (uint64_t) s->max_table_entries * 4;
 
-        s->pagetable = qemu_try_blockalign(bs->file->bs, pagetable_size);
-        if (s->pagetable == NULL) {
-            error_setg(errp, "Unable to allocate memory for page table");
-            ret = -ENOMEM;
-            goto fail;
-        }
-
         s->bat_offset = be64_to_cpu(dyndisk_header.table_offset);
 
-        ret = bdrv_pread(bs->file, s->bat_offset, pagetable_size,
-                         s->pagetable, 0);
-        if (ret < 0) {
-            error_setg(errp, "Error reading pagetable");
-            goto fail;
-        }
-
-        s->free_data_block_offset =
-            ROUND_UP(s->bat_offset + pagetable_size, 512);
-
-        for (i = 0; i < s->max_table_entries; i++) {
-            be32_to_cpus(&s->pagetable[i]);
-            if (s->pagetable[i] != 0xFFFFFFFF) {
-                int64_t next = (512 * (int64_t) s->pagetable[i]) +
-                    s->bitmap_size + s->block_size;
-
-                if (next > s->free_data_block_offset) {
-                    s->free_data_block_offset = next;
-                }
-            }
-        }
-
         bs_size = bdrv_getlength(bs->file->bs);
         if (bs_size < 0) {
             error_setg_errno(errp, -bs_size, "Unable to learn image size");
             ret = bs_size;
             goto fail;
         }
-        if (s->free_data_block_offset > bs_size) {
-            error_setg(errp, "block-vpc: free_data_block_offset points after "
-                             "the end of file. The image has been truncated.");
+        if (s->bat_offset + pagetable_size > bs_size) {
+            error_setg(errp, "block-vpc: BAT points after the end of file. "
+                             "The image has been truncated.");
             ret = -EINVAL;
             goto fail;
         }
 
+        /*
+         * The page table itself is read on first use by
+         * vpc_co_load_pagetable(), so that merely opening the image (e.g.
+         * for qemu-img info) does not have to read and scan the whole BAT.
+         */
+
         s->last_bitmap_offset = (int64_t) -1;
 
 #ifdef CACHE
@@ -482,6 +458,76 @@ static int vpc_reopen_prepare(BDRVReopenState *state,
     return 0;
 }
 
+/*
+ * Read the BAT on first use and derive the first free data block offset
+ * from it.  vpc_open() only validates the headers, so opening an image
+ * for inspection does not pay for reading a table of up to several
+ * megabytes.
+ *
+ * Called with s->lock held.
+ */
+static int coroutine_fn GRAPH_RDLOCK
+vpc_co_load_pagetable(BlockDriverState *bs)
+{
+    BDRVVPCState *s = bs->opaque;
+    uint64_t pagetable_size = (uint64_t) s->max_table_entries * 4;
+    uint64_t free_data_block_offset;
+    uint32_t *pagetable;
+    int64_t bs_size;
+    int ret;
+    int i;
+
+    if (likely(s->pagetable)) {
+        return 0;
+    }
+
+    pagetable = qemu_try_blockalign(bs->file->bs, pagetable_size);
+    if (pagetable == NULL) {
+        return -ENOMEM;
+    }
+
+    ret = bdrv_co_pread(bs->file, s->bat_offset, pagetable_size,
+                        pagetable, 0);
+    if (ret < 0) {
+        goto fail;
+    }
+
+    free_data_block_offset = ROUND_UP(s->bat_offset + pagetable_size, 512);
+
+    for (i = 0; i < s->max_table_entries; i++) {
+        be32_to_cpus(&pagetable[i]);
+        if (pagetable[i] != 0xFFFFFFFF) {
+            int64_t next = (512 * (int64_t) pagetable[i]) +
+                s->bitmap_size + s->block_size;
+
+            if (next > free_data_block_offset) {
+                free_data_block_offset = next;
+            }
+        }
+    }
+
+    bs_size = bdrv_co_getlength(bs->file->bs);
+    if (bs_size < 0) {
+        ret = bs_size;
+        goto fail;
+    }
+    if (free_data_block_offset > bs_size) {
+        /* free_data_block_offset points after the end of file; the image
+         * has been truncated. */
+        ret = -EINVAL;
+        goto fail;
+    }
+
+    s->free_data_block_offset = free_data_block_offset;
+    s->pagetable = pagetable;
+
+    return 0;
+
+fail:
+    qemu_vfree(pagetable);
+    return ret;
+}
+
 /*
  * Returns the absolute byte offset of the given sector in the image file.
  * If the sector is not allocated, -1 is returned instead.
@@ -635,6 +681,11 @@ vpc_co_preadv(BlockDriverState *bs, int64_t offset, int64_t bytes,
     qemu_co_mutex_lock(&s->lock);
     qemu_iovec_init(&local_qiov, qiov->niov);
 
+    ret = vpc_co_load_pagetable(bs);
+    if (ret < 0) {
+        goto fail;
+    }
+
     while (bytes > 0) {
         image_offset = get_image_offset(bs, offset, false, NULL);
         n_bytes = MIN(bytes, s->block_size - (offset % s->block_size));
@@ -685,6 +736,11 @@ vpc_co_pwritev(BlockDriverState *bs, int64_t offset, int64_t bytes,
     qemu_co_mutex_lock(&s->lock);
     qemu_iovec_init(&local_qiov, qiov->niov);
 
+    ret = vpc_co_load_pagetable(bs);
+    if (ret < 0) {
+        goto fail;
+    }
+
     while (bytes > 0) {
         image_offset = get_image_offset(bs, offset, true, &ret);
         if (image_offset == -2) {
@@ -746,6 +802,12 @@ vpc_co_block_status(BlockDriverState *bs, bool want_zero,
 
     qemu_co_mutex_lock(&s->lock);
 
+    ret = vpc_co_load_pagetable(bs);
+    if (ret < 0) {
+        qemu_co_mutex_unlock(&s->lock);
+        return ret;
+    }
+
     image_offset = get_image_offset(bs, offset, false, NULL);
     allocated = (image_offset != -1);
     *pnum = 0;
@@ -26,19 +26,42 @@
 #include "chardev/char.h"
 #include "qapi/error.h"
 #include "qapi/qapi-commands-char.h"
+#include "qapi/qapi-events-char.h"
 #include "qemu/base64.h"
+#include "qemu/main-loop.h"
 #include "qemu/module.h"
 #include "qemu/option.h"
 #include "qom/object.h"
 
 /* Ring buffer chardev */
 
+/*
+ * Layout of the backing file when the ring is given a path: one header
+ * page followed by the ring data.  External collectors map the file,
+ * poll @prod and read the data in place; QEMU never waits for them, the
+ * oldest bytes are simply overwritten.
+ */
+#define RINGBUF_MMAP_MAGIC      0x46554252 /* "RBUF" */
+#define RINGBUF_MMAP_VERSION    1
+#define RINGBUF_MMAP_HDR_SIZE   4096
+
+typedef struct RingBufMmapHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint64_t prod;
+} RingBufMmapHeader;
+
 struct RingBufChardev {
     Chardev parent;
     size_t size;
     size_t prod;
     size_t cons;
     uint8_t *cbuf;
+    RingBufMmapHeader *hdr;     /* non-NULL when backed by a mapped file */
+    size_t watermark;
+    bool watermark_hit;
+    QEMUBH *watermark_bh;
 };
 typedef struct RingBufChardev RingBufChardev;
 
@@ -52,6 +75,29 @@ static size_t ringbuf_count(const Chardev *chr)
     return d->prod - d->cons;
 }
 
+/*
+ * Runs without chr_write_lock held.  Event emission can itself write to
+ * a monitor's chardev and take chr_write_lock, so emitting directly from
+ * ringbuf_chr_write() would deadlock a monitor attached to this ringbuf.
+ */
+static void ringbuf_watermark_bh(void *opaque)
+{
+    Chardev *chr = CHARDEV(opaque);
+    RingBufChardev *d = RINGBUF_CHARDEV(chr);
+    size_t fill;
+    bool hit;
+
+    qemu_mutex_lock(&chr->chr_write_lock);
+    fill = d->prod - d->cons;
+    hit = d->watermark_hit;
+    qemu_mutex_unlock(&chr->chr_write_lock);
+
+    /* The ring may have drained below the watermark in the meantime */
+    if (hit) {
+        qapi_event_send_ringbuf_watermark(chr->label, fill);
+    }
+}
+
 static int ringbuf_chr_write(Chardev *chr, const uint8_t *buf, int len)
 {
     RingBufChardev *d = RINGBUF_CHARDEV(chr);
@@ -68,6 +114,18 @@ static int ringbuf_chr_write(Chardev *chr, const uint8_t *buf, int len)
         }
     }
 
+    if (d->hdr) {
+        /* Data must be visible to external readers before the counter */
+        smp_wmb();
+        d->hdr->prod = d->prod;
+    }
+
+    if (d->watermark && !d->watermark_hit &&
+        d->prod - d->cons >= d->watermark) {
+        d->watermark_hit = true;
+        qemu_bh_schedule(d->watermark_bh);
+    }
+
     return len;
 }
 
@@ -80,6 +138,9 @@ static int ringbuf_chr_read(Chardev *chr, uint8_t *buf, int len)
     for (i = 0; i < len && d->cons != d->prod; i++) {
         buf[i] = d->cbuf[d->cons++ & (d->size - 1)];
     }
+    if (d->watermark_hit && d->prod - d->cons < d->watermark) {
+        d->watermark_hit = false;
+    }
     qemu_mutex_unlock(&chr->chr_write_lock);
 
     return i;
@@ -89,6 +150,15 @@ static void char_ringbuf_finalize(Object *obj)
 {
     RingBufChardev *d = RINGBUF_CHARDEV(obj);
 
+    if (d->watermark_bh) {
+        qemu_bh_delete(d->watermark_bh);
+    }
+#ifndef _WIN32
+    if (d->hdr) {
+        munmap(d->hdr, RINGBUF_MMAP_HDR_SIZE + d->size);
+        return;
+    }
+#endif
     g_free(d->cbuf);
 }
 
@@ -108,9 +178,57 @@ static void qemu_chr_open_ringbuf(Chardev *chr,
         return;
     }
 
+    d->watermark = opts->has_watermark ? opts->watermark : 0;
+    if (d->watermark > d->size) {
+        error_setg(errp, "watermark of ringbuf chardev exceeds its size");
+        return;
+    }
+
     d->prod = 0;
     d->cons = 0;
-    d->cbuf = g_malloc0(d->size);
+
+    if (opts->path) {
+#ifdef _WIN32
+        error_setg(errp, "ringbuf chardev path is not supported on Windows");
+        return;
+#else
+        void *map;
+        int fd;
+
+        fd = qemu_create(opts->path, O_RDWR | O_TRUNC, 0600, errp);
+        if (fd < 0) {
+            return;
+        }
+        if (ftruncate(fd, RINGBUF_MMAP_HDR_SIZE + d->size) < 0) {
+            error_setg_errno(errp, errno, "unable to resize '%s'",
+                             opts->path);
+            close(fd);
+            return;
+        }
+        map = mmap(NULL, RINGBUF_MMAP_HDR_SIZE + d->size,
+                   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            error_setg_errno(errp, errno, "unable to map '%s'", opts->path);
+            return;
+        }
+
+        d->hdr = map;
+        d->cbuf = (uint8_t *)map + RINGBUF_MMAP_HDR_SIZE;
+        d->hdr->size = d->size;
+        d->hdr->prod = 0;
+        d->hdr->version = RINGBUF_MMAP_VERSION;
+        /* The magic goes live last, once the rest of the header is set */
+        smp_wmb();
+        d->hdr->magic = RINGBUF_MMAP_MAGIC;
+#endif
+    } else {
+        d->cbuf = g_malloc0(d->size);
+    }
+
+    if (d->watermark) {
+        d->watermark_bh = qemu_bh_new(ringbuf_watermark_bh, chr);
+    }
 }
 
 void qmp_ringbuf_write(const char *device, const char *data,
@@ -210,6 +328,7 @@ static void qemu_chr_parse_ringbuf(QemuOpts *opts, ChardevBackend *backend,
                                    Error **errp)
 {
     int val;
+    const char *path;
     ChardevRingbuf *ringbuf;
 
     backend->type = CHARDEV_BACKEND_KIND_RINGBUF;
@@ -221,6 +340,17 @@ static void qemu_chr_parse_ringbuf(QemuOpts *opts, ChardevBackend *backend,
         ringbuf->has_size = true;
         ringbuf->size = val;
     }
+
+    path = qemu_opt_get(opts, "path");
+    if (path) {
+        ringbuf->path = g_strdup(path);
+    }
+
+    val = qemu_opt_get_size(opts, "watermark", 0);
+    if (val != 0) {
+        ringbuf->has_watermark = true;
+        ringbuf->watermark = val;
+    }
 }
 
 static void char_ringbuf_class_init(ObjectClass *oc, void *data)
@@ -38,6 +38,13 @@
 #include "chardev/char-io.h"
 #include "chardev/char-socket.h"
 
+/*
+ * Upper bound on payload held back by write coalescing; large enough
+ * to absorb a burst of console output within one main loop iteration,
+ * small enough that a stuck peer cannot pin much memory.
+ */
+#define TCP_CHR_OUTBUF_MAX (64 * 1024)
+
 static gboolean socket_reconnect_timeout(gpointer opaque);
 static void tcp_chr_telnet_init(Chardev *chr);
 
@@ -103,6 +110,95 @@ static void tcp_chr_accept(QIONetListener *listener,
 
 static int tcp_chr_read_poll(void *opaque);
 static void tcp_chr_disconnect_locked(Chardev *chr);
+static void tcp_chr_flush_schedule(Chardev *chr);
+
+/* Called with chr_write_lock held.  */
+static int tcp_chr_flush_outbuf(Chardev *chr)
+{
+    SocketChardev *s = SOCKET_CHARDEV(chr);
+    int ret;
+
+    if (!s->outbuf_len) {
+        return 0;
+    }
+    if (s->state != TCP_CHARDEV_STATE_CONNECTED) {
+        s->outbuf_len = 0;
+        errno = EIO;
+        return -1;
+    }
+
+    ret = io_channel_send_full(s->ioc, s->outbuf, s->outbuf_len, NULL, 0);
+    if (ret < 0) {
+        if (errno != EAGAIN && tcp_chr_read_poll(chr) <= 0) {
+            /* Perform disconnect and return error. */
+            trace_chr_socket_poll_err(chr, chr->label);
+            tcp_chr_disconnect_locked(chr);
+        } /* else let the read handler finish it properly */
+        return ret;
+    }
+
+    memmove(s->outbuf, s->outbuf + ret, s->outbuf_len - ret);
+    s->outbuf_len -= ret;
+    return 0;
+}
+
+static gboolean tcp_chr_flush_io(QIOChannel *channel, GIOCondition cond,
+                                 void *opaque)
+{
+    Chardev *chr = CHARDEV(opaque);
+    SocketChardev *s = SOCKET_CHARDEV(opaque);
+
+    qemu_mutex_lock(&chr->chr_write_lock);
+    g_source_unref(s->flush_source);
+    s->flush_source = NULL;
+    tcp_chr_flush_outbuf(chr);
+    if (s->outbuf_len && s->state == TCP_CHARDEV_STATE_CONNECTED) {
+        /* socket buffer filled up; wait for it to drain */
+        tcp_chr_flush_schedule(chr);
+    }
+    qemu_mutex_unlock(&chr->chr_write_lock);
+
+    return false;
+}
+
+/* Called with chr_write_lock held.  */
+static void tcp_chr_flush_schedule(Chardev *chr)
+{
+    SocketChardev *s = SOCKET_CHARDEV(chr);
+
+    if (s->flush_source || s->state != TCP_CHARDEV_STATE_CONNECTED) {
+        return;
+    }
+    s->flush_source = qio_channel_create_watch(s->ioc, G_IO_OUT);
+    g_source_set_callback(s->flush_source, (GSourceFunc)tcp_chr_flush_io,
+                          chr, NULL);
+    g_source_attach(s->flush_source, chr->gcontext);
+}
+
+/* Called with chr_write_lock held.  */
+static int tcp_chr_write_coalesce(Chardev *chr, const uint8_t *buf, int len)
+{
+    SocketChardev *s = SOCKET_CHARDEV(chr);
+
+    if (!s->outbuf) {
+        s->outbuf = g_malloc(TCP_CHR_OUTBUF_MAX);
+    }
+    if (len > TCP_CHR_OUTBUF_MAX - (int)s->outbuf_len) {
+        /* try to make room right away rather than failing the write */
+        if (tcp_chr_flush_outbuf(chr) < 0 && errno != EAGAIN) {
+            return -1;
+        }
+        if (len > TCP_CHR_OUTBUF_MAX - (int)s->outbuf_len) {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+
+    memcpy(s->outbuf + s->outbuf_len, buf, len);
+    s->outbuf_len += len;
+    tcp_chr_flush_schedule(chr);
+    return len;
+}
 
 /* Called with chr_write_lock held.  */
 static int tcp_chr_write(Chardev *chr, const uint8_t *buf, int len)
@@ -110,9 +206,31 @@ static int tcp_chr_write(Chardev *chr, const uint8_t *buf, int len)
     SocketChardev *s = SOCKET_CHARDEV(chr);
 
     if (s->state == TCP_CHARDEV_STATE_CONNECTED) {
-        int ret =  io_channel_send_full(s->ioc, buf, len,
-                                        s->write_msgfds,
-                                        s->write_msgfds_num);
+        int ret;
+
+        if (s->do_coalesce && !s->write_msgfds_num &&
+            len <= TCP_CHR_OUTBUF_MAX) {
+            return tcp_chr_write_coalesce(chr, buf, len);
+        }
+
+        /*
+         * fd passing and oversized payloads must not overtake
+         * previously coalesced data; push out anything still buffered
+         * before sending directly.
+         */
+        if (s->outbuf_len) {
+            if (tcp_chr_flush_outbuf(chr) < 0) {
+                return -1;
+            }
+            if (s->outbuf_len) {
+                errno = EAGAIN;
+                return -1;
+            }
+        }
+
+        ret = io_channel_send_full(s->ioc, buf, len,
+                                   s->write_msgfds,
+                                   s->write_msgfds_num);
 
         /* free the written msgfds in any cases
          * other than ret < 0 && errno == EAGAIN
@@ -353,6 +471,15 @@ static void remove_hup_source(SocketChardev *s)
     }
 }
 
+static void remove_flush_source(SocketChardev *s)
+{
+    if (s->flush_source != NULL) {
+        g_source_destroy(s->flush_source);
+        g_source_unref(s->flush_source);
+        s->flush_source = NULL;
+    }
+}
+
 static void char_socket_yank_iochannel(void *opaque)
 {
     QIOChannel *ioc = QIO_CHANNEL(opaque);
@@ -375,6 +502,8 @@ static void tcp_chr_free_connection(Chardev *chr)
     }
 
     remove_hup_source(s);
+    remove_flush_source(s);
+    s->outbuf_len = 0;
 
     tcp_set_msgfds(chr, NULL, 0);
     remove_fd_in_watch(chr);
@@ -1105,6 +1234,7 @@ static void char_socket_finalize(Object *obj)
 
     tcp_chr_free_connection(chr);
     tcp_chr_reconn_timer_cancel(s);
+    g_free(s->outbuf);
     qapi_free_SocketAddress(s->addr);
     tcp_chr_telnet_destroy(s);
     g_free(s->telnet_init);
@@ -1376,6 +1506,7 @@ static void qmp_chardev_open_socket(Chardev *chr,
     SocketChardev *s = SOCKET_CHARDEV(chr);
     ChardevSocket *sock = backend->u.socket.data;
     bool do_nodelay     = sock->has_nodelay ? sock->nodelay : false;
+    bool do_coalesce    = sock->has_coalesce ? sock->coalesce : false;
     bool is_listen      = sock->has_server  ? sock->server  : true;
     bool is_telnet      = sock->has_telnet  ? sock->telnet  : false;
     bool is_tn3270      = sock->has_tn3270  ? sock->tn3270  : false;
@@ -1389,6 +1520,7 @@ static void qmp_chardev_open_socket(Chardev *chr,
     s->is_tn3270 = is_tn3270;
     s->is_websock = is_websock;
     s->do_nodelay = do_nodelay;
+    s->do_coalesce = do_coalesce;
     if (sock->tls_creds) {
         Object *creds;
         creds = object_resolve_path_component(
@@ -1504,6 +1636,8 @@ static void qemu_chr_parse_socket(QemuOpts *opts, ChardevBackend *backend,
     sock->nodelay =
         !qemu_opt_get_bool(opts, "delay", true) ||
         qemu_opt_get_bool(opts, "nodelay", false);
+    sock->has_coalesce = qemu_opt_get(opts, "coalesce");
+    sock->coalesce = qemu_opt_get_bool(opts, "coalesce", false);
 
     /*
      * We have different default to QMP for 'server', hence
@@ -892,6 +892,9 @@ QemuOptsList qemu_chardev_opts = {
         },{
             .name = "nodelay",
             .type = QEMU_OPT_BOOL,
+        },{
+            .name = "coalesce",
+            .type = QEMU_OPT_BOOL,
         },{
             .name = "reconnect",
             .type = QEMU_OPT_NUMBER,
@@ -940,6 +943,9 @@ QemuOptsList qemu_chardev_opts = {
         },{
             .name = "size",
             .type = QEMU_OPT_SIZE,
+        },{
+            .name = "watermark",
+            .type = QEMU_OPT_SIZE,
         },{
             .name = "chardev",
             .type = QEMU_OPT_STRING,
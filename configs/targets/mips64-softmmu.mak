@@ -1,4 +1,5 @@
 TARGET_ARCH=mips64
 TARGET_BASE_ARCH=mips
 TARGET_BIG_ENDIAN=y
+TARGET_SUPPORTS_MTTCG=y
 TARGET_LONG_BITS=64
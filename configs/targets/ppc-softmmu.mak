@@ -1,5 +1,6 @@
 TARGET_ARCH=ppc
 TARGET_BIG_ENDIAN=y
+TARGET_SUPPORTS_MTTCG=y
 TARGET_KVM_HAVE_GUEST_DEBUG=y
 TARGET_XML_FILES= gdb-xml/power-core.xml gdb-xml/power-fpu.xml gdb-xml/power-altivec.xml gdb-xml/power-spe.xml
 TARGET_LONG_BITS=32
@@ -474,6 +474,20 @@ qcrypto_tls_session_set_callbacks(QCryptoTLSSession *session,
 }
 
 
+void
+qcrypto_tls_session_set_transport_fd(QCryptoTLSSession *session, int fd)
+{
+    session->writeFunc = NULL;
+    session->readFunc = NULL;
+    session->opaque = NULL;
+
+    /* Passing NULL restores the GnuTLS default send/recv functions */
+    gnutls_transport_set_push_function(session->handle, NULL);
+    gnutls_transport_set_pull_function(session->handle, NULL);
+    gnutls_transport_set_int(session->handle, fd);
+}
+
+
 ssize_t
 qcrypto_tls_session_write(QCryptoTLSSession *session,
                           const char *buf,
@@ -677,6 +691,13 @@ qcrypto_tls_session_set_callbacks(
 }
 
 
+void
+qcrypto_tls_session_set_transport_fd(QCryptoTLSSession *sess G_GNUC_UNUSED,
+                                     int fd G_GNUC_UNUSED)
+{
+}
+
+
 ssize_t
 qcrypto_tls_session_write(QCryptoTLSSession *sess,
                           const char *buf,
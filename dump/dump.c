@@ -39,6 +39,9 @@
 #ifdef CONFIG_SNAPPY
 #include <snappy-c.h>
 #endif
+#ifdef CONFIG_ZSTD
+#include <zstd.h>
+#endif
 #ifndef ELF_MACHINE_UNAME
 #define ELF_MACHINE_UNAME "Unknown"
 #endif
@@ -1003,6 +1006,11 @@ static void create_header32(DumpState *s, Error **errp)
     if (s->flag_compress & DUMP_DH_COMPRESSED_SNAPPY) {
         status |= DUMP_DH_COMPRESSED_SNAPPY;
     }
+#endif
+#ifdef CONFIG_ZSTD
+    if (s->flag_compress & DUMP_DH_COMPRESSED_ZSTD) {
+        status |= DUMP_DH_COMPRESSED_ZSTD;
+    }
 #endif
     dh->status = cpu_to_dump32(s, status);
 
@@ -1114,6 +1122,11 @@ static void create_header64(DumpState *s, Error **errp)
     if (s->flag_compress & DUMP_DH_COMPRESSED_SNAPPY) {
         status |= DUMP_DH_COMPRESSED_SNAPPY;
     }
+#endif
+#ifdef CONFIG_ZSTD
+    if (s->flag_compress & DUMP_DH_COMPRESSED_ZSTD) {
+        status |= DUMP_DH_COMPRESSED_ZSTD;
+    }
 #endif
     dh->status = cpu_to_dump32(s, status);
 
@@ -1465,6 +1478,10 @@ static size_t get_len_buf_out(size_t page_size, uint32_t flag_compress)
 #ifdef CONFIG_SNAPPY
     case DUMP_DH_COMPRESSED_SNAPPY:
         return snappy_max_compressed_length(page_size);
+#endif
+#ifdef CONFIG_ZSTD
+    case DUMP_DH_COMPRESSED_ZSTD:
+        return ZSTD_compressBound(page_size);
 #endif
     }
     return 0;
@@ -1588,6 +1605,20 @@ static void write_dump_pages(DumpState *s, Error **errp)
                     goto out;
                 }
 #endif
+#ifdef CONFIG_ZSTD
+            } else if ((s->flag_compress & DUMP_DH_COMPRESSED_ZSTD) &&
+                    !ZSTD_isError(size_out = ZSTD_compress(buf_out, len_buf_out,
+                        buf, s->dump_info.page_size, 1)) &&
+                    (size_out < s->dump_info.page_size)) {
+                pd.flags = cpu_to_dump32(s, DUMP_DH_COMPRESSED_ZSTD);
+                pd.size  = cpu_to_dump32(s, size_out);
+
+                ret = write_cache(&page_data, buf_out, size_out, false);
+                if (ret < 0) {
+                    error_setg(errp, "dump: failed to write page data");
+                    goto out;
+                }
+#endif
             } else {
                 /*
                  * fall back to save in plaintext, size_out should be
@@ -1946,6 +1977,10 @@ static void dump_init(DumpState *s, int fd, bool has_format,
             s->flag_compress = DUMP_DH_COMPRESSED_SNAPPY;
             break;
 
+        case DUMP_GUEST_MEMORY_FORMAT_KDUMP_ZSTD:
+            s->flag_compress = DUMP_DH_COMPRESSED_ZSTD;
+            break;
+
         default:
             s->flag_compress = 0;
         }
@@ -2105,6 +2140,10 @@ void qmp_dump_guest_memory(bool paging, const char *protocol,
             format = DUMP_GUEST_MEMORY_FORMAT_KDUMP_SNAPPY;
             kdump_raw = true;
             break;
+        case DUMP_GUEST_MEMORY_FORMAT_KDUMP_RAW_ZSTD:
+            format = DUMP_GUEST_MEMORY_FORMAT_KDUMP_ZSTD;
+            kdump_raw = true;
+            break;
         default:
             break;
         }
@@ -2147,6 +2186,13 @@ void qmp_dump_guest_memory(bool paging, const char *protocol,
     }
 #endif
 
+#ifndef CONFIG_ZSTD
+    if (has_format && format == DUMP_GUEST_MEMORY_FORMAT_KDUMP_ZSTD) {
+        error_setg(errp, "kdump-zstd is not available now");
+        return;
+    }
+#endif
+
     if (has_format && format == DUMP_GUEST_MEMORY_FORMAT_WIN_DMP
         && !win_dump_available(errp)) {
         return;
@@ -2234,6 +2280,12 @@ DumpGuestMemoryCapability *qmp_query_dump_guest_memory_capability(Error **errp)
     QAPI_LIST_APPEND(tail, DUMP_GUEST_MEMORY_FORMAT_KDUMP_RAW_SNAPPY);
 #endif
 
+    /* add new item if kdump-zstd is available */
+#ifdef CONFIG_ZSTD
+    QAPI_LIST_APPEND(tail, DUMP_GUEST_MEMORY_FORMAT_KDUMP_ZSTD);
+    QAPI_LIST_APPEND(tail, DUMP_GUEST_MEMORY_FORMAT_KDUMP_RAW_ZSTD);
+#endif
+
     if (win_dump_available(NULL)) {
         QAPI_LIST_APPEND(tail, DUMP_GUEST_MEMORY_FORMAT_WIN_DMP);
     }
@@ -39,6 +39,7 @@ typedef struct FsCred {
 
 typedef struct FsContext FsContext;
 typedef struct V9fsPath V9fsPath;
+typedef struct V9fsAttrCache V9fsAttrCache;
 
 typedef struct ExtendedOps {
     int (*get_st_gen)(FsContext *, V9fsPath *, mode_t, uint64_t *);
@@ -76,6 +77,11 @@ typedef struct ExtendedOps {
  * Disables certain performance warnings from being logged on host side.
  */
 #define V9FS_NO_PERF_WARN           0x00000800
+/*
+ * Drop file data from the host page cache right after serving guest
+ * I/O, so shares are not cached in both guest and host memory.
+ */
+#define V9FS_NO_HOST_CACHE          0x00001000
 
 #define V9FS_SEC_MASK               0x0000003C
 
@@ -103,6 +109,8 @@ struct FsContext {
     XattrOperations **xops;
     ExtendedOps exops;
     FsThrottle *fst;
+    /* host side lstat() cache, NULL when not available */
+    V9fsAttrCache *attr_cache;
     /* fs driver specific data */
     void *private;
     mode_t fmode;
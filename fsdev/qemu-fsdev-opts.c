@@ -31,6 +31,9 @@ static QemuOptsList qemu_fsdev_opts = {
         }, {
             .name = "readonly",
             .type = QEMU_OPT_BOOL,
+        }, {
+            .name = "host-cache",
+            .type = QEMU_OPT_BOOL,
         }, {
             .name = "multidevs",
             .type = QEMU_OPT_STRING,
@@ -77,6 +80,9 @@ static QemuOptsList qemu_virtfs_opts = {
         }, {
             .name = "readonly",
             .type = QEMU_OPT_BOOL,
+        }, {
+            .name = "host-cache",
+            .type = QEMU_OPT_BOOL,
         }, {
             .name = "multidevs",
             .type = QEMU_OPT_STRING,
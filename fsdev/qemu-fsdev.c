@@ -56,6 +56,7 @@ static FsDriverTable FsDrivers[] = {
             "security_model",
             "path",
             "writeout",
+            "host-cache",
             "fmode",
             "dmode",
             "multidevs",
@@ -115,6 +116,7 @@ int qemu_fsdev_add(QemuOpts *opts, Error **errp)
     const char *fsdriver = qemu_opt_get(opts, "fsdriver");
     const char *writeout = qemu_opt_get(opts, "writeout");
     bool ro = qemu_opt_get_bool(opts, "readonly", 0);
+    bool host_cache = qemu_opt_get_bool(opts, "host-cache", true);
 
     if (!fsdev_id) {
         error_setg(errp, "fsdev: No id specified");
@@ -154,6 +156,9 @@ int qemu_fsdev_add(QemuOpts *opts, Error **errp)
     } else {
         fsle->fse.export_flags &= ~V9FS_RDONLY;
     }
+    if (!host_cache) {
+        fsle->fse.export_flags |= V9FS_NO_HOST_CACHE;
+    }
 
     if (fsle->fse.ops->parse_opts) {
         if (fsle->fse.ops->parse_opts(opts, &fsle->fse, errp)) {
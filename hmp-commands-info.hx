@@ -256,6 +256,21 @@ SRST
     Show dynamic compiler info.
 ERST
 
+#if defined(CONFIG_TCG)
+    {
+        .name       = "hottb",
+        .args_type  = "",
+        .params     = "",
+        .help       = "show the translation blocks with the highest execution counts",
+    },
+#endif
+
+SRST
+  ``info hottb``
+    Show the translation blocks with the highest execution counts.
+    Requires ``-accel tcg,tb-exec-stats=on``.
+ERST
+
 #if defined(CONFIG_TCG)
     {
         .name       = "opcount",
@@ -0,0 +1,238 @@
+/*
+ * 9p backend - host side attribute cache
+ *
+ * Caches lstat() results for local exports, keyed by the fid relative
+ * path, so repeated Tgetattr requests on read-mostly shares are served
+ * from memory instead of a worker thread hop plus a host syscall.
+ *
+ * Coherency is maintained two ways: the coth wrappers invalidate
+ * entries synchronously for mutations requested by the guest itself,
+ * and an inotify based file monitor invalidates entries when files are
+ * changed on the host behind QEMU's back.  The latter is asynchronous,
+ * so purely host side writers can be observed with a small delay; that
+ * matches the intended use for immutable or read-mostly trees.
+ *
+ * All cache accesses run in the main loop: the 9p request coroutines
+ * (top half) and the file monitor callback both execute there, so no
+ * locking is needed.  The worker threads (bottom half) never touch the
+ * cache.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2.  See
+ * the COPYING file in the top-level directory.
+ */
+
+/*
+ * Not so fast! You might want to read the 9p developer docs first:
+ * https://wiki.qemu.org/Documentation/9p
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/filemonitor.h"
+#include "9p-attr-cache.h"
+
+/*
+ * Upper bound on cached attribute entries; once reached, new paths are
+ * simply not cached any more until invalidation makes room again.
+ */
+#define ATTR_CACHE_MAX_ENTRIES 65536
+
+typedef struct V9fsAttrCacheDir {
+    V9fsAttrCache *cache;
+    char *dirpath;      /* fid relative directory path, e.g. "./a/b" */
+    int64_t watch_id;
+} V9fsAttrCacheDir;
+
+struct V9fsAttrCache {
+    char *fs_root;
+    QFileMonitor *mon;
+    GHashTable *attrs;  /* fid relative path -> struct stat */
+    GHashTable *dirs;   /* fid relative dir path -> V9fsAttrCacheDir */
+};
+
+static void v9fs_attr_cache_dir_free(gpointer p)
+{
+    V9fsAttrCacheDir *dir = p;
+
+    g_free(dir->dirpath);
+    g_free(dir);
+}
+
+static void v9fs_attr_cache_drop_subtree(V9fsAttrCache *cache,
+                                         const char *path)
+{
+    g_autofree char *prefix = g_strdup_printf("%s/", path);
+    GHashTableIter iter;
+    gpointer key;
+
+    g_hash_table_remove(cache->attrs, path);
+
+    g_hash_table_iter_init(&iter, cache->attrs);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        if (g_str_has_prefix(key, prefix)) {
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+}
+
+static void v9fs_attr_cache_monitor_ev(int64_t id, QFileMonitorEvent ev,
+                                       const char *filename, void *opaque)
+{
+    V9fsAttrCacheDir *dir = opaque;
+    V9fsAttrCache *cache = dir->cache;
+    g_autofree char *path = NULL;
+
+    if (ev == QFILE_MONITOR_EVENT_IGNORED) {
+        /* the watched directory itself is gone */
+        v9fs_attr_cache_drop_subtree(cache, dir->dirpath);
+        g_hash_table_remove(cache->dirs, dir->dirpath);
+        return;
+    }
+
+    if (!filename[0]) {
+        /* event on the directory itself, e.g. an attribute change */
+        g_hash_table_remove(cache->attrs, dir->dirpath);
+        return;
+    }
+
+    path = g_strdup_printf("%s/%s", dir->dirpath, filename);
+    if (ev == QFILE_MONITOR_EVENT_DELETED) {
+        /* a deleted directory takes all entries beneath it along */
+        v9fs_attr_cache_drop_subtree(cache, path);
+    } else {
+        g_hash_table_remove(cache->attrs, path);
+    }
+    if (ev == QFILE_MONITOR_EVENT_CREATED ||
+        ev == QFILE_MONITOR_EVENT_DELETED) {
+        /* link count and times of the containing directory changed */
+        g_hash_table_remove(cache->attrs, dir->dirpath);
+    }
+}
+
+void v9fs_attr_cache_init(FsContext *ctx)
+{
+    V9fsAttrCache *cache;
+    QFileMonitor *mon;
+
+    if (!ctx->fs_root) {
+        /* synthetic exports have no host paths to monitor */
+        return;
+    }
+    mon = qemu_file_monitor_new(NULL);
+    if (!mon) {
+        /* no file monitor support on this host: run uncached */
+        return;
+    }
+
+    cache = g_new0(V9fsAttrCache, 1);
+    cache->fs_root = g_strdup(ctx->fs_root);
+    cache->mon = mon;
+    cache->attrs = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                         g_free, g_free);
+    cache->dirs = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                        v9fs_attr_cache_dir_free);
+    ctx->attr_cache = cache;
+}
+
+void v9fs_attr_cache_free(FsContext *ctx)
+{
+    V9fsAttrCache *cache = ctx->attr_cache;
+
+    if (!cache) {
+        return;
+    }
+    /* dropping the monitor removes all registered watches */
+    qemu_file_monitor_free(cache->mon);
+    g_hash_table_destroy(cache->attrs);
+    g_hash_table_destroy(cache->dirs);
+    g_free(cache->fs_root);
+    g_free(cache);
+    ctx->attr_cache = NULL;
+}
+
+bool v9fs_attr_cache_lookup(FsContext *ctx, V9fsPath *path,
+                            struct stat *stbuf)
+{
+    V9fsAttrCache *cache = ctx->attr_cache;
+    struct stat *st;
+
+    if (!cache || !path->data) {
+        return false;
+    }
+    st = g_hash_table_lookup(cache->attrs, path->data);
+    if (!st) {
+        return false;
+    }
+    *stbuf = *st;
+    return true;
+}
+
+void v9fs_attr_cache_store(FsContext *ctx, V9fsPath *path,
+                           const struct stat *stbuf)
+{
+    V9fsAttrCache *cache = ctx->attr_cache;
+    g_autofree char *dirpath = NULL;
+    V9fsAttrCacheDir *dir;
+
+    if (!cache || !path->data || !strcmp(path->data, ".")) {
+        /* the export root has no parent directory to watch */
+        return;
+    }
+    if (g_hash_table_size(cache->attrs) >= ATTR_CACHE_MAX_ENTRIES &&
+        !g_hash_table_contains(cache->attrs, path->data)) {
+        return;
+    }
+
+    dirpath = g_path_get_dirname(path->data);
+    dir = g_hash_table_lookup(cache->dirs, dirpath);
+    if (!dir) {
+        g_autofree char *host_path = g_build_filename(cache->fs_root,
+                                                      dirpath, NULL);
+
+        dir = g_new0(V9fsAttrCacheDir, 1);
+        dir->cache = cache;
+        dir->dirpath = g_strdup(dirpath);
+        dir->watch_id = qemu_file_monitor_add_watch(cache->mon, host_path,
+                                                    NULL,
+                                                    v9fs_attr_cache_monitor_ev,
+                                                    dir, NULL);
+        if (dir->watch_id < 0) {
+            /* without invalidation the entry must not be cached */
+            v9fs_attr_cache_dir_free(dir);
+            return;
+        }
+        g_hash_table_insert(cache->dirs, dir->dirpath, dir);
+    }
+
+    g_hash_table_insert(cache->attrs, g_strdup(path->data),
+                        g_memdup2(stbuf, sizeof(*stbuf)));
+}
+
+void v9fs_attr_cache_invalidate(FsContext *ctx, V9fsPath *path)
+{
+    V9fsAttrCache *cache = ctx->attr_cache;
+
+    if (!cache || !path->data) {
+        return;
+    }
+    g_hash_table_remove(cache->attrs, path->data);
+}
+
+/*
+ * Invalidate @name inside directory @path and anything cached beneath
+ * it, for operations that change the name space (unlink, rename).  A
+ * NULL @name invalidates the subtree rooted at @path itself.
+ */
+void v9fs_attr_cache_invalidate_subtree(FsContext *ctx, V9fsPath *path,
+                                        const char *name)
+{
+    V9fsAttrCache *cache = ctx->attr_cache;
+    g_autofree char *full = NULL;
+
+    if (!cache || !path->data) {
+        return;
+    }
+    if (name) {
+        full = g_strdup_printf("%s/%s", path->data, name);
+    }
+    v9fs_attr_cache_drop_subtree(cache, full ? full : path->data);
+}
@@ -0,0 +1,23 @@
+/*
+ * 9p backend - host side attribute cache
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2.  See
+ * the COPYING file in the top-level directory.
+ */
+
+#ifndef QEMU_9P_ATTR_CACHE_H
+#define QEMU_9P_ATTR_CACHE_H
+
+#include "fsdev/file-op-9p.h"
+
+void v9fs_attr_cache_init(FsContext *ctx);
+void v9fs_attr_cache_free(FsContext *ctx);
+bool v9fs_attr_cache_lookup(FsContext *ctx, V9fsPath *path,
+                            struct stat *stbuf);
+void v9fs_attr_cache_store(FsContext *ctx, V9fsPath *path,
+                           const struct stat *stbuf);
+void v9fs_attr_cache_invalidate(FsContext *ctx, V9fsPath *path);
+void v9fs_attr_cache_invalidate_subtree(FsContext *ctx, V9fsPath *path,
+                                        const char *name);
+
+#endif
@@ -592,16 +592,27 @@ static ssize_t local_preadv(FsContext *ctx, V9fsFidOpenState *fs,
                             const struct iovec *iov,
                             int iovcnt, off_t offset)
 {
+    ssize_t ret;
 #ifdef CONFIG_PREADV
-    return preadv(fs->fd, iov, iovcnt, offset);
+    ret = preadv(fs->fd, iov, iovcnt, offset);
 #else
     int err = lseek(fs->fd, offset, SEEK_SET);
     if (err == -1) {
         return err;
     } else {
-        return readv(fs->fd, iov, iovcnt);
+        ret = readv(fs->fd, iov, iovcnt);
     }
 #endif
+#ifdef POSIX_FADV_DONTNEED
+    if (ret > 0 && ctx->export_flags & V9FS_NO_HOST_CACHE) {
+        /*
+         * The guest caches this data itself, so drop it from the host
+         * page cache instead of keeping the share resident twice.
+         */
+        posix_fadvise(fs->fd, offset, ret, POSIX_FADV_DONTNEED);
+    }
+#endif
+    return ret;
 }
 
 static ssize_t local_pwritev(FsContext *ctx, V9fsFidOpenState *fs,
@@ -629,6 +640,20 @@ static ssize_t local_pwritev(FsContext *ctx, V9fsFidOpenState *fs,
         sync_file_range(fs->fd, offset, ret,
                         SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE);
     }
+#endif
+#ifdef POSIX_FADV_DONTNEED
+    if (ret > 0 && ctx->export_flags & V9FS_NO_HOST_CACHE) {
+#ifdef CONFIG_SYNC_FILE_RANGE
+        /*
+         * Write the data back first; only clean pages can be dropped
+         * from the page cache.
+         */
+        sync_file_range(fs->fd, offset, ret,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                        SYNC_FILE_RANGE_WAIT_AFTER);
+#endif
+        posix_fadvise(fs->fd, offset, ret, POSIX_FADV_DONTNEED);
+    }
 #endif
     return ret;
 }
@@ -30,6 +30,7 @@
 #include "virtio-9p.h"
 #include "fsdev/qemu-fsdev.h"
 #include "9p-xattr.h"
+#include "9p-attr-cache.h"
 #include "9p-util.h"
 #include "coth.h"
 #include "trace.h"
@@ -2299,6 +2300,18 @@ static int v9fs_xattr_read(V9fsState *s, V9fsPDU *pdu, V9fsFidState *fidp,
     return offset;
 }
 
+static void v9fs_free_dirents(struct V9fsDirEnt *e)
+{
+    struct V9fsDirEnt *next = NULL;
+
+    for (; e; e = next) {
+        next = e->next;
+        g_free(e->dent);
+        g_free(e->st);
+        g_free(e);
+    }
+}
+
 static int coroutine_fn v9fs_do_readdir_with_stat(V9fsPDU *pdu,
                                                   V9fsFidState *fidp,
                                                   uint32_t max_count)
@@ -2307,67 +2320,69 @@ static int coroutine_fn v9fs_do_readdir_with_stat(V9fsPDU *pdu,
     V9fsStat v9stat;
     int len, err = 0;
     int32_t count = 0;
-    struct stat stbuf;
-    off_t saved_dir_pos;
+    off_t off;
     struct dirent *dent;
+    struct V9fsDirEnt *entries = NULL, *e;
 
     /* save the directory position */
-    saved_dir_pos = v9fs_co_telldir(pdu, fidp);
-    if (saved_dir_pos < 0) {
-        return saved_dir_pos;
+    off = v9fs_co_telldir(pdu, fidp);
+    if (off < 0) {
+        return off;
     }
 
-    while (1) {
-        v9fs_path_init(&path);
+    /*
+     * Fetch a batch of directory entries, including their stat info, in
+     * one worker job instead of three worker hops per entry.  The size
+     * estimate used by the fetch is based on the (smaller) Rreaddir
+     * entry layout, so the batch may hold more entries than fit into
+     * this Rread response; surplus entries are dropped below and the
+     * directory is rewound to the first entry that was not delivered.
+     */
+    err = v9fs_co_readdir_many(pdu, fidp, &entries, off, max_count, true);
+    if (err < 0) {
+        goto out;
+    }
 
-        v9fs_readdir_lock(&fidp->fs.dir);
+    for (e = entries; e; e = e->next) {
+        dent = e->dent;
+        v9fs_path_init(&path);
 
-        err = v9fs_co_readdir(pdu, fidp, &dent);
-        if (err || !dent) {
-            break;
-        }
-        err = v9fs_co_name_to_path(pdu, &fidp->path, dent->d_name, &path);
-        if (err < 0) {
-            break;
-        }
-        err = v9fs_co_lstat(pdu, &path, &stbuf);
-        if (err < 0) {
-            break;
+        if (S_ISLNK(e->st->st_mode)) {
+            /* only symlinks need the path, to read the link target */
+            err = v9fs_co_name_to_path(pdu, &fidp->path, dent->d_name, &path);
+            if (err < 0) {
+                v9fs_path_free(&path);
+                break;
+            }
         }
-        err = stat_to_v9stat(pdu, &path, dent->d_name, &stbuf, &v9stat);
+        err = stat_to_v9stat(pdu, &path, dent->d_name, e->st, &v9stat);
+        v9fs_path_free(&path);
         if (err < 0) {
             break;
         }
         if ((count + v9stat.size + 2) > max_count) {
-            v9fs_readdir_unlock(&fidp->fs.dir);
-
             /* Ran out of buffer. Set dir back to old position and return */
-            v9fs_co_seekdir(pdu, fidp, saved_dir_pos);
             v9fs_stat_free(&v9stat);
-            v9fs_path_free(&path);
+            v9fs_co_seekdir(pdu, fidp, off);
+            v9fs_free_dirents(entries);
             return count;
         }
 
         /* 11 = 7 + 4 (7 = start offset, 4 = space for storing count) */
         len = pdu_marshal(pdu, 11 + count, "S", &v9stat);
-
-        v9fs_readdir_unlock(&fidp->fs.dir);
+        v9fs_stat_free(&v9stat);
 
         if (len < 0) {
-            v9fs_co_seekdir(pdu, fidp, saved_dir_pos);
-            v9fs_stat_free(&v9stat);
-            v9fs_path_free(&path);
+            v9fs_co_seekdir(pdu, fidp, off);
+            v9fs_free_dirents(entries);
             return len;
         }
         count += len;
-        v9fs_stat_free(&v9stat);
-        v9fs_path_free(&path);
-        saved_dir_pos = qemu_dirent_off(dent);
+        off = qemu_dirent_off(dent);
     }
 
-    v9fs_readdir_unlock(&fidp->fs.dir);
-
-    v9fs_path_free(&path);
+out:
+    v9fs_free_dirents(entries);
     if (err < 0) {
         return err;
     }
@@ -2482,18 +2497,6 @@ size_t v9fs_readdir_response_size(V9fsString *name)
     return 24 + v9fs_string_size(name);
 }
 
-static void v9fs_free_dirents(struct V9fsDirEnt *e)
-{
-    struct V9fsDirEnt *next = NULL;
-
-    for (; e; e = next) {
-        next = e->next;
-        g_free(e->dent);
-        g_free(e->st);
-        g_free(e);
-    }
-}
-
 static int coroutine_fn v9fs_do_readdir(V9fsPDU *pdu, V9fsFidState *fidp,
                                         off_t offset, int32_t max_count)
 {
@@ -4324,6 +4327,8 @@ int v9fs_device_realize_common(V9fsState *s, const V9fsTransport *t,
     s->ctx.fst = &fse->fst;
     fsdev_throttle_init(s->ctx.fst);
 
+    v9fs_attr_cache_init(&s->ctx);
+
     rc = 0;
 out:
     if (rc) {
@@ -4335,6 +4340,7 @@ out:
 
 void v9fs_device_unrealize_common(V9fsState *s)
 {
+    v9fs_attr_cache_free(&s->ctx);
     if (s->ops && s->ops->cleanup) {
         s->ops->cleanup(&s->ctx);
     }
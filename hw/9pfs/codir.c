@@ -23,6 +23,7 @@
 #include "coth.h"
 #include "9p-xattr.h"
 #include "9p-util.h"
+#include "9p-attr-cache.h"
 
 /*
  * Intended to be called from bottom-half (e.g. background I/O thread)
@@ -307,6 +308,10 @@ int coroutine_fn v9fs_co_mkdir(V9fsPDU *pdu, V9fsFidState *fidp,
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        /* The new entry changes the parent directory's mtime/nlink */
+        v9fs_attr_cache_invalidate(&s->ctx, &fidp->path);
+    }
     return err;
 }
 
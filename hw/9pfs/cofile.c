@@ -21,6 +21,7 @@
 #include "qemu/thread.h"
 #include "qemu/main-loop.h"
 #include "coth.h"
+#include "9p-attr-cache.h"
 
 int coroutine_fn v9fs_co_st_gen(V9fsPDU *pdu, V9fsPath *path, mode_t st_mode,
                                 V9fsStatDotl *v9stat)
@@ -54,6 +55,9 @@ int coroutine_fn v9fs_co_lstat(V9fsPDU *pdu, V9fsPath *path, struct stat *stbuf)
     if (v9fs_request_cancelled(pdu)) {
         return -EINTR;
     }
+    if (v9fs_attr_cache_lookup(&s->ctx, path, stbuf)) {
+        return 0;
+    }
     v9fs_path_read_lock(s);
     v9fs_co_run_in_worker(
         {
@@ -63,6 +67,9 @@ int coroutine_fn v9fs_co_lstat(V9fsPDU *pdu, V9fsPath *path, struct stat *stbuf)
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        v9fs_attr_cache_store(&s->ctx, path, stbuf);
+    }
     return err;
 }
 
@@ -119,6 +126,9 @@ int coroutine_fn v9fs_co_open(V9fsPDU *pdu, V9fsFidState *fidp, int flags)
         });
     v9fs_path_unlock(s);
     if (!err) {
+        if (flags & O_TRUNC) {
+            v9fs_attr_cache_invalidate(&s->ctx, &fidp->path);
+        }
         total_open_fd++;
         if (total_open_fd > open_fd_hw) {
             v9fs_reclaim_fd(pdu);
@@ -134,6 +144,7 @@ int coroutine_fn v9fs_co_open2(V9fsPDU *pdu, V9fsFidState *fidp,
     int err;
     FsCred cred;
     V9fsPath path;
+    V9fsPath dpath;
     V9fsState *s = pdu->s;
 
     if (v9fs_request_cancelled(pdu)) {
@@ -149,6 +160,9 @@ int coroutine_fn v9fs_co_open2(V9fsPDU *pdu, V9fsFidState *fidp,
      * cannot be used by another operation.
      */
     v9fs_path_write_lock(s);
+    /* On success fidp->path becomes the new file; remember the parent */
+    v9fs_path_init(&dpath);
+    v9fs_path_copy(&dpath, &fidp->path);
     v9fs_co_run_in_worker(
         {
             err = s->ops->open2(&s->ctx, &fidp->path,
@@ -174,11 +188,14 @@ int coroutine_fn v9fs_co_open2(V9fsPDU *pdu, V9fsFidState *fidp,
         });
     v9fs_path_unlock(s);
     if (!err) {
+        /* The new file changes the parent directory's mtime */
+        v9fs_attr_cache_invalidate(&s->ctx, &dpath);
         total_open_fd++;
         if (total_open_fd > open_fd_hw) {
             v9fs_reclaim_fd(pdu);
         }
     }
+    v9fs_path_free(&dpath);
     return err;
 }
 
@@ -240,6 +257,11 @@ int coroutine_fn v9fs_co_link(V9fsPDU *pdu, V9fsFidState *oldfid,
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        /* The link bumps the target's nlink and the directory's mtime */
+        v9fs_attr_cache_invalidate(&s->ctx, &oldfid->path);
+        v9fs_attr_cache_invalidate(&s->ctx, &newdirfid->path);
+    }
     return err;
 }
 
@@ -260,6 +282,9 @@ int coroutine_fn v9fs_co_pwritev(V9fsPDU *pdu, V9fsFidState *fidp,
                 err = -errno;
             }
         });
+    if (err > 0) {
+        v9fs_attr_cache_invalidate(&s->ctx, &fidp->path);
+    }
     return err;
 }
 
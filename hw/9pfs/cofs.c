@@ -21,6 +21,7 @@
 #include "qemu/thread.h"
 #include "qemu/main-loop.h"
 #include "coth.h"
+#include "9p-attr-cache.h"
 
 static ssize_t __readlink(V9fsState *s, V9fsPath *path, V9fsString *buf)
 {
@@ -115,6 +116,9 @@ int coroutine_fn v9fs_co_chmod(V9fsPDU *pdu, V9fsPath *path, mode_t mode)
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        v9fs_attr_cache_invalidate(&s->ctx, path);
+    }
     return err;
 }
 
@@ -136,6 +140,9 @@ int coroutine_fn v9fs_co_utimensat(V9fsPDU *pdu, V9fsPath *path,
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        v9fs_attr_cache_invalidate(&s->ctx, path);
+    }
     return err;
 }
 
@@ -161,6 +168,9 @@ int coroutine_fn v9fs_co_chown(V9fsPDU *pdu, V9fsPath *path, uid_t uid,
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        v9fs_attr_cache_invalidate(&s->ctx, path);
+    }
     return err;
 }
 
@@ -181,6 +191,9 @@ int coroutine_fn v9fs_co_truncate(V9fsPDU *pdu, V9fsPath *path, off_t size)
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        v9fs_attr_cache_invalidate(&s->ctx, path);
+    }
     return err;
 }
 
@@ -220,6 +233,10 @@ int coroutine_fn v9fs_co_mknod(V9fsPDU *pdu, V9fsFidState *fidp,
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        /* The new node changes the parent directory's mtime */
+        v9fs_attr_cache_invalidate(&s->ctx, &fidp->path);
+    }
     return err;
 }
 
@@ -241,6 +258,9 @@ int coroutine_fn v9fs_co_remove(V9fsPDU *pdu, V9fsPath *path)
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        v9fs_attr_cache_invalidate_subtree(&s->ctx, path, NULL);
+    }
     return err;
 }
 
@@ -262,6 +282,9 @@ int coroutine_fn v9fs_co_unlinkat(V9fsPDU *pdu, V9fsPath *path,
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        v9fs_attr_cache_invalidate_subtree(&s->ctx, path, name->data);
+    }
     return err;
 }
 
@@ -282,6 +305,10 @@ int coroutine_fn v9fs_co_rename(V9fsPDU *pdu, V9fsPath *oldpath,
                 err = -errno;
             }
         });
+    if (!err) {
+        v9fs_attr_cache_invalidate_subtree(&s->ctx, oldpath, NULL);
+        v9fs_attr_cache_invalidate_subtree(&s->ctx, newpath, NULL);
+    }
     return err;
 }
 
@@ -303,6 +330,10 @@ int coroutine_fn v9fs_co_renameat(V9fsPDU *pdu, V9fsPath *olddirpath,
                 err = -errno;
             }
         });
+    if (!err) {
+        v9fs_attr_cache_invalidate_subtree(&s->ctx, olddirpath, oldname->data);
+        v9fs_attr_cache_invalidate_subtree(&s->ctx, newdirpath, newname->data);
+    }
     return err;
 }
 
@@ -342,6 +373,10 @@ int coroutine_fn v9fs_co_symlink(V9fsPDU *pdu, V9fsFidState *dfidp,
             }
         });
     v9fs_path_unlock(s);
+    if (!err) {
+        /* The new symlink changes the parent directory's mtime */
+        v9fs_attr_cache_invalidate(&s->ctx, &dfidp->path);
+    }
     return err;
 }
 
@@ -444,6 +444,8 @@ build_append_named_dword(GArray *array, const char *name_format, ...)
 }
 
 static GPtrArray *alloc_list;
+/* scratch buffer reused by aml_append(), valid while alloc_list is */
+static GArray *append_scratch;
 
 static Aml *aml_alloc(void)
 {
@@ -484,6 +486,7 @@ Aml *init_aml_allocator(void)
 {
     assert(!alloc_list);
     alloc_list = g_ptr_array_new();
+    append_scratch = build_alloc_array();
     return aml_alloc();
 }
 
@@ -492,6 +495,8 @@ void free_aml_allocator(void)
     g_ptr_array_foreach(alloc_list, aml_free, NULL);
     g_ptr_array_free(alloc_list, true);
     alloc_list = 0;
+    build_free_array(append_scratch);
+    append_scratch = NULL;
 }
 
 /* pack data with DefBuffer encoding */
@@ -507,13 +512,30 @@ static void build_buffer(GArray *array, uint8_t op)
 
 void aml_append(Aml *parent_ctx, Aml *child)
 {
-    GArray *buf = build_alloc_array();
-    build_append_array(buf, child->buf);
+    GArray *buf;
 
     switch (child->block_flags) {
     case AML_OPCODE:
         build_append_byte(parent_ctx->buf, child->op);
+        /* fall through */
+    case AML_NO_OPCODE:
+        /* nothing to prepend, append the child encoding as is */
+        build_append_array(parent_ctx->buf, child->buf);
+        return;
+    default:
         break;
+    }
+
+    /*
+     * The remaining cases prepend a package header to the child encoding;
+     * stage that in the scratch buffer, which is reused across calls so
+     * each append does not allocate and free a temporary array.
+     */
+    buf = append_scratch;
+    g_array_set_size(buf, 0);
+    build_append_array(buf, child->buf);
+
+    switch (child->block_flags) {
     case AML_EXT_PACKAGE:
         build_extop_package(buf, child->op);
         break;
@@ -531,13 +553,10 @@ void aml_append(Aml *parent_ctx, Aml *child)
     case AML_BUFFER:
         build_buffer(buf, child->op);
         break;
-    case AML_NO_OPCODE:
-        break;
     default:
         g_assert_not_reached();
     }
     build_append_array(parent_ctx->buf, buf);
-    build_free_array(buf);
 }
 
 /* ACPI 1.0b: 16.2.5.1 Namespace Modifier Objects Encoding: DefScope */
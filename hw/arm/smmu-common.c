@@ -153,9 +153,32 @@ void smmu_iotlb_insert(SMMUState *bs, SMMUTransCfg *cfg, SMMUTLBEntry *new)
     g_hash_table_insert(bs->iotlb, key, new);
 }
 
+static void smmu_walk_cache_clear_one(gpointer key, gpointer value,
+                                      gpointer user_data)
+{
+    SMMUTransCfg *cfg = (SMMUTransCfg *)value;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(cfg->tt); i++) {
+        memset(cfg->tt[i].walk_cache, 0, sizeof(cfg->tt[i].walk_cache));
+    }
+}
+
+/*
+ * Drop the intermediate-level walk caches of all cached configs.  The
+ * walk cache is not tagged finely enough to honour the scope of an
+ * invalidation command, so every TLBI clears it entirely; what it buys
+ * is the re-walk from the root on ordinary TLB misses.
+ */
+static void smmu_walk_cache_inv_all(SMMUState *s)
+{
+    g_hash_table_foreach(s->configs, smmu_walk_cache_clear_one, NULL);
+}
+
 void smmu_iotlb_inv_all(SMMUState *s)
 {
     trace_smmu_iotlb_inv_all();
+    smmu_walk_cache_inv_all(s);
     g_hash_table_remove_all(s->iotlb);
 }
 
@@ -252,6 +275,8 @@ void smmu_iotlb_inv_iova(SMMUState *s, int asid, int vmid, dma_addr_t iova,
     /* if tg is not set we use 4KB range invalidation */
     uint8_t granule = tg ? tg * 2 + 10 : 12;
 
+    smmu_walk_cache_inv_all(s);
+
     if (ttl && (num_pages == 1) && (asid >= 0)) {
         SMMUIOTLBKey key = smmu_get_iotlb_key(asid, vmid, iova, tg, ttl);
 
@@ -284,6 +309,8 @@ void smmu_iotlb_inv_ipa(SMMUState *s, int vmid, dma_addr_t ipa, uint8_t tg,
     uint8_t granule = tg ? tg * 2 + 10 : 12;
     int asid = -1;
 
+    smmu_walk_cache_inv_all(s);
+
    if (ttl && (num_pages == 1)) {
         SMMUIOTLBKey key = smmu_get_iotlb_key(asid, vmid, ipa, tg, ttl);
 
@@ -310,18 +337,21 @@ void smmu_iotlb_inv_asid_vmid(SMMUState *s, int asid, int vmid)
     };
 
     trace_smmu_iotlb_inv_asid_vmid(asid, vmid);
+    smmu_walk_cache_inv_all(s);
     g_hash_table_foreach_remove(s->iotlb, smmu_hash_remove_by_asid_vmid, &info);
 }
 
 void smmu_iotlb_inv_vmid(SMMUState *s, int vmid)
 {
     trace_smmu_iotlb_inv_vmid(vmid);
+    smmu_walk_cache_inv_all(s);
     g_hash_table_foreach_remove(s->iotlb, smmu_hash_remove_by_vmid, &vmid);
 }
 
 inline void smmu_iotlb_inv_vmid_s1(SMMUState *s, int vmid)
 {
     trace_smmu_iotlb_inv_vmid_s1(vmid);
+    smmu_walk_cache_inv_all(s);
     g_hash_table_foreach_remove(s->iotlb, smmu_hash_remove_by_vmid_s1, &vmid);
 }
 
@@ -462,6 +492,7 @@ static int smmu_ptw_64_s1(SMMUState *bs, SMMUTransCfg *cfg,
     SMMUStage stage = cfg->stage;
     SMMUTransTableInfo *tt = select_tt(cfg, iova);
     uint8_t level, granule_sz, inputsize, stride;
+    int lvl;
 
     if (!tt || tt->disabled) {
         info->type = SMMU_PTW_ERR_TRANSLATION;
@@ -477,6 +508,21 @@ static int smmu_ptw_64_s1(SMMUState *bs, SMMUTransCfg *cfg,
     baseaddr = extract64(tt->ttb, 0, cfg->oas);
     baseaddr &= ~indexmask;
 
+    /*
+     * Resume the walk from the deepest cached table covering this iova,
+     * skipping the upper-level PTE fetches.
+     */
+    for (lvl = VMSA_LEVELS - 1; lvl > level; lvl--) {
+        SMMUPTWCacheEntry *wc = &tt->walk_cache[lvl];
+        uint64_t span = 1ULL << level_shift(lvl - 1, granule_sz);
+
+        if (wc->valid && (iova & ~(span - 1)) == wc->va) {
+            baseaddr = wc->table;
+            level = lvl;
+            break;
+        }
+    }
+
     while (level < VMSA_LEVELS) {
         uint64_t subpage_size = 1ULL << level_shift(level, granule_sz);
         uint64_t mask = subpage_size - 1;
@@ -510,6 +556,11 @@ static int smmu_ptw_64_s1(SMMUState *bs, SMMUTransCfg *cfg,
                     goto error;
                 }
             }
+            tt->walk_cache[level + 1] = (SMMUPTWCacheEntry) {
+                .valid = true,
+                .va = iova & ~mask,
+                .table = baseaddr,
+            };
             level++;
             continue;
         } else if (is_page_pte(pte, level)) {
@@ -39,6 +39,7 @@ typedef struct XenBlockRequest {
     void *buf;
     size_t size;
     int presync;
+    bool copied;
     int aio_inflight;
     int aio_errors;
     XenBlockDataPlane *dataplane;
@@ -76,6 +77,7 @@ static void reset_request(XenBlockRequest *request)
     request->start = 0;
     request->size = 0;
     request->presync = 0;
+    request->copied = false;
 
     request->aio_inflight = 0;
     request->aio_errors = 0;
@@ -207,21 +209,14 @@ err:
     return -1;
 }
 
-static int xen_block_copy_request(XenBlockRequest *request)
+/* Fill @segs from the request's segment table; returns the segment count */
+static unsigned int xen_block_fill_copy_segs(XenBlockRequest *request,
+                                             XenDeviceGrantCopySegment *segs,
+                                             bool to_domain)
 {
     XenBlockDataPlane *dataplane = request->dataplane;
-    XenDevice *xendev = dataplane->xendev;
-    XenDeviceGrantCopySegment segs[BLKIF_MAX_SEGMENTS_PER_REQUEST];
-    int i, count;
-    bool to_domain = (request->req.operation == BLKIF_OP_READ);
+    unsigned int i, count = request->req.nr_segments;
     void *virt = request->buf;
-    Error *local_err = NULL;
-
-    if (request->req.nr_segments == 0) {
-        return 0;
-    }
-
-    count = request->req.nr_segments;
 
     for (i = 0; i < count; i++) {
         if (to_domain) {
@@ -241,6 +236,24 @@ static int xen_block_copy_request(XenBlockRequest *request)
         virt += segs[i].len;
     }
 
+    return count;
+}
+
+static int xen_block_copy_request(XenBlockRequest *request)
+{
+    XenBlockDataPlane *dataplane = request->dataplane;
+    XenDevice *xendev = dataplane->xendev;
+    XenDeviceGrantCopySegment segs[BLKIF_MAX_SEGMENTS_PER_REQUEST];
+    unsigned int count;
+    bool to_domain = (request->req.operation == BLKIF_OP_READ);
+    Error *local_err = NULL;
+
+    if (request->req.nr_segments == 0) {
+        return 0;
+    }
+
+    count = xen_block_fill_copy_segs(request, segs, to_domain);
+
     xen_device_copy_grant_refs(xendev, to_domain, segs, count, &local_err);
 
     if (local_err) {
@@ -355,7 +368,7 @@ static int xen_block_do_aio(XenBlockRequest *request)
 {
     XenBlockDataPlane *dataplane = request->dataplane;
 
-    if (request->req.nr_segments &&
+    if (request->req.nr_segments && !request->copied &&
         (request->req.operation == BLKIF_OP_WRITE ||
          request->req.operation == BLKIF_OP_FLUSH_DISKCACHE) &&
         xen_block_copy_request(request)) {
@@ -509,10 +522,63 @@ static int xen_block_get_request(XenBlockDataPlane *dataplane,
  */
 #define IO_PLUG_THRESHOLD 1
 
+static bool xen_block_request_needs_copy(XenBlockRequest *request)
+{
+    return request->req.nr_segments &&
+           (request->req.operation == BLKIF_OP_WRITE ||
+            request->req.operation == BLKIF_OP_FLUSH_DISKCACHE);
+}
+
+/*
+ * Copy the data of all pending write requests out of the frontend with
+ * a single grant copy operation, rather than one per request. If the
+ * combined operation fails, leave the requests unmarked so that
+ * xen_block_do_aio() retries them individually and the error is
+ * attributed to the right request.
+ */
+static void xen_block_copy_batch(XenBlockDataPlane *dataplane,
+                                 XenBlockRequest *pending[],
+                                 unsigned int nr_pending)
+{
+    g_autofree XenDeviceGrantCopySegment *segs = NULL;
+    unsigned int i, count = 0;
+    Error *local_err = NULL;
+
+    segs = g_new(XenDeviceGrantCopySegment,
+                 nr_pending * BLKIF_MAX_SEGMENTS_PER_REQUEST);
+
+    for (i = 0; i < nr_pending; i++) {
+        if (xen_block_request_needs_copy(pending[i])) {
+            count += xen_block_fill_copy_segs(pending[i], &segs[count],
+                                              false);
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    xen_device_copy_grant_refs(dataplane->xendev, false, segs, count,
+                               &local_err);
+    if (local_err) {
+        error_free(local_err);
+        return;
+    }
+
+    for (i = 0; i < nr_pending; i++) {
+        if (xen_block_request_needs_copy(pending[i])) {
+            pending[i]->copied = true;
+        }
+    }
+}
+
 static bool xen_block_handle_requests(XenBlockDataPlane *dataplane)
 {
     RING_IDX rc, rp;
     XenBlockRequest *request;
+    g_autofree XenBlockRequest **pending = NULL;
+    unsigned int nr_pending = 0;
+    unsigned int i;
     int inflight_atstart = dataplane->requests_inflight;
     int batched = 0;
     bool done_something = false;
@@ -523,18 +589,8 @@ static bool xen_block_handle_requests(XenBlockDataPlane *dataplane)
     rp = dataplane->rings.common.sring->req_prod;
     xen_rmb(); /* Ensure we see queued requests up to 'rp'. */
 
-    /*
-     * If there was more than IO_PLUG_THRESHOLD requests in flight
-     * when we got here, this is an indication that there the bottleneck
-     * is below us, so it's worth beginning to batch up I/O requests
-     * rather than submitting them immediately. The maximum number
-     * of requests we're willing to batch is the number already in
-     * flight, so it can grow up to max_requests when the bottleneck
-     * is below us.
-     */
-    if (inflight_atstart > IO_PLUG_THRESHOLD) {
-        defer_call_begin();
-    }
+    pending = g_new(XenBlockRequest *, dataplane->max_requests);
+
     while (rc != rp) {
         /* pull request from ring */
         if (RING_REQUEST_CONS_OVERFLOW(&dataplane->rings.common, rc)) {
@@ -571,11 +627,29 @@ static bool xen_block_handle_requests(XenBlockDataPlane *dataplane)
             continue;
         }
 
+        pending[nr_pending++] = request;
+    }
+
+    xen_block_copy_batch(dataplane, pending, nr_pending);
+
+    /*
+     * If there was more than IO_PLUG_THRESHOLD requests in flight
+     * when we got here, this is an indication that there the bottleneck
+     * is below us, so it's worth beginning to batch up I/O requests
+     * rather than submitting them immediately. The maximum number
+     * of requests we're willing to batch is the number already in
+     * flight, so it can grow up to max_requests when the bottleneck
+     * is below us.
+     */
+    if (inflight_atstart > IO_PLUG_THRESHOLD) {
+        defer_call_begin();
+    }
+    for (i = 0; i < nr_pending; i++) {
         if (inflight_atstart > IO_PLUG_THRESHOLD &&
             batched >= inflight_atstart) {
             defer_call_end();
         }
-        xen_block_do_aio(request);
+        xen_block_do_aio(pending[i]);
         if (inflight_atstart > IO_PLUG_THRESHOLD) {
             if (batched >= inflight_atstart) {
                 defer_call_begin();
@@ -57,6 +57,8 @@
 #define PFLASH_BE          0
 #define PFLASH_SECURE      1
 
+#define PFLASH_LAZY_ROMD_THRESHOLD 42
+
 struct PFlashCFI01 {
     /*< private >*/
     SysBusDevice parent_obj;
@@ -79,6 +81,7 @@ struct PFlashCFI01 {
     uint16_t ident3;
     uint8_t cfi_table[0x52];
     uint64_t counter;
+    int read_counter; /* used for lazy switch-back to ROMD mode */
     uint32_t writeblock_size;
     MemoryRegion mem;
     char *name;
@@ -260,23 +263,36 @@ static uint32_t pflash_data_read(PFlashCFI01 *pfl, hwaddr offset,
     return ret;
 }
 
+static void pflash_mode_read_array(PFlashCFI01 *pfl)
+{
+    trace_pflash_mode_read_array(pfl->name);
+    memory_region_rom_device_set_romd(&pfl->mem, true);
+    pfl->wcycle = 0;
+    /*
+     * The command 0x00 is not assigned by the CFI open standard,
+     * but QEMU historically uses it for the READ_ARRAY command (0xff).
+     */
+    pfl->cmd = 0x00;
+}
+
 static uint32_t pflash_read(PFlashCFI01 *pfl, hwaddr offset,
                             int width, int be)
 {
     hwaddr boff;
     uint32_t ret;
 
+    /* Lazy reset to ROMD mode after a certain amount of read accesses */
+    if (pfl->wcycle == 0 && pfl->cmd != 0x00 &&
+        ++pfl->read_counter > PFLASH_LAZY_ROMD_THRESHOLD) {
+        pflash_mode_read_array(pfl);
+    }
+
     ret = -1;
     switch (pfl->cmd) {
     default:
         /* This should never happen : reset state & treat it as a read */
         trace_pflash_read_unknown_state(pfl->name, pfl->cmd);
-        pfl->wcycle = 0;
-        /*
-         * The command 0x00 is not assigned by the CFI open standard,
-         * but QEMU historically uses it for the READ_ARRAY command (0xff).
-         */
-        pfl->cmd = 0x00;
+        pflash_mode_read_array(pfl);
         /* fall through to read code */
     case 0x00: /* This model reset value for READ_ARRAY (not CFI compliant) */
         /* Flash area read */
@@ -471,6 +487,7 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
     if (!pfl->wcycle) {
         /* Set the device in I/O access mode */
         memory_region_rom_device_set_romd(&pfl->mem, false);
+        pfl->read_counter = 0;
     }
 
     switch (pfl->wcycle) {
@@ -652,10 +669,7 @@ static void pflash_write(PFlashCFI01 *pfl, hwaddr offset,
                   "\n", __func__, offset, pfl->wcycle, pfl->cmd, value);
 
  mode_read_array:
-    trace_pflash_mode_read_array(pfl->name);
-    memory_region_rom_device_set_romd(&pfl->mem, true);
-    pfl->wcycle = 0;
-    pfl->cmd = 0x00; /* This model reset value for READ_ARRAY (not CFI) */
+    pflash_mode_read_array(pfl);
 }
 
 
@@ -1042,5 +1056,15 @@ static int pflash_post_load(void *opaque, int version_id)
         pfl->vmstate = qemu_add_vm_change_state_handler(postload_update_cb,
                                                         pfl);
     }
+
+    /*
+     * The ROMD state of the memory region is not migrated; restore it
+     * from the command state machine.  An in-flight command sequence
+     * means reads must trap into pflash_read().
+     */
+    if (pfl->wcycle || pfl->cmd != 0x00) {
+        memory_region_rom_device_set_romd(&pfl->mem, false);
+    }
+
     return 0;
 }
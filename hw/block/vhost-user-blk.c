@@ -142,16 +142,20 @@ static int vhost_user_blk_start(VirtIODevice *vdev, Error **errp)
         return -ENOSYS;
     }
 
-    ret = vhost_dev_enable_notifiers(&s->dev, vdev);
-    if (ret < 0) {
-        error_setg_errno(errp, -ret, "Error enabling host notifiers");
-        return ret;
-    }
+    /* Notifiers survive a warm resume; only wire them up once */
+    if (!s->notifiers_set) {
+        ret = vhost_dev_enable_notifiers(&s->dev, vdev);
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "Error enabling host notifiers");
+            return ret;
+        }
 
-    ret = k->set_guest_notifiers(qbus->parent, s->dev.nvqs, true);
-    if (ret < 0) {
-        error_setg_errno(errp, -ret, "Error binding guest notifier");
-        goto err_host_notifiers;
+        ret = k->set_guest_notifiers(qbus->parent, s->dev.nvqs, true);
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "Error binding guest notifier");
+            goto err_host_notifiers;
+        }
+        s->notifiers_set = true;
     }
 
     s->dev.acked_features = vdev->guest_features;
@@ -201,16 +205,41 @@ err_guest_notifiers:
     k->set_guest_notifiers(qbus->parent, s->dev.nvqs, false);
 err_host_notifiers:
     vhost_dev_disable_notifiers(&s->dev, vdev);
+    s->notifiers_set = false;
     return ret;
 }
 
-static void vhost_user_blk_stop(VirtIODevice *vdev)
+static void vhost_user_blk_drop_notifiers(VirtIODevice *vdev)
 {
     VHostUserBlk *s = VHOST_USER_BLK(vdev);
     BusState *qbus = BUS(qdev_get_parent_bus(DEVICE(vdev)));
     VirtioBusClass *k = VIRTIO_BUS_GET_CLASS(qbus);
     int ret;
 
+    if (!s->notifiers_set) {
+        return;
+    }
+    s->notifiers_set = false;
+
+    ret = k->set_guest_notifiers(qbus->parent, s->num_queues, false);
+    if (ret < 0) {
+        error_report("vhost guest notifier cleanup failed: %d", ret);
+        return;
+    }
+
+    /*
+     * s->dev may have been zeroed by vhost_dev_cleanup() since the
+     * notifiers were set up, so use the device's own queue count.
+     */
+    vhost_dev_disable_notifiers_nvqs(&s->dev, vdev, s->num_queues);
+}
+
+static void vhost_user_blk_stop(VirtIODevice *vdev)
+{
+    VHostUserBlk *s = VHOST_USER_BLK(vdev);
+    BusState *qbus = BUS(qdev_get_parent_bus(DEVICE(vdev)));
+    VirtioBusClass *k = VIRTIO_BUS_GET_CLASS(qbus);
+
     if (!s->started_vu) {
         return;
     }
@@ -222,13 +251,28 @@ static void vhost_user_blk_stop(VirtIODevice *vdev)
 
     vhost_dev_stop(&s->dev, vdev, true);
 
-    ret = k->set_guest_notifiers(qbus->parent, s->dev.nvqs, false);
-    if (ret < 0) {
-        error_report("vhost guest notifier cleanup failed: %d", ret);
+    vhost_user_blk_drop_notifiers(vdev);
+}
+
+/*
+ * Backend disconnect while the guest is running: snapshot the ring
+ * state but keep host and guest notifiers in place, so the device
+ * stays logically online and reconnecting is a latency blip rather
+ * than an outage.  GET_VRING_BASE cannot be answered by a dead
+ * backend; vhost then falls back to the shadow indexes, and the
+ * preserved inflight region records the descriptors the backend had
+ * claimed but not completed, so only those are replayed on resume.
+ */
+static void vhost_user_blk_suspend(VirtIODevice *vdev)
+{
+    VHostUserBlk *s = VHOST_USER_BLK(vdev);
+
+    if (!s->started_vu) {
         return;
     }
+    s->started_vu = false;
 
-    vhost_dev_disable_notifiers(&s->dev, vdev);
+    vhost_dev_stop(&s->dev, vdev, false);
 }
 
 static void vhost_user_blk_set_status(VirtIODevice *vdev, uint8_t status)
@@ -323,6 +367,8 @@ static void vhost_user_blk_reset(VirtIODevice *vdev)
 {
     VHostUserBlk *s = VHOST_USER_BLK(vdev);
 
+    /* Notifiers held across a disconnect are stale after a reset */
+    vhost_user_blk_drop_notifiers(vdev);
     vhost_dev_free_inflight(s->inflight);
 }
 
@@ -355,7 +401,25 @@ static int vhost_user_blk_connect(DeviceState *dev, Error **errp)
 
     /* restore vhost state */
     if (virtio_device_started(vdev, vdev->status)) {
+        bool resuming = s->notifiers_set;
+
         ret = vhost_user_blk_start(vdev, errp);
+        if (ret == 0 && resuming) {
+            int i;
+
+            /*
+             * Warm resume: kick every live queue so requests the guest
+             * submitted during the outage are picked up right away.
+             */
+            for (i = 0; i < s->dev.nvqs; i++) {
+                VirtQueue *kick_vq = virtio_get_queue(vdev, i);
+
+                if (!virtio_queue_get_desc_addr(vdev, i)) {
+                    continue;
+                }
+                event_notifier_set(virtio_queue_get_host_notifier(kick_vq));
+            }
+        }
     }
 
     return ret;
@@ -371,7 +435,11 @@ static void vhost_user_blk_disconnect(DeviceState *dev)
     }
     s->connected = false;
 
-    vhost_user_blk_stop(vdev);
+    if (virtio_device_started(vdev, vdev->status)) {
+        vhost_user_blk_suspend(vdev);
+    } else {
+        vhost_user_blk_stop(vdev);
+    }
 
     vhost_dev_cleanup(&s->dev);
 
@@ -531,6 +599,8 @@ static void vhost_user_blk_device_unrealize(DeviceState *dev)
     virtio_set_status(vdev, 0);
     qemu_chr_fe_set_handlers(&s->chardev,  NULL, NULL, NULL,
                              NULL, NULL, NULL, false);
+    /* May still be held if the backend was disconnected at this point */
+    vhost_user_blk_drop_notifiers(vdev);
     vhost_dev_cleanup(&s->dev);
     vhost_dev_free_inflight(s->inflight);
     g_free(s->vhost_vqs);
@@ -168,15 +168,8 @@ static void virtio_blk_discard_write_zeroes_complete(void *opaque, int ret)
     g_free(req);
 }
 
-static VirtIOBlockReq *virtio_blk_get_request(VirtIOBlock *s, VirtQueue *vq)
-{
-    VirtIOBlockReq *req = virtqueue_pop(vq, sizeof(VirtIOBlockReq));
-
-    if (req) {
-        virtio_blk_init_request(s, vq, req);
-    }
-    return req;
-}
+/* Number of requests popped from the virtqueue in one batch */
+#define VIRTIO_BLK_POP_BATCH 16
 
 static void virtio_blk_handle_scsi(VirtIOBlockReq *req)
 {
@@ -345,7 +338,8 @@ static void virtio_blk_handle_flush(VirtIOBlockReq *req, MultiReqBuffer *mrb)
     /*
      * Make sure all outstanding writes are posted to the backing device.
      */
-    if (mrb->is_write && mrb->num_reqs > 0) {
+    assert(!mrb->num_reqs || mrb->is_write);
+    if (mrb->num_reqs > 0) {
         virtio_blk_submit_multireq(s, mrb);
     }
     blk_aio_flush(s->blk, virtio_blk_flush_complete, req);
@@ -788,7 +782,8 @@ out:
     return err_status;
 }
 
-static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
+/* @mrbs is indexed by request direction: 0 for reads, 1 for writes */
+static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrbs)
 {
     uint32_t type;
     struct iovec *in_iov = req->elem.in_sg;
@@ -835,6 +830,8 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
     case VIRTIO_BLK_T_IN:
     {
         bool is_write = type & VIRTIO_BLK_T_OUT;
+        MultiReqBuffer *mrb = &mrbs[is_write];
+
         req->sector_num = virtio_ldq_p(vdev, &req->out.sector);
 
         if (is_write) {
@@ -858,10 +855,8 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
         block_acct_start(blk_get_stats(s->blk), &req->acct, req->qiov.size,
                          is_write ? BLOCK_ACCT_WRITE : BLOCK_ACCT_READ);
 
-        /* merge would exceed maximum number of requests or IO direction
-         * changes */
+        /* merge would exceed the maximum number of requests */
         if (mrb->num_reqs > 0 && (mrb->num_reqs == VIRTIO_BLK_MAX_MERGE_REQS ||
-                                  is_write != mrb->is_write ||
                                   !s->conf.request_merging)) {
             virtio_blk_submit_multireq(s, mrb);
         }
@@ -872,7 +867,7 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
         break;
     }
     case VIRTIO_BLK_T_FLUSH:
-        virtio_blk_handle_flush(req, mrb);
+        virtio_blk_handle_flush(req, &mrbs[1]);
         break;
     case VIRTIO_BLK_T_ZONE_REPORT:
         virtio_blk_handle_zone_report(req, in_iov, in_num);
@@ -969,7 +964,7 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
          */
         VirtIOBlkClass *vbk = VIRTIO_BLK_GET_CLASS(s);
         if (!vbk->handle_unknown_request ||
-            !vbk->handle_unknown_request(req, mrb, type)) {
+            !vbk->handle_unknown_request(req, mrbs, type)) {
             virtio_blk_req_complete(req, VIRTIO_BLK_S_UNSUPP);
             g_free(req);
         }
@@ -981,7 +976,11 @@ static int virtio_blk_handle_request(VirtIOBlockReq *req, MultiReqBuffer *mrb)
 void virtio_blk_handle_vq(VirtIOBlock *s, VirtQueue *vq)
 {
     VirtIOBlockReq *req;
-    MultiReqBuffer mrb = {};
+    VirtQueueElement *elems[VIRTIO_BLK_POP_BATCH];
+    unsigned int nelems;
+    /* One request batch per direction, so interleaved reads and writes
+     * cannot break up either batch. */
+    MultiReqBuffer mrbs[2] = {};
     bool suppress_notifications = virtio_queue_get_notification(vq);
 
     defer_call_begin();
@@ -991,10 +990,21 @@ void virtio_blk_handle_vq(VirtIOBlock *s, VirtQueue *vq)
             virtio_queue_set_notification(vq, 0);
         }
 
-        while ((req = virtio_blk_get_request(s, vq))) {
-            if (virtio_blk_handle_request(req, &mrb)) {
-                virtqueue_detach_element(req->vq, &req->elem, 0);
-                g_free(req);
+        while ((nelems = virtqueue_pop_batch(vq, sizeof(VirtIOBlockReq),
+                                             elems, ARRAY_SIZE(elems)))) {
+            bool fatal = false;
+
+            for (unsigned int i = 0; i < nelems; i++) {
+                req = (VirtIOBlockReq *)elems[i];
+                virtio_blk_init_request(s, vq, req);
+                /* On error drain the rest of the batch, the vq is broken */
+                if (fatal || virtio_blk_handle_request(req, mrbs)) {
+                    virtqueue_detach_element(req->vq, &req->elem, 0);
+                    g_free(req);
+                    fatal = true;
+                }
+            }
+            if (fatal) {
                 break;
             }
         }
@@ -1004,8 +1014,10 @@ void virtio_blk_handle_vq(VirtIOBlock *s, VirtQueue *vq)
         }
     } while (!virtio_queue_empty(vq));
 
-    if (mrb.num_reqs) {
-        virtio_blk_submit_multireq(s, &mrb);
+    for (int i = 0; i < ARRAY_SIZE(mrbs); i++) {
+        if (mrbs[i].num_reqs) {
+            virtio_blk_submit_multireq(s, &mrbs[i]);
+        }
     }
 
     defer_call_end();
@@ -1033,11 +1045,11 @@ static void virtio_blk_dma_restart_bh(void *opaque)
     VirtIOBlockReq *req = opaque;
     VirtIOBlock *s = req->dev; /* we're called with at least one request */
 
-    MultiReqBuffer mrb = {};
+    MultiReqBuffer mrbs[2] = {};
 
     while (req) {
         VirtIOBlockReq *next = req->next;
-        if (virtio_blk_handle_request(req, &mrb)) {
+        if (virtio_blk_handle_request(req, mrbs)) {
             /* Device is now broken and won't do any processing until it gets
              * reset. Already queued requests will be lost: let's purge them.
              */
@@ -1052,8 +1064,10 @@ static void virtio_blk_dma_restart_bh(void *opaque)
         req = next;
     }
 
-    if (mrb.num_reqs) {
-        virtio_blk_submit_multireq(s, &mrb);
+    for (int i = 0; i < ARRAY_SIZE(mrbs); i++) {
+        if (mrbs[i].num_reqs) {
+            virtio_blk_submit_multireq(s, &mrbs[i]);
+        }
     }
 
     /* Paired with inc in virtio_blk_dma_restart_cb() */
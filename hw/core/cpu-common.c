@@ -278,6 +278,8 @@ static void cpu_common_initfn(Object *obj)
     QSIMPLEQ_INIT(&cpu->work_list);
     QTAILQ_INIT(&cpu->breakpoints);
     QTAILQ_INIT(&cpu->watchpoints);
+    cpu->watchpoints_lo = -1;
+    cpu->watchpoints_hi = 0;
 
     cpu_exec_initfn(cpu);
 
@@ -8,6 +8,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "exec/cpu-common.h"
 #include "hw/acpi/vmgenid.h"
 #include "hw/boards.h"
 #include "hw/intc/intc.h"
@@ -18,6 +19,7 @@
 #include "qobject/qobject.h"
 #include "qapi/qobject-input-visitor.h"
 #include "qapi/type-helpers.h"
+#include "qemu/madvise.h"
 #include "qemu/uuid.h"
 #include "qom/qom-qobject.h"
 #include "system/hostmem.h"
@@ -214,6 +216,44 @@ MemdevList *qmp_query_memdev(Error **errp)
     return list;
 }
 
+static int pageout_ramblock(RAMBlock *rb, void *opaque)
+{
+    Error **errp = opaque;
+    void *host = qemu_ram_get_host_addr(rb);
+
+    if (!host) {
+        return 0;
+    }
+
+    if (qemu_madvise(host, qemu_ram_get_used_length(rb),
+                     QEMU_MADV_PAGEOUT) < 0) {
+        error_setg_errno(errp, errno, "Failed to page out RAM block '%s'",
+                         qemu_ram_get_idstr(rb));
+        return -1;
+    }
+    return 0;
+}
+
+void qmp_x_pageout_ram(Error **errp)
+{
+    if (QEMU_MADV_PAGEOUT == QEMU_MADV_INVALID) {
+        error_setg(errp, "MADV_PAGEOUT is not supported on this host");
+        return;
+    }
+
+    if (runstate_is_running()) {
+        error_setg(errp, "The VM must be stopped to page out its RAM");
+        return;
+    }
+
+    /*
+     * Reclaim is synchronous from the kernel's point of view but does
+     * not touch page contents: pinned pages (e.g. VFIO) are simply
+     * left in place.
+     */
+    qemu_ram_foreach_block(pageout_ramblock, errp);
+}
+
 HumanReadableText *qmp_x_query_numa(Error **errp)
 {
     g_autoptr(GString) buf = g_string_new("");
@@ -24,6 +24,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "system/memory.h"
 #include "system/reset.h"
 #include "hw/resettable.h"
 #include "hw/core/resetcontainer.h"
@@ -172,6 +173,20 @@ void qemu_unregister_resettable(Object *obj)
 
 void qemu_devices_reset(ResetType type)
 {
+    /*
+     * Resetting a large machine toggles many memory regions (PCI BARs
+     * being disabled, chipset mappings going back to their defaults),
+     * and every toggle would rebuild the flatviews of all address
+     * spaces.  Hold a memory transaction across the whole reset so the
+     * topology is rendered once, when the last region has settled.
+     * Memory accesses made by reset handlers themselves (e.g. the ROM
+     * loader repopulating guest RAM) resolve through the pre-reset
+     * topology, which maps such always-present RAM identically.
+     */
+    memory_region_transaction_begin();
+
     /* Reset the simulation */
     resettable_reset(OBJECT(get_root_reset_container()), type);
+
+    memory_region_transaction_commit();
 }
@@ -177,10 +177,29 @@ void virtio_gpu_ctrl_response(VirtIOGPU *g,
                       __func__, s, resp_len);
     }
     virtqueue_push(cmd->vq, &cmd->elem, s);
-    virtio_notify(VIRTIO_DEVICE(g), cmd->vq);
+    if (g->notify_batched) {
+        g->notify_pending = true;
+    } else {
+        virtio_notify(VIRTIO_DEVICE(g), cmd->vq);
+    }
     cmd->finished = true;
 }
 
+/*
+ * Stop coalescing notifications and send the one the batch held back,
+ * if any.  Interrupting the guest once per drained batch rather than
+ * once per completed command matters when the guest pushes hundreds of
+ * transfer/flush commands per frame.
+ */
+static void virtio_gpu_notify_flush(VirtIOGPU *g)
+{
+    g->notify_batched = false;
+    if (g->notify_pending) {
+        g->notify_pending = false;
+        virtio_notify(VIRTIO_DEVICE(g), g->ctrl_vq);
+    }
+}
+
 void virtio_gpu_ctrl_response_nodata(VirtIOGPU *g,
                                      struct virtio_gpu_ctrl_command *cmd,
                                      enum virtio_gpu_ctrl_type type)
@@ -428,6 +447,45 @@ static void virtio_gpu_resource_unref(VirtIOGPU *g,
     virtio_gpu_resource_destroy(g, res, NULL);
 }
 
+/*
+ * Like iov_to_buf(), but for a sequence of reads at monotonically
+ * increasing offsets: the scan resumes from the iov element reached by
+ * the previous call instead of walking the vector from the start.
+ * @iov_idx and @iov_base must be zero-initialized by the caller and
+ * passed unchanged to each subsequent call; @iov_base tracks the
+ * resource offset of iov[@iov_idx].
+ */
+static void iov_to_buf_seq(const struct iovec *iov, unsigned int iov_cnt,
+                           unsigned int *iov_idx, size_t *iov_base,
+                           size_t offset, void *buf, size_t bytes)
+{
+    unsigned int i = *iov_idx;
+    size_t base = *iov_base;
+    size_t done = 0;
+
+    while (i < iov_cnt && offset >= base + iov[i].iov_len) {
+        base += iov[i].iov_len;
+        i++;
+    }
+    *iov_idx = i;
+    *iov_base = base;
+
+    while (done < bytes && i < iov_cnt) {
+        size_t seg_off = offset + done - base;
+        size_t len;
+
+        if (seg_off >= iov[i].iov_len) {
+            base += iov[i].iov_len;
+            i++;
+            continue;
+        }
+        len = MIN(bytes - done, iov[i].iov_len - seg_off);
+        memcpy((uint8_t *)buf + done,
+               (uint8_t *)iov[i].iov_base + seg_off, len);
+        done += len;
+    }
+}
+
 static void virtio_gpu_transfer_to_host_2d(VirtIOGPU *g,
                                            struct virtio_gpu_ctrl_command *cmd)
 {
@@ -468,13 +526,16 @@ static void virtio_gpu_transfer_to_host_2d(VirtIOGPU *g,
     img_data = pixman_image_get_data(res->image);
 
     if (t2d.r.x || t2d.r.width != pixman_image_get_width(res->image)) {
+        unsigned int iov_idx = 0;
+        size_t iov_base = 0;
+
         for (h = 0; h < t2d.r.height; h++) {
             src_offset = t2d.offset + stride * h;
             dst_offset = (t2d.r.y + h) * stride + (t2d.r.x * bpp);
 
-            iov_to_buf(res->iov, res->iov_cnt, src_offset,
-                       (uint8_t *)img_data + dst_offset,
-                       t2d.r.width * bpp);
+            iov_to_buf_seq(res->iov, res->iov_cnt, &iov_idx, &iov_base,
+                           src_offset, (uint8_t *)img_data + dst_offset,
+                           t2d.r.width * bpp);
         }
     } else {
         src_offset = t2d.offset;
@@ -1037,6 +1098,7 @@ void virtio_gpu_process_cmdq(VirtIOGPU *g)
         return;
     }
     g->processing_cmdq = true;
+    g->notify_batched = true;
     while (!QTAILQ_EMPTY(&g->cmdq)) {
         cmd = QTAILQ_FIRST(&g->cmdq);
 
@@ -1071,6 +1133,7 @@ void virtio_gpu_process_cmdq(VirtIOGPU *g)
             g_free(cmd);
         }
     }
+    virtio_gpu_notify_flush(g);
     g->processing_cmdq = false;
 }
 
@@ -1078,6 +1141,7 @@ static void virtio_gpu_process_fenceq(VirtIOGPU *g)
 {
     struct virtio_gpu_ctrl_command *cmd, *tmp;
 
+    g->notify_batched = true;
     QTAILQ_FOREACH_SAFE(cmd, &g->fenceq, next, tmp) {
         trace_virtio_gpu_fence_resp(cmd->cmd_hdr.fence_id);
         virtio_gpu_ctrl_response_nodata(g, cmd, VIRTIO_GPU_RESP_OK_NODATA);
@@ -1088,6 +1152,7 @@ static void virtio_gpu_process_fenceq(VirtIOGPU *g)
             trace_virtio_gpu_dec_inflight_fences(g->inflight);
         }
     }
+    virtio_gpu_notify_flush(g);
 }
 
 static void virtio_gpu_handle_gl_flushed(VirtIOGPUBase *b)
@@ -1593,6 +1658,9 @@ void virtio_gpu_reset(VirtIODevice *vdev)
         g_free(cmd);
     }
 
+    g->notify_batched = false;
+    g->notify_pending = false;
+
     virtio_gpu_base_reset(VIRTIO_GPU_BASE(vdev));
 }
 
@@ -428,9 +428,17 @@ static void vtd_update_iotlb(IntelIOMMUState *s, uint16_t source_id,
     uint64_t gfn = vtd_get_iotlb_gfn(addr, level);
 
     trace_vtd_iotlb_page_update(source_id, addr, pte, domain_id);
-    if (g_hash_table_size(s->iotlb) >= VTD_IOTLB_MAX_SIZE) {
+    if (g_hash_table_size(s->iotlb) >= s->iotlb_max_size) {
         trace_vtd_iotlb_reset("iotlb exceeds size limit");
         vtd_reset_iotlb_locked(s);
+        /*
+         * The reset was triggered by insertion pressure, not by an
+         * invalidation, so the guest's working set does not fit.  Grow
+         * the limit so a hot working set stops thrashing the cache.
+         */
+        if (s->iotlb_max_size < VTD_IOTLB_ADAPTIVE_MAX) {
+            s->iotlb_max_size *= 2;
+        }
     }
 
     entry->gfn = gfn;
@@ -2768,27 +2776,43 @@ static void vtd_handle_iotlb_write(IntelIOMMUState *s)
     }
 }
 
-/* Fetch an Invalidation Descriptor from the Invalidation Queue */
-static bool vtd_get_inv_desc(IntelIOMMUState *s,
-                             VTDInvDesc *inv_desc)
+/*
+ * Fetch a batch of contiguous Invalidation Descriptors from the
+ * Invalidation Queue, starting at iq_head.  The batch stops at the end
+ * of the ring; the caller loops around the wrap.  Returns the number of
+ * descriptors fetched, 0 on DMA error.
+ */
+static uint32_t vtd_get_inv_desc_batch(IntelIOMMUState *s,
+                                       VTDInvDesc *descs, uint32_t max)
 {
-    dma_addr_t base_addr = s->iq;
-    uint32_t offset = s->iq_head;
     uint32_t dw = s->iq_dw ? 32 : 16;
-    dma_addr_t addr = base_addr + offset * dw;
+    uint8_t buf[VTD_INV_DESC_BATCH * 32];
+    dma_addr_t addr = s->iq + (dma_addr_t)s->iq_head * dw;
+    uint32_t count, i;
 
-    if (dma_memory_read(&address_space_memory, addr,
-                        inv_desc, dw, MEMTXATTRS_UNSPECIFIED)) {
+    assert(max <= VTD_INV_DESC_BATCH);
+    count = (s->iq_tail > s->iq_head ? s->iq_tail : s->iq_size) - s->iq_head;
+    count = MIN(count, max);
+
+    if (dma_memory_read(&address_space_memory, addr, buf, count * dw,
+                        MEMTXATTRS_UNSPECIFIED)) {
         error_report_once("Read INV DESC failed.");
-        return false;
+        return 0;
     }
-    inv_desc->lo = le64_to_cpu(inv_desc->lo);
-    inv_desc->hi = le64_to_cpu(inv_desc->hi);
-    if (dw == 32) {
-        inv_desc->val[2] = le64_to_cpu(inv_desc->val[2]);
-        inv_desc->val[3] = le64_to_cpu(inv_desc->val[3]);
+    for (i = 0; i < count; i++) {
+        const uint8_t *raw = buf + i * dw;
+
+        descs[i].lo = ldq_le_p(raw);
+        descs[i].hi = ldq_le_p(raw + 8);
+        if (dw == 32) {
+            descs[i].val[2] = ldq_le_p(raw + 16);
+            descs[i].val[3] = ldq_le_p(raw + 24);
+        } else {
+            descs[i].val[2] = 0;
+            descs[i].val[3] = 0;
+        }
     }
-    return true;
+    return count;
 }
 
 static bool vtd_inv_desc_reserved_check(IntelIOMMUState *s,
@@ -3179,67 +3203,62 @@ done:
     return true;
 }
 
-static bool vtd_process_inv_desc(IntelIOMMUState *s)
+static bool vtd_process_inv_desc(IntelIOMMUState *s, VTDInvDesc *inv_desc)
 {
-    VTDInvDesc inv_desc;
     uint8_t desc_type;
 
     trace_vtd_inv_qi_head(s->iq_head);
-    if (!vtd_get_inv_desc(s, &inv_desc)) {
-        s->iq_last_desc_type = VTD_INV_DESC_NONE;
-        return false;
-    }
 
-    desc_type = VTD_INV_DESC_TYPE(inv_desc.lo);
+    desc_type = VTD_INV_DESC_TYPE(inv_desc->lo);
     /* FIXME: should update at first or at last? */
     s->iq_last_desc_type = desc_type;
 
     switch (desc_type) {
     case VTD_INV_DESC_CC:
-        trace_vtd_inv_desc("context-cache", inv_desc.hi, inv_desc.lo);
-        if (!vtd_process_context_cache_desc(s, &inv_desc)) {
+        trace_vtd_inv_desc("context-cache", inv_desc->hi, inv_desc->lo);
+        if (!vtd_process_context_cache_desc(s, inv_desc)) {
             return false;
         }
         break;
 
     case VTD_INV_DESC_IOTLB:
-        trace_vtd_inv_desc("iotlb", inv_desc.hi, inv_desc.lo);
-        if (!vtd_process_iotlb_desc(s, &inv_desc)) {
+        trace_vtd_inv_desc("iotlb", inv_desc->hi, inv_desc->lo);
+        if (!vtd_process_iotlb_desc(s, inv_desc)) {
             return false;
         }
         break;
 
     case VTD_INV_DESC_PIOTLB:
-        trace_vtd_inv_desc("p-iotlb", inv_desc.val[1], inv_desc.val[0]);
-        if (!vtd_process_piotlb_desc(s, &inv_desc)) {
+        trace_vtd_inv_desc("p-iotlb", inv_desc->val[1], inv_desc->val[0]);
+        if (!vtd_process_piotlb_desc(s, inv_desc)) {
             return false;
         }
         break;
 
     case VTD_INV_DESC_WAIT:
-        trace_vtd_inv_desc("wait", inv_desc.hi, inv_desc.lo);
-        if (!vtd_process_wait_desc(s, &inv_desc)) {
+        trace_vtd_inv_desc("wait", inv_desc->hi, inv_desc->lo);
+        if (!vtd_process_wait_desc(s, inv_desc)) {
             return false;
         }
         break;
 
     case VTD_INV_DESC_IEC:
-        trace_vtd_inv_desc("iec", inv_desc.hi, inv_desc.lo);
-        if (!vtd_process_inv_iec_desc(s, &inv_desc)) {
+        trace_vtd_inv_desc("iec", inv_desc->hi, inv_desc->lo);
+        if (!vtd_process_inv_iec_desc(s, inv_desc)) {
             return false;
         }
         break;
 
     case VTD_INV_DESC_DEV_PIOTLB:
-        trace_vtd_inv_desc("device-piotlb", inv_desc.hi, inv_desc.lo);
-        if (!vtd_process_device_piotlb_desc(s, &inv_desc)) {
+        trace_vtd_inv_desc("device-piotlb", inv_desc->hi, inv_desc->lo);
+        if (!vtd_process_device_piotlb_desc(s, inv_desc)) {
             return false;
         }
         break;
 
     case VTD_INV_DESC_DEVICE:
-        trace_vtd_inv_desc("device", inv_desc.hi, inv_desc.lo);
-        if (!vtd_process_device_iotlb_desc(s, &inv_desc)) {
+        trace_vtd_inv_desc("device", inv_desc->hi, inv_desc->lo);
+        if (!vtd_process_device_iotlb_desc(s, inv_desc)) {
             return false;
         }
         break;
@@ -3256,8 +3275,8 @@ static bool vtd_process_inv_desc(IntelIOMMUState *s)
     /* fallthrough */
     default:
         error_report_once("%s: invalid inv desc: hi=%"PRIx64", lo=%"PRIx64
-                          " (unknown type)", __func__, inv_desc.hi,
-                          inv_desc.lo);
+                          " (unknown type)", __func__, inv_desc->hi,
+                          inv_desc->lo);
         return false;
     }
     s->iq_head++;
@@ -3286,15 +3305,26 @@ static void vtd_fetch_inv_desc(IntelIOMMUState *s)
         return;
     }
     while (s->iq_head != s->iq_tail) {
-        if (!vtd_process_inv_desc(s)) {
-            /* Invalidation Queue Errors */
+        VTDInvDesc descs[VTD_INV_DESC_BATCH];
+        uint32_t count, i;
+
+        count = vtd_get_inv_desc_batch(s, descs, VTD_INV_DESC_BATCH);
+        if (!count) {
+            s->iq_last_desc_type = VTD_INV_DESC_NONE;
             vtd_handle_inv_queue_error(s);
-            break;
+            return;
+        }
+        for (i = 0; i < count; i++) {
+            if (!vtd_process_inv_desc(s, &descs[i])) {
+                /* Invalidation Queue Errors */
+                vtd_handle_inv_queue_error(s);
+                return;
+            }
+            /* Must update the IQH_REG in time */
+            vtd_set_quad_raw(s, DMAR_IQH_REG,
+                             (((uint64_t)(s->iq_head)) << qi_shift) &
+                             VTD_IQH_QH_MASK);
         }
-        /* Must update the IQH_REG in time */
-        vtd_set_quad_raw(s, DMAR_IQH_REG,
-                         (((uint64_t)(s->iq_head)) << qi_shift) &
-                         VTD_IQH_QH_MASK);
     }
 }
 
@@ -4599,6 +4629,7 @@ static void vtd_init(IntelIOMMUState *s)
     s->iq_tail = 0;
     s->iq = 0;
     s->iq_size = 0;
+    s->iotlb_max_size = VTD_IOTLB_MAX_SIZE;
     s->qi_enabled = false;
     s->iq_last_desc_type = VTD_INV_DESC_NONE;
     s->iq_dw = false;
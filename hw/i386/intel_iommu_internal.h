@@ -117,7 +117,9 @@
 #define VTD_IOTLB_SID_SHIFT         26
 #define VTD_IOTLB_LVL_SHIFT         42
 #define VTD_IOTLB_PASID_SHIFT       44
-#define VTD_IOTLB_MAX_SIZE          1024    /* Max size of the hash table */
+#define VTD_IOTLB_MAX_SIZE          1024    /* Initial size of the hash table */
+/* Upper bound for the adaptively grown IOTLB size limit */
+#define VTD_IOTLB_ADAPTIVE_MAX      (16 * VTD_IOTLB_MAX_SIZE)
 
 /* IOTLB_REG */
 #define VTD_TLB_GLOBAL_FLUSH        (1ULL << 60) /* Global invalidation */
@@ -375,6 +377,9 @@ union VTDInvDesc {
 };
 typedef union VTDInvDesc VTDInvDesc;
 
+/* Max number of Invalidation Descriptors fetched from the queue at once */
+#define VTD_INV_DESC_BATCH              32
+
 /* Masks for struct VTDInvDesc */
 #define VTD_INV_DESC_ALL_ONE            -1ULL
 #define VTD_INV_DESC_TYPE(val)          ((((val) >> 5) & 0x70ULL) | \
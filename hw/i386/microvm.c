@@ -377,7 +377,7 @@ static void microvm_fix_kernel_cmdline(MachineState *machine)
     MicrovmMachineState *mms = MICROVM_MACHINE(machine);
     BusState *bus;
     BusChild *kid;
-    char *cmdline;
+    GString *cmdline;
 
     /*
      * Find MMIO transports with attached devices, and add them to the kernel
@@ -386,7 +386,7 @@ static void microvm_fix_kernel_cmdline(MachineState *machine)
      * Yes, this is a hack, but one that heavily improves the UX without
      * introducing any significant issues.
      */
-    cmdline = g_strdup(machine->kernel_cmdline);
+    cmdline = g_string_new(machine->kernel_cmdline);
     bus = sysbus_get_default();
     QTAILQ_FOREACH(kid, &bus->children, sibling) {
         DeviceState *dev = kid->child;
@@ -400,19 +400,17 @@ static void microvm_fix_kernel_cmdline(MachineState *machine)
                 gchar *mmio_cmdline = microvm_get_mmio_cmdline
                     (mmio_bus->name, mms->virtio_irq_base);
                 if (mmio_cmdline) {
-                    char *newcmd = g_strjoin(NULL, cmdline, mmio_cmdline, NULL);
+                    g_string_append(cmdline, mmio_cmdline);
                     g_free(mmio_cmdline);
-                    g_free(cmdline);
-                    cmdline = newcmd;
                 }
             }
         }
     }
 
-    fw_cfg_modify_i32(x86ms->fw_cfg, FW_CFG_CMDLINE_SIZE, strlen(cmdline) + 1);
-    fw_cfg_modify_string(x86ms->fw_cfg, FW_CFG_CMDLINE_DATA, cmdline);
+    fw_cfg_modify_i32(x86ms->fw_cfg, FW_CFG_CMDLINE_SIZE, cmdline->len + 1);
+    fw_cfg_modify_string(x86ms->fw_cfg, FW_CFG_CMDLINE_DATA, cmdline->str);
 
-    g_free(cmdline);
+    g_string_free(cmdline, true);
 }
 
 static void microvm_device_pre_plug_cb(HotplugHandler *hotplug_dev,
@@ -407,6 +407,69 @@ static void build_dvsecs(CXLType3Dev *ct3d)
                                PCIE_CXL3_FLEXBUS_PORT_DVSEC_REVID, dvsec);
 }
 
+/*
+ * Parse the HDM decoder registers into ct3d->hdm_cache so that
+ * cxl_type3_dpa() does not have to re-decode them on every access.
+ * Decoders commit in order, so parsing stops at the first uncommitted
+ * one; everything after it is marked uncommitted in the cache too.
+ */
+static void hdm_decoder_cache_update(CXLType3Dev *ct3d)
+{
+    int hdm_inc = R_CXL_HDM_DECODER1_BASE_LO - R_CXL_HDM_DECODER0_BASE_LO;
+    uint32_t *cache_mem = ct3d->cxl_cstate.crb.cache_mem_registers;
+    unsigned int hdm_count;
+    uint64_t dpa_base = 0;
+    uint32_t cap;
+    int i;
+
+    cap = ldl_le_p(cache_mem + R_CXL_HDM_DECODER_CAPABILITY);
+    hdm_count = cxl_decoder_count_dec(FIELD_EX32(cap,
+                                                 CXL_HDM_DECODER_CAPABILITY,
+                                                 DECODER_COUNT));
+    assert(hdm_count <= CXL_HDM_DECODER_COUNT);
+
+    memset(ct3d->hdm_cache, 0, sizeof(ct3d->hdm_cache));
+
+    for (i = 0; i < hdm_count; i++) {
+        struct CXLHDMDecoderCache *d = &ct3d->hdm_cache[i];
+        uint32_t hdm_ctrl, low, high;
+        uint64_t skip;
+        int decoded_iw;
+
+        hdm_ctrl = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_CTRL + i * hdm_inc);
+        if (!FIELD_EX32(hdm_ctrl, CXL_HDM_DECODER0_CTRL, COMMITTED)) {
+            break;
+        }
+
+        low = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_BASE_LO + i * hdm_inc);
+        high = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_BASE_HI + i * hdm_inc);
+        d->base = ((uint64_t)high << 32) | (low & 0xf0000000);
+
+        low = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_SIZE_LO + i * hdm_inc);
+        high = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_SIZE_HI + i * hdm_inc);
+        d->size = ((uint64_t)high << 32) | (low & 0xf0000000);
+
+        low = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_DPA_SKIP_LO +
+                       i * hdm_inc);
+        high = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_DPA_SKIP_HI +
+                        i * hdm_inc);
+        skip = ((uint64_t)high << 32) | (low & 0xf0000000);
+        dpa_base += skip;
+
+        d->iw = FIELD_EX32(hdm_ctrl, CXL_HDM_DECODER0_CTRL, IW);
+        d->ig = FIELD_EX32(hdm_ctrl, CXL_HDM_DECODER0_CTRL, IG);
+        d->dpa_base = dpa_base;
+
+        decoded_iw = cxl_interleave_ways_dec(d->iw, &error_fatal);
+        if (decoded_iw == 0) {
+            break;
+        }
+        dpa_base += d->size / decoded_iw;
+
+        d->committed = true;
+    }
+}
+
 static void hdm_decoder_commit(CXLType3Dev *ct3d, int which)
 {
     int hdm_inc = R_CXL_HDM_DECODER1_BASE_LO - R_CXL_HDM_DECODER0_BASE_LO;
@@ -420,6 +483,8 @@ static void hdm_decoder_commit(CXLType3Dev *ct3d, int which)
     ctrl = FIELD_DP32(ctrl, CXL_HDM_DECODER0_CTRL, COMMITTED, 1);
 
     stl_le_p(cache_mem + R_CXL_HDM_DECODER0_CTRL + which * hdm_inc, ctrl);
+
+    hdm_decoder_cache_update(ct3d);
 }
 
 static void hdm_decoder_uncommit(CXLType3Dev *ct3d, int which)
@@ -435,6 +500,8 @@ static void hdm_decoder_uncommit(CXLType3Dev *ct3d, int which)
     ctrl = FIELD_DP32(ctrl, CXL_HDM_DECODER0_CTRL, COMMITTED, 0);
 
     stl_le_p(cache_mem + R_CXL_HDM_DECODER0_CTRL + which * hdm_inc, ctrl);
+
+    hdm_decoder_cache_update(ct3d);
 }
 
 static int ct3d_qmp_uncor_err_to_cxl(CxlUncorErrorType qmp_err)
@@ -1048,65 +1115,30 @@ void ct3_clear_region_block_backed(CXLType3Dev *ct3d, uint64_t dpa,
 
 static bool cxl_type3_dpa(CXLType3Dev *ct3d, hwaddr host_addr, uint64_t *dpa)
 {
-    int hdm_inc = R_CXL_HDM_DECODER1_BASE_LO - R_CXL_HDM_DECODER0_BASE_LO;
-    uint32_t *cache_mem = ct3d->cxl_cstate.crb.cache_mem_registers;
-    unsigned int hdm_count;
-    uint32_t cap;
-    uint64_t dpa_base = 0;
     int i;
 
-    cap = ldl_le_p(cache_mem + R_CXL_HDM_DECODER_CAPABILITY);
-    hdm_count = cxl_decoder_count_dec(FIELD_EX32(cap,
-                                                 CXL_HDM_DECODER_CAPABILITY,
-                                                 DECODER_COUNT));
-
-    for (i = 0; i < hdm_count; i++) {
-        uint64_t decoder_base, decoder_size, hpa_offset, skip;
-        uint32_t hdm_ctrl, low, high;
-        int ig, iw;
+    for (i = 0; i < CXL_HDM_DECODER_COUNT; i++) {
+        const struct CXLHDMDecoderCache *d = &ct3d->hdm_cache[i];
+        uint64_t hpa_offset;
+        int ig = d->ig;
+        int iw = d->iw;
 
-        low = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_BASE_LO + i * hdm_inc);
-        high = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_BASE_HI + i * hdm_inc);
-        decoder_base = ((uint64_t)high << 32) | (low & 0xf0000000);
-
-        low = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_SIZE_LO + i * hdm_inc);
-        high = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_SIZE_HI + i * hdm_inc);
-        decoder_size = ((uint64_t)high << 32) | (low & 0xf0000000);
-
-        low = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_DPA_SKIP_LO +
-                       i * hdm_inc);
-        high = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_DPA_SKIP_HI +
-                        i * hdm_inc);
-        skip = ((uint64_t)high << 32) | (low & 0xf0000000);
-        dpa_base += skip;
-
-        hpa_offset = (uint64_t)host_addr - decoder_base;
-
-        hdm_ctrl = ldl_le_p(cache_mem + R_CXL_HDM_DECODER0_CTRL + i * hdm_inc);
-        iw = FIELD_EX32(hdm_ctrl, CXL_HDM_DECODER0_CTRL, IW);
-        ig = FIELD_EX32(hdm_ctrl, CXL_HDM_DECODER0_CTRL, IG);
-        if (!FIELD_EX32(hdm_ctrl, CXL_HDM_DECODER0_CTRL, COMMITTED)) {
+        if (!d->committed) {
             return false;
         }
-        if (((uint64_t)host_addr < decoder_base) ||
-            (hpa_offset >= decoder_size)) {
-            int decoded_iw = cxl_interleave_ways_dec(iw, &error_fatal);
-
-            if (decoded_iw == 0) {
-                return false;
-            }
 
-            dpa_base += decoder_size / decoded_iw;
+        hpa_offset = (uint64_t)host_addr - d->base;
+        if (((uint64_t)host_addr < d->base) || (hpa_offset >= d->size)) {
             continue;
         }
 
         if (iw < 8) {
-            *dpa = dpa_base +
+            *dpa = d->dpa_base +
                 ((MAKE_64BIT_MASK(0, 8 + ig) & hpa_offset) |
                  ((MAKE_64BIT_MASK(8 + ig + iw, 64 - 8 - ig - iw) & hpa_offset)
                   >> iw));
         } else {
-            *dpa = dpa_base +
+            *dpa = d->dpa_base +
                 ((MAKE_64BIT_MASK(0, 8 + ig) & hpa_offset) |
                  ((((MAKE_64BIT_MASK(ig + iw, 64 - ig - iw) & hpa_offset)
                    >> (ig + iw)) / 3) << (ig + 8)));
@@ -1220,6 +1252,7 @@ static void ct3d_reset(DeviceState *dev)
     pcie_cap_fill_link_ep_usp(PCI_DEVICE(dev), ct3d->width, ct3d->speed);
     cxl_component_register_init_common(reg_state, write_msk, CXL2_TYPE3_DEVICE);
     cxl_device_register_init_t3(ct3d, CXL_T3_MSIX_MBOX);
+    hdm_decoder_cache_update(ct3d);
 
     /*
      * Bring up an endpoint to target with MCTP over VDM.
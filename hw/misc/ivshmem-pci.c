@@ -21,6 +21,7 @@
 #include "qemu/units.h"
 #include "qapi/error.h"
 #include "qemu/cutils.h"
+#include "qemu/host-utils.h"
 #include "hw/pci/pci.h"
 #include "hw/qdev-properties.h"
 #include "hw/qdev-properties-system.h"
@@ -125,6 +126,7 @@ enum ivshmem_registers {
     INTRSTATUS = 4,
     IVPOSITION = 8,
     DOORBELL = 12,
+    DOORBELL_BATCH = 16,
 };
 
 static inline uint32_t ivshmem_has_feature(IVShmemState *ivs,
@@ -206,6 +208,27 @@ static void ivshmem_io_write(void *opaque, hwaddr addr,
                                 vector, dest);
             }
             break;
+
+        case DOORBELL_BATCH:
+            /*
+             * One write kicks every vector of the peer whose bit is set
+             * in the low 16 bits, saving an MMIO exit per doorbell for
+             * guests that post work on several queues before kicking.
+             */
+            if (dest >= s->nb_peers) {
+                IVSHMEM_DPRINTF("Invalid destination VM ID (%d)\n", dest);
+                break;
+            }
+
+            for (uint32_t mask = val & 0xffff; mask; mask &= mask - 1) {
+                int v = ctz32(mask);
+
+                if (v < s->peers[dest].nb_eventfds) {
+                    IVSHMEM_DPRINTF("Notifying VM %d on vector %d\n", dest, v);
+                    event_notifier_set(&s->peers[dest].eventfds[v]);
+                }
+            }
+            break;
         default:
             IVSHMEM_DPRINTF("Unhandled write " HWADDR_FMT_plx "\n", addr);
     }
@@ -232,6 +255,11 @@ static uint64_t ivshmem_io_read(void *opaque, hwaddr addr,
             ret = s->vm_id;
             break;
 
+        case DOORBELL_BATCH:
+            /* Probe point: reserved offsets read as 0 on older devices */
+            ret = 1;
+            break;
+
         default:
             IVSHMEM_DPRINTF("why are we reading " HWADDR_FMT_plx "\n", addr);
             ret = 0;
@@ -1320,53 +1320,108 @@ struct NetRxPkt *pkt, const E1000E_RSSInfo *rss_info,
     }
 }
 
-static inline void
-e1000e_pci_dma_write_rx_desc(E1000ECore *core, dma_addr_t addr,
-                             union e1000_rx_desc_union *desc, dma_addr_t len)
+#define E1000E_RX_DESC_WB_BATCH (32)
+
+typedef struct E1000ERxDescWbState {
+    dma_addr_t base;    /* guest address of the first descriptor in the run */
+    uint32_t count;
+    uint32_t status[E1000E_RX_DESC_WB_BATCH];
+    uint8_t buf[E1000E_RX_DESC_WB_BATCH * sizeof(union e1000_rx_desc_union)];
+} E1000ERxDescWbState;
+
+static uint32_t
+e1000e_rx_desc_take_status(E1000ECore *core, union e1000_rx_desc_union *desc)
+{
+    if (e1000e_rx_use_legacy_descriptor(core)) {
+        uint8_t status = desc->legacy.status;
+
+        desc->legacy.status &= ~E1000_RXD_STAT_DD;
+        return status;
+    } else if (core->mac[RCTL] & E1000_RCTL_DTYP_PS) {
+        uint32_t status = desc->packet_split.wb.middle.status_error;
+
+        desc->packet_split.wb.middle.status_error &= ~E1000_RXD_STAT_DD;
+        return status;
+    } else {
+        uint32_t status = desc->extended.wb.upper.status_error;
+
+        desc->extended.wb.upper.status_error &= ~E1000_RXD_STAT_DD;
+        return status;
+    }
+}
+
+static void
+e1000e_rx_descr_wb_flush(E1000ECore *core, E1000ERxDescWbState *wb)
 {
     PCIDevice *dev = core->owner;
+    size_t status_offset;
+    size_t status_size;
+    uint32_t i;
+
+    if (!wb->count) {
+        return;
+    }
 
     if (e1000e_rx_use_legacy_descriptor(core)) {
-        struct e1000_rx_desc *d = &desc->legacy;
-        size_t offset = offsetof(struct e1000_rx_desc, status);
-        uint8_t status = d->status;
+        status_offset = offsetof(struct e1000_rx_desc, status);
+        status_size = sizeof(uint8_t);
+    } else if (core->mac[RCTL] & E1000_RCTL_DTYP_PS) {
+        status_offset = offsetof(union e1000_rx_desc_packet_split,
+                                 wb.middle.status_error);
+        status_size = sizeof(uint32_t);
+    } else {
+        status_offset = offsetof(union e1000_rx_desc_extended,
+                                 wb.upper.status_error);
+        status_size = sizeof(uint32_t);
+    }
 
-        d->status &= ~E1000_RXD_STAT_DD;
-        pci_dma_write(dev, addr, desc, len);
+    /*
+     * Write all descriptor bodies of the run in a single transfer with
+     * DD still clear, then raise DD per descriptor with a small status
+     * write so the guest never observes DD ahead of the rest of the
+     * descriptor it covers.
+     */
+    trace_e1000e_rx_descr_wb(wb->base, wb->count);
+    pci_dma_write(dev, wb->base, wb->buf, wb->count * core->rx_desc_len);
+
+    for (i = 0; i < wb->count; i++) {
+        dma_addr_t addr = wb->base + i * core->rx_desc_len + status_offset;
 
-        if (status & E1000_RXD_STAT_DD) {
-            d->status = status;
-            pci_dma_write(dev, addr + offset, &status, sizeof(status));
+        if (!(wb->status[i] & E1000_RXD_STAT_DD)) {
+            continue;
         }
-    } else {
-        if (core->mac[RCTL] & E1000_RCTL_DTYP_PS) {
-            union e1000_rx_desc_packet_split *d = &desc->packet_split;
-            size_t offset = offsetof(union e1000_rx_desc_packet_split,
-                wb.middle.status_error);
-            uint32_t status = d->wb.middle.status_error;
 
-            d->wb.middle.status_error &= ~E1000_RXD_STAT_DD;
-            pci_dma_write(dev, addr, desc, len);
+        if (status_size == sizeof(uint8_t)) {
+            uint8_t status = wb->status[i];
 
-            if (status & E1000_RXD_STAT_DD) {
-                d->wb.middle.status_error = status;
-                pci_dma_write(dev, addr + offset, &status, sizeof(status));
-            }
+            pci_dma_write(dev, addr, &status, sizeof(status));
         } else {
-            union e1000_rx_desc_extended *d = &desc->extended;
-            size_t offset = offsetof(union e1000_rx_desc_extended,
-                wb.upper.status_error);
-            uint32_t status = d->wb.upper.status_error;
-
-            d->wb.upper.status_error &= ~E1000_RXD_STAT_DD;
-            pci_dma_write(dev, addr, desc, len);
+            uint32_t status = wb->status[i];
 
-            if (status & E1000_RXD_STAT_DD) {
-                d->wb.upper.status_error = status;
-                pci_dma_write(dev, addr + offset, &status, sizeof(status));
-            }
+            pci_dma_write(dev, addr, &status, sizeof(status));
         }
     }
+
+    wb->count = 0;
+}
+
+static void
+e1000e_rx_descr_wb_queue(E1000ECore *core, E1000ERxDescWbState *wb,
+                         dma_addr_t addr, union e1000_rx_desc_union *desc)
+{
+    /* A ring wrap or a full batch ends the contiguous run */
+    if (wb->count == E1000E_RX_DESC_WB_BATCH ||
+        (wb->count && addr != wb->base + wb->count * core->rx_desc_len)) {
+        e1000e_rx_descr_wb_flush(core, wb);
+    }
+
+    if (!wb->count) {
+        wb->base = addr;
+    }
+
+    wb->status[wb->count] = e1000e_rx_desc_take_status(core, desc);
+    memcpy(&wb->buf[wb->count * core->rx_desc_len], desc, core->rx_desc_len);
+    wb->count++;
 }
 
 typedef struct E1000EBAState {
@@ -1498,6 +1553,8 @@ e1000e_write_packet_to_guest(E1000ECore *core, struct NetRxPkt *pkt,
     bool do_ps = e1000e_do_ps(core, pkt, &ps_hdr_len);
     bool is_first = true;
 
+    E1000ERxDescWbState wb = { 0 };
+
     rxi = rxr->i;
 
     do {
@@ -1512,6 +1569,7 @@ e1000e_write_packet_to_guest(E1000ECore *core, struct NetRxPkt *pkt,
         }
 
         if (e1000e_ring_empty(core, rxi)) {
+            e1000e_rx_descr_wb_flush(core, &wb);
             return;
         }
 
@@ -1597,13 +1655,15 @@ e1000e_write_packet_to_guest(E1000ECore *core, struct NetRxPkt *pkt,
 
         e1000e_write_rx_descr(core, &desc, is_last ? core->rx_pkt : NULL,
                            rss_info, do_ps ? ps_hdr_len : 0, &bastate.written);
-        e1000e_pci_dma_write_rx_desc(core, base, &desc, core->rx_desc_len);
+        e1000e_rx_descr_wb_queue(core, &wb, base, &desc);
 
         e1000e_ring_advance(core, rxi,
                             core->rx_desc_len / E1000_MIN_RX_DESC_LEN);
 
     } while (desc_offset < total_size);
 
+    e1000e_rx_descr_wb_flush(core, &wb);
+
     e1000e_update_rx_stats(core, size, total_size);
 }
 
@@ -2783,7 +2843,22 @@ e1000e_set_itr(E1000ECore *core, int index, uint32_t val)
     trace_e1000e_irq_itr_set(val);
 
     core->itr_guest_value = interval;
-    core->mac[index] = MAX(interval, E1000E_MIN_XITR);
+    core->mac[index] = interval ? MAX(interval, E1000E_MIN_XITR) : 0;
+
+    /*
+     * Writing ITR restarts the interval countdown, so apply the new
+     * value to a running throttling window instead of waiting for the
+     * next rearm.  Otherwise adaptive moderation in the guest driver
+     * keeps being paced by a stale interval.
+     */
+    if (core->itr.running) {
+        e1000e_intrmgr_stop_timer(&core->itr);
+        if (core->mac[index]) {
+            e1000e_intrmgr_rearm_timer(&core->itr);
+        } else {
+            e1000e_intrmgr_on_throttling_timer(&core->itr);
+        }
+    }
 }
 
 static void
@@ -2795,7 +2870,17 @@ e1000e_set_eitr(E1000ECore *core, int index, uint32_t val)
     trace_e1000e_irq_eitr_set(eitr_num, val);
 
     core->eitr_guest_value[eitr_num] = interval;
-    core->mac[index] = MAX(interval, E1000E_MIN_XITR);
+    core->mac[index] = interval ? MAX(interval, E1000E_MIN_XITR) : 0;
+
+    /* As for ITR, restart a running throttling window with the new value */
+    if (core->eitr[eitr_num].running) {
+        e1000e_intrmgr_stop_timer(&core->eitr[eitr_num]);
+        if (core->mac[index]) {
+            e1000e_intrmgr_rearm_timer(&core->eitr[eitr_num]);
+        } else {
+            e1000e_intrmgr_on_msix_throttling_timer(&core->eitr[eitr_num]);
+        }
+    }
 }
 
 static void
@@ -1588,36 +1588,98 @@ igb_write_rx_descr(IGBCore *core,
     }
 }
 
-static inline void
-igb_pci_dma_write_rx_desc(IGBCore *core, PCIDevice *dev, dma_addr_t addr,
-                          union e1000_rx_desc_union *desc, dma_addr_t len)
+#define IGB_RX_DESC_WB_BATCH (32)
+
+typedef struct IGBRxDescWbState {
+    dma_addr_t base;    /* guest address of the first descriptor in the run */
+    uint32_t count;
+    uint32_t status[IGB_RX_DESC_WB_BATCH];
+    uint8_t buf[IGB_RX_DESC_WB_BATCH * sizeof(union e1000_rx_desc_union)];
+} IGBRxDescWbState;
+
+static uint32_t
+igb_rx_desc_take_status(IGBCore *core, union e1000_rx_desc_union *desc)
 {
     if (igb_rx_use_legacy_descriptor(core)) {
-        struct e1000_rx_desc *d = &desc->legacy;
-        size_t offset = offsetof(struct e1000_rx_desc, status);
-        uint8_t status = d->status;
+        uint8_t status = desc->legacy.status;
 
-        d->status &= ~E1000_RXD_STAT_DD;
-        pci_dma_write(dev, addr, desc, len);
+        desc->legacy.status &= ~E1000_RXD_STAT_DD;
+        return status;
+    } else {
+        uint32_t status = desc->adv.wb.upper.status_error;
 
-        if (status & E1000_RXD_STAT_DD) {
-            d->status = status;
-            pci_dma_write(dev, addr + offset, &status, sizeof(status));
-        }
+        desc->adv.wb.upper.status_error &= ~E1000_RXD_STAT_DD;
+        return status;
+    }
+}
+
+static void
+igb_rx_descr_wb_flush(IGBCore *core, PCIDevice *dev, IGBRxDescWbState *wb)
+{
+    size_t status_offset;
+    size_t status_size;
+    uint32_t i;
+
+    if (!wb->count) {
+        return;
+    }
+
+    if (igb_rx_use_legacy_descriptor(core)) {
+        status_offset = offsetof(struct e1000_rx_desc, status);
+        status_size = sizeof(uint8_t);
     } else {
-        union e1000_adv_rx_desc *d = &desc->adv;
-        size_t offset =
-            offsetof(union e1000_adv_rx_desc, wb.upper.status_error);
-        uint32_t status = d->wb.upper.status_error;
+        status_offset = offsetof(union e1000_adv_rx_desc,
+                                 wb.upper.status_error);
+        status_size = sizeof(uint32_t);
+    }
 
-        d->wb.upper.status_error &= ~E1000_RXD_STAT_DD;
-        pci_dma_write(dev, addr, desc, len);
+    /*
+     * Write all descriptor bodies of the run in a single transfer with
+     * DD still clear, then raise DD per descriptor with a small status
+     * write so the guest never observes DD ahead of the rest of the
+     * descriptor it covers.
+     */
+    trace_e1000e_rx_descr_wb(wb->base, wb->count);
+    pci_dma_write(dev, wb->base, wb->buf, wb->count * core->rx_desc_len);
+
+    for (i = 0; i < wb->count; i++) {
+        dma_addr_t addr = wb->base + i * core->rx_desc_len + status_offset;
 
-        if (status & E1000_RXD_STAT_DD) {
-            d->wb.upper.status_error = status;
-            pci_dma_write(dev, addr + offset, &status, sizeof(status));
+        if (!(wb->status[i] & E1000_RXD_STAT_DD)) {
+            continue;
+        }
+
+        if (status_size == sizeof(uint8_t)) {
+            uint8_t status = wb->status[i];
+
+            pci_dma_write(dev, addr, &status, sizeof(status));
+        } else {
+            uint32_t status = wb->status[i];
+
+            pci_dma_write(dev, addr, &status, sizeof(status));
         }
     }
+
+    wb->count = 0;
+}
+
+static void
+igb_rx_descr_wb_queue(IGBCore *core, PCIDevice *dev, IGBRxDescWbState *wb,
+                      dma_addr_t addr, union e1000_rx_desc_union *desc)
+{
+    /* A ring wrap or a full batch ends the contiguous run */
+    if (wb->count == IGB_RX_DESC_WB_BATCH ||
+        (wb->count && addr != wb->base + wb->count * core->rx_desc_len)) {
+        igb_rx_descr_wb_flush(core, dev, wb);
+    }
+
+    if (!wb->count) {
+        wb->base = addr;
+    }
+
+    wb->status[wb->count] = igb_rx_desc_take_status(core, desc);
+    memcpy(&wb->buf[wb->count * core->rx_desc_len], desc, core->rx_desc_len);
+    wb->count++;
 }
 
 static void
@@ -1918,11 +1980,14 @@ igb_write_packet_to_guest(IGBCore *core, struct NetRxPkt *pkt,
 
     pdma_st.do_ps = igb_do_ps(core, rxi, pkt, &pdma_st);
 
+    IGBRxDescWbState wb = { 0 };
+
     do {
         memset(&pdma_st.bastate, 0, sizeof(IGBBAState));
         bool is_last = false;
 
         if (igb_ring_empty(core, rxi)) {
+            igb_rx_descr_wb_flush(core, d, &wb);
             return;
         }
 
@@ -1944,10 +2009,12 @@ igb_write_packet_to_guest(IGBCore *core, struct NetRxPkt *pkt,
                            etqf, ts,
                            &pdma_st,
                            rxi);
-        igb_pci_dma_write_rx_desc(core, d, base, &desc, rx_desc_len);
+        igb_rx_descr_wb_queue(core, d, &wb, base, &desc);
         igb_ring_advance(core, rxi, rx_desc_len / E1000_MIN_RX_DESC_LEN);
     } while (pdma_st.desc_offset < pdma_st.total_size);
 
+    igb_rx_descr_wb_flush(core, d, &wb);
+
     igb_update_rx_stats(core, rxi, pdma_st.size, pdma_st.total_size);
 }
 
@@ -3048,6 +3115,22 @@ igb_set_eitr(IGBCore *core, int index, uint32_t val)
 
     core->eitr_guest_value[eitr_num] = val & ~E1000_EITR_CNT_IGNR;
     core->mac[index] = val & 0x7FFE;
+
+    /*
+     * Writing EITR restarts the interval countdown, so apply the new
+     * value to a running throttling window instead of waiting for the
+     * next rearm.  Otherwise adaptive moderation in the guest driver
+     * keeps being paced by a stale interval.
+     */
+    if (core->eitr[eitr_num].running) {
+        timer_del(core->eitr[eitr_num].timer);
+        core->eitr[eitr_num].running = false;
+        if (core->mac[index]) {
+            igb_intrmgr_rearm_timer(&core->eitr[eitr_num]);
+        } else {
+            igb_intrmgr_on_msix_throttling_timer(&core->eitr[eitr_num]);
+        }
+    }
 }
 
 static void
@@ -27,18 +27,22 @@
 #include "qemu/option_int.h"
 #include "qemu/config-file.h"
 #include "qobject/qdict.h"
+#include "block/aio-wait.h"
 #include "hw/virtio/virtio-net.h"
+#include "hw/virtio/iothread-vq-mapping.h"
 #include "net/vhost_net.h"
 #include "net/announce.h"
 #include "hw/virtio/virtio-bus.h"
 #include "qapi/error.h"
 #include "qapi/qapi-events-net.h"
 #include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
 #include "qapi/qapi-types-migration.h"
 #include "qapi/qapi-events-migration.h"
 #include "hw/virtio/virtio-access.h"
 #include "migration/misc.h"
 #include "standard-headers/linux/ethtool.h"
+#include "system/iothread.h"
 #include "system/system.h"
 #include "system/replay.h"
 #include "trace.h"
@@ -59,6 +63,9 @@
 #define VIRTIO_NET_RX_QUEUE_MIN_SIZE VIRTIO_NET_RX_QUEUE_DEFAULT_SIZE
 #define VIRTIO_NET_TX_QUEUE_MIN_SIZE VIRTIO_NET_TX_QUEUE_DEFAULT_SIZE
 
+/* Number of TX elements popped from the virtqueue in one batch */
+#define VIRTIO_NET_TX_BATCH 32
+
 #define VIRTIO_NET_IP4_ADDR_SIZE   8        /* ipv4 saddr + daddr */
 
 #define VIRTIO_NET_TCP_FLAG         0x3F
@@ -1298,6 +1305,17 @@ static void virtio_net_commit_rss_config(VirtIONet *n)
             }
         }
 
+        /*
+         * Software RSS may redirect a packet to a queue pair owned by a
+         * different IOThread, so steering must stay in the kernel when
+         * iothread-vq-mapping is in use.
+         */
+        if (n->vq_aio_context && n->rss_data.enabled_software_rss) {
+            warn_report("software RSS is unavailable with "
+                        "iothread-vq-mapping, disabling RSS");
+            n->rss_data.enabled_software_rss = false;
+        }
+
         trace_virtio_net_rss_enable(n,
                                     n->rss_data.hash_types,
                                     n->rss_data.indirections_len,
@@ -1904,6 +1922,20 @@ static int virtio_net_process_rss(NetClientState *nc, const uint8_t *buf,
     return (index == new_index) ? -1 : new_index;
 }
 
+/*
+ * Notify the guest about used buffers.  With iothread-vq-mapping the data
+ * path runs in an IOThread, where interrupts must be raised through the
+ * guest notifier instead of directly.
+ */
+static void virtio_net_data_notify(VirtIODevice *vdev, VirtQueue *vq)
+{
+    if (qemu_in_iothread()) {
+        virtio_notify_irqfd(vdev, vq);
+    } else {
+        virtio_notify(vdev, vq);
+    }
+}
+
 static ssize_t virtio_net_receive_rcu(NetClientState *nc, const uint8_t *buf,
                                       size_t size)
 {
@@ -2042,7 +2074,7 @@ static ssize_t virtio_net_receive_rcu(NetClientState *nc, const uint8_t *buf,
     }
 
     virtqueue_flush(q->rx_vq, i);
-    virtio_notify(vdev, q->rx_vq);
+    virtio_net_data_notify(vdev, q->rx_vq);
 
     return size;
 
@@ -2692,7 +2724,7 @@ static void virtio_net_tx_complete(NetClientState *nc, ssize_t len)
     int ret;
 
     virtqueue_push(q->tx_vq, q->async_tx.elem, 0);
-    virtio_notify(vdev, q->tx_vq);
+    virtio_net_data_notify(vdev, q->tx_vq);
 
     g_free(q->async_tx.elem);
     q->async_tx.elem = NULL;
@@ -2721,7 +2753,9 @@ static int32_t virtio_net_flush_tx(VirtIONetQueue *q)
 {
     VirtIONet *n = q->n;
     VirtIODevice *vdev = VIRTIO_DEVICE(n);
+    VirtQueueElement *elems[VIRTIO_NET_TX_BATCH];
     VirtQueueElement *elem;
+    unsigned int n_elems = 0, next = 0;
     int32_t num_packets = 0;
     int queue_index = vq2q(virtio_get_queue_index(q->tx_vq));
     if (!(vdev->status & VIRTIO_CONFIG_S_DRIVER_OK)) {
@@ -2739,10 +2773,19 @@ static int32_t virtio_net_flush_tx(VirtIONetQueue *q)
         struct iovec sg[VIRTQUEUE_MAX_SIZE], sg2[VIRTQUEUE_MAX_SIZE + 1], *out_sg;
         struct virtio_net_hdr vhdr;
 
-        elem = virtqueue_pop(q->tx_vq, sizeof(VirtQueueElement));
-        if (!elem) {
-            break;
+        if (next == n_elems) {
+            /* Cap the batch so the burst limit falls on a batch boundary */
+            int max_batch = MIN((int)ARRAY_SIZE(elems),
+                                MAX(n->tx_burst - num_packets, 1));
+
+            n_elems = virtqueue_pop_batch(q->tx_vq, sizeof(VirtQueueElement),
+                                          elems, max_batch);
+            next = 0;
+            if (!n_elems) {
+                break;
+            }
         }
+        elem = elems[next++];
 
         out_num = elem->out_num;
         out_sg = elem->out_sg;
@@ -2794,17 +2837,36 @@ static int32_t virtio_net_flush_tx(VirtIONetQueue *q)
             }
         }
 
-        ret = qemu_sendv_packet_async(qemu_get_subqueue(n->nic, queue_index),
-                                      out_sg, out_num, virtio_net_tx_complete);
+        /*
+         * Unless the header was rebuilt on the stack, all segments point
+         * into guest memory that stays valid until tx_complete runs, so
+         * the packet can be queued by reference on backend congestion.
+         */
+        if (n->needs_vnet_hdr_swap) {
+            ret = qemu_sendv_packet_async(qemu_get_subqueue(n->nic,
+                                                            queue_index),
+                                          out_sg, out_num,
+                                          virtio_net_tx_complete);
+        } else {
+            ret = qemu_sendv_packet_async_zerocopy(qemu_get_subqueue(n->nic,
+                                                                     queue_index),
+                                                   out_sg, out_num,
+                                                   virtio_net_tx_complete);
+        }
         if (ret == 0) {
             virtio_queue_set_notification(q->tx_vq, 0);
             q->async_tx.elem = elem;
+            /* Give the rest of the batch back; it is resent on completion */
+            while (n_elems > next) {
+                virtqueue_unpop(q->tx_vq, elems[--n_elems], 0);
+                g_free(elems[n_elems]);
+            }
             return -EBUSY;
         }
 
 drop:
         virtqueue_push(q->tx_vq, elem, 0);
-        virtio_notify(vdev, q->tx_vq);
+        virtio_net_data_notify(vdev, q->tx_vq);
         g_free(elem);
 
         if (++num_packets >= n->tx_burst) {
@@ -2816,6 +2878,11 @@ drop:
 detach:
     virtqueue_detach_element(q->tx_vq, elem, 0);
     g_free(elem);
+    while (next < n_elems) {
+        elem = elems[next++];
+        virtqueue_detach_element(q->tx_vq, elem, 0);
+        g_free(elem);
+    }
     return -EINVAL;
 }
 
@@ -2993,8 +3060,16 @@ static void virtio_net_add_queue(VirtIONet *n, int index)
         n->vqs[index].tx_vq =
             virtio_add_queue(vdev, n->net_conf.tx_queue_size,
                              virtio_net_handle_tx_bh);
-        n->vqs[index].tx_bh = qemu_bh_new_guarded(virtio_net_tx_bh, &n->vqs[index],
-                                                  &DEVICE(vdev)->mem_reentrancy_guard);
+        if (n->vq_aio_context) {
+            n->vqs[index].tx_bh = aio_bh_new_guarded(n->vq_aio_context[index],
+                                                     virtio_net_tx_bh,
+                                                     &n->vqs[index],
+                                                     &DEVICE(vdev)->mem_reentrancy_guard);
+        } else {
+            n->vqs[index].tx_bh = qemu_bh_new_guarded(virtio_net_tx_bh,
+                                                      &n->vqs[index],
+                                                      &DEVICE(vdev)->mem_reentrancy_guard);
+        }
     }
 
     n->vqs[index].tx_waiting = 0;
@@ -3521,7 +3596,15 @@ static bool virtio_net_guest_notifier_pending(VirtIODevice *vdev, int idx)
 {
     VirtIONet *n = VIRTIO_NET(vdev);
     NetClientState *nc;
-    assert(n->vhost_started);
+
+    if (!n->vhost_started) {
+        /*
+         * Guest notifiers are also in use with iothread-vq-mapping; the
+         * transport (MSI-X) tracks pending interrupts itself there.
+         */
+        assert(n->vq_aio_context);
+        return false;
+    }
     if (!n->multiqueue && idx == 2) {
         /* Must guard against invalid features and bogus queue index
          * from being set by malicious guest, or penetrated through
@@ -3553,7 +3636,12 @@ static void virtio_net_guest_notifier_mask(VirtIODevice *vdev, int idx,
 {
     VirtIONet *n = VIRTIO_NET(vdev);
     NetClientState *nc;
-    assert(n->vhost_started);
+
+    if (!n->vhost_started) {
+        /* See virtio_net_guest_notifier_pending() */
+        assert(n->vq_aio_context);
+        return;
+    }
     if (!n->multiqueue && idx == 2) {
         /* Must guard against invalid features and bogus queue index
          * from being set by malicious guest, or penetrated through
@@ -3745,6 +3833,171 @@ static bool failover_hide_primary_device(DeviceListener *listener,
     return qatomic_read(&n->failover_primary_hidden);
 }
 
+/* Context: BQL held */
+static bool virtio_net_vq_aio_context_init(VirtIONet *n, Error **errp)
+{
+    VirtIODevice *vdev = VIRTIO_DEVICE(n);
+    BusState *qbus = BUS(qdev_get_parent_bus(DEVICE(vdev)));
+    VirtioBusClass *k = VIRTIO_BUS_GET_CLASS(qbus);
+    int i;
+
+    if (!n->iothread_vq_mapping_list) {
+        return true;
+    }
+
+    if (!k->set_guest_notifiers || !k->ioeventfd_assign) {
+        error_setg(errp,
+                   "device is incompatible with iothread-vq-mapping "
+                   "(transport does not support notifiers)");
+        return false;
+    }
+    if (!virtio_device_ioeventfd_enabled(vdev)) {
+        error_setg(errp, "ioeventfd is required for iothread-vq-mapping");
+        return false;
+    }
+    if (n->net_conf.tx && !strcmp(n->net_conf.tx, "timer")) {
+        error_setg(errp,
+                   "iothread-vq-mapping is not compatible with tx=timer");
+        return false;
+    }
+
+    for (i = 0; i < n->max_queue_pairs; i++) {
+        NetClientState *peer = n->nic_conf.peers.ncs[i];
+
+        if (!qemu_can_set_aio_context(peer) || get_vhost_net(peer)) {
+            error_setg(errp, "iothread-vq-mapping requires a tap netdev "
+                       "without vhost");
+            return false;
+        }
+    }
+
+    n->vq_aio_context = g_new(AioContext *, n->max_queue_pairs);
+
+    if (!iothread_vq_mapping_apply(n->iothread_vq_mapping_list,
+                                   n->vq_aio_context, n->max_queue_pairs,
+                                   errp)) {
+        g_free(n->vq_aio_context);
+        n->vq_aio_context = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/* Context: BQL held */
+static void virtio_net_vq_aio_context_cleanup(VirtIONet *n)
+{
+    assert(!n->vq_ctx_attached);
+
+    if (n->iothread_vq_mapping_list) {
+        iothread_vq_mapping_cleanup(n->iothread_vq_mapping_list);
+    }
+
+    g_free(n->vq_aio_context);
+    n->vq_aio_context = NULL;
+}
+
+/*
+ * Stop processing a queue pair in its IOThread and move its tap fd back to
+ * the main loop.
+ *
+ * Context: BH in IOThread
+ */
+static void virtio_net_ioeventfd_stop_pair_bh(void *opaque)
+{
+    VirtIONetQueue *q = opaque;
+    VirtIONet *n = q->n;
+    int index = q - n->vqs;
+    NetClientState *nc = qemu_get_subqueue(n->nic, index);
+    AioContext *ctx = n->vq_aio_context[index];
+
+    virtio_queue_aio_detach_host_notifier(q->rx_vq, ctx);
+    virtio_queue_aio_detach_host_notifier(q->tx_vq, ctx);
+
+    /*
+     * Test and clear notifier after disabling event, in case the poll
+     * callback didn't have time to run.
+     */
+    virtio_queue_host_notifier_read(virtio_queue_get_host_notifier(q->rx_vq));
+    virtio_queue_host_notifier_read(virtio_queue_get_host_notifier(q->tx_vq));
+
+    qemu_set_aio_context(nc->peer, qemu_get_aio_context());
+}
+
+/* Context: BQL held */
+static int virtio_net_start_ioeventfd(VirtIODevice *vdev)
+{
+    VirtIONet *n = VIRTIO_NET(vdev);
+    BusState *qbus = BUS(qdev_get_parent_bus(DEVICE(vdev)));
+    VirtioBusClass *k = VIRTIO_BUS_GET_CLASS(qbus);
+    int nvqs = virtio_get_num_queues(vdev);
+    int r, i;
+
+    if (!n->vq_aio_context) {
+        return virtio_device_start_ioeventfd_impl(vdev);
+    }
+
+    /* vhost bypasses the device model; the mapping was rejected at realize */
+    assert(!n->vhost_started);
+
+    /* Set up guest notifiers (irq) so the IOThreads can raise interrupts */
+    r = k->set_guest_notifiers(qbus->parent, nvqs, true);
+    if (r != 0) {
+        error_report("virtio-net failed to set guest notifier (%d), "
+                     "ensure -accel kvm is set.", r);
+        return r;
+    }
+
+    r = virtio_device_start_ioeventfd_impl(vdev);
+    if (r != 0) {
+        k->set_guest_notifiers(qbus->parent, nvqs, false);
+        return r;
+    }
+
+    /* Hand the data queues and their tap fds over to the IOThreads */
+    for (i = 0; i < (nvqs - 1) / 2; i++) {
+        VirtIONetQueue *q = &n->vqs[i];
+        NetClientState *nc = qemu_get_subqueue(n->nic, i);
+        AioContext *ctx = n->vq_aio_context[i];
+
+        event_notifier_set_handler(virtio_queue_get_host_notifier(q->rx_vq),
+                                   NULL);
+        event_notifier_set_handler(virtio_queue_get_host_notifier(q->tx_vq),
+                                   NULL);
+        virtio_queue_aio_attach_host_notifier(q->rx_vq, ctx);
+        virtio_queue_aio_attach_host_notifier(q->tx_vq, ctx);
+        qemu_set_aio_context(nc->peer, ctx);
+    }
+    n->vq_ctx_attached = true;
+
+    return 0;
+}
+
+/* Context: BQL held */
+static void virtio_net_stop_ioeventfd(VirtIODevice *vdev)
+{
+    VirtIONet *n = VIRTIO_NET(vdev);
+    BusState *qbus = BUS(qdev_get_parent_bus(DEVICE(vdev)));
+    VirtioBusClass *k = VIRTIO_BUS_GET_CLASS(qbus);
+    int nvqs = virtio_get_num_queues(vdev);
+    int i;
+
+    if (n->vq_ctx_attached) {
+        for (i = 0; i < (nvqs - 1) / 2; i++) {
+            aio_wait_bh_oneshot(n->vq_aio_context[i],
+                                virtio_net_ioeventfd_stop_pair_bh,
+                                &n->vqs[i]);
+        }
+        n->vq_ctx_attached = false;
+
+        virtio_device_stop_ioeventfd_impl(vdev);
+        k->set_guest_notifiers(qbus->parent, nvqs, false);
+        return;
+    }
+
+    virtio_device_stop_ioeventfd_impl(vdev);
+}
+
 static void virtio_net_device_realize(DeviceState *dev, Error **errp)
 {
     VirtIODevice *vdev = VIRTIO_DEVICE(dev);
@@ -3854,6 +4107,12 @@ static void virtio_net_device_realize(DeviceState *dev, Error **errp)
     n->net_conf.tx_queue_size = MIN(virtio_net_max_tx_queue_size(n),
                                     n->net_conf.tx_queue_size);
 
+    if (!virtio_net_vq_aio_context_init(n, errp)) {
+        g_free(n->vqs);
+        virtio_cleanup(vdev);
+        return;
+    }
+
     virtio_net_add_queue(n, 0);
 
     n->ctrl_vq = virtio_add_queue(vdev, 64, virtio_net_handle_ctrl);
@@ -3955,6 +4214,7 @@ static void virtio_net_device_unrealize(DeviceState *dev)
     /* delete also control vq */
     virtio_del_queue(vdev, max_queue_pairs * 2);
     qemu_announce_timer_del(&n->announce_timer, false);
+    virtio_net_vq_aio_context_cleanup(n);
     g_free(n->vqs);
     qemu_del_nic(n->nic);
     virtio_net_rsc_cleanup(n);
@@ -4132,6 +4392,8 @@ static const Property virtio_net_properties[] = {
                       VIRTIO_NET_F_GUEST_USO6, true),
     DEFINE_PROP_BIT64("host_uso", VirtIONet, host_features,
                       VIRTIO_NET_F_HOST_USO, true),
+    DEFINE_PROP_IOTHREAD_VQ_MAPPING_LIST("iothread-vq-mapping", VirtIONet,
+                                         iothread_vq_mapping_list),
 };
 
 static void virtio_net_class_init(ObjectClass *klass, void *data)
@@ -4153,6 +4415,8 @@ static void virtio_net_class_init(ObjectClass *klass, void *data)
     vdc->queue_reset = virtio_net_queue_reset;
     vdc->queue_enable = virtio_net_queue_enable;
     vdc->set_status = virtio_net_set_status;
+    vdc->start_ioeventfd = virtio_net_start_ioeventfd;
+    vdc->stop_ioeventfd = virtio_net_stop_ioeventfd;
     vdc->guest_notifier_mask = virtio_net_guest_notifier_mask;
     vdc->guest_notifier_pending = virtio_net_guest_notifier_pending;
     vdc->legacy_features |= (0x1 << VIRTIO_NET_F_GSO);
@@ -226,6 +226,8 @@
 #define NVME_VF_RES_GRANULARITY 1
 #define NVME_VF_OFFSET 0x1
 #define NVME_VF_STRIDE 1
+#define NVME_DB_POLL_INTERVAL_MIN_NS (10 * SCALE_US)
+#define NVME_DB_POLL_INTERVAL_MAX_NS (1 * SCALE_MS)
 
 #define NVME_GUEST_ERR(trace, fmt, ...) \
     do { \
@@ -315,6 +317,7 @@ static const uint32_t nvme_cse_iocs_zoned_default[256] = {
 };
 
 static void nvme_process_sq(void *opaque);
+static void nvme_db_poll(void *opaque);
 static void nvme_ctrl_reset(NvmeCtrl *n, NvmeResetType rst);
 static inline uint64_t nvme_get_timestamp(const NvmeCtrl *n);
 
@@ -7238,6 +7241,12 @@ static uint16_t nvme_dbbuf_config(NvmeCtrl *n, const NvmeRequest *req)
     n->dbbuf_eis = eis_addr;
     n->dbbuf_enabled = true;
 
+    if (n->params.db_poll) {
+        n->db_poll_ns = NVME_DB_POLL_INTERVAL_MIN_NS;
+        timer_mod(n->db_poll_timer,
+                  qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) + n->db_poll_ns);
+    }
+
     for (i = 0; i < n->params.max_ioqpairs + 1; i++) {
         NvmeSQueue *sq = n->sq[i];
         NvmeCQueue *cq = n->cq[i];
@@ -7408,6 +7417,73 @@ static void nvme_update_sq_tail(NvmeSQueue *sq)
     trace_pci_nvme_update_sq_tail(sq->sqid, sq->tail);
 }
 
+/*
+ * Poll the shadow doorbell buffer for submission queue tail and completion
+ * queue head updates that the guest did not (or will not) announce with an
+ * MMIO doorbell write.  Paired with a polling guest driver this removes the
+ * doorbell VM exits from the I/O path entirely; the eventidx protocol only
+ * forces the guest back to MMIO when polling is behind.
+ */
+static void nvme_db_poll(void *opaque)
+{
+    NvmeCtrl *n = opaque;
+    bool found = false;
+    int i;
+
+    if (!n->dbbuf_enabled) {
+        return;
+    }
+
+    for (i = 1; i < n->params.max_ioqpairs + 1; i++) {
+        NvmeSQueue *sq = n->sq[i];
+        NvmeCQueue *cq = n->cq[i];
+
+        if (sq && sq->db_addr) {
+            nvme_update_sq_tail(sq);
+            if (!nvme_sq_empty(sq)) {
+                found = true;
+                qemu_bh_schedule(sq->bh);
+            }
+        }
+
+        if (cq && cq->db_addr) {
+            uint32_t head = cq->head;
+
+            nvme_update_cq_head(cq);
+            if (cq->head != head) {
+                found = true;
+
+                /* post cqes that were deferred while the queue was full */
+                if (!QTAILQ_EMPTY(&cq->req_list)) {
+                    qemu_bh_schedule(cq->bh);
+                }
+
+                if (cq->tail == cq->head) {
+                    if (cq->irq_enabled) {
+                        n->cq_pending--;
+                    }
+
+                    nvme_irq_deassert(n, cq);
+                }
+            }
+        }
+    }
+
+    /*
+     * Back off exponentially while the queues stay idle so an idle
+     * controller does not keep a host CPU busy; snap back to the minimum
+     * interval as soon as the guest produces work again.
+     */
+    if (found) {
+        n->db_poll_ns = NVME_DB_POLL_INTERVAL_MIN_NS;
+    } else if (n->db_poll_ns < NVME_DB_POLL_INTERVAL_MAX_NS) {
+        n->db_poll_ns = MIN(n->db_poll_ns * 2, NVME_DB_POLL_INTERVAL_MAX_NS);
+    }
+
+    timer_mod(n->db_poll_timer,
+              qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) + n->db_poll_ns);
+}
+
 #define NVME_ATOMIC_NO_START        0
 #define NVME_ATOMIC_START_ATOMIC    1
 #define NVME_ATOMIC_START_NONATOMIC 2
@@ -7664,6 +7740,10 @@ static void nvme_ctrl_reset(NvmeCtrl *n, NvmeResetType rst)
     n->dbbuf_dbs = 0;
     n->dbbuf_eis = 0;
     n->dbbuf_enabled = false;
+
+    if (n->db_poll_timer) {
+        timer_del(n->db_poll_timer);
+    }
 }
 
 static void nvme_ctrl_shutdown(NvmeCtrl *n)
@@ -8315,6 +8395,12 @@ static bool nvme_check_params(NvmeCtrl *n, Error **errp)
         return false;
     }
 
+    if (params->db_poll && !params->dbcs) {
+        error_setg(errp, "db-poll requires the Doorbell Buffer Config "
+                   "command ('dbcs' property)");
+        return false;
+    }
+
     if (n->pmr.dev) {
         if (params->msix_exclusive_bar) {
             error_setg(errp, "not enough BARs available to enable PMR");
@@ -8443,6 +8529,10 @@ static void nvme_init_state(NvmeCtrl *n)
     n->aer_reqs = g_new0(NvmeRequest *, n->params.aerl + 1);
     QTAILQ_INIT(&n->aer_queue);
 
+    if (n->params.db_poll) {
+        n->db_poll_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, nvme_db_poll, n);
+    }
+
     n->nr_sec_ctrls = max_vfs;
     for (i = 0; i < max_vfs; i++) {
         sctrl = &list[i];
@@ -9023,6 +9113,10 @@ static void nvme_exit(PCIDevice *pci_dev)
     g_free(n->sq);
     g_free(n->aer_reqs);
 
+    if (n->db_poll_timer) {
+        timer_free(n->db_poll_timer);
+    }
+
     if (n->params.cmb_size_mb) {
         g_free(n->cmb.buf);
     }
@@ -9068,6 +9162,7 @@ static const Property nvme_props[] = {
     DEFINE_PROP_BOOL("legacy-cmb", NvmeCtrl, params.legacy_cmb, false),
     DEFINE_PROP_BOOL("ioeventfd", NvmeCtrl, params.ioeventfd, false),
     DEFINE_PROP_BOOL("dbcs", NvmeCtrl, params.dbcs, true),
+    DEFINE_PROP_BOOL("db-poll", NvmeCtrl, params.db_poll, false),
     DEFINE_PROP_UINT8("zoned.zasl", NvmeCtrl, params.zasl, 0),
     DEFINE_PROP_BOOL("zoned.auto_transition", NvmeCtrl,
                      params.auto_transition_zones, true),
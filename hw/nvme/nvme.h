@@ -19,6 +19,7 @@
 #define HW_NVME_NVME_H
 
 #include "qemu/uuid.h"
+#include "qemu/timer.h"
 #include "hw/pci/pci_device.h"
 #include "hw/block/block.h"
 
@@ -542,6 +543,7 @@ typedef struct NvmeParams {
     bool     legacy_cmb;
     bool     ioeventfd;
     bool     dbcs;
+    bool     db_poll;
     uint16_t  sriov_max_vfs;
     uint16_t sriov_vq_flexible;
     uint16_t sriov_vi_flexible;
@@ -586,6 +588,8 @@ typedef struct NvmeCtrl {
     uint64_t    dbbuf_dbs;
     uint64_t    dbbuf_eis;
     bool        dbbuf_enabled;
+    QEMUTimer   *db_poll_timer;
+    int64_t     db_poll_ns;
 
     struct {
         uint32_t acs[256];
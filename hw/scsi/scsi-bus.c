@@ -1,5 +1,6 @@
 #include "qemu/osdep.h"
 #include "qapi/error.h"
+#include "qemu/defer-call.h"
 #include "qemu/error-report.h"
 #include "qemu/module.h"
 #include "qemu/option.h"
@@ -141,11 +142,16 @@ static void scsi_device_for_each_req_async_bh(void *opaque)
         }
     }
 
-    /* Call fn() on each request */
+    /*
+     * Call fn() on each request.  fn() may complete requests, so batch
+     * the guest notifications issued on their behalf into one.
+     */
+    defer_call_begin();
     for (GList *elem = g_list_first(reqs); elem; elem = g_list_next(elem)) {
         data->fn(elem->data, data->fn_opaque);
         scsi_req_unref(elem->data);
     }
+    defer_call_end();
 
     /* Drop the reference taken by scsi_device_for_each_req_async() */
     object_unref(OBJECT(s));
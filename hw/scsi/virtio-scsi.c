@@ -674,9 +674,12 @@ static void virtio_scsi_handle_ctrl_vq(VirtIOSCSI *s, VirtQueue *vq)
 {
     VirtIOSCSIReq *req;
 
+    /* Coalesce the guest notifications for requests completed in the loop */
+    defer_call_begin();
     while ((req = virtio_scsi_pop_req(s, vq, &s->ctrl_lock))) {
         virtio_scsi_handle_ctrl_req(s, req);
     }
+    defer_call_end();
 }
 
 /*
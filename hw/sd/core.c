@@ -124,6 +124,11 @@ void sdbus_write_data(SDBus *sdbus, const void *buf, size_t length)
     if (card) {
         SDCardClass *sc = SDMMC_COMMON_GET_CLASS(card);
 
+        if (sc->write_data) {
+            trace_sdbus_write_data(sdbus_name(sdbus), length);
+            sc->write_data(card, data, length);
+            return;
+        }
         for (size_t i = 0; i < length; i++) {
             trace_sdbus_write(sdbus_name(sdbus), data[i]);
             sc->write_byte(card, data[i]);
@@ -154,6 +159,11 @@ void sdbus_read_data(SDBus *sdbus, void *buf, size_t length)
     if (card) {
         SDCardClass *sc = SDMMC_COMMON_GET_CLASS(card);
 
+        if (sc->read_data) {
+            trace_sdbus_read_data(sdbus_name(sdbus), length);
+            sc->read_data(card, data, length);
+            return;
+        }
         for (size_t i = 0; i < length; i++) {
             data[i] = sc->read_byte(card);
             trace_sdbus_read(sdbus_name(sdbus), data[i]);
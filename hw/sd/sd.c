@@ -2496,6 +2496,102 @@ static uint8_t sd_read_byte(SDState *sd)
     return ret;
 }
 
+/*
+ * Bulk transfer of an ongoing WRITE_MULTIPLE_BLOCK.  The first byte of
+ * each block goes through sd_write_byte() so that the address and write
+ * protection checks run exactly as on the byte-wise path; the remainder
+ * of the block is copied in one go and committed with a single
+ * sd_blk_write() per block.  Anything that is not a CMD25 data phase
+ * falls back to sd_write_byte().
+ */
+static void sd_write_data(SDState *sd, const uint8_t *buf, size_t length)
+{
+    size_t pos = 0;
+
+    while (pos < length) {
+        size_t now;
+
+        if (sd->current_cmd != 25 || sd->state != sd_receivingdata_state ||
+            sd->data_offset == 0 || !sd->blk || !blk_is_inserted(sd->blk) ||
+            (sd->card_status & (ADDRESS_ERROR | WP_VIOLATION))) {
+            sd_write_byte(sd, buf[pos++]);
+            continue;
+        }
+
+        now = MIN(length - pos, (size_t)(sd->blk_len - sd->data_offset));
+        trace_sdcard_write_data_bulk(sd->proto->name, sd->last_cmd_name,
+                                     sd->current_cmd, sd->data_offset, now);
+        memcpy(&sd->data[sd->data_offset], buf + pos, now);
+        sd->data_offset += now;
+        pos += now;
+
+        if (sd->data_offset >= sd->blk_len) {
+            /* TODO: Check CRC before committing */
+            sd->state = sd_programming_state;
+            sd_blk_write(sd, sd->data_start, sd->data_offset);
+            sd->blk_written++;
+            sd->data_start += sd->blk_len;
+            sd->data_offset = 0;
+            sd->csd[14] |= 0x40;
+
+            /* Bzzzzzzztt .... Operation complete.  */
+            if (sd->multi_blk_cnt != 0) {
+                if (--sd->multi_blk_cnt == 0) {
+                    /* Stop! */
+                    sd->state = sd_transfer_state;
+                    continue;
+                }
+            }
+
+            sd->state = sd_receivingdata_state;
+        }
+    }
+}
+
+/*
+ * Bulk transfer of an ongoing READ_MULTIPLE_BLOCK.  The first byte of
+ * each block goes through sd_read_byte(), which performs the address
+ * check and the sd_blk_read() filling sd->data; the rest of the block
+ * is then copied out in one go.  Anything that is not a CMD18 data
+ * phase falls back to sd_read_byte().
+ */
+static void sd_read_data(SDState *sd, uint8_t *buf, size_t length)
+{
+    size_t pos = 0;
+
+    while (pos < length) {
+        uint32_t io_len;
+        size_t now;
+
+        if (sd->current_cmd != 18 || sd->state != sd_sendingdata_state ||
+            sd->data_offset == 0 || !sd->blk || !blk_is_inserted(sd->blk) ||
+            (sd->card_status & (ADDRESS_ERROR | WP_VIOLATION))) {
+            buf[pos++] = sd_read_byte(sd);
+            continue;
+        }
+
+        io_len = sd_blk_len(sd);
+        now = MIN(length - pos, (size_t)(io_len - sd->data_offset));
+        trace_sdcard_read_data_bulk(sd->proto->name, sd->last_cmd_name,
+                                    sd->current_cmd, sd->data_offset, now);
+        memcpy(buf + pos, &sd->data[sd->data_offset], now);
+        sd->data_offset += now;
+        pos += now;
+
+        if (sd->data_offset >= io_len) {
+            sd->data_start += io_len;
+            sd->data_offset = 0;
+
+            if (sd->multi_blk_cnt != 0) {
+                if (--sd->multi_blk_cnt == 0) {
+                    /* Stop! */
+                    sd->state = sd_transfer_state;
+                }
+            }
+        }
+    }
+}
+
 static bool sd_receive_ready(SDState *sd)
 {
     return sd->state == sd_receivingdata_state;
@@ -2768,6 +2864,8 @@ static void sdmmc_common_class_init(ObjectClass *klass, void *data)
     sc->do_command = sd_do_command;
     sc->write_byte = sd_write_byte;
     sc->read_byte = sd_read_byte;
+    sc->write_data = sd_write_data;
+    sc->read_data = sd_read_data;
     sc->receive_ready = sd_receive_ready;
     sc->data_ready = sd_data_ready;
     sc->get_inserted = sd_get_inserted;
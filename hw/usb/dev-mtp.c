@@ -21,6 +21,7 @@
 #include "qemu/iov.h"
 #include "qemu/module.h"
 #include "qemu/filemonitor.h"
+#include "block/thread-pool.h"
 #include "trace.h"
 #include "hw/qdev-properties.h"
 #include "hw/usb.h"
@@ -164,8 +165,20 @@ struct MTPData {
     uint8_t      write_status;
     /* Internal pointer per every MTP_WRITE_BUF_SZ */
     uint64_t     data_offset;
+    /* a worker thread read is using fd and data */
+    bool         read_pending;
+    /* freed while a read was pending, finish the free on completion */
+    bool         orphan;
 };
 
+/* file read running on a worker thread on behalf of an async packet */
+typedef struct MTPFileRead {
+    MTPState     *s;
+    MTPData      *d;
+    USBPacket    *p;    /* cleared if the packet is cancelled */
+    uint64_t     len;
+} MTPFileRead;
+
 struct MTPObject {
     uint32_t     handle;
     uint16_t     format;
@@ -190,6 +203,7 @@ struct MTPState {
 
     MTPData      *data_in;
     MTPData      *data_out;
+    MTPFileRead  *read_req;
     MTPControl   *result;
     uint32_t     session;
     uint32_t     next_handle;
@@ -665,6 +679,14 @@ static void usb_mtp_data_free(MTPData *data)
     if (data == NULL) {
         return;
     }
+    if (data->read_pending) {
+        /*
+         * A worker thread read is still using fd and data; the read
+         * completion callback will finish the free.
+         */
+        data->orphan = true;
+        return;
+    }
     if (data->fd != -1) {
         close(data->fd);
     }
@@ -1547,8 +1569,10 @@ static void usb_mtp_handle_control(USBDevice *dev, USBPacket *p,
 
 static void usb_mtp_cancel_packet(USBDevice *dev, USBPacket *p)
 {
-    /* we don't use async packets, so this should never be called */
-    fprintf(stderr, "%s\n", __func__);
+    MTPState *s = USB_MTP(dev);
+
+    assert(s->read_req && s->read_req->p == p);
+    s->read_req->p = NULL;
 }
 
 static char *utf16_to_str(uint8_t len, uint8_t *str16)
@@ -1840,6 +1864,80 @@ static void usb_mtp_get_data(MTPState *s, mtp_container *container,
     }
 }
 
+static int usb_mtp_file_read_func(void *arg)
+{
+    MTPFileRead *r = arg;
+
+    return read(r->d->fd, r->d->data, r->len);
+}
+
+static void usb_mtp_file_read_done(void *opaque, int ret)
+{
+    MTPFileRead *r = opaque;
+    MTPState *s = r->s;
+    MTPData *d = r->d;
+    USBPacket *p = r->p;
+
+    s->read_req = NULL;
+    d->read_pending = false;
+
+    if (d->orphan) {
+        /* the transaction was cancelled while the read was in flight */
+        usb_mtp_data_free(d);
+        if (p) {
+            p->status = USB_RET_STALL;
+            usb_packet_complete(&s->dev, p);
+        }
+        g_free(r);
+        return;
+    }
+
+    if (!p) {
+        /* the packet was cancelled; the chunk read on its behalf is lost */
+        d->offset += r->len;
+        if (d->offset == d->length) {
+            usb_mtp_data_free(s->data_in);
+            s->data_in = NULL;
+        }
+        g_free(r);
+        return;
+    }
+
+    if (ret != r->len) {
+        memset(d->data, 0, r->len);
+        s->result->code = RES_INCOMPLETE_TRANSFER;
+    }
+    usb_packet_copy(p, d->data, r->len);
+    d->offset += r->len;
+    if (d->offset == d->length) {
+        usb_mtp_data_free(s->data_in);
+        s->data_in = NULL;
+    }
+    p->status = USB_RET_SUCCESS;
+    usb_packet_complete(&s->dev, p);
+    g_free(r);
+}
+
+static void usb_mtp_file_read_submit(MTPState *s, USBPacket *p, uint64_t dlen)
+{
+    MTPFileRead *r = g_new0(MTPFileRead, 1);
+
+    r->s = s;
+    r->d = s->data_in;
+    r->p = p;
+    r->len = dlen;
+    r->d->read_pending = true;
+    s->read_req = r;
+
+    /*
+     * Read on a worker thread; a blocking read here would stall the
+     * whole main loop when the backing file sits on slow storage.
+     */
+    thread_pool_submit_aio(usb_mtp_file_read_func, r,
+                           usb_mtp_file_read_done, r);
+    p->status = USB_RET_ASYNC;
+}
+
 static void usb_mtp_handle_data(USBDevice *dev, USBPacket *p)
 {
     MTPState *s = USB_MTP(dev);
@@ -1847,7 +1945,7 @@ static void usb_mtp_handle_data(USBDevice *dev, USBPacket *p)
     mtp_container container;
     uint32_t params[5];
     uint16_t container_type;
-    int i, rc;
+    int i;
 
     switch (p->ep->nr) {
     case EP_DATA_IN:
@@ -1888,22 +1986,23 @@ static void usb_mtp_handle_data(USBDevice *dev, USBPacket *p)
             }
             if (d->fd == -1) {
                 usb_packet_copy(p, d->data + d->offset, dlen);
+                d->offset += dlen;
+                if (d->offset == d->length) {
+                    usb_mtp_data_free(s->data_in);
+                    s->data_in = NULL;
+                }
             } else {
+                if (s->read_req) {
+                    /* an orphaned read is still draining the worker */
+                    trace_usb_mtp_stall(s->dev.addr, "file read inflight");
+                    p->status = USB_RET_STALL;
+                    return;
+                }
                 if (d->alloc < p->iov.size) {
                     d->alloc = p->iov.size;
                     d->data = g_realloc(d->data, d->alloc);
                 }
-                rc = read(d->fd, d->data, dlen);
-                if (rc != dlen) {
-                    memset(d->data, 0, dlen);
-                    s->result->code = RES_INCOMPLETE_TRANSFER;
-                }
-                usb_packet_copy(p, d->data, dlen);
-            }
-            d->offset += dlen;
-            if (d->offset == d->length) {
-                usb_mtp_data_free(s->data_in);
-                s->data_in = NULL;
+                usb_mtp_file_read_submit(s, p, dlen);
             }
         } else if (s->result != NULL) {
             MTPControl *r = s->result;
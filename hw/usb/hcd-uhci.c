@@ -108,6 +108,7 @@ typedef struct UHCI_QH {
 static void uhci_async_cancel(UHCIAsync *async);
 static void uhci_queue_fill(UHCIQueue *q, UHCI_TD *td);
 static void uhci_resume(void *opaque);
+static void uhci_idle_wakeup(UHCIState *s);
 
 static inline int32_t uhci_queue_token(UHCI_TD *td)
 {
@@ -388,6 +389,9 @@ static void uhci_port_write(void *opaque, hwaddr addr,
 
     trace_usb_uhci_mmio_writew(addr, val);
 
+    /* Any register write is a hint that the schedule may change */
+    uhci_idle_wakeup(s);
+
     switch (addr) {
     case UHCI_USBCMD:
         if ((val & UHCI_CMD_RS) && !(s->cmd & UHCI_CMD_RS)) {
@@ -604,6 +608,7 @@ static void uhci_wakeup(USBPort *port1)
     UHCIState *s = port1->opaque;
     UHCIPort *port = &s->ports[port1->index];
 
+    uhci_idle_wakeup(s);
     if (port->ctrl & UHCI_PORT_SUSPEND && !(port->ctrl & UHCI_PORT_RD)) {
         port->ctrl |= UHCI_PORT_RD;
         uhci_resume(s);
@@ -888,6 +893,7 @@ static void uhci_async_complete(USBPort *port, USBPacket *packet)
     }
 
     async->done = 1;
+    uhci_idle_wakeup(s);
     /* Force processing of this packet *now*, needed for migration */
     s->completions_only = true;
     qemu_bh_schedule(s->bh);
@@ -1096,10 +1102,32 @@ static void uhci_bh(void *opaque)
     uhci_process_frame(s);
 }
 
+/*
+ * UHCI has no doorbell; new work is only discovered by walking the frame
+ * list.  To avoid waking up at 1 kHz for an idle schedule, consecutive
+ * workless timer ticks stretch the tick period (the catch-up loop in
+ * uhci_frame_timer still processes every skipped frame's schedule, so
+ * frame numbering and queue aging stay exact).  Any sign of activity --
+ * a completed TD, a pending interrupt, a device wakeup or a register
+ * write -- snaps the timer back to per-frame ticking.
+ */
+static void uhci_idle_wakeup(UHCIState *s)
+{
+    if (s->frame_stepdown) {
+        s->frame_stepdown = 0;
+        if (s->cmd & UHCI_CMD_RS) {
+            timer_mod(s->frame_timer,
+                      qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+                      NANOSECONDS_PER_SECOND / FRAME_TIMER_FREQ);
+        }
+    }
+}
+
 static void uhci_frame_timer(void *opaque)
 {
     UHCIState *s = opaque;
     uint64_t t_now, t_last_run;
+    bool work_done = false;
     int i, frames;
     const uint64_t frame_t = NANOSECONDS_PER_SECOND / FRAME_TIMER_FREQ;
 
@@ -1138,6 +1166,9 @@ static void uhci_frame_timer(void *opaque)
         uhci_async_validate_begin(s);
         uhci_process_frame(s);
         uhci_async_validate_end(s);
+        if (s->frame_bytes) {
+            work_done = true;
+        }
         /*
          * The spec says frnum is the frame currently being processed, and
          * the guest must look at frnum - 1 on interrupt, so inc frnum now
@@ -1146,6 +1177,12 @@ static void uhci_frame_timer(void *opaque)
         s->expire_time += frame_t;
     }
 
+    if (work_done || s->pending_int_mask) {
+        s->frame_stepdown = 0;
+    } else if (s->frame_stepdown < s->maxframes / 2) {
+        s->frame_stepdown++;
+    }
+
     /* Complete the previous frame(s) */
     if (s->pending_int_mask) {
         s->status2 |= s->pending_int_mask;
@@ -1154,7 +1191,7 @@ static void uhci_frame_timer(void *opaque)
     }
     s->pending_int_mask = 0;
 
-    timer_mod(s->frame_timer, t_now + frame_t);
+    timer_mod(s->frame_timer, t_now + frame_t * (s->frame_stepdown + 1));
 }
 
 static const MemoryRegionOps uhci_ioport_ops = {
@@ -1175,7 +1212,16 @@ static USBPortOps uhci_port_ops = {
     .complete = uhci_async_complete,
 };
 
+static void uhci_wakeup_endpoint(USBBus *bus, USBEndpoint *ep,
+                                 unsigned int stream)
+{
+    UHCIState *s = container_of(bus, UHCIState, bus);
+
+    uhci_idle_wakeup(s);
+}
+
 static USBBusOps uhci_bus_ops = {
+    .wakeup_endpoint = uhci_wakeup_endpoint,
 };
 
 void usb_uhci_common_realize(PCIDevice *dev, Error **errp)
@@ -569,7 +569,8 @@ vfio_save_complete_precopy_thread_config_state(VFIODevice *vbasedev,
     memcpy(&packet->data, bioc->data, bioc->usage);
 
     if (!multifd_queue_device_state(idstr, instance_id,
-                                    (char *)packet, packet_len)) {
+                                    (char *)g_steal_pointer(&packet),
+                                    packet_len)) {
         error_setg(errp, "%s: multifd config data queuing failed",
                    vbasedev->name);
         return false;
@@ -614,9 +615,6 @@ vfio_multifd_save_complete_precopy_thread(SaveLiveCompletePrecopyThreadData *d,
         goto thread_exit;
     }
 
-    packet = g_malloc0(sizeof(*packet) + migration->data_buffer_size);
-    packet->version = cpu_to_be32(VFIO_DEVICE_STATE_PACKET_VER_CURRENT);
-
     for (idx = 0; ; idx++) {
         ssize_t data_size;
         size_t packet_size;
@@ -626,6 +624,15 @@ vfio_multifd_save_complete_precopy_thread(SaveLiveCompletePrecopyThreadData *d,
             goto thread_exit;
         }
 
+        /*
+         * A fresh buffer each round since the previous one was handed
+         * over to the multifd channel, saving a copy there.
+         */
+        if (!packet) {
+            packet = g_malloc0(sizeof(*packet) + migration->data_buffer_size);
+            packet->version = cpu_to_be32(VFIO_DEVICE_STATE_PACKET_VER_CURRENT);
+        }
+
         data_size = read(migration->data_fd, &packet->data,
                          migration->data_buffer_size);
         if (data_size < 0) {
@@ -640,7 +647,8 @@ vfio_multifd_save_complete_precopy_thread(SaveLiveCompletePrecopyThreadData *d,
         packet_size = sizeof(*packet) + data_size;
 
         if (!multifd_queue_device_state(d->idstr, d->instance_id,
-                                        (char *)packet, packet_size)) {
+                                        (char *)g_steal_pointer(&packet),
+                                        packet_size)) {
             error_setg(errp, "%s: multifd data queuing failed", vbasedev->name);
             goto thread_exit;
         }
@@ -591,12 +591,6 @@ static bool vfio_is_active_iterate(void *opaque)
     return vfio_device_state_is_precopy(vbasedev);
 }
 
-/*
- * Note about migration rate limiting: VFIO migration buffer size is currently
- * limited to 1MB, so there is no need to check if migration rate exceeded (as
- * in the worst case it will exceed by 1MB). However, if the buffer size is
- * later changed to a bigger value, migration rate should be enforced here.
- */
 static int vfio_save_iterate(QEMUFile *f, void *opaque)
 {
     VFIODevice *vbasedev = opaque;
@@ -608,12 +602,21 @@ static int vfio_save_iterate(QEMUFile *f, void *opaque)
         migration->event_save_iterate_started = true;
     }
 
-    data_size = vfio_save_block(f, migration);
-    if (data_size < 0) {
-        return data_size;
-    }
+    /*
+     * Send precopy buffers until the shared migration rate limit is
+     * reached, the same way ram_save_iterate() does.  The rate limit
+     * paces the device state stream against the RAM stream: a device
+     * with a lot of precopy state gets drained at full bandwidth while
+     * idle, but cannot starve RAM of its share of the rate budget.
+     */
+    do {
+        data_size = vfio_save_block(f, migration);
+        if (data_size < 0) {
+            return data_size;
+        }
 
-    vfio_update_estimated_pending_data(migration, data_size);
+        vfio_update_estimated_pending_data(migration, data_size);
+    } while (data_size && !migration_rate_exceeded(f));
 
     if (migrate_switchover_ack() && !migration->precopy_init_size &&
         !migration->initial_data_sent) {
@@ -34,8 +34,25 @@ struct VhostIOVATree {
 
     /* GPA->IOVA address memory maps */
     IOVATree *gpa_iova_map;
+
+    /* Bumped on every removal; lets users detect stale cached lookups */
+    uint64_t generation;
 };
 
+/**
+ * Return the current generation of the tree
+ *
+ * The value changes whenever a mapping is removed, so a cached lookup
+ * result is still valid as long as the generation it was obtained under
+ * matches the current one.
+ *
+ * @iova_tree: The VhostIOVATree
+ */
+uint64_t vhost_iova_tree_generation(const VhostIOVATree *iova_tree)
+{
+    return iova_tree->generation;
+}
+
 /**
  * Create a new VhostIOVATree
  *
@@ -52,6 +69,7 @@ VhostIOVATree *vhost_iova_tree_new(hwaddr iova_first, hwaddr iova_last)
     tree->iova_taddr_map = iova_tree_new();
     tree->iova_map = iova_tree_new();
     tree->gpa_iova_map = gpa_tree_new();
+    tree->generation = 0;
     return tree;
 }
 
@@ -126,6 +144,7 @@ void vhost_iova_tree_remove(VhostIOVATree *iova_tree, DMAMap map)
 {
     iova_tree_remove(iova_tree->iova_taddr_map, map);
     iova_tree_remove(iova_tree->iova_map, map);
+    iova_tree->generation++;
 }
 
 /**
@@ -188,4 +207,5 @@ void vhost_iova_tree_remove_gpa(VhostIOVATree *iova_tree, DMAMap map)
 {
     iova_tree_remove(iova_tree->gpa_iova_map, map);
     iova_tree_remove(iova_tree->iova_map, map);
+    iova_tree->generation++;
 }
@@ -80,54 +80,84 @@ uint16_t vhost_svq_available_slots(const VhostShadowVirtqueue *svq)
  * @num: Length of iovec and minimum length of vaddr
  * @gpas: Descriptors' GPAs, if backed by guest memory
  */
-static bool vhost_svq_translate_addr(const VhostShadowVirtqueue *svq,
+static bool vhost_svq_translate_addr(VhostShadowVirtqueue *svq,
                                      hwaddr *addrs, const struct iovec *iovec,
                                      size_t num, const hwaddr *gpas)
 {
+    const bool is_gpa = gpas != NULL;
+    uint64_t gen;
+
     if (num == 0) {
         return true;
     }
 
+    /* Mapping removals invalidate every cached range */
+    gen = vhost_iova_tree_generation(svq->iova_tree);
+    if (svq->xlat_cache_gen != gen) {
+        memset(svq->xlat_cache, 0, sizeof(svq->xlat_cache));
+        svq->xlat_cache_gen = gen;
+    }
+
     for (size_t i = 0; i < num; ++i) {
         Int128 needle_last, map_last;
+        SVQTranslatedRange *ent = NULL;
         size_t off;
-        const DMAMap *map;
-        DMAMap needle;
-
-        /* Check if the descriptor is backed by guest memory  */
-        if (gpas) {
-            /* Search the GPA->IOVA tree */
-            needle = (DMAMap) {
-                .translated_addr = gpas[i],
-                .size = iovec[i].iov_len,
-            };
-            map = vhost_iova_tree_find_gpa(svq->iova_tree, &needle);
-        } else {
-            /* Search the IOVA->HVA tree */
-            needle = (DMAMap) {
-                .translated_addr = (hwaddr)(uintptr_t)iovec[i].iov_base,
+        hwaddr addr;
+        unsigned int j;
+
+        /* Descriptors backed by guest memory carry a GPA */
+        addr = is_gpa ? gpas[i] : (hwaddr)(uintptr_t)iovec[i].iov_base;
+
+        for (j = 0; j < ARRAY_SIZE(svq->xlat_cache); ++j) {
+            SVQTranslatedRange *cand = &svq->xlat_cache[j];
+
+            if (cand->valid && cand->is_gpa == is_gpa &&
+                addr >= cand->addr && addr <= cand->last) {
+                ent = cand;
+                break;
+            }
+        }
+
+        if (!ent) {
+            const DMAMap *map;
+            DMAMap needle = (DMAMap) {
+                .translated_addr = addr,
                 .size = iovec[i].iov_len,
             };
-            map = vhost_iova_tree_find_iova(svq->iova_tree, &needle);
-        }
 
-        /*
-         * Map cannot be NULL since iova map contains all guest space and
-         * qemu already has a physical address mapped
-         */
-        if (unlikely(!map)) {
-            qemu_log_mask(LOG_GUEST_ERROR,
-                          "Invalid address 0x%"HWADDR_PRIx" given by guest",
-                          needle.translated_addr);
-            return false;
+            /* Search the GPA->IOVA or the IOVA->HVA tree accordingly */
+            map = is_gpa ? vhost_iova_tree_find_gpa(svq->iova_tree, &needle)
+                         : vhost_iova_tree_find_iova(svq->iova_tree, &needle);
+
+            /*
+             * Map cannot be NULL since iova map contains all guest space and
+             * qemu already has a physical address mapped
+             */
+            if (unlikely(!map)) {
+                qemu_log_mask(LOG_GUEST_ERROR,
+                              "Invalid address 0x%"HWADDR_PRIx" given by guest",
+                              addr);
+                return false;
+            }
+
+            ent = &svq->xlat_cache[svq->xlat_cache_next];
+            svq->xlat_cache_next = (svq->xlat_cache_next + 1) %
+                                   ARRAY_SIZE(svq->xlat_cache);
+            *ent = (SVQTranslatedRange) {
+                .addr = map->translated_addr,
+                .last = map->translated_addr + map->size,
+                .iova = map->iova,
+                .is_gpa = is_gpa,
+                .valid = true,
+            };
         }
 
-        off = needle.translated_addr - map->translated_addr;
-        addrs[i] = map->iova + off;
+        off = addr - ent->addr;
+        addrs[i] = ent->iova + off;
 
-        needle_last = int128_add(int128_make64(needle.translated_addr),
+        needle_last = int128_add(int128_make64(addr),
                                  int128_makes64(iovec[i].iov_len - 1));
-        map_last = int128_make64(map->translated_addr + map->size);
+        map_last = int128_make64(ent->last);
         if (unlikely(int128_gt(needle_last, map_last))) {
             qemu_log_mask(LOG_GUEST_ERROR,
                           "Guest buffer expands over iova range");
@@ -236,7 +266,13 @@ static bool vhost_svq_add_split(VhostShadowVirtqueue *svq,
     return true;
 }
 
-static void vhost_svq_kick(VhostShadowVirtqueue *svq)
+/**
+ * Notify the device of newly available entries
+ *
+ * @svq: The shadow virtqueue
+ * @num: Number of entries made available since the last kick
+ */
+static void vhost_svq_kick(VhostShadowVirtqueue *svq, uint16_t num)
 {
     bool needs_kick;
 
@@ -249,7 +285,8 @@ static void vhost_svq_kick(VhostShadowVirtqueue *svq)
     if (virtio_vdev_has_feature(svq->vdev, VIRTIO_RING_F_EVENT_IDX)) {
         uint16_t avail_event = le16_to_cpu(
                 *(uint16_t *)(&svq->vring.used->ring[svq->vring.num]));
-        needs_kick = vring_need_event(avail_event, svq->shadow_avail_idx, svq->shadow_avail_idx - 1);
+        needs_kick = vring_need_event(avail_event, svq->shadow_avail_idx,
+                                      svq->shadow_avail_idx - num);
     } else {
         needs_kick =
                 !(svq->vring.used->flags & cpu_to_le16(VRING_USED_F_NO_NOTIFY));
@@ -263,14 +300,15 @@ static void vhost_svq_kick(VhostShadowVirtqueue *svq)
 }
 
 /**
- * Add an element to a SVQ.
+ * Expose an element to the SVQ vring without notifying the device.
  *
  * Return -EINVAL if element is invalid, -ENOSPC if dev queue is full
  */
-int vhost_svq_add(VhostShadowVirtqueue *svq, const struct iovec *out_sg,
-                  size_t out_num, const hwaddr *out_addr,
-                  const struct iovec *in_sg, size_t in_num,
-                  const hwaddr *in_addr, VirtQueueElement *elem)
+static int vhost_svq_add_no_kick(VhostShadowVirtqueue *svq,
+                                 const struct iovec *out_sg, size_t out_num,
+                                 const hwaddr *out_addr,
+                                 const struct iovec *in_sg, size_t in_num,
+                                 const hwaddr *in_addr, VirtQueueElement *elem)
 {
     unsigned qemu_head;
     unsigned ndescs = in_num + out_num;
@@ -289,16 +327,39 @@ int vhost_svq_add(VhostShadowVirtqueue *svq, const struct iovec *out_sg,
     svq->num_free -= ndescs;
     svq->desc_state[qemu_head].elem = elem;
     svq->desc_state[qemu_head].ndescs = ndescs;
-    vhost_svq_kick(svq);
     return 0;
 }
 
-/* Convenience wrapper to add a guest's element to SVQ */
+/**
+ * Add an element to a SVQ.
+ *
+ * Return -EINVAL if element is invalid, -ENOSPC if dev queue is full
+ */
+int vhost_svq_add(VhostShadowVirtqueue *svq, const struct iovec *out_sg,
+                  size_t out_num, const hwaddr *out_addr,
+                  const struct iovec *in_sg, size_t in_num,
+                  const hwaddr *in_addr, VirtQueueElement *elem)
+{
+    int r = vhost_svq_add_no_kick(svq, out_sg, out_num, out_addr,
+                                  in_sg, in_num, in_addr, elem);
+    if (unlikely(r != 0)) {
+        return r;
+    }
+
+    vhost_svq_kick(svq, 1);
+    return 0;
+}
+
+/*
+ * Convenience wrapper to add a guest's element to SVQ.  The caller is
+ * responsible for kicking the device once the batch is exposed.
+ */
 static int vhost_svq_add_element(VhostShadowVirtqueue *svq,
                                  VirtQueueElement *elem)
 {
-    return vhost_svq_add(svq, elem->out_sg, elem->out_num, elem->out_addr,
-                         elem->in_sg, elem->in_num, elem->in_addr, elem);
+    return vhost_svq_add_no_kick(svq, elem->out_sg, elem->out_num,
+                                 elem->out_addr, elem->in_sg, elem->in_num,
+                                 elem->in_addr, elem);
 }
 
 /**
@@ -316,6 +377,8 @@ static int vhost_svq_add_element(VhostShadowVirtqueue *svq,
  */
 static void vhost_handle_guest_kick(VhostShadowVirtqueue *svq)
 {
+    uint16_t added = 0;
+
     /* Clear event notifier */
     event_notifier_test_and_clear(&svq->svq_kick);
 
@@ -341,6 +404,9 @@ static void vhost_handle_guest_kick(VhostShadowVirtqueue *svq)
                 r = svq->ops->avail_handler(svq, elem, svq->ops_opaque);
             } else {
                 r = vhost_svq_add_element(svq, elem);
+                if (r == 0) {
+                    added++;
+                }
             }
             if (unlikely(r != 0)) {
                 if (r == -ENOSPC) {
@@ -358,6 +424,11 @@ static void vhost_handle_guest_kick(VhostShadowVirtqueue *svq)
                     svq->next_guest_avail_elem = g_steal_pointer(&elem);
                 }
 
+                /* Flush what was exposed so far before ignoring kicks */
+                if (added) {
+                    vhost_svq_kick(svq, added);
+                }
+
                 /* VQ is full or broken, just return and ignore kicks */
                 return;
             }
@@ -365,6 +436,12 @@ static void vhost_handle_guest_kick(VhostShadowVirtqueue *svq)
             elem = NULL;
         }
 
+        /* One kick flushes the whole batch to the device ring */
+        if (added) {
+            vhost_svq_kick(svq, added);
+            added = 0;
+        }
+
         virtio_queue_set_notification(svq->vq, true);
     } while (!virtio_queue_empty(svq->vq));
 }
@@ -692,6 +769,9 @@ void vhost_svq_start(VhostShadowVirtqueue *svq, VirtIODevice *vdev,
     svq->vdev = vdev;
     svq->vq = vq;
     svq->iova_tree = iova_tree;
+    memset(svq->xlat_cache, 0, sizeof(svq->xlat_cache));
+    svq->xlat_cache_gen = iova_tree ? vhost_iova_tree_generation(iova_tree) : 0;
+    svq->xlat_cache_next = 0;
 
     svq->vring.num = virtio_queue_get_num(vdev, virtio_get_queue_index(vq));
     svq->num_free = svq->vring.num;
@@ -27,6 +27,21 @@ typedef struct SVQDescState {
 
 typedef struct VhostShadowVirtqueue VhostShadowVirtqueue;
 
+/* Number of ranges kept in the flat translation cache */
+#define SVQ_XLAT_CACHE_SIZE 8
+
+/* One hot range of the iova tree, resolved once and reused */
+typedef struct SVQTranslatedRange {
+    /* Base of the range; a GPA, or an HVA if not backed by guest memory */
+    hwaddr addr;
+    /* Last byte of the range, inclusive */
+    hwaddr last;
+    /* IOVA that @addr maps to */
+    hwaddr iova;
+    bool is_gpa;
+    bool valid;
+} SVQTranslatedRange;
+
 /**
  * Callback to handle an avail buffer.
  *
@@ -78,6 +93,15 @@ typedef struct VhostShadowVirtqueue {
     /* IOVA mapping */
     VhostIOVATree *iova_tree;
 
+    /* Flat cache of hot iova tree lookups, valid for @xlat_cache_gen */
+    SVQTranslatedRange xlat_cache[SVQ_XLAT_CACHE_SIZE];
+
+    /* iova_tree generation the cache was filled under */
+    uint64_t xlat_cache_gen;
+
+    /* Next cache slot to evict */
+    unsigned int xlat_cache_next;
+
     /* SVQ vring descriptors state */
     SVQDescState *desc_state;
 
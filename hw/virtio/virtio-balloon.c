@@ -515,7 +515,6 @@ static bool get_free_page_hints(VirtIOBalloon *dev)
     VirtIODevice *vdev = VIRTIO_DEVICE(dev);
     VirtQueue *vq = dev->free_page_vq;
     bool ret = true;
-    int i;
 
     while (dev->block_iothread) {
         qemu_cond_wait(&dev->free_page_cond, &dev->free_page_lock);
@@ -550,10 +549,7 @@ static bool get_free_page_hints(VirtIOBalloon *dev)
     }
 
     if (elem->in_num && dev->free_page_hint_status == FREE_PAGE_HINT_S_START) {
-        for (i = 0; i < elem->in_num; i++) {
-            qemu_guest_free_page_hint(elem->in_sg[i].iov_base,
-                                      elem->in_sg[i].iov_len);
-        }
+        qemu_guest_free_page_hints(elem->in_sg, elem->in_num);
     }
 
 out:
@@ -13,6 +13,7 @@
 #include "qemu/osdep.h"
 #include "qemu/iov.h"
 #include "qemu/cutils.h"
+#include "qemu/main-loop.h"
 #include "qemu/error-report.h"
 #include "qemu/units.h"
 #include "system/numa.h"
@@ -25,6 +26,7 @@
 #include "qapi/error.h"
 #include "qapi/visitor.h"
 #include "exec/ram_addr.h"
+#include "block/thread-pool.h"
 #include "migration/misc.h"
 #include "hw/boards.h"
 #include "hw/qdev-properties.h"
@@ -33,6 +35,8 @@
 
 static const VMStateDescription vmstate_virtio_mem_device_early;
 
+static void virtio_mem_handle_request(VirtIODevice *vdev, VirtQueue *vq);
+
 /*
  * We only had legacy x86 guests that did not support
  * VIRTIO_MEM_F_UNPLUGGED_INACCESSIBLE. Other targets don't have legacy guests.
@@ -178,8 +182,16 @@ static bool virtio_mem_has_shared_zeropage(RAMBlock *rb)
 #error VIRTIO_MEM_USABLE_EXTENT not defined
 #endif
 
-static bool virtio_mem_is_busy(void)
+static bool virtio_mem_is_busy(const VirtIOMEM *vmem)
 {
+    /*
+     * While an asynchronous discard runs, the bitmap does not reflect the
+     * final state yet; refuse further state changes until it completed.
+     */
+    if (vmem->async_unplug_inflight) {
+        return true;
+    }
+
     /*
      * Postcopy cannot handle concurrent discards and we don't want to migrate
      * pages on-demand with stale content when plugging new blocks.
@@ -592,7 +604,7 @@ static int virtio_mem_set_block_state(VirtIOMEM *vmem, uint64_t start_gpa,
     RAMBlock *rb = vmem->memdev->mr.ram_block;
     int ret = 0;
 
-    if (virtio_mem_is_busy()) {
+    if (virtio_mem_is_busy(vmem)) {
         return -EBUSY;
     }
 
@@ -704,14 +716,107 @@ static void virtio_mem_plug_request(VirtIOMEM *vmem, VirtQueueElement *elem,
     virtio_mem_send_response_simple(vmem, elem, type);
 }
 
+/* Discard unplugs of at least this size on a worker thread. */
+#define VIRTIO_MEM_ASYNC_DISCARD_MIN (1 * GiB)
+/* Chunk size of the worker's discards, for progress reporting. */
+#define VIRTIO_MEM_ASYNC_DISCARD_CHUNK (1 * GiB)
+
+typedef struct VirtIOMEMDiscardJob {
+    VirtIOMEM *vmem;
+    uint64_t gpa;
+    uint64_t size;
+} VirtIOMEMDiscardJob;
+
+static int virtio_mem_discard_worker(void *opaque)
+{
+    VirtIOMEMDiscardJob *job = opaque;
+    const uint64_t offset = job->gpa - job->vmem->addr;
+    RAMBlock *rb = job->vmem->memdev->mr.ram_block;
+    uint64_t done;
+
+    for (done = 0; done < job->size;) {
+        const uint64_t chunk = MIN(VIRTIO_MEM_ASYNC_DISCARD_CHUNK,
+                                   job->size - done);
+        int ret = ram_block_discard_range(rb, offset + done, chunk);
+
+        if (ret) {
+            return ret;
+        }
+        done += chunk;
+        trace_virtio_mem_async_discard_progress(job->gpa, done, job->size);
+    }
+    return 0;
+}
+
+static void virtio_mem_discard_complete(void *opaque, int ret)
+{
+    VirtIOMEMDiscardJob *job = opaque;
+    VirtIOMEM *vmem = job->vmem;
+    VirtQueueElement *elem = vmem->async_unplug_elem;
+    const uint64_t offset = job->gpa - vmem->addr;
+
+    vmem->async_unplug_elem = NULL;
+    vmem->async_unplug_inflight = false;
+
+    if (ret) {
+        virtio_mem_send_response_simple(vmem, elem, VIRTIO_MEM_RESP_BUSY);
+    } else {
+        virtio_mem_notify_unplug(vmem, offset, job->size);
+        virtio_mem_set_range_unplugged(vmem, job->gpa, job->size);
+        /* Deactivate completely unplugged memslots after updating the state. */
+        if (vmem->dynamic_memslots) {
+            virtio_mem_deactivate_unplugged_memslots(vmem, offset, job->size);
+        }
+        vmem->size -= job->size;
+        notifier_list_notify(&vmem->size_change_notifiers, &vmem->size);
+        virtio_mem_send_response_simple(vmem, elem, VIRTIO_MEM_RESP_ACK);
+    }
+    g_free(elem);
+    g_free(job);
+
+    /* Process requests that queued up while the discard was running. */
+    virtio_mem_handle_request(VIRTIO_DEVICE(vmem), vmem->vq);
+}
+
+static void virtio_mem_drain_async_discard(VirtIOMEM *vmem)
+{
+    while (vmem->async_unplug_inflight) {
+        aio_poll(qemu_get_aio_context(), true);
+    }
+}
+
 static void virtio_mem_unplug_request(VirtIOMEM *vmem, VirtQueueElement *elem,
                                       struct virtio_mem_req *req)
 {
     const uint64_t gpa = le64_to_cpu(req->u.unplug.addr);
     const uint16_t nb_blocks = le16_to_cpu(req->u.unplug.nb_blocks);
+    const uint64_t size = nb_blocks * vmem->block_size;
     uint16_t type;
 
     trace_virtio_mem_unplug_request(gpa, nb_blocks);
+
+    /*
+     * Discard large ranges on a worker thread and respond once it
+     * completed, so unplugging hundreds of gigabytes does not stall the
+     * main loop for seconds.  The bitmap is only updated on completion;
+     * until then, all further state changes report BUSY.
+     */
+    if (size >= VIRTIO_MEM_ASYNC_DISCARD_MIN &&
+        virtio_mem_valid_range(vmem, gpa, size) &&
+        virtio_mem_is_range_plugged(vmem, gpa, size) &&
+        !virtio_mem_is_busy(vmem)) {
+        VirtIOMEMDiscardJob *job = g_new0(VirtIOMEMDiscardJob, 1);
+
+        job->vmem = vmem;
+        job->gpa = gpa;
+        job->size = size;
+        vmem->async_unplug_elem = elem;
+        vmem->async_unplug_inflight = true;
+        thread_pool_submit_aio(virtio_mem_discard_worker, job,
+                               virtio_mem_discard_complete, job);
+        return;
+    }
+
     type = virtio_mem_state_change_request(vmem, gpa, nb_blocks, false);
     virtio_mem_send_response_simple(vmem, elem, type);
 }
@@ -744,7 +849,7 @@ static int virtio_mem_unplug_all(VirtIOMEM *vmem)
     RAMBlock *rb = vmem->memdev->mr.ram_block;
 
     if (vmem->size) {
-        if (virtio_mem_is_busy()) {
+        if (virtio_mem_is_busy(vmem)) {
             return -EBUSY;
         }
         if (ram_block_discard_range(rb, 0, qemu_ram_get_used_length(rb))) {
@@ -859,6 +964,10 @@ static void virtio_mem_handle_request(VirtIODevice *vdev, VirtQueue *vq)
             return;
         }
 
+        if (elem == vmem->async_unplug_elem) {
+            /* Response and freeing deferred until the worker completes. */
+            return;
+        }
         g_free(elem);
     }
 }
@@ -1158,6 +1267,8 @@ static void virtio_mem_device_unrealize(DeviceState *dev)
     VirtIODevice *vdev = VIRTIO_DEVICE(dev);
     VirtIOMEM *vmem = VIRTIO_MEM(dev);
 
+    virtio_mem_drain_async_discard(vmem);
+
     /*
      * The unplug handler unmapped the memory region, it cannot be
      * found via an address space anymore. Unset ourselves.
@@ -1453,10 +1564,23 @@ static const VMStateDescription vmstate_virtio_mem_device_early = {
     },
 };
 
+static int virtio_mem_pre_save(void *opaque)
+{
+    VirtIOMEM *vmem = VIRTIO_MEM(opaque);
+
+    /*
+     * An in-flight asynchronous discard holds back a request element and
+     * defers bitmap updates; neither can be migrated, so finish it first.
+     */
+    virtio_mem_drain_async_discard(vmem);
+    return 0;
+}
+
 static const VMStateDescription vmstate_virtio_mem = {
     .name = "virtio-mem",
     .minimum_version_id = 1,
     .version_id = 1,
+    .pre_save = virtio_mem_pre_save,
     .fields = (const VMStateField[]) {
         VMSTATE_VIRTIO_DEVICE,
         VMSTATE_END_OF_LIST()
@@ -1954,6 +2078,7 @@ static void virtio_mem_system_reset_hold(Object *obj, ResetType type)
      * region size. This is, however, not possible in all scenarios. Then,
      * the guest has to deal with this manually (VIRTIO_MEM_REQ_UNPLUG_ALL).
      */
+    virtio_mem_drain_async_discard(vmem);
     virtio_mem_unplug_all(vmem);
 }
 
@@ -36,6 +36,7 @@
 #include "system/kvm.h"
 #include "hw/virtio/virtio-pci.h"
 #include "qemu/range.h"
+#include "qemu/timer.h"
 #include "hw/virtio/virtio-bus.h"
 #include "qapi/visitor.h"
 #include "system/replay.h"
@@ -68,12 +69,99 @@ static inline VirtIOPCIProxy *to_virtio_pci_proxy_fast(DeviceState *d)
     return container_of(d, VirtIOPCIProxy, pci_dev.qdev);
 }
 
+static void virtio_pci_coalesce_timer(void *opaque)
+{
+    VirtIOPCIVectorCoalesce *c = opaque;
+    VirtIOPCIProxy *proxy = c->proxy;
+
+    c->armed = false;
+    if (!c->pending) {
+        return;
+    }
+    c->pending = false;
+
+    if (msix_enabled(&proxy->pci_dev)) {
+        msix_notify(&proxy->pci_dev, c->vector);
+    }
+    /* Keep pacing for as long as notifications keep arriving */
+    c->armed = true;
+    timer_mod_ns(c->timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+                           proxy->notify_holdoff_ns);
+}
+
+/*
+ * Returns true if the notification was absorbed into an armed hold-off
+ * period and will be delivered when the timer fires.
+ *
+ * This only moderates how often an interrupt the virtio core asked for
+ * is actually injected; it never generates one on its own, so EVENT_IDX
+ * suppression in the core keeps working unchanged and a deferred
+ * interrupt is never one the guest did not request.
+ */
+static bool virtio_pci_coalesce_notify(VirtIOPCIProxy *proxy, uint16_t vector)
+{
+    VirtIOPCIVectorCoalesce *c;
+    int64_t now, gap;
+
+    if (!proxy->vector_coalesce || vector >= proxy->nvectors) {
+        return false;
+    }
+
+    c = &proxy->vector_coalesce[vector];
+    if (c->armed) {
+        c->pending = true;
+        return true;
+    }
+
+    now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    gap = now - c->last_notify_ns;
+    c->last_notify_ns = now;
+    /* The average gap between notifications tracks the completion rate */
+    c->avg_gap_ns += (gap - c->avg_gap_ns) / 8;
+
+    if (c->avg_gap_ns >= proxy->notify_holdoff_ns) {
+        /* Slow queue: do not add latency */
+        return false;
+    }
+
+    /*
+     * Busy queue: deliver this interrupt immediately, but arm the
+     * hold-off so the burst behind it collapses into a single one.
+     */
+    c->armed = true;
+    timer_mod_ns(c->timer, now + proxy->notify_holdoff_ns);
+    return false;
+}
+
+static void virtio_pci_coalesce_flush(VirtIOPCIProxy *proxy)
+{
+    unsigned i;
+
+    if (!proxy->vector_coalesce) {
+        return;
+    }
+
+    for (i = 0; i < proxy->nvectors; i++) {
+        VirtIOPCIVectorCoalesce *c = &proxy->vector_coalesce[i];
+
+        timer_del(c->timer);
+        c->armed = false;
+        if (c->pending) {
+            c->pending = false;
+            if (msix_enabled(&proxy->pci_dev)) {
+                msix_notify(&proxy->pci_dev, c->vector);
+            }
+        }
+    }
+}
+
 static void virtio_pci_notify(DeviceState *d, uint16_t vector)
 {
     VirtIOPCIProxy *proxy = to_virtio_pci_proxy_fast(d);
 
     if (msix_enabled(&proxy->pci_dev)) {
-        if (vector != VIRTIO_NO_VECTOR) {
+        if (vector != VIRTIO_NO_VECTOR &&
+            !virtio_pci_coalesce_notify(proxy, vector)) {
             msix_notify(&proxy->pci_dev, vector);
         }
     } else {
@@ -87,6 +175,8 @@ static void virtio_pci_save_config(DeviceState *d, QEMUFile *f)
     VirtIOPCIProxy *proxy = to_virtio_pci_proxy(d);
     VirtIODevice *vdev = virtio_bus_get_device(&proxy->bus);
 
+    /* Inject held-back interrupts so MSI-X pending state is accurate */
+    virtio_pci_coalesce_flush(proxy);
     pci_device_save(&proxy->pci_dev, f);
     msix_save(&proxy->pci_dev, f);
     if (msix_present(&proxy->pci_dev))
@@ -1961,6 +2051,7 @@ static void virtio_pci_device_plugged(DeviceState *d, Error **errp)
     bool modern_pio = proxy->flags & VIRTIO_PCI_FLAG_MODERN_PIO_NOTIFY;
     uint8_t *config;
     uint32_t size;
+    unsigned i;
     VirtIODevice *vdev = virtio_bus_get_device(bus);
 
     /*
@@ -2094,6 +2185,19 @@ static void virtio_pci_device_plugged(DeviceState *d, Error **errp)
         }
     }
 
+    if (proxy->notify_holdoff_ns && proxy->nvectors) {
+        proxy->vector_coalesce = g_new0(VirtIOPCIVectorCoalesce,
+                                        proxy->nvectors);
+        for (i = 0; i < proxy->nvectors; i++) {
+            VirtIOPCIVectorCoalesce *c = &proxy->vector_coalesce[i];
+
+            c->proxy = proxy;
+            c->vector = i;
+            c->timer = timer_new_ns(QEMU_CLOCK_VIRTUAL,
+                                    virtio_pci_coalesce_timer, c);
+        }
+    }
+
     proxy->pci_dev.config_write = virtio_write_config;
     proxy->pci_dev.config_read = virtio_read_config;
 
@@ -2116,9 +2220,18 @@ static void virtio_pci_device_unplugged(DeviceState *d)
     VirtIOPCIProxy *proxy = VIRTIO_PCI(d);
     bool modern = virtio_pci_modern(proxy);
     bool modern_pio = proxy->flags & VIRTIO_PCI_FLAG_MODERN_PIO_NOTIFY;
+    unsigned i;
 
     virtio_pci_stop_ioeventfd(proxy);
 
+    if (proxy->vector_coalesce) {
+        for (i = 0; i < proxy->nvectors; i++) {
+            timer_free(proxy->vector_coalesce[i].timer);
+        }
+        g_free(proxy->vector_coalesce);
+        proxy->vector_coalesce = NULL;
+    }
+
     if (modern) {
         virtio_pci_modern_mem_region_unmap(proxy, &proxy->common);
         virtio_pci_modern_mem_region_unmap(proxy, &proxy->isr);
@@ -2293,6 +2406,16 @@ static void virtio_pci_reset(DeviceState *qdev)
     virtio_bus_reset(bus);
     msix_unuse_all_vectors(&proxy->pci_dev);
 
+    if (proxy->vector_coalesce) {
+        for (i = 0; i < proxy->nvectors; i++) {
+            VirtIOPCIVectorCoalesce *c = &proxy->vector_coalesce[i];
+
+            timer_del(c->timer);
+            c->armed = false;
+            c->pending = false;
+        }
+    }
+
     for (i = 0; i < VIRTIO_QUEUE_MAX; i++) {
         proxy->vqs[i].enabled = 0;
         proxy->vqs[i].reset = 0;
@@ -2375,6 +2498,7 @@ static const Property virtio_pci_properties[] = {
                     VIRTIO_PCI_FLAG_INIT_FLR_BIT, true),
     DEFINE_PROP_BIT("aer", VirtIOPCIProxy, flags,
                     VIRTIO_PCI_FLAG_AER_BIT, false),
+    DEFINE_PROP_UINT32("notify-holdoff", VirtIOPCIProxy, notify_holdoff_ns, 0),
 };
 
 static void virtio_pci_dc_realize(DeviceState *qdev, Error **errp)
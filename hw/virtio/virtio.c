@@ -15,6 +15,7 @@
 #include "qapi/error.h"
 #include "qapi/qapi-commands-virtio.h"
 #include "trace.h"
+#include "qemu/counter.h"
 #include "qemu/defer-call.h"
 #include "qemu/error-report.h"
 #include "qemu/log.h"
@@ -1670,7 +1671,12 @@ static void *virtqueue_alloc_element(size_t sz, unsigned out_num, unsigned in_nu
     return elem;
 }
 
-static void *virtqueue_split_pop(VirtQueue *vq, size_t sz)
+/*
+ * Caller must hold the RCU read lock and have checked that the queue is
+ * not empty, including the smp_rmb() pairing with the guest's avail ring
+ * update (see the comment in virtqueue_num_heads()).
+ */
+static void *virtqueue_split_pop_locked(VirtQueue *vq, size_t sz)
 {
     unsigned int i, head, max, idx;
     VRingMemoryRegionCaches *caches;
@@ -1687,14 +1693,6 @@ static void *virtqueue_split_pop(VirtQueue *vq, size_t sz)
 
     address_space_cache_init_empty(&indirect_desc_cache);
 
-    RCU_READ_LOCK_GUARD();
-    if (virtio_queue_empty_rcu(vq)) {
-        goto done;
-    }
-    /* Needed after virtio_queue_empty(), see comment in
-     * virtqueue_num_heads(). */
-    smp_rmb();
-
     /* When we start there are none of either input nor output. */
     out_num = in_num = elem_entries = 0;
 
@@ -1816,7 +1814,56 @@ err_undo_map:
     goto done;
 }
 
-static void *virtqueue_packed_pop(VirtQueue *vq, size_t sz)
+static void *virtqueue_split_pop(VirtQueue *vq, size_t sz)
+{
+    RCU_READ_LOCK_GUARD();
+
+    if (virtio_queue_empty_rcu(vq)) {
+        return NULL;
+    }
+    /* Needed after virtio_queue_empty(), see comment in
+     * virtqueue_num_heads(). */
+    smp_rmb();
+
+    return virtqueue_split_pop_locked(vq, sz);
+}
+
+static unsigned virtqueue_split_pop_batch(VirtQueue *vq, size_t sz,
+                                          VirtQueueElement **elems,
+                                          unsigned max_elems)
+{
+    unsigned count = 0;
+
+    RCU_READ_LOCK_GUARD();
+
+    if (virtio_queue_empty_rcu(vq)) {
+        return 0;
+    }
+    /* Needed after virtio_queue_empty(), see comment in
+     * virtqueue_num_heads(). */
+    smp_rmb();
+
+    /*
+     * The avail index snapshotted in shadow_avail_idx bounds the walk;
+     * elements made available afterwards are left for the next call.
+     */
+    while (count < max_elems && vq->last_avail_idx != vq->shadow_avail_idx) {
+        VirtQueueElement *elem = virtqueue_split_pop_locked(vq, sz);
+
+        if (!elem) {
+            break;
+        }
+        elems[count++] = elem;
+    }
+
+    return count;
+}
+
+/*
+ * Caller must hold the RCU read lock and have checked that the queue is
+ * not empty.
+ */
+static void *virtqueue_packed_pop_locked(VirtQueue *vq, size_t sz)
 {
     unsigned int i, max;
     VRingMemoryRegionCaches *caches;
@@ -1834,11 +1881,6 @@ static void *virtqueue_packed_pop(VirtQueue *vq, size_t sz)
 
     address_space_cache_init_empty(&indirect_desc_cache);
 
-    RCU_READ_LOCK_GUARD();
-    if (virtio_queue_packed_empty_rcu(vq)) {
-        goto done;
-    }
-
     /* When we start there are none of either input nor output. */
     out_num = in_num = elem_entries = 0;
 
@@ -1965,6 +2007,17 @@ err_undo_map:
     goto done;
 }
 
+static void *virtqueue_packed_pop(VirtQueue *vq, size_t sz)
+{
+    RCU_READ_LOCK_GUARD();
+
+    if (virtio_queue_packed_empty_rcu(vq)) {
+        return NULL;
+    }
+
+    return virtqueue_packed_pop_locked(vq, sz);
+}
+
 void *virtqueue_pop(VirtQueue *vq, size_t sz)
 {
     if (virtio_device_disabled(vq->vdev)) {
@@ -1978,6 +2031,40 @@ void *virtqueue_pop(VirtQueue *vq, size_t sz)
     }
 }
 
+static unsigned virtqueue_packed_pop_batch(VirtQueue *vq, size_t sz,
+                                           VirtQueueElement **elems,
+                                           unsigned max_elems)
+{
+    unsigned count = 0;
+
+    RCU_READ_LOCK_GUARD();
+
+    while (count < max_elems && !virtio_queue_packed_empty_rcu(vq)) {
+        VirtQueueElement *elem = virtqueue_packed_pop_locked(vq, sz);
+
+        if (!elem) {
+            break;
+        }
+        elems[count++] = elem;
+    }
+
+    return count;
+}
+
+unsigned virtqueue_pop_batch(VirtQueue *vq, size_t sz,
+                             VirtQueueElement **elems, unsigned max_elems)
+{
+    if (virtio_device_disabled(vq->vdev)) {
+        return 0;
+    }
+
+    if (virtio_vdev_has_feature(vq->vdev, VIRTIO_F_RING_PACKED)) {
+        return virtqueue_packed_pop_batch(vq, sz, elems, max_elems);
+    } else {
+        return virtqueue_split_pop_batch(vq, sz, elems, max_elems);
+    }
+}
+
 static unsigned int virtqueue_packed_drop_all(VirtQueue *vq)
 {
     VRingMemoryRegionCaches *caches;
@@ -2471,6 +2558,8 @@ void virtio_queue_set_shadow_avail_idx(VirtQueue *vq, uint16_t shadow_avail_idx)
     }
 }
 
+QEMU_COUNTER_DEFINE(virtqueue_kick_counter, "virtqueue-kick")
+
 static void virtio_queue_notify_vq(VirtQueue *vq)
 {
     if (vq->vring.desc && vq->handle_output) {
@@ -2480,6 +2569,7 @@ static void virtio_queue_notify_vq(VirtQueue *vq)
             return;
         }
 
+        qemu_counter_inc(&virtqueue_kick_counter);
         trace_virtio_queue_notify(vdev, vq - vdev->vq, vq);
         vq->handle_output(vdev, vq);
 
@@ -2499,8 +2589,10 @@ void virtio_queue_notify(VirtIODevice *vdev, int n)
 
     trace_virtio_queue_notify(vdev, vq - vdev->vq, vq);
     if (vq->host_notifier_enabled) {
+        /* counted in virtio_queue_notify_vq() when the notifier fires */
         event_notifier_set(&vq->host_notifier);
     } else if (vq->handle_output) {
+        qemu_counter_inc(&virtqueue_kick_counter);
         vq->handle_output(vdev, vq);
 
         if (unlikely(vdev->start_on_kick)) {
@@ -4020,7 +4112,7 @@ static const Property virtio_properties[] = {
                      disable_legacy_check, false),
 };
 
-static int virtio_device_start_ioeventfd_impl(VirtIODevice *vdev)
+int virtio_device_start_ioeventfd_impl(VirtIODevice *vdev)
 {
     VirtioBusState *qbus = VIRTIO_BUS(qdev_get_parent_bus(DEVICE(vdev)));
     int i, n, r, err;
@@ -4090,7 +4182,7 @@ int virtio_device_start_ioeventfd(VirtIODevice *vdev)
     return virtio_bus_start_ioeventfd(vbus);
 }
 
-static void virtio_device_stop_ioeventfd_impl(VirtIODevice *vdev)
+void virtio_device_stop_ioeventfd_impl(VirtIODevice *vdev)
 {
     VirtioBusState *qbus = VIRTIO_BUS(qdev_get_parent_bus(DEVICE(vdev)));
     int n, r;
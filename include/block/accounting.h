@@ -92,6 +92,14 @@ struct BlockAcctStats {
     bool account_invalid;
     bool account_failed;
     BlockLatencyHistogram latency_histogram[BLOCK_MAX_IOTYPE];
+    /*
+     * Always-on log2 latency histogram: bucket @i counts requests with
+     * latency in [2^(i-1), 2^i) ns, bucket 0 counts [0, 1) ns.  Cheap
+     * enough to maintain unconditionally (one clz per request), unlike
+     * the configurable @latency_histogram above.
+     */
+#define BLOCK_LATENCY_LOG2_NBINS 64
+    uint64_t latency_log2_bins[BLOCK_MAX_IOTYPE][BLOCK_LATENCY_LOG2_NBINS];
 };
 
 typedef struct BlockAcctCookie {
@@ -21,6 +21,7 @@
 #include "qemu/queue.h"
 #include "qemu/event_notifier.h"
 #include "qemu/lockcnt.h"
+#include "qemu/stats64.h"
 #include "qemu/thread.h"
 #include "qemu/timer.h"
 #include "block/graph-lock.h"
@@ -222,6 +223,8 @@ struct AioContext {
     /* State for file descriptor monitoring using Linux io_uring */
     struct io_uring fdmon_io_uring;
     AioHandlerSList submit_list;
+    /* Cleared if the kernel rejects IORING_POLL_ADD_MULTI */
+    bool fdmon_io_uring_multishot;
 #endif
 
     /* TimerLists for calling timers - one per clock type.  Has its own
@@ -240,6 +243,13 @@ struct AioContext {
     /* AIO engine parameters */
     int64_t aio_max_batch;  /* maximum number of requests in a batch */
 
+    /*
+     * CPU time consumed by aio_poll() iterations, in nanoseconds.  Written
+     * by the event loop thread only; a Stat64 so the monitor can read it
+     * for query-iothreads, also on 32-bit hosts.
+     */
+    Stat64 cpu_total_ns;
+
     /*
      * List of handlers participating in userspace polling.  Protected by
      * ctx->list_lock.  Iterated and modified mostly by the event loop thread
@@ -708,6 +718,27 @@ void aio_context_set_poll_params(AioContext *ctx, int64_t max_ns,
                                  int64_t grow, int64_t shrink,
                                  Error **errp);
 
+/**
+ * aio_context_get_poll_ns:
+ * @ctx: the aio context
+ *
+ * Return the polling time learned by the adaptive polling controller, in
+ * nanoseconds.  Each handler adapts its own polling time; the largest value
+ * is returned because it is what aio_poll() actually busy-waits for.  May
+ * be called from any thread; the result is a momentary snapshot.
+ */
+int64_t aio_context_get_poll_ns(AioContext *ctx);
+
+/**
+ * aio_context_get_cpu_ns:
+ * @ctx: the aio context
+ *
+ * Return the CPU time consumed by the context's event loop iterations since
+ * it was created, in nanoseconds.  Time spent blocked waiting for events is
+ * not included.  May be called from any thread.
+ */
+int64_t aio_context_get_cpu_ns(AioContext *ctx);
+
 /**
  * aio_context_set_aio_params:
  * @ctx: the aio context
@@ -125,11 +125,20 @@ typedef struct BlockZoneDescriptor {
     BlockZoneState state;
 } BlockZoneDescriptor;
 
+/*
+ * Zoned writes and appends are serialized per zone; the locks are
+ * striped so the table stays small for devices with many zones.
+ */
+#define BLK_ZONE_LOCK_STRIPES 64
+
 /*
  * Track write pointers of a zone in bytes.
  */
 typedef struct BlockZoneWps {
+    /* Protects the wp array; must not be held across I/O */
     CoMutex colock;
+    /* Serializes in-flight writes/appends within a zone */
+    CoMutex zone_locks[BLK_ZONE_LOCK_STRIPES];
     uint64_t wp[];
 } BlockZoneWps;
 
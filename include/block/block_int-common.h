@@ -379,6 +379,27 @@ struct BlockDriver {
     void (*bdrv_drain_begin)(BlockDriverState *bs);
     void (*bdrv_drain_end)(BlockDriverState *bs);
 
+    /**
+     * bdrv_drain_child_begin is called when @child enters a drained section.
+     * Returning true declares that the driver stops issuing new requests to
+     * @child on its own, typically by queuing incoming requests internally,
+     * and the drain then does not propagate to this node's parents. This
+     * keeps a drain below a filter node from quiescing guest devices on top
+     * of it. Returning false, or not implementing the callback, quiesces
+     * this node as a whole as usual.
+     *
+     * After bdrv_drain_child_begin returned true, bdrv_drain_child_poll is
+     * polled and must return true as long as the driver may still issue a
+     * request to @child. bdrv_drain_child_end, which is mandatory in that
+     * case, is called when @child leaves the drained section and must allow
+     * queued requests to resume.
+     *
+     * Implementations must not call aio_poll().
+     */
+    bool (*bdrv_drain_child_begin)(BlockDriverState *bs, BdrvChild *child);
+    bool (*bdrv_drain_child_poll)(BlockDriverState *bs, BdrvChild *child);
+    void (*bdrv_drain_child_end)(BlockDriverState *bs, BdrvChild *child);
+
     /**
      * Try to get @bs's logical and physical block size.
      * On success, store them in @bsz and return zero.
@@ -1044,6 +1065,13 @@ struct BdrvChild {
      */
     bool quiesced_parent;
 
+    /*
+     * True if the parent absorbed the current drained section of this child
+     * through BlockDriver.bdrv_drain_child_begin() instead of quiescing
+     * itself.
+     */
+    bool drained_independent;
+
     QLIST_ENTRY(BdrvChild GRAPH_RDLOCK_PTR) next;
     QLIST_ENTRY(BdrvChild GRAPH_RDLOCK_PTR) next_parent;
 };
@@ -1252,6 +1280,18 @@ struct BlockDriverState {
     /* Always non-NULL, but must only be dereferenced under an RCU read guard */
     BdrvBlockStatusCache *block_status_cache;
 
+    /*
+     * One-block cache for the read-modify-write cycle of writes that are
+     * not aligned to bl.request_alignment: holds the content of the
+     * aligned block most recently written through the padding slow path,
+     * so that a sequential stream of sub-alignment writes does not
+     * re-read the same block before every write.  Protected by
+     * reqs_lock; pad_cache_offset is -1 while the cache is empty.
+     */
+    int64_t pad_cache_offset;
+    uint32_t pad_cache_size;
+    uint8_t *pad_cache_buf;
+
     /* array of write pointers' location of each zone in the zoned device. */
     BlockZoneWps *wps;
 };
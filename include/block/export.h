@@ -48,6 +48,12 @@ typedef struct BlockExportDriver {
      * shutting down.
      */
     void (*request_shutdown)(BlockExport *);
+
+    /*
+     * Optionally fills in the request statistics fields of @info for
+     * query-block-exports. Called from the main thread.
+     */
+    void (*fill_info)(BlockExport *, BlockExportInfo *info);
 } BlockExportDriver;
 
 struct BlockExport {
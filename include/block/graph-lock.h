@@ -98,6 +98,17 @@ void register_aiocontext(AioContext *ctx);
  */
 void unregister_aiocontext(AioContext *ctx);
 
+/* Number of bins in the graph lock wait time log2 histograms */
+#define GRAPH_LOCK_WAIT_LOG2_NBINS 64
+
+/*
+ * bdrv_graph_lock_wait_histograms:
+ * Copy consistent snapshots of the reader and writer wait time log2
+ * histograms into @rd_bins and @wr_bins, each an array of
+ * GRAPH_LOCK_WAIT_LOG2_NBINS elements.
+ */
+void bdrv_graph_lock_wait_histograms(uint64_t *rd_bins, uint64_t *wr_bins);
+
 /*
  * bdrv_graph_wrlock:
  * Start an exclusive write operation to modify the graph. This means we are
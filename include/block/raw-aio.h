@@ -84,6 +84,14 @@ int coroutine_fn luring_co_submit(BlockDriverState *bs, int fd, uint64_t offset,
 void luring_detach_aio_context(LuringState *s, AioContext *old_context);
 void luring_attach_aio_context(LuringState *s, AioContext *new_context);
 bool luring_has_fua(void);
+
+/*
+ * Register a candidate io_uring fixed buffer (process-wide).  Requests
+ * that fall entirely within a registered buffer are submitted with
+ * IORING_OP_READ_FIXED/WRITE_FIXED, avoiding per-request page pinning.
+ */
+bool luring_register_buf(void *host, size_t size, Error **errp);
+void luring_unregister_buf(void *host, size_t size);
 #else
 static inline bool luring_has_fua(void)
 {
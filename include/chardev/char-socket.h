@@ -58,6 +58,10 @@ struct SocketChardev {
     int max_size;
     int do_telnetopt;
     int do_nodelay;
+    bool do_coalesce;
+    uint8_t *outbuf;
+    size_t outbuf_len;
+    GSource *flush_source;
     int *read_msgfds;
     size_t read_msgfds_num;
     int *write_msgfds;
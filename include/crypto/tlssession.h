@@ -216,6 +216,23 @@ void qcrypto_tls_session_set_callbacks(QCryptoTLSSession *sess,
                                        QCryptoTLSSessionReadFunc readFunc,
                                        void *opaque);
 
+/**
+ * qcrypto_tls_session_set_transport_fd:
+ * @sess: the TLS session object
+ * @fd: a socket file descriptor
+ *
+ * Hand the underlying socket to the TLS implementation, replacing any
+ * callbacks registered with qcrypto_tls_session_set_callbacks().  The
+ * implementation then performs its own I/O on @fd, which allows GnuTLS
+ * builds with kernel TLS support to offload the record layer to the
+ * kernel during the handshake; with userspace callbacks in place that
+ * offload can never be negotiated.  The caller remains responsible for
+ * the lifetime and blocking mode of @fd.
+ *
+ * This must be called before qcrypto_tls_session_handshake().
+ */
+void qcrypto_tls_session_set_transport_fd(QCryptoTLSSession *sess, int fd);
+
 /**
  * qcrypto_tls_session_write:
  * @sess: the TLS session object
@@ -45,5 +45,8 @@ void address_space_dispatch_free(AddressSpaceDispatch *d);
 
 void mtree_print_dispatch(struct AddressSpaceDispatch *d,
                           MemoryRegion *root);
+
+void address_space_init_bounce_pool(AddressSpace *as);
+void address_space_drain_bounce_pool(AddressSpace *as);
 #endif
 #endif
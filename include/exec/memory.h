@@ -775,6 +775,7 @@ struct MemoryRegion {
     bool nonvolatile;
     bool rom_device;
     bool flush_coalesced_mmio;
+    bool lockless_io;
     bool unmergeable;
     uint8_t dirty_log_mask;
     bool is_iommu;
@@ -1095,6 +1096,11 @@ typedef struct AddressSpaceMapClient {
 
 #define DEFAULT_MAX_BOUNCE_BUFFER_SIZE (4096)
 
+/* Number of bounce buffer size classes pooled per AddressSpace */
+#define BOUNCE_BUFFER_SIZE_CLASSES 8
+
+typedef struct BounceBuffer BounceBuffer;
+
 /**
  * struct AddressSpace: describes a mapping of addresses to #MemoryRegion objects
  */
@@ -1124,6 +1130,9 @@ struct AddressSpace {
     size_t max_bounce_buffer_size;
     /* Total size of bounce buffers currently allocated, atomically accessed */
     size_t bounce_buffer_size;
+    /* Size-classed freelists of returned bounce buffers */
+    QemuMutex bounce_pool_lock;
+    QSLIST_HEAD(, BounceBuffer) bounce_pool[BOUNCE_BUFFER_SIZE_CLASSES];
     /* List of callbacks to invoke when buffers free up */
     QemuMutex map_client_list_lock;
     QLIST_HEAD(, AddressSpaceMapClient) map_client_list;
@@ -2253,6 +2262,24 @@ void memory_region_set_flush_coalesced(MemoryRegion *mr);
  */
 void memory_region_clear_flush_coalesced(MemoryRegion *mr);
 
+/**
+ * memory_region_enable_lockless_io: Declare that accesses need not take
+ *                                   the BQL.
+ *
+ * Dispatch accesses to the region's read/write callbacks without
+ * acquiring the BQL and without the re-entrancy guard, so concurrent
+ * vCPUs are not serialized on the lock.  The callbacks must be safe to
+ * run concurrently with each other and with all other code that touches
+ * the device state: either they only read values that are updated
+ * atomically, or the device serializes with a lock of its own that is
+ * also taken everywhere else the state is used (timers, bottom halves,
+ * migration).  Raising an interrupt still requires the BQL and thus a
+ * lockless handler must not do it directly.
+ *
+ * @mr: the memory region to be updated.
+ */
+void memory_region_enable_lockless_io(MemoryRegion *mr);
+
 /**
  * memory_region_add_eventfd: Request an eventfd to be triggered when a word
  *                            is written to a location.
@@ -479,6 +479,12 @@ static inline void cpu_physical_memory_clear_dirty_range(ram_addr_t start,
 }
 
 
+/*
+ * Pages covered by one bit of RAMBlock.bmap_summary: one summary bit per
+ * full word of words of the dirty bitmap.
+ */
+#define BMAP_SUMMARY_PAGES (BITS_PER_LONG * BITS_PER_LONG)
+
 /* Called with RCU critical section */
 static inline
 uint64_t cpu_physical_memory_sync_dirty_bitmap(RAMBlock *rb,
@@ -509,6 +515,10 @@ uint64_t cpu_physical_memory_sync_dirty_bitmap(RAMBlock *rb,
             if (src[idx][offset]) {
                 unsigned long bits = qatomic_xchg(&src[idx][offset], 0);
                 unsigned long new_dirty;
+                if (rb->bmap_summary) {
+                    /* One summary bit covers BITS_PER_LONG words of dest */
+                    set_bit(k / BITS_PER_LONG, rb->bmap_summary);
+                }
                 new_dirty = ~dest[k];
                 dest[k] |= bits;
                 new_dirty &= bits;
@@ -548,6 +558,9 @@ uint64_t cpu_physical_memory_sync_dirty_bitmap(RAMBlock *rb,
                 if (!test_and_set_bit(k, dest)) {
                     num_dirty++;
                 }
+                if (rb->bmap_summary) {
+                    set_bit(k / BMAP_SUMMARY_PAGES, rb->bmap_summary);
+                }
             }
         }
     }
@@ -46,6 +46,18 @@ struct RAMBlock {
     size_t page_size;
     /* dirty bitmap used during migration */
     unsigned long *bmap;
+    /*
+     * Coarse summary of `bmap': one bit covers BMAP_SUMMARY_PAGES guest
+     * pages and is set whenever any of them may be dirty.  It is purely
+     * an accelerator for the dirty page scan: bits are set when dirty
+     * pages appear and lazily cleared once a scan finds the whole chunk
+     * clean, so a stale set bit only costs an extra chunk scan.
+     *
+     * It is only used during src side of ram migration, and it is
+     * protected by the global ram_state.bitmap_mutex.  NULL when unused
+     * (e.g. on the COLO incoming side).
+     */
+    unsigned long *bmap_summary;
 
     /*
      * Below fields are only used by mapped-ram migration
@@ -93,6 +93,14 @@ struct TranslationBlock {
 
     struct tb_tc tc;
 
+    /*
+     * Number of times this TB has been entered.  Maintained by the
+     * generated prologue when the "tb-exec-stats" accelerator property
+     * is enabled, zero otherwise.  Incremented non-atomically from
+     * multiple vCPU threads, so the count is approximate.
+     */
+    uint64_t exec_count;
+
     /*
      * Track tb_page_addr_t intervals that intersect this TB.
      * For user-only, the virtual addresses are always contiguous,
@@ -66,12 +66,24 @@ typedef struct SMMUPTWEventInfo {
     bool is_ipa_descriptor; /* src for fault in nested translation. */
 } SMMUPTWEventInfo;
 
+/*
+ * Walk cache entry: the page table reached at a given level on the most
+ * recent successful descent, like the walk caches of real SMMU
+ * implementations.  Conservatively dropped on every TLB invalidation.
+ */
+typedef struct SMMUPTWCacheEntry {
+    bool valid;
+    dma_addr_t va;             /* first iova covered by the table */
+    dma_addr_t table;          /* table base address */
+} SMMUPTWCacheEntry;
+
 typedef struct SMMUTransTableInfo {
     bool disabled;             /* is the translation table disabled? */
     uint64_t ttb;              /* TT base address */
     uint8_t tsz;               /* input range, ie. 2^(64 -tsz)*/
     uint8_t granule_sz;        /* granule page shift */
     bool had;                  /* hierarchical attribute disable */
+    SMMUPTWCacheEntry walk_cache[VMSA_LEVELS]; /* indexed by level */
 } SMMUTransTableInfo;
 
 typedef struct SMMUTLBEntry {
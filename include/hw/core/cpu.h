@@ -282,8 +282,21 @@ typedef struct CPUTLBDesc {
     /* maximum number of entries observed in the window */
     size_t window_max_entries;
     size_t n_used_entries;
+    /*
+     * Number of entries installed over the lifetime of this mmu_idx,
+     * i.e. the number of tlb_fill paths that completed.  Not lock
+     * protected; updated and read atomically so that the monitor can
+     * print a snapshot without interfering with the cpu.
+     */
+    size_t n_fills;
     /* The next index to use in the tlb victim table.  */
     size_t vindex;
+    /*
+     * True if any entry has been evicted into the victim table since
+     * the last flush of this mmu_idx; allows victim_tlb_hit() to skip
+     * the scan entirely while the table is known to be empty.
+     */
+    bool vactive;
     /* The tlb victim table, in two parts.  */
     CPUTLBEntry vtable[CPU_VTLB_SIZE];
     CPUTLBEntryFull vfulltlb[CPU_VTLB_SIZE];
@@ -447,6 +460,8 @@ struct qemu_work_item;
  *    ring is enabled.
  * @kvm_fetch_index: Keeps the index that we last fetched from the per-vCPU
  *    dirty ring structure.
+ * @kvm_mmio_cache: Cache of recent MMIO exit translations, used to skip the
+ *    flatview lookup for repeated accesses to the same device register.
  *
  * @neg_align: The CPUState is the common part of a concrete ArchCPU
  * which is allocated when an individual CPU instance is created. As
@@ -515,6 +530,12 @@ struct CPUState {
     QTAILQ_HEAD(, CPUBreakpoint) breakpoints;
 
     QTAILQ_HEAD(, CPUWatchpoint) watchpoints;
+    /*
+     * Union of all watchpoint ranges (inclusive), for a cheap overlap
+     * pre-check before walking the list; lo > hi when the list is empty.
+     */
+    vaddr watchpoints_lo;
+    vaddr watchpoints_hi;
     CPUWatchpoint *watchpoint_hit;
 
     void *opaque;
@@ -533,6 +554,7 @@ struct CPUState {
     uint64_t dirty_pages;
     int kvm_vcpu_stats_fd;
     bool vcpu_dirty;
+    struct KVMMmioCache *kvm_mmio_cache;
 
     /* Use by accel-block: CPU is executing an ioctl() */
     QemuLockCnt in_ioctl_lock;
@@ -1079,6 +1101,8 @@ void cpu_single_step(CPUState *cpu, int enabled);
 #define BP_MEM_WRITE          0x02
 #define BP_MEM_ACCESS         (BP_MEM_READ | BP_MEM_WRITE)
 #define BP_STOP_BEFORE_ACCESS 0x04
+/* Log the access as a trace event and continue instead of stopping */
+#define BP_WATCHPOINT_LOG     0x08
 /* 0x08 currently unused */
 #define BP_GDB                0x10
 #define BP_CPU                0x20
@@ -564,6 +564,20 @@ struct CXLType3Dev {
     /* DOE */
     DOECap doe_cdat;
 
+    /*
+     * HDM decoder parameters parsed out of the register file whenever a
+     * decoder is (un)committed, so the MMIO data path does not have to
+     * re-decode the registers on every access.
+     */
+    struct CXLHDMDecoderCache {
+        bool committed;
+        int iw;
+        int ig;
+        uint64_t base;
+        uint64_t size;
+        uint64_t dpa_base;
+    } hdm_cache[CXL_HDM_DECODER_COUNT];
+
     /* Error injection */
     CXLErrorList error_list;
 
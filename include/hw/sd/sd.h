@@ -114,6 +114,26 @@ struct SDCardClass {
      * Return: byte value read
      */
     uint8_t (*read_byte)(SDState *sd);
+    /**
+     * Write multiple bytes to a SD card (optional).
+     * @sd: card
+     * @buf: data to write
+     * @length: number of bytes to write
+     *
+     * Write multiple bytes on the data lines of a SD card in one
+     * call, equivalent to @length calls of write_byte.
+     */
+    void (*write_data)(SDState *sd, const uint8_t *buf, size_t length);
+    /**
+     * Read multiple bytes from a SD card (optional).
+     * @sd: card
+     * @buf: buffer to read data into
+     * @length: number of bytes to read
+     *
+     * Read multiple bytes from the data lines of a SD card in one
+     * call, equivalent to @length calls of read_byte.
+     */
+    void (*read_data)(SDState *sd, uint8_t *buf, size_t length);
     bool (*receive_ready)(SDState *sd);
     bool (*data_ready)(SDState *sd);
     void (*set_voltage)(SDState *sd, uint16_t millivolts);
@@ -50,6 +50,11 @@ struct VHostUserBlk {
     bool connected;
     /* vhost_user_blk_start/vhost_user_blk_stop */
     bool started_vu;
+    /*
+     * Host and guest notifiers are kept across a backend disconnect so
+     * the guest-visible device stays online while we reconnect.
+     */
+    bool notifiers_set;
 };
 
 #endif
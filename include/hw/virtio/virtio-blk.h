@@ -104,7 +104,8 @@ typedef struct VirtIOBlkClass {
     /*< private >*/
     VirtioDeviceClass parent;
     /*< public >*/
-    bool (*handle_unknown_request)(VirtIOBlockReq *req, MultiReqBuffer *mrb,
+    /* @mrbs is indexed by request direction: 0 for reads, 1 for writes */
+    bool (*handle_unknown_request)(VirtIOBlockReq *req, MultiReqBuffer *mrbs,
                                    uint32_t type);
 } VirtIOBlkClass;
 
@@ -201,6 +201,10 @@ struct VirtIOGPU {
 
     bool processing_cmdq;
 
+    /* Coalesce ctrl queue notifications while a batch of responses drains */
+    bool notify_batched;
+    bool notify_pending;
+
     uint32_t inflight;
     struct {
         uint32_t max_inflight;
@@ -115,6 +115,13 @@ struct VirtIOMEM {
      */
     bool dynamic_memslots;
 
+    /*
+     * Large unplug requests discard their range on a worker thread; the
+     * guest's request element is held back until the worker completes.
+     */
+    VirtQueueElement *async_unplug_elem;
+    bool async_unplug_inflight;
+
     /* notifiers to notify when "size" changes */
     NotifierList size_change_notifiers;
 
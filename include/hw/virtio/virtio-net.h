@@ -14,6 +14,7 @@
 #ifndef QEMU_VIRTIO_NET_H
 #define QEMU_VIRTIO_NET_H
 
+#include "qapi/qapi-types-virtio.h"
 #include "qemu/units.h"
 #include "standard-headers/linux/virtio_net.h"
 #include "hw/virtio/virtio.h"
@@ -227,6 +228,10 @@ struct VirtIONet {
     struct EBPFRSSContext ebpf_rss;
     uint32_t nr_ebpf_rss_fds;
     char **ebpf_rss_fds;
+    IOThreadVirtQueueMappingList *iothread_vq_mapping_list;
+    /* One AioContext per TX/RX queue pair, NULL without iothread-vq-mapping */
+    AioContext **vq_aio_context;
+    bool vq_ctx_attached;
 };
 
 size_t virtio_net_handle_ctrl_iov(VirtIODevice *vdev,
@@ -119,6 +119,19 @@ typedef struct VirtIOPCIRegion {
     uint32_t type;
 } VirtIOPCIRegion;
 
+/* Interrupt moderation state for one MSI-X vector */
+typedef struct VirtIOPCIVectorCoalesce {
+    struct VirtIOPCIProxy *proxy;
+    QEMUTimer *timer;
+    uint16_t vector;
+    /* Hold-off in progress; notifications collapse into @pending */
+    bool armed;
+    bool pending;
+    int64_t last_notify_ns;
+    /* Exponential moving average of the inter-notification gap */
+    int64_t avg_gap_ns;
+} VirtIOPCIVectorCoalesce;
+
 typedef struct VirtIOPCIQueue {
   uint16_t num;
   bool enabled;
@@ -170,6 +183,9 @@ struct VirtIOPCIProxy {
 
     VirtIOIRQFD *vector_irqfd;
     int nvqs_with_notifiers;
+    /* MSI-X moderation, one entry per vector; NULL when disabled */
+    VirtIOPCIVectorCoalesce *vector_coalesce;
+    uint32_t notify_holdoff_ns;
     VirtioBusState bus;
 };
 
@@ -270,6 +270,21 @@ void virtqueue_fill(VirtQueue *vq, const VirtQueueElement *elem,
 
 void virtqueue_map(VirtIODevice *vdev, VirtQueueElement *elem);
 void *virtqueue_pop(VirtQueue *vq, size_t sz);
+/*
+ * virtqueue_pop_batch:
+ * @vq: The #VirtQueue
+ * @sz: The size of each element, at least sizeof(VirtQueueElement)
+ * @elems: Array to fill with popped elements
+ * @max_elems: The length of @elems
+ *
+ * Pop up to @max_elems elements in one pass, snapshotting the available
+ * ring window once instead of re-reading the available index and issuing
+ * memory barriers for every element as a virtqueue_pop() loop would.
+ *
+ * Returns the number of elements popped.
+ */
+unsigned virtqueue_pop_batch(VirtQueue *vq, size_t sz,
+                             VirtQueueElement **elems, unsigned max_elems);
 unsigned int virtqueue_drop_all(VirtQueue *vq);
 void *qemu_get_virtqueue_element(VirtIODevice *vdev, QEMUFile *f, size_t sz);
 void qemu_put_virtqueue_element(VirtIODevice *vdev, QEMUFile *f,
@@ -413,6 +428,13 @@ EventNotifier *virtio_queue_get_guest_notifier(VirtQueue *vq);
 void virtio_queue_set_guest_notifier_fd_handler(VirtQueue *vq, bool assign,
                                                 bool with_irqfd);
 int virtio_device_start_ioeventfd(VirtIODevice *vdev);
+/*
+ * Default ->start_ioeventfd()/->stop_ioeventfd() implementations.  Exported
+ * for devices that override the hooks but still want the generic host
+ * notifier setup before adjusting it (e.g. moving queues to IOThreads).
+ */
+int virtio_device_start_ioeventfd_impl(VirtIODevice *vdev);
+void virtio_device_stop_ioeventfd_impl(VirtIODevice *vdev);
 int virtio_device_grab_ioeventfd(VirtIODevice *vdev);
 void virtio_device_release_ioeventfd(VirtIODevice *vdev);
 bool virtio_device_ioeventfd_enabled(VirtIODevice *vdev);
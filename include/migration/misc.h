@@ -40,6 +40,7 @@ void precopy_remove_notifier(NotifierWithReturn *n);
 int precopy_notify(PrecopyNotifyReason reason, Error **errp);
 
 void qemu_guest_free_page_hint(void *addr, size_t len);
+void qemu_guest_free_page_hints(const struct iovec *iov, unsigned int iov_cnt);
 bool migrate_ram_is_ignored(RAMBlock *block);
 
 /* migration/block.c */
@@ -126,6 +127,11 @@ typedef struct SaveLiveCompletePrecopyThreadData {
     void *handler_opaque;
 } SaveLiveCompletePrecopyThreadData;
 
+/*
+ * Queue a device state buffer for transmission on a multifd channel.
+ * Takes ownership of the heap-allocated @data, which is freed once
+ * transferred (or on failure).
+ */
 bool multifd_queue_device_state(char *idstr, uint32_t instance_id,
                                 char *data, size_t len);
 bool multifd_device_state_supported(void);
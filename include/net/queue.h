@@ -32,6 +32,12 @@ typedef void (NetPacketSent) (NetClientState *sender, ssize_t ret);
 
 #define QEMU_NET_PACKET_FLAG_NONE  0
 #define QEMU_NET_PACKET_FLAG_RAW  (1<<0)
+/*
+ * Queue a reference to the sender's buffers instead of copying them.
+ * Requires a sent callback; the sender must keep the buffers valid and
+ * unmodified until it is invoked.
+ */
+#define QEMU_NET_PACKET_FLAG_ZERO_COPY  (1<<1)
 
 /* Returns:
  *   >0 - success
@@ -71,6 +71,15 @@ struct Coroutine {
 
 Coroutine *qemu_coroutine_new(void);
 void qemu_coroutine_delete(Coroutine *co);
+
+/*
+ * Hint that a terminated coroutine will sit in the pool for a while.
+ * The backend may let the host lazily reclaim the cold part of the
+ * coroutine's stack; state that is needed to re-enter the coroutine on
+ * reuse is preserved.  Must not be called once the coroutine is
+ * visible to other threads.
+ */
+void qemu_coroutine_stack_release_hint(Coroutine *co);
 CoroutineAction qemu_coroutine_switch(Coroutine *from, Coroutine *to,
                                       CoroutineAction action);
 
@@ -0,0 +1,58 @@
+/*
+ * Always-on counters for hot paths
+ *
+ * Counters are cumulative 64-bit values cheap enough to bump on fast
+ * paths (see qemu/stats64.h for the underlying primitive).  They are
+ * reported by the "builtin" provider of the query-stats QMP command.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * later.  See the COPYING file in the top-level directory.
+ */
+
+#ifndef QEMU_COUNTER_H
+#define QEMU_COUNTER_H
+
+#include "qemu/stats64.h"
+
+typedef struct QemuCounter {
+    Stat64 value;
+    const char *name;
+    struct QemuCounter *next;
+} QemuCounter;
+
+/*
+ * Define and register a counter local to the defining file.  @name_str
+ * must be unique across the binary; registration runs from a
+ * constructor, before main().
+ */
+#define QEMU_COUNTER_DEFINE(var, name_str)                              \
+    static QemuCounter var = { .name = name_str };                      \
+    static void __attribute__((constructor)) var##_register(void)       \
+    {                                                                   \
+        qemu_counter_register(&var);                                    \
+    }
+
+void qemu_counter_register(QemuCounter *counter);
+
+/*
+ * Iterate over registered counters: pass NULL to get the first one,
+ * the previous return value to get the next, NULL marks the end.
+ */
+QemuCounter *qemu_counter_next(QemuCounter *counter);
+
+static inline void qemu_counter_add(QemuCounter *counter, uint64_t value)
+{
+    stat64_add(&counter->value, value);
+}
+
+static inline void qemu_counter_inc(QemuCounter *counter)
+{
+    qemu_counter_add(counter, 1);
+}
+
+static inline uint64_t qemu_counter_get(QemuCounter *counter)
+{
+    return stat64_get(&counter->value);
+}
+
+#endif /* QEMU_COUNTER_H */
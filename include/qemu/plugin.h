@@ -70,6 +70,7 @@ enum plugin_dyn_cb_type {
     PLUGIN_CB_REGULAR,
     PLUGIN_CB_COND,
     PLUGIN_CB_MEM_REGULAR,
+    PLUGIN_CB_MEM_FILTER,
     PLUGIN_CB_INLINE_ADD_U64,
     PLUGIN_CB_INLINE_STORE_U64,
 };
@@ -96,6 +97,16 @@ struct qemu_plugin_conditional_cb {
     uint64_t imm;
 };
 
+/* A regular memory callback made only for accesses inside [lo, hi) */
+struct qemu_plugin_mem_filter_cb {
+    union qemu_plugin_cb_sig f;
+    TCGHelperInfo *info;
+    void *userp;
+    enum qemu_plugin_mem_rw rw;
+    uint64_t lo;
+    uint64_t hi;
+};
+
 /*
  * A dynamic callback has an insertion point that is determined at run-time.
  * Usually the insertion point is somewhere in the code cache; think for
@@ -106,6 +117,7 @@ struct qemu_plugin_dyn_cb {
     union {
         struct qemu_plugin_regular_cb regular;
         struct qemu_plugin_conditional_cb cond;
+        struct qemu_plugin_mem_filter_cb mem_filter;
         struct qemu_plugin_inline_cb inline_insn;
     };
 };
@@ -65,11 +65,15 @@ typedef uint64_t qemu_plugin_id_t;
  *
  * version 4:
  * - added qemu_plugin_read_memory_vaddr
+ *
+ * version 5:
+ * - added qemu_plugin_register_vcpu_mem_batch_cb
+ * - added qemu_plugin_register_vcpu_mem_filter_cb
  */
 
 extern QEMU_PLUGIN_EXPORT int qemu_plugin_version;
 
-#define QEMU_PLUGIN_VERSION 4
+#define QEMU_PLUGIN_VERSION 5
 
 /**
  * struct qemu_info_t - system information for plugins
@@ -701,6 +705,87 @@ void qemu_plugin_register_vcpu_mem_inline_per_vcpu(
     qemu_plugin_u64 entry,
     uint64_t imm);
 
+/**
+ * qemu_plugin_register_vcpu_mem_filter_cb() - address-filtered memory callback
+ * @insn: handle for instruction to instrument
+ * @cb: callback of type qemu_plugin_vcpu_mem_cb_t
+ * @flags: (currently unused) callback flags
+ * @rw: monitor reads, writes or both
+ * @lo: lowest virtual address of interest
+ * @hi: end of the range of interest (exclusive, must be greater than @lo)
+ * @userdata: opaque pointer for userdata
+ *
+ * Like qemu_plugin_register_vcpu_mem_cb(), but the access address is
+ * compared against [@lo, @hi) in the generated code and the callback
+ * is only made for accesses inside the range. A plugin watching a
+ * small region pays a two-instruction filter per access instead of a
+ * full callback.
+ */
+QEMU_PLUGIN_API
+void qemu_plugin_register_vcpu_mem_filter_cb(struct qemu_plugin_insn *insn,
+                                             qemu_plugin_vcpu_mem_cb_t cb,
+                                             enum qemu_plugin_cb_flags flags,
+                                             enum qemu_plugin_mem_rw rw,
+                                             uint64_t lo, uint64_t hi,
+                                             void *userdata);
+
+/**
+ * typedef qemu_plugin_mem_record - one buffered memory access
+ * @vaddr: the virtual address of the transaction
+ * @info: an opaque handle for further queries about the memory
+ *
+ * The @info handle can be decoded with qemu_plugin_mem_size_shift()
+ * and friends, but does not support qemu_plugin_get_hwaddr() or
+ * qemu_plugin_mem_get_value(), which are only valid while the access
+ * is in flight.
+ */
+typedef struct {
+    uint64_t vaddr;
+    qemu_plugin_meminfo_t info;
+} qemu_plugin_mem_record;
+
+/**
+ * typedef qemu_plugin_vcpu_mem_batch_cb_t - batched memory callback type
+ * @vcpu_index: the executing vCPU
+ * @records: array of buffered accesses, in execution order
+ * @count: number of valid entries in @records
+ * @userdata: any user data attached to the callback
+ *
+ * The @records array is only valid for the duration of the callback.
+ */
+typedef void (*qemu_plugin_vcpu_mem_batch_cb_t) (unsigned int vcpu_index,
+                                                 const qemu_plugin_mem_record *records,
+                                                 size_t count,
+                                                 void *userdata);
+
+/**
+ * qemu_plugin_register_vcpu_mem_batch_cb() - register batched memory callback
+ * @insn: handle for instruction to instrument
+ * @cb: callback of type qemu_plugin_vcpu_mem_batch_cb_t
+ * @flags: (currently unused) callback flags
+ * @rw: monitor reads, writes or both
+ * @userdata: opaque pointer for userdata
+ *
+ * Like qemu_plugin_register_vcpu_mem_cb(), but instead of one call per
+ * access the accesses are accumulated in a per-vCPU buffer which is
+ * handed to the plugin roughly once per thousand accesses. This
+ * amortises the cost of crossing into the plugin and makes heavyweight
+ * consumers such as cache models viable on hot paths.
+ *
+ * Registrations with the same @cb and @userdata share one buffer, so a
+ * plugin instrumenting every instruction receives each vCPU's accesses
+ * as a single interleaved stream in execution order. Partially filled
+ * buffers are delivered when a vCPU exits and before atexit callbacks
+ * run; until then delivery is deferred, so the callback must not
+ * assume it runs close in time to the access.
+ */
+QEMU_PLUGIN_API
+void qemu_plugin_register_vcpu_mem_batch_cb(struct qemu_plugin_insn *insn,
+                                            qemu_plugin_vcpu_mem_batch_cb_t cb,
+                                            enum qemu_plugin_cb_flags flags,
+                                            enum qemu_plugin_mem_rw rw,
+                                            void *userdata);
+
 /**
  * qemu_plugin_request_time_control() - request the ability to control time
  *
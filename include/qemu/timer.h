@@ -86,7 +86,9 @@ struct QEMUTimer {
     QEMUTimerList *timer_list;
     QEMUTimerCB *cb;
     void *opaque;
-    QEMUTimer *next;
+    size_t heap_idx;            /* index in the timer list's pending heap,
+                                 * valid while expire_time != -1 */
+    uint64_t heap_seq;          /* insertion order, breaks expire_time ties */
     int attributes;
     int scale;
 };
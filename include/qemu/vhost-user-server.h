@@ -24,6 +24,7 @@ typedef struct VuFdWatch {
     int fd; /*kick fd*/
     void *pvt;
     vu_watch_cb cb;
+    VuVirtq *vq; /* the virtqueue kicked through fd, used for polling */
     QTAILQ_ENTRY(VuFdWatch) next;
 } VuFdWatch;
 
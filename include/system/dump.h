@@ -33,6 +33,8 @@
 #define DUMP_DH_COMPRESSED_ZLIB     (0x1)
 #define DUMP_DH_COMPRESSED_LZO      (0x2)
 #define DUMP_DH_COMPRESSED_SNAPPY   (0x4)
+/* 0x8 is DUMP_DH_COMPRESSED_INCOMPLETE in makedumpfile */
+#define DUMP_DH_COMPRESSED_ZSTD     (0x10)
 
 #define KDUMP_SIGNATURE             "KDUMP   "
 #define SIG_LEN                     (sizeof(KDUMP_SIGNATURE) - 1)
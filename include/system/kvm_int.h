@@ -99,6 +99,7 @@ struct KVMDirtyRingReaper {
     QemuThread reaper_thr;
     volatile uint64_t reaper_iteration; /* iteration number of reaper thr */
     volatile enum KVMDirtyRingReaperState reaper_state; /* reap thr state */
+    uint32_t reaper_max_fill; /* largest per-vCPU count of the last reap */
 };
 struct KVMState
 {
@@ -635,6 +635,20 @@ TranslationBlock *tcg_tb_alloc(TCGContext *s);
 
 void tcg_region_reset_all(void);
 
+/**
+ * tcg_region_reclaim:
+ * @s: TCG context that has exhausted the region pool
+ *
+ * Recycle one full code-gen region that no context is currently
+ * translating into and assign it to @s.  Must be called from a
+ * safe-work context.
+ *
+ * Returns: the translation blocks still living in the recycled region,
+ * to be invalidated and tcg_tb_remove()d by the caller, or NULL if
+ * every region is in use.
+ */
+GPtrArray *tcg_region_reclaim(TCGContext *s);
+
 size_t tcg_code_size(void);
 size_t tcg_code_capacity(void);
 
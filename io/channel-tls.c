@@ -22,6 +22,7 @@
 #include "qapi/error.h"
 #include "qemu/module.h"
 #include "io/channel-tls.h"
+#include "io/channel-socket.h"
 #include "trace.h"
 #include "qemu/atomic.h"
 
@@ -60,6 +61,23 @@ static ssize_t qio_channel_tls_read_handler(char *buf,
     return ret;
 }
 
+/*
+ * When the master channel is a bare socket, hand its fd to the TLS
+ * library so that GnuTLS builds with kernel TLS support can offload
+ * the record layer during the handshake; with the userspace
+ * read/write handlers in place that offload can never be negotiated.
+ * Layered masters (e.g. an exec: migration channel) keep the handlers.
+ */
+static void qio_channel_tls_set_transport(QIOChannelTLS *tioc)
+{
+    QIOChannelSocket *sioc = (QIOChannelSocket *)
+        object_dynamic_cast(OBJECT(tioc->master), TYPE_QIO_CHANNEL_SOCKET);
+
+    if (sioc && sioc->fd >= 0) {
+        qcrypto_tls_session_set_transport_fd(tioc->session, sioc->fd);
+    }
+}
+
 
 QIOChannelTLS *
 qio_channel_tls_new_server(QIOChannel *master,
@@ -95,6 +113,7 @@ qio_channel_tls_new_server(QIOChannel *master,
         qio_channel_tls_write_handler,
         qio_channel_tls_read_handler,
         tioc);
+    qio_channel_tls_set_transport(tioc);
 
     trace_qio_channel_tls_new_server(tioc, master, creds, aclname);
     return tioc;
@@ -138,6 +157,7 @@ qio_channel_tls_new_client(QIOChannel *master,
         qio_channel_tls_write_handler,
         qio_channel_tls_read_handler,
         tioc);
+    qio_channel_tls_set_transport(tioc);
 
     trace_qio_channel_tls_new_client(tioc, master, creds, hostname);
     return tioc;
@@ -356,7 +356,9 @@ static int query_one_iothread(Object *object, void *opaque)
     info->poll_max_ns = iothread->poll_max_ns;
     info->poll_grow = iothread->poll_grow;
     info->poll_shrink = iothread->poll_shrink;
+    info->poll_ns = aio_context_get_poll_ns(iothread->ctx);
     info->aio_max_batch = iothread->parent_obj.aio_max_batch;
+    info->cpu_ns = aio_context_get_cpu_ns(iothread->ctx);
 
     QAPI_LIST_APPEND(*tail, info);
     return 0;
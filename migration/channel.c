@@ -21,6 +21,7 @@
 #include "io/channel-socket.h"
 #include "qemu/yank.h"
 #include "yank_functions.h"
+#include "options.h"
 
 /**
  * @migration_channel_process_incoming - Create new incoming migration channel
@@ -87,6 +88,17 @@ void migration_channel_connect(MigrationState *s,
         } else {
             QEMUFile *f = qemu_file_new_output(ioc);
 
+            /*
+             * Without multifd the main channel carries the RAM pages
+             * themselves, so it is the one that benefits from zero copy.
+             * With multifd the channels enable it individually instead.
+             */
+            if (migrate_zero_copy_send() && !migrate_multifd() &&
+                qio_channel_has_feature(ioc,
+                                        QIO_CHANNEL_FEATURE_WRITE_ZERO_COPY)) {
+                qemu_file_set_zero_copy(f);
+            }
+
             migration_ioc_register_yank(ioc);
 
             qemu_mutex_lock(&s->qemu_file_lock);
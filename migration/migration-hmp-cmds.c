@@ -314,6 +314,9 @@ void hmp_info_migrate_parameters(Monitor *mon, const QDict *qdict)
         monitor_printf(mon, "%s: '%s'\n",
             MigrationParameter_str(MIGRATION_PARAMETER_TLS_AUTHZ),
             params->tls_authz);
+        monitor_printf(mon, "%s: '%s'\n",
+            MigrationParameter_str(MIGRATION_PARAMETER_MULTIFD_THREAD_CONTEXT),
+            params->multifd_thread_context);
 
         if (params->has_block_bitmap_mapping) {
             const BitmapMigrationNodeAliasList *bmnal;
@@ -533,6 +536,11 @@ void hmp_migrate_set_parameter(Monitor *mon, const QDict *qdict)
         p->tls_authz->type = QTYPE_QSTRING;
         visit_type_str(v, param, &p->tls_authz->u.s, &err);
         break;
+    case MIGRATION_PARAMETER_MULTIFD_THREAD_CONTEXT:
+        p->multifd_thread_context = g_new0(StrOrNull, 1);
+        p->multifd_thread_context->type = QTYPE_QSTRING;
+        visit_type_str(v, param, &p->multifd_thread_context->u.s, &err);
+        break;
     case MIGRATION_PARAMETER_MAX_BANDWIDTH:
         p->has_max_bandwidth = true;
         /*
@@ -2964,6 +2964,15 @@ static int migration_completion_precopy(MigrationState *s)
     }
 
     ret = qemu_savevm_state_complete_precopy(s->to_dst_file, false);
+
+    /*
+     * Wait for in-flight zero copy sends to finish before declaring the
+     * migration complete; no-op unless zero copy is in use on the main
+     * channel.
+     */
+    if (!ret && qemu_file_flush_zero_copy(s->to_dst_file) < 0) {
+        ret = -EIO;
+    }
 out_unlock:
     bql_unlock();
     return ret;
@@ -11,7 +11,6 @@
 
 #include "qemu/osdep.h"
 #include "qapi/error.h"
-#include "qemu/lockable.h"
 #include "block/thread-pool.h"
 #include "migration.h"
 #include "migration/misc.h"
@@ -19,10 +18,6 @@
 #include "options.h"
 
 static struct {
-    QemuMutex queue_job_mutex;
-
-    MultiFDSendData *send_data;
-
     ThreadPool *threads;
     bool threads_abort;
 } *multifd_send_device_state;
@@ -32,10 +27,6 @@ void multifd_device_state_send_setup(void)
     assert(!multifd_send_device_state);
     multifd_send_device_state = g_malloc(sizeof(*multifd_send_device_state));
 
-    qemu_mutex_init(&multifd_send_device_state->queue_job_mutex);
-
-    multifd_send_device_state->send_data = multifd_send_data_alloc();
-
     multifd_send_device_state->threads = thread_pool_new();
     multifd_send_device_state->threads_abort = false;
 }
@@ -43,10 +34,6 @@ void multifd_device_state_send_setup(void)
 void multifd_device_state_send_cleanup(void)
 {
     g_clear_pointer(&multifd_send_device_state->threads, thread_pool_free);
-    g_clear_pointer(&multifd_send_device_state->send_data,
-                    multifd_send_data_free);
-
-    qemu_mutex_destroy(&multifd_send_device_state->queue_job_mutex);
 
     g_clear_pointer(&multifd_send_device_state, g_free);
 }
@@ -101,26 +88,34 @@ void multifd_device_state_send_prepare(MultiFDSendParams *p)
 bool multifd_queue_device_state(char *idstr, uint32_t instance_id,
                                 char *data, size_t len)
 {
-    /* Device state submissions can come from multiple threads */
-    QEMU_LOCK_GUARD(&multifd_send_device_state->queue_job_mutex);
+    /*
+     * Each submission gets its own payload instead of sharing one job
+     * slot, so device state save threads only serialize on the channel
+     * lookup inside multifd_send() instead of blocking each other for
+     * the whole duration of a channel becoming free.
+     */
+    MultiFDSendData *send_data = multifd_send_data_alloc();
     MultiFDDeviceState_t *device_state;
+    bool ret;
 
-    assert(multifd_payload_empty(multifd_send_device_state->send_data));
-
-    multifd_set_payload_type(multifd_send_device_state->send_data,
-                             MULTIFD_PAYLOAD_DEVICE_STATE);
-    device_state = &multifd_send_device_state->send_data->u.device_state;
+    multifd_set_payload_type(send_data, MULTIFD_PAYLOAD_DEVICE_STATE);
+    device_state = &send_data->u.device_state;
     device_state->idstr = g_strdup(idstr);
     device_state->instance_id = instance_id;
-    device_state->buf = g_memdup2(data, len);
+    /* Ownership of @data transfers to the channel (or is freed on error) */
+    device_state->buf = data;
     device_state->buf_len = len;
 
-    if (!multifd_send(&multifd_send_device_state->send_data)) {
-        multifd_send_data_clear(multifd_send_device_state->send_data);
-        return false;
-    }
+    ret = multifd_send(&send_data);
+
+    /*
+     * On success this is the empty slot received back from the channel,
+     * on failure it still holds the payload and free'ing it also
+     * releases @data.
+     */
+    multifd_send_data_free(send_data);
 
-    return true;
+    return ret;
 }
 
 bool multifd_device_state_supported(void)
@@ -37,6 +37,14 @@ static void swap_page_offset(ram_addr_t *pages_offset, int a, int b)
     pages_offset[b] = temp;
 }
 
+/*
+ * Scan up to this many contiguous pages with a single buffer_is_zero()
+ * call.  Pages are collected in ascending order, so most batches cover
+ * one contiguous range and the scan runs as one long streaming load
+ * instead of a call with head/tail handling per page.
+ */
+#define ZERO_PAGE_SCAN_BATCH 64
+
 /**
  * multifd_send_zero_page_detect: Perform zero page detection on all pages.
  *
@@ -49,6 +57,9 @@ void multifd_send_zero_page_detect(MultiFDSendParams *p)
 {
     MultiFDPages_t *pages = &p->data->u.ram;
     RAMBlock *rb = pages->block;
+    uint32_t page_size = multifd_ram_page_size();
+    uint64_t zero_run_start = 0, zero_run_end = 0;
+    uint64_t mixed_run_end = 0;
     int i = 0;
     int j = pages->num - 1;
 
@@ -63,8 +74,41 @@ void multifd_send_zero_page_detect(MultiFDSendParams *p)
      */
     while (i <= j) {
         uint64_t offset = pages->offset[i];
+        bool zero;
+
+        if (offset >= zero_run_start && offset < zero_run_end) {
+            /* Covered by a previous all-zero batch scan */
+            zero = true;
+        } else {
+            int run = 1;
+
+            /*
+             * Entries (i, j] are still in their original ascending order;
+             * batch up a contiguous run of them.  Ranges that a batch scan
+             * already found to contain data are re-scanned page by page so
+             * that no page is read more than twice.
+             */
+            if (offset >= mixed_run_end) {
+                while (run < ZERO_PAGE_SCAN_BATCH && i + run <= j &&
+                       pages->offset[i + run] == offset + run * page_size) {
+                    run++;
+                }
+            }
+
+            if (run > 1 && buffer_is_zero(rb->host + offset,
+                                          run * page_size)) {
+                zero = true;
+                zero_run_start = offset;
+                zero_run_end = offset + run * page_size;
+            } else {
+                if (run > 1) {
+                    mixed_run_end = offset + run * page_size;
+                }
+                zero = buffer_is_zero(rb->host + offset, page_size);
+            }
+        }
 
-        if (!buffer_is_zero(rb->host + offset, multifd_ram_page_size())) {
+        if (!zero) {
             i++;
             continue;
         }
@@ -86,7 +130,7 @@ void multifd_recv_zero_page_process(MultiFDRecvParams *p)
     for (int i = 0; i < p->zero_num; i++) {
         void *page = p->host + p->zero[i];
         if (ramblock_recv_bitmap_test_byte_offset(p->block, p->zero[i])) {
-            memset(page, 0, multifd_ram_page_size());
+            ram_handle_zero(page, multifd_ram_page_size());
         } else {
             ramblock_recv_bitmap_set_offset(p->block, p->zero[i]);
         }
@@ -31,6 +31,7 @@
 #include "multifd.h"
 #include "threadinfo.h"
 #include "options.h"
+#include "qemu/thread-context.h"
 #include "qemu/yank.h"
 #include "io/channel-file.h"
 #include "io/channel-socket.h"
@@ -807,6 +808,35 @@ static void *multifd_tls_handshake_thread(void *opaque)
     return NULL;
 }
 
+/*
+ * Create a multifd channel thread.  When the multifd-thread-context
+ * parameter names a thread-context object, the thread is created inside
+ * that context and inherits its CPU affinity, so that channel threads
+ * can be pinned to the NUMA node of the NIC they use.
+ */
+static void multifd_thread_create(QemuThread *thread, const char *name,
+                                  void *(*start_routine)(void *), void *arg)
+{
+    const char *tc_name = migrate_multifd_thread_context();
+
+    if (tc_name && tc_name[0]) {
+        Object *obj = object_resolve_path_component(object_get_objects_root(),
+                                                    tc_name);
+        ThreadContext *tc =
+            (ThreadContext *)object_dynamic_cast(obj, TYPE_THREAD_CONTEXT);
+
+        if (tc) {
+            thread_context_create_thread(tc, thread, name, start_routine, arg,
+                                         QEMU_THREAD_JOINABLE);
+            return;
+        }
+        warn_report_once("multifd-thread-context '%s' is not a thread-context "
+                         "object, channel threads are not pinned", tc_name);
+    }
+
+    qemu_thread_create(thread, name, start_routine, arg, QEMU_THREAD_JOINABLE);
+}
+
 static bool multifd_tls_channel_connect(MultiFDSendParams *p,
                                         QIOChannel *ioc,
                                         Error **errp)
@@ -834,9 +864,8 @@ static bool multifd_tls_channel_connect(MultiFDSendParams *p,
     args->p = p;
 
     p->tls_thread_created = true;
-    qemu_thread_create(&p->tls_thread, MIGRATION_THREAD_SRC_TLS,
-                       multifd_tls_handshake_thread, args,
-                       QEMU_THREAD_JOINABLE);
+    multifd_thread_create(&p->tls_thread, MIGRATION_THREAD_SRC_TLS,
+                          multifd_tls_handshake_thread, args);
     return true;
 }
 
@@ -849,8 +878,7 @@ void multifd_channel_connect(MultiFDSendParams *p, QIOChannel *ioc)
     p->c = ioc;
 
     p->thread_created = true;
-    qemu_thread_create(&p->thread, p->name, multifd_send_thread, p,
-                       QEMU_THREAD_JOINABLE);
+    multifd_thread_create(&p->thread, p->name, multifd_send_thread, p);
 }
 
 /*
@@ -1548,7 +1576,6 @@ void multifd_recv_new_channel(QIOChannel *ioc, Error **errp)
     object_ref(OBJECT(ioc));
 
     p->thread_created = true;
-    qemu_thread_create(&p->thread, p->name, multifd_recv_thread, p,
-                       QEMU_THREAD_JOINABLE);
+    multifd_thread_create(&p->thread, p->name, multifd_recv_thread, p);
     qatomic_inc(&multifd_recv_state->count);
 }
@@ -20,6 +20,7 @@
 #include "qapi/qapi-visit-migration.h"
 #include "qapi/qmp/qerror.h"
 #include "qobject/qnull.h"
+#include "qemu/thread-context.h"
 #include "system/runstate.h"
 #include "migration/colo.h"
 #include "migration/cpr.h"
@@ -165,6 +166,8 @@ const Property migration_properties[] = {
     DEFINE_PROP_STRING("tls-creds", MigrationState, parameters.tls_creds),
     DEFINE_PROP_STRING("tls-hostname", MigrationState, parameters.tls_hostname),
     DEFINE_PROP_STRING("tls-authz", MigrationState, parameters.tls_authz),
+    DEFINE_PROP_STRING("multifd-thread-context", MigrationState,
+                       parameters.multifd_thread_context),
     DEFINE_PROP_UINT64("x-vcpu-dirty-limit-period", MigrationState,
                        parameters.x_vcpu_dirty_limit_period,
                        DEFAULT_MIGRATE_VCPU_DIRTY_LIMIT_PERIOD),
@@ -201,6 +204,7 @@ const Property migration_properties[] = {
                         MIGRATION_CAPABILITY_SWITCHOVER_ACK),
     DEFINE_PROP_MIG_CAP("x-dirty-limit", MIGRATION_CAPABILITY_DIRTY_LIMIT),
     DEFINE_PROP_MIG_CAP("mapped-ram", MIGRATION_CAPABILITY_MAPPED_RAM),
+    DEFINE_PROP_MIG_CAP("x-auto-tune", MIGRATION_CAPABILITY_AUTO_TUNE),
 };
 const size_t migration_properties_count = ARRAY_SIZE(migration_properties);
 
@@ -211,6 +215,13 @@ bool migrate_auto_converge(void)
     return s->capabilities[MIGRATION_CAPABILITY_AUTO_CONVERGE];
 }
 
+bool migrate_auto_tune(void)
+{
+    MigrationState *s = migrate_get_current();
+
+    return s->capabilities[MIGRATION_CAPABILITY_AUTO_TUNE];
+}
+
 bool migrate_send_switchover_start(void)
 {
     MigrationState *s = migrate_get_current();
@@ -533,12 +544,13 @@ bool migrate_caps_check(bool *old_caps, bool *new_caps, Error **errp)
 
 #ifdef CONFIG_LINUX
     if (new_caps[MIGRATION_CAPABILITY_ZERO_COPY_SEND] &&
-        (!new_caps[MIGRATION_CAPABILITY_MULTIFD] ||
-         new_caps[MIGRATION_CAPABILITY_XBZRLE] ||
-         migrate_multifd_compression() ||
+        (new_caps[MIGRATION_CAPABILITY_XBZRLE] ||
+         new_caps[MIGRATION_CAPABILITY_X_COLO] ||
+         (new_caps[MIGRATION_CAPABILITY_MULTIFD] &&
+          migrate_multifd_compression()) ||
          migrate_tls())) {
         error_setg(errp,
-                   "Zero copy only available for non-compressed non-TLS multifd migration");
+                   "Zero copy only available for non-compressed non-TLS migration");
         return false;
     }
 #else
@@ -576,6 +588,14 @@ bool migrate_caps_check(bool *old_caps, bool *new_caps, Error **errp)
             return false;
         }
     }
+    if (new_caps[MIGRATION_CAPABILITY_AUTO_TUNE]) {
+        if (!new_caps[MIGRATION_CAPABILITY_AUTO_CONVERGE]) {
+            error_setg(errp, "Capability 'auto-tune' requires capability "
+                             "'auto-converge'");
+            return false;
+        }
+    }
+
     if (new_caps[MIGRATION_CAPABILITY_DIRTY_LIMIT]) {
         if (new_caps[MIGRATION_CAPABILITY_AUTO_CONVERGE]) {
             error_setg(errp, "dirty-limit conflicts with auto-converge"
@@ -803,6 +823,13 @@ int migrate_multifd_zstd_level(void)
     return s->parameters.multifd_zstd_level;
 }
 
+const char *migrate_multifd_thread_context(void)
+{
+    MigrationState *s = migrate_get_current();
+
+    return s->parameters.multifd_thread_context;
+}
+
 uint8_t migrate_throttle_trigger_threshold(void)
 {
     MigrationState *s = migrate_get_current();
@@ -905,6 +932,9 @@ MigrationParameters *qmp_query_migrate_parameters(Error **errp)
     params->multifd_qatzip_level = s->parameters.multifd_qatzip_level;
     params->has_multifd_zstd_level = true;
     params->multifd_zstd_level = s->parameters.multifd_zstd_level;
+    params->multifd_thread_context =
+        g_strdup(s->parameters.multifd_thread_context ?
+                 s->parameters.multifd_thread_context : "");
     params->has_xbzrle_cache_size = true;
     params->xbzrle_cache_size = s->parameters.xbzrle_cache_size;
     params->has_max_postcopy_bandwidth = true;
@@ -1065,6 +1095,18 @@ bool migrate_params_check(MigrationParameters *params, Error **errp)
         return false;
     }
 
+    if (params->multifd_thread_context && params->multifd_thread_context[0]) {
+        Object *obj = object_resolve_path_component(object_get_objects_root(),
+                                            params->multifd_thread_context);
+
+        if (!obj || !object_dynamic_cast(obj, TYPE_THREAD_CONTEXT)) {
+            error_setg(errp, QERR_INVALID_PARAMETER_VALUE,
+                       "multifd_thread_context",
+                       "the ID of an existing thread-context object");
+            return false;
+        }
+    }
+
     if (params->has_xbzrle_cache_size &&
         (params->xbzrle_cache_size < qemu_target_page_size() ||
          !is_power_of_2(params->xbzrle_cache_size))) {
@@ -1124,7 +1166,7 @@ bool migrate_params_check(MigrationParameters *params, Error **errp)
         ((params->has_multifd_compression && params->multifd_compression) ||
          (params->tls_creds && *params->tls_creds))) {
         error_setg(errp,
-                   "Zero copy only available for non-compressed non-TLS multifd migration");
+                   "Zero copy only available for non-compressed non-TLS migration");
         return false;
     }
 #endif
@@ -1224,6 +1266,10 @@ static void migrate_params_test_apply(MigrateSetParameters *params,
     if (params->has_multifd_zstd_level) {
         dest->multifd_zstd_level = params->multifd_zstd_level;
     }
+    if (params->multifd_thread_context) {
+        assert(params->multifd_thread_context->type == QTYPE_QSTRING);
+        dest->multifd_thread_context = params->multifd_thread_context->u.s;
+    }
     if (params->has_xbzrle_cache_size) {
         dest->xbzrle_cache_size = params->xbzrle_cache_size;
     }
@@ -1347,6 +1393,12 @@ static void migrate_params_apply(MigrateSetParameters *params, Error **errp)
     if (params->has_multifd_zstd_level) {
         s->parameters.multifd_zstd_level = params->multifd_zstd_level;
     }
+    if (params->multifd_thread_context) {
+        g_free(s->parameters.multifd_thread_context);
+        assert(params->multifd_thread_context->type == QTYPE_QSTRING);
+        s->parameters.multifd_thread_context =
+            g_strdup(params->multifd_thread_context->u.s);
+    }
     if (params->has_xbzrle_cache_size) {
         s->parameters.xbzrle_cache_size = params->xbzrle_cache_size;
         xbzrle_cache_resize(params->xbzrle_cache_size, errp);
@@ -1427,6 +1479,12 @@ void qmp_migrate_set_parameters(MigrateSetParameters *params, Error **errp)
         params->tls_authz->type = QTYPE_QSTRING;
         params->tls_authz->u.s = strdup("");
     }
+    if (params->multifd_thread_context
+        && params->multifd_thread_context->type == QTYPE_QNULL) {
+        qobject_unref(params->multifd_thread_context->u.n);
+        params->multifd_thread_context->type = QTYPE_QSTRING;
+        params->multifd_thread_context->u.s = strdup("");
+    }
 
     migrate_params_test_apply(params, &tmp);
 
@@ -26,6 +26,7 @@ extern const size_t migration_properties_count;
 /* capabilities */
 
 bool migrate_auto_converge(void);
+bool migrate_auto_tune(void);
 bool migrate_colo(void);
 bool migrate_dirty_bitmaps(void);
 bool migrate_events(void);
@@ -79,6 +80,7 @@ MultiFDCompression migrate_multifd_compression(void);
 int migrate_multifd_zlib_level(void);
 int migrate_multifd_qatzip_level(void);
 int migrate_multifd_zstd_level(void);
+const char *migrate_multifd_thread_context(void);
 uint8_t migrate_throttle_trigger_threshold(void);
 const char *migrate_tls_authz(void);
 const char *migrate_tls_creds(void);
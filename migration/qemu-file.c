@@ -51,9 +51,14 @@ struct QEMUFile {
     uint8_t buf[IO_BUF_SIZE];
 
     DECLARE_BITMAP(may_free, MAX_IOV_SIZE);
+    /* Entries referencing caller-owned memory rather than `buf' above */
+    DECLARE_BITMAP(by_ref, MAX_IOV_SIZE);
     struct iovec iov[MAX_IOV_SIZE];
     unsigned int iovcnt;
 
+    /* QIO_CHANNEL_WRITE_FLAG_* applied when flushing the iovec array */
+    int write_flags;
+
     int last_error;
     Error *last_error_obj;
 
@@ -273,6 +278,35 @@ bool qemu_file_is_seekable(QEMUFile *f)
     return qio_channel_has_feature(f->ioc, QIO_CHANNEL_FEATURE_SEEKABLE);
 }
 
+/*
+ * Send the pending iovec array, using zero copy for the entries that
+ * reference caller-owned memory.  Entries pointing into the internal
+ * buffer are written normally, because the buffer is reused as soon as
+ * the flush returns.
+ */
+static int qemu_fflush_zero_copy(QEMUFile *f, Error **errp)
+{
+    unsigned int i = 0;
+
+    while (i < f->iovcnt) {
+        bool by_ref = test_bit(i, f->by_ref);
+        unsigned int j = i + 1;
+
+        while (j < f->iovcnt && test_bit(j, f->by_ref) == by_ref) {
+            j++;
+        }
+
+        if (qio_channel_writev_full_all(f->ioc, f->iov + i, j - i, NULL, 0,
+                                        by_ref ? f->write_flags : 0,
+                                        errp) < 0) {
+            return -1;
+        }
+        i = j;
+    }
+
+    return 0;
+}
+
 /**
  * Flushes QEMUFile buffer
  *
@@ -290,9 +324,16 @@ int qemu_fflush(QEMUFile *f)
     }
     if (f->iovcnt > 0) {
         Error *local_error = NULL;
-        if (qio_channel_writev_all(f->ioc,
-                                   f->iov, f->iovcnt,
-                                   &local_error) < 0) {
+        int ret;
+
+        if (f->write_flags & QIO_CHANNEL_WRITE_FLAG_ZERO_COPY) {
+            ret = qemu_fflush_zero_copy(f, &local_error);
+        } else {
+            ret = qio_channel_writev_all(f->ioc,
+                                         f->iov, f->iovcnt,
+                                         &local_error);
+        }
+        if (ret < 0) {
             qemu_file_set_error_obj(f, -EIO, local_error);
         } else {
             uint64_t size = iov_size(f->iov, f->iovcnt);
@@ -300,6 +341,7 @@ int qemu_fflush(QEMUFile *f)
         }
 
         qemu_iovec_release_ram(f);
+        memset(f->by_ref, 0, sizeof(f->by_ref));
     }
 
     f->buf_index = 0;
@@ -307,6 +349,30 @@ int qemu_fflush(QEMUFile *f)
     return f->last_error;
 }
 
+void qemu_file_set_zero_copy(QEMUFile *f)
+{
+    f->write_flags |= QIO_CHANNEL_WRITE_FLAG_ZERO_COPY;
+}
+
+int qemu_file_flush_zero_copy(QEMUFile *f)
+{
+    Error *local_error = NULL;
+    int ret;
+
+    if (!(f->write_flags & QIO_CHANNEL_WRITE_FLAG_ZERO_COPY)) {
+        return 0;
+    }
+
+    ret = qio_channel_flush(f->ioc, &local_error);
+    if (ret < 0) {
+        qemu_file_set_error_obj(f, -EIO, local_error);
+    } else if (ret == 1) {
+        stat64_add(&mig_stats.dirty_sync_missed_zero_copy, 1);
+    }
+
+    return ret;
+}
+
 /*
  * Attempt to fill the buffer from the underlying file
  * Returns the number of bytes read, or negative value for an error.
@@ -458,12 +524,13 @@ int qemu_fclose(QEMUFile *f)
  *
  */
 static int add_to_iovec(QEMUFile *f, const uint8_t *buf, size_t size,
-                        bool may_free)
+                        bool may_free, bool by_ref)
 {
     /* check for adjacent buffer and coalesce them */
     if (f->iovcnt > 0 && buf == f->iov[f->iovcnt - 1].iov_base +
         f->iov[f->iovcnt - 1].iov_len &&
-        may_free == test_bit(f->iovcnt - 1, f->may_free))
+        may_free == test_bit(f->iovcnt - 1, f->may_free) &&
+        by_ref == test_bit(f->iovcnt - 1, f->by_ref))
     {
         f->iov[f->iovcnt - 1].iov_len += size;
     } else {
@@ -475,6 +542,9 @@ static int add_to_iovec(QEMUFile *f, const uint8_t *buf, size_t size,
         if (may_free) {
             set_bit(f->iovcnt, f->may_free);
         }
+        if (by_ref) {
+            set_bit(f->iovcnt, f->by_ref);
+        }
         f->iov[f->iovcnt].iov_base = (uint8_t *)buf;
         f->iov[f->iovcnt++].iov_len = size;
     }
@@ -489,7 +559,7 @@ static int add_to_iovec(QEMUFile *f, const uint8_t *buf, size_t size,
 
 static void add_buf_to_iovec(QEMUFile *f, size_t len)
 {
-    if (!add_to_iovec(f, f->buf + f->buf_index, len, false)) {
+    if (!add_to_iovec(f, f->buf + f->buf_index, len, false, false)) {
         f->buf_index += len;
         if (f->buf_index == IO_BUF_SIZE) {
             qemu_fflush(f);
@@ -504,7 +574,7 @@ void qemu_put_buffer_async(QEMUFile *f, const uint8_t *buf, size_t size,
         return;
     }
 
-    add_to_iovec(f, buf, size, may_free);
+    add_to_iovec(f, buf, size, may_free, true);
 }
 
 void qemu_put_buffer(QEMUFile *f, const uint8_t *buf, size_t size)
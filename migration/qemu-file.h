@@ -71,6 +71,15 @@ void qemu_file_set_error(QEMUFile *f, int ret);
 int qemu_file_shutdown(QEMUFile *f);
 QEMUFile *qemu_file_get_return_path(QEMUFile *f);
 int qemu_fflush(QEMUFile *f);
+
+/*
+ * Send buffers queued with qemu_put_buffer_async() with zero copy.  Only
+ * valid on channels with QIO_CHANNEL_FEATURE_WRITE_ZERO_COPY; the caller
+ * must then wait for in-flight sends with qemu_file_flush_zero_copy()
+ * before the queued buffers are allowed to change.
+ */
+void qemu_file_set_zero_copy(QEMUFile *f);
+int qemu_file_flush_zero_copy(QEMUFile *f);
 void qemu_file_set_blocking(QEMUFile *f, bool block);
 int qemu_file_get_to_fd(QEMUFile *f, int fd, size_t size);
 void qemu_set_offset(QEMUFile *f, off_t off, int whence);
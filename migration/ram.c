@@ -351,6 +351,8 @@ struct RAMState {
     uint32_t last_version;
     /* How many times we have dirty too many pages */
     int dirty_rate_high_cnt;
+    /* How many times the dirty rate stayed well below the threshold */
+    int dirty_rate_low_cnt;
     /* these variables are used for bitmap sync */
     /* last time we did a full bitmap_sync */
     int64_t time_last_bitmap_sync;
@@ -527,7 +529,17 @@ static void mig_throttle_guest_down(uint64_t bytes_dirty_period,
         cpu_throttle_set(pct_initial);
     } else {
         /* Throttling already on, just increase the rate */
-        if (!pct_tailslow) {
+        if (migrate_auto_tune()) {
+            /*
+             * Jump straight to the CPU percentage that would make the
+             * dirty rate match the threshold, instead of approaching it
+             * in fixed steps.
+             */
+            cpu_now = 100 - throttle_now;
+            cpu_ideal = cpu_now * (bytes_dirty_threshold * 1.0 /
+                        bytes_dirty_period);
+            throttle_inc = cpu_now - cpu_ideal;
+        } else if (!pct_tailslow) {
             throttle_inc = pct_increment;
         } else {
             /* Compute the ideal CPU percentage used by Guest, which may
@@ -541,6 +553,26 @@ static void mig_throttle_guest_down(uint64_t bytes_dirty_period,
     }
 }
 
+/**
+ * mig_throttle_guest_up: give CPU back to the guest
+ *
+ * Called when the dirty rate has stayed well below the convergence
+ * threshold for a while: the current throttle is stronger than needed,
+ * either because the workload calmed down or because available
+ * bandwidth grew.  Back off one increment at a time, but never below
+ * the initial percentage to avoid flapping the throttle on and off.
+ */
+static void mig_throttle_guest_up(void)
+{
+    uint64_t pct_initial = migrate_cpu_throttle_initial();
+    uint64_t pct_increment = migrate_cpu_throttle_increment();
+    uint64_t throttle_now = cpu_throttle_get_percentage();
+
+    if (throttle_now > pct_initial) {
+        cpu_throttle_set(MAX(throttle_now - pct_increment, pct_initial));
+    }
+}
+
 void mig_throttle_counter_reset(void)
 {
     RAMState *rs = ram_state;
@@ -688,6 +720,7 @@ static void pss_find_next_dirty(PageSearchStatus *pss)
     RAMBlock *rb = pss->block;
     unsigned long size = rb->used_length >> TARGET_PAGE_BITS;
     unsigned long *bitmap = rb->bmap;
+    unsigned long page = pss->page;
 
     if (migrate_ram_is_ignored(rb)) {
         /* Points directly to the end, so we know no dirty page */
@@ -702,9 +735,43 @@ static void pss_find_next_dirty(PageSearchStatus *pss)
     if (pss->host_page_sending) {
         assert(pss->host_page_end);
         size = MIN(size, pss->host_page_end);
+    } else if (rb->bmap_summary) {
+        /*
+         * Consult the summary bitmap to skip chunks without any dirty
+         * page.  Chunks found entirely clean have their summary bit
+         * cleared, so once the block converges the scan degrades to one
+         * summary lookup per chunk instead of walking the whole bitmap.
+         */
+        unsigned long nchunks = DIV_ROUND_UP(size, BMAP_SUMMARY_PAGES);
+
+        while (page < size) {
+            unsigned long chunk = find_next_bit(rb->bmap_summary, nchunks,
+                                                page / BMAP_SUMMARY_PAGES);
+            unsigned long chunk_start, chunk_end, found;
+
+            if (chunk >= nchunks) {
+                page = size;
+                break;
+            }
+            chunk_start = chunk * BMAP_SUMMARY_PAGES;
+            chunk_end = MIN(chunk_start + BMAP_SUMMARY_PAGES, size);
+            page = MAX(page, chunk_start);
+            found = find_next_bit(bitmap, chunk_end, page);
+            if (found < chunk_end) {
+                page = found;
+                break;
+            }
+            if (page == chunk_start) {
+                /* Scanned the whole chunk and it's clean; drop it */
+                clear_bit(chunk, rb->bmap_summary);
+            }
+            page = chunk_end;
+        }
+        pss->page = page;
+        return;
     }
 
-    pss->page = find_next_bit(bitmap, size, pss->page);
+    pss->page = find_next_bit(bitmap, size, page);
 }
 
 static void migration_clear_memory_region_dirty_bitmap(RAMBlock *rb,
@@ -1005,6 +1072,7 @@ static void migration_trigger_throttle(RAMState *rs)
     if ((bytes_dirty_period > bytes_dirty_threshold) &&
         (++rs->dirty_rate_high_cnt >= 2)) {
         rs->dirty_rate_high_cnt = 0;
+        rs->dirty_rate_low_cnt = 0;
         if (migrate_auto_converge()) {
             trace_migration_throttle();
             mig_throttle_guest_down(bytes_dirty_period,
@@ -1012,6 +1080,12 @@ static void migration_trigger_throttle(RAMState *rs)
         } else if (migrate_dirty_limit()) {
             migration_dirty_limit_guest();
         }
+    } else if (migrate_auto_tune() && cpu_throttle_active() &&
+               bytes_dirty_period * 2 < bytes_dirty_threshold &&
+               ++rs->dirty_rate_low_cnt >= 2) {
+        rs->dirty_rate_low_cnt = 0;
+        trace_migration_throttle_relax();
+        mig_throttle_guest_up();
     }
 }
 
@@ -1367,36 +1441,85 @@ static RAMBlock *unqueue_page(RAMState *rs, ram_addr_t *offset)
 }
 
 #if defined(__linux__)
+/* Number of UFFD write fault events drained per poll */
+#define UFFD_FAULT_BATCH_SIZE 16
+
 /**
- * poll_fault_page: try to get next UFFD write fault page and, if pending fault
- *   is found, return RAM block pointer and page offset
+ * ram_save_fault_pages: resolve pending UFFD write faults
+ *
+ * Drains a batch of pending write fault events, copies each faulted
+ * host page aside while it is still write-protected, removes the
+ * protection so the blocked vCPUs can resume, and only then streams
+ * the copies.  This keeps the stream writes out of the vCPU wake-up
+ * path: the faulted vCPUs no longer stay blocked until the page has
+ * been fully saved and the channel flushed.
  *
- * Returns pointer to the RAMBlock containing faulting page,
- *   NULL if no write faults are pending
+ * Returns the number of pages written, 0 if no write faults are
+ *   pending, negative value in case of an error
  *
  * @rs: current RAM state
- * @offset: page offset from the beginning of the block
+ * @pss: page-search-status structure
  */
-static RAMBlock *poll_fault_page(RAMState *rs, ram_addr_t *offset)
+static int ram_save_fault_pages(RAMState *rs, PageSearchStatus *pss)
 {
-    struct uffd_msg uffd_msg;
-    void *page_address;
-    RAMBlock *block;
-    int res;
+    struct uffd_msg uffd_msgs[UFFD_FAULT_BATCH_SIZE];
+    int pages = 0;
+    int nr_events;
 
     if (!migrate_background_snapshot()) {
-        return NULL;
+        return 0;
     }
 
-    res = uffd_read_events(rs->uffdio_fd, &uffd_msg, 1);
-    if (res <= 0) {
-        return NULL;
+    nr_events = uffd_read_events(rs->uffdio_fd, uffd_msgs,
+                                 UFFD_FAULT_BATCH_SIZE);
+    if (nr_events <= 0) {
+        return 0;
     }
 
-    page_address = (void *)(uintptr_t) uffd_msg.arg.pagefault.address;
-    block = qemu_ram_block_from_host(page_address, false, offset);
-    assert(block && (block->flags & RAM_UF_WRITEPROTECT) != 0);
-    return block;
+    for (int i = 0; i < nr_events; i++) {
+        void *page_address =
+            (void *)(uintptr_t) uffd_msgs[i].arg.pagefault.address;
+        g_autofree uint8_t *copy = NULL;
+        unsigned long page, last_page;
+        ram_addr_t offset;
+        size_t page_size;
+        RAMBlock *block;
+        int res;
+
+        block = qemu_ram_block_from_host(page_address, false, &offset);
+        assert(block && (block->flags & RAM_UF_WRITEPROTECT) != 0);
+
+        page_size = qemu_ram_pagesize(block);
+        offset = QEMU_ALIGN_DOWN(offset, page_size);
+
+        /*
+         * Snapshot the host page while it is still write-protected, then
+         * let the faulted vCPUs continue into the live copy.  A repeated
+         * event for an already resolved page merely re-copies it; the
+         * dirty bitmap check below makes sure it isn't sent twice.
+         */
+        copy = g_memdup2(block->host + offset, page_size);
+        res = uffd_change_protection(rs->uffdio_fd, block->host + offset,
+                                     page_size, false, false);
+        if (res < 0) {
+            return res;
+        }
+
+        page = offset >> TARGET_PAGE_BITS;
+        last_page = (offset + page_size) >> TARGET_PAGE_BITS;
+        for (; page < last_page; page++) {
+            ram_addr_t page_offset = (ram_addr_t)page << TARGET_PAGE_BITS;
+
+            /* Pages already sent by the background search stay clean */
+            if (!migration_bitmap_clear_dirty(rs, block, page)) {
+                continue;
+            }
+            pages += save_normal_page(pss, block, page_offset,
+                                      copy + (page_offset - offset), false);
+        }
+    }
+
+    return pages;
 }
 
 /**
@@ -1708,12 +1831,12 @@ void ram_write_tracking_stop(void)
 #else
 /* No target OS support, stubs just fail or ignore */
 
-static RAMBlock *poll_fault_page(RAMState *rs, ram_addr_t *offset)
+static int ram_save_fault_pages(RAMState *rs, PageSearchStatus *pss)
 {
     (void) rs;
-    (void) offset;
+    (void) pss;
 
-    return NULL;
+    return 0;
 }
 
 static int ram_save_release_protection(RAMState *rs, PageSearchStatus *pss,
@@ -1786,14 +1909,6 @@ static bool get_queued_page(RAMState *rs, PageSearchStatus *pss)
 
     } while (block && !dirty);
 
-    if (!block) {
-        /*
-         * Poll write faults too if background snapshot is enabled; that's
-         * when we have vcpus got blocked by the write protected pages.
-         */
-        block = poll_fault_page(rs, &offset);
-    }
-
     if (block) {
         /*
          * We want the background search to continue from the queued page
@@ -1835,6 +1950,60 @@ static void migration_page_queue_free(RAMState *rs)
     }
 }
 
+/*
+ * Size of the window queued around each postcopy page request.  The guest
+ * is likely to fault next on pages close to the one it just requested, so
+ * pushing the neighbourhood ahead of the linear background scan saves a
+ * network round-trip per fault.
+ */
+#define POSTCOPY_PREFETCH_SIZE (512 * 1024)
+
+/**
+ * postcopy_prefetch_queue: queue the pages around a postcopy request
+ *
+ * Inserts a normal-priority request covering the neighbourhood of a
+ * faulted page, so that the migration thread services it before resuming
+ * the background scan.  Deliberately not sent on the preempt channel:
+ * prefetched pages must never delay a real vCPU fault.  Pages in the
+ * window that were already sent have their dirty bit clear and are
+ * skipped when the queue is drained, so over-queueing is cheap.
+ *
+ * @rs: current RAM state
+ * @rb: RAMBlock of the original request
+ * @start: starting address of the original request
+ * @len: length (in bytes) of the original request
+ */
+static void postcopy_prefetch_queue(RAMState *rs, RAMBlock *rb,
+                                    ram_addr_t start, ram_addr_t len)
+{
+    size_t page_size = qemu_ram_pagesize(rb);
+    ram_addr_t window_start, window_end;
+    struct RAMSrcPageRequest *new_entry;
+
+    window_start = start > POSTCOPY_PREFETCH_SIZE / 2 ?
+                   start - POSTCOPY_PREFETCH_SIZE / 2 : 0;
+    window_start = QEMU_ALIGN_DOWN(window_start, page_size);
+    window_end = MIN(start + len + POSTCOPY_PREFETCH_SIZE / 2,
+                     QEMU_ALIGN_DOWN(rb->used_length, page_size));
+    if (window_end <= window_start) {
+        return;
+    }
+
+    trace_postcopy_prefetch_queue(rb->idstr, window_start,
+                                  window_end - window_start);
+
+    new_entry = g_new0(struct RAMSrcPageRequest, 1);
+    new_entry->rb = rb;
+    new_entry->offset = window_start;
+    new_entry->len = window_end - window_start;
+
+    memory_region_ref(rb->mr);
+    qemu_mutex_lock(&rs->src_page_req_mutex);
+    QSIMPLEQ_INSERT_TAIL(&rs->src_page_requests, new_entry, next_req);
+    migration_make_urgent_request();
+    qemu_mutex_unlock(&rs->src_page_req_mutex);
+}
+
 /**
  * ram_save_queue_pages: queue the page for transmission
  *
@@ -1893,6 +2062,7 @@ int ram_save_queue_pages(const char *rbname, ram_addr_t start, ram_addr_t len,
      */
     if (postcopy_preempt_active()) {
         ram_addr_t page_start = start >> TARGET_PAGE_BITS;
+        ram_addr_t req_len = len;
         size_t page_size = qemu_ram_pagesize(ramblock);
         PageSearchStatus *pss = &ram_state->pss[RAM_CHANNEL_POSTCOPY];
         int ret = 0;
@@ -1934,6 +2104,13 @@ int ram_save_queue_pages(const char *rbname, ram_addr_t start, ram_addr_t len,
         };
         qemu_mutex_unlock(&rs->bitmap_mutex);
 
+        if (!ret) {
+            /*
+             * The faulted vCPU is unblocked now; push its neighbourhood
+             * over the background channel.
+             */
+            postcopy_prefetch_queue(rs, ramblock, start, req_len);
+        }
         return ret;
     }
 
@@ -1949,6 +2126,9 @@ int ram_save_queue_pages(const char *rbname, ram_addr_t start, ram_addr_t len,
     migration_make_urgent_request();
     qemu_mutex_unlock(&rs->src_page_req_mutex);
 
+    /* Queued behind the request itself, so the faulted page goes first */
+    postcopy_prefetch_queue(rs, ramblock, start, len);
+
     return 0;
 }
 
@@ -2209,6 +2389,15 @@ static int ram_find_and_save_block(RAMState *rs)
     pss_init(pss, rs->last_seen_block, rs->last_page);
 
     while (true){
+        /*
+         * With background snapshot enabled, resolve pending write faults
+         * first; that's when we have vcpus got blocked by the write
+         * protected pages.
+         */
+        pages = ram_save_fault_pages(rs, pss);
+        if (pages) {
+            break;
+        }
         if (!get_queued_page(rs, pss)) {
             /* priority queue empty, so just search for something dirty */
             int res = find_dirty_block(rs, pss);
@@ -2308,6 +2497,8 @@ static void ram_bitmaps_destroy(void)
         block->clear_bmap = NULL;
         g_free(block->bmap);
         block->bmap = NULL;
+        g_free(block->bmap_summary);
+        block->bmap_summary = NULL;
         g_free(block->file_bmap);
         block->file_bmap = NULL;
     }
@@ -2508,6 +2699,9 @@ static void postcopy_chunk_hostpages_pass(MigrationState *ms, RAMBlock *block)
                  * that weren't previously dirty.
                  */
                 rs->migration_dirty_pages += !test_and_set_bit(page, bitmap);
+                if (block->bmap_summary) {
+                    set_bit(page / BMAP_SUMMARY_PAGES, block->bmap_summary);
+                }
             }
         }
 
@@ -2694,6 +2888,10 @@ static void ram_list_init_bitmaps(void)
              */
             block->bmap = bitmap_new(pages);
             bitmap_set(block->bmap, 0, pages);
+            block->bmap_summary =
+                bitmap_new(DIV_ROUND_UP(pages, BMAP_SUMMARY_PAGES));
+            bitmap_set(block->bmap_summary, 0,
+                       DIV_ROUND_UP(pages, BMAP_SUMMARY_PAGES));
             if (migrate_mapped_ram()) {
                 block->file_bmap = bitmap_new(pages);
             }
@@ -2800,17 +2998,13 @@ static void ram_state_resume_prepare(RAMState *rs, QEMUFile *out)
  * start of the continuous guest free pages, and @len is the total bytes of
  * those pages.
  */
-void qemu_guest_free_page_hint(void *addr, size_t len)
+/* Called with ram_state->bitmap_mutex held */
+static void qemu_guest_free_page_hint_locked(void *addr, size_t len)
 {
     RAMBlock *block;
     ram_addr_t offset;
     size_t used_len, start, npages;
 
-    /* This function is currently expected to be used during live migration */
-    if (!migration_is_running()) {
-        return;
-    }
-
     for (; len > 0; len -= used_len, addr += used_len) {
         block = qemu_ram_block_from_host(addr, false, &offset);
         if (unlikely(!block || offset >= block->used_length)) {
@@ -2832,7 +3026,6 @@ void qemu_guest_free_page_hint(void *addr, size_t len)
         start = offset >> TARGET_PAGE_BITS;
         npages = used_len >> TARGET_PAGE_BITS;
 
-        qemu_mutex_lock(&ram_state->bitmap_mutex);
         /*
          * The skipped free pages are equavalent to be sent from clear_bmap's
          * perspective, so clear the bits from the memory region bitmap which
@@ -2843,7 +3036,36 @@ void qemu_guest_free_page_hint(void *addr, size_t len)
         ram_state->migration_dirty_pages -=
                       bitmap_count_one_with_offset(block->bmap, start, npages);
         bitmap_clear(block->bmap, start, npages);
-        qemu_mutex_unlock(&ram_state->bitmap_mutex);
+    }
+}
+
+void qemu_guest_free_page_hint(void *addr, size_t len)
+{
+    /* This function is currently expected to be used during live migration */
+    if (!migration_is_running()) {
+        return;
+    }
+
+    QEMU_LOCK_GUARD(&ram_state->bitmap_mutex);
+    qemu_guest_free_page_hint_locked(addr, len);
+}
+
+/*
+ * Apply a whole batch of free page hints while taking the bitmap mutex
+ * only once, so a guest flushing many hint buffers at the start of a
+ * migration does not serialize against the migration thread per range.
+ */
+void qemu_guest_free_page_hints(const struct iovec *iov, unsigned int iov_cnt)
+{
+    unsigned int i;
+
+    if (!migration_is_running()) {
+        return;
+    }
+
+    QEMU_LOCK_GUARD(&ram_state->bitmap_mutex);
+    for (i = 0; i < iov_cnt; i++) {
+        qemu_guest_free_page_hint_locked(iov[i].iov_base, iov[i].iov_len);
     }
 }
 
@@ -4385,6 +4607,12 @@ bool ram_dirty_bitmap_reload(MigrationState *s, RAMBlock *block, Error **errp)
      */
     bitmap_complement(block->bmap, block->bmap, nbits);
 
+    /* Conservatively mark every summary chunk as possibly dirty */
+    if (block->bmap_summary) {
+        bitmap_set(block->bmap_summary, 0,
+                   DIV_ROUND_UP(nbits, BMAP_SUMMARY_PAGES));
+    }
+
     /* Clear dirty bits of discarded ranges that we don't want to migrate. */
     ramblock_dirty_bitmap_clear_discarded_pages(block);
 
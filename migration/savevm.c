@@ -254,6 +254,13 @@ typedef struct SaveStateEntry {
 typedef struct SaveState {
     QTAILQ_HEAD(, SaveStateEntry) handlers;
     SaveStateEntry *handler_pri_head[MIG_PRI_MAX + 1];
+    /*
+     * idstr (resp. compat idstr) => GSList of entries sharing it, so
+     * that registration does not walk every handler.  Allocated on
+     * first use.
+     */
+    GHashTable *handler_by_idstr;
+    GHashTable *handler_by_compat_idstr;
     int global_section_id;
     uint32_t len;
     const char *name;
@@ -701,14 +708,47 @@ void dump_vmstate_json_to_file(FILE *out_file)
     g_slist_free(list);
 }
 
+static GSList *savevm_state_index_lookup(GHashTable *index, const char *idstr)
+{
+    return index ? g_hash_table_lookup(index, idstr) : NULL;
+}
+
+static void savevm_state_index_add(GHashTable **index, const char *idstr,
+                                   SaveStateEntry *se)
+{
+    GSList *list;
+
+    if (!*index) {
+        *index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    }
+    list = g_hash_table_lookup(*index, idstr);
+    /* An existing key is kept and the duplicate freed */
+    g_hash_table_insert(*index, g_strdup(idstr), g_slist_prepend(list, se));
+}
+
+static void savevm_state_index_remove(GHashTable *index, const char *idstr,
+                                      SaveStateEntry *se)
+{
+    GSList *list = g_hash_table_lookup(index, idstr);
+
+    list = g_slist_remove(list, se);
+    if (list) {
+        g_hash_table_insert(index, g_strdup(idstr), list);
+    } else {
+        g_hash_table_remove(index, idstr);
+    }
+}
+
 static uint32_t calculate_new_instance_id(const char *idstr)
 {
-    SaveStateEntry *se;
+    GSList *l = savevm_state_index_lookup(savevm_state.handler_by_idstr,
+                                          idstr);
     uint32_t instance_id = 0;
 
-    QTAILQ_FOREACH(se, &savevm_state.handlers, entry) {
-        if (strcmp(idstr, se->idstr) == 0
-            && instance_id <= se->instance_id) {
+    for (; l; l = l->next) {
+        SaveStateEntry *se = l->data;
+
+        if (instance_id <= se->instance_id) {
             instance_id = se->instance_id + 1;
         }
     }
@@ -719,16 +759,14 @@ static uint32_t calculate_new_instance_id(const char *idstr)
 
 static int calculate_compat_instance_id(const char *idstr)
 {
-    SaveStateEntry *se;
+    GSList *l = savevm_state_index_lookup(savevm_state.handler_by_compat_idstr,
+                                          idstr);
     int instance_id = 0;
 
-    QTAILQ_FOREACH(se, &savevm_state.handlers, entry) {
-        if (!se->compat) {
-            continue;
-        }
+    for (; l; l = l->next) {
+        SaveStateEntry *se = l->data;
 
-        if (strcmp(idstr, se->compat->idstr) == 0
-            && instance_id <= se->compat->instance_id) {
+        if (instance_id <= se->compat->instance_id) {
             instance_id = se->compat->instance_id + 1;
         }
     }
@@ -743,6 +781,38 @@ static inline MigrationPriority save_state_priority(SaveStateEntry *se)
     return MIG_PRI_DEFAULT;
 }
 
+/*
+ * Equivalent of find_se(nse->idstr, nse->instance_id) for a new entry,
+ * but using the idstr indexes so registration cost does not grow with
+ * the number of handlers already present.
+ */
+static bool savevm_state_handler_conflicts(SaveStateEntry *nse)
+{
+    GSList *l;
+
+    for (l = savevm_state_index_lookup(savevm_state.handler_by_idstr,
+                                       nse->idstr);
+         l; l = l->next) {
+        SaveStateEntry *se = l->data;
+
+        if (nse->instance_id == se->instance_id ||
+            nse->instance_id == se->alias_id) {
+            return true;
+        }
+    }
+    for (l = savevm_state_index_lookup(savevm_state.handler_by_compat_idstr,
+                                       nse->idstr);
+         l; l = l->next) {
+        SaveStateEntry *se = l->data;
+
+        if (nse->instance_id == se->compat->instance_id ||
+            nse->instance_id == se->alias_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static void savevm_state_handler_insert(SaveStateEntry *nse)
 {
     MigrationPriority priority = save_state_priority(nse);
@@ -756,7 +826,7 @@ static void savevm_state_handler_insert(SaveStateEntry *nse)
      * silently somewhere because we can be wrongly applying one
      * object properties upon another one.  Bail out ASAP.
      */
-    if (find_se(nse->idstr, nse->instance_id)) {
+    if (savevm_state_handler_conflicts(nse)) {
         error_report("%s: Detected duplicate SaveStateEntry: "
                      "id=%s, instance_id=0x%"PRIx32, __func__,
                      nse->idstr, nse->instance_id);
@@ -780,6 +850,12 @@ static void savevm_state_handler_insert(SaveStateEntry *nse)
     if (savevm_state.handler_pri_head[priority] == NULL) {
         savevm_state.handler_pri_head[priority] = nse;
     }
+
+    savevm_state_index_add(&savevm_state.handler_by_idstr, nse->idstr, nse);
+    if (nse->compat) {
+        savevm_state_index_add(&savevm_state.handler_by_compat_idstr,
+                               nse->compat->idstr, nse);
+    }
 }
 
 static void savevm_state_handler_remove(SaveStateEntry *se)
@@ -796,6 +872,12 @@ static void savevm_state_handler_remove(SaveStateEntry *se)
         }
     }
     QTAILQ_REMOVE(&savevm_state.handlers, se, entry);
+
+    savevm_state_index_remove(savevm_state.handler_by_idstr, se->idstr, se);
+    if (se->compat) {
+        savevm_state_index_remove(savevm_state.handler_by_compat_idstr,
+                                  se->compat->idstr, se);
+    }
 }
 
 /* TODO: Individual devices generally have very little idea about the rest
@@ -835,7 +917,7 @@ int register_savevm_live(const char *idstr,
 
 void unregister_savevm(VMStateIf *obj, const char *idstr, void *opaque)
 {
-    SaveStateEntry *se, *new_se;
+    GSList *list, *l;
     char id[256] = "";
 
     if (obj) {
@@ -848,13 +930,19 @@ void unregister_savevm(VMStateIf *obj, const char *idstr, void *opaque)
     }
     pstrcat(id, sizeof(id), idstr);
 
-    QTAILQ_FOREACH_SAFE(se, &savevm_state.handlers, entry, new_se) {
-        if (strcmp(se->idstr, id) == 0 && se->opaque == opaque) {
+    /* Copy the index list, removal modifies it */
+    list = g_slist_copy(savevm_state_index_lookup(savevm_state.handler_by_idstr,
+                                                  id));
+    for (l = list; l; l = l->next) {
+        SaveStateEntry *se = l->data;
+
+        if (se->opaque == opaque) {
             savevm_state_handler_remove(se);
             g_free(se->compat);
             g_free(se);
         }
     }
+    g_slist_free(list);
 }
 
 /*
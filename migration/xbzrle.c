@@ -15,10 +15,14 @@
 #include "qemu/host-utils.h"
 #include "xbzrle.h"
 
-#if defined(CONFIG_AVX512BW_OPT)
+#if defined(CONFIG_AVX2_OPT) || defined(CONFIG_AVX512BW_OPT)
 #include <immintrin.h>
 #include "host/cpuinfo.h"
 
+static int xbzrle_encode_buffer_int(uint8_t *old_buf, uint8_t *new_buf,
+                                    int slen, uint8_t *dst, int dlen);
+
+#if defined(CONFIG_AVX512BW_OPT)
 static int __attribute__((target("avx512bw")))
 xbzrle_encode_buffer_avx512(uint8_t *old_buf, uint8_t *new_buf, int slen,
                             uint8_t *dst, int dlen)
@@ -136,20 +140,141 @@ xbzrle_encode_buffer_avx512(uint8_t *old_buf, uint8_t *new_buf, int slen,
     }
     return d;
 }
+#endif /* CONFIG_AVX512BW_OPT */
 
-static int xbzrle_encode_buffer_int(uint8_t *old_buf, uint8_t *new_buf,
-                                    int slen, uint8_t *dst, int dlen);
+#if defined(CONFIG_AVX2_OPT)
+/*
+ * Same run-length state machine as the AVX512 variant above, with 32-byte
+ * blocks and the comparison mask taken from VPMOVMSKB.  AVX2 has no masked
+ * byte loads, so buffers that are not a multiple of 32 bytes fall back to
+ * the integer version; in practice slen is always a target page size.
+ */
+static int __attribute__((target("avx2")))
+xbzrle_encode_buffer_avx2(uint8_t *old_buf, uint8_t *new_buf, int slen,
+                          uint8_t *dst, int dlen)
+{
+    uint32_t zrun_len = 0, nzrun_len = 0;
+    int d = 0, i = 0, num = 0;
+    uint8_t *nzrun_start = NULL;
+    uint32_t count256s = slen >> 5;
+    bool never_same = true;
+
+    if (slen & 0b11111) {
+        return xbzrle_encode_buffer_int(old_buf, new_buf, slen, dst, dlen);
+    }
+
+    while (count256s) {
+        int bytes_to_check = 32;
+        __m256i old_data = _mm256_loadu_si256((__m256i const *)(old_buf + i));
+        __m256i new_data = _mm256_loadu_si256((__m256i const *)(new_buf + i));
+        uint32_t comp =
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(old_data, new_data));
+        count256s--;
+
+        bool is_same = (comp & 0x1);
+        while (bytes_to_check) {
+            if (d + 2 > dlen) {
+                return -1;
+            }
+            if (is_same) {
+                if (nzrun_len) {
+                    d += uleb128_encode_small(dst + d, nzrun_len);
+                    if (d + nzrun_len > dlen) {
+                        return -1;
+                    }
+                    nzrun_start = new_buf + i - nzrun_len;
+                    memcpy(dst + d, nzrun_start, nzrun_len);
+                    d += nzrun_len;
+                    nzrun_len = 0;
+                }
+                /* 32 data at a time for speed */
+                if (count256s && (comp == 0xffffffff)) {
+                    i += 32;
+                    zrun_len += 32;
+                    break;
+                }
+                never_same = false;
+                num = ctz32(~comp);
+                num = (num < bytes_to_check) ? num : bytes_to_check;
+                zrun_len += num;
+                bytes_to_check -= num;
+                i += num;
+                if (!bytes_to_check) {
+                    break;
+                }
+                /* still has different data after same data */
+                comp >>= num;
+                d += uleb128_encode_small(dst + d, zrun_len);
+                zrun_len = 0;
+            }
+            if (never_same || zrun_len) {
+                /*
+                 * never_same only acts if
+                 * data begins with diff in first count256s
+                 */
+                d += uleb128_encode_small(dst + d, zrun_len);
+                zrun_len = 0;
+                never_same = false;
+            }
+            /* has diff, 32 data at a time for speed */
+            if ((bytes_to_check == 32) && (comp == 0x0)) {
+                i += 32;
+                nzrun_len += 32;
+                break;
+            }
+            num = ctz32(comp);
+            num = (num < bytes_to_check) ? num : bytes_to_check;
+            nzrun_len += num;
+            bytes_to_check -= num;
+            i += num;
+            if (!bytes_to_check) {
+                break;
+            }
+            comp >>= num;
+            d += uleb128_encode_small(dst + d, nzrun_len);
+            /* overflow */
+            if (d + nzrun_len > dlen) {
+                return -1;
+            }
+            nzrun_start = new_buf + i - nzrun_len;
+            memcpy(dst + d, nzrun_start, nzrun_len);
+            d += nzrun_len;
+            nzrun_len = 0;
+            is_same = true;
+        }
+    }
+
+    if (nzrun_len != 0) {
+        d += uleb128_encode_small(dst + d, nzrun_len);
+        /* overflow */
+        if (d + nzrun_len > dlen) {
+            return -1;
+        }
+        nzrun_start = new_buf + i - nzrun_len;
+        memcpy(dst + d, nzrun_start, nzrun_len);
+        d += nzrun_len;
+    }
+    return d;
+}
+#endif /* CONFIG_AVX2_OPT */
 
 static int (*accel_func)(uint8_t *, uint8_t *, int, uint8_t *, int);
 
 static void __attribute__((constructor)) init_accel(void)
 {
     unsigned info = cpuinfo_init();
+
+    accel_func = xbzrle_encode_buffer_int;
+#if defined(CONFIG_AVX2_OPT)
+    if (info & CPUINFO_AVX2) {
+        accel_func = xbzrle_encode_buffer_avx2;
+    }
+#endif
+#if defined(CONFIG_AVX512BW_OPT)
     if (info & CPUINFO_AVX512BW) {
         accel_func = xbzrle_encode_buffer_avx512;
-    } else {
-        accel_func = xbzrle_encode_buffer_int;
     }
+#endif
 }
 
 int xbzrle_encode_buffer(uint8_t *old_buf, uint8_t *new_buf, int slen,
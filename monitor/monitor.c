@@ -44,10 +44,15 @@ typedef struct MonitorQAPIEventState {
     QDict *data;        /* ... data, see qapi_event_throttle_equal() */
     QEMUTimer *timer;   /* Timer for handling delayed events */
     QDict *qdict;       /* Delayed event (if any) */
+    uint64_t dropped;   /* Events coalesced into @qdict since last send */
 } MonitorQAPIEventState;
 
 typedef struct {
     int64_t rate;       /* Minimum time (in ns) between two events */
+    const char *key;    /* Optional member of the event data that
+                         * identifies the stream to throttle; events of
+                         * the same type with different values of this
+                         * member are rate-limited independently. */
 } MonitorQAPIEventConf;
 
 /* Shared monitor I/O thread */
@@ -308,13 +313,13 @@ int error_printf_unless_qmp(const char *fmt, ...)
 static MonitorQAPIEventConf monitor_qapi_event_conf[QAPI_EVENT__MAX] = {
     /* Limit guest-triggerable events to 1 per second */
     [QAPI_EVENT_RTC_CHANGE]        = { 1000 * SCALE_MS },
-    [QAPI_EVENT_BLOCK_IO_ERROR]    = { 1000 * SCALE_MS },
+    [QAPI_EVENT_BLOCK_IO_ERROR]    = { 1000 * SCALE_MS, "qom-path" },
     [QAPI_EVENT_WATCHDOG]          = { 1000 * SCALE_MS },
     [QAPI_EVENT_BALLOON_CHANGE]    = { 1000 * SCALE_MS },
-    [QAPI_EVENT_QUORUM_REPORT_BAD] = { 1000 * SCALE_MS },
+    [QAPI_EVENT_QUORUM_REPORT_BAD] = { 1000 * SCALE_MS, "node-name" },
     [QAPI_EVENT_QUORUM_FAILURE]    = { 1000 * SCALE_MS },
-    [QAPI_EVENT_VSERPORT_CHANGE]   = { 1000 * SCALE_MS },
-    [QAPI_EVENT_MEMORY_DEVICE_SIZE_CHANGE] = { 1000 * SCALE_MS },
+    [QAPI_EVENT_VSERPORT_CHANGE]   = { 1000 * SCALE_MS, "id" },
+    [QAPI_EVENT_MEMORY_DEVICE_SIZE_CHANGE] = { 1000 * SCALE_MS, "qom-path" },
     [QAPI_EVENT_HV_BALLOON_STATUS_REPORT] = { 1000 * SCALE_MS },
 };
 
@@ -386,6 +391,9 @@ monitor_qapi_event_queue_no_reenter(QAPIEvent event, QDict *qdict)
              * last send.  Store event for sending when timer fires,
              * replacing a prior stored event if any.
              */
+            if (evstate->qdict) {
+                evstate->dropped++;
+            }
             qobject_unref(evstate->qdict);
             evstate->qdict = qobject_ref(qdict);
         } else {
@@ -403,6 +411,7 @@ monitor_qapi_event_queue_no_reenter(QAPIEvent event, QDict *qdict)
             evstate->event = event;
             evstate->data = qobject_ref(data);
             evstate->qdict = NULL;
+            evstate->dropped = 0;
             evstate->timer = timer_new_ns(monitor_get_event_clock(),
                                           monitor_qapi_event_handler,
                                           evstate);
@@ -469,6 +478,11 @@ static void monitor_qapi_event_handler(void *opaque)
     if (evstate->qdict) {
         int64_t now = qemu_clock_get_ns(monitor_get_event_clock());
 
+        if (evstate->dropped) {
+            trace_monitor_protocol_event_coalesced(evstate->event,
+                                                   evstate->dropped);
+            evstate->dropped = 0;
+        }
         monitor_qapi_event_emit(evstate->event, evstate->qdict);
         qobject_unref(evstate->qdict);
         evstate->qdict = NULL;
@@ -485,18 +499,10 @@ static unsigned int qapi_event_throttle_hash(const void *key)
 {
     const MonitorQAPIEventState *evstate = key;
     unsigned int hash = evstate->event * 255;
+    const char *conf_key = monitor_qapi_event_conf[evstate->event].key;
 
-    if (evstate->event == QAPI_EVENT_VSERPORT_CHANGE) {
-        hash += g_str_hash(qdict_get_str(evstate->data, "id"));
-    }
-
-    if (evstate->event == QAPI_EVENT_QUORUM_REPORT_BAD) {
-        hash += g_str_hash(qdict_get_str(evstate->data, "node-name"));
-    }
-
-    if (evstate->event == QAPI_EVENT_MEMORY_DEVICE_SIZE_CHANGE ||
-        evstate->event == QAPI_EVENT_BLOCK_IO_ERROR) {
-        hash += g_str_hash(qdict_get_str(evstate->data, "qom-path"));
+    if (conf_key) {
+        hash += g_str_hash(qdict_get_str(evstate->data, conf_key));
     }
 
     return hash;
@@ -506,25 +512,16 @@ static gboolean qapi_event_throttle_equal(const void *a, const void *b)
 {
     const MonitorQAPIEventState *eva = a;
     const MonitorQAPIEventState *evb = b;
+    const char *conf_key;
 
     if (eva->event != evb->event) {
         return FALSE;
     }
 
-    if (eva->event == QAPI_EVENT_VSERPORT_CHANGE) {
-        return !strcmp(qdict_get_str(eva->data, "id"),
-                       qdict_get_str(evb->data, "id"));
-    }
-
-    if (eva->event == QAPI_EVENT_QUORUM_REPORT_BAD) {
-        return !strcmp(qdict_get_str(eva->data, "node-name"),
-                       qdict_get_str(evb->data, "node-name"));
-    }
-
-    if (eva->event == QAPI_EVENT_MEMORY_DEVICE_SIZE_CHANGE ||
-        eva->event == QAPI_EVENT_BLOCK_IO_ERROR) {
-        return !strcmp(qdict_get_str(eva->data, "qom-path"),
-                       qdict_get_str(evb->data, "qom-path"));
+    conf_key = monitor_qapi_event_conf[eva->event].key;
+    if (conf_key) {
+        return !strcmp(qdict_get_str(eva->data, conf_key),
+                       qdict_get_str(evb->data, conf_key));
     }
 
     return TRUE;
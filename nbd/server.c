@@ -85,6 +85,25 @@ struct NBDRequestData {
     bool complete;
 };
 
+/*
+ * Payload bytes a client may consume per scheduling round before it
+ * has to let the other clients of the export catch up.
+ */
+#define NBD_SCHED_QUANTUM (1 * MiB)
+
+#define NBD_READ_AHEAD_SLOTS 4
+#define NBD_READ_AHEAD_SIZE (1 * MiB)
+/* Consecutive sequential READs before read-ahead kicks in */
+#define NBD_READ_AHEAD_MIN_SEQ 2
+
+typedef struct NBDReadAheadSlot {
+    uint64_t from;
+    uint64_t len;   /* valid bytes at @data, 0 while empty or filling */
+    unsigned gen;   /* bumped by invalidation to cancel in-flight fills */
+    bool filling;
+    uint8_t *data;  /* NBD_READ_AHEAD_SIZE bytes, allocated lazily */
+} NBDReadAheadSlot;
+
 struct NBDExport {
     BlockExport common;
 
@@ -101,6 +120,17 @@ struct NBDExport {
     bool allocation_depth;
     BdrvDirtyBitmap **export_bitmaps;
     size_t nr_export_bitmaps;
+
+    /*
+     * Request scheduling and read-ahead state.  Only accessed by
+     * coroutines running in the export's AioContext, so no locking is
+     * needed: coroutines yield only while waiting for I/O.
+     */
+    CoQueue sched_wait;         /* clients that exhausted their quantum */
+    uint64_t sched_round;
+    unsigned sched_dispatched;  /* requests currently being handled */
+    NBDReadAheadSlot read_ahead[NBD_READ_AHEAD_SLOTS];
+    unsigned read_ahead_next;   /* round-robin victim for slot reuse */
 };
 
 static QTAILQ_HEAD(, NBDExport) exports = QTAILQ_HEAD_INITIALIZER(exports);
@@ -147,6 +177,12 @@ struct NBDClient {
     int nb_requests; /* protected by lock */
     bool closing; /* protected by lock */
 
+    /* Scheduling state; only accessed in the export's AioContext */
+    uint64_t sched_round;
+    uint64_t sched_bytes;
+    uint64_t seq_next_from; /* end offset of the last READ */
+    unsigned seq_count;     /* length of the current sequential run */
+
     uint32_t check_align; /* If non-zero, check for aligned client requests */
 
     NBDMode mode;
@@ -1845,6 +1881,7 @@ static int nbd_export_create(BlockExport *blk_exp, BlockExportOptions *exp_args,
     }
 
     QTAILQ_INIT(&exp->clients);
+    qemu_co_queue_init(&exp->sched_wait);
     exp->name = g_strdup(name);
     exp->description = g_strdup(arg->description);
     exp->nbdflags = (NBD_FLAG_HAS_FLAGS | NBD_FLAG_SEND_FLUSH |
@@ -2010,6 +2047,10 @@ static void nbd_export_delete(BlockExport *blk_exp)
     g_free(exp->description);
     exp->description = NULL;
 
+    for (i = 0; i < NBD_READ_AHEAD_SLOTS; i++) {
+        qemu_vfree(exp->read_ahead[i].data);
+    }
+
     if (exp->eject_notifier_blk) {
         notifier_remove(&exp->eject_notifier);
         blk_unref(exp->eject_notifier_blk);
@@ -2032,6 +2073,17 @@ const BlockExportDriver blk_exp_nbd = {
     .request_shutdown   = nbd_export_request_shutdown,
 };
 
+/*
+ * Transmit one reply (header plus optional payload) to the client.
+ *
+ * Read payloads are sent from the bounce buffer that blk_co_pread()
+ * filled.  A splice()/sendfile() zero-copy path is not possible here:
+ * the export is backed by the block graph (format drivers, filters,
+ * network protocols), not by a host file descriptor that the kernel
+ * could splice from, and client->ioc may be a TLS channel that has to
+ * see the plaintext anyway.  Gathering the header and payload into a
+ * single writev() below is as close to zero-copy as this path can get.
+ */
 static int coroutine_fn nbd_co_send_iov(NBDClient *client, struct iovec *iov,
                                         unsigned niov, Error **errp)
 {
@@ -2819,6 +2871,163 @@ static int coroutine_fn nbd_co_receive_request(NBDRequestData *req,
     return 0;
 }
 
+/*
+ * Fair scheduling across the clients of an export: deficit round robin
+ * over request payload bytes.  Each client may consume up to
+ * NBD_SCHED_QUANTUM bytes per round; once over quota it waits until no
+ * under-quota request is in flight any more, at which point a new
+ * round starts.  This keeps one greedy client from monopolizing the
+ * export while leaving a lone client entirely unthrottled.
+ */
+static void coroutine_fn nbd_export_sched_request(NBDClient *client,
+                                                  NBDRequest *request)
+{
+    NBDExport *exp = client->exp;
+
+    /*
+     * A lone client has nobody to be fair to.  Skip the byte accounting
+     * entirely so that a deep pipeline of large requests is never parked
+     * on the round barrier.
+     */
+    if (!QTAILQ_NEXT(QTAILQ_FIRST(&exp->clients), next)) {
+        exp->sched_dispatched++;
+        return;
+    }
+
+    if (client->sched_round != exp->sched_round) {
+        client->sched_round = exp->sched_round;
+        client->sched_bytes = 0;
+    }
+
+    while (client->sched_bytes >= NBD_SCHED_QUANTUM) {
+        if (!exp->sched_dispatched) {
+            /* Nobody under quota is making progress; start a new round. */
+            exp->sched_round++;
+            trace_nbd_sched_new_round(exp->sched_round);
+            qemu_co_queue_restart_all(&exp->sched_wait);
+        } else {
+            qemu_co_queue_wait(&exp->sched_wait, NULL);
+        }
+        if (client->sched_round != exp->sched_round) {
+            client->sched_round = exp->sched_round;
+            client->sched_bytes = 0;
+        }
+    }
+
+    client->sched_bytes += request->len;
+    exp->sched_dispatched++;
+}
+
+static void coroutine_fn nbd_export_sched_complete(NBDClient *client)
+{
+    NBDExport *exp = client->exp;
+
+    assert(exp->sched_dispatched > 0);
+    exp->sched_dispatched--;
+    if (!exp->sched_dispatched && !qemu_co_queue_empty(&exp->sched_wait)) {
+        exp->sched_round++;
+        trace_nbd_sched_new_round(exp->sched_round);
+        qemu_co_queue_restart_all(&exp->sched_wait);
+    }
+}
+
+/* Serve a READ from the read-ahead cache, if it is fully covered */
+static bool nbd_export_read_ahead_lookup(NBDExport *exp, uint64_t from,
+                                         uint64_t len, uint8_t *data)
+{
+    int i;
+
+    for (i = 0; i < NBD_READ_AHEAD_SLOTS; i++) {
+        NBDReadAheadSlot *slot = &exp->read_ahead[i];
+
+        if (slot->len && from >= slot->from &&
+            len <= slot->from + slot->len - from) {
+            memcpy(data, slot->data + (from - slot->from), len);
+            trace_nbd_read_ahead_hit(from, len);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Prefetch the next chunk of a sequential stream into the cache shared
+ * by all clients of the export.  Called with the reply for the
+ * triggering READ already on the wire, so the block layer read overlaps
+ * with the client receiving the reply and sending its next request.
+ */
+static void coroutine_fn nbd_export_read_ahead(NBDClient *client)
+{
+    NBDExport *exp = client->exp;
+    NBDReadAheadSlot *slot = NULL;
+    uint64_t from = client->seq_next_from;
+    uint64_t len;
+    unsigned gen;
+    int i;
+
+    if (client->seq_count < NBD_READ_AHEAD_MIN_SEQ || from >= exp->size) {
+        return;
+    }
+    len = MIN(NBD_READ_AHEAD_SIZE, exp->size - from);
+
+    for (i = 0; i < NBD_READ_AHEAD_SLOTS; i++) {
+        NBDReadAheadSlot *s = &exp->read_ahead[i];
+
+        if ((s->len || s->filling) && from >= s->from &&
+            from < s->from + (s->filling ? NBD_READ_AHEAD_SIZE : s->len)) {
+            /* Already cached, or another client is fetching it */
+            return;
+        }
+        if (!slot && !s->len && !s->filling) {
+            slot = s;
+        }
+    }
+    if (!slot) {
+        slot = &exp->read_ahead[exp->read_ahead_next++ % NBD_READ_AHEAD_SLOTS];
+        if (slot->filling) {
+            return;
+        }
+    }
+
+    if (!slot->data) {
+        slot->data = blk_blockalign(exp->common.blk, NBD_READ_AHEAD_SIZE);
+    }
+    slot->from = from;
+    slot->len = 0;
+    slot->filling = true;
+    gen = slot->gen;
+
+    trace_nbd_read_ahead_fill(from, len);
+    if (blk_co_pread(exp->common.blk, from, len, slot->data, 0) == 0 &&
+        slot->gen == gen) {
+        slot->len = len;
+    }
+    slot->filling = false;
+}
+
+/*
+ * Drop cached data overlapping [@from, @from + @len) and cancel
+ * overlapping in-flight fills.  Must be called after the modifying
+ * request completed but before its reply is sent, so that a client
+ * that saw the reply cannot read stale data.
+ */
+static void nbd_export_read_ahead_invalidate(NBDExport *exp, uint64_t from,
+                                             uint64_t len)
+{
+    int i;
+
+    for (i = 0; i < NBD_READ_AHEAD_SLOTS; i++) {
+        NBDReadAheadSlot *slot = &exp->read_ahead[i];
+        uint64_t slot_len = slot->filling ? NBD_READ_AHEAD_SIZE : slot->len;
+
+        if (slot_len && slot->from < from + len &&
+            from < slot->from + slot_len) {
+            slot->len = 0;
+            slot->gen++;
+        }
+    }
+}
+
 /* Send simple reply without a payload, or a structured error
  * @error_msg is ignored if @ret >= 0
  * Returns 0 if connection is still live, -errno on failure to talk to client
@@ -2860,14 +3069,22 @@ static coroutine_fn int nbd_do_cmd_read(NBDClient *client, NBDRequest *request,
         }
     }
 
-    if (client->mode >= NBD_MODE_STRUCTURED &&
-        !(request->flags & NBD_CMD_FLAG_DF) && request->len)
+    /*
+     * A cached read is served as a single data chunk even without
+     * NBD_CMD_FLAG_DF; that is always permitted, the flag merely
+     * forbids fragmenting.
+     */
+    if (nbd_export_read_ahead_lookup(exp, request->from, request->len, data)) {
+        ret = 0;
+    } else if (client->mode >= NBD_MODE_STRUCTURED &&
+               !(request->flags & NBD_CMD_FLAG_DF) && request->len)
     {
         return nbd_co_send_sparse_read(client, request, request->from,
                                        data, request->len, errp);
+    } else {
+        ret = blk_co_pread(exp->common.blk, request->from, request->len,
+                           data, 0);
     }
-
-    ret = blk_co_pread(exp->common.blk, request->from, request->len, data, 0);
     if (ret < 0) {
         return nbd_send_generic_reply(client, request, ret,
                                       "reading from file failed", errp);
@@ -2943,7 +3160,18 @@ static coroutine_fn int nbd_handle_request(NBDClient *client,
         return nbd_do_cmd_cache(client, request, errp);
 
     case NBD_CMD_READ:
-        return nbd_do_cmd_read(client, request, data, errp);
+        if (request->from == client->seq_next_from && request->len) {
+            client->seq_count++;
+        } else {
+            client->seq_count = 1;
+        }
+        client->seq_next_from = request->from + request->len;
+
+        ret = nbd_do_cmd_read(client, request, data, errp);
+        if (ret == 0) {
+            nbd_export_read_ahead(client);
+        }
+        return ret;
 
     case NBD_CMD_WRITE:
         flags = 0;
@@ -2953,6 +3181,7 @@ static coroutine_fn int nbd_handle_request(NBDClient *client,
         assert(request->len <= NBD_MAX_BUFFER_SIZE);
         ret = blk_co_pwrite(exp->common.blk, request->from, request->len, data,
                             flags);
+        nbd_export_read_ahead_invalidate(exp, request->from, request->len);
         return nbd_send_generic_reply(client, request, ret,
                                       "writing to file failed", errp);
 
@@ -2969,6 +3198,7 @@ static coroutine_fn int nbd_handle_request(NBDClient *client,
         }
         ret = blk_co_pwrite_zeroes(exp->common.blk, request->from, request->len,
                                    flags);
+        nbd_export_read_ahead_invalidate(exp, request->from, request->len);
         return nbd_send_generic_reply(client, request, ret,
                                       "writing to file failed", errp);
 
@@ -2983,6 +3213,7 @@ static coroutine_fn int nbd_handle_request(NBDClient *client,
 
     case NBD_CMD_TRIM:
         ret = blk_co_pdiscard(exp->common.blk, request->from, request->len);
+        nbd_export_read_ahead_invalidate(exp, request->from, request->len);
         if (ret >= 0 && request->flags & NBD_CMD_FLAG_FUA) {
             ret = blk_co_flush(exp->common.blk);
         }
@@ -3145,7 +3376,9 @@ static coroutine_fn void nbd_trip(void *opaque)
                                      error_get_pretty(export_err), &local_err);
         error_free(export_err);
     } else {
+        nbd_export_sched_request(client, &request);
         ret = nbd_handle_request(client, &request, req->data, &local_err);
+        nbd_export_sched_complete(client);
     }
     if (request.contexts && request.contexts != &client->contexts) {
         assert(request.type == NBD_CMD_BLOCK_STATUS);
@@ -56,6 +56,12 @@ typedef struct AFXDPState {
 
 #define AF_XDP_BATCH_SIZE 64
 
+/*
+ * Maximum number of Rx descriptors processed in one fd_read() callback.
+ * Keeps a busy queue from starving the rest of the event loop.
+ */
+#define AF_XDP_RX_BUDGET (AF_XDP_BATCH_SIZE * 4)
+
 static void af_xdp_send(void *opaque);
 static void af_xdp_writable(void *opaque);
 
@@ -139,10 +145,29 @@ static void af_xdp_writable(void *opaque)
     qemu_flush_queued_packets(&s->nc);
 }
 
-static ssize_t af_xdp_receive(NetClientState *nc,
-                              const uint8_t *buf, size_t size)
+/*
+ * Kick the kernel Tx path if it went to sleep.  Kicking from the
+ * transmit path directly saves a round trip through the event loop;
+ * if the kernel can't be woken up right now, fall back to polling
+ * for writability and retry from there.
+ */
+static void af_xdp_kick_tx(AFXDPState *s)
+{
+    if (!xsk_ring_prod__needs_wakeup(&s->tx)) {
+        return;
+    }
+
+    if (sendto(xsk_socket__fd(s->xsk), NULL, 0, MSG_DONTWAIT, NULL, 0) < 0 ||
+        xsk_ring_prod__needs_wakeup(&s->tx)) {
+        af_xdp_write_poll(s, true);
+    }
+}
+
+static ssize_t af_xdp_receive_iov(NetClientState *nc,
+                                  const struct iovec *iov, int iovcnt)
 {
     AFXDPState *s = DO_UPCAST(AFXDPState, nc, nc);
+    size_t size = iov_size(iov, iovcnt);
     struct xdp_desc *desc;
     uint32_t idx;
     void *data;
@@ -169,18 +194,27 @@ static ssize_t af_xdp_receive(NetClientState *nc,
     desc->len = size;
 
     data = xsk_umem__get_data(s->buffer, desc->addr);
-    memcpy(data, buf, size);
+    iov_to_buf(iov, iovcnt, 0, data, size);
 
     xsk_ring_prod__submit(&s->tx, 1);
     s->outstanding_tx++;
 
-    if (xsk_ring_prod__needs_wakeup(&s->tx)) {
-        af_xdp_write_poll(s, true);
-    }
+    af_xdp_kick_tx(s);
 
     return size;
 }
 
+static ssize_t af_xdp_receive(NetClientState *nc,
+                              const uint8_t *buf, size_t size)
+{
+    const struct iovec iov = {
+        .iov_base = (void *)buf,
+        .iov_len = size,
+    };
+
+    return af_xdp_receive_iov(nc, &iov, 1);
+}
+
 /*
  * Complete a previous send (backend --> guest) and enable the
  * fd_read callback.
@@ -218,43 +252,54 @@ static void af_xdp_fq_refill(AFXDPState *s, uint32_t n)
 
 static void af_xdp_send(void *opaque)
 {
-    uint32_t i, n_rx, idx = 0;
+    uint32_t budget = AF_XDP_RX_BUDGET;
+    uint32_t i, n_rx, idx;
     AFXDPState *s = opaque;
 
-    n_rx = xsk_ring_cons__peek(&s->rx, AF_XDP_BATCH_SIZE, &idx);
-    if (!n_rx) {
-        return;
-    }
+    do {
+        idx = 0;
+        n_rx = xsk_ring_cons__peek(&s->rx, AF_XDP_BATCH_SIZE, &idx);
+        if (!n_rx) {
+            return;
+        }
 
-    for (i = 0; i < n_rx; i++) {
-        const struct xdp_desc *desc;
-        struct iovec iov;
+        for (i = 0; i < n_rx; i++) {
+            const struct xdp_desc *desc;
+            struct iovec iov;
 
-        desc = xsk_ring_cons__rx_desc(&s->rx, idx++);
+            desc = xsk_ring_cons__rx_desc(&s->rx, idx++);
 
-        iov.iov_base = xsk_umem__get_data(s->buffer, desc->addr);
-        iov.iov_len = desc->len;
+            iov.iov_base = xsk_umem__get_data(s->buffer, desc->addr);
+            iov.iov_len = desc->len;
 
-        s->pool[s->n_pool++] = desc->addr;
+            s->pool[s->n_pool++] = desc->addr;
 
-        if (!qemu_sendv_packet_async(&s->nc, &iov, 1,
-                                     af_xdp_send_completed)) {
-            /*
-             * The peer does not receive anymore.  Packet is queued, stop
-             * reading from the backend until af_xdp_send_completed().
-             */
-            af_xdp_read_poll(s, false);
+            if (!qemu_sendv_packet_async(&s->nc, &iov, 1,
+                                         af_xdp_send_completed)) {
+                /*
+                 * The peer does not receive anymore.  Packet is queued, stop
+                 * reading from the backend until af_xdp_send_completed().
+                 */
+                af_xdp_read_poll(s, false);
 
-            /* Return unused descriptors to not break the ring cache. */
-            xsk_ring_cons__cancel(&s->rx, n_rx - i - 1);
-            n_rx = i + 1;
-            break;
+                /* Return unused descriptors to not break the ring cache. */
+                xsk_ring_cons__cancel(&s->rx, n_rx - i - 1);
+                n_rx = i + 1;
+                break;
+            }
         }
-    }
 
-    /* Release actually sent descriptors and try to re-fill. */
-    xsk_ring_cons__release(&s->rx, n_rx);
-    af_xdp_fq_refill(s, AF_XDP_BATCH_SIZE);
+        /* Release actually sent descriptors and try to re-fill. */
+        xsk_ring_cons__release(&s->rx, n_rx);
+        af_xdp_fq_refill(s, AF_XDP_BATCH_SIZE);
+
+        budget -= n_rx;
+        /*
+         * Keep draining while the ring produces full batches instead of
+         * returning to the event loop for another poll round, but stop
+         * once the budget is spent or the peer stops receiving.
+         */
+    } while (n_rx == AF_XDP_BATCH_SIZE && budget && s->read_poll);
 }
 
 /* Flush and close. */
@@ -401,6 +446,7 @@ static NetClientInfo net_af_xdp_info = {
     .type = NET_CLIENT_DRIVER_AF_XDP,
     .size = sizeof(AFXDPState),
     .receive = af_xdp_receive,
+    .receive_iov = af_xdp_receive_iov,
     .poll = af_xdp_poll,
     .cleanup = af_xdp_cleanup,
 };
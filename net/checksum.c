@@ -21,22 +21,64 @@
 
 uint32_t net_checksum_add_cont(int len, uint8_t *buf, int seq)
 {
-    uint32_t sum1 = 0, sum2 = 0;
-    int i;
+    uint64_t sum = 0;
+    uint32_t res;
 
-    for (i = 0; i < len - 1; i += 2) {
-        sum1 += (uint32_t)buf[i];
-        sum2 += (uint32_t)buf[i + 1];
+    /*
+     * One's-complement sum of the buffer, eight bytes at a time with
+     * end-around carry.  The individual 16-bit words are accumulated in
+     * host byte order and the result is swapped at the end if needed;
+     * the one's-complement sum is invariant under a consistent byte
+     * swap of all its inputs.
+     */
+    while (len >= 8) {
+        uint64_t v = ldq_he_p(buf);
+
+        sum += v;
+        sum += sum < v;
+        buf += 8;
+        len -= 8;
     }
-    if (i < len) {
-        sum1 += (uint32_t)buf[i];
+    if (len >= 4) {
+        uint32_t v = ldl_he_p(buf);
+
+        sum += v;
+        sum += sum < v;
+        buf += 4;
+        len -= 4;
     }
+    if (len >= 2) {
+        uint16_t v = lduw_he_p(buf);
 
-    if (seq & 1) {
-        return sum1 + (sum2 << 8);
-    } else {
-        return sum2 + (sum1 << 8);
+        sum += v;
+        sum += sum < v;
+        buf += 2;
+        len -= 2;
     }
+    if (len) {
+        /* A trailing byte is the high byte of a big-endian word. */
+        uint16_t v = HOST_BIG_ENDIAN ? *buf << 8 : *buf;
+
+        sum += v;
+        sum += sum < v;
+    }
+
+    /* Fold to 16 bits; the carry adds above keep this lossless. */
+    sum = (sum & 0xffffffff) + (sum >> 32);
+    sum = (sum & 0xffffffff) + (sum >> 32);
+    res = (sum & 0xffff) + ((uint32_t)sum >> 16);
+    res = (res & 0xffff) + (res >> 16);
+
+    /*
+     * The caller wants the sum of big-endian words when @seq is even
+     * and of byte-swapped words when it is odd, i.e. continuation
+     * chunks starting at an odd offset swap the byte roles.
+     */
+    if ((seq & 1) == HOST_BIG_ENDIAN) {
+        res = ((res & 0xff) << 8) | (res >> 8);
+    }
+
+    return res;
 }
 
 uint16_t net_checksum_finish(uint32_t sum)
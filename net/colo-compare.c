@@ -18,6 +18,7 @@
 #include "qapi/error.h"
 #include "net/net.h"
 #include "net/eth.h"
+#include "net/checksum.h"
 #include "qom/object_interfaces.h"
 #include "qemu/iov.h"
 #include "qom/object.h"
@@ -343,6 +344,23 @@ static int colo_compare_packet_payload(Packet *ppkt,
     return memcmp(ppkt->data + poffset, spkt->data + soffset, len);
 }
 
+/*
+ * Checksum of the packet from @offset to its end, cached in the packet
+ * so that scanning a queue for a match doesn't have to byte-compare
+ * against every candidate.  Packet payloads are immutable once queued.
+ */
+static uint32_t colo_packet_fingerprint(Packet *pkt, uint16_t offset)
+{
+    if (!pkt->fp_valid || pkt->fp_offset != offset) {
+        pkt->fp_sum = net_checksum_add(pkt->size - offset,
+                                       (uint8_t *)pkt->data + offset);
+        pkt->fp_offset = offset;
+        pkt->fp_valid = true;
+    }
+
+    return pkt->fp_sum;
+}
+
 /*
  * return true means that the payload is consist and
  * need to make the next comparison, false means do
@@ -525,6 +543,11 @@ static int colo_packet_compare_udp(Packet *spkt, Packet *ppkt)
         trace_colo_compare_main("UDP: payload size of packets are different");
         return -1;
     }
+    if (colo_packet_fingerprint(ppkt, offset) !=
+        colo_packet_fingerprint(spkt, offset)) {
+        trace_colo_compare_main("UDP: payload fingerprints are different");
+        return -1;
+    }
     if (colo_compare_packet_payload(ppkt, spkt, offset, offset,
                                     ppkt->size - offset)) {
         trace_colo_compare_udp_miscompare("primary pkt size", ppkt->size);
@@ -564,6 +587,11 @@ static int colo_packet_compare_icmp(Packet *spkt, Packet *ppkt)
         trace_colo_compare_main("ICMP: payload size of packets are different");
         return -1;
     }
+    if (colo_packet_fingerprint(ppkt, offset) !=
+        colo_packet_fingerprint(spkt, offset)) {
+        trace_colo_compare_main("ICMP: payload fingerprints are different");
+        return -1;
+    }
     if (colo_compare_packet_payload(ppkt, spkt, offset, offset,
                                     ppkt->size - offset)) {
         trace_colo_compare_icmp_miscompare("primary pkt size",
@@ -593,6 +621,11 @@ static int colo_packet_compare_other(Packet *spkt, Packet *ppkt)
         trace_colo_compare_main("Other: payload size of packets are different");
         return -1;
     }
+    if (colo_packet_fingerprint(ppkt, offset) !=
+        colo_packet_fingerprint(spkt, offset)) {
+        trace_colo_compare_main("Other: payload fingerprints are different");
+        return -1;
+    }
     return colo_compare_packet_payload(ppkt, spkt, offset, offset,
                                        ppkt->size - offset);
 }
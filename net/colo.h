@@ -55,6 +55,10 @@ typedef struct Packet {
     /* record the payload offset(the length that has been compared) */
     uint16_t offset;
     uint8_t flags; /* Flags(aka Control bits) */
+    /* cached payload sum for the compare fast path, keyed by fp_offset */
+    uint32_t fp_sum;
+    uint16_t fp_offset;
+    bool fp_valid;
 } Packet;
 
 typedef struct ConnectionKey {
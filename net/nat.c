@@ -0,0 +1,961 @@
+/*
+ * In-process stateless NAT network backend.
+ *
+ * Copyright (c) 2026 QEMU contributors
+ *
+ * A minimal unprivileged forwarder: the guest sees an IPv4 gateway and
+ * established TCP and UDP flows are relayed through ordinary host
+ * sockets, one socket per flow, without the per-packet protocol
+ * emulation a full user-mode stack performs.
+ *
+ * The guest-facing link is an in-process queue that cannot lose or
+ * reorder frames (the net core queues packets with a completion
+ * callback when the peer is busy), so the TCP relay needs no
+ * retransmission machinery: out-of-order segments can only be guest
+ * retransmissions and are dropped and re-ACKed.
+ *
+ * Deliberately out of scope: IPv6, IP fragmentation, ICMP forwarding
+ * (echo to the gateway is answered locally), inbound connections and
+ * guest-to-guest traffic.  Guests are expected to configure a static
+ * address; anything that needs DHCP/TFTP/DNS emulation should keep
+ * using the slirp backend.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * later.  See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+
+#include "net/net.h"
+#include "clients.h"
+#include "net/eth.h"
+#include "net/checksum.h"
+#include "qapi/error.h"
+#include "qemu/cutils.h"
+#include "qemu/host-utils.h"
+#include "qemu/jhash.h"
+#include "qemu/main-loop.h"
+#include "qemu/sockets.h"
+#include "qemu/timer.h"
+
+#define NAT_FRAME_MAX           (ETH_HLEN + 1500)
+#define NAT_TCP_MSS             1460
+/* Guest payload buffered per flow while the host socket is full. */
+#define NAT_OUTBUF_MAX          (256 * 1024)
+#define NAT_UDP_TIMEOUT_MS      60000
+#define NAT_EXPIRE_INTERVAL_MS  30000
+
+#define TH_FIN  0x01
+#define TH_SYN  0x02
+#define TH_RST  0x04
+#define TH_PUSH 0x08
+#define TH_ACK  0x10
+
+typedef enum NATTcpState {
+    NAT_TCP_CONNECTING,     /* connect() in flight, SYN-ACK not yet sent */
+    NAT_TCP_ESTABLISHED,
+} NATTcpState;
+
+typedef struct NATFlowKey {
+    uint32_t gaddr;         /* guest address, host byte order */
+    uint32_t faddr;         /* foreign address, host byte order */
+    uint16_t gport;
+    uint16_t fport;
+    uint8_t  proto;
+} QEMU_PACKED NATFlowKey;
+
+typedef struct NetNATState NetNATState;
+
+typedef struct NATFlow {
+    QTAILQ_ENTRY(NATFlow) entry;
+    NetNATState *s;
+    NATFlowKey key;
+    uint8_t guest_mac[ETH_ALEN];
+    int fd;
+    int64_t last_used_ms;
+
+    /* TCP relay state; sequence numbers in host byte order */
+    NATTcpState tcp_state;
+    uint32_t iss;           /* our initial sequence number */
+    uint32_t snd_nxt;       /* next sequence we send to the guest */
+    uint32_t rcv_nxt;       /* next sequence we expect from the guest */
+    uint32_t snd_wnd_edge;  /* guest ack + window: highest usable seq */
+    bool fin_sent;
+    bool fin_acked;
+    bool guest_fin;
+    bool sock_shut_wr;
+
+    /* guest payload the host socket couldn't take yet */
+    uint8_t *outbuf;
+    uint32_t outlen;
+} NATFlow;
+
+struct NetNATState {
+    NetClientState nc;
+    uint32_t net;           /* all addresses in host byte order */
+    uint32_t mask;
+    uint32_t host;
+    uint8_t host_mac[ETH_ALEN];
+    uint16_t ip_id;
+    /* the peer stopped receiving; resumed from the sent callback */
+    bool congested;
+    GHashTable *flow_table;
+    QTAILQ_HEAD(, NATFlow) flows;
+    QEMUTimer *expire_timer;
+};
+
+struct nat_arp_hdr {
+    uint16_t ar_hrd;
+    uint16_t ar_pro;
+    uint8_t  ar_hln;
+    uint8_t  ar_pln;
+    uint16_t ar_op;
+    uint8_t  ar_sha[ETH_ALEN];
+    uint32_t ar_sip;
+    uint8_t  ar_tha[ETH_ALEN];
+    uint32_t ar_tip;
+} QEMU_PACKED;
+
+#define NAT_ARP_REQUEST     1
+#define NAT_ARP_REPLY       2
+
+#define NAT_ICMP_ECHOREPLY  0
+#define NAT_ICMP_ECHO       8
+
+static inline bool nat_seq_after(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+static guint nat_flow_key_hash(gconstpointer opaque)
+{
+    const NATFlowKey *key = opaque;
+    uint32_t a, b, c;
+
+    /* Jenkins hash, as net/colo.c uses for its connection table */
+    a = b = c = JHASH_INITVAL + sizeof(*key);
+    a += key->gaddr;
+    b += key->faddr;
+    c += (key->gport | key->fport << 16);
+    __jhash_mix(a, b, c);
+
+    a += key->proto;
+    __jhash_final(a, b, c);
+
+    return c;
+}
+
+static gboolean nat_flow_key_equal(gconstpointer a, gconstpointer b)
+{
+    return memcmp(a, b, sizeof(NATFlowKey)) == 0;
+}
+
+static void nat_flow_fd_read(void *opaque);
+static void nat_flow_fd_write(void *opaque);
+
+/* Re-evaluate which fd events a flow needs to see. */
+static void nat_flow_update_poll(NATFlow *f)
+{
+    bool read_poll, write_poll;
+
+    if (f->fd < 0) {
+        return;
+    }
+
+    if (f->key.proto == IPPROTO_UDP) {
+        read_poll = true;
+        write_poll = false;
+    } else if (f->tcp_state == NAT_TCP_CONNECTING) {
+        read_poll = false;
+        write_poll = true;
+    } else {
+        read_poll = !f->fin_sent && !f->s->congested &&
+                    (int32_t)(f->snd_wnd_edge - f->snd_nxt) > 0;
+        write_poll = f->outlen > 0;
+    }
+
+    qemu_set_fd_handler(f->fd,
+                        read_poll ? nat_flow_fd_read : NULL,
+                        write_poll ? nat_flow_fd_write : NULL,
+                        f);
+}
+
+static void nat_flow_free(NATFlow *f)
+{
+    NetNATState *s = f->s;
+
+    if (f->fd >= 0) {
+        qemu_set_fd_handler(f->fd, NULL, NULL, NULL);
+        close(f->fd);
+    }
+    g_hash_table_remove(s->flow_table, &f->key);
+    QTAILQ_REMOVE(&s->flows, f, entry);
+    g_free(f->outbuf);
+    g_free(f);
+}
+
+static NATFlow *nat_flow_new(NetNATState *s, const NATFlowKey *key,
+                             const uint8_t *guest_mac)
+{
+    NATFlow *f = g_new0(NATFlow, 1);
+
+    f->s = s;
+    f->key = *key;
+    f->fd = -1;
+    memcpy(f->guest_mac, guest_mac, ETH_ALEN);
+    f->last_used_ms = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
+
+    g_hash_table_insert(s->flow_table, &f->key, f);
+    QTAILQ_INSERT_TAIL(&s->flows, f, entry);
+
+    return f;
+}
+
+static NATFlow *nat_flow_find(NetNATState *s, const NATFlowKey *key)
+{
+    return g_hash_table_lookup(s->flow_table, key);
+}
+
+/*
+ * Fill in the Ethernet and IP headers of a frame to the guest and
+ * return a pointer to the L4 header.
+ */
+static uint8_t *nat_frame_begin(NetNATState *s, uint8_t *frame,
+                                const uint8_t *guest_mac, uint8_t proto,
+                                uint32_t saddr, uint32_t daddr, int l4len)
+{
+    struct eth_header *eth = (struct eth_header *)frame;
+    struct ip_header *ip = (struct ip_header *)(frame + ETH_HLEN);
+
+    memcpy(eth->h_dest, guest_mac, ETH_ALEN);
+    memcpy(eth->h_source, s->host_mac, ETH_ALEN);
+    eth->h_proto = cpu_to_be16(ETH_P_IP);
+
+    ip->ip_ver_len = 0x45;
+    ip->ip_tos = 0;
+    stw_be_p(&ip->ip_len, sizeof(*ip) + l4len);
+    stw_be_p(&ip->ip_id, s->ip_id++);
+    ip->ip_off = 0;
+    ip->ip_ttl = 64;
+    ip->ip_p = proto;
+    ip->ip_sum = 0;
+    stl_be_p(&ip->ip_src, saddr);
+    stl_be_p(&ip->ip_dst, daddr);
+    eth_fix_ip4_checksum(ip, sizeof(*ip));
+
+    return (uint8_t *)(ip + 1);
+}
+
+static uint16_t nat_tcp_window(NATFlow *f)
+{
+    return MIN(NAT_OUTBUF_MAX - f->outlen, 65535);
+}
+
+/*
+ * Send a TCP segment to the guest.  Data segments go through the
+ * asynchronous path so a busy peer queues them instead of dropping;
+ * control segments are fire-and-forget, the guest recovers a lost one
+ * by retransmitting whatever it was acknowledging.
+ */
+static ssize_t nat_tcp_output(NATFlow *f, uint8_t flags, uint32_t seq,
+                              const uint8_t *data, int len,
+                              NetPacketSent *sent_cb)
+{
+    NetNATState *s = f->s;
+    uint8_t frame[NAT_FRAME_MAX];
+    int hlen = sizeof(tcp_header) + ((flags & TH_SYN) ? 4 : 0);
+    uint8_t *l4 = nat_frame_begin(s, frame, f->guest_mac, IPPROTO_TCP,
+                                  f->key.faddr, f->key.gaddr, hlen + len);
+    tcp_header *th = (tcp_header *)l4;
+    uint16_t csum;
+
+    stw_be_p(&th->th_sport, f->key.fport);
+    stw_be_p(&th->th_dport, f->key.gport);
+    stl_be_p(&th->th_seq, seq);
+    stl_be_p(&th->th_ack, (flags & TH_ACK) ? f->rcv_nxt : 0);
+    stw_be_p(&th->th_offset_flags, ((hlen >> 2) << 12) | flags);
+    stw_be_p(&th->th_win, nat_tcp_window(f));
+    th->th_sum = 0;
+    th->th_urp = 0;
+    if (flags & TH_SYN) {
+        /* MSS option; without it the guest would assume 536 bytes */
+        l4[sizeof(*th)] = 2;
+        l4[sizeof(*th) + 1] = 4;
+        stw_be_p(&l4[sizeof(*th) + 2], NAT_TCP_MSS);
+    }
+    if (len) {
+        memcpy(l4 + hlen, data, len);
+    }
+    csum = net_checksum_tcpudp(hlen + len, IPPROTO_TCP,
+                               frame + ETH_HLEN +
+                               offsetof(struct ip_header, ip_src), l4);
+    stw_be_p(&th->th_sum, csum);
+
+    len += ETH_HLEN + sizeof(struct ip_header) + hlen;
+    if (sent_cb) {
+        return qemu_send_packet_async(&s->nc, frame, len, sent_cb);
+    }
+    return qemu_send_packet(&s->nc, frame, len);
+}
+
+/* RFC 793 reset generation for segments that match no flow. */
+static void nat_tcp_send_rst(NetNATState *s, const struct eth_header *eth,
+                             uint32_t saddr, uint32_t daddr,
+                             uint16_t sport, uint16_t dport,
+                             uint8_t flags, uint32_t seq, uint32_t ack,
+                             int plen)
+{
+    uint8_t frame[NAT_FRAME_MAX];
+    uint8_t *l4 = nat_frame_begin(s, frame, eth->h_source, IPPROTO_TCP,
+                                  daddr, saddr, sizeof(tcp_header));
+    tcp_header *th = (tcp_header *)l4;
+    uint16_t csum;
+
+    stw_be_p(&th->th_sport, dport);
+    stw_be_p(&th->th_dport, sport);
+    if (flags & TH_ACK) {
+        stl_be_p(&th->th_seq, ack);
+        stl_be_p(&th->th_ack, 0);
+        stw_be_p(&th->th_offset_flags, (5 << 12) | TH_RST);
+    } else {
+        stl_be_p(&th->th_seq, 0);
+        stl_be_p(&th->th_ack,
+                 seq + plen + !!(flags & TH_SYN) + !!(flags & TH_FIN));
+        stw_be_p(&th->th_offset_flags, (5 << 12) | TH_RST | TH_ACK);
+    }
+    th->th_win = 0;
+    th->th_sum = 0;
+    th->th_urp = 0;
+    csum = net_checksum_tcpudp(sizeof(*th), IPPROTO_TCP,
+                               frame + ETH_HLEN +
+                               offsetof(struct ip_header, ip_src), l4);
+    stw_be_p(&th->th_sum, csum);
+
+    qemu_send_packet(&s->nc, frame,
+                     ETH_HLEN + sizeof(struct ip_header) + sizeof(*th));
+}
+
+static void nat_tcp_abort(NATFlow *f)
+{
+    nat_tcp_output(f, TH_RST | TH_ACK, f->snd_nxt, NULL, 0, NULL);
+    nat_flow_free(f);
+}
+
+/* Returns true if the flow was freed and must not be touched again. */
+static bool nat_tcp_maybe_free(NATFlow *f)
+{
+    if (f->fin_sent && f->fin_acked && f->guest_fin && !f->outlen) {
+        nat_flow_free(f);
+        return true;
+    }
+    return false;
+}
+
+static void nat_send_completed(NetClientState *nc, ssize_t len)
+{
+    NetNATState *s = DO_UPCAST(NetNATState, nc, nc);
+    NATFlow *f;
+
+    s->congested = false;
+    QTAILQ_FOREACH(f, &s->flows, entry) {
+        nat_flow_update_poll(f);
+    }
+}
+
+/* The host socket has data (or EOF) for the guest. */
+static void nat_tcp_fd_read(NATFlow *f)
+{
+    uint8_t buf[NAT_TCP_MSS];
+    int budget = 32;
+
+    while (budget--) {
+        int32_t wnd = f->snd_wnd_edge - f->snd_nxt;
+        ssize_t n;
+
+        if (wnd <= 0) {
+            /* Guest window is closed; an ACK will reopen polling. */
+            break;
+        }
+
+        n = recv(f->fd, buf, MIN(wnd, NAT_TCP_MSS), 0);
+        if (n == 0) {
+            nat_tcp_output(f, TH_FIN | TH_ACK, f->snd_nxt, NULL, 0, NULL);
+            f->snd_nxt++;
+            f->fin_sent = true;
+            break;
+        }
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                nat_tcp_abort(f);
+                return;
+            }
+            break;
+        }
+
+        if (!nat_tcp_output(f, TH_PUSH | TH_ACK, f->snd_nxt, buf, n,
+                            nat_send_completed)) {
+            f->s->congested = true;
+        }
+        f->snd_nxt += n;
+        if (f->s->congested) {
+            break;
+        }
+    }
+
+    nat_flow_update_poll(f);
+}
+
+/* Push buffered guest payload into the host socket. */
+static bool nat_tcp_flush_outbuf(NATFlow *f)
+{
+    while (f->outlen) {
+        ssize_t n = send(f->fd, f->outbuf, f->outlen, 0);
+
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return true;
+            }
+            nat_tcp_abort(f);
+            return false;
+        }
+        f->outlen -= n;
+        memmove(f->outbuf, f->outbuf + n, f->outlen);
+    }
+
+    if (f->guest_fin && !f->sock_shut_wr) {
+        shutdown(f->fd, SHUT_WR);
+        f->sock_shut_wr = true;
+    }
+    return true;
+}
+
+static void nat_tcp_fd_write(NATFlow *f)
+{
+    if (f->tcp_state == NAT_TCP_CONNECTING) {
+        int err = 0;
+        socklen_t errlen = sizeof(err);
+
+        if (getsockopt(f->fd, SOL_SOCKET, SO_ERROR, &err, &errlen) < 0 ||
+            err != 0) {
+            nat_tcp_abort(f);
+            return;
+        }
+        nat_tcp_output(f, TH_SYN | TH_ACK, f->iss, NULL, 0, NULL);
+        f->snd_nxt = f->iss + 1;
+        f->tcp_state = NAT_TCP_ESTABLISHED;
+        nat_flow_update_poll(f);
+        return;
+    }
+
+    if (nat_tcp_flush_outbuf(f)) {
+        /* Freed buffer space is a window update for the guest. */
+        nat_tcp_output(f, TH_ACK, f->snd_nxt, NULL, 0, NULL);
+        if (nat_tcp_maybe_free(f)) {
+            return;
+        }
+        if (!f->outlen) {
+            nat_flow_update_poll(f);
+        }
+    }
+}
+
+/* Accept in-order guest payload, buffering what the socket won't take. */
+static uint32_t nat_tcp_take_payload(NATFlow *f, const uint8_t *data,
+                                     uint32_t len)
+{
+    uint32_t taken = 0;
+
+    if (!f->outlen) {
+        ssize_t n = send(f->fd, data, len, 0);
+
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                nat_tcp_abort(f);
+                return -1;
+            }
+            n = 0;
+        }
+        data += n;
+        len -= n;
+        taken += n;
+    }
+
+    if (len) {
+        uint32_t space;
+
+        if (!f->outbuf) {
+            f->outbuf = g_malloc(NAT_OUTBUF_MAX);
+        }
+        space = NAT_OUTBUF_MAX - f->outlen;
+        len = MIN(len, space);
+        memcpy(f->outbuf + f->outlen, data, len);
+        f->outlen += len;
+        taken += len;
+        nat_flow_update_poll(f);
+    }
+
+    return taken;
+}
+
+static void nat_tcp_input(NetNATState *s, const struct eth_header *eth,
+                          uint32_t saddr, uint32_t daddr,
+                          const uint8_t *l4, int l4len)
+{
+    const tcp_header *th = (const tcp_header *)l4;
+    NATFlowKey key = { .proto = IPPROTO_TCP };
+    uint8_t flags;
+    uint32_t seq, ack;
+    int hlen, plen;
+    NATFlow *f;
+
+    if (l4len < sizeof(*th)) {
+        return;
+    }
+    hlen = TCP_HEADER_DATA_OFFSET(th);
+    if (hlen < sizeof(*th) || hlen > l4len) {
+        return;
+    }
+    flags = TCP_HEADER_FLAGS(th) & 0x3f;
+    seq = ldl_be_p(&th->th_seq);
+    ack = ldl_be_p(&th->th_ack);
+    plen = l4len - hlen;
+
+    key.gaddr = saddr;
+    key.faddr = daddr;
+    key.gport = lduw_be_p(&th->th_sport);
+    key.fport = lduw_be_p(&th->th_dport);
+
+    f = nat_flow_find(s, &key);
+    if (!f) {
+        struct sockaddr_in sin = {
+            .sin_family = AF_INET,
+            .sin_port = htons(key.fport),
+            .sin_addr.s_addr = htonl(key.faddr),
+        };
+
+        if ((flags & (TH_SYN | TH_ACK | TH_RST)) != TH_SYN) {
+            if (!(flags & TH_RST)) {
+                nat_tcp_send_rst(s, eth, saddr, daddr, key.gport, key.fport,
+                                 flags, seq, ack, plen);
+            }
+            return;
+        }
+
+        f = nat_flow_new(s, &key, eth->h_source);
+        f->fd = qemu_socket(PF_INET, SOCK_STREAM, 0);
+        if (f->fd < 0) {
+            nat_flow_free(f);
+            return;
+        }
+        qemu_socket_set_nonblock(f->fd);
+        if (connect(f->fd, (struct sockaddr *)&sin, sizeof(sin)) < 0 &&
+            errno != EINPROGRESS) {
+            f->rcv_nxt = seq + 1;
+            nat_tcp_abort(f);
+            return;
+        }
+        f->rcv_nxt = seq + 1;
+        f->iss = g_random_int();
+        f->snd_nxt = f->iss;
+        f->snd_wnd_edge = f->iss + 1 + lduw_be_p(&th->th_win);
+        f->tcp_state = NAT_TCP_CONNECTING;
+        nat_flow_update_poll(f);
+        return;
+    }
+
+    f->last_used_ms = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
+
+    if (flags & TH_RST) {
+        nat_flow_free(f);
+        return;
+    }
+    if (flags & TH_SYN) {
+        /* Retransmitted SYN: our SYN-ACK hasn't reached the guest yet. */
+        if (f->tcp_state == NAT_TCP_ESTABLISHED) {
+            nat_tcp_output(f, TH_SYN | TH_ACK, f->iss, NULL, 0, NULL);
+        }
+        return;
+    }
+    if (f->tcp_state == NAT_TCP_CONNECTING || !(flags & TH_ACK)) {
+        return;
+    }
+
+    /* Advance the usable window edge; ACKs never move it back. */
+    if (nat_seq_after(ack + lduw_be_p(&th->th_win), f->snd_wnd_edge)) {
+        f->snd_wnd_edge = ack + lduw_be_p(&th->th_win);
+    }
+    if (f->fin_sent && ack == f->snd_nxt) {
+        f->fin_acked = true;
+    }
+
+    if (plen) {
+        if (seq == f->rcv_nxt) {
+            uint32_t taken = nat_tcp_take_payload(f, l4 + hlen, plen);
+
+            if (taken == (uint32_t)-1) {
+                return; /* flow aborted */
+            }
+            f->rcv_nxt += taken;
+        }
+        /* Anything else is a guest retransmission; just re-ACK below. */
+    }
+
+    if ((flags & TH_FIN) && !f->guest_fin && seq + plen == f->rcv_nxt) {
+        f->guest_fin = true;
+        f->rcv_nxt++;
+        if (!f->outlen && !f->sock_shut_wr) {
+            shutdown(f->fd, SHUT_WR);
+            f->sock_shut_wr = true;
+        }
+    }
+
+    if (plen || (flags & (TH_FIN | TH_SYN))) {
+        nat_tcp_output(f, TH_ACK, f->snd_nxt, NULL, 0, NULL);
+    }
+
+    if (!nat_tcp_maybe_free(f)) {
+        nat_flow_update_poll(f);
+    }
+}
+
+static void nat_udp_fd_read(NATFlow *f)
+{
+    NetNATState *s = f->s;
+    uint8_t frame[NAT_FRAME_MAX];
+    int max_payload = NAT_FRAME_MAX - ETH_HLEN - sizeof(struct ip_header) -
+                      sizeof(udp_header);
+    int budget = 32;
+
+    while (budget--) {
+        uint8_t *l4 = nat_frame_begin(s, frame, f->guest_mac, IPPROTO_UDP,
+                                      f->key.faddr, f->key.gaddr, 0);
+        udp_header *uh = (udp_header *)l4;
+        uint8_t *payload = l4 + sizeof(*uh);
+        struct ip_header *ip = (struct ip_header *)(frame + ETH_HLEN);
+        uint16_t csum;
+        ssize_t n;
+
+        n = recv(f->fd, payload, max_payload, 0);
+        if (n < 0) {
+            return;
+        }
+
+        /* Rewrite the IP length now that the payload size is known. */
+        stw_be_p(&ip->ip_len, sizeof(*ip) + sizeof(*uh) + n);
+        ip->ip_sum = 0;
+        eth_fix_ip4_checksum(ip, sizeof(*ip));
+
+        stw_be_p(&uh->uh_sport, f->key.fport);
+        stw_be_p(&uh->uh_dport, f->key.gport);
+        stw_be_p(&uh->uh_ulen, sizeof(*uh) + n);
+        uh->uh_sum = 0;
+        csum = net_checksum_tcpudp(sizeof(*uh) + n, IPPROTO_UDP,
+                                   frame + ETH_HLEN +
+                                   offsetof(struct ip_header, ip_src), l4);
+        stw_be_p(&uh->uh_sum, csum ? csum : 0xffff);
+
+        f->last_used_ms = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
+        qemu_send_packet(&s->nc, frame,
+                         ETH_HLEN + sizeof(*ip) + sizeof(*uh) + n);
+    }
+}
+
+static void nat_udp_input(NetNATState *s, const struct eth_header *eth,
+                          uint32_t saddr, uint32_t daddr,
+                          const uint8_t *l4, int l4len)
+{
+    const udp_header *uh = (const udp_header *)l4;
+    NATFlowKey key = { .proto = IPPROTO_UDP };
+    NATFlow *f;
+    int ulen, plen;
+
+    if (l4len < sizeof(*uh)) {
+        return;
+    }
+    ulen = lduw_be_p(&uh->uh_ulen);
+    plen = MIN(ulen, l4len) - (int)sizeof(*uh);
+    if (plen < 0) {
+        return;
+    }
+
+    key.gaddr = saddr;
+    key.faddr = daddr;
+    key.gport = lduw_be_p(&uh->uh_sport);
+    key.fport = lduw_be_p(&uh->uh_dport);
+
+    f = nat_flow_find(s, &key);
+    if (!f) {
+        struct sockaddr_in sin = {
+            .sin_family = AF_INET,
+            .sin_port = htons(key.fport),
+            .sin_addr.s_addr = htonl(key.faddr),
+        };
+
+        f = nat_flow_new(s, &key, eth->h_source);
+        f->fd = qemu_socket(PF_INET, SOCK_DGRAM, 0);
+        if (f->fd < 0 ||
+            connect(f->fd, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
+            nat_flow_free(f);
+            return;
+        }
+        qemu_socket_set_nonblock(f->fd);
+        nat_flow_update_poll(f);
+    }
+
+    f->last_used_ms = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
+    /* A full socket buffer just drops the datagram, as UDP may. */
+    send(f->fd, l4 + sizeof(*uh), plen, 0);
+}
+
+static void nat_flow_fd_read(void *opaque)
+{
+    NATFlow *f = opaque;
+
+    if (f->key.proto == IPPROTO_TCP) {
+        nat_tcp_fd_read(f);
+    } else {
+        nat_udp_fd_read(f);
+    }
+}
+
+static void nat_flow_fd_write(void *opaque)
+{
+    nat_tcp_fd_write(opaque);
+}
+
+static void nat_arp_input(NetNATState *s, const struct eth_header *eth,
+                          const uint8_t *data, int len)
+{
+    const struct nat_arp_hdr *arp = (const struct nat_arp_hdr *)data;
+    uint8_t frame[ETH_HLEN + sizeof(struct nat_arp_hdr)];
+    struct eth_header *reth = (struct eth_header *)frame;
+    struct nat_arp_hdr *rarp = (struct nat_arp_hdr *)(frame + ETH_HLEN);
+
+    if (len < sizeof(*arp) ||
+        lduw_be_p(&arp->ar_op) != NAT_ARP_REQUEST ||
+        ldl_be_p(&arp->ar_tip) != s->host) {
+        return;
+    }
+
+    memcpy(reth->h_dest, eth->h_source, ETH_ALEN);
+    memcpy(reth->h_source, s->host_mac, ETH_ALEN);
+    reth->h_proto = cpu_to_be16(ETH_P_ARP);
+
+    stw_be_p(&rarp->ar_hrd, 1);
+    stw_be_p(&rarp->ar_pro, ETH_P_IP);
+    rarp->ar_hln = ETH_ALEN;
+    rarp->ar_pln = 4;
+    stw_be_p(&rarp->ar_op, NAT_ARP_REPLY);
+    memcpy(rarp->ar_sha, s->host_mac, ETH_ALEN);
+    stl_be_p(&rarp->ar_sip, s->host);
+    memcpy(rarp->ar_tha, arp->ar_sha, ETH_ALEN);
+    rarp->ar_tip = arp->ar_sip;
+
+    qemu_send_packet(&s->nc, frame, sizeof(frame));
+}
+
+static void nat_icmp_input(NetNATState *s, const struct eth_header *eth,
+                           uint32_t saddr, const uint8_t *l4, int l4len)
+{
+    uint8_t frame[NAT_FRAME_MAX];
+    uint8_t *rl4;
+
+    if (l4len < 8 || l4[0] != NAT_ICMP_ECHO || l4[1] != 0 ||
+        l4len > NAT_FRAME_MAX - ETH_HLEN - (int)sizeof(struct ip_header)) {
+        return;
+    }
+
+    rl4 = nat_frame_begin(s, frame, eth->h_source, IPPROTO_ICMP,
+                          s->host, saddr, l4len);
+    memcpy(rl4, l4, l4len);
+    rl4[0] = NAT_ICMP_ECHOREPLY;
+    stw_be_p(&rl4[2], 0);
+    stw_be_p(&rl4[2], net_raw_checksum(rl4, l4len));
+
+    qemu_send_packet(&s->nc, frame,
+                     ETH_HLEN + sizeof(struct ip_header) + l4len);
+}
+
+static void nat_ip_input(NetNATState *s, const struct eth_header *eth,
+                         const uint8_t *l3, int len)
+{
+    const struct ip_header *ip = (const struct ip_header *)l3;
+    uint32_t saddr, daddr;
+    int hlen, tot;
+
+    if (len < sizeof(*ip) || IP_HEADER_VERSION(ip) != IP_HEADER_VERSION_4) {
+        return;
+    }
+    hlen = IP_HDR_GET_LEN(ip);
+    tot = lduw_be_p(&ip->ip_len);
+    if (hlen < sizeof(*ip) || tot < hlen || tot > len) {
+        return;
+    }
+    if (lduw_be_p(&ip->ip_off) & 0x3fff) {
+        return; /* no fragment reassembly */
+    }
+
+    saddr = ldl_be_p(&ip->ip_src);
+    daddr = ldl_be_p(&ip->ip_dst);
+
+    if (daddr == s->host) {
+        if (ip->ip_p == IPPROTO_ICMP) {
+            nat_icmp_input(s, eth, saddr, l3 + hlen, tot - hlen);
+        }
+        return;
+    }
+    if ((daddr & s->mask) == s->net) {
+        return; /* no guest-to-guest forwarding */
+    }
+
+    switch (ip->ip_p) {
+    case IPPROTO_TCP:
+        nat_tcp_input(s, eth, saddr, daddr, l3 + hlen, tot - hlen);
+        break;
+    case IPPROTO_UDP:
+        nat_udp_input(s, eth, saddr, daddr, l3 + hlen, tot - hlen);
+        break;
+    default:
+        break;
+    }
+}
+
+static ssize_t nat_receive(NetClientState *nc, const uint8_t *buf, size_t size)
+{
+    NetNATState *s = DO_UPCAST(NetNATState, nc, nc);
+    const struct eth_header *eth = (const struct eth_header *)buf;
+
+    if (size < sizeof(*eth)) {
+        return size;
+    }
+
+    switch (be16_to_cpu(eth->h_proto)) {
+    case ETH_P_ARP:
+        nat_arp_input(s, eth, buf + ETH_HLEN, size - ETH_HLEN);
+        break;
+    case ETH_P_IP:
+        nat_ip_input(s, eth, buf + ETH_HLEN, size - ETH_HLEN);
+        break;
+    default:
+        /* Unroutable frames are dropped, as a real gateway would. */
+        break;
+    }
+
+    return size;
+}
+
+static void nat_flow_expire(void *opaque)
+{
+    NetNATState *s = opaque;
+    int64_t now = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
+    NATFlow *f, *next;
+
+    QTAILQ_FOREACH_SAFE(f, &s->flows, entry, next) {
+        if (f->key.proto == IPPROTO_UDP &&
+            now - f->last_used_ms > NAT_UDP_TIMEOUT_MS) {
+            nat_flow_free(f);
+        }
+    }
+
+    timer_mod(s->expire_timer, now + NAT_EXPIRE_INTERVAL_MS);
+}
+
+static void nat_cleanup(NetClientState *nc)
+{
+    NetNATState *s = DO_UPCAST(NetNATState, nc, nc);
+    NATFlow *f;
+
+    while ((f = QTAILQ_FIRST(&s->flows))) {
+        nat_flow_free(f);
+    }
+    g_hash_table_destroy(s->flow_table);
+    timer_free(s->expire_timer);
+}
+
+static NetClientInfo net_nat_info = {
+    .type = NET_CLIENT_DRIVER_NAT,
+    .size = sizeof(NetNATState),
+    .receive = nat_receive,
+    .cleanup = nat_cleanup,
+};
+
+static int nat_parse_net(const char *str, uint32_t *net, uint32_t *mask,
+                         Error **errp)
+{
+    g_autofree char *addr = g_strdup(str);
+    char *slash = strchr(addr, '/');
+    unsigned long prefix = 24;
+    struct in_addr in;
+
+    if (slash) {
+        *slash = '\0';
+        if (qemu_strtoul(slash + 1, NULL, 10, &prefix) < 0 ||
+            prefix < 1 || prefix > 30) {
+            error_setg(errp, "invalid network prefix in '%s'", str);
+            return -1;
+        }
+    }
+    if (!inet_aton(addr, &in)) {
+        error_setg(errp, "invalid network address in '%s'", str);
+        return -1;
+    }
+
+    *mask = ~0u << (32 - prefix);
+    *net = ntohl(in.s_addr) & *mask;
+    return 0;
+}
+
+int net_init_nat(const Netdev *netdev, const char *name,
+                 NetClientState *peer, Error **errp)
+{
+    const NetdevNATOptions *opts = &netdev->u.nat;
+    uint32_t net = 0x0a000200;  /* 10.0.2.0/24, slirp-compatible */
+    uint32_t mask = 0xffffff00;
+    NetClientState *nc;
+    NetNATState *s;
+    uint32_t host;
+
+    if (opts->net && nat_parse_net(opts->net, &net, &mask, errp) < 0) {
+        return -1;
+    }
+
+    host = net | 2;
+    if (opts->host) {
+        struct in_addr in;
+
+        if (!inet_aton(opts->host, &in)) {
+            error_setg(errp, "invalid host address '%s'", opts->host);
+            return -1;
+        }
+        host = ntohl(in.s_addr);
+        if ((host & mask) != net) {
+            error_setg(errp, "host address '%s' not in the guest network",
+                       opts->host);
+            return -1;
+        }
+    }
+
+    nc = qemu_new_net_client(&net_nat_info, peer, "nat", name);
+    s = DO_UPCAST(NetNATState, nc, nc);
+
+    s->net = net;
+    s->mask = mask;
+    s->host = host;
+    s->host_mac[0] = 0x52;
+    s->host_mac[1] = 0x55;
+    stl_be_p(&s->host_mac[2], host);
+
+    s->flow_table = g_hash_table_new(nat_flow_key_hash, nat_flow_key_equal);
+    QTAILQ_INIT(&s->flows);
+    s->expire_timer = timer_new_ms(QEMU_CLOCK_REALTIME, nat_flow_expire, s);
+    timer_mod(s->expire_timer,
+              qemu_clock_get_ms(QEMU_CLOCK_REALTIME) + NAT_EXPIRE_INTERVAL_MS);
+
+    qemu_set_info_str(nc, "net=%d.%d.%d.%d/%d,host=%d.%d.%d.%d",
+                      net >> 24, (net >> 16) & 0xff, (net >> 8) & 0xff,
+                      net & 0xff, 32 - ctz32(mask),
+                      host >> 24, (host >> 16) & 0xff, (host >> 8) & 0xff,
+                      host & 0xff);
+
+    return 0;
+}
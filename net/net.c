@@ -599,6 +599,18 @@ int qemu_set_vnet_be(NetClientState *nc, bool is_be)
 #endif
 }
 
+bool qemu_can_set_aio_context(NetClientState *nc)
+{
+    return nc && nc->info->set_aio_context;
+}
+
+void qemu_set_aio_context(NetClientState *nc, AioContext *ctx)
+{
+    assert(qemu_can_set_aio_context(nc));
+
+    nc->info->set_aio_context(nc, ctx);
+}
+
 int qemu_can_receive_packet(NetClientState *nc)
 {
     if (nc->receive_disabled) {
@@ -888,6 +900,37 @@ ssize_t qemu_sendv_packet_async(NetClientState *sender,
                                    iov, iovcnt, sent_cb);
 }
 
+ssize_t qemu_sendv_packet_async_zerocopy(NetClientState *sender,
+                                         const struct iovec *iov, int iovcnt,
+                                         NetPacketSent *sent_cb)
+{
+    NetQueue *queue;
+    size_t size = iov_size(iov, iovcnt);
+
+    if (size > NET_BUFSIZE) {
+        return size;
+    }
+
+    if (sender->link_down || !sender->peer) {
+        return size;
+    }
+
+    /*
+     * Filters may hold on to a copy of the packet and complete it on
+     * their own schedule; keep the copying path when any is attached.
+     */
+    if (!QTAILQ_EMPTY(&sender->filters) ||
+        !QTAILQ_EMPTY(&sender->peer->filters)) {
+        return qemu_sendv_packet_async(sender, iov, iovcnt, sent_cb);
+    }
+
+    queue = sender->peer->incoming_queue;
+
+    return qemu_net_queue_send_iov(queue, sender,
+                                   QEMU_NET_PACKET_FLAG_ZERO_COPY,
+                                   iov, iovcnt, sent_cb);
+}
+
 ssize_t
 qemu_sendv_packet(NetClientState *nc, const struct iovec *iov, int iovcnt)
 {
@@ -1255,6 +1298,7 @@ static int (* const net_client_init_fun[NET_CLIENT_DRIVER__MAX])(
         [NET_CLIENT_DRIVER_SOCKET]    = net_init_socket,
         [NET_CLIENT_DRIVER_STREAM]    = net_init_stream,
         [NET_CLIENT_DRIVER_DGRAM]     = net_init_dgram,
+        [NET_CLIENT_DRIVER_NAT]       = net_init_nat,
 #ifdef CONFIG_VDE
         [NET_CLIENT_DRIVER_VDE]       = net_init_vde,
 #endif
@@ -1351,6 +1395,7 @@ void show_netdevs(void)
         "socket",
         "stream",
         "dgram",
+        "nat",
         "hubport",
         "tap",
 #ifdef CONFIG_SLIRP
@@ -46,9 +46,21 @@ struct NetPacket {
     unsigned flags;
     int size;
     NetPacketSent *sent_cb;
+    /*
+     * Zero-copy packets reference the sender's buffers instead of
+     * copying them into @data; only the iovec array is duplicated.
+     */
+    struct iovec *iov;
+    int iovcnt;
     uint8_t data[];
 };
 
+static void net_packet_free(NetPacket *packet)
+{
+    g_free(packet->iov);
+    g_free(packet);
+}
+
 struct NetQueue {
     void *opaque;
     uint32_t nq_maxlen;
@@ -84,7 +96,7 @@ void qemu_del_net_queue(NetQueue *queue)
 
     QTAILQ_FOREACH_SAFE(packet, &queue->packets, entry, next) {
         QTAILQ_REMOVE(&queue->packets, packet, entry);
-        g_free(packet);
+        net_packet_free(packet);
     }
 
     g_free(queue);
@@ -107,6 +119,8 @@ static void qemu_net_queue_append(NetQueue *queue,
     packet->flags = flags;
     packet->size = size;
     packet->sent_cb = sent_cb;
+    packet->iov = NULL;
+    packet->iovcnt = 0;
     memcpy(packet->data, buf, size);
 
     queue->nq_count++;
@@ -131,11 +145,31 @@ void qemu_net_queue_append_iov(NetQueue *queue,
         max_len += iov[i].iov_len;
     }
 
+    if ((flags & QEMU_NET_PACKET_FLAG_ZERO_COPY) && sent_cb) {
+        /*
+         * The sender keeps the buffers stable until the sent callback
+         * runs, so only the iovec array itself needs to be kept.
+         */
+        packet = g_malloc(sizeof(NetPacket));
+        packet->sender = sender;
+        packet->sent_cb = sent_cb;
+        packet->flags = flags;
+        packet->size = max_len;
+        packet->iov = g_memdup2(iov, iovcnt * sizeof(struct iovec));
+        packet->iovcnt = iovcnt;
+
+        queue->nq_count++;
+        QTAILQ_INSERT_TAIL(&queue->packets, packet, entry);
+        return;
+    }
+
     packet = g_malloc(sizeof(NetPacket) + max_len);
     packet->sender = sender;
     packet->sent_cb = sent_cb;
     packet->flags = flags;
     packet->size = 0;
+    packet->iov = NULL;
+    packet->iovcnt = 0;
 
     for (i = 0; i < iovcnt; i++) {
         size_t len = iov[i].iov_len;
@@ -254,7 +288,7 @@ void qemu_net_queue_purge(NetQueue *queue, NetClientState *from)
             if (packet->sent_cb) {
                 packet->sent_cb(packet->sender, 0);
             }
-            g_free(packet);
+            net_packet_free(packet);
         }
     }
 }
@@ -272,11 +306,19 @@ bool qemu_net_queue_flush(NetQueue *queue)
         QTAILQ_REMOVE(&queue->packets, packet, entry);
         queue->nq_count--;
 
-        ret = qemu_net_queue_deliver(queue,
-                                     packet->sender,
-                                     packet->flags,
-                                     packet->data,
-                                     packet->size);
+        if (packet->iovcnt) {
+            ret = qemu_net_queue_deliver_iov(queue,
+                                             packet->sender,
+                                             packet->flags,
+                                             packet->iov,
+                                             packet->iovcnt);
+        } else {
+            ret = qemu_net_queue_deliver(queue,
+                                         packet->sender,
+                                         packet->flags,
+                                         packet->data,
+                                         packet->size);
+        }
         if (ret == 0) {
             queue->nq_count++;
             QTAILQ_INSERT_HEAD(&queue->packets, packet, entry);
@@ -287,7 +329,7 @@ bool qemu_net_queue_flush(NetQueue *queue)
             packet->sent_cb(packet->sender, ret);
         }
 
-        g_free(packet);
+        net_packet_free(packet);
     }
     return true;
 }
@@ -38,6 +38,7 @@
 #include "monitor/monitor.h"
 #include "system/system.h"
 #include "qapi/error.h"
+#include "block/aio.h"
 #include "qemu/cutils.h"
 #include "qemu/error-report.h"
 #include "qemu/main-loop.h"
@@ -62,6 +63,8 @@ typedef struct TAPState {
     VHostNetState *vhost_net;
     unsigned host_vnet_hdr_len;
     Notifier exit;
+    /* AioContext to poll the fd in, NULL for the main loop */
+    AioContext *ctx;
 } TAPState;
 
 static void launch_script(const char *setup_script, const char *ifname,
@@ -72,10 +75,37 @@ static void tap_writable(void *opaque);
 
 static void tap_update_fd_handler(TAPState *s)
 {
-    qemu_set_fd_handler(s->fd,
-                        s->read_poll && s->enabled ? tap_send : NULL,
-                        s->write_poll && s->enabled ? tap_writable : NULL,
-                        s);
+    IOHandler *read_cb = s->read_poll && s->enabled ? tap_send : NULL;
+    IOHandler *write_cb = s->write_poll && s->enabled ? tap_writable : NULL;
+
+    if (s->ctx) {
+        aio_set_fd_handler(s->ctx, s->fd, read_cb, write_cb, NULL, NULL, s);
+    } else {
+        qemu_set_fd_handler(s->fd, read_cb, write_cb, s);
+    }
+}
+
+static void tap_set_aio_context(NetClientState *nc, AioContext *ctx)
+{
+    TAPState *s = DO_UPCAST(TAPState, nc, nc);
+
+    assert(nc->info->type == NET_CLIENT_DRIVER_TAP);
+
+    if (ctx == qemu_get_aio_context()) {
+        ctx = NULL;
+    }
+    if (s->ctx == ctx) {
+        return;
+    }
+
+    /* Quiesce the fd in its old context before rearming it in the new one */
+    if (s->ctx) {
+        aio_set_fd_handler(s->ctx, s->fd, NULL, NULL, NULL, NULL, NULL);
+    } else {
+        qemu_set_fd_handler(s->fd, NULL, NULL, NULL);
+    }
+    s->ctx = ctx;
+    tap_update_fd_handler(s);
 }
 
 static void tap_read_poll(TAPState *s, bool enable)
@@ -347,6 +377,7 @@ static NetClientInfo net_tap_info = {
     .set_vnet_le = tap_set_vnet_le,
     .set_vnet_be = tap_set_vnet_be,
     .set_steering_ebpf = tap_set_steering_ebpf,
+    .set_aio_context = tap_set_aio_context,
 };
 
 static TAPState *net_tap_fd_init(NetClientState *peer,
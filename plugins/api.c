@@ -178,6 +178,26 @@ void qemu_plugin_register_vcpu_mem_cb(struct qemu_plugin_insn *insn,
     plugin_register_vcpu_mem_cb(&insn->mem_cbs, cb, flags, rw, udata);
 }
 
+void qemu_plugin_register_vcpu_mem_filter_cb(struct qemu_plugin_insn *insn,
+                                             qemu_plugin_vcpu_mem_cb_t cb,
+                                             enum qemu_plugin_cb_flags flags,
+                                             enum qemu_plugin_mem_rw rw,
+                                             uint64_t lo, uint64_t hi,
+                                             void *udata)
+{
+    plugin_register_vcpu_mem_filter_cb(&insn->mem_cbs, cb, flags, rw,
+                                       lo, hi, udata);
+}
+
+void qemu_plugin_register_vcpu_mem_batch_cb(struct qemu_plugin_insn *insn,
+                                            qemu_plugin_vcpu_mem_batch_cb_t cb,
+                                            enum qemu_plugin_cb_flags flags,
+                                            enum qemu_plugin_mem_rw rw,
+                                            void *udata)
+{
+    plugin_register_vcpu_mem_batch_cb(&insn->mem_cbs, cb, flags, rw, udata);
+}
+
 void qemu_plugin_register_vcpu_mem_inline_per_vcpu(
     struct qemu_plugin_insn *insn,
     enum qemu_plugin_mem_rw rw,
@@ -31,6 +31,8 @@ struct qemu_plugin_cb {
 
 struct qemu_plugin_state plugin;
 
+static void plugin_mem_batch_flush_vcpu(unsigned int vcpu_index);
+
 struct qemu_plugin_ctx *plugin_id_to_ctx_locked(qemu_plugin_id_t id)
 {
     struct qemu_plugin_ctx *ctx;
@@ -279,6 +281,7 @@ void qemu_plugin_vcpu_exit_hook(CPUState *cpu)
 {
     bool success;
 
+    plugin_mem_batch_flush_vcpu(cpu->cpu_index);
     plugin_vcpu_cb__simple(cpu, QEMU_PLUGIN_EV_VCPU_EXIT);
 
     assert(cpu->cpu_index != UNASSIGNED_CPU_INDEX);
@@ -457,6 +460,143 @@ void plugin_register_vcpu_mem_cb(GArray **arr,
     dyn_cb->regular = regular_cb;
 }
 
+void plugin_register_vcpu_mem_filter_cb(GArray **arr,
+                                        void *cb,
+                                        enum qemu_plugin_cb_flags flags,
+                                        enum qemu_plugin_mem_rw rw,
+                                        uint64_t lo, uint64_t hi,
+                                        void *udata)
+{
+    static TCGHelperInfo info[3] = {
+        [QEMU_PLUGIN_CB_NO_REGS].flags = TCG_CALL_NO_RWG,
+        [QEMU_PLUGIN_CB_R_REGS].flags = TCG_CALL_NO_WG,
+        /*
+         * Match qemu_plugin_vcpu_mem_cb_t:
+         *   void (*)(uint32_t, qemu_plugin_meminfo_t, uint64_t, void *)
+         */
+        [0 ... 2].typemask =
+            (dh_typemask(void, 0) |
+             dh_typemask(i32, 1) |
+             (__builtin_types_compatible_p(qemu_plugin_meminfo_t, uint32_t)
+              ? dh_typemask(i32, 2) : dh_typemask(s32, 2)) |
+             dh_typemask(i64, 3) |
+             dh_typemask(ptr, 4))
+    };
+    assert((unsigned)flags < ARRAY_SIZE(info));
+    assert(lo < hi);
+
+    struct qemu_plugin_dyn_cb *dyn_cb = plugin_get_dyn_cb(arr);
+    struct qemu_plugin_mem_filter_cb filter_cb = { .userp = udata,
+                                                   .rw = rw,
+                                                   .lo = lo,
+                                                   .hi = hi,
+                                                   .f.vcpu_mem = cb,
+                                                   .info = &info[flags] };
+    dyn_cb->type = PLUGIN_CB_MEM_FILTER;
+    dyn_cb->mem_filter = filter_cb;
+}
+
+/*
+ * Batched memory callbacks: accesses are buffered per vCPU and handed
+ * to the plugin in bulk, so that a heavyweight consumer pays the cost
+ * of crossing into the plugin once per buffer rather than per access.
+ * One buffer is shared by all registrations with the same (cb, userdata)
+ * pair, keeping each vCPU's accesses in a single stream in execution
+ * order.
+ */
+#define PLUGIN_MEM_BATCH_SIZE 1024
+
+struct qemu_plugin_mem_batch_buf {
+    size_t count;
+    qemu_plugin_mem_record records[PLUGIN_MEM_BATCH_SIZE];
+};
+
+struct qemu_plugin_mem_batch {
+    qemu_plugin_vcpu_mem_batch_cb_t cb;
+    void *userp;
+    struct qemu_plugin_scoreboard *score;
+    QLIST_ENTRY(qemu_plugin_mem_batch) entry;
+};
+
+/*
+ * Disable CFI checks.
+ * The callback function has been loaded from an external library so we do not
+ * have type information
+ */
+QEMU_DISABLE_CFI
+static void plugin_mem_batch_flush(struct qemu_plugin_mem_batch *batch,
+                                   unsigned int vcpu_index,
+                                   struct qemu_plugin_mem_batch_buf *buf)
+{
+    size_t count = buf->count;
+
+    if (count) {
+        buf->count = 0;
+        batch->cb(vcpu_index, buf->records, count, batch->userp);
+    }
+}
+
+/* Matches qemu_plugin_vcpu_mem_cb_t; planted like a regular mem callback. */
+static void plugin_mem_batch_append(unsigned int vcpu_index,
+                                    qemu_plugin_meminfo_t info,
+                                    uint64_t vaddr, void *udata)
+{
+    struct qemu_plugin_mem_batch *batch = udata;
+    struct qemu_plugin_mem_batch_buf *buf =
+        &g_array_index(batch->score->data,
+                       struct qemu_plugin_mem_batch_buf, vcpu_index);
+
+    buf->records[buf->count].vaddr = vaddr;
+    buf->records[buf->count].info = info;
+    if (++buf->count == PLUGIN_MEM_BATCH_SIZE) {
+        plugin_mem_batch_flush(batch, vcpu_index, buf);
+    }
+}
+
+/* Deliver any buffered accesses of @vcpu_index to their plugins. */
+static void plugin_mem_batch_flush_vcpu(unsigned int vcpu_index)
+{
+    struct qemu_plugin_mem_batch *batch;
+
+    qemu_rec_mutex_lock(&plugin.lock);
+    QLIST_FOREACH(batch, &plugin.mem_batches, entry) {
+        struct qemu_plugin_mem_batch_buf *buf =
+            &g_array_index(batch->score->data,
+                           struct qemu_plugin_mem_batch_buf, vcpu_index);
+
+        plugin_mem_batch_flush(batch, vcpu_index, buf);
+    }
+    qemu_rec_mutex_unlock(&plugin.lock);
+}
+
+void plugin_register_vcpu_mem_batch_cb(GArray **arr,
+                                       qemu_plugin_vcpu_mem_batch_cb_t cb,
+                                       enum qemu_plugin_cb_flags flags,
+                                       enum qemu_plugin_mem_rw rw,
+                                       void *udata)
+{
+    struct qemu_plugin_mem_batch *batch;
+
+    qemu_rec_mutex_lock(&plugin.lock);
+    QLIST_FOREACH(batch, &plugin.mem_batches, entry) {
+        if (batch->cb == cb && batch->userp == udata) {
+            break;
+        }
+    }
+    if (!batch) {
+        batch = g_new0(struct qemu_plugin_mem_batch, 1);
+        batch->cb = cb;
+        batch->userp = udata;
+        batch->score =
+            plugin_scoreboard_new(sizeof(struct qemu_plugin_mem_batch_buf));
+        QLIST_INSERT_HEAD(&plugin.mem_batches, batch, entry);
+    }
+    qemu_rec_mutex_unlock(&plugin.lock);
+
+    plugin_register_vcpu_mem_cb(arr, plugin_mem_batch_append, flags, rw,
+                                batch);
+}
+
 /*
  * Disable CFI checks.
  * The callback function has been loaded from an external library so we do not
@@ -620,6 +760,15 @@ void qemu_plugin_vcpu_mem_cb(CPUState *cpu, uint64_t vaddr,
                                        vaddr, cb->regular.userp);
             }
             break;
+        case PLUGIN_CB_MEM_FILTER:
+            if ((rw & cb->mem_filter.rw) &&
+                vaddr - cb->mem_filter.lo <
+                cb->mem_filter.hi - cb->mem_filter.lo) {
+                cb->mem_filter.f.vcpu_mem(cpu->cpu_index,
+                                          make_plugin_meminfo(oi, rw),
+                                          vaddr, cb->mem_filter.userp);
+            }
+            break;
         case PLUGIN_CB_INLINE_ADD_U64:
         case PLUGIN_CB_INLINE_STORE_U64:
             if (rw & cb->inline_insn.rw) {
@@ -634,6 +783,9 @@ void qemu_plugin_vcpu_mem_cb(CPUState *cpu, uint64_t vaddr,
 
 void qemu_plugin_atexit_cb(void)
 {
+    for (int i = 0; i < plugin.num_vcpus; i++) {
+        plugin_mem_batch_flush_vcpu(i);
+    }
     plugin_cb__udata(QEMU_PLUGIN_EV_ATEXIT);
 }
 
@@ -725,6 +877,7 @@ static void __attribute__((__constructor__)) plugin_init(void)
     plugin.id_ht = g_hash_table_new(g_int64_hash, g_int64_equal);
     plugin.cpu_ht = g_hash_table_new(g_int_hash, g_int_equal);
     QLIST_INIT(&plugin.scoreboards);
+    QLIST_INIT(&plugin.mem_batches);
     plugin.scoreboard_alloc_size = 16; /* avoid frequent reallocation */
     QTAILQ_INIT(&plugin.ctxs);
     qht_init(&plugin.dyn_cb_arr_ht, plugin_dyn_cb_arr_cmp, 16,
@@ -53,6 +53,10 @@ struct QObjectInputVisitor {
      * QDict or QList). */
     QSLIST_HEAD(, StackObject) stack;
 
+    /* Recycled StackObjects, so visiting a list of structs does not
+     * allocate (and build a hash table) per element. */
+    QSLIST_HEAD(, StackObject) free_stack;
+
     GString *errname;           /* Accumulator for full_name() */
 };
 
@@ -208,27 +212,51 @@ static const QListEntry *qobject_input_push(QObjectInputVisitor *qiv,
                                             const char *name,
                                             QObject *obj, void *qapi)
 {
-    GHashTable *h;
-    StackObject *tos = g_new0(StackObject, 1);
+    StackObject *tos = QSLIST_FIRST(&qiv->free_stack);
     QDict *qdict = qobject_to(QDict, obj);
     QList *qlist = qobject_to(QList, obj);
     const QDictEntry *entry;
 
+    if (tos) {
+        QSLIST_REMOVE_HEAD(&qiv->free_stack, node);
+    } else {
+        tos = g_new0(StackObject, 1);
+    }
+
     assert(obj);
     tos->name = name;
     tos->obj = obj;
     tos->qapi = qapi;
 
     if (qdict) {
-        h = g_hash_table_new(g_str_hash, g_str_equal);
-        for (entry = qdict_first(qdict);
-             entry;
-             entry = qdict_next(qdict, entry)) {
-            g_hash_table_insert(h, (void *)qdict_entry_key(entry), NULL);
+        /*
+         * Track unvisited keys so qobject_input_check_struct() can
+         * flag unexpected parameters.  Empty dicts (e.g. commands
+         * without arguments) need no table; a recycled StackObject's
+         * table was emptied when it was recycled and is reused.
+         */
+        if (qdict_size(qdict)) {
+            if (!tos->h) {
+                tos->h = g_hash_table_new(g_str_hash, g_str_equal);
+            }
+            for (entry = qdict_first(qdict);
+                 entry;
+                 entry = qdict_next(qdict, entry)) {
+                g_hash_table_insert(tos->h, (void *)qdict_entry_key(entry),
+                                    NULL);
+            }
         }
-        tos->h = h;
+        tos->entry = NULL;
+        tos->index = 0;
     } else {
         assert(qlist);
+        /* A recycled StackObject may carry a dict's empty table; drop it
+         * so qobject_input_end_list() sees a clean list StackObject.
+         */
+        if (tos->h) {
+            g_hash_table_unref(tos->h);
+            tos->h = NULL;
+        }
         tos->entry = qlist_first(qlist);
         tos->index = -1;
     }
@@ -247,6 +275,10 @@ static bool qobject_input_check_struct(Visitor *v, Error **errp)
 
     assert(tos && !tos->entry);
 
+    if (!tos->h) {
+        return true;
+    }
+
     g_hash_table_iter_init(&iter, tos->h);
     if (g_hash_table_iter_next(&iter, (void **)&key, NULL)) {
         error_setg(errp, "Parameter '%s' is unexpected",
@@ -265,6 +297,15 @@ static void qobject_input_stack_object_free(StackObject *tos)
     g_free(tos);
 }
 
+static void qobject_input_stack_object_recycle(QObjectInputVisitor *qiv,
+                                               StackObject *tos)
+{
+    if (tos->h) {
+        g_hash_table_remove_all(tos->h);
+    }
+    QSLIST_INSERT_HEAD(&qiv->free_stack, tos, node);
+}
+
 static void qobject_input_pop(Visitor *v, void **obj)
 {
     QObjectInputVisitor *qiv = to_qiv(v);
@@ -272,7 +313,7 @@ static void qobject_input_pop(Visitor *v, void **obj)
 
     assert(tos && tos->qapi == obj);
     QSLIST_REMOVE_HEAD(&qiv->stack, node);
-    qobject_input_stack_object_free(tos);
+    qobject_input_stack_object_recycle(qiv, tos);
 }
 
 static bool qobject_input_start_struct(Visitor *v, const char *name, void **obj,
@@ -306,7 +347,8 @@ static void qobject_input_end_struct(Visitor *v, void **obj)
     QObjectInputVisitor *qiv = to_qiv(v);
     StackObject *tos = QSLIST_FIRST(&qiv->stack);
 
-    assert(qobject_type(tos->obj) == QTYPE_QDICT && tos->h);
+    /* Empty dicts never allocate an unvisited-keys table */
+    assert(qobject_type(tos->obj) == QTYPE_QDICT);
     qobject_input_pop(v, obj);
 }
 
@@ -682,6 +724,12 @@ static void qobject_input_free(Visitor *v)
         QSLIST_REMOVE_HEAD(&qiv->stack, node);
         qobject_input_stack_object_free(tos);
     }
+    while (!QSLIST_EMPTY(&qiv->free_stack)) {
+        StackObject *tos = QSLIST_FIRST(&qiv->free_stack);
+
+        QSLIST_REMOVE_HEAD(&qiv->free_stack, node);
+        qobject_input_stack_object_free(tos);
+    }
 
     qobject_unref(qiv->root);
     if (qiv->errname) {
@@ -1667,6 +1667,16 @@ enum ImgConvertBlockStatus {
 #define MAX_COROUTINES 16
 #define CONVERT_THROTTLE_GROUP "img_convert"
 
+/* An extent remembered from the allocation-counting pass */
+typedef struct ImgConvertExtent {
+    int64_t start;
+    int64_t end; /* exclusive */
+    enum ImgConvertBlockStatus status;
+} ImgConvertExtent;
+
+/* Bounds the status cache to 16 MB of extents for badly fragmented images */
+#define MAX_STATUS_CACHE_EXTENTS (1024 * 1024)
+
 typedef struct ImgConvertState {
     BlockBackend **src;
     int64_t *src_sectors;
@@ -1679,6 +1689,9 @@ typedef struct ImgConvertState {
     int64_t wr_offs;
     enum ImgConvertBlockStatus status;
     int64_t sector_next_status;
+    GArray *status_cache;
+    unsigned status_cache_pos;
+    bool recording_status;
     BlockBackend *target;
     bool has_zero_init;
     bool compressed;
@@ -1713,6 +1726,72 @@ static void convert_select_part(ImgConvertState *s, int64_t sector_num,
     }
 }
 
+/*
+ * The pass that counts allocated sectors in convert_do_copy() and the copy
+ * loop itself walk the source extents in the same order.  Remember the
+ * extents seen by the counting pass so that the copy loop does not pay for
+ * every block-status round-trip to the source a second time; on fragmented
+ * images on network protocols those round-trips dominate the runtime.
+ */
+static bool convert_status_cache_lookup(ImgConvertState *s, int64_t sector_num)
+{
+    if (!s->status_cache || s->recording_status) {
+        return false;
+    }
+
+    while (s->status_cache_pos < s->status_cache->len) {
+        ImgConvertExtent *ext = &g_array_index(s->status_cache,
+                                               ImgConvertExtent,
+                                               s->status_cache_pos);
+
+        if (ext->end > sector_num) {
+            if (ext->start > sector_num) {
+                /* Hole from compressed-cluster rounding; query anew */
+                return false;
+            }
+            s->status = ext->status;
+            s->sector_next_status = ext->end;
+            return true;
+        }
+        s->status_cache_pos++;
+    }
+
+    return false;
+}
+
+static void convert_status_cache_record(ImgConvertState *s,
+                                        int64_t sector_num, int n)
+{
+    ImgConvertExtent ext;
+
+    if (!s->status_cache || !s->recording_status) {
+        return;
+    }
+
+    if (s->status_cache->len) {
+        ImgConvertExtent *last = &g_array_index(s->status_cache,
+                                                ImgConvertExtent,
+                                                s->status_cache->len - 1);
+
+        if (last->status == s->status && last->end == sector_num) {
+            last->end = sector_num + n;
+            return;
+        }
+    }
+
+    if (s->status_cache->len >= MAX_STATUS_CACHE_EXTENTS) {
+        /* Too fragmented; the copy loop re-queries whatever is missing */
+        return;
+    }
+
+    ext = (ImgConvertExtent) {
+        .start = sector_num,
+        .end = sector_num + n,
+        .status = s->status,
+    };
+    g_array_append_val(s->status_cache, ext);
+}
+
 static int coroutine_mixed_fn GRAPH_RDLOCK
 convert_iteration_sectors(ImgConvertState *s, int64_t sector_num)
 {
@@ -1735,7 +1814,8 @@ convert_iteration_sectors(ImgConvertState *s, int64_t sector_num)
         }
     }
 
-    if (s->sector_next_status <= sector_num) {
+    if (s->sector_next_status <= sector_num &&
+        !convert_status_cache_lookup(s, sector_num)) {
         uint64_t offset = (sector_num - src_cur_offset) * BDRV_SECTOR_SIZE;
         int64_t count;
         int tail;
@@ -1797,6 +1877,7 @@ convert_iteration_sectors(ImgConvertState *s, int64_t sector_num)
             s->status = s->target_has_backing ? BLK_BACKING_FILE : BLK_DATA;
         }
 
+        convert_status_cache_record(s, sector_num, n);
         s->sector_next_status = sector_num + n;
     }
 
@@ -1874,6 +1955,40 @@ static int coroutine_fn convert_co_read(ImgConvertState *s, int64_t sector_num,
 }
 
 
+/*
+ * Check how many consecutive clusters at the start of @buf share the same
+ * content type (all zeroes vs. data) and return their combined length in
+ * *@pnum (in sectors). Returns true if the run consists of zeroed clusters.
+ *
+ * Compressed images can only be written in complete clusters, so this is used
+ * instead of is_allocated_sectors_min() to decide how much of a multi-cluster
+ * buffer can be submitted in a single write request while still keeping fully
+ * zeroed clusters sparse in the target.
+ */
+static bool convert_compressed_cluster_run(ImgConvertState *s,
+                                           const uint8_t *buf, int nb_sectors,
+                                           int *pnum)
+{
+    int n = 0;
+    bool zero = false;
+
+    while (n < nb_sectors) {
+        int len = MIN(nb_sectors - n, (int)s->cluster_sectors);
+        bool cluster_is_zero = buffer_is_zero(buf + n * BDRV_SECTOR_SIZE,
+                                              len * BDRV_SECTOR_SIZE);
+
+        if (n == 0) {
+            zero = cluster_is_zero;
+        } else if (cluster_is_zero != zero) {
+            break;
+        }
+        n += len;
+    }
+
+    *pnum = n;
+    return zero;
+}
+
 static int coroutine_fn convert_co_write(ImgConvertState *s, int64_t sector_num,
                                          int nb_sectors, uint8_t *buf,
                                          enum ImgConvertBlockStatus status)
@@ -1896,15 +2011,16 @@ static int coroutine_fn convert_co_write(ImgConvertState *s, int64_t sector_num,
             /* If we're told to keep the target fully allocated (-S 0) or there
              * is real non-zero data, we must write it. Otherwise we can treat
              * it as zero sectors.
-             * Compressed clusters need to be written as a whole, so in that
-             * case we can only save the write if the buffer is completely
-             * zeroed. */
+             * Compressed clusters need to be written as a whole, so we only
+             * save the write for runs of completely zeroed clusters, and
+             * write runs of data clusters in a single request so that the
+             * target driver can compress the clusters in parallel. */
             if (!s->min_sparse ||
                 (!s->compressed &&
                  is_allocated_sectors_min(buf, n, &n, s->min_sparse,
                                           sector_num, s->alignment)) ||
                 (s->compressed &&
-                 !buffer_is_zero(buf, n * BDRV_SECTOR_SIZE)))
+                 !convert_compressed_cluster_run(s, buf, n, &n)))
             {
                 ret = blk_co_pwrite(s->target, sector_num << BDRV_SECTOR_BITS,
                                     n << BDRV_SECTOR_BITS, buf, flags);
@@ -2105,21 +2221,28 @@ static int convert_do_copy(ImgConvertState *s)
         bdrv_graph_rdunlock_main_loop();
     }
 
-    /* Allocate buffer for copied data. For compressed images, only one cluster
-     * can be copied at a time. */
+    /* Allocate buffer for copied data. Compressed images can only be written
+     * in complete clusters, so round the buffer down to a multiple of the
+     * cluster size. Writing multiple clusters per request allows format
+     * drivers with a compression worker pool (e.g. qcow2) to compress them
+     * in parallel. */
     if (s->compressed) {
         if (s->cluster_sectors <= 0 || s->cluster_sectors > s->buf_sectors) {
             error_report("invalid cluster size");
             return -EINVAL;
         }
-        s->buf_sectors = s->cluster_sectors;
+        s->buf_sectors = QEMU_ALIGN_DOWN(s->buf_sectors, s->cluster_sectors);
     }
 
+    s->status_cache = g_array_new(FALSE, FALSE, sizeof(ImgConvertExtent));
+    s->recording_status = true;
+
     while (sector_num < s->total_sectors) {
         bdrv_graph_rdlock_main_loop();
         n = convert_iteration_sectors(s, sector_num);
         bdrv_graph_rdunlock_main_loop();
         if (n < 0) {
+            g_array_unref(s->status_cache);
             return n;
         }
         if (s->status == BLK_DATA || (!s->min_sparse && s->status == BLK_ZERO))
@@ -2129,7 +2252,9 @@ static int convert_do_copy(ImgConvertState *s)
         sector_num += n;
     }
 
-    /* Do the copy */
+    /* Do the copy, replaying the extents recorded above where possible */
+    s->recording_status = false;
+    s->status_cache_pos = 0;
     s->sector_next_status = 0;
     s->ret = -EINPROGRESS;
 
@@ -2144,6 +2269,9 @@ static int convert_do_copy(ImgConvertState *s)
         main_loop_wait(false);
     }
 
+    g_array_unref(s->status_cache);
+    s->status_cache = NULL;
+
     if (s->compressed && !s->ret) {
         /* signal EOF to align */
         ret = blk_pwrite_compressed(s->target, 0, 0, NULL);
@@ -1801,7 +1801,7 @@ ERST
 
 DEF("fsdev", HAS_ARG, QEMU_OPTION_fsdev,
     "-fsdev local,id=id,path=path,security_model=mapped-xattr|mapped-file|passthrough|none\n"
-    " [,writeout=immediate][,readonly=on][,fmode=fmode][,dmode=dmode]\n"
+    " [,writeout=immediate][,readonly=on][,host-cache=on|off][,fmode=fmode][,dmode=dmode]\n"
     " [[,throttling.bps-total=b]|[[,throttling.bps-read=r][,throttling.bps-write=w]]]\n"
     " [[,throttling.iops-total=i]|[[,throttling.iops-read=r][,throttling.iops-write=w]]]\n"
     " [[,throttling.bps-total-max=bm]|[[,throttling.bps-read-max=rm][,throttling.bps-write-max=wm]]]\n"
@@ -1811,7 +1811,7 @@ DEF("fsdev", HAS_ARG, QEMU_OPTION_fsdev,
     QEMU_ARCH_ALL)
 
 SRST
-``-fsdev local,id=id,path=path,security_model=security_model [,writeout=writeout][,readonly=on][,fmode=fmode][,dmode=dmode] [,throttling.option=value[,throttling.option=value[,...]]]``
+``-fsdev local,id=id,path=path,security_model=security_model [,writeout=writeout][,readonly=on][,host-cache=on|off][,fmode=fmode][,dmode=dmode] [,throttling.option=value[,throttling.option=value[,...]]]``
   \ 
 ``-fsdev synth,id=id[,readonly=on]``
     Define a new file system device. Valid options are:
@@ -1855,6 +1855,13 @@ SRST
         Enables exporting 9p share as a readonly mount for guests. By
         default read-write access is given.
 
+    ``host-cache=off``
+        This is an optional argument, enabled by default. When disabled,
+        file data is dropped from the host page cache right after it has
+        been read or written, so the share is only cached once, in the
+        guest. Useful for large read-mostly shares to avoid consuming
+        host memory with data the guest caches anyway.
+
     ``fmode=fmode``
         Specifies the default mode for newly created files on the host.
         Works only with security models "mapped-xattr" and
@@ -1906,12 +1913,12 @@ ERST
 
 DEF("virtfs", HAS_ARG, QEMU_OPTION_virtfs,
     "-virtfs local,path=path,mount_tag=tag,security_model=mapped-xattr|mapped-file|passthrough|none\n"
-    "        [,id=id][,writeout=immediate][,readonly=on][,fmode=fmode][,dmode=dmode][,multidevs=remap|forbid|warn]\n"
+    "        [,id=id][,writeout=immediate][,readonly=on][,host-cache=on|off][,fmode=fmode][,dmode=dmode][,multidevs=remap|forbid|warn]\n"
     "-virtfs synth,mount_tag=tag[,id=id][,readonly=on]\n",
     QEMU_ARCH_ALL)
 
 SRST
-``-virtfs local,path=path,mount_tag=mount_tag ,security_model=security_model[,writeout=writeout][,readonly=on] [,fmode=fmode][,dmode=dmode][,multidevs=multidevs]``
+``-virtfs local,path=path,mount_tag=mount_tag ,security_model=security_model[,writeout=writeout][,readonly=on][,host-cache=on|off] [,fmode=fmode][,dmode=dmode][,multidevs=multidevs]``
   \ 
 ``-virtfs synth,mount_tag=mount_tag``
     Define a new virtual filesystem device and expose it to the guest using
@@ -1965,6 +1972,13 @@ SRST
         Enables exporting 9p share as a readonly mount for guests. By
         default read-write access is given.
 
+    ``host-cache=off``
+        This is an optional argument, enabled by default. When disabled,
+        file data is dropped from the host page cache right after it has
+        been read or written, so the share is only cached once, in the
+        guest. Useful for large read-mostly shares to avoid consuming
+        host memory with data the guest caches anyway.
+
     ``fmode=fmode``
         Specifies the default mode for newly created files on the host.
         Works only with security models "mapped-xattr" and
@@ -2893,6 +2907,10 @@ DEF("netdev", HAS_ARG, QEMU_OPTION_netdev,
     "-netdev dgram,id=str,local.type=fd,local.str=file-descriptor\n"
     "                configure a network backend to connect to another network\n"
     "                using an UDP tunnel\n"
+    "-netdev nat,id=str[,net=addr[/prefix]][,host=addr]\n"
+    "                configure an unprivileged in-process NAT backend that relays\n"
+    "                guest TCP and UDP flows through host sockets; the guest must\n"
+    "                use a static address (no DHCP/DNS emulation)\n"
 #ifdef CONFIG_VDE
     "-netdev vde,id=str[,sock=socketpath][,port=n][,group=groupname][,mode=octalmode]\n"
     "                configure a network backend to connect to port 'n' of a vde switch\n"
@@ -3724,7 +3742,7 @@ DEFHEADING(Character device options:)
 DEF("chardev", HAS_ARG, QEMU_OPTION_chardev,
     "-chardev help\n"
     "-chardev null,id=id[,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
-    "-chardev socket,id=id[,host=host],port=port[,to=to][,ipv4=on|off][,ipv6=on|off][,nodelay=on|off]\n"
+    "-chardev socket,id=id[,host=host],port=port[,to=to][,ipv4=on|off][,ipv6=on|off][,nodelay=on|off][,coalesce=on|off]\n"
     "         [,server=on|off][,wait=on|off][,telnet=on|off][,websocket=on|off][,reconnect-ms=milliseconds][,mux=on|off]\n"
     "         [,logfile=PATH][,logappend=on|off][,tls-creds=ID][,tls-authz=ID] (tcp)\n"
     "-chardev socket,id=id,path=path[,server=on|off][,wait=on|off][,telnet=on|off][,websocket=on|off][,reconnect-ms=milliseconds]\n"
@@ -3735,7 +3753,8 @@ DEF("chardev", HAS_ARG, QEMU_OPTION_chardev,
     "-chardev msmouse,id=id[,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
     "-chardev vc,id=id[[,width=width][,height=height]][[,cols=cols][,rows=rows]]\n"
     "         [,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
-    "-chardev ringbuf,id=id[,size=size][,logfile=PATH][,logappend=on|off]\n"
+    "-chardev ringbuf,id=id[,size=size][,path=path][,watermark=watermark]\n"
+    "         [,logfile=PATH][,logappend=on|off]\n"
     "-chardev file,id=id,path=path[,input-path=input-file][,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
     "-chardev pipe,id=id,path=path[,mux=on|off][,logfile=PATH][,logappend=on|off]\n"
 #ifdef _WIN32
@@ -3866,6 +3885,12 @@ The available backends are:
     the handshake. The credentials must be previously created with the
     ``-object tls-creds`` argument.
 
+    ``coalesce=on|off`` buffers writes and flushes them with a single
+    send once the socket is writable, instead of issuing one send per
+    write. This cuts syscall overhead for chardevs carrying bursts of
+    small payloads, such as guest console logging, at the cost of
+    slightly delayed delivery. Disabled by default.
+
     ``tls-auth`` provides the ID of the QAuthZ authorization object
     against which the client's x509 distinguished name will be
     validated. This object is only resolved at time of use, so can be
@@ -3976,10 +4001,19 @@ The available backends are:
     ``cols`` and ``rows`` specify that the console be sized to fit a
     text console with the given dimensions.
 
-``-chardev ringbuf,id=id[,size=size]``
+``-chardev ringbuf,id=id[,size=size][,path=path][,watermark=watermark]``
     Create a ring buffer with fixed size ``size``. size must be a power
     of two and defaults to ``64K``.
 
+    ``path``, if given, backs the ring with a memory-mapped file at that
+    location so external collectors can map it and consume the data in
+    place instead of polling ``ringbuf-read``. The file starts with one
+    header page carrying the ring size and the producer counter.
+
+    ``watermark``, if given, makes QEMU emit a ``RINGBUF_WATERMARK`` QMP
+    event once that many bytes are waiting to be read with
+    ``ringbuf-read``.
+
 ``-chardev file,id=id,path=path[,input-path=input-path]``
     Log all traffic received from the guest to a file.
 
@@ -5364,7 +5398,7 @@ SRST
     they are specified. Note that the 'id' property must be set. These
     objects are placed in the '/objects' path.
 
-    ``-object memory-backend-file,id=id,size=size,mem-path=dir,share=on|off,discard-data=on|off,merge=on|off,dump=on|off,prealloc=on|off,host-nodes=host-nodes,policy=default|preferred|bind|interleave,align=align,offset=offset,readonly=on|off,rom=on|off|auto``
+    ``-object memory-backend-file,id=id,size=size,mem-path=dir,share=on|off,discard-data=on|off,merge=on|off,dump=on|off,prealloc=on|off,host-nodes=host-nodes,policy=default|preferred|bind|interleave|preferred-many,align=align,offset=offset,readonly=on|off,rom=on|off|auto``
         Creates a memory file backend object, which can be used to back
         the guest RAM with huge pages.
 
@@ -5423,6 +5457,21 @@ SRST
             interleave memory allocations across the given host node
             list
 
+        ``preferred-many``
+            allocate from the given host node list (for example the
+            DRAM tier of a tiered-memory host) while it has free
+            memory and fall back to the remaining nodes otherwise,
+            so the kernel can demote cold pages to the slower tier
+            and promote hot ones back; fails if the host kernel
+            lacks support for multiple preferred nodes
+
+        The ``numa-stripe`` option, together with ``policy=bind``,
+        splits the memory range into equal contiguous chunks, one per
+        node in the ``host-nodes`` list, and binds and preallocates
+        each chunk on its own node. This keeps a single backend used
+        as guest RAM aligned with the guest's NUMA node boundaries
+        without requiring one backend object per node.
+
         The ``align`` option specifies the base address alignment when
         QEMU mmap(2) ``mem-path``, and accepts common suffixes, eg
         ``2M``. Some backend store specified by ``mem-path`` requires an
@@ -5472,7 +5521,7 @@ SRST
         Please refer to ``memory-backend-file`` for a description of the
         options.
 
-    ``-object memory-backend-memfd,id=id,merge=on|off,dump=on|off,share=on|off,prealloc=on|off,size=size,host-nodes=host-nodes,policy=default|preferred|bind|interleave,seal=on|off,hugetlb=on|off,hugetlbsize=size``
+    ``-object memory-backend-memfd,id=id,merge=on|off,dump=on|off,share=on|off,prealloc=on|off,size=size,host-nodes=host-nodes,policy=default|preferred|bind|interleave|preferred-many,seal=on|off,hugetlb=on|off,hugetlbsize=size``
         Creates an anonymous memory file backend object, which allows
         QEMU to share the memory with an external process (e.g. when
         using vhost-user). The memory is allocated with memfd and
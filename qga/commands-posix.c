@@ -557,7 +557,12 @@ GuestFileRead *guest_file_read_unsafe(GuestFileHandle *gfh,
         gfh->state = RW_STATE_NEW;
     }
 
-    buf = g_malloc0(count + 1);
+    /*
+     * No need to zero the buffer: fread() fills the used part and the
+     * terminator is written below.  Chunks can be up to 48MB, so the
+     * memset() is a measurable share of a large transfer.
+     */
+    buf = g_malloc(count + 1);
     read_count = fread(buf, 1, count, fh);
     if (ferror(fh)) {
         error_setg_errno(errp, errno, "failed to read file");
@@ -352,7 +352,8 @@ GuestFileRead *guest_file_read_unsafe(GuestFileHandle *gfh,
     bool is_ok;
     DWORD read_count;
 
-    buf = g_malloc0(count + 1);
+    /* ReadFile() fills the used part and the terminator is written below */
+    buf = g_malloc(count + 1);
     is_ok = ReadFile(fh, buf, count, &read_count, NULL);
     if (!is_ok) {
         error_setg_win32(errp, GetLastError(), "failed to read file");
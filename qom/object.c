@@ -319,6 +319,23 @@ static void type_initialize_interface(TypeImpl *ti, TypeImpl *interface_type,
     ti->class->interfaces = g_slist_append(ti->class->interfaces, new_iface);
 }
 
+/*
+ * Allocate an ObjectProperty together with copies of its name and type
+ * strings in a single block, so that adding a property costs one
+ * allocation and freeing it one g_free.
+ */
+static ObjectProperty *object_property_new(const char *name, const char *type)
+{
+    size_t name_len = strlen(name) + 1;
+    size_t type_len = strlen(type) + 1;
+    ObjectProperty *prop = g_malloc0(sizeof(*prop) + name_len + type_len);
+    char *buf = (char *)&prop[1];
+
+    prop->name = memcpy(buf, name, name_len);
+    prop->type = memcpy(buf + name_len, type, type_len);
+    return prop;
+}
+
 static void object_property_free(gpointer data)
 {
     ObjectProperty *prop = data;
@@ -327,8 +344,7 @@ static void object_property_free(gpointer data)
         qobject_unref(prop->defval);
         prop->defval = NULL;
     }
-    g_free(prop->name);
-    g_free(prop->type);
+    /* name and type are allocated inline with the property */
     g_free(prop->description);
     g_free(prop);
 }
@@ -565,8 +581,7 @@ static void object_initialize_with_type(Object *obj, size_t size, TypeImpl *type
     obj->class = type->class;
     object_ref(obj);
     object_class_property_init_all(obj);
-    obj->properties = g_hash_table_new_full(g_str_hash, g_str_equal,
-                                            NULL, object_property_free);
+    /* obj->properties is allocated on the first property add */
     object_init_with_type(obj, type);
     object_post_init_with_type(obj, type);
 }
@@ -672,7 +687,9 @@ static void object_property_del_all(Object *obj)
         }
     } while (released);
 
-    g_hash_table_unref(obj->properties);
+    if (obj->properties) {
+        g_hash_table_unref(obj->properties);
+    }
 }
 
 static void object_property_del_child(Object *obj, Object *child)
@@ -1141,6 +1158,10 @@ static int do_object_child_foreach(Object *obj,
     ObjectProperty *prop;
     int ret = 0;
 
+    if (!obj->properties) {
+        return 0;
+    }
+
     g_hash_table_iter_init(&iter, obj->properties);
     while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&prop)) {
         if (object_property_is_child(prop)) {
@@ -1269,16 +1290,17 @@ object_property_try_add(Object *obj, const char *name, const char *type,
         return NULL;
     }
 
-    prop = g_malloc0(sizeof(*prop));
-
-    prop->name = g_strdup(name);
-    prop->type = g_strdup(type);
+    prop = object_property_new(name, type);
 
     prop->get = get;
     prop->set = set;
     prop->release = release;
     prop->opaque = opaque;
 
+    if (!obj->properties) {
+        obj->properties = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                NULL, object_property_free);
+    }
     g_hash_table_insert(obj->properties, prop->name, prop);
     return prop;
 }
@@ -1307,10 +1329,7 @@ object_class_property_add(ObjectClass *klass,
 
     assert(!object_class_property_find(klass, name));
 
-    prop = g_malloc0(sizeof(*prop));
-
-    prop->name = g_strdup(name);
-    prop->type = g_strdup(type);
+    prop = object_property_new(name, type);
 
     prop->get = get;
     prop->set = set;
@@ -1332,6 +1351,9 @@ ObjectProperty *object_property_find(Object *obj, const char *name)
         return prop;
     }
 
+    if (!obj->properties) {
+        return NULL;
+    }
     return g_hash_table_lookup(obj->properties, name);
 }
 
@@ -1349,7 +1371,21 @@ ObjectProperty *object_property_find_err(Object *obj, const char *name,
 void object_property_iter_init(ObjectPropertyIterator *iter,
                                Object *obj)
 {
-    g_hash_table_iter_init(&iter->iter, obj->properties);
+    static GHashTable *empty;
+
+    if (obj->properties) {
+        g_hash_table_iter_init(&iter->iter, obj->properties);
+    } else {
+        /*
+         * Instance property tables are allocated on first use; iterate
+         * a shared (never modified) empty table so that iteration goes
+         * straight on to the class properties.
+         */
+        if (g_once_init_enter(&empty)) {
+            g_once_init_leave(&empty, g_hash_table_new(NULL, NULL));
+        }
+        g_hash_table_iter_init(&iter->iter, empty);
+    }
     iter->nextclass = object_get_class(obj);
 }
 
@@ -2175,6 +2211,10 @@ static Object *object_resolve_partial_path(Object *parent,
 
     obj = object_resolve_abs_path(parent, parts, typename);
 
+    if (!parent->properties) {
+        return obj;
+    }
+
     g_hash_table_iter_init(&iter, parent->properties);
     while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&prop)) {
         Object *found;
@@ -27,10 +27,37 @@ typedef struct Event {
 } Event;
 
 static QTAILQ_HEAD(, Event) events_list = QTAILQ_HEAD_INITIALIZER(events_list);
+/*
+ * Pool of free Event structures. Recording hot paths queue and release
+ * an event per incoming packet or request, so reuse the structures
+ * instead of going through the allocator every time. Protected by the
+ * replay mutex, like the events queue itself.
+ */
+static QTAILQ_HEAD(, Event) events_pool = QTAILQ_HEAD_INITIALIZER(events_pool);
 static bool events_enabled;
 
 /* Functions */
 
+static Event *replay_event_alloc(void)
+{
+    Event *event;
+
+    if (QTAILQ_EMPTY(&events_pool)) {
+        return g_new0(Event, 1);
+    }
+
+    event = QTAILQ_FIRST(&events_pool);
+    QTAILQ_REMOVE(&events_pool, event, events);
+    memset(event, 0, sizeof(*event));
+
+    return event;
+}
+
+static void replay_event_free(Event *event)
+{
+    QTAILQ_INSERT_HEAD(&events_pool, event, events);
+}
+
 static void replay_run_event(Event *event)
 {
     switch (event->event_kind) {
@@ -88,7 +115,7 @@ void replay_flush_events(void)
         Event *event = QTAILQ_FIRST(&events_list);
         replay_run_event(event);
         QTAILQ_REMOVE(&events_list, event, events);
-        g_free(event);
+        replay_event_free(event);
     }
 }
 
@@ -110,15 +137,24 @@ void replay_add_event(ReplayAsyncEventKind event_kind,
         return;
     }
 
-    Event *event = g_new0(Event, 1);
+    g_assert(replay_mutex_locked());
+
+    Event *event = replay_event_alloc();
     event->event_kind = event_kind;
     event->opaque = opaque;
     event->opaque2 = opaque2;
     event->id = id;
 
-    g_assert(replay_mutex_locked());
+    /*
+     * A kick is only needed when the queue becomes non-empty: the vCPU
+     * drains the whole queue under the replay mutex, so with events
+     * already pending a kick is on its way and further ones would just
+     * interrupt the vCPU once per queued event.
+     */
+    if (QTAILQ_EMPTY(&events_list)) {
+        qemu_cpu_kick(first_cpu);
+    }
     QTAILQ_INSERT_TAIL(&events_list, event, events);
-    qemu_cpu_kick(first_cpu);
 }
 
 void replay_bh_schedule_event(QEMUBH *bh)
@@ -204,7 +240,7 @@ void replay_save_events(void)
         replay_save_event(event);
         replay_run_event(event);
         QTAILQ_REMOVE(&events_list, event, events);
-        g_free(event);
+        replay_event_free(event);
     }
 }
 
@@ -222,17 +258,17 @@ static Event *replay_read_event(void)
         }
         break;
     case REPLAY_ASYNC_EVENT_INPUT:
-        event = g_new0(Event, 1);
+        event = replay_event_alloc();
         event->event_kind = event_kind;
         event->opaque = replay_read_input_event();
         return event;
     case REPLAY_ASYNC_EVENT_INPUT_SYNC:
-        event = g_new0(Event, 1);
+        event = replay_event_alloc();
         event->event_kind = event_kind;
         event->opaque = 0;
         return event;
     case REPLAY_ASYNC_EVENT_CHAR_READ:
-        event = g_new0(Event, 1);
+        event = replay_event_alloc();
         event->event_kind = event_kind;
         event->opaque = replay_event_char_read_load();
         return event;
@@ -242,7 +278,7 @@ static Event *replay_read_event(void)
         }
         break;
     case REPLAY_ASYNC_EVENT_NET:
-        event = g_new0(Event, 1);
+        event = replay_event_alloc();
         event->event_kind = event_kind;
         event->opaque = replay_event_net_load();
         return event;
@@ -281,7 +317,7 @@ void replay_read_events(void)
         replay_state.read_event_id = -1;
         replay_run_event(event);
 
-        g_free(event);
+        replay_event_free(event);
     }
 }
 
@@ -294,6 +330,12 @@ void replay_finish_events(void)
 {
     events_enabled = false;
     replay_flush_events();
+
+    while (!QTAILQ_EMPTY(&events_pool)) {
+        Event *event = QTAILQ_FIRST(&events_pool);
+        QTAILQ_REMOVE(&events_pool, event, events);
+        g_free(event);
+    }
 }
 
 bool replay_events_enabled(void)
@@ -10,6 +10,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/bswap.h"
 #include "system/replay.h"
 #include "system/runstate.h"
 #include "replay-internal.h"
@@ -60,22 +61,46 @@ void replay_put_event(uint8_t event)
 }
 
 
+/*
+ * Multi-byte values are written with a single fwrite() of a
+ * big-endian buffer rather than one putc() per byte: stdio locks the
+ * stream on every call, and events are put tightly enough on recording
+ * hot paths for the per-byte locking to show up in profiles.
+ */
 void replay_put_word(uint16_t word)
 {
-    replay_put_byte(word >> 8);
-    replay_put_byte(word);
+    if (replay_file) {
+        uint8_t buf[sizeof(word)];
+
+        stw_be_p(buf, word);
+        if (fwrite(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_write_error();
+        }
+    }
 }
 
 void replay_put_dword(uint32_t dword)
 {
-    replay_put_word(dword >> 16);
-    replay_put_word(dword);
+    if (replay_file) {
+        uint8_t buf[sizeof(dword)];
+
+        stl_be_p(buf, dword);
+        if (fwrite(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_write_error();
+        }
+    }
 }
 
 void replay_put_qword(int64_t qword)
 {
-    replay_put_dword(qword >> 32);
-    replay_put_dword(qword);
+    if (replay_file) {
+        uint8_t buf[sizeof(qword)];
+
+        stq_be_p(buf, qword);
+        if (fwrite(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_write_error();
+        }
+    }
 }
 
 void replay_put_array(const uint8_t *buf, size_t size)
@@ -105,8 +130,12 @@ uint16_t replay_get_word(void)
 {
     uint16_t word = 0;
     if (replay_file) {
-        word = replay_get_byte();
-        word = (word << 8) + replay_get_byte();
+        uint8_t buf[sizeof(word)];
+
+        if (fread(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_read_error();
+        }
+        word = lduw_be_p(buf);
     }
 
     return word;
@@ -116,8 +145,12 @@ uint32_t replay_get_dword(void)
 {
     uint32_t dword = 0;
     if (replay_file) {
-        dword = replay_get_word();
-        dword = (dword << 16) + replay_get_word();
+        uint8_t buf[sizeof(dword)];
+
+        if (fread(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_read_error();
+        }
+        dword = ldl_be_p(buf);
     }
 
     return dword;
@@ -127,8 +160,12 @@ int64_t replay_get_qword(void)
 {
     int64_t qword = 0;
     if (replay_file) {
-        qword = replay_get_dword();
-        qword = (qword << 32) + replay_get_dword();
+        uint8_t buf[sizeof(qword)];
+
+        if (fread(buf, sizeof(buf), 1, replay_file) != 1) {
+            replay_read_error();
+        }
+        qword = ldq_be_p(buf);
     }
 
     return qword;
@@ -10,6 +10,7 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/units.h"
 #include "qapi/error.h"
 #include "system/cpu-timers.h"
 #include "system/replay.h"
@@ -25,6 +26,8 @@
 #define REPLAY_VERSION              0xe0200c
 /* Size of replay log header */
 #define HEADER_SIZE                 (sizeof(uint32_t) + sizeof(uint64_t))
+/* stdio buffer size for the replay log */
+#define REPLAY_FILE_BUFFER_SIZE     (1 * MiB)
 
 ReplayMode replay_mode = REPLAY_MODE_NONE;
 char *replay_snapshot;
@@ -361,6 +364,14 @@ static void replay_enable(const char *fname, int mode)
         exit(1);
     }
 
+    /*
+     * The log is accessed strictly sequentially; a large stdio buffer
+     * batches the underlying reads and writes so that recording hot
+     * paths do not stall on per-event syscalls.  The stream is flushed
+     * and closed by replay_finish() registered via atexit() above.
+     */
+    setvbuf(replay_file, NULL, _IOFBF, REPLAY_FILE_BUFFER_SIZE);
+
     replay_filename = g_strdup(fname);
     replay_mode = mode;
     replay_mutex_init();
@@ -0,0 +1,69 @@
+/*
+ * "builtin" provider for the query-stats command, reporting the
+ * always-on hot path counters defined with QEMU_COUNTER_DEFINE().
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * (at your option) any later version.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/counter.h"
+#include "system/stats.h"
+#include "qapi/error.h"
+
+static void counter_stats_cb(StatsResultList **result, StatsTarget target,
+                             strList *names, strList *targets, Error **errp)
+{
+    StatsList *stats_list = NULL;
+    QemuCounter *counter;
+
+    if (target != STATS_TARGET_VM) {
+        return;
+    }
+
+    for (counter = qemu_counter_next(NULL); counter;
+         counter = qemu_counter_next(counter)) {
+        Stats *stats;
+
+        if (!apply_str_list_filter(counter->name, names)) {
+            continue;
+        }
+
+        stats = g_new0(Stats, 1);
+        stats->name = g_strdup(counter->name);
+        stats->value = g_new0(StatsValue, 1);
+        stats->value->type = QTYPE_QNUM;
+        stats->value->u.scalar = qemu_counter_get(counter);
+        QAPI_LIST_PREPEND(stats_list, stats);
+    }
+
+    if (stats_list) {
+        add_stats_entry(result, STATS_PROVIDER_BUILTIN, NULL, stats_list);
+    }
+}
+
+static void counter_schemas_cb(StatsSchemaList **result, Error **errp)
+{
+    StatsSchemaValueList *stats_list = NULL;
+    QemuCounter *counter;
+
+    for (counter = qemu_counter_next(NULL); counter;
+         counter = qemu_counter_next(counter)) {
+        StatsSchemaValueList *schema_entry = g_new0(StatsSchemaValueList, 1);
+
+        schema_entry->value = g_new0(StatsSchemaValue, 1);
+        schema_entry->value->name = g_strdup(counter->name);
+        schema_entry->value->type = STATS_TYPE_CUMULATIVE;
+        schema_entry->next = stats_list;
+        stats_list = schema_entry;
+    }
+
+    add_stats_schema(result, STATS_PROVIDER_BUILTIN, STATS_TARGET_VM,
+                     stats_list);
+}
+
+static void __attribute__((constructor)) counter_stats_register(void)
+{
+    add_stats_callbacks(STATS_PROVIDER_BUILTIN, counter_stats_cb,
+                        counter_schemas_cb);
+}
@@ -8,8 +8,13 @@
 #include "qemu/osdep.h"
 #include "system/stats.h"
 #include "qapi/qapi-commands-stats.h"
+#include "qapi/qapi-visit-stats.h"
+#include "qapi/clone-visitor.h"
+#include "qemu/bswap.h"
 #include "qemu/queue.h"
+#include "qemu/timer.h"
 #include "qapi/error.h"
+#include "monitor/monitor.h"
 
 typedef struct StatsCallbacks {
     StatsProvider provider;
@@ -66,6 +71,8 @@ static bool invoke_stats_cb(StatsCallbacks *entry,
         break;
     case STATS_TARGET_CRYPTODEV:
         break;
+    case STATS_TARGET_BLOCK:
+        break;
     default:
         abort();
     }
@@ -148,6 +155,210 @@ void add_stats_schema(StatsSchemaList **schema_results,
     QAPI_LIST_PREPEND(*schema_results, entry);
 }
 
+/*
+ * Statistics subscriptions stream the result of a stored query-stats
+ * filter to a file descriptor on a timer, in a binary framing that
+ * spares both sides the JSON round trip.  All integers are
+ * little-endian.  Each interval produces one frame:
+ *
+ *   frame:  magic "QST0" | u32 payload length | u64 timestamp (ns,
+ *           realtime clock) | u32 record count | records...
+ *   record: u8 provider (StatsProvider) | string qom-path (empty if
+ *           absent) | string name | u8 kind | value
+ *   string: u16 length | bytes (no terminator)
+ *   value:  kind 0: u64 scalar
+ *           kind 1: u8 boolean
+ *           kind 2: u16 count | count * u64 (histogram buckets)
+ *
+ * The payload length covers everything after the length field.
+ */
+#define STATS_STREAM_MAGIC "QST0"
+
+typedef struct StatsSubscriber {
+    int64_t id;
+    int fd;
+    int64_t interval_ms;
+    StatsFilter *filter;
+    QEMUTimer *timer;
+    QTAILQ_ENTRY(StatsSubscriber) next;
+} StatsSubscriber;
+
+static QTAILQ_HEAD(, StatsSubscriber) stats_subscribers =
+    QTAILQ_HEAD_INITIALIZER(stats_subscribers);
+
+static void stats_stream_put_u8(GByteArray *buf, uint8_t v)
+{
+    g_byte_array_append(buf, &v, sizeof(v));
+}
+
+static void stats_stream_put_u16(GByteArray *buf, uint16_t v)
+{
+    uint8_t b[2];
+
+    stw_le_p(b, v);
+    g_byte_array_append(buf, b, sizeof(b));
+}
+
+static void stats_stream_put_u32(GByteArray *buf, uint32_t v)
+{
+    uint8_t b[4];
+
+    stl_le_p(b, v);
+    g_byte_array_append(buf, b, sizeof(b));
+}
+
+static void stats_stream_put_u64(GByteArray *buf, uint64_t v)
+{
+    uint8_t b[8];
+
+    stq_le_p(b, v);
+    g_byte_array_append(buf, b, sizeof(b));
+}
+
+static void stats_stream_put_str(GByteArray *buf, const char *str)
+{
+    size_t len = str ? strlen(str) : 0;
+
+    stats_stream_put_u16(buf, MIN(len, UINT16_MAX));
+    g_byte_array_append(buf, (const uint8_t *)str, MIN(len, UINT16_MAX));
+}
+
+static uint32_t stats_stream_put_result(GByteArray *buf, StatsResult *result)
+{
+    StatsList *stats;
+    uint32_t count = 0;
+
+    for (stats = result->stats; stats; stats = stats->next) {
+        Stats *entry = stats->value;
+
+        stats_stream_put_u8(buf, result->provider);
+        stats_stream_put_str(buf, result->qom_path);
+        stats_stream_put_str(buf, entry->name);
+        switch (entry->value->type) {
+        case QTYPE_QNUM:
+            stats_stream_put_u8(buf, 0);
+            stats_stream_put_u64(buf, entry->value->u.scalar);
+            break;
+        case QTYPE_QBOOL:
+            stats_stream_put_u8(buf, 1);
+            stats_stream_put_u8(buf, entry->value->u.boolean);
+            break;
+        case QTYPE_QLIST: {
+            uint64List *item;
+            uint16_t n = 0;
+
+            for (item = entry->value->u.list; item; item = item->next) {
+                n++;
+            }
+            stats_stream_put_u8(buf, 2);
+            stats_stream_put_u16(buf, n);
+            for (item = entry->value->u.list; item; item = item->next) {
+                stats_stream_put_u64(buf, item->value);
+            }
+            break;
+        }
+        default:
+            abort();
+        }
+        count++;
+    }
+    return count;
+}
+
+static void stats_subscriber_free(StatsSubscriber *sub)
+{
+    QTAILQ_REMOVE(&stats_subscribers, sub, next);
+    timer_free(sub->timer);
+    qapi_free_StatsFilter(sub->filter);
+    close(sub->fd);
+    g_free(sub);
+}
+
+static void stats_subscriber_timer_cb(void *opaque)
+{
+    StatsSubscriber *sub = opaque;
+    g_autoptr(GByteArray) buf = g_byte_array_new();
+    StatsResultList *results, *entry;
+    Error *err = NULL;
+    uint32_t count = 0;
+
+    results = qmp_query_stats(sub->filter, &err);
+    if (err) {
+        error_free(err);
+        stats_subscriber_free(sub);
+        return;
+    }
+
+    g_byte_array_append(buf, (const uint8_t *)STATS_STREAM_MAGIC, 4);
+    stats_stream_put_u32(buf, 0); /* payload length, patched below */
+    stats_stream_put_u64(buf, qemu_clock_get_ns(QEMU_CLOCK_REALTIME));
+    stats_stream_put_u32(buf, 0); /* record count, patched below */
+
+    for (entry = results; entry; entry = entry->next) {
+        count += stats_stream_put_result(buf, entry->value);
+    }
+    qapi_free_StatsResultList(results);
+
+    stl_le_p(buf->data + 4, buf->len - 8);
+    stl_le_p(buf->data + 16, count);
+
+    if (qemu_write_full(sub->fd, buf->data, buf->len) != buf->len) {
+        stats_subscriber_free(sub);
+        return;
+    }
+
+    timer_mod(sub->timer,
+              qemu_clock_get_ms(QEMU_CLOCK_REALTIME) + sub->interval_ms);
+}
+
+StatsSubscription *qmp_stats_subscribe(const char *fdname, int64_t interval,
+                                       StatsFilter *filter, Error **errp)
+{
+    static int64_t next_subscriber_id;
+    StatsSubscription *ret;
+    StatsSubscriber *sub;
+    int fd;
+
+    if (interval <= 0) {
+        error_setg(errp, "'interval' must be a positive number of "
+                   "milliseconds");
+        return NULL;
+    }
+
+    fd = monitor_get_fd(monitor_cur(), fdname, errp);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    sub = g_new0(StatsSubscriber, 1);
+    sub->id = ++next_subscriber_id;
+    sub->fd = fd;
+    sub->interval_ms = interval;
+    sub->filter = QAPI_CLONE(StatsFilter, filter);
+    sub->timer = timer_new_ms(QEMU_CLOCK_REALTIME,
+                              stats_subscriber_timer_cb, sub);
+    QTAILQ_INSERT_TAIL(&stats_subscribers, sub, next);
+    timer_mod(sub->timer,
+              qemu_clock_get_ms(QEMU_CLOCK_REALTIME) + sub->interval_ms);
+
+    ret = g_new0(StatsSubscription, 1);
+    ret->id = sub->id;
+    return ret;
+}
+
+void qmp_stats_unsubscribe(int64_t id, Error **errp)
+{
+    StatsSubscriber *sub;
+
+    QTAILQ_FOREACH(sub, &stats_subscribers, next) {
+        if (sub->id == id) {
+            stats_subscriber_free(sub);
+            return;
+        }
+    }
+    error_setg(errp, "no stats subscription with id %" PRId64, id);
+}
+
 bool apply_str_list_filter(const char *string, strList *list)
 {
     strList *str_list = NULL;
@@ -37,13 +37,26 @@
  * DIRTYLIMIT_LINEAR_ADJUSTMENT_PCT.
  * Otherwise, plus or minus a fixed vcpu sleep time.
  */
-#define DIRTYLIMIT_LINEAR_ADJUSTMENT_PCT     50
 /*
  * Max vcpu sleep time percentage during a cycle
  * composed of dirty ring full and sleep time.
  */
 #define DIRTYLIMIT_THROTTLE_PCT_MAX 99
 
+/*
+ * Gains of the PID controller adjusting the vcpu sleep time, applied
+ * to the relative dirty rate error in percent.  Biased towards smooth
+ * convergence rather than aggressive clamping: the proportional and
+ * derivative terms react to (changes of) the current error while the
+ * integral term closes the remaining steady-state gap over a few
+ * observation periods without overshooting into needless guest latency.
+ */
+#define DIRTYLIMIT_PID_KP   0.4
+#define DIRTYLIMIT_PID_KI   0.1
+#define DIRTYLIMIT_PID_KD   0.2
+/* Anti-windup clamp for the accumulated error, in percent */
+#define DIRTYLIMIT_PID_INTEGRAL_MAX 300.0
+
 struct {
     VcpuStat stat;
     bool running;
@@ -58,6 +71,9 @@ typedef struct VcpuDirtyLimitState {
      * zero if not enabled.
      */
     uint64_t quota;
+    /* PID controller state, in percent of relative dirty rate error */
+    double err_integral;
+    double err_prev;
 } VcpuDirtyLimitState;
 
 struct {
@@ -263,56 +279,46 @@ static inline bool dirtylimit_done(uint64_t quota,
     return ((max - min) <= DIRTYLIMIT_TOLERANCE_RANGE) ? true : false;
 }
 
-static inline bool
-dirtylimit_need_linear_adjustment(uint64_t quota,
-                                  uint64_t current)
-{
-    uint64_t min, max;
-
-    min = MIN(quota, current);
-    max = MAX(quota, current);
-
-    return ((max - min) * 100 / max) > DIRTYLIMIT_LINEAR_ADJUSTMENT_PCT;
-}
-
 static void dirtylimit_set_throttle(CPUState *cpu,
                                     uint64_t quota,
                                     uint64_t current)
 {
+    VcpuDirtyLimitState *state = dirtylimit_vcpu_get_state(cpu->cpu_index);
     int64_t ring_full_time_us = 0;
-    uint64_t sleep_pct = 0;
-    uint64_t throttle_us = 0;
+    double err_pct, adjust_pct;
 
     if (current == 0) {
         cpu->throttle_us_per_full = 0;
+        state->err_integral = 0;
+        state->err_prev = 0;
         return;
     }
 
     ring_full_time_us = dirtylimit_dirty_ring_full_time(current);
 
-    if (dirtylimit_need_linear_adjustment(quota, current)) {
-        if (quota < current) {
-            sleep_pct = (current - quota) * 100 / current;
-            throttle_us =
-                ring_full_time_us * sleep_pct / (double)(100 - sleep_pct);
-            cpu->throttle_us_per_full += throttle_us;
-        } else {
-            sleep_pct = (quota - current) * 100 / quota;
-            throttle_us =
-                ring_full_time_us * sleep_pct / (double)(100 - sleep_pct);
-            cpu->throttle_us_per_full -= throttle_us;
-        }
+    /*
+     * Relative dirty rate error in percent; positive when the vcpu
+     * dirties faster than its quota.
+     */
+    err_pct = ((double)current - (double)quota) * 100 / MAX(current, quota);
 
-        trace_dirtylimit_throttle_pct(cpu->cpu_index,
-                                      sleep_pct,
-                                      throttle_us);
-    } else {
-        if (quota < current) {
-            cpu->throttle_us_per_full += ring_full_time_us / 10;
-        } else {
-            cpu->throttle_us_per_full -= ring_full_time_us / 10;
-        }
-    }
+    state->err_integral += err_pct;
+    state->err_integral = MIN(state->err_integral,
+                              DIRTYLIMIT_PID_INTEGRAL_MAX);
+    state->err_integral = MAX(state->err_integral,
+                              -DIRTYLIMIT_PID_INTEGRAL_MAX);
+
+    adjust_pct = DIRTYLIMIT_PID_KP * err_pct +
+                 DIRTYLIMIT_PID_KI * state->err_integral +
+                 DIRTYLIMIT_PID_KD * (err_pct - state->err_prev);
+    state->err_prev = err_pct;
+
+    cpu->throttle_us_per_full += ring_full_time_us * adjust_pct / 100;
+
+    trace_dirtylimit_throttle_pct(cpu->cpu_index,
+                                  (uint64_t)fabs(err_pct),
+                                  (int64_t)(ring_full_time_us *
+                                            adjust_pct / 100));
 
     /*
      * TODO: in the big kvm_dirty_ring_size case (eg: 65536, or other scenario),
@@ -390,6 +396,10 @@ void dirtylimit_set_vcpu(int cpu_index,
         }
     }
 
+    /* A new quota is a new setpoint; restart the controller from scratch */
+    dirtylimit_state->states[cpu_index].err_integral = 0;
+    dirtylimit_state->states[cpu_index].err_prev = 0;
+
     dirtylimit_state->states[cpu_index].enabled = enable;
 }
 
@@ -610,10 +620,13 @@ static struct DirtyLimitInfo *dirtylimit_query_vcpu(int cpu_index)
 {
     DirtyLimitInfo *info = NULL;
 
+    CPUState *cpu = qemu_get_cpu(cpu_index);
+
     info = g_malloc0(sizeof(*info));
     info->cpu_index = cpu_index;
     info->limit_rate = dirtylimit_vcpu_get_state(cpu_index)->quota;
     info->current_rate = vcpu_dirty_rate_get(cpu_index);
+    info->throttle_time_per_full = cpu ? cpu->throttle_us_per_full : 0;
 
     return info;
 }
@@ -668,9 +681,11 @@ void hmp_info_vcpu_dirty_limit(Monitor *mon, const QDict *qdict)
 
     for (info = head; info != NULL; info = info->next) {
         monitor_printf(mon, "vcpu[%"PRIi64"], limit rate %"PRIi64 " (MB/s),"
-                            " current rate %"PRIi64 " (MB/s)\n",
+                            " current rate %"PRIi64 " (MB/s),"
+                            " throttle %"PRIi64 " (us/full)\n",
                             info->value->cpu_index,
                             info->value->limit_rate,
-                            info->value->current_rate);
+                            info->value->current_rate,
+                            info->value->throttle_time_per_full);
     }
 }
@@ -132,8 +132,22 @@ static void dma_blk_cb(void *opaque, int ret)
     dma_blk_unmap(dbs);
 
     while (dbs->sg_cur_index < dbs->sg->nsg) {
+        int next;
+
         cur_addr = dbs->sg->sg[dbs->sg_cur_index].base + dbs->sg_cur_byte;
         cur_len = dbs->sg->sg[dbs->sg_cur_index].len - dbs->sg_cur_byte;
+        /*
+         * Coalesce contiguous entries so that a single map call (and thus
+         * a single IOMMU translation walk) can cover a whole run of the
+         * scatter-gather list.  dma_memory_map() may still return less
+         * than we ask for; the loop below picks up wherever it stopped.
+         */
+        for (next = dbs->sg_cur_index + 1; next < dbs->sg->nsg; next++) {
+            if (dbs->sg->sg[next].base != cur_addr + cur_len) {
+                break;
+            }
+            cur_len += dbs->sg->sg[next].len;
+        }
         mem = dma_memory_map(dbs->sg->as, cur_addr, &cur_len, dbs->dir,
                              MEMTXATTRS_UNSPECIFIED);
         /*
@@ -160,8 +174,9 @@ static void dma_blk_cb(void *opaque, int ret)
             break;
         qemu_iovec_add(&dbs->iov, mem, cur_len);
         dbs->sg_cur_byte += cur_len;
-        if (dbs->sg_cur_byte == dbs->sg->sg[dbs->sg_cur_index].len) {
-            dbs->sg_cur_byte = 0;
+        while (dbs->sg_cur_index < dbs->sg->nsg &&
+               dbs->sg_cur_byte >= dbs->sg->sg[dbs->sg_cur_index].len) {
+            dbs->sg_cur_byte -= dbs->sg->sg[dbs->sg_cur_index].len;
             ++dbs->sg_cur_index;
         }
     }
@@ -1062,25 +1062,60 @@ static void flatviews_init(void)
     }
 }
 
+static bool flatview_equal(FlatView *a, FlatView *b)
+{
+    unsigned i;
+
+    if (a->nr != b->nr) {
+        return false;
+    }
+
+    for (i = 0; i < a->nr; i++) {
+        /* flatrange_equal() ignores the log mask, but a kept view must
+         * carry the current one or log_start/log_stop would not fire.
+         */
+        if (!flatrange_equal(&a->ranges[i], &b->ranges[i]) ||
+            a->ranges[i].dirty_log_mask != b->ranges[i].dirty_log_mask) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static void flatviews_reset(void)
 {
+    GHashTable *old_views = flat_views;
     AddressSpace *as;
 
-    if (flat_views) {
-        g_hash_table_unref(flat_views);
-        flat_views = NULL;
-    }
+    flat_views = NULL;
     flatviews_init();
 
     /* Render unique FVs */
     QTAILQ_FOREACH(as, &address_spaces, address_spaces_link) {
         MemoryRegion *physmr = memory_region_get_flatview_root(as->root);
+        FlatView *old_view, *new_view;
 
         if (g_hash_table_lookup(flat_views, physmr)) {
             continue;
         }
 
-        generate_memory_topology(physmr);
+        new_view = generate_memory_topology(physmr);
+
+        /* If the topology change did not touch this root, keep the old
+         * view: address_space_set_flatview() then short-circuits on
+         * pointer equality, so unchanged address spaces skip the two
+         * listener update passes and keep their dispatch tree.
+         */
+        old_view = old_views ? g_hash_table_lookup(old_views, physmr) : NULL;
+        if (old_view && flatview_equal(old_view, new_view)) {
+            flatview_ref(old_view);
+            g_hash_table_replace(flat_views, physmr, old_view);
+        }
+    }
+
+    if (old_views) {
+        g_hash_table_unref(old_views);
     }
 }
 
@@ -2567,6 +2602,15 @@ void memory_region_clear_flush_coalesced(MemoryRegion *mr)
     }
 }
 
+void memory_region_enable_lockless_io(MemoryRegion *mr)
+{
+    /* Flushing the coalesced MMIO buffer requires the BQL */
+    assert(!mr->flush_coalesced_mmio);
+    mr->lockless_io = true;
+    /* The guard flag in DeviceState is not atomic */
+    mr->disable_reentrancy_guard = true;
+}
+
 void memory_region_add_eventfd(MemoryRegion *mr,
                                hwaddr addr,
                                unsigned size,
@@ -3233,6 +3277,7 @@ void address_space_init(AddressSpace *as, MemoryRegion *root, const char *name)
     QTAILQ_INSERT_TAIL(&address_spaces, as, address_spaces_link);
     as->max_bounce_buffer_size = DEFAULT_MAX_BOUNCE_BUFFER_SIZE;
     as->bounce_buffer_size = 0;
+    address_space_init_bounce_pool(as);
     qemu_mutex_init(&as->map_client_list_lock);
     QLIST_INIT(&as->map_client_list);
     as->name = g_strdup(name ? name : "anonymous");
@@ -3243,6 +3288,7 @@ void address_space_init(AddressSpace *as, MemoryRegion *root, const char *name)
 static void do_address_space_destroy(AddressSpace *as)
 {
     assert(qatomic_read(&as->bounce_buffer_size) == 0);
+    address_space_drain_bounce_pool(as);
     assert(QLIST_EMPTY(&as->map_client_list));
     qemu_mutex_destroy(&as->map_client_list_lock);
 
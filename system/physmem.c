@@ -50,6 +50,7 @@
 #include "qemu/log.h"
 #include "qemu/memalign.h"
 #include "qemu/memfd.h"
+#include "qemu/units.h"
 #include "exec/memory.h"
 #include "exec/ioport.h"
 #include "system/dma.h"
@@ -2248,7 +2249,7 @@ RAMBlock *qemu_ram_alloc_resizeable(ram_addr_t size, ram_addr_t maxsz,
                                    RAM_RESIZEABLE, mr, errp);
 }
 
-static void reclaim_ramblock(RAMBlock *block)
+static void ram_block_release(RAMBlock *block)
 {
     if (block->flags & RAM_PREALLOC) {
         ;
@@ -2271,6 +2272,34 @@ static void reclaim_ramblock(RAMBlock *block)
     g_free(block);
 }
 
+static void *ram_block_release_thread(void *opaque)
+{
+    ram_block_release(opaque);
+    return NULL;
+}
+
+/*
+ * Unmapping hundreds of gigabytes can take seconds in the kernel.  Release
+ * blocks larger than this from a detached thread so that neither the RCU
+ * callback thread nor anybody draining it (e.g. the monitor) stalls behind
+ * the munmap when a large memory backend is unplugged.
+ */
+#define RAM_RECLAIM_ASYNC_THRESHOLD (16 * GiB)
+
+static void reclaim_ramblock(RAMBlock *block)
+{
+    if (block->host && !xen_enabled() && !(block->flags & RAM_PREALLOC) &&
+        block->max_length >= RAM_RECLAIM_ASYNC_THRESHOLD) {
+        QemuThread thread;
+
+        qemu_thread_create(&thread, "ram-reclaim", ram_block_release_thread,
+                           block, QEMU_THREAD_DETACHED);
+        return;
+    }
+
+    ram_block_release(block);
+}
+
 void qemu_ram_free(RAMBlock *block)
 {
     g_autofree char *name = NULL;
@@ -2879,6 +2908,9 @@ bool prepare_mmio_access(MemoryRegion *mr)
 {
     bool release_lock = false;
 
+    if (mr->lockless_io) {
+        return false;
+    }
     if (!bql_locked()) {
         bql_lock();
         release_lock = true;
@@ -3248,13 +3280,96 @@ void cpu_flush_icache_range(hwaddr start, hwaddr len)
  */
 #define BOUNCE_BUFFER_MAGIC 0xb4017ceb4ffe12ed
 
-typedef struct {
+struct BounceBuffer {
     uint64_t magic;
     MemoryRegion *mr;
     hwaddr addr;
     size_t len;
+    /* Allocated buffer size; pooled buffers have their size class's size */
+    size_t capacity;
+    QSLIST_ENTRY(BounceBuffer) pool_next;
     uint8_t buffer[];
-} BounceBuffer;
+};
+
+/* Smallest pooled bounce buffer; classes double up from here */
+#define BOUNCE_BUFFER_MIN_CLASS_SIZE 4096
+
+/* Returns BOUNCE_BUFFER_SIZE_CLASSES for lengths too large to pool. */
+static unsigned bounce_buffer_size_class(size_t len)
+{
+    size_t size = BOUNCE_BUFFER_MIN_CLASS_SIZE;
+    unsigned i;
+
+    for (i = 0; i < BOUNCE_BUFFER_SIZE_CLASSES; i++, size *= 2) {
+        if (len <= size) {
+            break;
+        }
+    }
+    return i;
+}
+
+void address_space_init_bounce_pool(AddressSpace *as)
+{
+    unsigned i;
+
+    qemu_mutex_init(&as->bounce_pool_lock);
+    for (i = 0; i < BOUNCE_BUFFER_SIZE_CLASSES; i++) {
+        QSLIST_INIT(&as->bounce_pool[i]);
+    }
+}
+
+void address_space_drain_bounce_pool(AddressSpace *as)
+{
+    unsigned i;
+
+    for (i = 0; i < BOUNCE_BUFFER_SIZE_CLASSES; i++) {
+        while (!QSLIST_EMPTY(&as->bounce_pool[i])) {
+            BounceBuffer *bounce = QSLIST_FIRST(&as->bounce_pool[i]);
+
+            QSLIST_REMOVE_HEAD(&as->bounce_pool[i], pool_next);
+            g_free(bounce);
+        }
+    }
+    qemu_mutex_destroy(&as->bounce_pool_lock);
+}
+
+static BounceBuffer *bounce_buffer_get(AddressSpace *as, size_t len)
+{
+    unsigned class = bounce_buffer_size_class(len);
+    BounceBuffer *bounce = NULL;
+
+    if (class < BOUNCE_BUFFER_SIZE_CLASSES) {
+        QEMU_LOCK_GUARD(&as->bounce_pool_lock);
+        bounce = QSLIST_FIRST(&as->bounce_pool[class]);
+        if (bounce) {
+            QSLIST_REMOVE_HEAD(&as->bounce_pool[class], pool_next);
+        }
+    }
+
+    if (bounce) {
+        memset(bounce->buffer, 0, len);
+    } else {
+        size_t capacity = class < BOUNCE_BUFFER_SIZE_CLASSES
+            ? BOUNCE_BUFFER_MIN_CLASS_SIZE << class : len;
+
+        bounce = g_malloc0(sizeof(BounceBuffer) + capacity);
+        bounce->capacity = capacity;
+    }
+    return bounce;
+}
+
+static void bounce_buffer_put(AddressSpace *as, BounceBuffer *bounce)
+{
+    unsigned class = bounce_buffer_size_class(bounce->capacity);
+
+    if (class >= BOUNCE_BUFFER_SIZE_CLASSES) {
+        g_free(bounce);
+        return;
+    }
+
+    QEMU_LOCK_GUARD(&as->bounce_pool_lock);
+    QSLIST_INSERT_HEAD(&as->bounce_pool[class], bounce, pool_next);
+}
 
 static void
 address_space_unregister_map_client_do(AddressSpaceMapClient *client)
@@ -3430,7 +3545,7 @@ void *address_space_map(AddressSpace *as,
             return NULL;
         }
 
-        BounceBuffer *bounce = g_malloc0(l + sizeof(BounceBuffer));
+        BounceBuffer *bounce = bounce_buffer_get(as, l);
         bounce->magic = BOUNCE_BUFFER_MAGIC;
         memory_region_ref(mr);
         bounce->mr = mr;
@@ -3487,7 +3602,7 @@ void address_space_unmap(AddressSpace *as, void *buffer, hwaddr len,
     qatomic_sub(&as->bounce_buffer_size, bounce->len);
     bounce->magic = ~BOUNCE_BUFFER_MAGIC;
     memory_region_unref(bounce->mr);
-    g_free(bounce);
+    bounce_buffer_put(as, bounce);
     /* Write bounce_buffer_size before reading map_client_list. */
     smp_mb();
     address_space_notify_map_clients(as);
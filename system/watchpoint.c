@@ -23,6 +23,20 @@
 #include "exec/target_page.h"
 #include "hw/core/cpu.h"
 
+/* Recompute the union of all watchpoint ranges for the fast pre-check. */
+static void cpu_watchpoint_update_bounds(CPUState *cpu)
+{
+    CPUWatchpoint *wp;
+    vaddr lo = -1, hi = 0;
+
+    QTAILQ_FOREACH(wp, &cpu->watchpoints, entry) {
+        lo = MIN(lo, wp->vaddr);
+        hi = MAX(hi, wp->vaddr + wp->len - 1);
+    }
+    cpu->watchpoints_lo = lo;
+    cpu->watchpoints_hi = hi;
+}
+
 /* Add a watchpoint.  */
 int cpu_watchpoint_insert(CPUState *cpu, vaddr addr, vaddr len,
                           int flags, CPUWatchpoint **watchpoint)
@@ -48,6 +62,7 @@ int cpu_watchpoint_insert(CPUState *cpu, vaddr addr, vaddr len,
     } else {
         QTAILQ_INSERT_TAIL(&cpu->watchpoints, wp, entry);
     }
+    cpu_watchpoint_update_bounds(cpu);
 
     in_page = -(addr | TARGET_PAGE_MASK);
     if (len <= in_page) {
@@ -82,6 +97,7 @@ int cpu_watchpoint_remove(CPUState *cpu, vaddr addr, vaddr len,
 void cpu_watchpoint_remove_by_ref(CPUState *cpu, CPUWatchpoint *watchpoint)
 {
     QTAILQ_REMOVE(&cpu->watchpoints, watchpoint, entry);
+    cpu_watchpoint_update_bounds(cpu);
 
     tlb_flush_page(cpu, watchpoint->vaddr);
 
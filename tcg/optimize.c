@@ -54,6 +54,19 @@ typedef struct TempOptInfo {
     uint64_t val;
     uint64_t z_mask;  /* mask bit is 0 if and only if value bit is 0 */
     uint64_t s_mask;  /* mask bit is 1 if value bit matches msb */
+
+    /*
+     * Definition tracking, for fusing shift/mask/or chains: the opcode
+     * that produced this value, with its variable and constant inputs.
+     * The record is only usable while def_src still holds the value it
+     * had when the record was made, which is checked by comparing gen
+     * numbers: every (re)definition assigns the temp a new gen.
+     */
+    uint64_t gen;
+    uint64_t def_src_gen;
+    uint64_t def_val;
+    TCGTemp *def_src;
+    TCGOpcode def_opc;
 } TempOptInfo;
 
 typedef struct OptContext {
@@ -64,6 +77,9 @@ typedef struct OptContext {
     IntervalTreeRoot mem_copy;
     QSIMPLEQ_HEAD(, MemCopyInfo) mem_free;
 
+    /* Generation counter for TempOptInfo definition tracking. */
+    uint64_t gen_count;
+
     /* In flight values from optimization. */
     TCGType type;
 } OptContext;
@@ -93,6 +109,11 @@ static inline bool ti_is_const_val(TempOptInfo *ti, uint64_t val)
     return ti_is_const(ti) && ti_const_val(ti) == val;
 }
 
+static inline bool ti_def_valid(TempOptInfo *ti)
+{
+    return ti->def_opc != 0 && ts_info(ti->def_src)->gen == ti->def_src_gen;
+}
+
 static inline bool ts_is_const(TCGTemp *ts)
 {
     return ti_is_const(ts_info(ts));
@@ -143,6 +164,8 @@ static void init_ts_info(OptContext *ctx, TCGTemp *ts)
     ti->next_copy = ts;
     ti->prev_copy = ts;
     QSIMPLEQ_INIT(&ti->mem_copy);
+    ti->gen = ++ctx->gen_count;
+    ti->def_opc = 0;
     if (ts->kind == TEMP_CONST) {
         ti->is_const = true;
         ti->val = ts->val;
@@ -239,6 +262,8 @@ static void reset_ts(OptContext *ctx, TCGTemp *ts)
     ti->is_const = false;
     ti->z_mask = -1;
     ti->s_mask = 0;
+    ti->gen = ++ctx->gen_count;
+    ti->def_opc = 0;
 
     if (!QSIMPLEQ_EMPTY(&ti->mem_copy)) {
         if (ts == nts) {
@@ -1014,6 +1039,40 @@ static bool fold_const2_commutative(OptContext *ctx, TCGOp *op)
     return fold_const2(ctx, op);
 }
 
+/*
+ * Record the operation defining the single output of @op, for use by
+ * the shift/mask/or pattern fusion in fold_and and fold_or.  Only the
+ * opcodes those folders examine need to be recorded.
+ */
+static void record_def(OptContext *ctx, TCGOp *op)
+{
+    TempOptInfo *ti, *t2;
+
+    switch (op->opc) {
+    CASE_OP_32_64(and):
+    CASE_OP_32_64(shl):
+    CASE_OP_32_64(shr):
+    CASE_OP_32_64(sar):
+        /*
+         * An in-place operation cannot be recorded: the source temp no
+         * longer holds the input value, but carries the gen that was
+         * assigned when the output was reset.
+         */
+        t2 = arg_info(op->args[2]);
+        if (ti_is_const(t2) &&
+            arg_temp(op->args[0]) != arg_temp(op->args[1])) {
+            ti = arg_info(op->args[0]);
+            ti->def_opc = op->opc;
+            ti->def_src = arg_temp(op->args[1]);
+            ti->def_src_gen = ts_info(ti->def_src)->gen;
+            ti->def_val = ti_const_val(t2);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 /*
  * Record "zero" and "sign" masks for the single output of @op.
  * See TempOptInfo definition of z_mask and s_mask.
@@ -1059,6 +1118,7 @@ static bool fold_masks_zs(OptContext *ctx, TCGOp *op,
     rep = MAX(rep - 1, 0);
     ti->s_mask = INT64_MIN >> rep;
 
+    record_def(ctx, op);
     return true;
 }
 
@@ -1296,6 +1356,81 @@ static bool fold_add2(OptContext *ctx, TCGOp *op)
     return fold_addsub2(ctx, op, true);
 }
 
+static bool fold_extract(OptContext *ctx, TCGOp *op);
+
+/*
+ * Match the mask-after-shift idiom that guest bitfield extractions
+ * expand to,
+ *
+ *   and(shr(src, pos), (1 << len) - 1)  ->  extract(src, pos, len)
+ *
+ * so that hosts with a bitfield extract instruction use it and the
+ * shift becomes dead.  An arithmetic shift qualifies as well, so long
+ * as the mask does not reach into the replicated sign bits.
+ */
+static bool fold_and_to_extract(OptContext *ctx, TCGOp *op)
+{
+    TempOptInfo *t1 = arg_info(op->args[1]);
+    TempOptInfo *t2 = arg_info(op->args[2]);
+    TCGOpcode shr_opc, sar_opc, ext_opc;
+    uint64_t mask;
+    TCGOp *op2;
+    int width, pos, len;
+
+    switch (ctx->type) {
+    case TCG_TYPE_I32:
+        shr_opc = INDEX_op_shr_i32;
+        sar_opc = INDEX_op_sar_i32;
+        ext_opc = INDEX_op_extract_i32;
+        width = 32;
+        break;
+    case TCG_TYPE_I64:
+        shr_opc = INDEX_op_shr_i64;
+        sar_opc = INDEX_op_sar_i64;
+        ext_opc = INDEX_op_extract_i64;
+        width = 64;
+        break;
+    default:
+        return false;
+    }
+
+    if (!ti_is_const(t2) || ti_is_const(t1) || !ti_def_valid(t1)) {
+        return false;
+    }
+    if (t1->def_opc != shr_opc && t1->def_opc != sar_opc) {
+        return false;
+    }
+    pos = t1->def_val;
+    if (pos <= 0 || pos >= width) {
+        return false;
+    }
+
+    /* The mask must be a run of low bits; anything else is not a field. */
+    mask = ti_const_val(t2) & MAKE_64BIT_MASK(0, width);
+    len = 64 - clz64(mask);
+    if (mask == 0 || mask != MAKE_64BIT_MASK(0, len)) {
+        return false;
+    }
+    if (len > width - pos) {
+        if (t1->def_opc == sar_opc) {
+            return false;
+        }
+        len = width - pos;
+    }
+    if (!TCG_TARGET_extract_valid(ctx->type, pos, len)) {
+        return false;
+    }
+
+    op2 = tcg_op_insert_before(ctx->tcg, op, ext_opc, 4);
+    op2->args[0] = op->args[0];
+    op2->args[1] = temp_arg(t1->def_src);
+    op2->args[2] = pos;
+    op2->args[3] = len;
+
+    tcg_op_remove(ctx->tcg, op);
+    return fold_extract(ctx, op2);
+}
+
 static bool fold_and(OptContext *ctx, TCGOp *op)
 {
     uint64_t z1, z2, z_mask, s_mask;
@@ -1321,6 +1456,10 @@ static bool fold_and(OptContext *ctx, TCGOp *op)
         return true;
     }
 
+    if (fold_and_to_extract(ctx, op)) {
+        return true;
+    }
+
     z_mask = z1 & z2;
 
     /*
@@ -2155,6 +2294,120 @@ static bool fold_not(OptContext *ctx, TCGOp *op)
     return fold_masks_s(ctx, op, arg_info(op->args[1])->s_mask);
 }
 
+/*
+ * Match the shift/mask/or chains that guest bitfield insertions expand
+ * to and fuse them into a single deposit,
+ *
+ *   or(bg, shl(src, ofs))   ->  deposit(bg, src, ofs, len)
+ *   or(bg, and(src, mask))  ->  deposit(bg, src, 0, len)
+ *
+ * when the known-zero masks prove that the background operand has no
+ * bits within the inserted field.  Since deposit replaces the field
+ * outright and ignores the high bits of the inserted value, a mask
+ * applied to the background, or to the field source below the field
+ * width, is bypassed as well, leaving it dead in the common case.
+ */
+static bool fold_or_to_deposit(OptContext *ctx, TCGOp *op)
+{
+    TCGOpcode shl_opc, and_opc, dep_opc;
+    uint64_t width_mask;
+    int width;
+
+    switch (ctx->type) {
+    case TCG_TYPE_I32:
+        shl_opc = INDEX_op_shl_i32;
+        and_opc = INDEX_op_and_i32;
+        dep_opc = INDEX_op_deposit_i32;
+        width = 32;
+        break;
+    case TCG_TYPE_I64:
+        shl_opc = INDEX_op_shl_i64;
+        and_opc = INDEX_op_and_i64;
+        dep_opc = INDEX_op_deposit_i64;
+        width = 64;
+        break;
+    default:
+        return false;
+    }
+    width_mask = MAKE_64BIT_MASK(0, width);
+
+    for (int swap = 0; swap < 2; swap++) {
+        TCGArg bg = op->args[1 + swap];
+        TempOptInfo *tb = arg_info(bg);
+        TempOptInfo *tf = arg_info(op->args[2 - swap]);
+        uint64_t z_fld = tf->z_mask & width_mask;
+        uint64_t z_bg = tb->z_mask & width_mask;
+        uint64_t fld_mask;
+        TempOptInfo *ti_src;
+        TCGTemp *src;
+        TCGOp *op2;
+        int ofs, len;
+
+        if (z_fld == 0 || ti_is_const(tf) || !ti_def_valid(tf)) {
+            continue;
+        }
+        if (tf->def_opc == shl_opc) {
+            ofs = tf->def_val;
+            if (ofs <= 0 || ofs >= width) {
+                continue;
+            }
+            len = 64 - clz64(z_fld) - ofs;
+        } else if (tf->def_opc == and_opc) {
+            ofs = 0;
+            len = 64 - clz64(z_fld);
+            /* The mask must cover the field, or low bits would change. */
+            if (MAKE_64BIT_MASK(0, len) & ~tf->def_val) {
+                continue;
+            }
+        } else {
+            continue;
+        }
+        /* Reject malformed fields, and a "field" covering the word. */
+        if (len < 1 || len > width - ofs || (ofs == 0 && len == width)) {
+            continue;
+        }
+
+        fld_mask = MAKE_64BIT_MASK(0, len) << ofs;
+        if ((z_fld & ~fld_mask) || (z_bg & fld_mask)) {
+            continue;
+        }
+        if (!TCG_TARGET_deposit_valid(ctx->type, ofs, len)) {
+            continue;
+        }
+
+        src = tf->def_src;
+
+        /* Skip a mask on the field source that deposit reapplies. */
+        ti_src = ts_info(src);
+        if (!ti_is_const(ti_src) && ti_def_valid(ti_src) &&
+            ti_src->def_opc == and_opc &&
+            (MAKE_64BIT_MASK(0, len) & ~ti_src->def_val) == 0) {
+            src = ti_src->def_src;
+        }
+
+        /*
+         * Skip a mask on the background whose cleared bits all lie
+         * within the field that deposit replaces.
+         */
+        if (!ti_is_const(tb) && ti_def_valid(tb) &&
+            tb->def_opc == and_opc &&
+            (~tb->def_val & ~fld_mask & width_mask) == 0) {
+            bg = temp_arg(tb->def_src);
+        }
+
+        op2 = tcg_op_insert_before(ctx->tcg, op, dep_opc, 5);
+        op2->args[0] = op->args[0];
+        op2->args[1] = bg;
+        op2->args[2] = temp_arg(src);
+        op2->args[3] = ofs;
+        op2->args[4] = len;
+
+        tcg_op_remove(ctx->tcg, op);
+        return fold_deposit(ctx, op2);
+    }
+    return false;
+}
+
 static bool fold_or(OptContext *ctx, TCGOp *op)
 {
     uint64_t z_mask, s_mask;
@@ -2166,6 +2419,10 @@ static bool fold_or(OptContext *ctx, TCGOp *op)
         return true;
     }
 
+    if (fold_or_to_deposit(ctx, op)) {
+        return true;
+    }
+
     t1 = arg_info(op->args[1]);
     t2 = arg_info(op->args[2]);
     z_mask = t1->z_mask | t2->z_mask;
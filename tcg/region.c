@@ -422,6 +422,67 @@ void tcg_region_reset_all(void)
     tcg_region_tree_reset_all();
 }
 
+static gboolean tcg_region_reclaim_collect(gpointer key, gpointer value,
+                                           gpointer data)
+{
+    g_ptr_array_add(data, value);
+    return FALSE;
+}
+
+/*
+ * Called from a safe-work context when @s has exhausted the region pool.
+ * Pick a full region that no TCG context is currently translating into,
+ * hand it to @s for reuse, and return the TBs still living in it so the
+ * caller can invalidate them (and tcg_tb_remove() them, which empties
+ * the region's tree again).  Returns NULL when every region is some
+ * context's current region and only a full flush can make room.
+ */
+GPtrArray *tcg_region_reclaim(TCGContext *s)
+{
+    unsigned int n_ctxs = qatomic_read(&tcg_cur_ctxs);
+    static size_t next_victim;
+    GPtrArray *tbs = NULL;
+    size_t i, j;
+
+    qemu_mutex_lock(&region.lock);
+    for (i = 0; i < region.current && !tbs; i++) {
+        size_t v = (next_victim + i) % region.current;
+        struct tcg_region_tree *rt;
+        void *start, *end;
+        bool active = false;
+
+        tcg_region_bounds(v, &start, &end);
+        for (j = 0; j < n_ctxs; j++) {
+            TCGContext *ctx = qatomic_read(&tcg_ctxs[j]);
+
+            if (ctx->code_gen_buffer == start) {
+                active = true;
+                break;
+            }
+        }
+        if (active) {
+            continue;
+        }
+
+        /*
+         * @s abandons its full region and takes over @v; the set of
+         * full regions shrinks by @v and grows by the abandoned one.
+         */
+        region.agg_size_full += s->code_gen_buffer_size - TCG_HIGHWATER;
+        region.agg_size_full -= (end - start) - TCG_HIGHWATER;
+        tcg_region_assign(s, v);
+
+        rt = region_trees + v * tree_size;
+        tbs = g_ptr_array_new();
+        qemu_mutex_lock(&rt->lock);
+        q_tree_foreach(rt->tree, tcg_region_reclaim_collect, tbs);
+        qemu_mutex_unlock(&rt->lock);
+        next_victim = (v + 1) % region.current;
+    }
+    qemu_mutex_unlock(&region.lock);
+    return tbs;
+}
+
 static size_t tcg_n_regions(size_t tb_size, unsigned max_cpus)
 {
 #ifdef CONFIG_USER_ONLY
@@ -0,0 +1,153 @@
+/*
+ * AioContext and coroutine dispatch microbenchmarks
+ *
+ * Measures the per-operation cost of the event loop hot paths: bottom
+ * half scheduling, event notifier dispatch through aio_poll(), and
+ * coroutine switching.  Results are reported via g_test_message() so
+ * the TAP output of the "speed" suite can be scraped for regression
+ * tracking.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * later.  See the COPYING file in the top-level directory.
+ */
+#include "qemu/osdep.h"
+#include "block/aio.h"
+#include "qapi/error.h"
+#include "qemu/coroutine-core.h"
+#include "qemu/main-loop.h"
+
+static AioContext *ctx;
+
+typedef struct {
+    QEMUBH *bh;
+    unsigned int n;
+    unsigned int max;
+} BHBenchData;
+
+static void bh_bench_cb(void *opaque)
+{
+    BHBenchData *data = opaque;
+
+    if (++data->n < data->max) {
+        qemu_bh_schedule(data->bh);
+    }
+}
+
+static void bench_bh_dispatch(void)
+{
+    BHBenchData data = { .n = 0, .max = 1000000 };
+    double duration;
+
+    data.bh = aio_bh_new(ctx, bh_bench_cb, &data);
+
+    g_test_timer_start();
+    qemu_bh_schedule(data.bh);
+    while (data.n < data.max) {
+        aio_poll(ctx, true);
+    }
+    duration = g_test_timer_elapsed();
+
+    qemu_bh_delete(data.bh);
+    g_test_message("BH schedule/dispatch %u iterations: %f s (%.1f ns/op)",
+                   data.max, duration, duration * 1e9 / data.max);
+}
+
+typedef struct {
+    EventNotifier e;
+    unsigned int n;
+    unsigned int max;
+} NotifierBenchData;
+
+static void notifier_bench_cb(EventNotifier *e)
+{
+    NotifierBenchData *data = container_of(e, NotifierBenchData, e);
+
+    event_notifier_test_and_clear(e);
+    if (++data->n < data->max) {
+        event_notifier_set(e);
+    }
+}
+
+static void bench_notifier_dispatch(void)
+{
+    NotifierBenchData data = { .n = 0, .max = 100000 };
+    double duration;
+
+    event_notifier_init(&data.e, false);
+    aio_set_event_notifier(ctx, &data.e, notifier_bench_cb, NULL, NULL);
+
+    g_test_timer_start();
+    event_notifier_set(&data.e);
+    while (data.n < data.max) {
+        aio_poll(ctx, true);
+    }
+    duration = g_test_timer_elapsed();
+
+    aio_set_event_notifier(ctx, &data.e, NULL, NULL, NULL);
+    event_notifier_cleanup(&data.e);
+    g_test_message("Notifier poll/dispatch %u iterations: %f s (%.1f ns/op)",
+                   data.max, duration, duration * 1e9 / data.max);
+}
+
+static void coroutine_fn yield_loop(void *opaque)
+{
+    unsigned int *counter = opaque;
+
+    while ((*counter) > 0) {
+        (*counter)--;
+        qemu_coroutine_yield();
+    }
+}
+
+static void bench_coroutine_yield(void)
+{
+    unsigned int i, max = 10000000;
+    Coroutine *co;
+    double duration;
+
+    i = max;
+    co = qemu_coroutine_create(yield_loop, &i);
+
+    g_test_timer_start();
+    while (i > 0) {
+        qemu_coroutine_enter(co);
+    }
+    duration = g_test_timer_elapsed();
+
+    g_test_message("Coroutine enter/yield %u iterations: %f s (%.1f ns/op)",
+                   max, duration, duration * 1e9 / max);
+}
+
+static void coroutine_fn empty_coroutine(void *opaque)
+{
+}
+
+static void bench_coroutine_lifecycle(void)
+{
+    unsigned int i, max = 1000000;
+    Coroutine *co;
+    double duration;
+
+    g_test_timer_start();
+    for (i = 0; i < max; i++) {
+        co = qemu_coroutine_create(empty_coroutine, NULL);
+        qemu_coroutine_enter(co);
+    }
+    duration = g_test_timer_elapsed();
+
+    g_test_message("Coroutine lifecycle %u iterations: %f s (%.1f ns/op)",
+                   max, duration, duration * 1e9 / max);
+}
+
+int main(int argc, char **argv)
+{
+    qemu_init_main_loop(&error_fatal);
+    ctx = qemu_get_aio_context();
+
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/aio/bench/bh-dispatch", bench_bh_dispatch);
+    g_test_add_func("/aio/bench/notifier-dispatch", bench_notifier_dispatch);
+    g_test_add_func("/aio/bench/coroutine-yield", bench_coroutine_yield);
+    g_test_add_func("/aio/bench/coroutine-lifecycle", bench_coroutine_lifecycle);
+    return g_test_run();
+}
@@ -27,18 +27,23 @@ static void ptimer_test_expire_qemu_timers(int64_t expire_time,
                                            QEMUClockType type)
 {
     QEMUTimerList *timer_list = main_loop_tlg.tl[type];
-    QEMUTimer *t = timer_list->active_timers.next;
+    guint i = 0;
+
+    while (i < timer_list->active_timers->len) {
+        QEMUTimer *t = g_ptr_array_index(timer_list->active_timers, i);
 
-    while (t != NULL) {
         if (t->expire_time == expire_time) {
             timer_del(t);
 
             if (t->cb != NULL) {
                 t->cb(t->opaque);
             }
-        }
 
-        t = t->next;
+            /* The callback may have re-armed or deleted timers; rescan.  */
+            i = 0;
+        } else {
+            i++;
+        }
     }
 }
 
@@ -915,6 +920,7 @@ int main(int argc, char **argv)
 
     for (i = 0; i < QEMU_CLOCK_MAX; i++) {
         main_loop_tlg.tl[i] = g_new0(QEMUTimerList, 1);
+        main_loop_tlg.tl[i]->active_timers = g_ptr_array_new();
     }
 
     add_all_ptimer_policies_comb_tests();
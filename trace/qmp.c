@@ -11,6 +11,9 @@
 #include "qapi/error.h"
 #include "qapi/qapi-commands-trace.h"
 #include "control.h"
+#ifdef CONFIG_TRACE_SIMPLE
+#include "simple.h"
+#endif
 
 
 static bool check_events(bool ignore_unavailable, bool is_pattern,
@@ -106,3 +109,10 @@ void qmp_trace_event_set_state(const char *name, bool enable,
         trace_event_set_state_dynamic(ev, enable);
     }
 }
+
+#ifdef CONFIG_TRACE_SIMPLE
+void qmp_trace_flush(Error **errp)
+{
+    st_flush_trace_buffer();
+}
+#endif
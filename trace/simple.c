@@ -30,9 +30,6 @@
 /** Records were dropped event ID */
 #define DROPPED_EVENT_ID (~(uint64_t)0 - 1)
 
-/** Trace record is valid */
-#define TRACE_RECORD_VALID ((uint64_t)1 << 63)
-
 /*
  * Trace records are written out by a dedicated thread.  The thread waits for
  * records to become available, writes them out, and then waits again.
@@ -45,14 +42,30 @@ static bool trace_available;
 static bool trace_writeout_enabled;
 
 enum {
-    TRACE_BUF_LEN = 4096 * 64,
+    TRACE_BUF_LEN = 4096 * 16,
     TRACE_BUF_FLUSH_THRESHOLD = TRACE_BUF_LEN / 4,
 };
 
-uint8_t trace_buf[TRACE_BUF_LEN];
-static volatile gint trace_idx;
-static unsigned int writeout_idx;
-static volatile gint dropped_events;
+/*
+ * Each thread that emits trace records owns a single-producer
+ * single-consumer ring buffer, so the record fast path never takes a
+ * lock or bounces a cache line written by other threads.  The writeout
+ * thread is the only consumer for every ring: producers publish
+ * completed records by advancing their producer index behind a write
+ * barrier, and rings of exited threads are freed by the writeout
+ * thread once they have been drained.
+ */
+typedef struct TraceThreadBuffer {
+    struct TraceThreadBuffer *next; /* registration list, under trace_lock */
+    volatile gint prod_idx;         /* written by the owner thread only */
+    volatile gint cons_idx;         /* written by the writeout thread only */
+    volatile gint dropped_events;
+    volatile gint exited;           /* owner thread gone; free once drained */
+    uint8_t buf[TRACE_BUF_LEN];
+} TraceThreadBuffer;
+
+static TraceThreadBuffer *trace_buffers;
+static __thread TraceThreadBuffer *trace_thread_buffer;
 static uint32_t trace_pid;
 static FILE *trace_fp;
 static char *trace_file_name;
@@ -76,53 +89,68 @@ typedef struct {
 } TraceLogHeader;
 
 
-static void read_from_buffer(unsigned int idx, void *dataptr, size_t size);
-static unsigned int write_to_buffer(unsigned int idx, void *dataptr, size_t size);
+static void flush_trace_file(bool wait);
 
-static void clear_buffer_range(unsigned int idx, size_t len)
+static void read_from_buffer(TraceThreadBuffer *tb, unsigned int idx,
+                             void *dataptr, size_t size)
 {
-    uint32_t num = 0;
-    while (num < len) {
+    uint8_t *data_ptr = dataptr;
+    uint32_t x = 0;
+    while (x < size) {
         if (idx >= TRACE_BUF_LEN) {
             idx = idx % TRACE_BUF_LEN;
         }
-        trace_buf[idx++] = 0;
-        num++;
+        data_ptr[x++] = tb->buf[idx++];
     }
 }
-/**
- * Read a trace record from the trace buffer
- *
- * @idx         Trace buffer index
- * @record      Trace record to fill
- *
- * Returns false if the record is not valid.
- */
-static bool get_trace_record(unsigned int idx, TraceRecord **recordptr)
+
+static unsigned int write_to_buffer(TraceThreadBuffer *tb, unsigned int idx,
+                                    void *dataptr, size_t size)
 {
-    uint64_t event_flag = 0;
-    TraceRecord record;
-    /* read the event flag to see if its a valid record */
-    read_from_buffer(idx, &record, sizeof(event_flag));
+    uint8_t *data_ptr = dataptr;
+    uint32_t x = 0;
+    while (x < size) {
+        if (idx >= TRACE_BUF_LEN) {
+            idx = idx % TRACE_BUF_LEN;
+        }
+        tb->buf[idx++] = data_ptr[x++];
+    }
+    return idx; /* most callers wants to know where to write next */
+}
 
-    if (!(record.event & TRACE_RECORD_VALID)) {
-        return false;
+static void trace_thread_buffer_exited(gpointer opaque)
+{
+    TraceThreadBuffer *tb = opaque;
+
+    /* The writeout thread frees the ring once it has been drained.  */
+    g_atomic_int_set(&tb->exited, true);
+    flush_trace_file(false);
+}
+
+static GPrivate trace_buffer_key = G_PRIVATE_INIT(trace_thread_buffer_exited);
+
+static TraceThreadBuffer *trace_thread_buffer_get(void)
+{
+    TraceThreadBuffer *tb = trace_thread_buffer;
+
+    if (tb) {
+        return tb;
     }
 
-    smp_rmb(); /* read memory barrier before accessing record */
-    /* read the record header to know record length */
-    read_from_buffer(idx, &record, sizeof(TraceRecord));
-    *recordptr = malloc(record.length); /* don't use g_malloc, can deadlock when traced */
-    /* make a copy of record to avoid being overwritten */
-    read_from_buffer(idx, *recordptr, record.length);
-    smp_rmb(); /* memory barrier before clearing valid flag */
-    (*recordptr)->event &= ~TRACE_RECORD_VALID;
-    /* clear the trace buffer range for consumed record otherwise any byte
-     * with its MSB set may be considered as a valid event id when the writer
-     * thread crosses this range of buffer again.
-     */
-    clear_buffer_range(idx, record.length);
-    return true;
+    /* don't use g_malloc, can deadlock when traced */
+    tb = calloc(1, sizeof(*tb));
+    if (!tb) {
+        return NULL;
+    }
+
+    g_mutex_lock(&trace_lock);
+    tb->next = trace_buffers;
+    g_atomic_pointer_set(&trace_buffers, tb);
+    g_mutex_unlock(&trace_lock);
+
+    trace_thread_buffer = tb;
+    g_private_set(&trace_buffer_key, tb);
+    return tb;
 }
 
 /**
@@ -154,41 +182,88 @@ static void wait_for_trace_records_available(void)
     g_mutex_unlock(&trace_lock);
 }
 
-static gpointer writeout_thread(gpointer opaque)
+static void write_dropped_events(TraceThreadBuffer *tb)
 {
-    TraceRecord *recordptr;
     union {
         TraceRecord rec;
         uint8_t bytes[sizeof(TraceRecord) + sizeof(uint64_t)];
     } dropped;
-    unsigned int idx = 0;
+    uint64_t type = TRACE_RECORD_TYPE_EVENT;
     int dropped_count;
     size_t unused __attribute__ ((unused));
+
+    if (!g_atomic_int_get(&tb->dropped_events)) {
+        return;
+    }
+
+    dropped.rec.event = DROPPED_EVENT_ID;
+    dropped.rec.timestamp_ns = get_clock();
+    dropped.rec.length = sizeof(TraceRecord) + sizeof(uint64_t);
+    dropped.rec.pid = trace_pid;
+    do {
+        dropped_count = g_atomic_int_get(&tb->dropped_events);
+    } while (!g_atomic_int_compare_and_exchange(&tb->dropped_events,
+                                                dropped_count, 0));
+    dropped.rec.arguments[0] = dropped_count;
+    unused = fwrite(&type, sizeof(type), 1, trace_fp);
+    unused = fwrite(&dropped.rec, dropped.rec.length, 1, trace_fp);
+}
+
+static void drain_thread_buffer(TraceThreadBuffer *tb)
+{
+    unsigned int prod = (unsigned int)g_atomic_int_get(&tb->prod_idx);
+    unsigned int cons = (unsigned int)g_atomic_int_get(&tb->cons_idx);
     uint64_t type = TRACE_RECORD_TYPE_EVENT;
+    size_t unused __attribute__ ((unused));
+    TraceRecord record;
+    TraceRecord *recordptr;
+
+    smp_rmb(); /* read memory barrier before accessing published records */
+
+    while (cons != prod) {
+        read_from_buffer(tb, cons, &record, sizeof(TraceRecord));
+        /* don't use g_malloc, can deadlock when traced */
+        recordptr = malloc(record.length);
+        read_from_buffer(tb, cons, recordptr, record.length);
+        unused = fwrite(&type, sizeof(type), 1, trace_fp);
+        unused = fwrite(recordptr, recordptr->length, 1, trace_fp);
+        free(recordptr);
+        cons += record.length;
+        g_atomic_int_set(&tb->cons_idx, cons);
+    }
+}
+
+static bool thread_buffer_empty(TraceThreadBuffer *tb)
+{
+    return g_atomic_int_get(&tb->prod_idx) == g_atomic_int_get(&tb->cons_idx);
+}
+
+static gpointer writeout_thread(gpointer opaque)
+{
+    TraceThreadBuffer *tb, **prev;
 
     for (;;) {
         wait_for_trace_records_available();
 
-        if (g_atomic_int_get(&dropped_events)) {
-            dropped.rec.event = DROPPED_EVENT_ID;
-            dropped.rec.timestamp_ns = get_clock();
-            dropped.rec.length = sizeof(TraceRecord) + sizeof(uint64_t);
-            dropped.rec.pid = trace_pid;
-            do {
-                dropped_count = g_atomic_int_get(&dropped_events);
-            } while (!g_atomic_int_compare_and_exchange(&dropped_events,
-                                                        dropped_count, 0));
-            dropped.rec.arguments[0] = dropped_count;
-            unused = fwrite(&type, sizeof(type), 1, trace_fp);
-            unused = fwrite(&dropped.rec, dropped.rec.length, 1, trace_fp);
-        }
-
-        while (get_trace_record(idx, &recordptr)) {
-            unused = fwrite(&type, sizeof(type), 1, trace_fp);
-            unused = fwrite(recordptr, recordptr->length, 1, trace_fp);
-            writeout_idx += recordptr->length;
-            free(recordptr); /* don't use g_free, can deadlock when traced */
-            idx = writeout_idx % TRACE_BUF_LEN;
+        /*
+         * Traversal is safe without the lock: new rings are only ever
+         * inserted at the list head, and only this thread unlinks
+         * them.  Taking the lock is needed just to unlink, so that an
+         * insertion does not race with updating the head pointer.
+         */
+        prev = &trace_buffers;
+        while ((tb = *prev) != NULL) {
+            write_dropped_events(tb);
+            drain_thread_buffer(tb);
+
+            if (g_atomic_int_get(&tb->exited) && thread_buffer_empty(tb)) {
+                g_mutex_lock(&trace_lock);
+                *prev = tb->next;
+                g_mutex_unlock(&trace_lock);
+                free(tb);
+                continue;
+            }
+            prev = &tb->next;
         }
 
         fflush(trace_fp);
@@ -198,84 +273,65 @@ static gpointer writeout_thread(gpointer opaque)
 
 void trace_record_write_u64(TraceBufferRecord *rec, uint64_t val)
 {
-    rec->rec_off = write_to_buffer(rec->rec_off, &val, sizeof(uint64_t));
+    rec->rec_off = write_to_buffer(trace_thread_buffer, rec->rec_off,
+                                   &val, sizeof(uint64_t));
 }
 
 void trace_record_write_str(TraceBufferRecord *rec, const char *s, uint32_t slen)
 {
+    TraceThreadBuffer *tb = trace_thread_buffer;
+
     /* Write string length first */
-    rec->rec_off = write_to_buffer(rec->rec_off, &slen, sizeof(slen));
+    rec->rec_off = write_to_buffer(tb, rec->rec_off, &slen, sizeof(slen));
     /* Write actual string now */
-    rec->rec_off = write_to_buffer(rec->rec_off, (void*)s, slen);
+    rec->rec_off = write_to_buffer(tb, rec->rec_off, (void *)s, slen);
 }
 
 int trace_record_start(TraceBufferRecord *rec, uint32_t event, size_t datasize)
 {
-    unsigned int idx, rec_off, old_idx, new_idx;
+    TraceThreadBuffer *tb = trace_thread_buffer_get();
+    unsigned int idx, rec_off;
     uint32_t rec_len = sizeof(TraceRecord) + datasize;
     uint64_t event_u64 = event;
     uint64_t timestamp_ns = get_clock();
 
-    do {
-        old_idx = g_atomic_int_get(&trace_idx);
-        smp_rmb();
-        new_idx = old_idx + rec_len;
-
-        if (new_idx - writeout_idx > TRACE_BUF_LEN) {
-            /* Trace Buffer Full, Event dropped ! */
-            g_atomic_int_inc(&dropped_events);
-            return -ENOSPC;
-        }
-    } while (!g_atomic_int_compare_and_exchange(&trace_idx, old_idx, new_idx));
+    if (!tb) {
+        return -ENOMEM;
+    }
 
-    idx = old_idx % TRACE_BUF_LEN;
+    idx = (unsigned int)tb->prod_idx;
+    if (rec_len > TRACE_BUF_LEN ||
+        idx + rec_len - (unsigned int)g_atomic_int_get(&tb->cons_idx)
+        > TRACE_BUF_LEN) {
+        /* Trace Buffer Full, Event dropped ! */
+        g_atomic_int_inc(&tb->dropped_events);
+        return -ENOSPC;
+    }
 
     rec_off = idx;
-    rec_off = write_to_buffer(rec_off, &event_u64, sizeof(event_u64));
-    rec_off = write_to_buffer(rec_off, &timestamp_ns, sizeof(timestamp_ns));
-    rec_off = write_to_buffer(rec_off, &rec_len, sizeof(rec_len));
-    rec_off = write_to_buffer(rec_off, &trace_pid, sizeof(trace_pid));
+    rec_off = write_to_buffer(tb, rec_off, &event_u64, sizeof(event_u64));
+    rec_off = write_to_buffer(tb, rec_off, &timestamp_ns, sizeof(timestamp_ns));
+    rec_off = write_to_buffer(tb, rec_off, &rec_len, sizeof(rec_len));
+    rec_off = write_to_buffer(tb, rec_off, &trace_pid, sizeof(trace_pid));
 
     rec->tbuf_idx = idx;
-    rec->rec_off  = (idx + sizeof(TraceRecord)) % TRACE_BUF_LEN;
+    rec->rec_off  = idx + sizeof(TraceRecord);
     return 0;
 }
 
-static void read_from_buffer(unsigned int idx, void *dataptr, size_t size)
-{
-    uint8_t *data_ptr = dataptr;
-    uint32_t x = 0;
-    while (x < size) {
-        if (idx >= TRACE_BUF_LEN) {
-            idx = idx % TRACE_BUF_LEN;
-        }
-        data_ptr[x++] = trace_buf[idx++];
-    }
-}
-
-static unsigned int write_to_buffer(unsigned int idx, void *dataptr, size_t size)
-{
-    uint8_t *data_ptr = dataptr;
-    uint32_t x = 0;
-    while (x < size) {
-        if (idx >= TRACE_BUF_LEN) {
-            idx = idx % TRACE_BUF_LEN;
-        }
-        trace_buf[idx++] = data_ptr[x++];
-    }
-    return idx; /* most callers wants to know where to write next */
-}
-
 void trace_record_finish(TraceBufferRecord *rec)
 {
+    TraceThreadBuffer *tb = trace_thread_buffer;
     TraceRecord record;
-    read_from_buffer(rec->tbuf_idx, &record, sizeof(TraceRecord));
-    smp_wmb(); /* write barrier before marking as valid */
-    record.event |= TRACE_RECORD_VALID;
-    write_to_buffer(rec->tbuf_idx, &record, sizeof(TraceRecord));
+    unsigned int pending;
+
+    read_from_buffer(tb, rec->tbuf_idx, &record, sizeof(TraceRecord));
+    smp_wmb(); /* write barrier before publishing the record */
+    g_atomic_int_set(&tb->prod_idx, rec->tbuf_idx + record.length);
 
-    if (((unsigned int)g_atomic_int_get(&trace_idx) - writeout_idx)
-        > TRACE_BUF_FLUSH_THRESHOLD) {
+    pending = rec->tbuf_idx + record.length
+              - (unsigned int)g_atomic_int_get(&tb->cons_idx);
+    if (pending > TRACE_BUF_FLUSH_THRESHOLD) {
         flush_trace_file(false);
     }
 }
@@ -20,6 +20,9 @@ struct QemuConsole {
     int index;
     DisplayState *ds;
     DisplaySurface *surface;
+    /* copy of the surface as of the last forwarded update, for tile
+     * based dirty tracking; NULL when tracking is not active */
+    uint8_t *tile_shadow;
     DisplayScanout scanout;
     int dcls;
     DisplayGLCtx *gl;
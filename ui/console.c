@@ -396,6 +396,7 @@ qemu_console_finalize(Object *obj)
 
     /* TODO: check this code path, and unregister from consoles */
     g_clear_pointer(&c->surface, qemu_free_displaysurface);
+    g_clear_pointer(&c->tile_shadow, g_free);
     g_clear_pointer(&c->gl_unblock_timer, timer_free);
     g_clear_pointer(&c->ui_timer, timer_free);
 }
@@ -772,12 +773,71 @@ int dpy_set_ui_info(QemuConsole *con, QemuUIInfo *info, bool delay)
     return 0;
 }
 
-void dpy_gfx_update(QemuConsole *con, int x, int y, int w, int h)
+/*
+ * Display devices with page granular dirty logging report update strips
+ * spanning the whole scanline.  The console keeps a shadow copy of the
+ * surface and narrows such strips down to 64x64 tiles that actually
+ * changed before forwarding them, so all consumers see tight
+ * rectangles without tracking dirty state themselves.
+ */
+#define DPY_TILE_SIZE 64
+
+static void dpy_gfx_shadow_reset(QemuConsole *con)
+{
+    DisplaySurface *surface = con->surface;
+
+    g_clear_pointer(&con->tile_shadow, g_free);
+    if (surface && !surface_is_placeholder(surface)) {
+        size_t size = (size_t)surface_stride(surface) *
+            surface_height(surface);
+
+        con->tile_shadow = g_memdup2(surface_data(surface), size);
+    }
+}
+
+/* returns true when the rectangle differs from the shadow copy,
+ * bringing the shadow up to date as a side effect */
+static bool dpy_gfx_shadow_sync(QemuConsole *con, int x, int y, int w, int h)
+{
+    DisplaySurface *surface = con->surface;
+    int stride = surface_stride(surface);
+    uint8_t *data = surface_data(surface);
+    size_t offset = (size_t)y * stride +
+        (size_t)x * surface_bytes_per_pixel(surface);
+    size_t len = (size_t)w * surface_bytes_per_pixel(surface);
+    bool changed = false;
+    int line;
+
+    for (line = 0; line < h; line++, offset += stride) {
+        if (memcmp(con->tile_shadow + offset, data + offset, len) != 0) {
+            memcpy(con->tile_shadow + offset, data + offset, len);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+static void dpy_gfx_update_fwd(QemuConsole *con, int x, int y, int w, int h)
 {
     DisplayState *s = con->ds;
     DisplayChangeListener *dcl;
+
+    dpy_gfx_update_texture(con, con->surface, x, y, w, h);
+    QLIST_FOREACH(dcl, &s->listeners, next) {
+        if (con != dcl->con) {
+            continue;
+        }
+        if (dcl->ops->dpy_gfx_update) {
+            dcl->ops->dpy_gfx_update(dcl, x, y, w, h);
+        }
+    }
+}
+
+void dpy_gfx_update(QemuConsole *con, int x, int y, int w, int h)
+{
     int width = qemu_console_get_width(con, x + w);
     int height = qemu_console_get_height(con, y + h);
+    int tx, ty, tx2, ty2, run;
 
     x = MAX(x, 0);
     y = MAX(y, 0);
@@ -789,13 +849,34 @@ void dpy_gfx_update(QemuConsole *con, int x, int y, int w, int h)
     if (!qemu_console_is_visible(con)) {
         return;
     }
-    dpy_gfx_update_texture(con, con->surface, x, y, w, h);
-    QLIST_FOREACH(dcl, &s->listeners, next) {
-        if (con != dcl->con) {
-            continue;
+    if (!con->tile_shadow || con->scanout.kind != SCANOUT_SURFACE ||
+        w <= DPY_TILE_SIZE) {
+        /* narrow updates are forwarded as-is, but the shadow must
+         * still follow the surface */
+        if (con->tile_shadow && con->scanout.kind == SCANOUT_SURFACE &&
+            w > 0 && h > 0) {
+            dpy_gfx_shadow_sync(con, x, y, w, h);
         }
-        if (dcl->ops->dpy_gfx_update) {
-            dcl->ops->dpy_gfx_update(dcl, x, y, w, h);
+        dpy_gfx_update_fwd(con, x, y, w, h);
+        return;
+    }
+
+    for (ty = y; ty < y + h; ty = ty2) {
+        ty2 = MIN(QEMU_ALIGN_UP(ty + 1, DPY_TILE_SIZE), y + h);
+        run = -1;
+        for (tx = x; tx < x + w; tx = tx2) {
+            tx2 = MIN(QEMU_ALIGN_UP(tx + 1, DPY_TILE_SIZE), x + w);
+            if (dpy_gfx_shadow_sync(con, tx, ty, tx2 - tx, ty2 - ty)) {
+                if (run < 0) {
+                    run = tx;
+                }
+            } else if (run >= 0) {
+                dpy_gfx_update_fwd(con, run, ty, tx - run, ty2 - ty);
+                run = -1;
+            }
+        }
+        if (run >= 0) {
+            dpy_gfx_update_fwd(con, run, ty, x + w - run, ty2 - ty);
         }
     }
 }
@@ -835,6 +916,7 @@ void dpy_gfx_replace_surface(QemuConsole *con,
 
     con->scanout.kind = SCANOUT_SURFACE;
     con->surface = new_surface;
+    dpy_gfx_shadow_reset(con);
     dpy_gfx_create_texture(con, new_surface);
     QLIST_FOREACH(dcl, &s->listeners, next) {
         if (con != dcl->con) {
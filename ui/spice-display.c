@@ -169,11 +169,14 @@ static void qemu_spice_create_one_update(SimpleSpiceDisplay *ssd,
     image->bitmap.palette = 0;
     image->bitmap.format = SPICE_BITMAP_FMT_32BIT;
 
+    /*
+     * The mirror already carries the new pixels for this rect: the diff
+     * scan in qemu_spice_create_update copies each changed line as it
+     * finds it, so a single conversion into the update bitmap is all
+     * that is left to do here.
+     */
     dest = pixman_image_create_bits(PIXMAN_LE_x8r8g8b8, bw, bh,
                                     (void *)update->bitmap, bw * 4);
-    pixman_image_composite(PIXMAN_OP_SRC, ssd->surface, NULL, ssd->mirror,
-                           rect->left, rect->top, 0, 0,
-                           rect->left, rect->top, bw, bh);
     pixman_image_composite(PIXMAN_OP_SRC, ssd->mirror, NULL, dest,
                            rect->left, rect->top, 0, 0,
                            0, 0, bw, bh);
@@ -226,6 +229,13 @@ static void qemu_spice_create_update(SimpleSpiceDisplay *ssd)
                     dirty_top[blk] = -1;
                 }
             } else {
+                /*
+                 * Refresh the mirror line while it is still cache-hot
+                 * from the compare; qemu_spice_create_one_update then
+                 * only needs one copy per damaged block instead of
+                 * re-reading the guest surface.
+                 */
+                memcpy(mirror + yoff2 + xoff, guest + yoff1 + xoff, bw * bpp);
                 if (dirty_top[blk] == -1) {
                     dirty_top[blk] = y;
                 }
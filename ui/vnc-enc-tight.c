@@ -142,7 +142,7 @@ tight_detect_smooth_image24(VncState *vs, int w, int h)
     unsigned int c;
     unsigned int stats[256];
     int pixels = 0;
-    int pix, left[3];
+    int pix, left;
     unsigned int errors;
     unsigned char *buf = vs->tight->tight.buffer;
 
@@ -157,14 +157,17 @@ tight_detect_smooth_image24(VncState *vs, int w, int h)
     for (y = 0, x = 0; y < h && x < w;) {
         for (d = 0; d < h - y && d < w - x - VNC_TIGHT_DETECT_SUBROW_WIDTH;
              d++) {
-            for (c = 0; c < 3; c++) {
-                left[c] = buf[((y+d)*w+x+d)*4+off+c] & 0xFF;
-            }
+            /*
+             * Re-reading the left neighbour instead of carrying it
+             * across iterations keeps the iterations independent, so
+             * the compiler can pipeline the sample extraction; only
+             * the histogram update is serialized.
+             */
             for (dx = 1; dx <= VNC_TIGHT_DETECT_SUBROW_WIDTH; dx++) {
                 for (c = 0; c < 3; c++) {
+                    left = buf[((y+d)*w+x+d+dx-1)*4+off+c] & 0xFF;
                     pix = buf[((y+d)*w+x+d+dx)*4+off+c] & 0xFF;
-                    stats[abs(pix - left[c])]++;
-                    left[c] = pix;
+                    stats[abs(pix - left)]++;
                 }
                 pixels++;
             }
@@ -213,7 +216,8 @@ tight_detect_smooth_image24(VncState *vs, int w, int h)
         unsigned int c;                                                 \
         unsigned int stats[256];                                        \
         int pixels = 0;                                                 \
-        int sample, sum, left[3];                                       \
+        uint##bpp##_t left;                                             \
+        int sum;                                                        \
         unsigned int errors;                                            \
         unsigned char *buf = vs->tight->tight.buffer;                    \
                                                                         \
@@ -233,24 +237,21 @@ tight_detect_smooth_image24(VncState *vs, int w, int h)
         while (y < h && x < w) {                                        \
             for (d = 0; d < h - y &&                                    \
                      d < w - x - VNC_TIGHT_DETECT_SUBROW_WIDTH; d++) {  \
-                pix = ((uint##bpp##_t *)buf)[(y+d)*w+x+d];              \
-                if (endian) {                                           \
-                    pix = bswap##bpp(pix);                              \
-                }                                                       \
-                for (c = 0; c < 3; c++) {                               \
-                    left[c] = (int)(pix >> shift[c] & max[c]);          \
-                }                                                       \
+                /* Iterations are independent: each loads its own      \
+                 * left neighbour instead of carrying the unpacked     \
+                 * samples across iterations. */                        \
                 for (dx = 1; dx <= VNC_TIGHT_DETECT_SUBROW_WIDTH;       \
                      dx++) {                                            \
+                    left = ((uint##bpp##_t *)buf)[(y+d)*w+x+d+dx-1];    \
                     pix = ((uint##bpp##_t *)buf)[(y+d)*w+x+d+dx];       \
                     if (endian) {                                       \
+                        left = bswap##bpp(left);                        \
                         pix = bswap##bpp(pix);                          \
                     }                                                   \
                     sum = 0;                                            \
                     for (c = 0; c < 3; c++) {                           \
-                        sample = (int)(pix >> shift[c] & max[c]);       \
-                        sum += abs(sample - left[c]);                   \
-                        left[c] = sample;                               \
+                        sum += abs((int)(pix >> shift[c] & max[c]) -    \
+                                   (int)(left >> shift[c] & max[c]));   \
                     }                                                   \
                     if (sum > 255) {                                    \
                         sum = 255;                                      \
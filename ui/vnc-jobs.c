@@ -56,17 +56,22 @@
 struct VncJobQueue {
     QemuCond cond;
     QemuMutex mutex;
-    QemuThread thread;
     bool exit;
-    QTAILQ_HEAD(, VncJob) jobs;
+    int n_threads;   /* workers still running, the last one frees the queue */
+    QTAILQ_HEAD(, VncJob) jobs;      /* pending jobs, in submission order */
+    QTAILQ_HEAD(, VncJob) inflight;  /* jobs currently being encoded */
 };
 
 typedef struct VncJobQueue VncJobQueue;
 
 /*
- * We use a single global queue, but most of the functions are
- * already reentrant, so we can easily add more than one encoding thread
+ * One global queue is shared by a small pool of encoding threads,
+ * sized from the number of host CPUs.  Jobs for different clients are
+ * encoded in parallel; jobs for the same client stay serialized so
+ * that its output buffer is produced in submission order.
  */
+#define VNC_WORKER_THREADS_MAX 8
+
 static VncJobQueue *queue;
 
 static void vnc_lock_queue(VncJobQueue *queue)
@@ -129,9 +134,42 @@ static bool vnc_has_job_locked(VncState *vs)
             return true;
         }
     }
+    QTAILQ_FOREACH(job, &queue->inflight, next) {
+        if (job->vs == vs || !vs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool vnc_job_inflight_locked(VncState *vs)
+{
+    VncJob *job;
+
+    QTAILQ_FOREACH(job, &queue->inflight, next) {
+        if (job->vs == vs) {
+            return true;
+        }
+    }
     return false;
 }
 
+/*
+ * Pick the oldest pending job whose client is not already being
+ * encoded by another worker, so per-client ordering is preserved.
+ */
+static VncJob *vnc_worker_pick_job_locked(VncJobQueue *queue)
+{
+    VncJob *job;
+
+    QTAILQ_FOREACH(job, &queue->jobs, next) {
+        if (!vnc_job_inflight_locked(job->vs)) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
 void vnc_jobs_join(VncState *vs)
 {
     vnc_lock_queue(queue);
@@ -244,16 +282,16 @@ static int vnc_worker_thread_loop(VncJobQueue *queue)
     int saved_offset;
 
     vnc_lock_queue(queue);
-    while (QTAILQ_EMPTY(&queue->jobs) && !queue->exit) {
+    while ((job = vnc_worker_pick_job_locked(queue)) == NULL && !queue->exit) {
         qemu_cond_wait(&queue->cond, &queue->mutex);
     }
-    /* Here job can only be NULL if queue->exit is true */
-    job = QTAILQ_FIRST(&queue->jobs);
-    vnc_unlock_queue(queue);
-
     if (queue->exit) {
+        vnc_unlock_queue(queue);
         return -1;
     }
+    QTAILQ_REMOVE(&queue->jobs, job, next);
+    QTAILQ_INSERT_TAIL(&queue->inflight, job, next);
+    vnc_unlock_queue(queue);
 
     assert(job->vs->magic == VNC_MAGIC);
 
@@ -283,12 +321,12 @@ static int vnc_worker_thread_loop(VncJobQueue *queue)
     saved_offset = vs.output.offset;
     vnc_write_u16(&vs, 0);
 
-    vnc_lock_display(job->vs->vd);
+    vnc_lock_display_shared(job->vs->vd);
     QLIST_FOREACH_SAFE(entry, &job->rectangles, next, tmp) {
         int n;
 
         if (job->vs->ioc == NULL) {
-            vnc_unlock_display(job->vs->vd);
+            vnc_unlock_display_shared(job->vs->vd);
             /* Copy persistent encoding data */
             vnc_async_encoding_end(job->vs, &vs);
             goto disconnected;
@@ -305,7 +343,7 @@ static int vnc_worker_thread_loop(VncJobQueue *queue)
         g_free(entry);
     }
     trace_vnc_job_nrects(&vs, job, n_rectangles);
-    vnc_unlock_display(job->vs->vd);
+    vnc_unlock_display_shared(job->vs->vd);
 
     /* Put n_rectangles at the beginning of the message */
     vs.output.buffer[saved_offset] = (n_rectangles >> 8) & 0xFF;
@@ -327,7 +365,7 @@ static int vnc_worker_thread_loop(VncJobQueue *queue)
 
 disconnected:
     vnc_lock_queue(queue);
-    QTAILQ_REMOVE(&queue->jobs, job, next);
+    QTAILQ_REMOVE(&queue->inflight, job, next);
     vnc_unlock_queue(queue);
     qemu_cond_broadcast(&queue->cond);
     g_free(job);
@@ -342,6 +380,7 @@ static VncJobQueue *vnc_queue_init(void)
     qemu_cond_init(&queue->cond);
     qemu_mutex_init(&queue->mutex);
     QTAILQ_INIT(&queue->jobs);
+    QTAILQ_INIT(&queue->inflight);
     return queue;
 }
 
@@ -356,11 +395,16 @@ static void vnc_queue_clear(VncJobQueue *q)
 static void *vnc_worker_thread(void *arg)
 {
     VncJobQueue *queue = arg;
-
-    qemu_thread_get_self(&queue->thread);
+    bool last;
 
     while (!vnc_worker_thread_loop(queue)) ;
-    vnc_queue_clear(queue);
+
+    vnc_lock_queue(queue);
+    last = --queue->n_threads == 0;
+    vnc_unlock_queue(queue);
+    if (last) {
+        vnc_queue_clear(queue);
+    }
     return NULL;
 }
 
@@ -372,12 +416,19 @@ static bool vnc_worker_thread_running(void)
 void vnc_start_worker_thread(void)
 {
     VncJobQueue *q;
+    QemuThread thread;
+    int i, n_threads;
 
     if (vnc_worker_thread_running())
         return;
 
+    n_threads = MIN(MAX(1, g_get_num_processors()), VNC_WORKER_THREADS_MAX);
+
     q = vnc_queue_init();
-    qemu_thread_create(&q->thread, "vnc_worker", vnc_worker_thread, q,
-                       QEMU_THREAD_DETACHED);
-    queue = q; /* Set global queue */
+    q->n_threads = n_threads;
+    queue = q; /* Set global queue before the workers start looking at it */
+    for (i = 0; i < n_threads; i++) {
+        qemu_thread_create(&thread, "vnc_worker", vnc_worker_thread, q,
+                           QEMU_THREAD_DETACHED);
+    }
 }
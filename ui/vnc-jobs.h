@@ -39,20 +39,32 @@ void vnc_jobs_join(VncState *vs);
 void vnc_jobs_consume_buffer(VncState *vs);
 void vnc_start_worker_thread(void);
 
-/* Locks */
+/*
+ * Locks
+ *
+ * The display lock is a reader/writer lock: the encoding workers only
+ * read the server surface and may run concurrently for different
+ * clients, while vnc_refresh_server_surface() takes the writer side
+ * to update the surface.
+ */
 static inline int vnc_trylock_display(VncDisplay *vd)
 {
-    return qemu_mutex_trylock(&vd->mutex);
+    return !g_rw_lock_writer_trylock(&vd->lock);
+}
+
+static inline void vnc_unlock_display(VncDisplay *vd)
+{
+    g_rw_lock_writer_unlock(&vd->lock);
 }
 
-static inline void vnc_lock_display(VncDisplay *vd)
+static inline void vnc_lock_display_shared(VncDisplay *vd)
 {
-    qemu_mutex_lock(&vd->mutex);
+    g_rw_lock_reader_lock(&vd->lock);
 }
 
-static inline void vnc_unlock_display(VncDisplay *vd)
+static inline void vnc_unlock_display_shared(VncDisplay *vd)
 {
-    qemu_mutex_unlock(&vd->mutex);
+    g_rw_lock_reader_unlock(&vd->lock);
 }
 
 static inline void vnc_lock_output(VncState *vs)
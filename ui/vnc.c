@@ -3416,7 +3416,7 @@ void vnc_display_init(const char *id, Error **errp)
     vd->share_policy = VNC_SHARE_POLICY_ALLOW_EXCLUSIVE;
     vd->connections_limit = 32;
 
-    qemu_mutex_init(&vd->mutex);
+    g_rw_lock_init(&vd->lock);
     vnc_start_worker_thread();
 
     vd->dcl.ops = &dcl_ops;
@@ -157,7 +157,7 @@ struct VncDisplay
     QEMUPutLEDEntry *led;
     int ledstate;
     QKbdState *kbd;
-    QemuMutex mutex;
+    GRWLock lock;
 
     int cursor_msize;
     uint8_t *cursor_mask;
@@ -16,6 +16,8 @@
 #include "qemu/osdep.h"
 #include "block/block.h"
 #include "block/thread-pool.h"
+#include "qemu/counter.h"
+#include "qemu/defer-call.h"
 #include "qemu/main-loop.h"
 #include "qemu/lockcnt.h"
 #include "qemu/rcu.h"
@@ -433,8 +435,11 @@ static bool aio_dispatch_handlers(AioContext *ctx)
 void aio_dispatch(AioContext *ctx)
 {
     qemu_lockcnt_inc(&ctx->list_lock);
+    /* Batch up I/O submissions from all handlers run in this iteration */
+    defer_call_begin();
     aio_bh_poll(ctx);
     aio_dispatch_handlers(ctx);
+    defer_call_end();
     aio_free_deleted_handlers(ctx);
     qemu_lockcnt_dec(&ctx->list_lock);
 
@@ -578,6 +583,9 @@ static bool run_poll_handlers(AioContext *ctx, AioHandlerList *ready_list,
     return progress;
 }
 
+QEMU_COUNTER_DEFINE(aio_poll_total_counter, "aio-poll")
+QEMU_COUNTER_DEFINE(aio_poll_success_counter, "aio-poll-success")
+
 /* try_poll_mode:
  * @ctx: the AioContext
  * @ready_list: list to add handlers that need to be run
@@ -611,7 +619,9 @@ static bool try_poll_mode(AioContext *ctx, AioHandlerList *ready_list,
          */
         poll_set_started(ctx, ready_list, true);
 
+        qemu_counter_inc(&aio_poll_total_counter);
         if (run_poll_handlers(ctx, ready_list, max_ns, timeout)) {
+            qemu_counter_inc(&aio_poll_success_counter);
             return true;
         }
     }
@@ -658,6 +668,19 @@ static void adjust_polling_time(AioContext *ctx, AioPolledEvent *poll,
     }
 }
 
+/*
+ * CPU time consumed by the calling thread, in nanoseconds.  Unlike the
+ * wall clock it does not advance while the thread is blocked, so deltas
+ * taken around an aio_poll() iteration measure dispatch work only.
+ */
+static int64_t thread_cputime_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * NANOSECONDS_PER_SECOND + ts.tv_nsec;
+}
+
 bool aio_poll(AioContext *ctx, bool blocking)
 {
     AioHandlerList ready_list = QLIST_HEAD_INITIALIZER(ready_list);
@@ -666,6 +689,7 @@ bool aio_poll(AioContext *ctx, bool blocking)
     int64_t timeout;
     int64_t start = 0;
     int64_t block_ns = 0;
+    int64_t cpu_start = thread_cputime_ns();
 
     /*
      * There cannot be two concurrent aio_poll calls for the same AioContext (or
@@ -686,6 +710,16 @@ bool aio_poll(AioContext *ctx, bool blocking)
     }
 
     timeout = blocking ? aio_compute_timeout(ctx) : 0;
+
+    if (timeout) {
+        /*
+         * We may be a nested event loop inside an enclosing defer_call
+         * section; deferred submissions must reach the kernel before we
+         * wait for their completions.
+         */
+        defer_call_flush();
+    }
+
     progress = try_poll_mode(ctx, &ready_list, &timeout);
     assert(!(timeout && progress));
 
@@ -743,8 +777,11 @@ bool aio_poll(AioContext *ctx, bool blocking)
         block_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME) - start;
     }
 
+    /* Batch up I/O submissions from all handlers run in this iteration */
+    defer_call_begin();
     progress |= aio_bh_poll(ctx);
     progress |= aio_dispatch_ready_handlers(ctx, &ready_list, block_ns);
+    defer_call_end();
 
     aio_free_deleted_handlers(ctx);
 
@@ -752,6 +789,8 @@ bool aio_poll(AioContext *ctx, bool blocking)
 
     progress |= timerlistgroup_run_timers(&ctx->tlg);
 
+    stat64_add(&ctx->cpu_total_ns, thread_cputime_ns() - cpu_start);
+
     return progress;
 }
 
@@ -808,6 +847,29 @@ void aio_context_set_poll_params(AioContext *ctx, int64_t max_ns,
     aio_notify(ctx);
 }
 
+int64_t aio_context_get_poll_ns(AioContext *ctx)
+{
+    AioHandler *node;
+    int64_t poll_ns = 0;
+
+    qemu_lockcnt_inc(&ctx->list_lock);
+    QLIST_FOREACH_RCU(node, &ctx->aio_handlers, node) {
+        /*
+         * Unsynchronized read; the value only feeds monitoring and a torn
+         * or stale read is harmless.
+         */
+        poll_ns = MAX(poll_ns, node->poll.ns);
+    }
+    qemu_lockcnt_dec(&ctx->list_lock);
+
+    return poll_ns;
+}
+
+int64_t aio_context_get_cpu_ns(AioContext *ctx)
+{
+    return stat64_get(&ctx->cpu_total_ns);
+}
+
 void aio_context_set_aio_params(AioContext *ctx, int64_t max_batch)
 {
     /*
@@ -17,6 +17,7 @@
 
 #include "qemu/osdep.h"
 #include "block/block.h"
+#include "qemu/defer-call.h"
 #include "qemu/main-loop.h"
 #include "qemu/lockcnt.h"
 #include "qemu/queue.h"
@@ -314,8 +315,11 @@ static bool aio_dispatch_handlers(AioContext *ctx, HANDLE event)
 void aio_dispatch(AioContext *ctx)
 {
     qemu_lockcnt_inc(&ctx->list_lock);
+    /* Batch up I/O submissions from all handlers run in this iteration */
+    defer_call_begin();
     aio_bh_poll(ctx);
     aio_dispatch_handlers(ctx, INVALID_HANDLE_VALUE);
+    defer_call_end();
     qemu_lockcnt_dec(&ctx->list_lock);
     timerlistgroup_run_timers(&ctx->tlg);
 }
@@ -375,6 +379,18 @@ bool aio_poll(AioContext *ctx, bool blocking)
     /* ctx->notifier is always registered.  */
     assert(count > 0);
 
+    if (blocking) {
+        /*
+         * We may be a nested event loop inside an enclosing defer_call
+         * section; deferred submissions must reach the kernel before we
+         * wait for their completions.
+         */
+        defer_call_flush();
+    }
+
+    /* Batch up I/O submissions from all handlers run in this iteration */
+    defer_call_begin();
+
     /* Multiple iterations, all of them non-blocking except the first,
      * may be necessary to process all pending events.  After the first
      * WaitForMultipleObjects call ctx->notify_me will be decremented.
@@ -385,6 +401,10 @@ bool aio_poll(AioContext *ctx, bool blocking)
 
         timeout = blocking && !have_select_revents
             ? qemu_timeout_ns_to_ms(aio_compute_timeout(ctx)) : 0;
+        /* Don't block if aio_notify() was called */
+        if (qatomic_read(&ctx->notified)) {
+            timeout = 0;
+        }
         ret = WaitForMultipleObjects(count, events, FALSE, timeout);
         if (blocking) {
             assert(first);
@@ -413,6 +433,8 @@ bool aio_poll(AioContext *ctx, bool blocking)
         progress |= aio_dispatch_handlers(ctx, event);
     } while (count > 0);
 
+    defer_call_end();
+
     qemu_lockcnt_dec(&ctx->list_lock);
 
     progress |= timerlistgroup_run_timers(&ctx->tlg);
@@ -439,6 +461,16 @@ void aio_context_set_poll_params(AioContext *ctx, int64_t max_ns,
     }
 }
 
+int64_t aio_context_get_poll_ns(AioContext *ctx)
+{
+    return 0;
+}
+
+int64_t aio_context_get_cpu_ns(AioContext *ctx)
+{
+    return 0;
+}
+
 void aio_context_set_aio_params(AioContext *ctx, int64_t max_batch)
 {
 }
@@ -316,6 +316,16 @@ aio_ctx_prepare(GSource *source, gint    *timeout)
     /* We assume there is no timeout already supplied */
     *timeout = qemu_timeout_ns_to_ms(aio_compute_timeout(ctx));
 
+    /*
+     * Don't block if aio_notify() was called: the notification may have
+     * coalesced with an earlier one that has already been accepted, in
+     * which case nobody wrote the event notifier.  Mirrors the
+     * ctx->notified check on the aio_poll() path.
+     */
+    if (qatomic_read(&ctx->notified)) {
+        *timeout = 0;
+    }
+
     if (aio_prepare(ctx)) {
         *timeout = 0;
     }
@@ -489,16 +499,23 @@ void aio_notify(AioContext *ctx)
 {
     /*
      * Write e.g. ctx->bh_list before writing ctx->notified.  Pairs with
-     * smp_mb() in aio_notify_accept().
+     * smp_mb() in aio_notify_accept().  The sequentially consistent
+     * atomic also orders the write of ctx->notified before the read of
+     * ctx->notify_me below; that pairs with smp_mb() in aio_ctx_prepare
+     * or aio_poll.
      */
     smp_wmb();
-    qatomic_set(&ctx->notified, true);
+    if (qatomic_xchg(&ctx->notified, true)) {
+        /*
+         * Already notified and not yet accepted, so a wakeup is
+         * guaranteed without a second write: both aio_poll() and
+         * aio_ctx_prepare() recheck ctx->notified after publishing
+         * notify_me and refuse to block while it is set.
+         * Notifications between two aio_notify_accept() calls coalesce.
+         */
+        return;
+    }
 
-    /*
-     * Write ctx->notified (and also ctx->bh_list) before reading ctx->notify_me.
-     * Pairs with smp_mb() in aio_ctx_prepare or aio_poll.
-     */
-    smp_mb();
     if (qatomic_read(&ctx->notify_me)) {
         event_notifier_set(&ctx->notifier);
     }
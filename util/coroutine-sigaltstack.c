@@ -287,6 +287,10 @@ CoroutineAction qemu_coroutine_switch(Coroutine *from_, Coroutine *to_,
     return ret;
 }
 
+void qemu_coroutine_stack_release_hint(Coroutine *co)
+{
+}
+
 Coroutine *qemu_coroutine_self(void)
 {
     CoroutineThreadState *s = coroutine_get_thread_state();
@@ -278,6 +278,30 @@ static void coroutine_fn terminate_asan(void *opaque)
 }
 #endif
 
+void qemu_coroutine_stack_release_hint(Coroutine *co_)
+{
+#ifdef MADV_FREE
+    CoroutineUContext *co = DO_UPCAST(CoroutineUContext, base, co_);
+    size_t pagesz = qemu_real_host_page_size();
+    /*
+     * The lowest page of the stack is the guard page.  The topmost
+     * pages hold the frames of coroutine_trampoline() and
+     * qemu_coroutine_switch(), which are live while the coroutine sits
+     * in the pool and are needed to re-enter it; leave a generous
+     * margin for them.  Everything in between may be reclaimed lazily
+     * by the host: under memory pressure the kernel takes the pages
+     * back and refaults them as zero pages on next use, otherwise
+     * reuse from the pool costs nothing.
+     */
+    size_t keep = 4 * pagesz;
+
+    if (co->stack_size > keep + pagesz) {
+        madvise(co->stack + pagesz, co->stack_size - keep - pagesz,
+                MADV_FREE);
+    }
+#endif
+}
+
 void qemu_coroutine_delete(Coroutine *co_)
 {
     CoroutineUContext *co = DO_UPCAST(CoroutineUContext, base, co_);
@@ -101,6 +101,10 @@ Coroutine *qemu_coroutine_self(void)
     return current;
 }
 
+void qemu_coroutine_stack_release_hint(Coroutine *co)
+{
+}
+
 bool qemu_in_coroutine(void)
 {
     Coroutine *current = get_current();
@@ -0,0 +1,23 @@
+/*
+ * Always-on counters for hot paths
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or
+ * later.  See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/counter.h"
+
+static QemuCounter *counters;
+
+void qemu_counter_register(QemuCounter *counter)
+{
+    /* Called from constructors only, before any thread is created.  */
+    counter->next = counters;
+    counters = counter;
+}
+
+QemuCounter *qemu_counter_next(QemuCounter *counter)
+{
+    return counter ? counter->next : counters;
+}
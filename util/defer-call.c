@@ -122,21 +122,17 @@ void defer_call_begin(void)
 }
 
 /**
- * defer_call_end: Run any pending defer_call() functions
+ * defer_call_flush: Run any pending defer_call() functions immediately
  *
- * There must have been a matching defer_call_begin() call in the same thread
- * prior to this defer_call_end() call.
+ * Calls deferred so far are invoked now instead of waiting for the outermost
+ * defer_call_end(). The event loop uses this before blocking so that work
+ * deferred by an enclosing section (e.g. when a handler runs a nested event
+ * loop) cannot be delayed past the point where its completion is awaited.
  */
-void defer_call_end(void)
+void defer_call_flush(void)
 {
     DeferCallThreadState *thread_state = get_ptr_defer_call_thread_state();
 
-    assert(thread_state->nesting_level > 0);
-
-    if (--thread_state->nesting_level > 0) {
-        return;
-    }
-
     GArray *array = thread_state->deferred_call_array;
     if (!array) {
         return;
@@ -154,3 +150,22 @@ void defer_call_end(void)
      */
     g_array_set_size(array, 0);
 }
+
+/**
+ * defer_call_end: Run any pending defer_call() functions
+ *
+ * There must have been a matching defer_call_begin() call in the same thread
+ * prior to this defer_call_end() call.
+ */
+void defer_call_end(void)
+{
+    DeferCallThreadState *thread_state = get_ptr_defer_call_thread_state();
+
+    assert(thread_state->nesting_level > 0);
+
+    if (--thread_state->nesting_level > 0) {
+        return;
+    }
+
+    defer_call_flush();
+}
@@ -25,7 +25,12 @@
  *
  * File descriptor monitoring is implemented using the following operations:
  *
- * 1. IORING_OP_POLL_ADD - adds a file descriptor to be monitored.
+ * 1. IORING_OP_POLL_ADD - adds a file descriptor to be monitored.  When the
+ *    kernel supports it the request is submitted with IORING_POLL_ADD_MULTI,
+ *    so a single sqe keeps generating cqes until it is cancelled and the
+ *    common ready path does not need to re-arm the poll request.  Kernels
+ *    that reject the flag fail the request with -EINVAL, at which point we
+ *    fall back to one-shot poll requests for the AioContext.
  * 2. IORING_OP_POLL_REMOVE - removes a file descriptor being monitored.  When
  *    the poll mask changes for a file descriptor it is first removed and then
  *    re-added with the new poll mask, so this operation is also used as part
@@ -172,6 +177,11 @@ static void add_poll_add_sqe(AioContext *ctx, AioHandler *node)
     int events = poll_events_from_pfd(node->pfd.events);
 
     io_uring_prep_poll_add(sqe, node->pfd.fd, events);
+#ifdef IORING_POLL_ADD_MULTI
+    if (ctx->fdmon_io_uring_multishot) {
+        sqe->len |= IORING_POLL_ADD_MULTI;
+    }
+#endif
     io_uring_sqe_set_data(sqe, node);
 }
 
@@ -234,6 +244,30 @@ static bool process_cqe(AioContext *ctx,
         return false;
     }
 
+#ifdef IORING_POLL_ADD_MULTI
+    if (unlikely(cqe->res == -EINVAL && ctx->fdmon_io_uring_multishot)) {
+        /* The kernel predates IORING_POLL_ADD_MULTI; re-arm one-shot */
+        ctx->fdmon_io_uring_multishot = false;
+        add_poll_add_sqe(ctx, node);
+        return false;
+    }
+
+    if (cqe->flags & IORING_CQE_F_MORE) {
+        /*
+         * The multishot poll request is still armed.  If removal has been
+         * requested, ignore the event: the handler may only be freed once
+         * the terminal cqe (with F_MORE clear) generated by
+         * IORING_OP_POLL_REMOVE has been seen.
+         */
+        if (qatomic_read(&node->flags) & FDMON_IO_URING_REMOVE) {
+            return false;
+        }
+        aio_add_ready_handler(ready_list, node,
+                              pfd_events_from_poll(cqe->res));
+        return true;
+    }
+#endif
+
     /*
      * Deletion can only happen when IORING_OP_POLL_ADD completes.  If we race
      * with enqueue() here then we can safely clear the FDMON_IO_URING_REMOVE
@@ -247,7 +281,7 @@ static bool process_cqe(AioContext *ctx,
 
     aio_add_ready_handler(ready_list, node, pfd_events_from_poll(cqe->res));
 
-    /* IORING_OP_POLL_ADD is one-shot so we must re-arm it */
+    /* This cqe terminates the poll request, so we must re-arm it */
     add_poll_add_sqe(ctx, node);
     return true;
 }
@@ -331,6 +365,9 @@ bool fdmon_io_uring_setup(AioContext *ctx)
     }
 
     QSLIST_INIT(&ctx->submit_list);
+#ifdef IORING_POLL_ADD_MULTI
+    ctx->fdmon_io_uring_multishot = true;
+#endif
     ctx->fdmon_ops = &fdmon_io_uring_ops;
     return true;
 }
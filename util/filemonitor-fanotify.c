@@ -0,0 +1,680 @@
+/*
+ * QEMU file monitor Linux fanotify impl
+ *
+ * Copyright (c) 2018 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/filemonitor.h"
+#include "qemu/main-loop.h"
+#include "qemu/error-report.h"
+#include "qapi/error.h"
+#include "trace.h"
+
+#include <sys/fanotify.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+
+/*
+ * Unlike inotify, which needs one kernel watch per directory,
+ * fanotify can watch an entire mounted filesystem with a single
+ * FAN_MARK_FILESYSTEM mark. FAN_REPORT_DFID_NAME makes every event
+ * carry the file handle of the containing directory plus the entry
+ * name, which we use to filter the filesystem-wide event stream
+ * down to the directories callers registered.
+ *
+ * Filesystem marks require CAP_SYS_ADMIN, so an unprivileged
+ * monitor transparently falls back to per-directory inotify
+ * watches at creation time.
+ */
+
+#define QEMU_FILE_MONITOR_FAN_EVENTS                        \
+    (FAN_CREATE | FAN_DELETE | FAN_MODIFY | FAN_ATTRIB |    \
+     FAN_MOVED_TO | FAN_MOVED_FROM | FAN_ONDIR)
+
+struct QFileMonitor {
+    int fd;
+    bool inotify; /* fell back to per-directory inotify watches */
+    QemuMutex lock; /* protects dirs, idmap, handles & filesystems */
+    GHashTable *dirs; /* dirname => QFileMonitorDir */
+    GHashTable *idmap; /* inotify ID => QFileMonitorDir (inotify only) */
+    GHashTable *handles; /* dir file handle => QFileMonitorDir (fanotify) */
+    GHashTable *filesystems; /* fsid => QFileMonitorFS (fanotify only) */
+    int next_dir_id; /* dir ID counter (fanotify only) */
+};
+
+
+typedef struct {
+    int64_t id; /* watch ID */
+    char *filename; /* optional filter */
+    QFileMonitorHandler cb;
+    void *opaque;
+} QFileMonitorWatch;
+
+
+typedef struct {
+    char *path;
+    int id; /* inotify wd, or monitor-local ID with fanotify */
+    int next_file_id; /* file ID counter */
+    GBytes *handle; /* dir file handle, key in handles (fanotify) */
+    uint64_t fsid; /* key in filesystems (fanotify) */
+    GArray *watches; /* QFileMonitorWatch elements */
+} QFileMonitorDir;
+
+
+typedef struct {
+    uint64_t fsid;
+    char *path; /* any marked directory, for FAN_MARK_REMOVE */
+    size_t refs; /* number of watched dirs on this filesystem */
+} QFileMonitorFS;
+
+
+static void
+qemu_file_monitor_dispatch(QFileMonitor *mon,
+                           QFileMonitorDir *dir,
+                           const char *name,
+                           int qev)
+{
+    gsize i;
+
+    for (i = 0; i < dir->watches->len; i++) {
+        QFileMonitorWatch *watch = &g_array_index(dir->watches,
+                                                  QFileMonitorWatch,
+                                                  i);
+
+        if (watch->filename == NULL ||
+            (name && g_str_equal(watch->filename, name))) {
+            trace_qemu_file_monitor_dispatch(mon, dir->path, name,
+                                             qev, watch->cb,
+                                             watch->opaque, watch->id);
+            watch->cb(watch->id, qev, name, watch->opaque);
+        }
+    }
+}
+
+
+static void
+qemu_file_monitor_watch_fanotify(QFileMonitor *mon)
+{
+    char buf[16384]
+        __attribute__ ((aligned(__alignof__(struct fanotify_event_metadata))));
+    QFileMonitorDir *prev_dir = NULL;
+    g_autofree char *prev_name = NULL;
+    int prev_qev = -1;
+    struct fanotify_event_metadata *ev;
+    int len;
+
+    len = read(mon->fd, buf, sizeof(buf));
+
+    if (len < 0) {
+        if (errno != EAGAIN) {
+            error_report("Failure monitoring fanotify FD '%s',"
+                         "disabling events", strerror(errno));
+        }
+
+        /* no more events right now */
+        return;
+    }
+
+    ev = (struct fanotify_event_metadata *)buf;
+    for (; FAN_EVENT_OK(ev, len); ev = FAN_EVENT_NEXT(ev, len)) {
+        struct fanotify_event_info_fid *fid = NULL;
+        struct fanotify_event_info_header *info;
+        struct file_handle *fh;
+        QFileMonitorDir *dir;
+        g_autoptr(GBytes) key = NULL;
+        const char *name;
+        size_t used;
+        uint64_t iev;
+
+        if (ev->vers != FANOTIFY_METADATA_VERSION) {
+            error_report("Unexpected fanotify metadata version %d,"
+                         "disabling events", ev->vers);
+            return;
+        }
+
+        if (ev->mask & FAN_Q_OVERFLOW) {
+            /*
+             * Events were dropped by the kernel; there is nothing
+             * useful we can report to the callers for them.
+             */
+            continue;
+        }
+
+        /*
+         * Find the FAN_EVENT_INFO_TYPE_DFID_NAME record identifying
+         * the containing directory and entry name.
+         */
+        used = ev->metadata_len;
+        while (used < ev->event_len) {
+            info = (struct fanotify_event_info_header *)((char *)ev + used);
+            if (info->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME) {
+                fid = (struct fanotify_event_info_fid *)info;
+                break;
+            }
+            used += info->len;
+        }
+        if (!fid) {
+            continue;
+        }
+
+        fh = (struct file_handle *)fid->handle;
+        name = (char *)fh->f_handle + fh->handle_bytes;
+        if (g_str_equal(name, ".")) {
+            /* Event on the watched directory itself */
+            name = "";
+        }
+
+        key = g_bytes_new(fh, sizeof(*fh) + fh->handle_bytes);
+        dir = g_hash_table_lookup(mon->handles, key);
+        if (!dir) {
+            /* Filesystem-wide mark; event is outside any watched dir */
+            continue;
+        }
+
+        trace_qemu_file_monitor_event(mon, dir->path, name,
+                                      (int)ev->mask, dir->id);
+
+        /*
+         * Unlike inotify, an event record carries a mask that may
+         * combine several merged events, so check each bit. Rename
+         * operations are reported as FAN_MOVED_FROM on the old name
+         * and FAN_MOVED_TO on the new name; turn these into DELETED
+         * and CREATED events as the inotify impl does.
+         */
+        for (iev = ev->mask & QEMU_FILE_MONITOR_FAN_EVENTS & ~FAN_ONDIR;
+             iev != 0; iev &= iev - 1) {
+            int qev;
+
+            switch (iev & -iev) {
+            case FAN_CREATE:
+            case FAN_MOVED_TO:
+                qev = QFILE_MONITOR_EVENT_CREATED;
+                break;
+            case FAN_MODIFY:
+                qev = QFILE_MONITOR_EVENT_MODIFIED;
+                break;
+            case FAN_DELETE:
+            case FAN_MOVED_FROM:
+                qev = QFILE_MONITOR_EVENT_DELETED;
+                break;
+            case FAN_ATTRIB:
+                qev = QFILE_MONITOR_EVENT_ATTRIBUTES;
+                break;
+            default:
+                g_assert_not_reached();
+            }
+
+            /*
+             * The kernel merges identical back-to-back events on an
+             * object, but a busy filesystem still yields runs of the
+             * same event interleaved per record; coalesce repeats of
+             * the previous dispatch within this batch.
+             */
+            if (dir == prev_dir && qev == prev_qev &&
+                g_str_equal(name, prev_name)) {
+                continue;
+            }
+            prev_dir = dir;
+            prev_qev = qev;
+            g_free(prev_name);
+            prev_name = g_strdup(name);
+
+            qemu_file_monitor_dispatch(mon, dir, name, qev);
+        }
+    }
+}
+
+
+static void
+qemu_file_monitor_watch_inotify(QFileMonitor *mon)
+{
+    char buf[4096]
+        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    int used = 0;
+    int len;
+
+    len = read(mon->fd, buf, sizeof(buf));
+
+    if (len < 0) {
+        if (errno != EAGAIN) {
+            error_report("Failure monitoring inotify FD '%s',"
+                         "disabling events", strerror(errno));
+        }
+
+        /* no more events right now */
+        return;
+    }
+
+    /* Loop over all events in the buffer */
+    while (used < len) {
+        const char *name;
+        QFileMonitorDir *dir;
+        uint32_t iev;
+        int qev;
+        struct inotify_event *ev = (struct inotify_event *)(buf + used);
+
+        /*
+         * We trust the kernel to provide valid buffer with complete event
+         * records.
+         */
+        assert(len - used >= sizeof(struct inotify_event));
+        assert(len - used - sizeof(struct inotify_event) >= ev->len);
+
+        name = ev->len ? ev->name : "";
+        dir = g_hash_table_lookup(mon->idmap, GINT_TO_POINTER(ev->wd));
+        iev = ev->mask &
+            (IN_CREATE | IN_MODIFY | IN_DELETE | IN_IGNORED |
+             IN_MOVED_TO | IN_MOVED_FROM | IN_ATTRIB);
+
+        used += sizeof(struct inotify_event) + ev->len;
+
+        if (!dir) {
+            continue;
+        }
+
+        /*
+         * During a rename operation, the old name gets
+         * IN_MOVED_FROM and the new name gets IN_MOVED_TO.
+         * To simplify life for callers, we turn these into
+         * DELETED and CREATED events
+         */
+        switch (iev) {
+        case IN_CREATE:
+        case IN_MOVED_TO:
+            qev = QFILE_MONITOR_EVENT_CREATED;
+            break;
+        case IN_MODIFY:
+            qev = QFILE_MONITOR_EVENT_MODIFIED;
+            break;
+        case IN_DELETE:
+        case IN_MOVED_FROM:
+            qev = QFILE_MONITOR_EVENT_DELETED;
+            break;
+        case IN_ATTRIB:
+            qev = QFILE_MONITOR_EVENT_ATTRIBUTES;
+            break;
+        case IN_IGNORED:
+            qev = QFILE_MONITOR_EVENT_IGNORED;
+            break;
+        default:
+            g_assert_not_reached();
+        }
+
+        trace_qemu_file_monitor_event(mon, dir->path, name, ev->mask,
+                                      dir->id);
+        qemu_file_monitor_dispatch(mon, dir, name, qev);
+    }
+}
+
+
+static void qemu_file_monitor_watch(void *arg)
+{
+    QFileMonitor *mon = arg;
+
+    qemu_mutex_lock(&mon->lock);
+
+    if (mon->fd == -1) {
+        qemu_mutex_unlock(&mon->lock);
+        return;
+    }
+
+    if (mon->inotify) {
+        qemu_file_monitor_watch_inotify(mon);
+    } else {
+        qemu_file_monitor_watch_fanotify(mon);
+    }
+
+    qemu_mutex_unlock(&mon->lock);
+}
+
+
+static void
+qemu_file_monitor_dir_free(void *data)
+{
+    QFileMonitorDir *dir = data;
+    gsize i;
+
+    for (i = 0; i < dir->watches->len; i++) {
+        QFileMonitorWatch *watch = &g_array_index(dir->watches,
+                                                  QFileMonitorWatch, i);
+        g_free(watch->filename);
+    }
+    g_array_unref(dir->watches);
+    if (dir->handle) {
+        g_bytes_unref(dir->handle);
+    }
+    g_free(dir->path);
+    g_free(dir);
+}
+
+
+static void
+qemu_file_monitor_fs_free(void *data)
+{
+    QFileMonitorFS *fs = data;
+
+    g_free(fs->path);
+    g_free(fs);
+}
+
+
+QFileMonitor *
+qemu_file_monitor_new(Error **errp)
+{
+    bool inotify = false;
+    int fd;
+    QFileMonitor *mon;
+
+    fd = fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_NONBLOCK,
+                       O_RDONLY);
+    if (fd < 0) {
+        /*
+         * fanotify_init requires CAP_SYS_ADMIN and FAN_REPORT_DFID_NAME
+         * needs a 5.9+ kernel; fall back to per-directory inotify
+         * watches rather than failing outright.
+         */
+        fd = inotify_init1(IN_NONBLOCK);
+        if (fd < 0) {
+            error_setg_errno(errp, errno,
+                             "Unable to initialize inotify");
+            return NULL;
+        }
+        inotify = true;
+    }
+
+    mon = g_new0(QFileMonitor, 1);
+    qemu_mutex_init(&mon->lock);
+    mon->fd = fd;
+    mon->inotify = inotify;
+
+    mon->dirs = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                      qemu_file_monitor_dir_free);
+    if (inotify) {
+        mon->idmap = g_hash_table_new(g_direct_hash, g_direct_equal);
+    } else {
+        mon->handles = g_hash_table_new(g_bytes_hash, g_bytes_equal);
+        mon->filesystems = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                                 NULL,
+                                                 qemu_file_monitor_fs_free);
+    }
+
+    trace_qemu_file_monitor_new(mon, mon->fd);
+
+    return mon;
+}
+
+static gboolean
+qemu_file_monitor_free_idle(void *opaque)
+{
+    QFileMonitor *mon = opaque;
+
+    if (!mon) {
+        return G_SOURCE_REMOVE;
+    }
+
+    qemu_mutex_lock(&mon->lock);
+
+    if (mon->idmap) {
+        g_hash_table_unref(mon->idmap);
+    }
+    if (mon->handles) {
+        g_hash_table_unref(mon->handles);
+    }
+    if (mon->filesystems) {
+        g_hash_table_unref(mon->filesystems);
+    }
+    g_hash_table_unref(mon->dirs);
+
+    qemu_mutex_unlock(&mon->lock);
+
+    qemu_mutex_destroy(&mon->lock);
+    g_free(mon);
+
+    return G_SOURCE_REMOVE;
+}
+
+void
+qemu_file_monitor_free(QFileMonitor *mon)
+{
+    if (!mon) {
+        return;
+    }
+
+    qemu_mutex_lock(&mon->lock);
+    if (mon->fd != -1) {
+        qemu_set_fd_handler(mon->fd, NULL, NULL, NULL);
+        close(mon->fd);
+        mon->fd = -1;
+    }
+    qemu_mutex_unlock(&mon->lock);
+
+    /*
+     * Can't free it yet, because another thread
+     * may be running event loop, so the notify
+     * callback might be pending. Using an idle
+     * source ensures we'll only free after the
+     * pending callback is done
+     */
+    g_idle_add((GSourceFunc)qemu_file_monitor_free_idle, mon);
+}
+
+
+static QFileMonitorDir *
+qemu_file_monitor_dir_new_fanotify(QFileMonitor *mon,
+                                   const char *dirpath,
+                                   Error **errp)
+{
+    char fhbuf[sizeof(struct file_handle) + MAX_HANDLE_SZ];
+    struct file_handle *fh = (struct file_handle *)fhbuf;
+    struct statfs sfs;
+    QFileMonitorFS *fs;
+    QFileMonitorDir *dir;
+    uint64_t fsid;
+    int mount_id;
+
+    fh->handle_bytes = MAX_HANDLE_SZ;
+    if (name_to_handle_at(AT_FDCWD, dirpath, fh, &mount_id, 0) < 0) {
+        error_setg_errno(errp, errno,
+                         "Unable to get file handle for '%s'", dirpath);
+        return NULL;
+    }
+
+    if (statfs(dirpath, &sfs) < 0) {
+        error_setg_errno(errp, errno, "Unable to statfs '%s'", dirpath);
+        return NULL;
+    }
+    memcpy(&fsid, &sfs.f_fsid, sizeof(fsid));
+
+    fs = g_hash_table_lookup(mon->filesystems, &fsid);
+    if (!fs) {
+        if (fanotify_mark(mon->fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                          QEMU_FILE_MONITOR_FAN_EVENTS,
+                          AT_FDCWD, dirpath) < 0) {
+            error_setg_errno(errp, errno, "Unable to watch '%s'", dirpath);
+            return NULL;
+        }
+
+        fs = g_new0(QFileMonitorFS, 1);
+        fs->fsid = fsid;
+        fs->path = g_strdup(dirpath);
+        g_hash_table_insert(mon->filesystems, &fs->fsid, fs);
+    }
+    fs->refs++;
+
+    dir = g_new0(QFileMonitorDir, 1);
+    dir->path = g_strdup(dirpath);
+    dir->id = mon->next_dir_id++;
+    dir->fsid = fsid;
+    dir->handle = g_bytes_new(fh, sizeof(*fh) + fh->handle_bytes);
+    dir->watches = g_array_new(FALSE, TRUE, sizeof(QFileMonitorWatch));
+
+    g_hash_table_insert(mon->handles, dir->handle, dir);
+
+    return dir;
+}
+
+
+static QFileMonitorDir *
+qemu_file_monitor_dir_new_inotify(QFileMonitor *mon,
+                                  const char *dirpath,
+                                  Error **errp)
+{
+    QFileMonitorDir *dir;
+    int rv = inotify_add_watch(mon->fd, dirpath,
+                               IN_CREATE | IN_DELETE | IN_MODIFY |
+                               IN_MOVED_TO | IN_MOVED_FROM | IN_ATTRIB);
+
+    if (rv < 0) {
+        error_setg_errno(errp, errno, "Unable to watch '%s'", dirpath);
+        return NULL;
+    }
+
+    dir = g_new0(QFileMonitorDir, 1);
+    dir->path = g_strdup(dirpath);
+    dir->id = rv;
+    dir->watches = g_array_new(FALSE, TRUE, sizeof(QFileMonitorWatch));
+
+    g_hash_table_insert(mon->idmap, GINT_TO_POINTER(rv), dir);
+
+    return dir;
+}
+
+
+int64_t
+qemu_file_monitor_add_watch(QFileMonitor *mon,
+                            const char *dirpath,
+                            const char *filename,
+                            QFileMonitorHandler cb,
+                            void *opaque,
+                            Error **errp)
+{
+    QFileMonitorDir *dir;
+    QFileMonitorWatch watch;
+    int64_t ret = -1;
+
+    qemu_mutex_lock(&mon->lock);
+    dir = g_hash_table_lookup(mon->dirs, dirpath);
+    if (!dir) {
+        if (mon->inotify) {
+            dir = qemu_file_monitor_dir_new_inotify(mon, dirpath, errp);
+        } else {
+            dir = qemu_file_monitor_dir_new_fanotify(mon, dirpath, errp);
+        }
+        if (!dir) {
+            goto cleanup;
+        }
+
+        trace_qemu_file_monitor_enable_watch(mon, dirpath, dir->id);
+
+        g_hash_table_insert(mon->dirs, dir->path, dir);
+
+        if (g_hash_table_size(mon->dirs) == 1) {
+            qemu_set_fd_handler(mon->fd, qemu_file_monitor_watch, NULL, mon);
+        }
+    }
+
+    watch.id = (((int64_t)dir->id) << 32) | dir->next_file_id++;
+    watch.filename = g_strdup(filename);
+    watch.cb = cb;
+    watch.opaque = opaque;
+
+    g_array_append_val(dir->watches, watch);
+
+    trace_qemu_file_monitor_add_watch(mon, dirpath,
+                                      filename ? filename : "<none>",
+                                      cb, opaque, watch.id);
+
+    ret = watch.id;
+
+ cleanup:
+    qemu_mutex_unlock(&mon->lock);
+    return ret;
+}
+
+
+static void
+qemu_file_monitor_dir_remove_fanotify(QFileMonitor *mon,
+                                      QFileMonitorDir *dir)
+{
+    QFileMonitorFS *fs = g_hash_table_lookup(mon->filesystems, &dir->fsid);
+
+    g_hash_table_remove(mon->handles, dir->handle);
+
+    assert(fs && fs->refs > 0);
+    if (--fs->refs == 0) {
+        /*
+         * The path may have disappeared since the filesystem was
+         * marked; nothing useful to do about that beyond keeping
+         * the (now unreferenced) mark in place.
+         */
+        if (fanotify_mark(mon->fd, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM,
+                          QEMU_FILE_MONITOR_FAN_EVENTS,
+                          AT_FDCWD, fs->path) < 0) {
+            error_report("Unable to unwatch filesystem of '%s': %s",
+                         fs->path, strerror(errno));
+        }
+        g_hash_table_remove(mon->filesystems, &fs->fsid);
+    }
+}
+
+
+void qemu_file_monitor_remove_watch(QFileMonitor *mon,
+                                    const char *dirpath,
+                                    int64_t id)
+{
+    QFileMonitorDir *dir;
+    gsize i;
+
+    qemu_mutex_lock(&mon->lock);
+
+    trace_qemu_file_monitor_remove_watch(mon, dirpath, id);
+
+    dir = g_hash_table_lookup(mon->dirs, dirpath);
+    if (!dir) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < dir->watches->len; i++) {
+        QFileMonitorWatch *watch = &g_array_index(dir->watches,
+                                                  QFileMonitorWatch, i);
+        if (watch->id == id) {
+            g_free(watch->filename);
+            g_array_remove_index(dir->watches, i);
+            break;
+        }
+    }
+
+    if (dir->watches->len == 0) {
+        trace_qemu_file_monitor_disable_watch(mon, dir->path, dir->id);
+
+        if (mon->inotify) {
+            inotify_rm_watch(mon->fd, dir->id);
+            g_hash_table_remove(mon->idmap, GINT_TO_POINTER(dir->id));
+        } else {
+            qemu_file_monitor_dir_remove_fanotify(mon, dir);
+        }
+        g_hash_table_remove(mon->dirs, dir->path);
+
+        if (g_hash_table_size(mon->dirs) == 0) {
+            qemu_set_fd_handler(mon->fd, NULL, NULL, NULL);
+        }
+    }
+
+ cleanup:
+    qemu_mutex_unlock(&mon->lock);
+}
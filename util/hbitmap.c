@@ -198,6 +198,9 @@ int64_t hbitmap_next_dirty(const HBitmap *hb, int64_t start, int64_t count)
     HBitmapIter hbi;
     int64_t first_dirty_off;
     uint64_t end;
+    size_t pos;
+    unsigned bit;
+    unsigned long cur;
 
     assert(start >= 0 && count >= 0);
 
@@ -207,6 +210,23 @@ int64_t hbitmap_next_dirty(const HBitmap *hb, int64_t start, int64_t count)
 
     end = count > hb->orig_size - start ? hb->orig_size : start + count;
 
+    /*
+     * Fast path for dense bitmaps: if the last-level word containing @start
+     * has a bit set at or after it, there is no need to set up an iterator
+     * and descend through all the levels from the top.
+     */
+    pos = (start >> hb->granularity) >> BITS_PER_LEVEL;
+    bit = (start >> hb->granularity) & (BITS_PER_LONG - 1);
+    cur = hb->levels[HBITMAP_LEVELS - 1][pos] & ~((1UL << bit) - 1);
+    if (cur) {
+        first_dirty_off = (int64_t)((pos << BITS_PER_LEVEL) + ctzl(cur))
+                          << hb->granularity;
+        if (first_dirty_off >= end) {
+            return -1;
+        }
+        return MAX(start, first_dirty_off);
+    }
+
     hbitmap_iter_init(&hbi, hb, start);
     first_dirty_off = hbitmap_iter_next(&hbi);
 
@@ -245,9 +265,22 @@ int64_t hbitmap_next_zero(const HBitmap *hb, int64_t start, int64_t count)
     assert((start >> hb->granularity) < hb->size);
 
     if (cur == (unsigned long)-1) {
-        do {
+        /*
+         * The upper levels cannot help here: they only distinguish zero
+         * words from nonzero ones, not all-ones words.  Skip over the run
+         * several words at a time; this form of the loop lets the compiler
+         * vectorize it, which matters when a copy job scans a mostly-dirty
+         * bitmap.
+         */
+        pos++;
+        while (pos + 4 <= sz &&
+               (last_lev[pos] & last_lev[pos + 1] &
+                last_lev[pos + 2] & last_lev[pos + 3]) == (unsigned long)-1) {
+            pos += 4;
+        }
+        while (pos < sz && last_lev[pos] == (unsigned long)-1) {
             pos++;
-        } while (pos < sz && last_lev[pos] == (unsigned long)-1);
+        }
 
         if (pos >= sz) {
             return -1;
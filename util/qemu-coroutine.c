@@ -156,6 +156,18 @@ static void coroutine_pool_refill_local(void)
 /* Add a batch of coroutines to the global pool */
 static void coroutine_pool_put_global(CoroutinePoolBatch *batch)
 {
+    Coroutine *co;
+
+    /*
+     * These coroutines may stay cached for a long time.  Let the host
+     * reclaim their stack pages if it needs the memory.  This must
+     * happen before the batch is published: afterwards another thread
+     * could already be running on one of the stacks.
+     */
+    QSLIST_FOREACH(co, &batch->list, pool_next) {
+        qemu_coroutine_stack_release_hint(co);
+    }
+
     WITH_QEMU_LOCK_GUARD(&global_pool_lock) {
         unsigned int max = MIN(global_pool_max_size,
                                global_pool_hard_max_size);
@@ -26,6 +26,7 @@
 #include "qemu/main-loop.h"
 #include "qemu/timer.h"
 #include "qemu/lockable.h"
+#include "qemu/seqlock.h"
 #include "system/cpu-timers.h"
 #include "system/replay.h"
 #include "system/cpus.h"
@@ -66,11 +67,29 @@ static QEMUClock qemu_clocks[QEMU_CLOCK_MAX];
 struct QEMUTimerList {
     QEMUClock *clock;
     QemuMutex active_timers_lock;
-    QEMUTimer *active_timers;
+
+    /* Binary min-heap of pending timers, ordered by expire time with
+     * insertion order (heap_seq) breaking ties, so that timers that
+     * expire together fire in the order they were armed.  Written with
+     * active_timers_lock held; heap_used is also read outside the lock
+     * to test for an empty list.
+     */
+    QEMUTimer **heap;
+    size_t heap_used;
+    size_t heap_size;
+    uint64_t next_heap_seq;
+
     QLIST_ENTRY(QEMUTimerList) list;
     QEMUTimerListNotifyCB *notify_cb;
     void *notify_opaque;
 
+    /* Copy of the head timer's expire time, INT64_MAX when the list is
+     * empty.  Published under the seqlock (written with active_timers_lock
+     * held) so that readers can poll the deadline without taking the lock.
+     */
+    QemuSeqLock deadline_seqlock;
+    int64_t cached_deadline;
+
     /* lightweight method to mark the end of timerlist's running */
     QemuEvent timers_done_ev;
 };
@@ -93,6 +112,112 @@ static bool timer_expired_ns(QEMUTimer *timer_head, int64_t current_time)
     return timer_head && (timer_head->expire_time <= current_time);
 }
 
+/* Order pending timers by expire time, then by arming order.  */
+static inline bool timer_less(QEMUTimer *a, QEMUTimer *b)
+{
+    return a->expire_time < b->expire_time ||
+           (a->expire_time == b->expire_time && a->heap_seq < b->heap_seq);
+}
+
+/* The heap helpers below are called with active_timers_lock held.  */
+static inline void timerlist_heap_set(QEMUTimerList *timer_list,
+                                      size_t i, QEMUTimer *ts)
+{
+    timer_list->heap[i] = ts;
+    ts->heap_idx = i;
+}
+
+static void timerlist_heap_sift_up(QEMUTimerList *timer_list, size_t i)
+{
+    QEMUTimer *ts = timer_list->heap[i];
+
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+
+        if (!timer_less(ts, timer_list->heap[parent])) {
+            break;
+        }
+        timerlist_heap_set(timer_list, i, timer_list->heap[parent]);
+        i = parent;
+    }
+    timerlist_heap_set(timer_list, i, ts);
+}
+
+static void timerlist_heap_sift_down(QEMUTimerList *timer_list, size_t i)
+{
+    QEMUTimer *ts = timer_list->heap[i];
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+
+        if (child >= timer_list->heap_used) {
+            break;
+        }
+        if (child + 1 < timer_list->heap_used &&
+            timer_less(timer_list->heap[child + 1],
+                       timer_list->heap[child])) {
+            child++;
+        }
+        if (!timer_less(timer_list->heap[child], ts)) {
+            break;
+        }
+        timerlist_heap_set(timer_list, i, timer_list->heap[child]);
+        i = child;
+    }
+    timerlist_heap_set(timer_list, i, ts);
+}
+
+static void timerlist_heap_insert(QEMUTimerList *timer_list, QEMUTimer *ts)
+{
+    size_t i = timer_list->heap_used;
+
+    if (i == timer_list->heap_size) {
+        timer_list->heap_size = MAX(timer_list->heap_size * 2, 16);
+        timer_list->heap = g_renew(QEMUTimer *, timer_list->heap,
+                                   timer_list->heap_size);
+    }
+    timerlist_heap_set(timer_list, i, ts);
+    qatomic_set(&timer_list->heap_used, i + 1);
+    timerlist_heap_sift_up(timer_list, i);
+}
+
+static void timerlist_heap_remove(QEMUTimerList *timer_list, QEMUTimer *ts)
+{
+    size_t i = ts->heap_idx;
+    QEMUTimer *last = timer_list->heap[timer_list->heap_used - 1];
+
+    qatomic_set(&timer_list->heap_used, timer_list->heap_used - 1);
+    if (last != ts) {
+        timerlist_heap_set(timer_list, i, last);
+        timerlist_heap_sift_down(timer_list, i);
+        timerlist_heap_sift_up(timer_list, last->heap_idx);
+    }
+}
+
+/* Called with active_timers_lock held after any change to the heap head */
+static void timerlist_publish_deadline(QEMUTimerList *timer_list)
+{
+    int64_t deadline = timer_list->heap_used
+        ? timer_list->heap[0]->expire_time : INT64_MAX;
+
+    seqlock_write_begin(&timer_list->deadline_seqlock);
+    timer_list->cached_deadline = deadline;
+    seqlock_write_end(&timer_list->deadline_seqlock);
+}
+
+static int64_t timerlist_read_deadline(QEMUTimerList *timer_list)
+{
+    int64_t expire_time;
+    unsigned start;
+
+    do {
+        start = seqlock_read_begin(&timer_list->deadline_seqlock);
+        expire_time = timer_list->cached_deadline;
+    } while (seqlock_read_retry(&timer_list->deadline_seqlock, start));
+
+    return expire_time;
+}
+
 QEMUTimerList *timerlist_new(QEMUClockType type,
                              QEMUTimerListNotifyCB *cb,
                              void *opaque)
@@ -106,6 +231,8 @@ QEMUTimerList *timerlist_new(QEMUClockType type,
     timer_list->notify_cb = cb;
     timer_list->notify_opaque = opaque;
     qemu_mutex_init(&timer_list->active_timers_lock);
+    seqlock_init(&timer_list->deadline_seqlock);
+    timer_list->cached_deadline = INT64_MAX;
     QLIST_INSERT_HEAD(&clock->timerlists, timer_list, list);
     return timer_list;
 }
@@ -117,6 +244,7 @@ void timerlist_free(QEMUTimerList *timer_list)
         QLIST_REMOVE(timer_list, list);
     }
     qemu_mutex_destroy(&timer_list->active_timers_lock);
+    g_free(timer_list->heap);
     g_free(timer_list);
 }
 
@@ -171,7 +299,7 @@ void qemu_clock_enable(QEMUClockType type, bool enabled)
 
 bool timerlist_has_timers(QEMUTimerList *timer_list)
 {
-    return !!qatomic_read(&timer_list->active_timers);
+    return qatomic_read(&timer_list->heap_used) != 0;
 }
 
 bool qemu_clock_has_timers(QEMUClockType type)
@@ -182,17 +310,15 @@ bool qemu_clock_has_timers(QEMUClockType type)
 
 bool timerlist_expired(QEMUTimerList *timer_list)
 {
-    int64_t expire_time = 0;
+    int64_t expire_time;
 
-    if (!qatomic_read(&timer_list->active_timers)) {
+    if (!qatomic_read(&timer_list->heap_used)) {
         return false;
     }
 
-    WITH_QEMU_LOCK_GUARD(&timer_list->active_timers_lock) {
-        if (!timer_list->active_timers) {
-            return false;
-        }
-        expire_time = timer_list->active_timers->expire_time;
+    expire_time = timerlist_read_deadline(timer_list);
+    if (expire_time == INT64_MAX) {
+        return false;
     }
 
     return expire_time <= qemu_clock_get_ns(timer_list->clock->type);
@@ -214,7 +340,7 @@ int64_t timerlist_deadline_ns(QEMUTimerList *timer_list)
     int64_t delta;
     int64_t expire_time = 0;
 
-    if (!qatomic_read(&timer_list->active_timers)) {
+    if (!qatomic_read(&timer_list->heap_used)) {
         return -1;
     }
 
@@ -226,11 +352,9 @@ int64_t timerlist_deadline_ns(QEMUTimerList *timer_list)
      * value but ->notify_cb() is called when the deadline changes.  Therefore
      * the caller should notice the change and there is no race condition.
      */
-    WITH_QEMU_LOCK_GUARD(&timer_list->active_timers_lock) {
-        if (!timer_list->active_timers) {
-            return -1;
-        }
-        expire_time = timer_list->active_timers->expire_time;
+    expire_time = timerlist_read_deadline(timer_list);
+    if (expire_time == INT64_MAX) {
+        return -1;
     }
 
     delta = expire_time - qemu_clock_get_ns(timer_list->clock->type);
@@ -261,21 +385,24 @@ int64_t qemu_clock_deadline_ns_all(QEMUClockType type, int attr_mask)
     }
 
     QLIST_FOREACH(timer_list, &clock->timerlists, list) {
-        if (!qatomic_read(&timer_list->active_timers)) {
+        size_t i;
+
+        if (!qatomic_read(&timer_list->heap_used)) {
             continue;
         }
         qemu_mutex_lock(&timer_list->active_timers_lock);
-        ts = timer_list->active_timers;
-        /* Skip all external timers */
-        while (ts && (ts->attributes & ~attr_mask)) {
-            ts = ts->next;
+        /* Find the soonest deadline, skipping all external timers */
+        expire_time = INT64_MAX;
+        for (i = 0; i < timer_list->heap_used; i++) {
+            ts = timer_list->heap[i];
+            if (!(ts->attributes & ~attr_mask)) {
+                expire_time = MIN(expire_time, ts->expire_time);
+            }
         }
-        if (!ts) {
-            qemu_mutex_unlock(&timer_list->active_timers_lock);
+        qemu_mutex_unlock(&timer_list->active_timers_lock);
+        if (expire_time == INT64_MAX) {
             continue;
         }
-        expire_time = ts->expire_time;
-        qemu_mutex_unlock(&timer_list->active_timers_lock);
 
         delta = expire_time - qemu_clock_get_ns(type);
         if (delta <= 0) {
@@ -370,41 +497,20 @@ void timer_deinit(QEMUTimer *ts)
 
 static void timer_del_locked(QEMUTimerList *timer_list, QEMUTimer *ts)
 {
-    QEMUTimer **pt, *t;
-
-    ts->expire_time = -1;
-    pt = &timer_list->active_timers;
-    for(;;) {
-        t = *pt;
-        if (!t)
-            break;
-        if (t == ts) {
-            qatomic_set(pt, t->next);
-            break;
-        }
-        pt = &t->next;
+    if (ts->expire_time != -1) {
+        timerlist_heap_remove(timer_list, ts);
+        ts->expire_time = -1;
     }
 }
 
 static bool timer_mod_ns_locked(QEMUTimerList *timer_list,
                                 QEMUTimer *ts, int64_t expire_time)
 {
-    QEMUTimer **pt, *t;
-
-    /* add the timer in the sorted list */
-    pt = &timer_list->active_timers;
-    for (;;) {
-        t = *pt;
-        if (!timer_expired_ns(t, expire_time)) {
-            break;
-        }
-        pt = &t->next;
-    }
     ts->expire_time = MAX(expire_time, 0);
-    ts->next = *pt;
-    qatomic_set(pt, ts);
+    ts->heap_seq = timer_list->next_heap_seq++;
+    timerlist_heap_insert(timer_list, ts);
 
-    return pt == &timer_list->active_timers;
+    return timer_list->heap[0] == ts;
 }
 
 static void timerlist_rearm(QEMUTimerList *timer_list)
@@ -420,6 +526,7 @@ void timer_del(QEMUTimer *ts)
     if (timer_list) {
         qemu_mutex_lock(&timer_list->active_timers_lock);
         timer_del_locked(timer_list, ts);
+        timerlist_publish_deadline(timer_list);
         qemu_mutex_unlock(&timer_list->active_timers_lock);
     }
 }
@@ -434,6 +541,7 @@ void timer_mod_ns(QEMUTimer *ts, int64_t expire_time)
     qemu_mutex_lock(&timer_list->active_timers_lock);
     timer_del_locked(timer_list, ts);
     rearm = timer_mod_ns_locked(timer_list, ts, expire_time);
+    timerlist_publish_deadline(timer_list);
     qemu_mutex_unlock(&timer_list->active_timers_lock);
 
     if (rearm) {
@@ -455,6 +563,7 @@ void timer_mod_anticipate_ns(QEMUTimer *ts, int64_t expire_time)
                 timer_del_locked(timer_list, ts);
             }
             rearm = timer_mod_ns_locked(timer_list, ts, expire_time);
+            timerlist_publish_deadline(timer_list);
         } else {
             rearm = false;
         }
@@ -492,7 +601,7 @@ bool timerlist_run_timers(QEMUTimerList *timer_list)
     QEMUTimerCB *cb;
     void *opaque;
 
-    if (!qatomic_read(&timer_list->active_timers)) {
+    if (!qatomic_read(&timer_list->heap_used)) {
         return false;
     }
 
@@ -531,7 +640,8 @@ bool timerlist_run_timers(QEMUTimerList *timer_list)
      */
     current_time = qemu_clock_get_ns(timer_list->clock->type);
     qemu_mutex_lock(&timer_list->active_timers_lock);
-    while ((ts = timer_list->active_timers)) {
+    while (timer_list->heap_used) {
+        ts = timer_list->heap[0];
         if (!timer_expired_ns(ts, current_time)) {
             /* No expired timers left.  The checkpoint can be skipped
              * if no timers fired or they were all external.
@@ -550,10 +660,10 @@ bool timerlist_run_timers(QEMUTimerList *timer_list)
             goto out;
         }
 
-        /* remove timer from the list before calling the callback */
-        timer_list->active_timers = ts->next;
-        ts->next = NULL;
+        /* remove timer from the heap before calling the callback */
+        timerlist_heap_remove(timer_list, ts);
         ts->expire_time = -1;
+        timerlist_publish_deadline(timer_list);
         cb = ts->cb;
         opaque = ts->opaque;
 
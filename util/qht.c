@@ -899,19 +899,53 @@ void qht_iter_remove(struct qht *ht, qht_iter_bool_func_t func, void *userp)
 }
 
 struct qht_map_copy_data {
-    struct qht *ht;
     struct qht_map *new;
 };
 
+/*
+ * Insert an entry into a map that no other thread has seen yet.
+ *
+ * Unlike qht_insert__locked() we need no bucket lock, no seqlock write
+ * and no duplicate check: the source map cannot contain duplicates and
+ * the destination map is not yet published.  This keeps the window
+ * during which concurrent writers are blocked on the old map's bucket
+ * locks as short as possible; concurrent lookups are not blocked at
+ * all, since they read the old map under its per-bucket seqlocks.
+ */
+static void qht_insert__fresh(struct qht_map *map, struct qht_bucket *head,
+                              void *p, uint32_t hash)
+{
+    struct qht_bucket *b = head;
+    struct qht_bucket *prev;
+    int i;
+
+    do {
+        for (i = 0; i < QHT_BUCKET_ENTRIES; i++) {
+            if (b->pointers[i] == NULL) {
+                b->hashes[i] = hash;
+                b->pointers[i] = p;
+                return;
+            }
+        }
+        prev = b;
+        b = b->next;
+    } while (b);
+
+    b = qemu_memalign(QHT_BUCKET_ALIGN, sizeof(*b));
+    memset(b, 0, sizeof(*b));
+    map->n_added_buckets++;
+    prev->next = b;
+    b->hashes[0] = hash;
+    b->pointers[0] = p;
+}
+
 static void qht_map_copy(void *p, uint32_t hash, void *userp)
 {
     struct qht_map_copy_data *data = userp;
-    struct qht *ht = data->ht;
     struct qht_map *new = data->new;
     struct qht_bucket *b = qht_map_to_bucket(new, hash);
 
-    /* no need to acquire b->lock because no thread has seen this map yet */
-    qht_insert__locked(ht, new, b, p, hash, NULL);
+    qht_insert__fresh(new, b, p, hash);
 }
 
 /*
@@ -940,7 +974,6 @@ static void qht_do_resize_reset(struct qht *ht, struct qht_map *new, bool reset)
     }
 
     g_assert(new->n_buckets != old->n_buckets);
-    data.ht = ht;
     data.new = new;
     qht_map_iter__all_locked(old, &iter, &data);
     qht_map_debug__all_locked(new);
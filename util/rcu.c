@@ -176,6 +176,14 @@ void synchronize_rcu(void)
 
 #define RCU_CALL_MIN_SIZE        30
 
+/*
+ * Past this many pending callbacks, stop waiting for more to batch up
+ * and start the grace period immediately, so that memory freed during
+ * e.g. flatview churn on hotplug storms is reclaimed promptly instead
+ * of accumulating behind the pile-up heuristic below.
+ */
+#define RCU_CALL_HIGH_WATER      4096
+
 /* Multi-producer, single-consumer queue based on urcu/static/wfqueue.h
  * from liburcu.  Note that head is only used by the consumer.
  */
@@ -261,12 +269,15 @@ static void *call_rcu_thread(void *opaque)
     for (;;) {
         int tries = 0;
         int n = qatomic_read(&rcu_call_count);
+        int batch;
 
         /* Heuristically wait for a decent number of callbacks to pile up.
          * Fetch rcu_call_count now, we only must process elements that were
-         * added before synchronize_rcu() starts.
+         * added before synchronize_rcu() starts.  Skip the wait entirely
+         * when the backlog is already past the high-water mark.
          */
-        while (n == 0 || (n < RCU_CALL_MIN_SIZE && ++tries <= 5)) {
+        while (n < RCU_CALL_HIGH_WATER &&
+               (n == 0 || (n < RCU_CALL_MIN_SIZE && ++tries <= 5))) {
             g_usleep(10000);
             if (n == 0) {
                 qemu_event_reset(&rcu_call_ready_event);
@@ -281,6 +292,7 @@ static void *call_rcu_thread(void *opaque)
             n = qatomic_read(&rcu_call_count);
         }
 
+        batch = n;
         qatomic_sub(&rcu_call_count, n);
         synchronize_rcu();
         bql_lock();
@@ -301,6 +313,17 @@ static void *call_rcu_thread(void *opaque)
             node->func(node);
         }
         bql_unlock();
+
+#if defined(CONFIG_MALLOC_TRIM)
+        /*
+         * A storm-sized batch has likely released a lot of memory at
+         * once; give it back to the OS now rather than waiting for the
+         * queue to go idle, which may not happen while the storm lasts.
+         */
+        if (batch >= RCU_CALL_HIGH_WATER) {
+            malloc_trim(4 * 1024 * 1024);
+        }
+#endif
     }
     abort();
 }
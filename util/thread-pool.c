@@ -244,6 +244,7 @@ BlockAIOCB *thread_pool_submit_aio(ThreadPoolFunc *func, void *arg,
     ThreadPoolElementAio *req;
     AioContext *ctx = qemu_get_current_aio_context();
     ThreadPoolAio *pool = aio_get_thread_pool(ctx);
+    bool notify;
 
     /* Assert that the thread submitting work is the same running the pool */
     assert(pool->ctx == qemu_get_current_aio_context());
@@ -263,8 +264,17 @@ BlockAIOCB *thread_pool_submit_aio(ThreadPoolFunc *func, void *arg,
         spawn_thread(pool);
     }
     QTAILQ_INSERT_TAIL(&pool->request_list, req, reqs);
+    /*
+     * Workers only wait on request_cond after bumping idle_threads under
+     * the lock, and recheck request_list before waiting, so the signal
+     * can be elided when every worker is busy: whoever picks up work
+     * next will see the new request on its own.
+     */
+    notify = pool->idle_threads > 0;
     qemu_mutex_unlock(&pool->lock);
-    qemu_cond_signal(&pool->request_cond);
+    if (notify) {
+        qemu_cond_signal(&pool->request_cond);
+    }
     return &req->common;
 }
 
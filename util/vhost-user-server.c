@@ -272,6 +272,50 @@ static void kick_handler(void *opaque)
     }
 }
 
+/*
+ * AioContext poll handler for kick fds: instead of waiting for the
+ * eventfd, look at the avail ring directly.  This lets the adaptive
+ * polling in util/aio-posix.c pick up new requests before the client's
+ * kick write and syscall wakeup land, the same way virtio devices poll
+ * their host notifiers.
+ */
+static bool kick_handler_poll(void *opaque)
+{
+    VuFdWatch *vu_fd_watch = opaque;
+    VuVirtq *vq = vu_fd_watch->vq;
+
+    return vq && vq->started && !vu_queue_empty(vu_fd_watch->vu_dev, vq);
+}
+
+static void kick_handler_poll_ready(void *opaque)
+{
+    VuFdWatch *vu_fd_watch = opaque;
+    VuDev *vu_dev = vu_fd_watch->vu_dev;
+    VuVirtq *vq = vu_fd_watch->vq;
+    uint64_t kick_data;
+    ssize_t ret;
+
+    /*
+     * The avail ring told us there is work; the client may or may not
+     * have written a kick as well.  Drain the eventfd here instead of
+     * going through vu_kick_cb(), which treats an empty counter as an
+     * error.
+     */
+    ret = read(vu_fd_watch->fd, &kick_data, sizeof(kick_data));
+    (void)ret;
+
+    if (vq->handler) {
+        vq->handler(vu_dev, vq - vu_dev->vq);
+    }
+
+    /* Stop vu_client_trip() if an error occurred in the handler */
+    if (vu_dev->broken) {
+        VuServer *server = container_of(vu_dev, VuServer, vu_dev);
+
+        qio_channel_shutdown(server->ioc, QIO_CHANNEL_SHUTDOWN_BOTH, NULL);
+    }
+}
+
 static VuFdWatch *find_vu_fd_watch(VuServer *server, int fd)
 {
 
@@ -297,17 +341,31 @@ set_watch(VuDev *vu_dev, int fd, int vu_evt,
     VuFdWatch *vu_fd_watch = find_vu_fd_watch(server, fd);
 
     if (!vu_fd_watch) {
+        int i;
+
         vu_fd_watch = g_new0(VuFdWatch, 1);
 
         QTAILQ_INSERT_TAIL(&server->vu_fd_watches, vu_fd_watch, next);
 
         vu_fd_watch->fd = fd;
         vu_fd_watch->cb = cb;
-        qemu_socket_set_nonblock(fd);
-        aio_set_fd_handler(server->ctx, fd, kick_handler,
-                           NULL, NULL, NULL, vu_fd_watch);
         vu_fd_watch->vu_dev = vu_dev;
         vu_fd_watch->pvt = pvt;
+
+        /* libvhost-user only watches kick fds, find the matching vring */
+        for (i = 0; i < vu_dev->max_queues; i++) {
+            VuVirtq *vq = vu_get_queue(vu_dev, i);
+
+            if (vq->kick_fd == fd) {
+                vu_fd_watch->vq = vq;
+                break;
+            }
+        }
+
+        qemu_socket_set_nonblock(fd);
+        aio_set_fd_handler(server->ctx, fd, kick_handler, NULL,
+                           kick_handler_poll, kick_handler_poll_ready,
+                           vu_fd_watch);
     }
 }
 
@@ -425,7 +483,8 @@ void vhost_user_server_attach_aio_context(VuServer *server, AioContext *ctx)
 
     QTAILQ_FOREACH(vu_fd_watch, &server->vu_fd_watches, next) {
         aio_set_fd_handler(ctx, vu_fd_watch->fd, kick_handler, NULL,
-                           NULL, NULL, vu_fd_watch);
+                           kick_handler_poll, kick_handler_poll_ready,
+                           vu_fd_watch);
     }
 
     if (server->co_trip) {